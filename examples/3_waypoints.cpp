@@ -44,6 +44,6 @@ int main() {
         }
     }
 
-    std::cout << "Reached target position in " << output.trajectory.get_duration() << " [s]." << std::endl;
+    std::cout << "Reached target position in " << otg.get_waypoint_trajectory().get_duration() << " [s]." << std::endl;
     std::cout << "Calculation in " << calculation_duration << " [µs]." << std::endl;
 }
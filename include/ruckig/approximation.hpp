@@ -0,0 +1,174 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <limits>
+#include <tuple>
+#include <type_traits>
+
+#include <ruckig/block.hpp>
+#include <ruckig/brake.hpp>
+#include <ruckig/input_parameter.hpp>
+#include <ruckig/profile.hpp>
+#include <ruckig/velocity.hpp>
+
+
+namespace ruckig {
+
+//! Conservative approximation of the time-optimal trajectory, e.g. for the many edges of a sampling-based planner
+
+//! Instead of the time-optimal profile, each DoF is bounded by a feasible motion through rest: the brake trajectory of
+//! the exact calculation, a stop, a motion between two states at rest, and the time-reversed stop from the target
+//! state. Waiting at rest stretches this motion to any longer duration, so that the exact (time or phase) synchronized
+//! trajectory is never longer than the slowest of these motions. Only closed forms and the velocity Step 1 to rest are
+//! evaluated, without any blocked intervals or Step 2. The position bounds hold for the exact trajectory between the
+//! start and its end (not its extrapolation), as its speed is bounded by the velocity limits and the brake trajectory.
+//! Only the position interface is supported.
+template<size_t DOFs, size_t MaxDOFs = 0>
+class ConservativeApproximation {
+    template<class T> using Vector = DOFsVector<T, DOFs, MaxDOFs>;
+
+    Vector<double> max_speeds; // Bound of the absolute velocity of each DoF
+
+    //! Duration and displacement of the time-optimal stop from a state within the acceleration limits to rest
+    static bool get_stop(double v0, double a0, double aMax, double aMin, double jMax, double& duration, double& displacement) {
+        VelocityStep1 step1 {0.0, v0, a0, 0.0, 0.0, aMax, aMin, jMax};
+        Block block;
+        if (!step1.get_profile(Profile(), block, true)) {
+            return false;
+        }
+
+        duration = block.t_min;
+        displacement = block.get_min_profile().pf;
+        return true;
+    }
+
+    //! Duration of the time-optimal motion between two states at rest with symmetric limits, in closed form
+    static double get_rest_to_rest_duration(double distance, double vMax, double aMax, double jMax) {
+        distance = std::abs(distance);
+
+        // Duration and distance of the acceleration to the maximal velocity
+        const double t_acceleration = (vMax * jMax >= aMax * aMax) ? vMax / aMax + aMax / jMax : 2 * std::sqrt(vMax / jMax);
+        if (distance >= vMax * t_acceleration) {
+            return t_acceleration + distance / vMax;
+        }
+
+        // The velocity limit is not reached, with or without reaching the acceleration limit
+        if (distance <= 2 * aMax * aMax * aMax / (jMax * jMax)) {
+            return 4 * std::cbrt(distance / (2 * jMax));
+        }
+
+        const double v_peak = aMax / 2 * (std::sqrt(aMax * aMax / (jMax * jMax) + 4 * distance / aMax) - aMax / jMax);
+        return 2 * (v_peak / aMax + aMax / jMax);
+    }
+
+public:
+    size_t degrees_of_freedom;
+
+    //! Upper bound of the duration of the exact trajectory
+    double duration {0.0};
+
+    //! Duration of the bounding motion of each DoF
+    Vector<double> independent_durations;
+
+    //! Bounds of the positions of the exact trajectory between zero and its duration
+    Vector<double> min_position, max_position;
+
+    template <size_t D = DOFs, typename std::enable_if<D >= 1, int>::type = 0>
+    ConservativeApproximation(): degrees_of_freedom(DOFs) { }
+
+    template <size_t D = DOFs, typename std::enable_if<D == 0, int>::type = 0>
+    ConservativeApproximation(size_t dofs): degrees_of_freedom(dofs) {
+        max_speeds.resize(dofs);
+        independent_durations.resize(dofs);
+        min_position.resize(dofs);
+        max_position.resize(dofs);
+    }
+
+    //! Calculate the bounds for a valid input, the delta_time is only used for discrete durations
+    Result calculate(const InputParameter<DOFs, MaxDOFs>& inp, double delta_time) {
+        duration = inp.minimum_duration.value_or(0.0);
+        for (size_t dof = 0; dof < degrees_of_freedom; ++dof) {
+            const ControlInterface control_interface = inp.per_dof_control_interface ? inp.per_dof_control_interface.value()[dof] : inp.control_interface;
+            if (inp.enabled[dof] && control_interface != ControlInterface::Position) {
+                return Result::ErrorInvalidInput;
+            }
+
+            independent_durations[dof] = 0.0;
+            if (!inp.enabled[dof]) {
+                continue;
+            }
+
+            const double vMax = inp.max_velocity[dof];
+            const double vMin = inp.min_velocity ? inp.min_velocity.value()[dof] : -inp.max_velocity[dof];
+            const double aMax = inp.max_acceleration[dof];
+            const double aMin = inp.min_acceleration ? inp.min_acceleration.value()[dof] : -inp.max_acceleration[dof];
+            const double jMax = inp.max_jerk[dof];
+
+            // The same brake trajectory as the exact calculation, afterwards the state is within the limits
+            BrakeProfile brake;
+            BrakeProfile::get_position_brake_trajectory(inp.current_velocity[dof], inp.current_acceleration[dof], vMax, vMin, aMax, aMin, jMax, brake.t, brake.j);
+            double p0 {inp.current_position[dof]}, v0 {inp.current_velocity[dof]}, a0 {inp.current_acceleration[dof]};
+            for (size_t i = 0; i < 2 && brake.t[i] > 0; ++i) {
+                std::tie(p0, v0, a0) = Profile::integrate(brake.t[i], p0, v0, a0, brake.j[i]);
+            }
+
+            // Stop, and reach the target state from rest as the time-reversed stop from its mirrored velocity
+            double t_stop, p_stop, t_arrival, p_arrival;
+            if (!get_stop(v0, a0, aMax, aMin, jMax, t_stop, p_stop) || !get_stop(-inp.target_velocity[dof], inp.target_acceleration[dof], aMax, aMin, jMax, t_arrival, p_arrival)) {
+                return Result::ErrorExecutionTimeCalculation;
+            }
+
+            const double distance = (inp.target_position[dof] + p_arrival) - (p0 + p_stop);
+            const double t_motion = get_rest_to_rest_duration(distance, std::min(vMax, -vMin), std::min(aMax, -aMin), jMax);
+            independent_durations[dof] = brake.t[0] + brake.t[1] + t_stop + t_motion + t_arrival;
+            duration = std::max(duration, independent_durations[dof]);
+
+            // The speed exceeds the velocity limits at most while the acceleration of the boundary states is reduced
+            const double v0_peak = std::abs(inp.current_velocity[dof]) + inp.current_acceleration[dof] * inp.current_acceleration[dof] / (2 * jMax);
+            const double vf_peak = std::abs(inp.target_velocity[dof]) + inp.target_acceleration[dof] * inp.target_acceleration[dof] / (2 * jMax);
+            max_speeds[dof] = std::max({vMax, -vMin, v0_peak, vf_peak});
+        }
+
+        if (inp.duration_discretization == DurationDiscretization::Discrete && duration > 0.0) {
+            double steps = std::ceil(duration / delta_time);
+            if (steps * delta_time < duration) {
+                steps += 1;
+            }
+            duration = steps * delta_time;
+        }
+
+        for (size_t dof = 0; dof < degrees_of_freedom; ++dof) {
+            const double p0 = inp.current_position[dof];
+            if (!inp.enabled[dof]) {
+                // Constant acceleration, bounded by its end points and its vertex
+                const double v0 = inp.current_velocity[dof], a0 = inp.current_acceleration[dof];
+                const double pf = p0 + duration * (v0 + duration * a0 / 2);
+                min_position[dof] = std::min(p0, pf);
+                max_position[dof] = std::max(p0, pf);
+                if (a0 != 0.0 && -v0 / a0 > 0.0 && -v0 / a0 < duration) {
+                    const double p_vertex = p0 - v0 * v0 / (2 * a0);
+                    min_position[dof] = std::min(min_position[dof], p_vertex);
+                    max_position[dof] = std::max(max_position[dof], p_vertex);
+                }
+                continue;
+            }
+
+            // A DoF that is not synchronized might reach its target earlier, and continues with the target acceleration
+            const Synchronization synchronization = inp.per_dof_synchronization ? inp.per_dof_synchronization.value()[dof] : inp.synchronization;
+            double max_speed = max_speeds[dof];
+            if (synchronization != Synchronization::Time && synchronization != Synchronization::Phase) {
+                max_speed = std::max(max_speed, std::abs(inp.target_velocity[dof]) + std::abs(inp.target_acceleration[dof]) * duration);
+            }
+
+            // Leaving the start and reaching the target with at most the maximal speed meet in the middle
+            const double pf = inp.target_position[dof];
+            min_position[dof] = std::min({(p0 + pf - max_speed * duration) / 2, p0, pf});
+            max_position[dof] = std::max({(p0 + pf + max_speed * duration) / 2, p0, pf});
+        }
+        return Result::Working;
+    }
+};
+
+} // namespace ruckig
@@ -0,0 +1,171 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+#include <ruckig/ruckig.hpp>
+
+
+namespace ruckig {
+
+//! Online trajectory generation with the calculation on a background thread
+
+//! When the input changes, update keeps sampling the current trajectory while the new trajectory is calculated in
+//! the background. The new trajectory starts from the state of the current trajectory at a predicted time, namely
+//! prediction_cycles control cycles later, and is swapped in exactly then. If the calculation takes longer, the new
+//! trajectory is swapped in as soon as it is ready (at its corresponding time, which leads to a jump in the output).
+//! Only the very first trajectory is calculated synchronously.
+template<size_t DOFs, size_t MaxDOFs = 0>
+class AsyncRuckig {
+    enum class State {
+        Idle,
+        Requested, ///< The background thread is calculating a new trajectory
+        Finished, ///< The new trajectory is ready to be swapped in
+    };
+
+    Ruckig<DOFs, false, true, MaxDOFs> otg;
+
+    //! Input of the current trajectory, only for comparison for recalculation
+    InputParameter<DOFs, MaxDOFs> current_input;
+    bool current_input_initialized {false};
+
+    // Owned by the calling thread while idle, and by the background thread while requested
+    InputParameter<DOFs, MaxDOFs> requested_input, background_input;
+    Trajectory<DOFs, MaxDOFs> background_trajectory;
+    Result background_result {Result::Working};
+    double background_start_time {0.0}; // Time on the current trajectory at which the new one starts
+
+    std::atomic<State> state {State::Idle};
+    std::atomic<bool> running {true};
+    std::mutex mutex;
+    std::condition_variable condition;
+    std::thread worker;
+
+    void work() {
+        while (true) {
+            {
+                std::unique_lock<std::mutex> lock {mutex};
+                condition.wait(lock, [this] { return state.load() == State::Requested || !running.load(); });
+                if (!running.load()) {
+                    return;
+                }
+            }
+
+            bool was_interrupted {false};
+            background_result = otg.calculate(background_input, background_trajectory, was_interrupted);
+            state.store(State::Finished, std::memory_order_release);
+        }
+    }
+
+    void request(const InputParameter<DOFs, MaxDOFs>& input, const OutputParameter<DOFs, MaxDOFs>& output) {
+        requested_input = input;
+        background_input = input;
+        background_start_time = output.time + (std::max<size_t>(prediction_cycles, 1) + 1) * delta_time;
+        output.trajectory.at_time(background_start_time, background_input.current_position, background_input.current_velocity, background_input.current_acceleration);
+
+        {
+            std::lock_guard<std::mutex> lock {mutex};
+            state.store(State::Requested, std::memory_order_release);
+        }
+        condition.notify_one();
+    }
+
+public:
+    size_t degrees_of_freedom;
+
+    //! Time step between updates (cycle time) in [s]
+    const double delta_time;
+
+    //! Number of control cycles between starting a background calculation and swapping in its trajectory
+    size_t prediction_cycles {2};
+
+    template <size_t D = DOFs, typename std::enable_if<D >= 1, int>::type = 0>
+    explicit AsyncRuckig(double delta_time): otg(delta_time), degrees_of_freedom(DOFs), delta_time(delta_time) {
+        worker = std::thread(&AsyncRuckig::work, this);
+    }
+
+    template <size_t D = DOFs, typename std::enable_if<D == 0, int>::type = 0>
+    explicit AsyncRuckig(size_t dofs, double delta_time): otg(dofs, delta_time), current_input(dofs), requested_input(dofs), background_input(dofs), background_trajectory(dofs), degrees_of_freedom(dofs), delta_time(delta_time) {
+        worker = std::thread(&AsyncRuckig::work, this);
+    }
+
+    ~AsyncRuckig() {
+        {
+            std::lock_guard<std::mutex> lock {mutex};
+            running.store(false);
+        }
+        condition.notify_one();
+        worker.join();
+    }
+
+    AsyncRuckig(const AsyncRuckig&) = delete;
+    AsyncRuckig& operator=(const AsyncRuckig&) = delete;
+
+    //! Is a new trajectory being calculated in the background?
+    bool is_calculating() const {
+        return state.load(std::memory_order_acquire) == State::Requested;
+    }
+
+    //! Get the next output state along the current trajectory, and start or swap in a background calculation
+    Result update(const InputParameter<DOFs, MaxDOFs>& input, OutputParameter<DOFs, MaxDOFs>& output) {
+        Stopwatch<true> stopwatch;
+        output.new_calculation = false;
+
+        if (!current_input_initialized) {
+            bool was_interrupted {false};
+            const Result result = otg.calculate(input, output.trajectory, was_interrupted);
+            if (result != Result::Working) {
+                return result;
+            }
+
+            current_input = input;
+            current_input_initialized = true;
+            output.time = 0.0;
+            output.cursor.reset();
+            output.new_calculation = true;
+
+        } else {
+            // Swap in the new trajectory at its start time
+            if (state.load(std::memory_order_acquire) == State::Finished && output.time + delta_time >= background_start_time - 1e-6 * delta_time) {
+                state.store(State::Idle, std::memory_order_relaxed);
+                if (background_result != Result::Working) {
+                    return background_result;
+                }
+
+                // Keep the current state, as it was passed from the output since the request
+                std::swap(output.trajectory, background_trajectory);
+                requested_input.current_position = current_input.current_position;
+                requested_input.current_velocity = current_input.current_velocity;
+                requested_input.current_acceleration = current_input.current_acceleration;
+                current_input = requested_input;
+                output.time = std::max(output.time + delta_time - background_start_time, 0.0) - delta_time;
+                output.cursor.reset();
+                output.new_calculation = true;
+            }
+
+            if (state.load(std::memory_order_acquire) == State::Idle && input.has_changed(current_input)) {
+                request(input, output);
+            }
+        }
+        output.was_calculation_interrupted = (state.load(std::memory_order_acquire) != State::Idle);
+
+        const size_t old_section = output.new_section;
+        output.time += delta_time;
+        output.trajectory.at_time(output.time, output.new_position, output.new_velocity, output.new_acceleration, output.new_section, output.cursor);
+        output.did_section_change = (output.new_section != old_section);
+
+        output.calculation_duration = stopwatch.lap();
+
+        output.pass_to_input(current_input);
+
+        if (output.time > output.trajectory.get_duration()) {
+            return Result::Finished;
+        }
+
+        return Result::Working;
+    }
+};
+
+} // namespace ruckig
@@ -0,0 +1,196 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+#include <ruckig/ruckig.hpp>
+
+
+namespace ruckig {
+
+//! Many independent Ruckig instances with the same number of DoFs and cycle time, stepped together
+
+//! Each update_all call recalculates only the instances whose input has changed (optionally in parallel on a worker
+//! pool), and then samples all instances at once. The trajectory segments are first looked up per instance, and then
+//! integrated in a single branch-free loop over all instances and DoFs, so that it can be vectorized by the compiler.
+//! The outputs are stored in SoA form, e.g. `new_positions[dof * size() + instance]`.
+template<size_t DOFs, size_t MaxDOFs = 0>
+class BatchRuckig {
+    Ruckig<DOFs, false, true, MaxDOFs> otg;
+
+    std::vector<InputParameter<DOFs, MaxDOFs>> current_inputs;
+    std::vector<uint8_t> current_inputs_initialized;
+    std::vector<Trajectory<DOFs, MaxDOFs>> trajectories;
+    std::vector<size_t> changed_instances;
+
+    // State at the beginning of the current segment of each instance and DoF, in the same SoA form as the outputs
+    std::vector<size_t> segments;
+    std::vector<double> segment_times, segment_positions, segment_velocities, segment_accelerations, segment_jerks;
+
+    void calculate(const InputParameter<DOFs, MaxDOFs>& input, size_t instance) {
+        results[instance] = otg.calculate(input, trajectories[instance]);
+        if (results[instance] != Result::Working) {
+            return;
+        }
+
+        current_inputs[instance] = input;
+        current_inputs_initialized[instance] = true;
+        times[instance] = 0.0;
+        new_calculations[instance] = true;
+        for (size_t dof = 0; dof < degrees_of_freedom; ++dof) {
+            segments[dof * size() + instance] = 0;
+        }
+    }
+
+public:
+    size_t degrees_of_freedom;
+
+    //! Time step between updates (cycle time) in [s]
+    const double delta_time;
+
+    //! Optional pool of worker threads to recalculate the changed instances in parallel (not owned)
+    WorkerPool* worker_pool {nullptr};
+
+    //! Current time on the trajectory of each instance
+    std::vector<double> times;
+
+    //! Result of the last update of each instance
+    std::vector<Result> results;
+
+    //! Was a new trajectory calculated for the instance in the last update?
+    std::vector<uint8_t> new_calculations;
+
+    //! Current kinematic state of each instance and DoF, indexed by `dof * size() + instance`
+    std::vector<double> new_positions, new_velocities, new_accelerations;
+
+    template <size_t D = DOFs, typename std::enable_if<D >= 1, int>::type = 0>
+    explicit BatchRuckig(size_t number_instances, double delta_time): otg(delta_time), current_inputs(number_instances), trajectories(number_instances), degrees_of_freedom(DOFs), delta_time(delta_time) {
+        resize(number_instances);
+    }
+
+    template <size_t D = DOFs, typename std::enable_if<D == 0, int>::type = 0>
+    explicit BatchRuckig(size_t number_instances, size_t dofs, double delta_time): otg(dofs, delta_time), current_inputs(number_instances, InputParameter<0, MaxDOFs>(dofs)), trajectories(number_instances, Trajectory<0, MaxDOFs>(dofs)), degrees_of_freedom(dofs), delta_time(delta_time) {
+        resize(number_instances);
+    }
+
+    //! Allocate all buffers for the given number of instances
+    void resize(size_t number_instances) {
+        changed_instances.reserve(number_instances);
+        current_inputs_initialized.resize(number_instances, false);
+        times.resize(number_instances, 0.0);
+        results.resize(number_instances, Result::Working);
+        new_calculations.resize(number_instances, false);
+
+        const size_t number_states = number_instances * degrees_of_freedom;
+        for (auto* vector: {&segment_times, &segment_positions, &segment_velocities, &segment_accelerations, &segment_jerks, &new_positions, &new_velocities, &new_accelerations}) {
+            vector->resize(number_states, 0.0);
+        }
+        segments.resize(number_states, 0);
+    }
+
+    //! Number of instances
+    size_t size() const {
+        return times.size();
+    }
+
+    //! Current trajectory of the instance
+    const Trajectory<DOFs, MaxDOFs>& trajectory(size_t instance) const {
+        return trajectories[instance];
+    }
+
+    //! Get the next output state of all instances, and recalculate the instances with a changed input
+    void update_all(const std::vector<InputParameter<DOFs, MaxDOFs>>& inputs) {
+        const size_t number_instances = size();
+        if (inputs.size() != number_instances) {
+            throw std::runtime_error("[ruckig] mismatch in the number of instances.");
+        }
+
+        changed_instances.clear();
+        for (size_t i = 0; i < number_instances; ++i) {
+            new_calculations[i] = false;
+            if (!current_inputs_initialized[i] || inputs[i].has_changed(current_inputs[i])) {
+                changed_instances.push_back(i);
+            }
+        }
+
+        if (worker_pool && worker_pool->number_threads() > 1 && changed_instances.size() > 1) {
+            const size_t chunk_size = (changed_instances.size() + worker_pool->number_threads() - 1) / worker_pool->number_threads();
+            worker_pool->run([this, &inputs, chunk_size](size_t chunk) {
+                const size_t begin = std::min(chunk * chunk_size, changed_instances.size());
+                const size_t end = std::min(begin + chunk_size, changed_instances.size());
+                for (size_t j = begin; j < end; ++j) {
+                    calculate(inputs[changed_instances[j]], changed_instances[j]);
+                }
+            });
+        } else {
+            for (const size_t i: changed_instances) {
+                calculate(inputs[i], i);
+            }
+        }
+
+        // Look up the current segment of each instance and DoF
+        for (size_t i = 0; i < number_instances; ++i) {
+            if (results[i] < 0 || !current_inputs_initialized[i]) {
+                // Hold the last state
+                for (size_t dof = 0; dof < degrees_of_freedom; ++dof) {
+                    const size_t k = dof * number_instances + i;
+                    segment_times[k] = 0.0;
+                    segment_positions[k] = new_positions[k];
+                    segment_velocities[k] = new_velocities[k];
+                    segment_accelerations[k] = new_accelerations[k];
+                    segment_jerks[k] = 0.0;
+                }
+                continue;
+            }
+
+            times[i] += delta_time;
+            const auto& trajectory = trajectories[i];
+            for (size_t dof = 0; dof < degrees_of_freedom; ++dof) {
+                const size_t k = dof * number_instances + i;
+                const Profile& p = trajectory.profiles[dof];
+                if (times[i] >= trajectory.duration) {
+                    // Keep constant acceleration
+                    segments[k] = 9;
+                    segment_times[k] = times[i] - (p.brake.duration + p.t_sum[6]);
+                    segment_positions[k] = p.pf;
+                    segment_velocities[k] = p.vf;
+                    segment_accelerations[k] = p.af;
+                    segment_jerks[k] = 0.0;
+                } else {
+                    Trajectory<DOFs, MaxDOFs>::segment_at_time(p, times[i], segments[k], segment_times[k], segment_positions[k], segment_velocities[k], segment_accelerations[k], segment_jerks[k]);
+                }
+            }
+
+            results[i] = (times[i] > trajectory.duration) ? Result::Finished : Result::Working;
+        }
+
+        // Integrate all segments at once
+        const size_t number_states = number_instances * degrees_of_freedom;
+        for (size_t k = 0; k < number_states; ++k) {
+            const double t = segment_times[k];
+            new_positions[k] = segment_positions[k] + t * (segment_velocities[k] + t * (segment_accelerations[k] / 2 + t * segment_jerks[k] / 6));
+            new_velocities[k] = segment_velocities[k] + t * (segment_accelerations[k] + t * segment_jerks[k] / 2);
+            new_accelerations[k] = segment_accelerations[k] + t * segment_jerks[k];
+        }
+
+        // Keep the current inputs in sync with the output, as in Ruckig::update
+        for (size_t i = 0; i < number_instances; ++i) {
+            if (current_inputs_initialized[i]) {
+                pass_to_input(i, current_inputs[i]);
+            }
+        }
+    }
+
+    //! Copy the current state of the instance into its input for the next cycle
+    void pass_to_input(size_t instance, InputParameter<DOFs, MaxDOFs>& input) const {
+        for (size_t dof = 0; dof < degrees_of_freedom; ++dof) {
+            const size_t k = dof * size() + instance;
+            input.current_position[dof] = new_positions[k];
+            input.current_velocity[dof] = new_velocities[k];
+            input.current_acceleration[dof] = new_accelerations[k];
+        }
+    }
+};
+
+} // namespace ruckig
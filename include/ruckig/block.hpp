@@ -1,10 +1,13 @@
 #pragma once
 
 #include <algorithm>
+#include <array>
 #include <limits>
 #include <numeric>
-#include <optional>
-#include <string>
+
+#ifndef RUCKIG_HARD_REALTIME
+    #include <string>
+#endif
 
 #include <ruckig/profile.hpp>
 
@@ -12,56 +15,129 @@
 namespace ruckig {
 
 //! Which times are possible for synchronization?
+
+//! The candidate profiles of Step 1 are written directly into a pool of the block, the minimal profile and the blocked
+//! intervals only refer to them by index. So no profile is copied while calculating a block, and only the ones selected
+//! by the synchronization are copied into the trajectory.
 class Block {
+    friend class PositionStep1;
+    friend class VelocityStep1;
+
     struct Interval {
         double left, right; // [s]
-        Profile profile; // Profile corresponding to right (end) time
-
-        explicit Interval(double left, double right, const Profile& profile): left(left), right(right), profile(profile) { };
+        size_t index; // Profile corresponding to right (end) time
     };
 
-    inline static void add_interval(std::optional<Block::Interval>& interval, const Profile& left, const Profile& right) {
-        const double left_duration = left.t_sum[6] + left.brake.duration;
-        const double right_duraction = right.t_sum[6] + right.brake.duration;
+    // Max 5 valid profiles + 1 spare for numerical issues
+    std::array<Profile, 6> profiles;
+    size_t min_index {0};
+
+    inline void add_interval(Block::Interval& interval, bool& has_interval, size_t left, size_t right) const {
+        const double left_duration = profiles[left].t_sum[6] + profiles[left].brake.duration;
+        const double right_duraction = profiles[right].t_sum[6] + profiles[right].brake.duration;
         if (left_duration < right_duraction) {
-            interval = Block::Interval(left_duration, right_duraction, right);
+            interval.left = left_duration;
+            interval.right = right_duraction;
+            interval.index = right;
         } else {
-            interval = Block::Interval(right_duraction, left_duration, left);
+            interval.left = right_duraction;
+            interval.right = left_duration;
+            interval.index = left;
         }
+        has_interval = true;
     }
 
-    template<size_t N>
-    inline static void remove_profile(std::array<Profile, N>& valid_profiles, size_t& valid_profile_counter, size_t index) {
+    //! Reset the block to the minimal profile only
+    inline void set_min_index(size_t index) {
+        min_index = index;
+        t_min = profiles[index].t_sum[6] + profiles[index].brake.duration;
+        has_a = false;
+        has_b = false;
+    }
+
+    inline void remove_profile(size_t& valid_profile_counter, size_t index) {
         for (size_t i = index; i < valid_profile_counter - 1; ++i) {
-            valid_profiles[i] = valid_profiles[i + 1];
+            profiles[i] = profiles[i + 1];
         }
         valid_profile_counter -= 1;
     }
 
 public:
-    Profile p_min; // Save min profile so that it doesn't need to be recalculated in Step2
     double t_min; // [s]
 
-    // Max. 2 intervals can be blocked: called a and b with corresponding profiles, order does not matter
-    std::optional<Interval> a, b;
+    // Max. 2 intervals can be blocked: called a and b with corresponding profiles, order does not matter.
+    // An interval is only valid if its flag is set, so that resetting a block never touches their profiles.
+    Interval a, b;
+    bool has_a {false}, has_b {false};
 
     explicit Block() { }
-    explicit Block(const Profile& p_min): p_min(p_min), t_min(p_min.t_sum[6] + p_min.brake.duration) { }
+    explicit Block(const Profile& p_min) {
+        set_min_profile(p_min);
+    }
+
+    //! Reset the block to a single given profile, e.g. for a DoF without motion
+    inline void set_min_profile(const Profile& profile) {
+        profiles[0] = profile;
+        set_min_index(0);
+    }
+
+    //! Express the minimal profile and the blocked intervals in other units, see Profile::scale_units
+    inline void scale_units(double time_factor, double position_factor, double position_offset) {
+        std::array<bool, 6> is_scaled {};
+        const auto scale_profile = [&](size_t index) {
+            if (!is_scaled[index]) {
+                profiles[index].scale_units(time_factor, position_factor, position_offset);
+                is_scaled[index] = true;
+            }
+        };
+
+        scale_profile(min_index);
+        t_min *= time_factor;
+        if (has_a) {
+            scale_profile(a.index);
+            a.left *= time_factor;
+            a.right *= time_factor;
+        }
+        if (has_b) {
+            scale_profile(b.index);
+            b.left *= time_factor;
+            b.right *= time_factor;
+        }
+    }
+
+    //! Get the time-optimal profile, so that it doesn't need to be recalculated in Step 2
+    inline const Profile& get_min_profile() const {
+        return profiles[min_index];
+    }
 
-    template<size_t N, bool numerical_robust = true>
-    static bool calculate_block(Block& block, std::array<Profile, N>& valid_profiles, size_t valid_profile_counter) {
+    //! Get the profile corresponding to the right (end) time of a blocked interval
+    inline const Profile& get_profile(const Interval& interval) const {
+        return profiles[interval.index];
+    }
+
+    //! Select the minimal profile and the blocked intervals from the first valid_profile_counter profiles of the pool
+    template<bool numerical_robust = true>
+    static bool calculate_block(Block& block, size_t valid_profile_counter, bool minimum_duration_only = false) {
+        const auto& valid_profiles = block.profiles;
         // std::cout << "---\n " << valid_profile_counter << std::endl;
         // for (size_t i = 0; i < valid_profile_counter; ++i) {
         //     std::cout << valid_profiles[i].t_sum[6] << " " << valid_profiles[i].to_string() << std::endl;
         // }
 
+        // Skip the blocked intervals if they are not needed for synchronization
+        if (minimum_duration_only && valid_profile_counter > 0) {
+            const auto idx_min_it = std::min_element(valid_profiles.cbegin(), valid_profiles.cbegin() + valid_profile_counter, [](const Profile& a, const Profile& b) { return a.t_sum[6] < b.t_sum[6]; });
+            block.set_min_index(std::distance(valid_profiles.cbegin(), idx_min_it));
+            return true;
+        }
+
         if (valid_profile_counter == 1) {
-            block = Block(valid_profiles[0]);
+            block.set_min_index(0);
             return true;
 
         } else if (valid_profile_counter == 2) {
             if (std::abs(valid_profiles[0].t_sum[6] - valid_profiles[1].t_sum[6]) < 8*std::numeric_limits<double>::epsilon()) {
-                block = Block(valid_profiles[0]);
+                block.set_min_index(0);
                 return true;
             }
 
@@ -69,8 +145,8 @@ public:
                 const size_t idx_min = (valid_profiles[0].t_sum[6] < valid_profiles[1].t_sum[6]) ? 0 : 1;
                 const size_t idx_else_1 = (idx_min + 1) % 2;
 
-                block = Block(valid_profiles[idx_min]);
-                Block::add_interval(block.a, valid_profiles[idx_min], valid_profiles[idx_else_1]);
+                block.set_min_index(idx_min);
+                block.add_interval(block.a, block.has_a, idx_min, idx_else_1);
                 return true;
             }
 
@@ -78,11 +154,11 @@ public:
         } else if (valid_profile_counter == 4) {
             // Find "identical" profiles
             if (std::abs(valid_profiles[0].t_sum[6] - valid_profiles[1].t_sum[6]) < 32*std::numeric_limits<double>::epsilon() && valid_profiles[0].direction != valid_profiles[1].direction) {
-                remove_profile<N>(valid_profiles, valid_profile_counter, 1);
+                block.remove_profile(valid_profile_counter, 1);
             } else if (std::abs(valid_profiles[2].t_sum[6] - valid_profiles[3].t_sum[6]) < 256*std::numeric_limits<double>::epsilon() && valid_profiles[2].direction != valid_profiles[3].direction) {
-                remove_profile<N>(valid_profiles, valid_profile_counter, 3);
+                block.remove_profile(valid_profile_counter, 3);
             } else if (std::abs(valid_profiles[0].t_sum[6] - valid_profiles[3].t_sum[6]) < 256*std::numeric_limits<double>::epsilon() && valid_profiles[0].direction != valid_profiles[3].direction) {
-                remove_profile<N>(valid_profiles, valid_profile_counter, 3);
+                block.remove_profile(valid_profile_counter, 3);
             } else {
                 return false;
             }
@@ -95,13 +171,13 @@ public:
         const auto idx_min_it = std::min_element(valid_profiles.cbegin(), valid_profiles.cbegin() + valid_profile_counter, [](const Profile& a, const Profile& b) { return a.t_sum[6] < b.t_sum[6]; });
         const size_t idx_min = std::distance(valid_profiles.cbegin(), idx_min_it);
 
-        block = Block(valid_profiles[idx_min]);
+        block.set_min_index(idx_min);
 
         if (valid_profile_counter == 3) {
             const size_t idx_else_1 = (idx_min + 1) % 3;
             const size_t idx_else_2 = (idx_min + 2) % 3;
 
-            Block::add_interval(block.a, valid_profiles[idx_else_1], valid_profiles[idx_else_2]);
+            block.add_interval(block.a, block.has_a, idx_else_1, idx_else_2);
             return true;
 
         } else if (valid_profile_counter == 5) {
@@ -111,11 +187,11 @@ public:
             const size_t idx_else_4 = (idx_min + 4) % 5;
 
             if (valid_profiles[idx_else_1].direction == valid_profiles[idx_else_2].direction) {
-                Block::add_interval(block.a, valid_profiles[idx_else_1], valid_profiles[idx_else_2]);
-                Block::add_interval(block.b, valid_profiles[idx_else_3], valid_profiles[idx_else_4]);
+                block.add_interval(block.a, block.has_a, idx_else_1, idx_else_2);
+                block.add_interval(block.b, block.has_b, idx_else_3, idx_else_4);
             } else {
-                Block::add_interval(block.a, valid_profiles[idx_else_1], valid_profiles[idx_else_4]);
-                Block::add_interval(block.b, valid_profiles[idx_else_2], valid_profiles[idx_else_3]);
+                block.add_interval(block.a, block.has_a, idx_else_1, idx_else_4);
+                block.add_interval(block.b, block.has_b, idx_else_2, idx_else_3);
             }
             return true;
         }
@@ -124,19 +200,21 @@ public:
     }
 
     inline bool is_blocked(double t) const {
-        return (t < t_min) || (a && a->left < t && t < a->right) || (b && b->left < t && t < b->right);
+        return (t < t_min) || (has_a && a.left < t && t < a.right) || (has_b && b.left < t && t < b.right);
     }
 
+#ifndef RUCKIG_HARD_REALTIME
     std::string to_string() const {
         std::string result = "[" + std::to_string(t_min) + " ";
-        if (a) {
-            result += std::to_string(a->left) + "] [" + std::to_string(a->right) + " ";
+        if (has_a) {
+            result += std::to_string(a.left) + "] [" + std::to_string(a.right) + " ";
         }
-        if (b) {
-            result += std::to_string(b->left) + "] [" + std::to_string(b->right) + " ";
+        if (has_b) {
+            result += std::to_string(b.left) + "] [" + std::to_string(b.right) + " ";
         }
         return result + "-";
     }
+#endif
 };
 
 } // namespace ruckig
@@ -0,0 +1,110 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <optional>
+#include <type_traits>
+#include <vector>
+
+#include <ruckig/utils.hpp>
+
+
+namespace ruckig {
+
+//! Which timing information Ruckig measures, chosen at compile-time, each level includes the previous ones
+enum class Instrumentation {
+    None, ///< No clock reads at all, the calculation duration is not measured
+    Duration, ///< Measure the total duration of each update call (Default)
+    Phases, ///< Additionally measure the duration of each calculation phase
+    Cases, ///< Additionally count the profile cases of each calculation, see CaseStatistics
+};
+
+
+//! Durations [µs] of the individual phases of the last trajectory calculation
+template<size_t DOFs, size_t MaxDOFs = 0>
+struct CalculationTiming {
+    template<class T> using Vector = DOFsVector<T, DOFs, MaxDOFs>;
+
+    //! Brake pre-trajectory of each DoF
+    Vector<double> brake;
+
+    //! Step 1 of each DoF (the shared pre-calculation of all DoFs is split evenly)
+    Vector<double> step1;
+
+    //! Finding the synchronization duration across all DoFs
+    double synchronization {0.0};
+
+    //! Phase synchronization, i.e. the collinearity check and the profile checks
+    double phase_synchronization {0.0};
+
+    //! Step 2 of each DoF
+    Vector<double> step2;
+
+    template <size_t D = DOFs, typename std::enable_if<D >= 1, int>::type = 0>
+    CalculationTiming() {
+        reset();
+    }
+
+    template <size_t D = DOFs, typename std::enable_if<D == 0, int>::type = 0>
+    CalculationTiming(size_t dofs) {
+        brake.resize(dofs);
+        step1.resize(dofs);
+        step2.resize(dofs);
+        reset();
+    }
+
+    void reset() {
+        std::fill(brake.begin(), brake.end(), 0.0);
+        std::fill(step1.begin(), step1.end(), 0.0);
+        std::fill(step2.begin(), step2.end(), 0.0);
+        synchronization = 0.0;
+        phase_synchronization = 0.0;
+    }
+};
+
+
+//! Measures the time between consecutive laps, and is compiled out entirely if not enabled
+template<bool enabled>
+class Stopwatch {
+    std::chrono::high_resolution_clock::time_point last;
+
+public:
+    explicit Stopwatch() {
+        if constexpr (enabled) {
+            last = std::chrono::high_resolution_clock::now();
+        }
+    }
+
+    //! Duration [µs] since the last lap or the construction
+    double lap() {
+        if constexpr (enabled) {
+            const auto now = std::chrono::high_resolution_clock::now();
+            const double duration = std::chrono::duration_cast<std::chrono::nanoseconds>(now - last).count() / 1000.0;
+            last = now;
+            return duration;
+        }
+        return 0.0;
+    }
+};
+
+
+//! Soft deadline for interrupting a calculation, never passes if no duration is given
+class Deadline {
+    std::chrono::steady_clock::time_point end;
+    bool enabled;
+
+public:
+    //! Start the deadline with the given duration [µs] from now
+    explicit Deadline(std::optional<double> duration): enabled(duration.has_value()) {
+        if (enabled) {
+            end = std::chrono::steady_clock::now() + std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double, std::micro>(duration.value()));
+        }
+    }
+
+    bool has_passed() const {
+        return enabled && std::chrono::steady_clock::now() >= end;
+    }
+};
+
+} // namespace ruckig
@@ -0,0 +1,149 @@
+#pragma once
+
+#include <algorithm>
+#include <limits>
+#include <vector>
+
+#include <ruckig/ruckig.hpp>
+
+
+namespace ruckig {
+
+//! Minimal durations of many candidate motions with the same number of DoFs, e.g. for learning-based or sampling-based
+//! planners that evaluate far more motions than they execute
+
+//! The inputs and outputs are stored in SoA form, e.g. `current_positions[dof * size() + candidate]`, so that they can
+//! be filled from (and read into) the tensors of a planner without any per-candidate structures. Each candidate is
+//! evaluated by the same kernel from the buffers and a workspace only, which gathers its input, runs the brake
+//! trajectories, Step 1, and the synchronization, and skips Step 2. With a worker pool, each thread evaluates a
+//! contiguous chunk of the candidates with its own workspace. The exact trajectory of a chosen candidate is calculated
+//! with calculate afterwards.
+template<size_t DOFs, size_t MaxDOFs = 0>
+class CandidateBatch {
+    Ruckig<DOFs, false, true, MaxDOFs> otg;
+
+    //! Input and trajectory of each thread
+    struct Workspace {
+        InputParameter<DOFs, MaxDOFs> input;
+        Trajectory<DOFs, MaxDOFs> trajectory;
+    };
+
+    std::vector<Workspace> workspaces;
+
+    Workspace make_workspace() const {
+        if constexpr (DOFs == 0) {
+            return {InputParameter<DOFs, MaxDOFs>(degrees_of_freedom), Trajectory<DOFs, MaxDOFs>(degrees_of_freedom)};
+        } else {
+            return {};
+        }
+    }
+
+    //! Gather the input of a candidate from the SoA buffers
+    void gather(size_t candidate, InputParameter<DOFs, MaxDOFs>& input) const {
+        for (size_t dof = 0; dof < degrees_of_freedom; ++dof) {
+            const size_t i = dof * size() + candidate;
+            input.current_position[dof] = current_positions[i];
+            input.current_velocity[dof] = current_velocities[i];
+            input.current_acceleration[dof] = current_accelerations[i];
+            input.target_position[dof] = target_positions[i];
+            input.target_velocity[dof] = target_velocities[i];
+            input.target_acceleration[dof] = target_accelerations[i];
+            input.max_velocity[dof] = max_velocities[i];
+            input.max_acceleration[dof] = max_accelerations[i];
+            input.max_jerk[dof] = max_jerks[i];
+        }
+    }
+
+    //! Evaluate a single candidate, only from the buffers and the given workspace
+    void evaluate_candidate(size_t candidate, Workspace& workspace) {
+        gather(candidate, workspace.input);
+
+        durations[candidate] = std::numeric_limits<double>::infinity();
+        if (!otg.validate_input(workspace.input)) {
+            results[candidate] = Result::ErrorInvalidInput;
+            return;
+        }
+
+        results[candidate] = workspace.trajectory.template calculate_min_duration<false, true>(workspace.input, otg.delta_time);
+        if (results[candidate] == Result::Working) {
+            durations[candidate] = workspace.trajectory.get_duration();
+        }
+    }
+
+public:
+    size_t degrees_of_freedom;
+
+    //! Optional pool of worker threads to evaluate the candidates in parallel (not owned)
+    WorkerPool* worker_pool {nullptr};
+
+    //! Inputs of each candidate and DoF, indexed by `dof * size() + candidate`
+    std::vector<double> current_positions, current_velocities, current_accelerations;
+    std::vector<double> target_positions, target_velocities, target_accelerations;
+    std::vector<double> max_velocities, max_accelerations, max_jerks;
+
+    //! Minimal duration of each candidate, infinity for invalid inputs and failed calculations
+    std::vector<double> durations;
+
+    //! Result of the evaluation of each candidate
+    std::vector<Result> results;
+
+    template <size_t D = DOFs, typename std::enable_if<D >= 1, int>::type = 0>
+    explicit CandidateBatch(size_t number_candidates): degrees_of_freedom(DOFs) {
+        resize(number_candidates);
+    }
+
+    template <size_t D = DOFs, typename std::enable_if<D == 0, int>::type = 0>
+    explicit CandidateBatch(size_t number_candidates, size_t dofs): otg(dofs), degrees_of_freedom(dofs) {
+        resize(number_candidates);
+    }
+
+    //! Allocate all buffers for the given number of candidates, the values of the inputs are not kept
+    void resize(size_t number_candidates) {
+        for (auto* buffer: {&current_positions, &current_velocities, &current_accelerations, &target_positions, &target_velocities, &target_accelerations, &max_velocities, &max_accelerations, &max_jerks}) {
+            buffer->resize(degrees_of_freedom * number_candidates);
+        }
+        durations.resize(number_candidates);
+        results.resize(number_candidates);
+    }
+
+    //! Number of candidates
+    size_t size() const {
+        return durations.size();
+    }
+
+    //! Evaluate the minimal duration of all candidates
+    void evaluate() {
+        const size_t number_threads = worker_pool ? worker_pool->number_threads() : 1;
+        if (workspaces.size() < number_threads) {
+            workspaces.resize(number_threads, make_workspace());
+        }
+
+        if (number_threads == 1) {
+            for (size_t candidate = 0; candidate < size(); ++candidate) {
+                evaluate_candidate(candidate, workspaces[0]);
+            }
+            return;
+        }
+
+        const size_t chunk_size = (size() + number_threads - 1) / number_threads;
+        worker_pool->run([this, chunk_size](size_t chunk) {
+            const size_t begin = std::min(chunk * chunk_size, size());
+            const size_t end = std::min(begin + chunk_size, size());
+            for (size_t candidate = begin; candidate < end; ++candidate) {
+                evaluate_candidate(candidate, workspaces[chunk]);
+            }
+        });
+    }
+
+    //! Calculate the exact trajectory of a candidate, e.g. of the chosen one
+    Result calculate(size_t candidate, Trajectory<DOFs, MaxDOFs>& trajectory) {
+        if (workspaces.empty()) {
+            workspaces.push_back(make_workspace());
+        }
+
+        gather(candidate, workspaces[0].input);
+        return otg.calculate(workspaces[0].input, trajectory);
+    }
+};
+
+} // namespace ruckig
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+
+
+namespace ruckig {
+
+//! Counters of the profile cases that the calculations hit (only with Instrumentation::Cases)
+
+//! Every finished calculation of a single trajectory is counted, cache hits and the sections of waypoint
+//! trajectories are not. The counters of the final profiles are indexed by Profile::Limits and Profile::JerkSigns.
+struct CaseStatistics {
+    //! Number of finished calculations
+    uint64_t calculations {0};
+
+    //! Limits and jerk signs of the final profile of each enabled DoF, for the position and the velocity interface
+    std::array<uint64_t, 8> position_limits {}, velocity_limits {};
+    std::array<uint64_t, 2> position_jerk_signs {}, velocity_jerk_signs {};
+
+    //! Step 1 calculations in the position interface, and how many of them needed the two-step numerical fallbacks
+    uint64_t position_step1 {0}, position_step1_two_step {0};
+
+    //! Profile cases evaluated by Step 1 in the position interface in total (without the two-step fallbacks)
+    uint64_t position_step1_cases {0};
+
+    //! Step 2 calculations, i.e. the DoFs that could not be synchronized by a profile of Step 1
+    uint64_t step2 {0};
+
+    //! DoFs in the position interface whose Step 1 or Step 2 was only solved in normalized units (for numerical issues)
+    uint64_t normalized {0};
+
+    //! Histogram of the number of synchronization candidates that were tried until one was not blocked (the last bin
+    //! counts all larger numbers). Calculations of a single DoF without a minimum duration need no synchronization.
+    std::array<uint64_t, 8> synchronization_candidates {};
+
+    void reset() {
+        *this = CaseStatistics();
+    }
+
+    CaseStatistics& operator+=(const CaseStatistics& rhs) {
+        const auto add = [](auto& lhs_values, const auto& rhs_values) {
+            for (size_t i = 0; i < lhs_values.size(); ++i) {
+                lhs_values[i] += rhs_values[i];
+            }
+        };
+
+        calculations += rhs.calculations;
+        add(position_limits, rhs.position_limits);
+        add(velocity_limits, rhs.velocity_limits);
+        add(position_jerk_signs, rhs.position_jerk_signs);
+        add(velocity_jerk_signs, rhs.velocity_jerk_signs);
+        position_step1 += rhs.position_step1;
+        position_step1_two_step += rhs.position_step1_two_step;
+        position_step1_cases += rhs.position_step1_cases;
+        step2 += rhs.step2;
+        normalized += rhs.normalized;
+        add(synchronization_candidates, rhs.synchronization_candidates);
+        return *this;
+    }
+};
+
+} // namespace ruckig
@@ -0,0 +1,174 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <limits>
+#include <stdexcept>
+#include <tuple>
+#include <type_traits>
+
+#include <ruckig/profile.hpp>
+#include <ruckig/trajectory.hpp>
+
+
+namespace ruckig {
+
+//! Compact storage of the executable part of a trajectory, e.g. for archives or large caches of calculated trajectories
+
+//! Only the segment durations, the jerks, and the initial and final states are stored for each DoF, as well as the two
+//! segments and the initial state of its brake sub-profile. The cumulative times and the states at the segment
+//! boundaries are integrated again on restore. With float as storage type, the memory is halved once more compared to
+//! double. The profiles are reconstructed up to `error`, the maximal deviation of any segment boundary (in seconds) or
+//! state (in the units of the DoF) from the original trajectory, which is checked on assignment.
+template<size_t DOFs, size_t MaxDOFs = 0, class Real = double>
+class CompactTrajectory {
+    static_assert(std::is_floating_point<Real>::value, "[ruckig] the storage type needs to be a floating point type.");
+
+    struct Record {
+        std::array<Real, 7> t, j;
+        std::array<Real, 3> initial_state, final_state; // Position, velocity, and acceleration
+        std::array<Real, 2> brake_t, brake_j;
+        std::array<Real, 3> brake_initial_state;
+        Real brake_duration;
+    };
+
+    template<class T> using Vector = DOFsVector<T, DOFs, MaxDOFs>;
+
+    Vector<Record> records;
+    double duration {0.0};
+
+    static void compress(const Profile& p, Record& r) {
+        const bool has_profile = (p.t_sum[6] > 0.0); // Disabled DoFs only keep their final state
+        for (size_t i = 0; i < 7; ++i) {
+            r.t[i] = has_profile ? static_cast<Real>(p.t[i]) : Real(0);
+            r.j[i] = has_profile ? static_cast<Real>(p.j[i]) : Real(0);
+        }
+        r.final_state = {static_cast<Real>(p.pf), static_cast<Real>(p.vf), static_cast<Real>(p.af)};
+        r.initial_state = has_profile ? std::array<Real, 3> {static_cast<Real>(p.p[0]), static_cast<Real>(p.v[0]), static_cast<Real>(p.a[0])} : r.final_state;
+
+        const bool has_brake = (p.brake.duration > 0.0);
+        r.brake_duration = has_brake ? static_cast<Real>(p.brake.duration) : Real(0);
+        for (size_t i = 0; i < 2; ++i) {
+            r.brake_t[i] = has_brake ? static_cast<Real>(p.brake.t[i]) : Real(0);
+            r.brake_j[i] = has_brake ? static_cast<Real>(p.brake.j[i]) : Real(0);
+        }
+        r.brake_initial_state = has_brake ? std::array<Real, 3> {static_cast<Real>(p.brake.p[0]), static_cast<Real>(p.brake.v[0]), static_cast<Real>(p.brake.a[0])} : std::array<Real, 3> {};
+    }
+
+    static void decompress(const Record& r, Profile& p) {
+        for (size_t i = 0; i < 7; ++i) {
+            p.t[i] = r.t[i];
+            p.j[i] = r.j[i];
+        }
+        p.t_sum[0] = p.t[0];
+        for (size_t i = 0; i < 6; ++i) {
+            p.t_sum[i+1] = p.t_sum[i] + p.t[i+1];
+        }
+
+        std::tie(p.p[0], p.v[0], p.a[0]) = std::make_tuple(r.initial_state[0], r.initial_state[1], r.initial_state[2]);
+        for (size_t i = 0; i < 7; ++i) {
+            std::tie(p.p[i+1], p.v[i+1], p.a[i+1]) = Profile::integrate(p.t[i], p.p[i], p.v[i], p.a[i], p.j[i]);
+        }
+        std::tie(p.pf, p.vf, p.af) = std::make_tuple(r.final_state[0], r.final_state[1], r.final_state[2]);
+
+        p.brake.duration = r.brake_duration;
+        for (size_t i = 0; i < 2; ++i) {
+            p.brake.t[i] = r.brake_t[i];
+            p.brake.j[i] = r.brake_j[i];
+        }
+        std::tie(p.brake.p[0], p.brake.v[0], p.brake.a[0]) = std::make_tuple(r.brake_initial_state[0], r.brake_initial_state[1], r.brake_initial_state[2]);
+        std::tie(p.brake.p[1], p.brake.v[1], p.brake.a[1]) = Profile::integrate(p.brake.t[0], p.brake.p[0], p.brake.v[0], p.brake.a[0], p.brake.j[0]);
+    }
+
+    //! Maximal deviation of the boundaries and states of a reconstructed profile from the original
+    static double deviation(const Profile& original, const Profile& p) {
+        double result = std::max({std::abs(p.pf - original.pf), std::abs(p.vf - original.vf), std::abs(p.af - original.af)});
+        if (original.t_sum[6] > 0.0) {
+            for (size_t i = 0; i < 7; ++i) {
+                result = std::max({result, std::abs(p.t_sum[i] - original.t_sum[i]), std::abs(p.p[i+1] - original.p[i+1]), std::abs(p.v[i+1] - original.v[i+1]), std::abs(p.a[i+1] - original.a[i+1])});
+            }
+            result = std::max({result, std::abs(p.p[0] - original.p[0]), std::abs(p.v[0] - original.v[0]), std::abs(p.a[0] - original.a[0])});
+        }
+        if (original.brake.duration > 0.0) {
+            result = std::max({result, std::abs(p.brake.duration - original.brake.duration), std::abs(p.brake.t[0] - original.brake.t[0])});
+            for (size_t i = 0; i < 2 && original.brake.t[i] > 0; ++i) {
+                result = std::max({result, std::abs(p.brake.p[i] - original.brake.p[i]), std::abs(p.brake.v[i] - original.brake.v[i]), std::abs(p.brake.a[i] - original.brake.a[i])});
+            }
+        }
+        return std::isnan(result) ? std::numeric_limits<double>::infinity() : result;
+    }
+
+public:
+    size_t degrees_of_freedom;
+
+    //! Maximal deviation of the reconstruction from the last assigned trajectory
+    double error {0.0};
+
+    //! Storage per DoF in bytes, compared to sizeof(Profile) of the full trajectory
+    constexpr static size_t bytes_per_dof {sizeof(Record)};
+
+    template <size_t D = DOFs, typename std::enable_if<D >= 1, int>::type = 0>
+    CompactTrajectory(): degrees_of_freedom(DOFs) { }
+
+    template <size_t D = DOFs, typename std::enable_if<D == 0, int>::type = 0>
+    explicit CompactTrajectory(size_t dofs): degrees_of_freedom(dofs) {
+        records.resize(dofs);
+    }
+
+    //! Store a trajectory, returns false if its reconstruction deviates by more than the tolerance (e.g. to fall back
+    //! to double as storage type)
+    bool assign(const ExecutableTrajectory<DOFs, MaxDOFs>& trajectory, double tolerance = std::numeric_limits<double>::infinity()) {
+        if constexpr (DOFs == 0) {
+            if (trajectory.degrees_of_freedom != degrees_of_freedom) {
+                throw std::runtime_error("[ruckig] mismatch in degrees of freedom (vector size).");
+            }
+        }
+
+        duration = trajectory.duration;
+        error = 0.0;
+        Profile reconstruction;
+        for (size_t dof = 0; dof < degrees_of_freedom; ++dof) {
+            compress(trajectory.profiles[dof], records[dof]);
+            decompress(records[dof], reconstruction);
+            error = std::max(error, deviation(trajectory.profiles[dof], reconstruction));
+        }
+        return error <= tolerance;
+    }
+
+    //! Reconstruct the full profiles into the trajectory, e.g. to continue with its query methods
+    void restore(ExecutableTrajectory<DOFs, MaxDOFs>& trajectory) const {
+        if constexpr (DOFs == 0) {
+            if (trajectory.degrees_of_freedom != degrees_of_freedom) {
+                throw std::runtime_error("[ruckig] mismatch in degrees of freedom (vector size).");
+            }
+        }
+
+        trajectory.duration = duration;
+        for (size_t dof = 0; dof < degrees_of_freedom; ++dof) {
+            decompress(records[dof], trajectory.profiles[dof]);
+            trajectory.independent_min_durations[dof] = std::numeric_limits<double>::quiet_NaN(); // Not stored
+        }
+        trajectory.position_extrema.reset();
+        trajectory.kinematic_extrema.reset();
+        trajectory.segment_coefficients.reset();
+    }
+
+    //! Reconstruct into a full trajectory, whose calculation workspace is outdated afterwards
+    void restore(Trajectory<DOFs, MaxDOFs>& trajectory) const {
+        restore(static_cast<ExecutableTrajectory<DOFs, MaxDOFs>&>(trajectory));
+        for (auto& step1_input: trajectory.step1_inputs) {
+            step1_input.valid = false;
+        }
+        trajectory.has_step2_hints = false;
+        trajectory.calculation_stage = Trajectory<DOFs, MaxDOFs>::Stage::None;
+    }
+
+    //! Get the duration of the stored trajectory
+    double get_duration() const {
+        return duration;
+    }
+};
+
+} // namespace ruckig
@@ -0,0 +1,956 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <iterator>
+#include <limits>
+#include <numeric>
+#include <optional>
+#include <tuple>
+#include <type_traits>
+#include <vector>
+
+#include <ruckig/profile.hpp>
+#include <ruckig/roots.hpp>
+#include <ruckig/tracing.hpp>
+#include <ruckig/utils.hpp>
+#include <ruckig/worker_pool.hpp>
+
+
+namespace ruckig {
+
+// Forward declare alternative OTG algorithms for friend class
+template <size_t> class Reflexxes;
+template <size_t, size_t> class BatchRuckig;
+class TrajectorySerialization;
+
+
+//! Cached segments of each DoF for sampling a trajectory at ascending times without searching
+template<size_t DOFs, size_t MaxDOFs = 0>
+struct TrajectoryCursor {
+    template<class T> using Vector = DOFsVector<T, DOFs, MaxDOFs>;
+
+    //! Current segment for each DoF: 0-1 for the brake trajectory, 2-8 for the profile, and 9 afterwards
+    Vector<size_t> segments;
+
+    //! Time of the last sample
+    double time {-std::numeric_limits<double>::infinity()};
+
+    template <size_t D = DOFs, typename std::enable_if<D >= 1, int>::type = 0>
+    TrajectoryCursor() {
+        reset();
+    }
+
+    template <size_t D = DOFs, typename std::enable_if<D == 0, int>::type = 0>
+    TrajectoryCursor(size_t dofs) {
+        segments.resize(dofs);
+        reset();
+    }
+
+    //! Restart the cursor at the beginning of a trajectory
+    void reset() {
+        std::fill(segments.begin(), segments.end(), 0);
+        time = -std::numeric_limits<double>::infinity();
+    }
+};
+
+
+template<size_t, size_t> class ExecutableTrajectory;
+template<size_t, size_t> class FixedPointTrajectory;
+template<size_t, size_t> class TrajectorySegmentTable;
+template<size_t, size_t, class> class CompactTrajectory;
+
+
+//! Samples a trajectory at a fixed rate, advancing the current segment of each DoF incrementally
+
+//! The samples are at the times `i * delta_time` before the duration, followed by a last sample exactly at the
+//! duration. Each DoF keeps the polynomial coefficients of its current segment, which are reloaded from the profile at
+//! every segment boundary (so that errors do not accumulate), and each sample is a single polynomial evaluation.
+//! Can be used as a range, e.g. `for (const auto& sample: trajectory.sample(0.001)) { sample.position[0]; }`.
+template<size_t DOFs, size_t MaxDOFs = 0>
+class TrajectorySampler {
+    template<class T> using Vector = DOFsVector<T, DOFs, MaxDOFs>;
+
+public:
+    //! Polynomial of a segment of a profile relative to its start time
+    struct Segment {
+        size_t index; // 0-1 for the brake trajectory, 2-8 for the profile, and 9 afterwards
+        double start, end;
+        double p, v, a, j, a_2, j_2, j_6;
+    };
+
+private:
+    const ExecutableTrajectory<DOFs, MaxDOFs>* trajectory;
+    Vector<Segment> segments;
+    size_t step {0};
+    bool finished {false};
+
+    //! Load a segment from the precomputed segments of the trajectory if available, otherwise from its profile
+    void load(size_t dof, size_t index) {
+        if (const auto* coefficients = trajectory->segment_coefficients.get_if_ready()) {
+            segments[dof] = (*coefficients)[dof][index];
+        } else {
+            load(trajectory->profiles[dof], index, segments[dof]);
+        }
+    }
+
+    void evaluate() {
+        const double duration = trajectory->duration;
+        time = std::min(step * delta_time, duration);
+
+        for (size_t dof = 0; dof < segments.size(); ++dof) {
+            Segment& segment = segments[dof];
+            if (time >= duration && segment.index < 9) {
+                load(dof, 9);
+            }
+            while (time >= segment.end) {
+                load(dof, segment.index + 1);
+            }
+
+            const double t = time - segment.start;
+            position[dof] = segment.p + t * (segment.v + t * (segment.a_2 + t * segment.j_6));
+            velocity[dof] = segment.v + t * (segment.a + t * segment.j_2);
+            acceleration[dof] = segment.a + t * segment.j;
+        }
+    }
+
+public:
+    //! Load the segment with the given index (or the first segment of the profile afterwards that exists)
+    static void load(const Profile& profile, size_t index, Segment& segment) {
+        if (index <= 1 && !(profile.brake.duration > 0)) {
+            index = 2;
+        }
+
+        segment.index = index;
+        if (index <= 1) {
+            segment.start = (index == 0) ? 0.0 : profile.brake.t[0];
+            segment.end = (index == 0) ? profile.brake.t[0] : profile.brake.duration;
+            std::tie(segment.p, segment.v, segment.a, segment.j) = std::make_tuple(profile.brake.p[index], profile.brake.v[index], profile.brake.a[index], profile.brake.j[index]);
+
+        } else if (index <= 8) {
+            // The profile ends at t_sum[6] in any case, e.g. for a DoF without motion whose other times are outdated
+            const double brake_duration = (profile.brake.duration > 0) ? profile.brake.duration : 0.0;
+            segment.start = brake_duration + ((index > 2) ? std::min(profile.t_sum[6], profile.t_sum[index - 3]) : 0.0);
+            segment.end = brake_duration + std::min(profile.t_sum[6], profile.t_sum[index - 2]);
+            std::tie(segment.p, segment.v, segment.a, segment.j) = std::make_tuple(profile.p[index - 2], profile.v[index - 2], profile.a[index - 2], profile.j[index - 2]);
+
+        } else {
+            // Keep constant acceleration
+            segment.start = profile.brake.duration + profile.t_sum[6];
+            segment.end = std::numeric_limits<double>::infinity();
+            std::tie(segment.p, segment.v, segment.a, segment.j) = std::make_tuple(profile.pf, profile.vf, profile.af, 0.0);
+        }
+
+        segment.a_2 = segment.a / 2;
+        segment.j_2 = segment.j / 2;
+        segment.j_6 = segment.j / 6;
+    }
+
+    //! Index of the first time step at or after the given time, robust against the rounding of the division
+    static size_t first_step_at(double time, double delta_time) {
+        size_t step = static_cast<size_t>(std::ceil(time / delta_time));
+        if (step > 0 && (step - 1) * delta_time >= time) {
+            step -= 1;
+        } else if (step * delta_time < time) {
+            step += 1;
+        }
+        return step;
+    }
+
+    //! Forward iterator over the samples, all iterators of a sampler share its current state
+    class Iterator {
+        TrajectorySampler* sampler;
+
+    public:
+        using iterator_category = std::input_iterator_tag;
+        using value_type = TrajectorySampler;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const TrajectorySampler*;
+        using reference = const TrajectorySampler&;
+
+        explicit Iterator(TrajectorySampler* sampler): sampler(sampler) { }
+
+        reference operator*() const { return *sampler; }
+        pointer operator->() const { return sampler; }
+
+        Iterator& operator++() {
+            if (!sampler->next()) {
+                sampler = nullptr;
+            }
+            return *this;
+        }
+
+        bool operator==(const Iterator& rhs) const { return sampler == rhs.sampler; }
+        bool operator!=(const Iterator& rhs) const { return sampler != rhs.sampler; }
+    };
+
+    //! Time step between samples in [s]
+    const double delta_time;
+
+    //! Time and kinematic state of the current sample
+    double time {0.0};
+    Vector<double> position, velocity, acceleration;
+
+    explicit TrajectorySampler(const ExecutableTrajectory<DOFs, MaxDOFs>& trajectory, double delta_time): trajectory(&trajectory), delta_time(delta_time) {
+        if (!(delta_time > 0.0)) {
+            throw std::runtime_error("[ruckig] the sampling time step needs to be positive.");
+        }
+
+        if constexpr (DOFs == 0) {
+            segments.resize(trajectory.degrees_of_freedom);
+            position.resize(trajectory.degrees_of_freedom);
+            velocity.resize(trajectory.degrees_of_freedom);
+            acceleration.resize(trajectory.degrees_of_freedom);
+        }
+        reset();
+    }
+
+    //! Restart at the beginning of the trajectory
+    void reset() {
+        for (size_t dof = 0; dof < segments.size(); ++dof) {
+            load(dof, 0);
+        }
+        step = 0;
+        finished = false;
+        evaluate();
+    }
+
+    //! Advance to the next sample, returns false if the current sample was the last one (at the duration)
+    bool next() {
+        if (finished || time >= trajectory->duration) {
+            finished = true;
+            return false;
+        }
+
+        step += 1;
+        evaluate();
+        return true;
+    }
+
+    //! Number of samples in total
+    size_t size() const {
+        return first_step_at(trajectory->duration, delta_time) + 1;
+    }
+
+    Iterator begin() {
+        return Iterator {finished ? nullptr : this};
+    }
+
+    Iterator end() {
+        return Iterator {nullptr};
+    }
+};
+
+
+//! Executable part of a trajectory, i.e. what is needed to sample and query it without the calculation workspace
+
+//! It can be copied from a Trajectory (e.g. `ExecutableTrajectory<6> executable = trajectory;`), so that storing and
+//! copying many calculated trajectories costs a fraction of the memory.
+template<size_t DOFs, size_t MaxDOFs = 0>
+class ExecutableTrajectory {
+    // Allow alternative OTG algorithms to directly access members (i.e. duration)
+    friend class Reflexxes<DOFs>;
+    friend class BatchRuckig<DOFs, MaxDOFs>;
+    friend class TrajectorySerialization;
+    friend class TrajectorySampler<DOFs, MaxDOFs>;
+    friend class FixedPointTrajectory<DOFs, MaxDOFs>;
+    friend class TrajectorySegmentTable<DOFs, MaxDOFs>;
+    template<size_t, size_t, class> friend class CompactTrajectory;
+
+protected:
+    template<class T> using Vector = DOFsVector<T, DOFs, MaxDOFs>;
+
+    // Set of current profiles for each DoF
+    Vector<Profile> profiles;
+
+    double duration {0.0};
+    Vector<double> independent_min_durations;
+
+    LazyValue<Vector<PositionExtrema>> position_extrema; // Calculated on the first query
+    LazyValue<Vector<KinematicExtrema>> kinematic_extrema; // Calculated on the first query
+    LazyValue<Vector<std::array<typename TrajectorySampler<DOFs, MaxDOFs>::Segment, 10>>> segment_coefficients; // Calculated on the first query
+
+    //! Get the segment of a single DoF without branches, by counting the passed brake and profile boundaries
+
+    //! Returns the same segment, relative time, initial state and jerk as segment_at_time. Both the compare-and-sum
+    //! and the selection of the initial state compile to conditional moves, so that no branch mispredicts at the
+    //! segment boundaries and a loop over many DoFs can be vectorized.
+    static void find_segment(const Profile& p, double time, size_t& segment, double& t, double& p0, double& v0, double& a0, double& j) {
+        const bool has_brake = (p.brake.duration > 0);
+        const double t_profile = time - (has_brake ? p.brake.duration : 0.0);
+
+        // A missing brake trajectory counts as passed for any time
+        constexpr double before_all = -std::numeric_limits<double>::infinity();
+        segment = size_t(time >= (has_brake ? p.brake.t[0] : before_all)) + size_t(time >= (has_brake ? p.brake.duration : before_all));
+        for (size_t i = 0; i < 7; ++i) {
+            // The profile ends at t_sum[6] in any case, e.g. for a DoF without motion whose other times are outdated
+            segment += size_t(std::min(p.t_sum[6], p.t_sum[i]) <= t_profile);
+        }
+
+        const bool in_brake = (segment < 2), after = (segment == 9);
+        const size_t b = std::min<size_t>(segment, 1);
+        const size_t k = std::min<size_t>(std::max<size_t>(segment, 2) - 2, 6);
+        const double profile_start = (segment > 2) ? p.t_sum[std::max<size_t>(segment, 3) - 3] : 0.0;
+
+        t = in_brake ? time - ((b > 0) ? p.brake.t[0] : 0.0) : t_profile - profile_start;
+        p0 = in_brake ? p.brake.p[b] : (after ? p.pf : p.p[k]);
+        v0 = in_brake ? p.brake.v[b] : (after ? p.vf : p.v[k]);
+        a0 = in_brake ? p.brake.a[b] : (after ? p.af : p.a[k]);
+        j = in_brake ? p.brake.j[b] : (after ? 0.0 : p.j[k]);
+    }
+
+    //! Get the segment of a single DoF, walking forward from the given segment (see TrajectoryCursor)
+
+    //! Returns the time within the segment as well as its initial state and jerk, so that it can be integrated separately.
+    static void segment_at_time(const Profile& p, double t_diff, size_t& segment, double& t, double& p0, double& v0, double& a0, double& j) {
+        if (p.brake.duration > 0) {
+            if (t_diff < p.brake.duration) {
+                segment = (t_diff < p.brake.t[0]) ? 0 : 1;
+                if (segment > 0) {
+                    t_diff -= p.brake.t[segment - 1];
+                }
+
+                t = t_diff;
+                p0 = p.brake.p[segment];
+                v0 = p.brake.v[segment];
+                a0 = p.brake.a[segment];
+                j = p.brake.j[segment];
+                return;
+            } else {
+                t_diff -= p.brake.duration;
+            }
+        }
+
+        // Non-time synchronization
+        if (t_diff >= p.t_sum[6]) {
+            // Keep constant acceleration
+            segment = 9;
+            t = t_diff - p.t_sum[6];
+            p0 = p.pf;
+            v0 = p.vf;
+            a0 = p.af;
+            j = 0.0;
+            return;
+        }
+
+        // Same section as std::upper_bound, as t_sum is sorted and the time only moves forward
+        size_t index = (segment >= 2 && segment <= 8) ? segment - 2 : 0;
+        while (p.t_sum[index] <= t_diff) {
+            ++index;
+        }
+        segment = index + 2;
+
+        if (index > 0) {
+            t_diff -= p.t_sum[index - 1];
+        }
+
+        t = t_diff;
+        p0 = p.p[index];
+        v0 = p.v[index];
+        a0 = p.a[index];
+        j = p.j[index];
+    }
+
+    //! Get the state of a single DoF, walking forward from the given segment (see TrajectoryCursor)
+    static void state_at_time(const Profile& p, double t_diff, size_t& segment, double& new_position, double& new_velocity, double& new_acceleration) {
+        double t, p0, v0, a0, j;
+        segment_at_time(p, t_diff, segment, t, p0, v0, a0, j);
+        std::tie(new_position, new_velocity, new_acceleration) = Profile::integrate(t, p0, v0, a0, j);
+    }
+
+    using Segment = typename TrajectorySampler<DOFs, MaxDOFs>::Segment;
+
+    //! Evaluate the precomputed polynomial of a segment, with multiply-adds only
+    static void evaluate(const Segment& s, double time, double& new_position, double& new_velocity, double& new_acceleration) {
+        const double t = time - s.start;
+        new_position = s.p + t * (s.v + t * (s.a_2 + t * s.j_6));
+        new_velocity = s.v + t * (s.a + t * s.j_2);
+        new_acceleration = s.a + t * s.j;
+    }
+
+    //! Get the state of a single DoF from its precomputed segments, walking forward from the given segment
+    static void state_at_time(const std::array<Segment, 10>& segments, double time, size_t& segment, double& new_position, double& new_velocity, double& new_acceleration) {
+        while (segment < 9 && segments[segment + 1].start <= time) {
+            ++segment;
+        }
+        evaluate(segments[segment], time, new_position, new_velocity, new_acceleration);
+    }
+
+    //! Call the function with each segment of the profile until the duration, and the duration of the segment until then
+    template<class F>
+    void for_each_segment(const Profile& profile, const F& function) const {
+        Segment segment;
+        TrajectorySampler<DOFs, MaxDOFs>::load(profile, 0, segment);
+        while (segment.start <= duration) {
+            const double segment_duration = std::min(segment.end, duration) - segment.start;
+            if (segment_duration > 0.0 || (segment.index == 9 && duration == 0.0)) {
+                function(segment, segment_duration);
+            }
+
+            if (segment.index == 9) {
+                break;
+            }
+            TrajectorySampler<DOFs, MaxDOFs>::load(profile, segment.index + 1, segment);
+        }
+    }
+
+    //! Extend the range by the positions of the segment within [t_start, t_end] (relative to the segment start)
+    static void add_position_range(const Segment& s, double t_start, double t_end, double& min, double& max) {
+        const auto add = [&](double t) {
+            const double position = s.p + t * (s.v + t * (s.a_2 + t * s.j_6));
+            min = std::min(min, position);
+            max = std::max(max, position);
+        };
+
+        add(t_start);
+        add(t_end);
+        for (const double t: Roots::solveCub(0.0, s.j_2, s.a, s.v)) {
+            if (t_start < t && t < t_end) {
+                add(t);
+            }
+        }
+    }
+
+    //! Add the crossings of the sorted thresholds within the given duration of the segment
+
+    //! The segment is split into intervals of monotonic position, and each threshold within the position range of an
+    //! interval has a single root there. Crossings up to the end of the last contact (per threshold) are skipped, so
+    //! that boundaries between intervals and phases of standstill are reported once.
+    static void add_position_crossings(const Segment& s, double segment_duration, size_t dof, const std::vector<double>& positions, const std::vector<size_t>& order, std::vector<double>& last_contacts, std::vector<PositionCrossing>& crossings) {
+        std::array<double, 4> boundaries;
+        size_t number_boundaries {0};
+        boundaries[number_boundaries++] = 0.0;
+        for (const double t: Roots::solveCub(0.0, s.j_2, s.a, s.v)) {
+            if (0.0 < t && t < segment_duration) {
+                boundaries[number_boundaries++] = t;
+            }
+        }
+        std::sort(boundaries.begin() + 1, boundaries.begin() + number_boundaries);
+        boundaries[number_boundaries++] = segment_duration;
+
+        const auto position_at = [&s](double t) { return s.p + t * (s.v + t * (s.a_2 + t * s.j_6)); };
+        const auto less = [&positions](size_t k, double value) { return positions[k] < value; };
+
+        for (size_t b = 0; b + 1 < number_boundaries; ++b) {
+            const double t_low = boundaries[b], t_high = boundaries[b + 1];
+            const double p_low = position_at(t_low), p_high = position_at(t_high);
+
+            const auto first = std::lower_bound(order.begin(), order.end(), std::min(p_low, p_high), less);
+            for (auto it = first; it != order.end() && positions[*it] <= std::max(p_low, p_high); ++it) {
+                const size_t k = *it;
+                double t, t_contact_end;
+                if (p_low == p_high) {
+                    // Standstill at the threshold
+                    t = t_low;
+                    t_contact_end = t_high;
+                } else {
+                    t = Roots::shrinkInterval<4>({s.j_6, s.a_2, s.v, s.p - positions[k]}, t_low, t_high);
+                    t_contact_end = t;
+                }
+
+                if (s.start + t <= last_contacts[k] + 1e-12) {
+                    last_contacts[k] = std::max(last_contacts[k], s.start + t_contact_end);
+                    continue;
+                }
+
+                crossings.push_back({dof, k, s.start + t, s.v + t * (s.a + t * s.j_2)});
+                last_contacts[k] = s.start + t_contact_end;
+            }
+        }
+    }
+
+public:
+    size_t degrees_of_freedom;
+
+    template <size_t D = DOFs, typename std::enable_if<D >= 1, int>::type = 0>
+    ExecutableTrajectory(): degrees_of_freedom(DOFs) { }
+
+    template <size_t D = DOFs, typename std::enable_if<D == 0, int>::type = 0>
+    ExecutableTrajectory(size_t dofs): position_extrema(Vector<PositionExtrema>(dofs)), kinematic_extrema(Vector<KinematicExtrema>(dofs)), segment_coefficients(Vector<std::array<Segment, 10>>(dofs)), degrees_of_freedom(dofs) {
+        profiles.resize(dofs);
+        independent_min_durations.resize(dofs);
+    }
+
+    //! Get the kinematic state at a given time
+
+    //! The Python wrapper takes `time` as an argument, and returns `new_position`, `new_velocity`, and `new_acceleration` instead.
+    void at_time(double time, Vector<double>& new_position, Vector<double>& new_velocity, Vector<double>& new_acceleration, size_t& new_section) const {
+        const TraceScope trace {TracePoint::AtTime};
+        if constexpr (DOFs == 0) {
+            if (degrees_of_freedom != new_position.size() || degrees_of_freedom != new_velocity.size() || degrees_of_freedom != new_acceleration.size()) {
+                throw std::runtime_error("[ruckig] mismatch in degrees of freedom (vector size).");
+            }
+        }
+
+        if (time >= duration) {
+            // Keep constant acceleration
+            new_section = 1;
+            for (size_t dof = 0; dof < profiles.size(); ++dof) {
+                const double t_diff = time - (profiles[dof].brake.duration + profiles[dof].t_sum[6]);
+                std::tie(new_position[dof], new_velocity[dof], new_acceleration[dof]) = Profile::integrate(t_diff, profiles[dof].pf, profiles[dof].vf, profiles[dof].af, 0);
+            }
+            return;
+        }
+
+        new_section = 0;
+        if (const auto* coefficients = segment_coefficients.get_if_ready()) {
+            for (size_t dof = 0; dof < profiles.size(); ++dof) {
+                // Count the passed segments as in find_segment
+                const auto& segments = (*coefficients)[dof];
+                size_t segment {0};
+                for (size_t k = 1; k < 10; ++k) {
+                    segment += size_t(segments[k].start <= time);
+                }
+                evaluate(segments[segment], time, new_position[dof], new_velocity[dof], new_acceleration[dof]);
+            }
+            return;
+        }
+
+        for (size_t dof = 0; dof < profiles.size(); ++dof) {
+            size_t segment;
+            double t, p0, v0, a0, j;
+            find_segment(profiles[dof], time, segment, t, p0, v0, a0, j);
+            std::tie(new_position[dof], new_velocity[dof], new_acceleration[dof]) = Profile::integrate(t, p0, v0, a0, j);
+        }
+    }
+
+    //! Get the kinematic state and current section at a given time
+    void at_time(double time, Vector<double>& new_position, Vector<double>& new_velocity, Vector<double>& new_acceleration) const {
+        size_t new_section;
+        at_time(time, new_position, new_velocity, new_acceleration, new_section);
+    }
+
+    //! Get the kinematic state at a given time, continuing the segment search of the cursor for ascending times
+    void at_time(double time, Vector<double>& new_position, Vector<double>& new_velocity, Vector<double>& new_acceleration, size_t& new_section, TrajectoryCursor<DOFs, MaxDOFs>& cursor) const {
+        const TraceScope trace {TracePoint::AtTime};
+        if constexpr (DOFs == 0) {
+            if (degrees_of_freedom != new_position.size() || degrees_of_freedom != new_velocity.size() || degrees_of_freedom != new_acceleration.size() || degrees_of_freedom != cursor.segments.size()) {
+                throw std::runtime_error("[ruckig] mismatch in degrees of freedom (vector size).");
+            }
+        }
+
+        if (time < cursor.time) {
+            std::fill(cursor.segments.begin(), cursor.segments.end(), 0);
+        }
+        cursor.time = time;
+
+        if (time >= duration) {
+            // Keep constant acceleration
+            new_section = 1;
+            for (size_t dof = 0; dof < profiles.size(); ++dof) {
+                const double t_diff = time - (profiles[dof].brake.duration + profiles[dof].t_sum[6]);
+                cursor.segments[dof] = 9;
+                std::tie(new_position[dof], new_velocity[dof], new_acceleration[dof]) = Profile::integrate(t_diff, profiles[dof].pf, profiles[dof].vf, profiles[dof].af, 0);
+            }
+            return;
+        }
+
+        new_section = 0;
+        if (const auto* coefficients = segment_coefficients.get_if_ready()) {
+            for (size_t dof = 0; dof < profiles.size(); ++dof) {
+                state_at_time((*coefficients)[dof], time, cursor.segments[dof], new_position[dof], new_velocity[dof], new_acceleration[dof]);
+            }
+            return;
+        }
+
+        for (size_t dof = 0; dof < profiles.size(); ++dof) {
+            state_at_time(profiles[dof], time, cursor.segments[dof], new_position[dof], new_velocity[dof], new_acceleration[dof]);
+        }
+    }
+
+    //! Get the kinematic states at multiple times
+
+    //! The states are written row-major into caller-provided buffers of size `number_times * degrees_of_freedom`, so that
+    //! e.g. `new_positions[i * degrees_of_freedom + dof]` is the position of the DoF at `times[i]`. For ascending times,
+    //! the section of each profile is searched forward from the previous time instead of from the beginning.
+    void at_times(const double* times, size_t number_times, double* new_positions, double* new_velocities, double* new_accelerations) const {
+        const auto* coefficients = segment_coefficients.get_if_ready();
+        for (size_t dof = 0; dof < profiles.size(); ++dof) {
+            const Profile& p = profiles[dof];
+            const double t_end = p.brake.duration + p.t_sum[6];
+
+            size_t segment {0};
+            double last_time {-std::numeric_limits<double>::infinity()};
+            for (size_t i = 0; i < number_times; ++i) {
+                const double time = times[i];
+                const size_t offset = i * degrees_of_freedom + dof;
+
+                if (time < last_time) {
+                    segment = 0;
+                }
+                last_time = time;
+
+                if (time >= duration) {
+                    // Keep constant acceleration
+                    segment = 9;
+                    std::tie(new_positions[offset], new_velocities[offset], new_accelerations[offset]) = Profile::integrate(time - t_end, p.pf, p.vf, p.af, 0);
+                    continue;
+                }
+
+                if (coefficients) {
+                    state_at_time((*coefficients)[dof], time, segment, new_positions[offset], new_velocities[offset], new_accelerations[offset]);
+                } else {
+                    state_at_time(p, time, segment, new_positions[offset], new_velocities[offset], new_accelerations[offset]);
+                }
+            }
+        }
+    }
+
+    //! Get the kinematic states at multiple times, resizing the given vectors to `times.size() * degrees_of_freedom`
+    void at_times(const std::vector<double>& times, std::vector<double>& new_positions, std::vector<double>& new_velocities, std::vector<double>& new_accelerations) const {
+        new_positions.resize(times.size() * degrees_of_freedom);
+        new_velocities.resize(times.size() * degrees_of_freedom);
+        new_accelerations.resize(times.size() * degrees_of_freedom);
+        at_times(times.data(), times.size(), new_positions.data(), new_velocities.data(), new_accelerations.data());
+    }
+
+    //! Sample the trajectory at a fixed rate from the beginning, see TrajectorySampler
+
+    //! The trajectory needs to outlive the sampler.
+    TrajectorySampler<DOFs, MaxDOFs> sample(double delta_time) const {
+        return TrajectorySampler<DOFs, MaxDOFs>(*this, delta_time);
+    }
+
+    //! Number of samples at a fixed rate, the same as of sample(delta_time)
+    size_t number_samples(double delta_time) const {
+        return TrajectorySampler<DOFs, MaxDOFs>::first_step_at(duration, delta_time) + 1;
+    }
+
+    //! Sample the trajectory at a fixed rate into caller-provided buffers, optionally in parallel on a worker pool
+
+    //! The samples are the same as of sample(delta_time), and are written row-major into buffers of size
+    //! `number_samples(delta_time) * degrees_of_freedom` as for at_times. Each thread samples a contiguous range of
+    //! the samples, so that it writes (and on first touch, allocates) its own part of the buffers only, e.g. on its own
+    //! NUMA node. Within its range, the segments of each DoF are found once and then walked forward. Returns the number of
+    //! samples, or zero if the time step is not positive.
+    size_t sample_into(double delta_time, double* new_positions, double* new_velocities, double* new_accelerations, WorkerPool* pool = nullptr) const {
+        if (!(delta_time > 0.0)) {
+            return 0;
+        }
+
+        using Segment = typename TrajectorySampler<DOFs, MaxDOFs>::Segment;
+        const auto* coefficients = segment_coefficients.get_if_ready();
+        const size_t size = number_samples(delta_time);
+
+        const auto sample_range = [&](size_t begin, size_t end) {
+            if (begin >= end) {
+                return;
+            }
+
+            const auto load = [this, coefficients](size_t dof, size_t index, Segment& segment) {
+                if (coefficients) {
+                    segment = (*coefficients)[dof][index];
+                } else {
+                    TrajectorySampler<DOFs, MaxDOFs>::load(profiles[dof], index, segment);
+                }
+            };
+
+            // The first segments are found once, afterwards the segments are walked forward
+            Vector<Segment> segments;
+            if constexpr (DOFs == 0) {
+                segments.resize(degrees_of_freedom);
+            }
+            for (size_t dof = 0; dof < profiles.size(); ++dof) {
+                size_t index;
+                double t, p0, v0, a0, j;
+                find_segment(profiles[dof], std::min(begin * delta_time, duration), index, t, p0, v0, a0, j);
+                load(dof, index, segments[dof]);
+            }
+
+            for (size_t i = begin; i < end; ++i) {
+                const double time = std::min(i * delta_time, duration);
+                for (size_t dof = 0; dof < profiles.size(); ++dof) {
+                    Segment& segment = segments[dof];
+                    if (time >= duration && segment.index < 9) {
+                        load(dof, 9, segment);
+                    }
+                    while (time >= segment.end) {
+                        load(dof, segment.index + 1, segment);
+                    }
+
+                    const size_t offset = i * degrees_of_freedom + dof;
+                    const double t = time - segment.start;
+                    new_positions[offset] = segment.p + t * (segment.v + t * (segment.a_2 + t * segment.j_6));
+                    new_velocities[offset] = segment.v + t * (segment.a + t * segment.j_2);
+                    new_accelerations[offset] = segment.a + t * segment.j;
+                }
+            }
+        };
+
+        if (!pool || pool->number_threads() == 1) {
+            sample_range(0, size);
+            return size;
+        }
+
+        const size_t chunk_size = (size + pool->number_threads() - 1) / pool->number_threads();
+        pool->run([&sample_range, size, chunk_size](size_t chunk) {
+            const size_t begin = std::min(chunk * chunk_size, size);
+            sample_range(begin, std::min(begin + chunk_size, size));
+        });
+        return size;
+    }
+
+    //! Get the duration of the (synchronized) trajectory
+    double get_duration() const {
+        return duration;
+    }
+
+    //! Get the durations when the intermediate waypoints are reached
+    std::vector<double> get_intermediate_durations() const {
+        return {duration};
+    }
+
+    //! Get the minimum duration of each independent DoF
+    Vector<double> get_independent_min_durations() const {
+        return independent_min_durations;
+    }
+
+    //! Scale the time of the trajectory by a factor without recalculation, e.g. for a feed-rate override
+
+    //! The trajectory passes the same positions factor times as fast: the durations are divided by the factor, while
+    //! velocities, accelerations, and jerks are multiplied by the factor, its square, and its cube. This includes the
+    //! initial and target velocity and acceleration, so that the scaled trajectory starts in the same state only from
+    //! rest. For factors of at most 1, all kinematic limits of the trajectory still hold. Returns false (and keeps the
+    //! trajectory) if the factor is not positive and finite.
+    bool scale_time(double factor) {
+        if (!(factor > 0.0) || !std::isfinite(factor)) {
+            return false;
+        }
+
+        for (auto& profile: profiles) {
+            profile.scale_time(factor);
+        }
+        duration /= factor;
+        for (auto& independent_min_duration: independent_min_durations) {
+            independent_min_duration /= factor;
+        }
+        position_extrema.reset();
+        kinematic_extrema.reset();
+        segment_coefficients.reset();
+        return true;
+    }
+
+    //! Get a copy of the trajectory with its time scaled by a factor, see scale_time
+    ExecutableTrajectory time_scaled(double factor) const {
+        ExecutableTrajectory result {*this};
+        result.scale_time(factor);
+        return result;
+    }
+
+    //! Get the min/max values of the position for each DoF
+
+    //! They are calculated once on the first call after a new calculation, so that the trajectory can be queried concurrently.
+    const Vector<PositionExtrema>& get_position_extrema() const {
+        return position_extrema.get([this](Vector<PositionExtrema>& extrema) {
+            for (size_t dof = 0; dof < profiles.size(); ++dof) {
+                extrema[dof] = profiles[dof].get_position_extrema();
+            }
+        });
+    }
+
+    //! Get the min/max values of the velocity and acceleration for each DoF, calculated once as the position extrema
+    const Vector<KinematicExtrema>& get_kinematic_extrema() const {
+        return kinematic_extrema.get([this](Vector<KinematicExtrema>& extrema) {
+            for (size_t dof = 0; dof < profiles.size(); ++dof) {
+                extrema[dof] = profiles[dof].get_kinematic_extrema();
+            }
+        });
+    }
+
+    //! Does the trajectory stay within the given kinematic limits, e.g. after they were lowered?
+
+    //! The velocity and acceleration are compared with their extrema, and the jerk with the jerk of all segments with
+    //! a positive duration, each up to a tolerance of 1e-12. The minimal limits are the negative maximal limits if they
+    //! are not given. Invalid (e.g. NaN) limits are never satisfied.
+    bool is_within_limits(const Vector<double>& max_velocity, const Vector<double>& max_acceleration, const Vector<double>& max_jerk, const std::optional<Vector<double>>& min_velocity = std::nullopt, const std::optional<Vector<double>>& min_acceleration = std::nullopt) const {
+        constexpr double eps {1e-12};
+        const auto& extrema = get_kinematic_extrema();
+        for (size_t dof = 0; dof < profiles.size(); ++dof) {
+            const double v_min = min_velocity ? (*min_velocity)[dof] : -max_velocity[dof];
+            const double a_min = min_acceleration ? (*min_acceleration)[dof] : -max_acceleration[dof];
+            if (!(extrema[dof].max_velocity <= max_velocity[dof] + eps && extrema[dof].min_velocity >= v_min - eps
+                && extrema[dof].max_acceleration <= max_acceleration[dof] + eps && extrema[dof].min_acceleration >= a_min - eps)) {
+                return false;
+            }
+
+            const Profile& p = profiles[dof];
+            double jerk {0.0};
+            for (size_t i = 0; i < 7; ++i) {
+                jerk = (p.t[i] > 0.0) ? std::max(jerk, std::abs(p.j[i])) : jerk;
+            }
+            for (size_t i = 0; i < 2; ++i) {
+                jerk = (p.brake.t[i] > 0.0) ? std::max(jerk, std::abs(p.brake.j[i])) : jerk;
+            }
+            if (!(jerk <= max_jerk[dof] + eps)) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    //! Get the polynomial coefficients of the ten segments (two brake, seven profile, one afterwards) of each DoF
+
+    //! They are calculated once on the first call after a new calculation, as the extrema. Afterwards, at_time (also
+    //! with a cursor), at_times, and the TrajectorySampler evaluate them with multiply-adds only, instead of integrating
+    //! the profiles. The samples agree with the profiles up to the rounding of the relative times.
+    const Vector<std::array<Segment, 10>>& get_segment_coefficients() const {
+        return segment_coefficients.get([this](Vector<std::array<Segment, 10>>& coefficients) {
+            for (size_t dof = 0; dof < profiles.size(); ++dof) {
+                for (size_t k = 0; k < 10; ++k) {
+                    TrajectorySampler<DOFs, MaxDOFs>::load(profiles[dof], k, coefficients[dof][k]);
+                }
+            }
+        });
+    }
+
+    //! Get the bounding box of the positions of all DoFs within the time interval [t_start, t_end]
+
+    //! The bounds are calculated analytically from the boundaries and the extrema of all segments within the interval,
+    //! e.g. for a broad-phase collision check of consecutive intervals. Times after the duration are ignored.
+    void get_position_bounds(double t_start, double t_end, Vector<double>& min_position, Vector<double>& max_position) const {
+        if constexpr (DOFs == 0) {
+            min_position.resize(degrees_of_freedom);
+            max_position.resize(degrees_of_freedom);
+        }
+
+        t_start = std::max(t_start, 0.0);
+        t_end = std::min(t_end, duration);
+        for (size_t dof = 0; dof < profiles.size(); ++dof) {
+            double& min = min_position[dof];
+            double& max = max_position[dof];
+            min = std::numeric_limits<double>::infinity();
+            max = -std::numeric_limits<double>::infinity();
+
+            for_each_segment(profiles[dof], [&](const Segment& segment, double segment_duration) {
+                const double segment_end = segment.start + segment_duration;
+                if (segment_end >= t_start && segment.start <= t_end) {
+                    add_position_range(segment, std::max(t_start, segment.start) - segment.start, std::min(t_end, segment_end) - segment.start, min, max);
+                }
+            });
+        }
+    }
+
+    //! Bounding box of the positions of all DoFs within a time interval
+    struct PositionBox {
+        double t_start, t_end;
+        Vector<double> min_position, max_position;
+    };
+
+    //! Get the bounding boxes in between all segment boundaries of any DoF, so that they cover the trajectory tightly
+    void get_position_boxes(std::vector<PositionBox>& boxes) const {
+        std::vector<double> boundaries {0.0, duration};
+        for (const Profile& profile: profiles) {
+            for_each_segment(profile, [&](const Segment& segment, double) {
+                if (segment.start > 0.0 && segment.start < duration) {
+                    boundaries.push_back(segment.start);
+                }
+            });
+        }
+        std::sort(boundaries.begin(), boundaries.end());
+        boundaries.erase(std::unique(boundaries.begin(), boundaries.end()), boundaries.end());
+
+        boxes.resize(std::max<size_t>(boundaries.size(), 2) - 1);
+        for (size_t i = 0; i < boxes.size(); ++i) {
+            PositionBox& box = boxes[i];
+            box.t_start = boundaries[i];
+            box.t_end = boundaries[std::min(i + 1, boundaries.size() - 1)];
+            get_position_bounds(box.t_start, box.t_end, box.min_position, box.max_position);
+        }
+    }
+
+    //! Get all times within the duration at which a DoF reaches any of the given positions
+
+    //! The segments of the profile are scanned once for all thresholds, so that many thresholds cost little more
+    //! than one. Touching a threshold without passing it and standing still at it are reported once. The crossings
+    //! are appended to the given vector, sorted by time.
+    void get_position_crossings(size_t dof, const std::vector<double>& positions, std::vector<PositionCrossing>& crossings) const {
+        if (dof >= degrees_of_freedom) {
+            return;
+        }
+
+        std::vector<size_t> order(positions.size());
+        std::iota(order.begin(), order.end(), 0);
+        std::sort(order.begin(), order.end(), [&positions](size_t a, size_t b) { return positions[a] < positions[b]; });
+        std::vector<double> last_contacts(positions.size(), -std::numeric_limits<double>::infinity());
+
+        const size_t first_crossing = crossings.size();
+        for_each_segment(profiles[dof], [&](const Segment& segment, double segment_duration) {
+            add_position_crossings(segment, segment_duration, dof, positions, order, last_contacts, crossings);
+        });
+
+        std::sort(crossings.begin() + first_crossing, crossings.end(), [](const PositionCrossing& a, const PositionCrossing& b) { return a.time < b.time; });
+    }
+
+    //! Get all crossings of the thresholds of each DoF (with a list of positions per DoF), sorted by time
+    void get_position_crossings(const Vector<std::vector<double>>& positions, std::vector<PositionCrossing>& crossings) const {
+        crossings.clear();
+        for (size_t dof = 0; dof < degrees_of_freedom && dof < positions.size(); ++dof) {
+            get_position_crossings(dof, positions[dof], crossings);
+        }
+        std::stable_sort(crossings.begin(), crossings.end(), [](const PositionCrossing& a, const PositionCrossing& b) { return a.time < b.time; });
+    }
+
+    //! Get all events of the trajectory sorted by time: the end of braking, the segment boundaries, and the arrival of each DoF, and the end of the trajectory
+
+    //! Segments without duration are skipped, so that there is a single event per DoF and time. The end of the
+    //! trajectory is the last event. Together with get_next_event_time, an event-driven executive can sleep until the
+    //! next event instead of polling update in every cycle.
+    void get_events(std::vector<TrajectoryEvent>& events) const {
+        events.clear();
+        for (size_t dof = 0; dof < profiles.size(); ++dof) {
+            const Profile& profile = profiles[dof];
+            const double brake_duration = (profile.brake.duration > 0.0) ? profile.brake.duration : 0.0;
+            const double arrival = std::min(brake_duration + profile.t_sum[6], duration);
+            for_each_segment(profile, [&](const Segment& segment, double) {
+                if (segment.start <= 0.0 || segment.start >= arrival) {
+                    return;
+                }
+
+                const bool is_brake_end = (segment.index >= 2 && brake_duration > 0.0 && segment.start == brake_duration);
+                events.push_back({is_brake_end ? TrajectoryEventType::BrakeEnd : TrajectoryEventType::SegmentBoundary, dof, segment.index, segment.start});
+            });
+
+            // Also at the start for a DoF without motion
+            events.push_back({TrajectoryEventType::Arrival, dof, 9, arrival});
+        }
+
+        std::stable_sort(events.begin(), events.end(), [](const TrajectoryEvent& a, const TrajectoryEvent& b) { return a.time < b.time; });
+        events.push_back({TrajectoryEventType::Finished, degrees_of_freedom, 9, duration});
+    }
+
+    //! Get the time of the next event after the given time (without allocation), or infinity after the end of the trajectory
+    double get_next_event_time(double time) const {
+        if (time >= duration) {
+            return std::numeric_limits<double>::infinity();
+        }
+
+        double result {duration};
+        for (const Profile& profile: profiles) {
+            Segment segment;
+            for (size_t index = 0; index < 10; ++index) {
+                TrajectorySampler<DOFs, MaxDOFs>::load(profile, index, segment);
+                if (segment.start > time && segment.end > segment.start) {
+                    result = std::min(result, segment.start);
+                    break;
+                }
+            }
+        }
+        return result;
+    }
+
+    //! Get the time that this trajectory passes a specific position of a given DoF the first time
+
+    //! If the position is passed, this method returns true, otherwise false
+    //! The Python wrapper takes `dof` and `position` as arguments and returns `time` (or `None`) instead
+    bool get_first_time_at_position(size_t dof, double position, double& time) const {
+        if (dof >= degrees_of_freedom) {
+            return false;
+        }
+
+        double v, a;
+        return profiles[dof].get_first_state_at_position(position, time, v, a);
+    }
+};
+
+} // namespace ruckig
@@ -0,0 +1,194 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+
+#include <ruckig/executable_trajectory.hpp>
+
+
+namespace ruckig {
+
+//! Fixed-rate samples of a trajectory in scaled integers (e.g. encoder counts), without floating point per cycle
+
+//! On assignment, the profile of each DoF is split into pieces of at most 2^piece_bits cycles, and each piece is
+//! converted into integer polynomial coefficients (in fixed-point with fractional_bits) of the cycle index within the
+//! piece. Each cycle then evaluates the polynomials with integer multiply-adds only, which are exact. The coefficients
+//! are rounded once, so that the sampled position and velocity differ from the scaled double trajectory by at most
+//! max_rounding_error counts. The cycles are at the same times as the TrajectorySampler, i.e. at multiples of the
+//! time step followed by a last cycle exactly at the duration; afterwards, the state of the last cycle is held.
+template<size_t DOFs, size_t MaxDOFs = 0>
+class FixedPointTrajectory {
+    template<class T> using Vector = DOFsVector<T, DOFs, MaxDOFs>;
+    using Sampler = TrajectorySampler<DOFs, MaxDOFs>;
+
+    //! Position and velocity polynomials of a piece, in counts with fractional_bits
+    struct Piece {
+        size_t end; // First cycle after the piece
+        std::array<int64_t, 4> position;
+        std::array<int64_t, 3> velocity;
+    };
+
+    Vector<std::vector<Piece>> pieces;
+    Vector<size_t> current_pieces;
+    Vector<size_t> piece_begins; // First cycle of the current piece
+    size_t number_cycles {0};
+
+    static int64_t to_fixed(double value) {
+        const double scaled = std::round(std::ldexp(value, fractional_bits));
+        if (!(std::abs(scaled) < std::ldexp(1.0, 62))) {
+            throw std::runtime_error("[ruckig] scaled trajectory exceeds the range of the fixed-point representation.");
+        }
+        return static_cast<int64_t>(scaled);
+    }
+
+    //! Round to the nearest integer count (ties towards positive infinity, with an arithmetic right shift)
+    static int64_t round(int64_t value) {
+        return (value + (int64_t {1} << (fractional_bits - 1))) >> fractional_bits;
+    }
+
+    //! Piece starting at the time tau within the segment, for cycles of length h
+    static Piece make_piece(const typename Sampler::Segment& s, double tau, double h, double scale, size_t end) {
+        const double v = s.v + tau * (s.a + tau * s.j_2);
+        const double a = s.a + tau * s.j;
+
+        Piece piece;
+        piece.end = end;
+        piece.position = {
+            to_fixed(scale * (s.p + tau * (s.v + tau * (s.a_2 + tau * s.j_6)))),
+            to_fixed(scale * h * v),
+            to_fixed(scale * h * h / 2 * a),
+            to_fixed(scale * h * h * h * s.j_6),
+        };
+        piece.velocity = {
+            to_fixed(scale * v),
+            to_fixed(scale * h * a),
+            to_fixed(scale * h * h * s.j_2),
+        };
+        return piece;
+    }
+
+    void evaluate() {
+        for (size_t dof = 0; dof < pieces.size(); ++dof) {
+            const std::vector<Piece>& dof_pieces = pieces[dof];
+            size_t& current = current_pieces[dof];
+            while (cycle >= dof_pieces[current].end && current + 1 < dof_pieces.size()) {
+                piece_begins[dof] = dof_pieces[current].end;
+                ++current;
+            }
+
+            const Piece& piece = dof_pieces[current];
+            const int64_t m = static_cast<int64_t>(std::min(cycle, piece.end - 1) - piece_begins[dof]);
+            position[dof] = round(((piece.position[3] * m + piece.position[2]) * m + piece.position[1]) * m + piece.position[0]);
+            velocity[dof] = round((piece.velocity[2] * m + piece.velocity[1]) * m + piece.velocity[0]);
+        }
+    }
+
+public:
+    //! Fractional bits of the coefficients, and the maximal number of cycles of a piece as a power of two
+    constexpr static int fractional_bits {27};
+    constexpr static int piece_bits {8};
+
+    //! Bound of the difference to the scaled double trajectory in counts, from rounding the output (0.5) and the
+    //! coefficients (0.5 * 2^-fractional_bits per term, with a cycle index of at most 2^piece_bits). The conversion in
+    //! double precision adds a relative error of the order of 1e-15 of the position.
+    constexpr static double max_rounding_error {0.5 + 0.5 * ((1 << (3 * piece_bits)) + (1 << (2 * piece_bits)) + (1 << piece_bits) + 1) / static_cast<double>(int64_t {1} << fractional_bits)};
+
+    //! Counts per unit of each DoF, e.g. per radian, for both position and velocity (then in counts per second)
+    Vector<double> scales;
+
+    //! Current cycle and its state in counts
+    size_t cycle {0};
+    Vector<int64_t> position, velocity;
+
+    explicit FixedPointTrajectory(const Vector<double>& scales): scales(scales) {
+        if constexpr (DOFs == 0) {
+            pieces.resize(scales.size());
+            current_pieces.resize(scales.size());
+            piece_begins.resize(scales.size());
+            position.resize(scales.size());
+            velocity.resize(scales.size());
+        }
+    }
+
+    //! Convert the trajectory for sampling with the given cycle time, and restart at its first cycle
+
+    //! This is not real-time capable, as it uses floating point and might allocate memory for longer trajectories.
+    void assign(const ExecutableTrajectory<DOFs, MaxDOFs>& trajectory, double delta_time) {
+        if (trajectory.degrees_of_freedom != scales.size()) {
+            throw std::runtime_error("[ruckig] mismatch in degrees of freedom (vector size).");
+        }
+        if (!(delta_time > 0.0)) {
+            throw std::runtime_error("[ruckig] the sampling time step needs to be positive.");
+        }
+
+        const double duration = trajectory.duration;
+        const size_t last_cycle = Sampler::first_step_at(duration, delta_time);
+        const size_t max_piece_cycles = size_t {1} << piece_bits;
+
+        for (size_t dof = 0; dof < pieces.size(); ++dof) {
+            const Profile& profile = trajectory.profiles[dof];
+            std::vector<Piece>& dof_pieces = pieces[dof];
+            dof_pieces.clear();
+
+            // Pieces for the cycles before the duration, split at segment boundaries and after at most 2^piece_bits cycles
+            typename Sampler::Segment segment;
+            Sampler::load(profile, 0, segment);
+            size_t begin {0};
+            while (begin < last_cycle) {
+                const size_t segment_end = (segment.end < duration) ? std::min(Sampler::first_step_at(segment.end, delta_time), last_cycle) : last_cycle;
+                while (begin < segment_end) {
+                    const size_t end = std::min(begin + max_piece_cycles, segment_end);
+                    dof_pieces.push_back(make_piece(segment, begin * delta_time - segment.start, delta_time, scales[dof], end));
+                    begin = end;
+                }
+
+                if (segment.index < 9) {
+                    Sampler::load(profile, segment.index + 1, segment);
+                }
+            }
+
+            // Last cycle exactly at the duration, held afterwards
+            Sampler::load(profile, 9, segment);
+            Piece last = make_piece(segment, duration - segment.start, delta_time, scales[dof], std::numeric_limits<size_t>::max());
+            last.position[1] = last.position[2] = last.position[3] = 0;
+            last.velocity[1] = last.velocity[2] = 0;
+            dof_pieces.push_back(last);
+        }
+
+        number_cycles = last_cycle + 1;
+        reset();
+    }
+
+    //! Restart at the first cycle
+    void reset() {
+        cycle = 0;
+        std::fill(current_pieces.begin(), current_pieces.end(), 0);
+        std::fill(piece_begins.begin(), piece_begins.end(), 0);
+        if (number_cycles > 0) {
+            evaluate();
+        }
+    }
+
+    //! Advance to the next cycle, returns false if the trajectory was finished before (and keeps the last state)
+    bool next() {
+        if (cycle + 1 >= number_cycles) {
+            return false;
+        }
+
+        ++cycle;
+        evaluate();
+        return true;
+    }
+
+    //! Number of cycles of the trajectory, including the last one at the duration
+    size_t size() const {
+        return number_cycles;
+    }
+};
+
+} // namespace ruckig
@@ -1,12 +1,15 @@
 #pragma once
 
 #include <array>
-#include <iomanip>
 #include <optional>
-#include <sstream>
 #include <type_traits>
 #include <vector>
 
+#ifndef RUCKIG_HARD_REALTIME
+    #include <iomanip>
+    #include <sstream>
+#endif
+
 #include <ruckig/utils.hpp>
 
 namespace ruckig {
@@ -24,6 +27,23 @@ enum Result {
     ErrorSynchronizationCalculation = -111, ///< Error during the synchronization calculation (Step 2)
 };
 
+//! Phase of the calculation in which an error occurred
+enum class CalculationPhase {
+    None, ///< No error
+    Validation, ///< The input is invalid
+    Step1, ///< Extremal profiles of a DoF
+    Synchronization, ///< Choice of the synchronization duration
+    Step2, ///< Profile of a DoF for the synchronization duration
+};
+
+//! Record of the last calculation error, filled without exceptions or string building (e.g. for the hard real-time profile)
+struct CalculationError {
+    Result result {Result::Working};
+    CalculationPhase phase {CalculationPhase::None};
+    int dof {-1}; ///< Failing DoF, or -1 if the error is not specific to a DoF
+    double duration {0.0}; ///< Synchronization duration, if it was determined already
+};
+
 
 enum class ControlInterface {
     Position, ///< Position-control: Full control over the entire kinematic state (Default)
@@ -43,11 +63,55 @@ enum class DurationDiscretization {
     Discrete, ///< The trajectory synchronization duration must be a multiple of the control cycle
 };
 
+enum class ChangeDetection {
+    Full, ///< Compare all input values to the last calculated input (Default)
+    Generation, ///< Only compare the generation counter, which needs to be incremented by mark_changed() after each change
+};
+
+//! Optional input features that can be removed from the calculation at compile-time, can be combined with |
+enum class Features: unsigned {
+    All = 0, ///< Support all input features (Default)
+    Symmetric = 1 << 0, ///< No min_velocity and min_acceleration, the limits are always symmetric
+    Uniform = 1 << 1, ///< No per_dof_control_interface, per_dof_synchronization, and synchronization_groups
+    TimeSyncOnly = 1 << 2, ///< Only Synchronization::Time
+    NoMinimumDuration = 1 << 3, ///< No minimum_duration
+    Continuous = 1 << 4, ///< Only DurationDiscretization::Continuous
+    AllEnabled = 1 << 5, ///< All DoFs are always enabled
+    Minimal = (1 << 6) - 1, ///< None of the optional features above
+};
+
+constexpr Features operator|(Features a, Features b) {
+    return static_cast<Features>(static_cast<unsigned>(a) | static_cast<unsigned>(b));
+}
+
+//! Is the given feature removed from the calculation?
+constexpr bool is_removed(Features features, Features feature) {
+    return (static_cast<unsigned>(features) & static_cast<unsigned>(feature)) != 0;
+}
+
+//! Kinematic limits of the input that are read at runtime (Default)
+struct RuntimeLimits { };
+
+//! Are the kinematic limits known at compile-time? Then, Limits is a struct with the static constexpr members
+//! max_velocity, max_acceleration, and max_jerk, which hold for all DoFs (with symmetric minimal limits).
+template<class Limits>
+constexpr bool has_constant_limits = !std::is_same_v<Limits, RuntimeLimits>;
+
+//! Are the kinematic limits known at compile-time valid, so that they don't need to be validated at runtime?
+template<class Limits>
+constexpr bool are_valid_constant_limits() {
+    if constexpr (has_constant_limits<Limits>) {
+        return Limits::max_velocity > 0.0 && Limits::max_acceleration > 0.0 && Limits::max_jerk > 0.0;
+    } else {
+        return true;
+    }
+}
+
 
 //! Input type of Ruckig
-template<size_t DOFs>
+template<size_t DOFs, size_t MaxDOFs = 0>
 class InputParameter {
-    template<class T> using Vector = typename std::conditional<DOFs >= 1, std::array<T, DOFs>, std::vector<T>>::type;
+    template<class T> using Vector = DOFsVector<T, DOFs, MaxDOFs>;
 
     void initialize() {
         std::fill(current_velocity.begin(), current_velocity.end(), 0.0);
@@ -64,6 +128,12 @@ public:
     Synchronization synchronization {Synchronization::Time};
     DurationDiscretization duration_discretization {DurationDiscretization::Continuous};
 
+    //! How the update function detects a changed input (and therefore the need for a recalculation)
+    ChangeDetection change_detection {ChangeDetection::Full};
+
+    //! Generation counter for the ChangeDetection::Generation mode
+    size_t generation {0};
+
     // Current state
     Vector<double> current_position, current_velocity, current_acceleration;
 
@@ -74,8 +144,8 @@ public:
     Vector<double> max_velocity, max_acceleration, max_jerk;
     std::optional<Vector<double>> min_velocity, min_acceleration;
 
-    //! Intermediate waypoints (only in Ruckig Pro)
-    std::vector<Vector<double>> intermediate_positions;
+    //! Intermediate waypoints, passed in order before the target (see WaypointTrajectory)
+    WaypointList<Vector<double>> intermediate_positions;
 
     // Positional constraints (only in Ruckig Pro)
     std::optional<Vector<double>> max_position, min_position;
@@ -89,12 +159,23 @@ public:
     //! Per-DoF synchronization (overwrites global synchronization)
     std::optional<Vector<Synchronization>> per_dof_synchronization;
 
+    //! Optional synchronization group per DoF, e.g. for an arm and a positioner: the DoFs of a group are synchronized
+    //! with each other only, and the trajectory lasts until the slowest group reaches its target
+    std::optional<Vector<size_t>> synchronization_groups;
+
     //! Optional minimum trajectory duration
     std::optional<double> minimum_duration;
 
     //! Optional duration [µs] after which the trajectory calculation is (softly) interrupted (only in Ruckig Pro)
     std::optional<double> interrupt_calculation_duration;
 
+    //! Try the profile cases of the previous trajectory first in Step 2, e.g. for a slowly changing target
+    bool warm_start {false};
+
+    //! Number of synchronization candidates (at most 4) for which Step 2 is tried, if it fails for the first ones. With
+    //! a worker pool, the candidates are calculated speculatively at once, and the earliest valid one is used.
+    size_t speculative_candidates {1};
+
     template <size_t D = DOFs, typename std::enable_if<D >= 1, int>::type = 0>
     InputParameter(): degrees_of_freedom(DOFs) {
         initialize();
@@ -116,7 +197,44 @@ public:
         initialize();
     }
 
-    bool operator!=(const InputParameter<DOFs>& rhs) const {
+    //! Set the kinematic limits of all DoFs to the limits known at compile-time (see has_constant_limits)
+    template<class Limits>
+    void set_limits() {
+        static_assert(has_constant_limits<Limits>, "[ruckig] set_limits requires limits known at compile-time.");
+
+        std::fill(max_velocity.begin(), max_velocity.end(), Limits::max_velocity);
+        std::fill(max_acceleration.begin(), max_acceleration.end(), Limits::max_acceleration);
+        std::fill(max_jerk.begin(), max_jerk.end(), Limits::max_jerk);
+        min_velocity = std::nullopt;
+        min_acceleration = std::nullopt;
+    }
+
+    //! Mark the input as changed, so that a new trajectory is calculated with ChangeDetection::Generation
+    void mark_changed() {
+        ++generation;
+    }
+
+    //! Has the input changed with respect to a previous input? Depending on change_detection, this is an O(1) check.
+    bool has_changed(const InputParameter<DOFs, MaxDOFs>& previous) const {
+        if (change_detection == ChangeDetection::Generation && previous.change_detection == ChangeDetection::Generation) {
+            return generation != previous.generation;
+        }
+        return *this != previous;
+    }
+
+    //! Have the kinematic limits (of velocity, acceleration, and jerk) changed with respect to a previous input?
+    bool has_changed_limits(const InputParameter<DOFs, MaxDOFs>& rhs) const {
+        return (
+            max_velocity != rhs.max_velocity
+            || max_acceleration != rhs.max_acceleration
+            || max_jerk != rhs.max_jerk
+            || min_velocity != rhs.min_velocity
+            || min_acceleration != rhs.min_acceleration
+        );
+    }
+
+    //! Has anything but the kinematic limits (of velocity, acceleration, and jerk) changed with respect to a previous input?
+    bool has_changed_except_limits(const InputParameter<DOFs, MaxDOFs>& rhs) const {
         return (
             current_position != rhs.current_position
             || current_velocity != rhs.current_velocity
@@ -124,24 +242,55 @@ public:
             || target_position != rhs.target_position
             || target_velocity != rhs.target_velocity
             || target_acceleration != rhs.target_acceleration
+            || intermediate_positions != rhs.intermediate_positions
+            || max_position != rhs.max_position
+            || min_position != rhs.min_position
+            || enabled != rhs.enabled
+            || minimum_duration != rhs.minimum_duration
+            || control_interface != rhs.control_interface
+            || synchronization != rhs.synchronization
+            || duration_discretization != rhs.duration_discretization
+            || per_dof_control_interface != rhs.per_dof_control_interface
+            || per_dof_synchronization != rhs.per_dof_synchronization
+            || synchronization_groups != rhs.synchronization_groups
+        );
+    }
+
+    //! Has anything but the target position changed with respect to a previous input?
+    bool has_changed_except_target_position(const InputParameter<DOFs, MaxDOFs>& rhs) const {
+        return (
+            current_position != rhs.current_position
+            || current_velocity != rhs.current_velocity
+            || current_acceleration != rhs.current_acceleration
+            || target_velocity != rhs.target_velocity
+            || target_acceleration != rhs.target_acceleration
             || max_velocity != rhs.max_velocity
             || max_acceleration != rhs.max_acceleration
             || max_jerk != rhs.max_jerk
+            || min_velocity != rhs.min_velocity
+            || min_acceleration != rhs.min_acceleration
             || intermediate_positions != rhs.intermediate_positions
             || max_position != rhs.max_position
             || min_position != rhs.min_position
             || enabled != rhs.enabled
             || minimum_duration != rhs.minimum_duration
-            || min_velocity != rhs.min_velocity
-            || min_acceleration != rhs.min_acceleration
             || control_interface != rhs.control_interface
             || synchronization != rhs.synchronization
             || duration_discretization != rhs.duration_discretization
             || per_dof_control_interface != rhs.per_dof_control_interface
             || per_dof_synchronization != rhs.per_dof_synchronization
+            || synchronization_groups != rhs.synchronization_groups
+        );
+    }
+
+    bool operator!=(const InputParameter<DOFs, MaxDOFs>& rhs) const {
+        return (
+            has_changed_except_limits(rhs)
+            || has_changed_limits(rhs)
         );
     }
 
+#ifndef RUCKIG_HARD_REALTIME
     std::string to_string() const {
         std::stringstream ss;
         ss << "\ninp.current_position = [" << join(current_position) << "]\n";
@@ -168,6 +317,7 @@ public:
         }
         return ss.str();
     }
+#endif
 };
 
 } // namespace ruckig
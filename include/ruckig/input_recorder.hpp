@@ -0,0 +1,329 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include <ruckig/input_parameter.hpp>
+#include <ruckig/serialization.hpp>
+
+
+namespace ruckig {
+
+//! Versioned binary format of a recorded input stream
+
+//! A recording consists of a header (the magic "RUCKIGIN" and the format version as uint64) followed by a record per
+//! changed input. Each record starts with the cycle of the input and a word with the number of DoFs (bits 0-31), the
+//! control interface, synchronization, and duration discretization (4 bits each from bit 32), and the flags of the
+//! optional fields (from bit 44). Then follow the current state, target state, and limits with one double per DoF, and
+//! the optional fields that are set. All values are little-endian 64-bit words, doubles are stored bit-exact.
+//! Intermediate positions, interrupt_calculation_duration, and speculative_candidates are not recorded.
+struct InputRecording {
+    constexpr static std::array<char, 8> magic {'R', 'U', 'C', 'K', 'I', 'G', 'I', 'N'};
+
+    //! Version of the binary format, incremented for incompatible changes
+    constexpr static uint64_t version {1};
+
+    constexpr static size_t header_size {16};
+
+    // Flags of the optional fields
+    constexpr static uint64_t has_min_velocity {1 << 0}, has_min_acceleration {1 << 1}, has_max_position {1 << 2}, has_min_position {1 << 3};
+    constexpr static uint64_t has_minimum_duration {1 << 4}, has_disabled_dofs {1 << 5}, has_per_dof_control_interface {1 << 6}, has_per_dof_synchronization {1 << 7}, has_warm_start {1 << 8};
+    constexpr static uint64_t has_synchronization_groups {1 << 9};
+
+    //! Size in bytes of a record with the given number of DoFs and flags
+    constexpr static size_t record_size(size_t degrees_of_freedom, uint64_t flags) {
+        size_t words = 2 + 9 * degrees_of_freedom;
+        for (const uint64_t flag: {has_min_velocity, has_min_acceleration, has_max_position, has_min_position, has_per_dof_control_interface, has_per_dof_synchronization, has_synchronization_groups}) {
+            words += (flags & flag) ? degrees_of_freedom : 0;
+        }
+        words += (flags & has_minimum_duration) ? 1 : 0;
+        words += (flags & has_disabled_dofs) ? (degrees_of_freedom + 63) / 64 : 0;
+        return 8 * words;
+    }
+
+    //! Largest size in bytes of a record with the given number of DoFs
+    constexpr static size_t max_record_size(size_t degrees_of_freedom) {
+        return record_size(degrees_of_freedom, (1 << 10) - 1);
+    }
+
+    //! Append the header of a recording to the buffer
+    static void write_header(std::vector<uint8_t>& buffer) {
+        const size_t begin = buffer.size();
+        buffer.resize(begin + header_size);
+        std::memcpy(buffer.data() + begin, magic.data(), magic.size());
+        TrajectorySerialization::store(buffer.data() + begin + 8, version);
+    }
+
+    //! Check the header of a recording
+    static bool read_header(const uint8_t* data, size_t size) {
+        return size >= header_size && std::memcmp(data, magic.data(), magic.size()) == 0 && TrajectorySerialization::load_integer(data + 8) == version;
+    }
+
+    //! Encode the input as a record into data, which needs to hold max_record_size bytes, and return its size
+    template<size_t DOFs, size_t MaxDOFs>
+    static size_t write_record(uint64_t cycle, const InputParameter<DOFs, MaxDOFs>& input, uint8_t* data) {
+        const size_t dofs = input.degrees_of_freedom;
+        uint64_t flags {0};
+        flags |= input.min_velocity ? has_min_velocity : 0;
+        flags |= input.min_acceleration ? has_min_acceleration : 0;
+        flags |= input.max_position ? has_max_position : 0;
+        flags |= input.min_position ? has_min_position : 0;
+        flags |= input.minimum_duration ? has_minimum_duration : 0;
+        flags |= std::all_of(input.enabled.begin(), input.enabled.end(), [](bool e){ return e; }) ? 0 : has_disabled_dofs;
+        flags |= input.per_dof_control_interface ? has_per_dof_control_interface : 0;
+        flags |= input.per_dof_synchronization ? has_per_dof_synchronization : 0;
+        flags |= input.warm_start ? has_warm_start : 0;
+        flags |= input.synchronization_groups ? has_synchronization_groups : 0;
+
+        uint8_t* const begin = data;
+        const auto store = [&data](auto value) {
+            TrajectorySerialization::store(data, value);
+            data += 8;
+        };
+        const auto store_vector = [&store](const auto& vector) {
+            for (const double value: vector) {
+                store(value);
+            }
+        };
+
+        store(cycle);
+        store(static_cast<uint64_t>(dofs) | (static_cast<uint64_t>(input.control_interface) << 32) | (static_cast<uint64_t>(input.synchronization) << 36) | (static_cast<uint64_t>(input.duration_discretization) << 40) | (flags << 44));
+        for (const auto* vector: {&input.current_position, &input.current_velocity, &input.current_acceleration, &input.target_position, &input.target_velocity, &input.target_acceleration, &input.max_velocity, &input.max_acceleration, &input.max_jerk}) {
+            store_vector(*vector);
+        }
+        for (const auto* vector: {&input.min_velocity, &input.min_acceleration, &input.max_position, &input.min_position}) {
+            if (*vector) {
+                store_vector(vector->value());
+            }
+        }
+        if (input.minimum_duration) {
+            store(input.minimum_duration.value());
+        }
+        if (flags & has_disabled_dofs) {
+            for (size_t i = 0; i < dofs; i += 64) {
+                uint64_t bits {0};
+                for (size_t dof = i; dof < std::min(i + 64, dofs); ++dof) {
+                    bits |= static_cast<uint64_t>(input.enabled[dof]) << (dof - i);
+                }
+                store(bits);
+            }
+        }
+        if (input.per_dof_control_interface) {
+            for (const ControlInterface value: input.per_dof_control_interface.value()) {
+                store(static_cast<uint64_t>(value));
+            }
+        }
+        if (input.per_dof_synchronization) {
+            for (const Synchronization value: input.per_dof_synchronization.value()) {
+                store(static_cast<uint64_t>(value));
+            }
+        }
+        if (input.synchronization_groups) {
+            for (const size_t value: input.synchronization_groups.value()) {
+                store(static_cast<uint64_t>(value));
+            }
+        }
+        return data - begin;
+    }
+
+    //! Decode the record at the offset into the input and advance the offset to the next record
+
+    //! Returns false at the end of the data, or if the record is incomplete or its number of DoFs does not match. For
+    //! dynamic DoFs, the input is resized to the DoFs of the record.
+    template<size_t DOFs, size_t MaxDOFs>
+    static bool read_record(const uint8_t* data, size_t size, size_t& offset, uint64_t& cycle, InputParameter<DOFs, MaxDOFs>& input) {
+        if (offset + 16 > size) {
+            return false;
+        }
+
+        const uint64_t settings = TrajectorySerialization::load_integer(data + offset + 8);
+        const size_t dofs = static_cast<uint32_t>(settings);
+        const uint64_t flags = settings >> 44;
+        if (offset + record_size(dofs, flags) > size) {
+            return false;
+        }
+
+        if (dofs != input.degrees_of_freedom) {
+            if constexpr (DOFs == 0) {
+                input = InputParameter<DOFs, MaxDOFs>(dofs);
+            } else {
+                return false;
+            }
+        }
+
+        const uint8_t* ptr = data + offset;
+        const auto load_integer = [&ptr]() {
+            const uint64_t value = TrajectorySerialization::load_integer(ptr);
+            ptr += 8;
+            return value;
+        };
+        const auto load_double = [&ptr]() {
+            const double value = TrajectorySerialization::load_double(ptr);
+            ptr += 8;
+            return value;
+        };
+        const auto load_vector = [&load_double](auto& vector) {
+            for (double& value: vector) {
+                value = load_double();
+            }
+        };
+
+        cycle = load_integer();
+        load_integer();
+        input.control_interface = static_cast<ControlInterface>((settings >> 32) & 0xF);
+        input.synchronization = static_cast<Synchronization>((settings >> 36) & 0xF);
+        input.duration_discretization = static_cast<DurationDiscretization>((settings >> 40) & 0xF);
+        for (auto* vector: {&input.current_position, &input.current_velocity, &input.current_acceleration, &input.target_position, &input.target_velocity, &input.target_acceleration, &input.max_velocity, &input.max_acceleration, &input.max_jerk}) {
+            load_vector(*vector);
+        }
+
+        const std::array<uint64_t, 4> optional_flags {has_min_velocity, has_min_acceleration, has_max_position, has_min_position};
+        const std::array<decltype(&input.min_velocity), 4> optional_vectors {&input.min_velocity, &input.min_acceleration, &input.max_position, &input.min_position};
+        for (size_t i = 0; i < optional_vectors.size(); ++i) {
+            if (flags & optional_flags[i]) {
+                if (!*optional_vectors[i]) {
+                    *optional_vectors[i] = input.current_position;
+                }
+                load_vector(optional_vectors[i]->value());
+            } else {
+                optional_vectors[i]->reset();
+            }
+        }
+
+        input.minimum_duration = (flags & has_minimum_duration) ? std::optional<double>(load_double()) : std::nullopt;
+        std::fill(input.enabled.begin(), input.enabled.end(), true);
+        if (flags & has_disabled_dofs) {
+            for (size_t i = 0; i < dofs; i += 64) {
+                const uint64_t bits = load_integer();
+                for (size_t dof = i; dof < std::min(i + 64, dofs); ++dof) {
+                    input.enabled[dof] = (bits >> (dof - i)) & 1;
+                }
+            }
+        }
+
+        if (flags & has_per_dof_control_interface) {
+            input.per_dof_control_interface.emplace();
+            if constexpr (DOFs == 0) {
+                input.per_dof_control_interface->resize(dofs);
+            }
+            for (auto& value: input.per_dof_control_interface.value()) {
+                value = static_cast<ControlInterface>(load_integer());
+            }
+        } else {
+            input.per_dof_control_interface.reset();
+        }
+        if (flags & has_per_dof_synchronization) {
+            input.per_dof_synchronization.emplace();
+            if constexpr (DOFs == 0) {
+                input.per_dof_synchronization->resize(dofs);
+            }
+            for (auto& value: input.per_dof_synchronization.value()) {
+                value = static_cast<Synchronization>(load_integer());
+            }
+        } else {
+            input.per_dof_synchronization.reset();
+        }
+        if (flags & has_synchronization_groups) {
+            input.synchronization_groups.emplace();
+            if constexpr (DOFs == 0) {
+                input.synchronization_groups->resize(dofs);
+            }
+            for (auto& value: input.synchronization_groups.value()) {
+                value = static_cast<size_t>(load_integer());
+            }
+        } else {
+            input.synchronization_groups.reset();
+        }
+
+        input.warm_start = (flags & has_warm_start);
+        input.intermediate_positions.clear();
+        input.interrupt_calculation_duration.reset();
+        input.speculative_candidates = 1;
+        offset += record_size(dofs, flags);
+        return true;
+    }
+};
+
+
+//! Records the changed inputs of a control loop into a bounded ring buffer, which is drained by another thread
+
+//! The memory is allocated at construction, so that record() does not allocate memory (except for the copy of inputs
+//! with optional fields that are set for the first time in case of dynamic DoFs), locks, or waits. A single real-time
+//! thread records, while a single other thread drains the records, e.g. to write them to a file. If the ring buffer is
+//! full, the record is dropped and the input is recorded again once there is space.
+template<size_t DOFs, size_t MaxDOFs = 0>
+class InputRecorder {
+    std::vector<uint8_t> ring;
+    std::vector<uint8_t> scratch;
+    std::atomic<size_t> write_position {0}; // Total number of written bytes
+    std::atomic<size_t> read_position {0}; // Total number of drained bytes
+    std::atomic<uint64_t> dropped {0};
+
+    InputParameter<DOFs, MaxDOFs> last_input;
+    bool has_last_input {false};
+    uint64_t cycle {0};
+
+public:
+    template <size_t D = DOFs, typename std::enable_if<D >= 1, int>::type = 0>
+    explicit InputRecorder(size_t capacity): ring(capacity), scratch(InputRecording::max_record_size(DOFs)) { }
+
+    template <size_t D = DOFs, typename std::enable_if<D == 0, int>::type = 0>
+    explicit InputRecorder(size_t dofs, size_t capacity): ring(capacity), scratch(InputRecording::max_record_size(dofs)), last_input(dofs) { }
+
+    InputRecorder(const InputRecorder&) = delete;
+    InputRecorder& operator=(const InputRecorder&) = delete;
+
+    //! Record the input of the current cycle if it has changed (by the real-time thread), returns false if it was dropped
+    bool record(const InputParameter<DOFs, MaxDOFs>& input) {
+        const uint64_t current_cycle = cycle++;
+        if (has_last_input && !input.has_changed(last_input)) {
+            return true;
+        }
+
+        const size_t size = InputRecording::write_record(current_cycle, input, scratch.data());
+        const size_t begin = write_position.load(std::memory_order_relaxed);
+        if (begin + size - read_position.load(std::memory_order_acquire) > ring.size()) {
+            dropped.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+
+        const size_t index = begin % ring.size();
+        const size_t first = std::min(size, ring.size() - index);
+        std::memcpy(ring.data() + index, scratch.data(), first);
+        std::memcpy(ring.data(), scratch.data() + first, size - first);
+        write_position.store(begin + size, std::memory_order_release);
+
+        last_input = input;
+        has_last_input = true;
+        return true;
+    }
+
+    //! Append all complete records to the buffer (by the draining thread), returns the number of appended bytes
+    size_t drain(std::vector<uint8_t>& buffer) {
+        const size_t begin = read_position.load(std::memory_order_relaxed);
+        const size_t size = write_position.load(std::memory_order_acquire) - begin;
+        if (size == 0) {
+            return 0;
+        }
+
+        const size_t offset = buffer.size();
+        buffer.resize(offset + size);
+        const size_t index = begin % ring.size();
+        const size_t first = std::min(size, ring.size() - index);
+        std::memcpy(buffer.data() + offset, ring.data() + index, first);
+        std::memcpy(buffer.data() + offset + first, ring.data(), size - first);
+        read_position.store(begin + size, std::memory_order_release);
+        return size;
+    }
+
+    //! Number of records that were dropped as the ring buffer was full
+    uint64_t dropped_records() const {
+        return dropped.load(std::memory_order_relaxed);
+    }
+};
+
+} // namespace ruckig
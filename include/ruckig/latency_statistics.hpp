@@ -0,0 +1,195 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+
+#include <ruckig/input_parameter.hpp>
+
+
+namespace ruckig {
+
+//! Histogram of durations with logarithmic buckets (HDR-style) in fixed memory, that is lock-free to read and reset
+
+//! Durations are counted in nanoseconds: exactly below 32ns, and above with 16 buckets per power of two, so that each
+//! bucket has a relative width of at most 6.25%. Durations beyond about 68s are counted in the last bucket. A single
+//! thread records, while any other thread may read or reset the histogram concurrently.
+class LatencyHistogram {
+    constexpr static size_t sub_bucket_bits {4};
+    constexpr static size_t sub_buckets {1 << sub_bucket_bits};
+    constexpr static size_t max_exponent {36};
+    constexpr static size_t number_buckets {(max_exponent - sub_bucket_bits + 1) * sub_buckets};
+
+    static_assert(std::atomic<uint64_t>::is_always_lock_free, "[ruckig] the latency histogram requires lock-free atomics.");
+
+    std::array<std::atomic<uint64_t>, number_buckets> counts {};
+    std::atomic<uint64_t> total_count {0};
+    std::atomic<uint64_t> max_nanoseconds {0};
+
+    static size_t bucket_index(uint64_t nanoseconds) {
+        if (nanoseconds < 2 * sub_buckets) {
+            return static_cast<size_t>(nanoseconds);
+        }
+
+        size_t exponent {0}; // Position of the most significant bit
+        for (uint64_t v = nanoseconds; v > 1; v >>= 1) {
+            ++exponent;
+        }
+        const size_t index = (exponent - sub_bucket_bits + 1) * sub_buckets + static_cast<size_t>(nanoseconds >> (exponent - sub_bucket_bits)) - sub_buckets;
+        return std::min(index, number_buckets - 1);
+    }
+
+    //! Largest duration [ns] that is counted in the bucket
+    static uint64_t bucket_upper_bound(size_t index) {
+        if (index < 2 * sub_buckets) {
+            return index;
+        }
+
+        const size_t exponent = index / sub_buckets + sub_bucket_bits - 1;
+        const uint64_t mantissa = index % sub_buckets + sub_buckets;
+        return ((mantissa + 1) << (exponent - sub_bucket_bits)) - 1;
+    }
+
+public:
+    //! Count a duration [µs]
+    void record(double duration) {
+        const uint64_t nanoseconds = (duration > 0.0) ? static_cast<uint64_t>(std::llround(std::min(duration, 1e12) * 1000.0)) : 0;
+        counts[bucket_index(nanoseconds)].fetch_add(1, std::memory_order_relaxed);
+        total_count.fetch_add(1, std::memory_order_relaxed);
+        if (nanoseconds > max_nanoseconds.load(std::memory_order_relaxed)) {
+            max_nanoseconds.store(nanoseconds, std::memory_order_relaxed);
+        }
+    }
+
+    //! Number of recorded durations
+    uint64_t count() const {
+        return total_count.load(std::memory_order_relaxed);
+    }
+
+    //! Largest recorded duration [µs]
+    double max() const {
+        return max_nanoseconds.load(std::memory_order_relaxed) / 1000.0;
+    }
+
+    //! Duration [µs] below which the given fraction (e.g. 0.999) of the recorded durations lies, within the bucket width
+    double percentile(double q) const {
+        std::array<uint64_t, number_buckets> snapshot;
+        uint64_t total {0};
+        for (size_t i = 0; i < number_buckets; ++i) {
+            snapshot[i] = counts[i].load(std::memory_order_relaxed);
+            total += snapshot[i];
+        }
+        if (total == 0) {
+            return 0.0;
+        }
+
+        const uint64_t rank = std::max<uint64_t>(static_cast<uint64_t>(std::ceil(q * total)), 1);
+        uint64_t sum {0};
+        for (size_t i = 0; i < number_buckets; ++i) {
+            sum += snapshot[i];
+            if (sum >= rank) {
+                return std::min(bucket_upper_bound(i), max_nanoseconds.load(std::memory_order_relaxed)) / 1000.0;
+            }
+        }
+        return max();
+    }
+
+    void reset() {
+        for (auto& count: counts) {
+            count.store(0, std::memory_order_relaxed);
+        }
+        total_count.store(0, std::memory_order_relaxed);
+        max_nanoseconds.store(0, std::memory_order_relaxed);
+    }
+};
+
+
+//! Latency histograms of the update calls of a Ruckig instance, and the input of the slowest call
+
+//! Cycles that calculate (or continue to calculate) a trajectory and cycles that only sample the current trajectory
+//! are recorded separately. The real-time thread records via Ruckig::latency_statistics, while a monitoring thread
+//! reads and resets the statistics without locks. The input of the slowest call is handed over via triple buffering
+//! (as in the TrajectoryMailbox), so that neither side waits or reads a buffer that is being written.
+template<size_t DOFs, size_t MaxDOFs = 0>
+class LatencyStatistics {
+public:
+    //! Slowest update call since the last reset
+    struct MaxSample {
+        double duration {0.0}; ///< [µs]
+        bool calculation {false}; ///< Did the call calculate a trajectory?
+        InputParameter<DOFs, MaxDOFs> input;
+    };
+
+private:
+    constexpr static uint8_t index_mask {0b011};
+    constexpr static uint8_t fresh_flag {0b100};
+
+    static_assert(std::atomic<uint8_t>::is_always_lock_free, "[ruckig] the latency statistics require lock-free atomics.");
+
+    std::array<MaxSample, 3> max_samples;
+    uint8_t back_index {0}; // Owned by the recording thread
+    std::atomic<uint8_t> middle {1};
+    uint8_t front_index {2}; // Owned by the monitoring thread
+
+    std::atomic<bool> max_reset {false};
+    double max_duration {0.0}; // Owned by the recording thread
+
+public:
+    //! Cycles with a trajectory calculation
+    LatencyHistogram calculation;
+
+    //! Cycles that only sample the trajectory
+    LatencyHistogram sampling;
+
+    template <size_t D = DOFs, typename std::enable_if<D >= 1, int>::type = 0>
+    LatencyStatistics() { }
+
+    template <size_t D = DOFs, typename std::enable_if<D == 0, int>::type = 0>
+    LatencyStatistics(size_t dofs): max_samples({MaxSample {0.0, false, InputParameter<0, MaxDOFs>(dofs)}, MaxSample {0.0, false, InputParameter<0, MaxDOFs>(dofs)}, MaxSample {0.0, false, InputParameter<0, MaxDOFs>(dofs)}}) { }
+
+    LatencyStatistics(const LatencyStatistics&) = delete;
+    LatencyStatistics& operator=(const LatencyStatistics&) = delete;
+
+    //! Record the duration [µs] of an update call (by the real-time thread)
+    void record(double duration, bool is_calculation, const InputParameter<DOFs, MaxDOFs>& input) {
+        (is_calculation ? calculation : sampling).record(duration);
+
+        if (max_reset.load(std::memory_order_relaxed) && max_reset.exchange(false, std::memory_order_acquire)) {
+            max_duration = 0.0;
+        }
+        if (duration > max_duration) {
+            max_duration = duration;
+            MaxSample& sample = max_samples[back_index];
+            sample.duration = duration;
+            sample.calculation = is_calculation;
+            sample.input = input;
+            back_index = middle.exchange(back_index | fresh_flag, std::memory_order_acq_rel) & index_mask;
+        }
+    }
+
+    //! Get the slowest update call since the last reset (by the monitoring thread), returns false if none was recorded
+    bool get_max(MaxSample& sample) {
+        if (middle.load(std::memory_order_relaxed) & fresh_flag) {
+            front_index = middle.exchange(front_index, std::memory_order_acq_rel) & index_mask;
+        }
+
+        const MaxSample& front = max_samples[front_index];
+        if (front.duration <= 0.0) {
+            return false;
+        }
+        sample = front;
+        return true;
+    }
+
+    //! Reset the histograms and the slowest call (by the monitoring thread)
+    void reset() {
+        calculation.reset();
+        sampling.reset();
+        max_samples[front_index].duration = 0.0;
+        max_reset.store(true, std::memory_order_release);
+    }
+};
+
+} // namespace ruckig
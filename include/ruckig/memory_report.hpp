@@ -0,0 +1,145 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+#include <optional>
+
+#ifndef RUCKIG_HARD_REALTIME
+#include <sstream>
+#include <string>
+#endif
+
+#include <ruckig/ruckig.hpp>
+
+
+namespace ruckig {
+
+//! Program-wide counter of heap allocations via the global operator new
+
+//! The counter is installed by defining RUCKIG_ALLOCATION_COUNTER_IMPLEMENT in exactly one translation unit of the
+//! program before including this header, which replaces the global operator new and delete. Then, all allocations of
+//! the program are counted, so that e.g. a control loop can be checked to not allocate in its steady state.
+struct AllocationCounter {
+    static inline std::atomic<size_t> allocations {0};
+    static inline std::atomic<size_t> bytes {0};
+    static inline bool is_installed {false};
+
+    //! Number and bytes of all allocations so far
+    struct Snapshot {
+        size_t allocations;
+        size_t bytes;
+
+        Snapshot operator-(const Snapshot& rhs) const {
+            return {allocations - rhs.allocations, bytes - rhs.bytes};
+        }
+    };
+
+    static Snapshot now() {
+        return {allocations.load(std::memory_order_relaxed), bytes.load(std::memory_order_relaxed)};
+    }
+};
+
+
+//! Static size and heap memory [bytes] of the main types for a number of DoFs
+struct MemoryReport {
+    size_t degrees_of_freedom;
+    bool dynamic_dofs;
+    size_t max_dofs; // Capacity of bounded dynamic DoFs, 0 otherwise
+
+    //! sizeof of each type
+    size_t ruckig, trajectory, input_parameter, output_parameter, block, profile;
+
+    //! Heap memory allocated by the construction of each type, only if the AllocationCounter is installed
+    std::optional<size_t> ruckig_heap, trajectory_heap, input_parameter_heap, output_parameter_heap;
+
+    //! Report for Ruckig<DOFs, ..., MaxDOFs>, with the number of DoFs given for dynamic DoFs
+    template<size_t DOFs, size_t MaxDOFs = 0>
+    static MemoryReport of(size_t dofs = DOFs) {
+        MemoryReport report;
+        report.degrees_of_freedom = dofs;
+        report.dynamic_dofs = (DOFs == 0);
+        report.max_dofs = MaxDOFs;
+        report.ruckig = sizeof(Ruckig<DOFs, false, true, MaxDOFs>);
+        report.trajectory = sizeof(Trajectory<DOFs, MaxDOFs>);
+        report.input_parameter = sizeof(InputParameter<DOFs, MaxDOFs>);
+        report.output_parameter = sizeof(OutputParameter<DOFs, MaxDOFs>);
+        report.block = sizeof(Block);
+        report.profile = sizeof(Profile);
+
+        if (AllocationCounter::is_installed) {
+            const auto heap = [](auto construct) {
+                const auto before = AllocationCounter::now();
+                {
+                    const auto object = construct();
+                    (void)object;
+                }
+                return (AllocationCounter::now() - before).bytes;
+            };
+
+            if constexpr (DOFs == 0) {
+                report.ruckig_heap = heap([dofs]{ return Ruckig<DOFs, false, true, MaxDOFs> {dofs, 0.01}; });
+                report.trajectory_heap = heap([dofs]{ return Trajectory<DOFs, MaxDOFs> {dofs}; });
+                report.input_parameter_heap = heap([dofs]{ return InputParameter<DOFs, MaxDOFs> {dofs}; });
+                report.output_parameter_heap = heap([dofs]{ return OutputParameter<DOFs, MaxDOFs> {dofs}; });
+            } else {
+                report.ruckig_heap = heap([]{ return Ruckig<DOFs, false, true, MaxDOFs> {0.01}; });
+                report.trajectory_heap = heap([]{ return Trajectory<DOFs, MaxDOFs> {}; });
+                report.input_parameter_heap = heap([]{ return InputParameter<DOFs, MaxDOFs> {}; });
+                report.output_parameter_heap = heap([]{ return OutputParameter<DOFs, MaxDOFs> {}; });
+            }
+        }
+        return report;
+    }
+
+    //! Total memory of an instance with its input, output, and trajectory [bytes], without the heap if not measured
+    size_t total() const {
+        return ruckig + trajectory + input_parameter + output_parameter + ruckig_heap.value_or(0) + trajectory_heap.value_or(0) + input_parameter_heap.value_or(0) + output_parameter_heap.value_or(0);
+    }
+
+#ifndef RUCKIG_HARD_REALTIME
+    std::string to_string() const {
+        const auto heap = [](const std::optional<size_t>& bytes) {
+            return bytes ? (" + " + std::to_string(bytes.value()) + " heap") : std::string();
+        };
+
+        std::stringstream ss;
+        ss << (dynamic_dofs ? (max_dofs > 0 ? "Ruckig<0, MaxDOFs=" + std::to_string(max_dofs) + ">" : std::string("Ruckig<0>")) : "Ruckig<" + std::to_string(degrees_of_freedom) + ">");
+        ss << " with " << degrees_of_freedom << " DoFs [bytes]: Ruckig " << ruckig << heap(ruckig_heap);
+        ss << ", Trajectory " << trajectory << heap(trajectory_heap);
+        ss << ", InputParameter " << input_parameter << heap(input_parameter_heap);
+        ss << ", OutputParameter " << output_parameter << heap(output_parameter_heap);
+        ss << ", Block " << block << ", Profile " << profile << ", total " << total();
+        return ss.str();
+    }
+#endif
+};
+
+} // namespace ruckig
+
+
+#ifdef RUCKIG_ALLOCATION_COUNTER_IMPLEMENT
+static const bool ruckig_allocation_counter_installed = (ruckig::AllocationCounter::is_installed = true);
+
+void* operator new(std::size_t size) {
+    ruckig::AllocationCounter::allocations.fetch_add(1, std::memory_order_relaxed);
+    ruckig::AllocationCounter::bytes.fetch_add(size, std::memory_order_relaxed);
+    if (void* ptr = std::malloc(size)) {
+        return ptr;
+    }
+#ifdef RUCKIG_HARD_REALTIME
+    std::abort();
+#else
+    throw std::bad_alloc();
+#endif
+}
+
+void operator delete(void* ptr) noexcept {
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, std::size_t) noexcept {
+    std::free(ptr);
+}
+#endif
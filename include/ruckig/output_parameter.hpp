@@ -1,9 +1,13 @@
 #pragma once
 
 #include <array>
-#include <iomanip>
 #include <type_traits>
 
+#ifndef RUCKIG_HARD_REALTIME
+    #include <iomanip>
+    #include <sstream>
+#endif
+
 #include <ruckig/trajectory.hpp>
 #include <ruckig/utils.hpp>
 
@@ -11,15 +15,15 @@
 namespace ruckig {
 
 //! Output type of Ruckig
-template<size_t DOFs>
+template<size_t DOFs, size_t MaxDOFs = 0>
 class OutputParameter {
-    template<class T> using Vector = typename std::conditional<DOFs >= 1, std::array<T, DOFs>, std::vector<T>>::type;
+    template<class T> using Vector = DOFsVector<T, DOFs, MaxDOFs>;
 
 public:
     size_t degrees_of_freedom;
 
     //! Current trajectory
-    Trajectory<DOFs> trajectory;
+    Trajectory<DOFs, MaxDOFs> trajectory;
 
     // Current kinematic state
     Vector<double> new_position, new_velocity, new_acceleration;
@@ -27,42 +31,49 @@ public:
     //! Current time on trajectory
     double time;
 
-    //! Index of the current section between two intermediate positions (only relevant in Ruckig Pro)
+    //! Index of the current section between two intermediate positions
     size_t new_section {0};
 
-    //! Was an intermediate position reached in the last cycle? (only relevant in Ruckig Pro)
+    //! Was an intermediate position reached in the last cycle?
     bool did_section_change {false};
 
     //! Was a new trajectory calculation performed in the last cycle?
     bool new_calculation {false};
 
-    //! Was the trajectory calculation interrupted? (only in Ruckig Pro)
+    //! Was the trajectory calculation interrupted? (only in Ruckig Pro) Or is it still running in the background (AsyncRuckig)?
     bool was_calculation_interrupted {false};
 
-    //! Computational duration of the last update call
-    double calculation_duration; // [µs]
+    //! Computational duration of the last update call (zero without instrumentation)
+    double calculation_duration {0.0}; // [µs]
+
+    //! Durations of the calculation phases of the last new calculation (with Instrumentation::Phases or Cases)
+    CalculationTiming<DOFs, MaxDOFs> calculation_timing;
+
+    //! Cached segments of the current trajectory for sampling the next cycle without searching
+    TrajectoryCursor<DOFs, MaxDOFs> cursor;
 
     template <size_t D = DOFs, typename std::enable_if<D >= 1, int>::type = 0>
     OutputParameter(): degrees_of_freedom(DOFs) { }
 
     template <size_t D = DOFs, typename std::enable_if<D == 0, int>::type = 0>
-    OutputParameter(size_t dofs): degrees_of_freedom(dofs), trajectory(Trajectory<0>(dofs)) {
+    OutputParameter(size_t dofs): degrees_of_freedom(dofs), trajectory(Trajectory<0, MaxDOFs>(dofs)), calculation_timing(CalculationTiming<0, MaxDOFs>(dofs)), cursor(TrajectoryCursor<0, MaxDOFs>(dofs)) {
         new_position.resize(dofs);
         new_velocity.resize(dofs);
         new_acceleration.resize(dofs);
     }
 
-    void pass_to_input(InputParameter<DOFs>& input) const {
+    void pass_to_input(InputParameter<DOFs, MaxDOFs>& input) const {
         input.current_position = new_position;
         input.current_velocity = new_velocity;
         input.current_acceleration = new_acceleration;
 
         // Remove first intermediate waypoint if section did change
         if (did_section_change && !input.intermediate_positions.empty()) {
-            input.intermediate_positions.erase(input.intermediate_positions.begin());
+            input.intermediate_positions.pop_front();
         }
     }
 
+#ifndef RUCKIG_HARD_REALTIME
     std::string to_string() const {
         std::stringstream ss;
         ss << "\nout.new_position = [" << join(new_position) << "]\n";
@@ -72,6 +83,7 @@ public:
         ss << "out.calculation_duration = [" << std::setprecision(16) << calculation_duration << "]\n";
         return ss.str();
     }
+#endif
 };
 
 } // namespace ruckig
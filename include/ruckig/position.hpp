@@ -1,6 +1,7 @@
 #pragma once
 
 #include <array>
+#include <cmath>
 #include <optional>
 
 
@@ -10,6 +11,79 @@ using Limits = Profile::Limits;
 using JerkSigns = Profile::JerkSigns;
 
 
+//! Boundary state and pre-calculated expressions of a single DoF for the position interface, shared by Step 1 and Step 2
+struct PositionExpressions {
+    double p0, v0, a0;
+    double pf, vf, af;
+
+    double pd;
+    double vd, vd_vd;
+    double ad, ad_ad;
+    double v0_v0, vf_vf;
+    double a0_a0, a0_p3, a0_p4, a0_p5, a0_p6;
+    double af_af, af_p3, af_p4, af_p5, af_p6;
+    double jMax_jMax;
+
+    explicit PositionExpressions() { }
+    explicit PositionExpressions(double p0, double v0, double a0, double pf, double vf, double af, double jMax) {
+        set(p0, v0, a0, pf, vf, af, jMax);
+    }
+
+    //! Branch-free, so that a loop over all DoFs can be vectorized by the compiler
+    inline void set(double p0_new, double v0_new, double a0_new, double pf_new, double vf_new, double af_new, double jMax) {
+        p0 = p0_new;
+        v0 = v0_new;
+        a0 = a0_new;
+        pf = pf_new;
+        vf = vf_new;
+        af = af_new;
+
+        pd = pf - p0;
+
+        vd = vf - v0;
+        vd_vd = vd * vd;
+        v0_v0 = v0 * v0;
+        vf_vf = vf * vf;
+
+        ad = af - a0;
+        ad_ad = ad * ad;
+        a0_a0 = a0 * a0;
+        af_af = af * af;
+
+        a0_p3 = a0 * a0_a0;
+        a0_p4 = a0_a0 * a0_a0;
+        a0_p5 = a0_p3 * a0_a0;
+        a0_p6 = a0_p4 * a0_a0;
+        af_p3 = af * af_af;
+        af_p4 = af_af * af_af;
+        af_p5 = af_p3 * af_af;
+        af_p6 = af_p4 * af_af;
+
+        // max values needs to be invariant to plus minus sign change
+        jMax_jMax = jMax * jMax;
+    }
+};
+
+
+//! Units normalized by the acceleration and jerk limits of a DoF, with the time unit aMax/jMax and the position unit
+//! aMax^3/jMax^2 relative to the initial position. The absolute tolerances of the profile checks are only meaningful
+//! for moderately scaled inputs, so Step 1 and Step 2 re-solve a DoF of extreme scale in these units before failing.
+struct NormalizedUnits {
+    double time, position, offset;
+    double velocity, acceleration, jerk;
+
+    explicit NormalizedUnits(double p0, double aMax, double jMax): time(std::abs(aMax / jMax)), position(std::abs(aMax) * time * time), offset(p0) {
+        velocity = position / time;
+        acceleration = velocity / time;
+        jerk = acceleration / time;
+    }
+
+    //! Whether re-solving in the normalized units would change the input at all
+    bool is_applicable() const {
+        return std::isfinite(position) && time > 0 && position > 0 && (time != 1.0 || position != 1.0 || offset != 0.0);
+    }
+};
+
 
 //! Mathematical equations for Step 1 in position interface: Extremal profiles
 class PositionStep1 {
@@ -24,8 +98,8 @@ class PositionStep1 {
     double af_af, af_p3, af_p4;
     double jMax_jMax;
 
-    // Max 5 valid profiles + 1 spare for numerical issues
-    std::array<Profile, 6> valid_profiles;
+    // Candidate pool of the block of the current get_profile call
+    Profile* valid_profiles;
     size_t valid_profile_counter;
 
     void time_all_vel(Profile& profile, double vMax, double vMin, double aMax, double aMin, double jMax);
@@ -40,6 +114,9 @@ class PositionStep1 {
     void time_vel_two_step(Profile& profile, double vMax, double vMin, double aMax, double aMin, double jMax);
     void time_none_two_step(Profile& profile, double vMax, double vMin, double aMax, double aMin, double jMax);
 
+    //! Predict which limits the time-optimal profile reaches for a target state at rest
+    Profile::Limits predict_limits_to_rest(double vMax, double aMax, double aMin, double jMax) const;
+
 
     inline void add_profile(const Profile& profile, double jMax) {
         valid_profiles[valid_profile_counter] = profile;
@@ -49,9 +126,26 @@ class PositionStep1 {
 
 public:
     explicit PositionStep1(double p0, double v0, double a0, double pf, double vf, double af, double vMax, double vMin, double aMax, double aMin, double jMax);
+    explicit PositionStep1(const PositionExpressions& expr, double vMax, double vMin, double aMax, double aMin, double jMax);
 
-    bool get_profile(const Profile& input, Block& block);
+    //! Calculate the time-optimal profile and the blocked intervals, or only the time-optimal profile if minimum_duration_only is set
+    bool get_profile(const Profile& input, Block& block, bool minimum_duration_only = false);
 
+    //! Number of profile cases (without the two-step fallbacks) that were evaluated in the last get_profile call
+    size_t number_evaluated_cases {0};
+
+    //! Did the last get_profile call need the two-step fallbacks (only for numerical issues)?
+    bool used_two_step_fallback {false};
+
+    //! Re-solve in normalized units after get_profile failed, e.g. for limits spanning many orders of magnitude
+    bool get_profile_normalized(const Profile& input, Block& block, bool minimum_duration_only = false) const;
+};
+
+
+//! Profile case of a previous solution, which is tried first in Step 2
+struct ProfileCaseHint {
+    Profile::Limits limits;
+    bool positive_jerk; // Sign of the jerk in the first phase
 };
 
 
@@ -83,8 +177,15 @@ class PositionStep2 {
 
 public:
     explicit PositionStep2(double tf, double p0, double v0, double a0, double pf, double vf, double af, double vMax, double vMin, double aMax, double aMin, double jMax);
+    explicit PositionStep2(double tf, const PositionExpressions& expr, double vMax, double vMin, double aMax, double aMin, double jMax);
 
     bool get_profile(Profile& profile);
+
+    //! Try the profile case of the hint first, then fall back to the full search
+    bool get_profile(Profile& profile, const ProfileCaseHint& hint);
+
+    //! Re-solve in normalized units after get_profile failed, e.g. for limits spanning many orders of magnitude
+    bool get_profile_normalized(Profile& profile) const;
 };
 
 } // namespace ruckig
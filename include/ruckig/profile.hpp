@@ -3,12 +3,14 @@
 #include <algorithm>
 #include <array>
 #include <cmath>
-#include <iomanip>
-#include <iostream>
 #include <limits>
 #include <optional>
 #include <tuple>
 
+#ifndef RUCKIG_HARD_REALTIME
+    #include <string>
+#endif
+
 #include <ruckig/brake.hpp>
 #include <ruckig/roots.hpp>
 
@@ -25,6 +27,46 @@ struct PositionExtrema {
 };
 
 
+//! Information about the velocity and acceleration extrema
+struct KinematicExtrema {
+    //! The extreme velocity and acceleration
+    double min_velocity, max_velocity, min_acceleration, max_acceleration;
+
+    //! Time when they are reached
+    double t_min_velocity, t_max_velocity, t_min_acceleration, t_max_acceleration;
+};
+
+//! Crossing of a position threshold by a DoF
+struct PositionCrossing {
+    //! The DoF and the index of the threshold within its positions
+    size_t dof, index;
+
+    //! Time of the crossing and the velocity at that time (e.g. its sign for the direction)
+    double time, velocity;
+};
+
+//! Kind of an event of a trajectory
+enum class TrajectoryEventType {
+    BrakeEnd, ///< The DoF finished braking into its limits
+    SegmentBoundary, ///< A new segment of constant jerk begins
+    Arrival, ///< The DoF reached its target state
+    Finished, ///< The trajectory ends (for all DoFs)
+};
+
+//! Event of a trajectory, e.g. to wait until the next one instead of polling every cycle
+struct TrajectoryEvent {
+    TrajectoryEventType type;
+
+    //! The DoF, or the number of DoFs for the end of the trajectory
+    size_t dof;
+
+    //! The segment that begins (0-1 for the brake trajectory, 2-8 for the profile, and 9 afterwards)
+    size_t segment;
+
+    double time;
+};
+
+
 //! The state profile for position, velocity, acceleration and jerk for a single DoF
 class Profile {
 public:
@@ -73,23 +115,37 @@ public:
             j = {jf, 0, -jf, 0, jf, 0, -jf};
         }
 
+        // The states are integrated lazily: most candidates are already rejected by their acceleration
         for (size_t i = 0; i < 7; ++i) {
             a[i+1] = a[i] + t[i] * j[i];
-            v[i+1] = v[i] + t[i] * (a[i] + t[i] * j[i] / 2);
-            p[i+1] = p[i] + t[i] * (v[i] + t[i] * (a[i] / 2 + t[i] * j[i] / 6));
         }
 
-        this->jerk_signs = jerk_signs;
-        this->limits = limits;
-
         const double aUppLim = ((aMax > 0) ? aMax : aMin) + 1e-12;
         const double aLowLim = ((aMax > 0) ? aMin : aMax) - 1e-12;
+        if (!(std::abs(a[7] - af) < 1e-10
+            && a[1] >= aLowLim && a[3] >= aLowLim && a[5] >= aLowLim
+            && a[1] <= aUppLim && a[3] <= aUppLim && a[5] <= aUppLim)) {
+            return false;
+        }
+
+        for (size_t i = 0; i < 7; ++i) {
+            v[i+1] = v[i] + t[i] * (a[i] + t[i] * j[i] / 2);
+        }
 
         // Velocity limit can be broken in the beginning if both initial velocity and acceleration are too high
         // std::cout << std::setprecision(15) << "target: " << std::abs(p[7]-pf) << " " << std::abs(v[7] - vf) << " " << std::abs(a[7] - af) << " T: " << t_sum[6] << " " << to_string() << std::endl;
-        return std::abs(v[7] - vf) < 1e-8 && std::abs(a[7] - af) < 1e-10
-            && a[1] >= aLowLim && a[3] >= aLowLim && a[5] >= aLowLim
-            && a[1] <= aUppLim && a[3] <= aUppLim && a[5] <= aUppLim;
+        if (!(std::abs(v[7] - vf) < 1e-8)) {
+            return false;
+        }
+
+        // Only for a valid profile, as the position is its result
+        for (size_t i = 0; i < 7; ++i) {
+            p[i+1] = p[i] + t[i] * (v[i] + t[i] * (a[i] / 2 + t[i] * j[i] / 6));
+        }
+
+        this->jerk_signs = jerk_signs;
+        this->limits = limits;
+        return true;
     }
 
     template<JerkSigns jerk_signs, Limits limits>
@@ -142,13 +198,12 @@ public:
             j = {jf, 0, -jf, 0, jf, 0, -jf};
         }
 
-        const double vUppLim = ((vMax > 0) ? vMax : vMin) + 1e-12;
-        const double vLowLim = ((vMax > 0) ? vMin : vMax) - 1e-12;
-
+        // The states are integrated lazily, from the cheapest test to the most expensive one: first the accelerations
+        // with the final acceleration and the acceleration limits, then the velocities with the final velocity and the
+        // velocity limits, and the positions only for the remaining candidates. Most candidates (e.g. in Step 2) are
+        // rejected before their positions are integrated.
         for (size_t i = 0; i < 7; ++i) {
             a[i+1] = a[i] + t[i] * j[i];
-            v[i+1] = v[i] + t[i] * (a[i] + t[i] * j[i] / 2);
-            p[i+1] = p[i] + t[i] * (v[i] + t[i] * (a[i] / 2 + t[i] * j[i] / 6));
 
             if constexpr (limits == Limits::ACC0_ACC1_VEL || limits == Limits::ACC0_ACC1 || limits == Limits::ACC0_VEL || limits == Limits::ACC1_VEL || limits == Limits::VEL) {
                 if (i == 2) {
@@ -173,6 +228,21 @@ public:
                     }
                 }
             }
+        }
+
+        const double aUppLim = ((aMax > 0) ? aMax : aMin) + 1e-12;
+        const double aLowLim = ((aMax > 0) ? aMin : aMax) - 1e-12;
+        if (!(std::abs(a[7] - af) < 1e-10
+            && a[1] >= aLowLim && a[3] >= aLowLim && a[5] >= aLowLim
+            && a[1] <= aUppLim && a[3] <= aUppLim && a[5] <= aUppLim)) {
+            return false;
+        }
+
+        const double vUppLim = ((vMax > 0) ? vMax : vMin) + 1e-12;
+        const double vLowLim = ((vMax > 0) ? vMin : vMax) - 1e-12;
+
+        for (size_t i = 0; i < 7; ++i) {
+            v[i+1] = v[i] + t[i] * (a[i] + t[i] * j[i] / 2);
 
             if (i > 1 && a[i+1] * a[i] < -std::numeric_limits<double>::epsilon()) {
                 const double v_a_zero = v[i] - (a[i] * a[i]) / (2 * j[i]);
@@ -182,19 +252,22 @@ public:
             }
         }
 
+        // Velocity limit can be broken in the beginning if both initial velocity and acceleration are too high
+        if (!(std::abs(v[7] - vf) < 1e-8
+            && v[3] <= vUppLim && v[4] <= vUppLim && v[5] <= vUppLim && v[6] <= vUppLim
+            && v[3] >= vLowLim && v[4] >= vLowLim && v[5] >= vLowLim && v[6] >= vLowLim)) {
+            return false;
+        }
+
+        for (size_t i = 0; i < 7; ++i) {
+            p[i+1] = p[i] + t[i] * (v[i] + t[i] * (a[i] / 2 + t[i] * j[i] / 6));
+        }
+
         this->jerk_signs = jerk_signs;
         this->limits = limits;
 
-        const double aUppLim = ((aMax > 0) ? aMax : aMin) + 1e-12;
-        const double aLowLim = ((aMax > 0) ? aMin : aMax) - 1e-12;
-
-        // Velocity limit can be broken in the beginning if both initial velocity and acceleration are too high
         // std::cout << std::setprecision(16) << "target: " << std::abs(p[7]-pf) << " " << std::abs(v[7] - vf) << " " << std::abs(a[7] - af) << " T: " << t_sum[6] << " " << to_string() << std::endl;
-        return std::abs(p[7] - pf) < 1e-8 && std::abs(v[7] - vf) < 1e-8 && std::abs(a[7] - af) < 1e-10
-            && a[1] >= aLowLim && a[3] >= aLowLim && a[5] >= aLowLim
-            && a[1] <= aUppLim && a[3] <= aUppLim && a[5] <= aUppLim
-            && v[3] <= vUppLim && v[4] <= vUppLim && v[5] <= vUppLim && v[6] <= vUppLim
-            && v[3] >= vLowLim && v[4] >= vLowLim && v[5] >= vLowLim && v[6] >= vLowLim;
+        return std::abs(p[7] - pf) < 1e-8;
     }
 
     template<JerkSigns jerk_signs, Limits limits>
@@ -227,6 +300,126 @@ public:
         pf = pf_new;
     }
 
+    //! Set the profile to the given one (including its brake pre-trajectory) scaled by a factor, e.g. for the phase
+    //! synchronization of a DoF with collinear input. Returns whether the scaled profile is within the limits, with the
+    //! same checks as for a calculated profile.
+    bool set_scaled(const Profile& profile, double scale, double p0_new, double pf_new, double vMax, double vMin, double aMax, double aMin, double jMax) {
+        const double p0_profile = (profile.brake.duration > 0) ? profile.brake.p[0] : profile.p[0];
+        const double jUppLim = std::abs(jMax) + 1e-12;
+
+        brake.duration = profile.brake.duration;
+        brake.t = profile.brake.t;
+        for (size_t i = 0; i < 2; ++i) {
+            brake.j[i] = scale * profile.brake.j[i];
+            brake.a[i] = scale * profile.brake.a[i];
+            brake.v[i] = scale * profile.brake.v[i];
+            brake.p[i] = p0_new + scale * (profile.brake.p[i] - p0_profile);
+            if (brake.t[i] > 0 && std::abs(brake.j[i]) > jUppLim) {
+                return false;
+            }
+        }
+
+        t = profile.t;
+        t_sum = profile.t_sum;
+        for (size_t i = 0; i < 7; ++i) {
+            j[i] = scale * profile.j[i];
+            if (std::abs(j[i]) > jUppLim) {
+                return false;
+            }
+        }
+        for (size_t i = 0; i < 8; ++i) {
+            a[i] = scale * profile.a[i];
+            v[i] = scale * profile.v[i];
+            p[i] = p0_new + scale * (profile.p[i] - p0_profile);
+        }
+        pf = pf_new;
+        vf = scale * profile.vf;
+        af = scale * profile.af;
+        limits = profile.limits;
+        jerk_signs = profile.jerk_signs;
+        direction = ((scale >= 0) == (profile.direction == Direction::UP)) ? Direction::UP : Direction::DOWN;
+
+        const double vUppLim = ((vMax > 0) ? vMax : vMin) + 1e-12;
+        const double vLowLim = ((vMax > 0) ? vMin : vMax) - 1e-12;
+        for (size_t i = 2; i < 7; ++i) {
+            if (a[i+1] * a[i] < -std::numeric_limits<double>::epsilon()) {
+                const double v_a_zero = v[i] - (a[i] * a[i]) / (2 * j[i]);
+                if (v_a_zero > vUppLim || v_a_zero < vLowLim) {
+                    return false;
+                }
+            }
+        }
+
+        const double aUppLim = ((aMax > 0) ? aMax : aMin) + 1e-12;
+        const double aLowLim = ((aMax > 0) ? aMin : aMax) - 1e-12;
+        return a[1] >= aLowLim && a[3] >= aLowLim && a[5] >= aLowLim
+            && a[1] <= aUppLim && a[3] <= aUppLim && a[5] <= aUppLim
+            && v[3] <= vUppLim && v[4] <= vUppLim && v[5] <= vUppLim && v[6] <= vUppLim
+            && v[3] >= vLowLim && v[4] >= vLowLim && v[5] >= vLowLim && v[6] >= vLowLim;
+    }
+
+    //! Play the profile (including its brake pre-trajectory) slower by a factor in (0, 1], or faster for a factor > 1
+
+    //! The durations are divided by the factor, while the velocities, accelerations, and jerks are multiplied by the
+    //! factor, its square, and its cube. The positions are unchanged.
+    void scale_time(double factor) {
+        const double factor_2 = factor * factor;
+        const double factor_3 = factor_2 * factor;
+
+        brake.duration /= factor;
+        for (size_t i = 0; i < 2; ++i) {
+            brake.t[i] /= factor;
+            brake.j[i] *= factor_3;
+            brake.a[i] *= factor_2;
+            brake.v[i] *= factor;
+        }
+
+        for (size_t i = 0; i < 7; ++i) {
+            t[i] /= factor;
+            t_sum[i] /= factor;
+            j[i] *= factor_3;
+        }
+        for (size_t i = 0; i < 8; ++i) {
+            a[i] *= factor_2;
+            v[i] *= factor;
+        }
+        vf *= factor;
+        af *= factor_2;
+    }
+
+    //! Express the profile (including its brake pre-trajectory) in other units, e.g. to and from normalized units
+
+    //! The durations are multiplied by the time factor, and the positions by the position factor before the offset is
+    //! added. The velocities, accelerations, and jerks follow from both factors.
+    void scale_units(double time_factor, double position_factor, double position_offset) {
+        const double v_factor = position_factor / time_factor;
+        const double a_factor = v_factor / time_factor;
+        const double j_factor = a_factor / time_factor;
+
+        brake.duration *= time_factor;
+        for (size_t i = 0; i < 2; ++i) {
+            brake.t[i] *= time_factor;
+            brake.j[i] *= j_factor;
+            brake.a[i] *= a_factor;
+            brake.v[i] *= v_factor;
+            brake.p[i] = brake.p[i] * position_factor + position_offset;
+        }
+
+        for (size_t i = 0; i < 7; ++i) {
+            t[i] *= time_factor;
+            t_sum[i] *= time_factor;
+            j[i] *= j_factor;
+        }
+        for (size_t i = 0; i < 8; ++i) {
+            a[i] *= a_factor;
+            v[i] *= v_factor;
+            p[i] = p[i] * position_factor + position_offset;
+        }
+        pf = pf * position_factor + position_offset;
+        vf *= v_factor;
+        af *= a_factor;
+    }
+
     //! Set boundary values for the velocity interface
     inline void set_boundary(double p0_new, double v0_new, double a0_new, double vf_new, double af_new) {
         a[0] = a0_new;
@@ -340,6 +533,68 @@ public:
         return false;
     }
 
+    static void check_step_for_kinematic_extremum(double t_sum, double t, double v, double a, double j, KinematicExtrema& ext) {
+        // The acceleration is linear, so that it is extreme at the boundaries of each step
+        if (v < ext.min_velocity) {
+            ext.min_velocity = v;
+            ext.t_min_velocity = t_sum;
+        }
+        if (v > ext.max_velocity) {
+            ext.max_velocity = v;
+            ext.t_max_velocity = t_sum;
+        }
+        if (a < ext.min_acceleration) {
+            ext.min_acceleration = a;
+            ext.t_min_acceleration = t_sum;
+        }
+        if (a > ext.max_acceleration) {
+            ext.max_acceleration = a;
+            ext.t_max_acceleration = t_sum;
+        }
+
+        if (j != 0) {
+            const double t_ext = -a / j;
+            if (0 < t_ext && t_ext < t) {
+                const double v_ext = v + t_ext * (a + t_ext * j / 2);
+                if (j > 0 && v_ext < ext.min_velocity) {
+                    ext.min_velocity = v_ext;
+                    ext.t_min_velocity = t_sum + t_ext;
+                } else if (j < 0 && v_ext > ext.max_velocity) {
+                    ext.max_velocity = v_ext;
+                    ext.t_max_velocity = t_sum + t_ext;
+                }
+            }
+        }
+    }
+
+    KinematicExtrema get_kinematic_extrema() const {
+        KinematicExtrema extrema;
+        extrema.min_velocity = extrema.min_acceleration = std::numeric_limits<double>::infinity();
+        extrema.max_velocity = extrema.max_acceleration = -std::numeric_limits<double>::infinity();
+
+        if (brake.duration > 0.0) {
+            if (brake.t[0] > 0.0) {
+                check_step_for_kinematic_extremum(0.0, brake.t[0], brake.v[0], brake.a[0], brake.j[0], extrema);
+
+                if (brake.t[1] > 0.0) {
+                    check_step_for_kinematic_extremum(brake.t[0], brake.t[1], brake.v[1], brake.a[1], brake.j[1], extrema);
+                }
+            }
+        }
+
+        double t_current_sum {0.0};
+        for (size_t i = 0; i < 7; ++i) {
+            if (i > 0) {
+                t_current_sum = t_sum[i - 1];
+            }
+            check_step_for_kinematic_extremum(t_current_sum + brake.duration, t[i], v[i], a[i], j[i], extrema);
+        }
+
+        check_step_for_kinematic_extremum(t_sum[6] + brake.duration, 0.0, vf, af, 0.0, extrema);
+        return extrema;
+    }
+
+#ifndef RUCKIG_HARD_REALTIME
     std::string to_string() const {
         std::string result;
         switch (direction) {
@@ -362,6 +617,7 @@ public:
         }
         return result;
     }
+#endif
 };
 
 } // namespace ruckig
@@ -0,0 +1,138 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <optional>
+#include <type_traits>
+
+#include <ruckig/ruckig.hpp>
+
+
+namespace ruckig {
+
+//! Online trajectory generation for a real-time control loop (e.g. a ros2_control controller), with all state allocated on construction
+
+//! The instance is constructed when the controller is configured, which allocates the generator, its input and output,
+//! the latency statistics, and three command buffers (for dynamic DoFs). Afterwards, no method allocates or locks: a
+//! non real-time thread (e.g. a subscription callback) writes the next target into command() and publishes it, and the
+//! real-time thread adopts the latest published command at the beginning of update. As in the TrajectoryMailbox, both
+//! sides exchange a buffer index with a single atomic operation, and commands published in between two updates are
+//! dropped. Between commands, update continues the trajectory from its last output state (open loop).
+template<size_t DOFs, size_t MaxDOFs = 0>
+class RealtimeRuckig {
+public:
+    template<class T> using Vector = DOFsVector<T, DOFs, MaxDOFs>;
+
+    //! Target state and kinematic limits of a command, e.g. translated from a trajectory point message
+    struct Command {
+        ControlInterface control_interface;
+        Vector<double> target_position, target_velocity, target_acceleration;
+        Vector<double> max_velocity, max_acceleration, max_jerk;
+        std::optional<double> minimum_duration;
+
+        explicit Command(const InputParameter<DOFs, MaxDOFs>& input): control_interface(input.control_interface), target_position(input.target_position), target_velocity(input.target_velocity), target_acceleration(input.target_acceleration), max_velocity(input.max_velocity), max_acceleration(input.max_acceleration), max_jerk(input.max_jerk), minimum_duration(input.minimum_duration) { }
+    };
+
+private:
+    constexpr static uint8_t index_mask {0b011};
+    constexpr static uint8_t fresh_flag {0b100}; // The middle buffer was published but not received yet
+
+    static_assert(std::atomic<uint8_t>::is_always_lock_free, "[ruckig] the real-time wrapper requires lock-free atomics.");
+
+    Ruckig<DOFs, false, true, MaxDOFs> otg;
+    InputParameter<DOFs, MaxDOFs> input;
+    OutputParameter<DOFs, MaxDOFs> output;
+
+    std::array<Command, 3> commands;
+    uint8_t back_index {0}; // Owned by the non real-time thread
+    std::atomic<uint8_t> middle {1};
+    uint8_t front_index {2}; // Owned by the real-time thread
+
+    //! Copy the target and limits into the preallocated input, so that the vectors keep their memory
+    void apply(const Command& command) {
+        input.control_interface = command.control_interface;
+        input.target_position = command.target_position;
+        input.target_velocity = command.target_velocity;
+        input.target_acceleration = command.target_acceleration;
+        input.max_velocity = command.max_velocity;
+        input.max_acceleration = command.max_acceleration;
+        input.max_jerk = command.max_jerk;
+        input.minimum_duration = command.minimum_duration;
+    }
+
+public:
+    size_t degrees_of_freedom;
+
+    //! Time step between updates (cycle time) in [s]
+    const double delta_time;
+
+    //! Latency histograms of the update calls, e.g. read by a monitoring thread
+    LatencyStatistics<DOFs, MaxDOFs> latency_statistics;
+
+    template <size_t D = DOFs, typename std::enable_if<D >= 1, int>::type = 0>
+    explicit RealtimeRuckig(double delta_time): otg(delta_time), commands({Command {input}, Command {input}, Command {input}}), degrees_of_freedom(DOFs), delta_time(delta_time) {
+        otg.latency_statistics = &latency_statistics;
+    }
+
+    template <size_t D = DOFs, typename std::enable_if<D == 0, int>::type = 0>
+    explicit RealtimeRuckig(size_t dofs, double delta_time): otg(dofs, delta_time), input(dofs), output(dofs), commands({Command {input}, Command {input}, Command {input}}), degrees_of_freedom(dofs), delta_time(delta_time), latency_statistics(dofs) {
+        otg.latency_statistics = &latency_statistics;
+    }
+
+    RealtimeRuckig(const RealtimeRuckig&) = delete;
+    RealtimeRuckig& operator=(const RealtimeRuckig&) = delete;
+
+    // Non real-time side (a single thread)
+
+    //! Command to write before publishing it (a different buffer after each publish, holding an older command)
+    Command& command() {
+        return commands[back_index];
+    }
+
+    //! Publish the written command, which the next update adopts
+    void publish_command() {
+        back_index = middle.exchange(back_index | fresh_flag, std::memory_order_acq_rel) & index_mask;
+    }
+
+    // Real-time side
+
+    //! Start from the given (measured) state and hold it, e.g. when the controller is activated
+
+    //! The target is set to the state at rest, and a command published before is still adopted by the next update.
+    void activate(const Vector<double>& position, const Vector<double>& velocity, const Vector<double>& acceleration) {
+        input.current_position = position;
+        input.current_velocity = velocity;
+        input.current_acceleration = acceleration;
+        input.target_position = position;
+        std::fill(input.target_velocity.begin(), input.target_velocity.end(), 0.0);
+        std::fill(input.target_acceleration.begin(), input.target_acceleration.end(), 0.0);
+        input.control_interface = ControlInterface::Position;
+        input.minimum_duration = std::nullopt;
+    }
+
+    //! Adopt the latest published command (if any) and calculate the output of the next control cycle
+    Result update() {
+        if ((middle.load(std::memory_order_acquire) & fresh_flag) != 0) {
+            front_index = middle.exchange(front_index, std::memory_order_acq_rel) & index_mask;
+            apply(commands[front_index]);
+        }
+
+        const Result result = otg.update(input, output);
+        output.pass_to_input(input);
+        return result;
+    }
+
+    //! The input of the next update, e.g. to set further parameters when configuring the controller (not concurrently to update)
+    InputParameter<DOFs, MaxDOFs>& get_input() {
+        return input;
+    }
+
+    //! The output of the last update, e.g. new_position for the command interfaces
+    const OutputParameter<DOFs, MaxDOFs>& get_output() const {
+        return output;
+    }
+};
+
+} // namespace ruckig
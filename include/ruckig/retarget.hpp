@@ -0,0 +1,365 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <numeric>
+#include <optional>
+#include <tuple>
+
+#include <ruckig/profile.hpp>
+
+
+namespace ruckig {
+
+//! Correction of the remaining profile of a single DoF for a slightly changed target position, e.g. by a vision refinement
+
+//! The profile of the previous trajectory is cut at the current time, and keeps the jerk of each segment. The remaining
+//! segment durations are the unknowns of a small system of equations for the final state and the plateaus at a limit,
+//! which determine the duration of a time-optimal profile. A synchronized profile is additionally corrected to a given
+//! duration, for which its empty plateaus may open up. The Jacobian consists of the analytic sensitivities of these
+//! states with respect to the durations, so that a first-order correction and a few polishing steps (with the same
+//! factorization) move the durations to the new target. The result is only used if it passes the same tolerances and
+//! limits as a calculated profile, otherwise the full calculation is needed.
+class ProfileRetargeting {
+    constexpr static size_t max_equations {10}; // Final state, 2 per plateau, and the duration
+
+    using Matrix = std::array<std::array<double, 7>, max_equations>;
+    using Equations = std::array<double, max_equations>;
+
+    //! Acceleration or velocity of a plateau at a limit, fixed at the start of its segment
+    struct Constraint {
+        bool is_velocity;
+        size_t segment;
+        double value;
+    };
+
+    std::array<double, 7> t, j;
+    double p0, v0, a0, pf;
+    double vMax, vMin, aMax, aMin;
+
+    std::array<size_t, 7> unknowns; // Segments whose duration is corrected
+    size_t number_unknowns {0};
+    std::array<Constraint, 6> constraints;
+    size_t number_constraints {0};
+    bool time_optimal;
+    bool is_supported {true};
+
+    std::array<double, 8> a, v, p; // States at the segment boundaries
+
+    void integrate_states() {
+        a[0] = a0;
+        v[0] = v0;
+        p[0] = p0;
+        for (size_t i = 0; i < 7; ++i) {
+            std::tie(p[i+1], v[i+1], a[i+1]) = Profile::integrate(t[i], p[i], v[i], a[i], j[i]);
+        }
+    }
+
+    //! Residuals of the final state, the plateaus at a limit, and the duration if given (in this order)
+    size_t get_residuals(std::optional<double> duration, Equations& residuals) const {
+        residuals[0] = a[7];
+        residuals[1] = v[7];
+        residuals[2] = p[7] - pf;
+
+        size_t row {3};
+        for (size_t c = 0; c < number_constraints; ++c, ++row) {
+            const Constraint& constraint = constraints[c];
+            residuals[row] = (constraint.is_velocity ? v[constraint.segment] : a[constraint.segment]) - constraint.value;
+        }
+
+        if (duration) {
+            residuals[row] = std::accumulate(t.begin(), t.end(), 0.0) - *duration;
+            ++row;
+        }
+        return row;
+    }
+
+    //! Jacobian of the residuals with respect to the unknown durations
+    void get_jacobian(std::optional<double> duration, Matrix& jacobian) const {
+        std::array<double, 8> t_start;
+        t_start[0] = 0.0;
+        for (size_t i = 0; i < 7; ++i) {
+            t_start[i+1] = t_start[i] + t[i];
+        }
+
+        // A longer segment m shifts the following states by its jerk and the state at its end
+        const auto set_row = [&](size_t row, size_t segment, size_t order) {
+            for (size_t k = 0; k < number_unknowns; ++k) {
+                const size_t m = unknowns[k];
+                if (m >= segment) {
+                    jacobian[row][k] = 0.0;
+                    continue;
+                }
+
+                const double rest = t_start[segment] - t_start[m+1];
+                switch (order) {
+                    case 0: jacobian[row][k] = j[m]; break;
+                    case 1: jacobian[row][k] = a[m+1] + j[m] * rest; break;
+                    default: jacobian[row][k] = v[m+1] + rest * (a[m+1] + j[m] * rest / 2); break;
+                }
+            }
+        };
+
+        set_row(0, 7, 0);
+        set_row(1, 7, 1);
+        set_row(2, 7, 2);
+
+        size_t row {3};
+        for (size_t c = 0; c < number_constraints; ++c, ++row) {
+            set_row(row, constraints[c].segment, constraints[c].is_velocity ? 1 : 0);
+        }
+
+        if (duration) {
+            std::fill_n(jacobian[row].begin(), number_unknowns, 1.0);
+        }
+    }
+
+    //! Same tolerances as for a calculated profile, or a fraction of them
+    static bool is_within_tolerances(const Equations& residuals, size_t rows, double fraction = 1.0) {
+        if (!(std::abs(residuals[0]) < 1e-10 * fraction && std::abs(residuals[1]) < 1e-8 * fraction && std::abs(residuals[2]) < 1e-8 * fraction)) {
+            return false;
+        }
+        for (size_t row = 3; row < rows; ++row) {
+            if (!(std::abs(residuals[row]) < 1e-8 * fraction)) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    //! Minimum-norm solution x = J^T y of J x = b with (J J^T) y = b, factorized once for the first-order correction
+    //! and reused for the polishing steps
+    class LinearSolver {
+        Matrix J;
+        std::array<std::array<double, max_equations>, max_equations> G; // Eliminated, with the multipliers below
+        Equations scales;
+        std::array<size_t, max_equations> order;
+        size_t rows, cols;
+
+    public:
+        size_t rank;
+
+        LinearSolver(const Matrix& jacobian, size_t rows, size_t cols): J(jacobian), rows(rows), cols(cols) {
+            // Each row is scaled to unit size, as the equations have different units
+            for (size_t r = 0; r < rows; ++r) {
+                double scale {0.0};
+                for (size_t c = 0; c < cols; ++c) {
+                    scale = std::max(scale, std::abs(J[r][c]));
+                }
+                scales[r] = (scale > 0.0) ? 1.0 / scale : 1.0;
+                for (size_t c = 0; c < cols; ++c) {
+                    J[r][c] *= scales[r];
+                }
+            }
+
+            for (size_t r = 0; r < rows; ++r) {
+                for (size_t s = r; s < rows; ++s) {
+                    G[r][s] = 0.0;
+                    for (size_t c = 0; c < cols; ++c) {
+                        G[r][s] += J[r][c] * J[s][c];
+                    }
+                    G[s][r] = G[r][s];
+                }
+                order[r] = r;
+            }
+
+            // Gaussian elimination with diagonal pivoting, as G is symmetric positive semi-definite
+            for (rank = 0; rank < rows; ++rank) {
+                size_t pivot {rank};
+                for (size_t r = rank + 1; r < rows; ++r) {
+                    if (G[order[r]][order[r]] > G[order[pivot]][order[pivot]]) {
+                        pivot = r;
+                    }
+                }
+                if (G[order[pivot]][order[pivot]] < 1e-12) {
+                    break;
+                }
+                std::swap(order[rank], order[pivot]);
+
+                const size_t k = order[rank];
+                for (size_t r = rank + 1; r < rows; ++r) {
+                    const size_t i = order[r];
+                    const double factor = G[i][k] / G[k][k];
+                    for (size_t s = rank + 1; s < rows; ++s) {
+                        G[i][order[s]] -= factor * G[k][order[s]];
+                    }
+                    G[i][k] = factor;
+                }
+            }
+        }
+
+        //! Dependent equations (beyond the rank) are left out, they need to hold by themselves
+        void solve(Equations b, std::array<double, 7>& x) const {
+            for (size_t r = 0; r < rows; ++r) {
+                b[r] *= scales[r];
+            }
+            for (size_t r = 0; r < rank; ++r) {
+                const size_t k = order[r];
+                for (size_t s = r + 1; s < rows; ++s) {
+                    b[order[s]] -= G[order[s]][k] * b[k];
+                }
+            }
+
+            Equations y {};
+            for (size_t r = rank; r-- > 0;) {
+                const size_t k = order[r];
+                double sum = b[k];
+                for (size_t s = r + 1; s < rank; ++s) {
+                    sum -= G[k][order[s]] * y[order[s]];
+                }
+                y[k] = sum / G[k][k];
+            }
+
+            for (size_t c = 0; c < cols; ++c) {
+                x[c] = 0.0;
+                for (size_t r = 0; r < rows; ++r) {
+                    x[c] += J[r][c] * y[r];
+                }
+            }
+        }
+    };
+
+public:
+    //! The plateaus at a limit stay there, a time-optimal profile has no others while they are free for a synchronized one
+    explicit ProfileRetargeting(const Profile& previous, double time, double p0, double v0, double a0, double pf, double vMax, double vMin, double aMax, double aMin, bool time_optimal): j(previous.j), p0(p0), v0(v0), a0(a0), pf(pf), vMax(vMax), vMin(vMin), aMax(aMax), aMin(aMin), time_optimal(time_optimal) {
+        // Cut the profile at the current time
+        const double t_profile = time - previous.brake.duration;
+        for (size_t i = 0; i < 7; ++i) {
+            const double start = (i > 0) ? previous.t_sum[i-1] : 0.0;
+            t[i] = std::max(previous.t_sum[i] - std::max(start, t_profile), 0.0);
+        }
+        integrate_states();
+
+        const double a_tolerance = 1e-8 * std::max(std::abs(aMax), std::abs(aMin));
+        const double v_tolerance = 1e-8 * std::max(std::abs(vMax), std::abs(vMin));
+        for (size_t i = 0; i < 7; ++i) {
+            const bool is_current = (number_unknowns == 0);
+            if (time_optimal) {
+                // Consecutive segments with the same jerk (e.g. around an empty plateau) are corrected as one
+                if (t[i] <= 0.0 || (!is_current && j[unknowns[number_unknowns - 1]] == j[i])) {
+                    continue;
+                }
+            } else {
+                // An empty plateau may open up, but not before the current segment
+                if (t[i] <= 0.0 && (j[i] != 0.0 || is_current)) {
+                    continue;
+                }
+            }
+            unknowns[number_unknowns++] = i;
+
+            // The plateau of the current segment starts at the current state anyway
+            if (j[i] != 0.0 || is_current || t[i] <= 0.0) {
+                continue;
+            }
+
+            if (std::abs(a[i] - aMax) < a_tolerance) {
+                constraints[number_constraints++] = {false, i, aMax};
+            } else if (std::abs(a[i] - aMin) < a_tolerance) {
+                constraints[number_constraints++] = {false, i, aMin};
+            } else if (std::abs(a[i]) < a_tolerance && (time_optimal || std::abs(v[i] - vMax) < v_tolerance || std::abs(v[i] - vMin) < v_tolerance)) {
+                constraints[number_constraints++] = {false, i, 0.0};
+                if (std::abs(v[i] - vMax) < v_tolerance) {
+                    constraints[number_constraints++] = {true, i, vMax};
+                } else if (std::abs(v[i] - vMin) < v_tolerance) {
+                    constraints[number_constraints++] = {true, i, vMin};
+                }
+            } else if (time_optimal) {
+                is_supported = false; // A plateau of a time-optimal profile needs to be at a limit
+            }
+        }
+    }
+
+    //! Correct the durations by a first-order step and polishing steps (to the duration if given), and set the profile
+    //! if it is valid. The duration of a time-optimal profile needs to be determined by its structure.
+    bool solve(std::optional<double> duration, Profile& profile) {
+        if (!is_supported || number_unknowns == 0) {
+            return false;
+        }
+
+        Matrix jacobian;
+        Equations residuals;
+        std::array<double, 7> delta;
+        const std::array<double, 7> t_previous = t;
+        // A time-optimal profile is polished well below the tolerances, so that its duration is not longer than necessary
+        const double polish_fraction = time_optimal ? 1e-4 : 1e-1;
+        size_t rows = get_residuals(duration, residuals);
+        for (size_t attempt = 0; attempt < 3 && !is_within_tolerances(residuals, rows, polish_fraction); ++attempt) {
+            get_jacobian(duration, jacobian);
+            const LinearSolver solver {jacobian, rows, number_unknowns};
+            if (time_optimal && solver.rank < number_unknowns) {
+                return false;
+            }
+
+            for (size_t step = 0; step < 3 && !is_within_tolerances(residuals, rows, polish_fraction); ++step) {
+                solver.solve(residuals, delta);
+                for (size_t k = 0; k < number_unknowns; ++k) {
+                    t[unknowns[k]] -= delta[k];
+                }
+                integrate_states();
+                rows = get_residuals(duration, residuals);
+            }
+
+            // An empty plateau that would need a negative duration stays closed, and the correction is repeated
+            const size_t number_open = number_unknowns;
+            number_unknowns = 0;
+            for (size_t k = 0; k < number_open; ++k) {
+                if (t_previous[unknowns[k]] > 0.0 || t[unknowns[k]] >= 0.0) {
+                    unknowns[number_unknowns++] = unknowns[k];
+                }
+            }
+            if (number_unknowns == number_open) {
+                break;
+            }
+
+            t = t_previous;
+            integrate_states();
+            rows = get_residuals(duration, residuals);
+        }
+
+        // Also the equations left out by the solution need to hold
+        for (size_t i = 0; i < 7; ++i) {
+            if (!(t[i] >= 0.0)) {
+                return false;
+            }
+        }
+        if (!is_within_tolerances(residuals, rows)) {
+            return false;
+        }
+
+        const double aUppLim = std::max(aMax, aMin) + 1e-12;
+        const double aLowLim = std::min(aMax, aMin) - 1e-12;
+        const double vUppLim = std::max(vMax, vMin) + 1e-12;
+        const double vLowLim = std::min(vMax, vMin) - 1e-12;
+        for (size_t i = 1; i < 8; ++i) {
+            if (a[i] > aUppLim || a[i] < aLowLim || v[i] > vUppLim || v[i] < vLowLim) {
+                return false;
+            }
+
+            // Velocity extremum within a segment, where its acceleration crosses zero
+            if (j[i-1] != 0.0 && a[i-1] * a[i] < 0.0) {
+                const double v_a_zero = v[i-1] - (a[i-1] * a[i-1]) / (2 * j[i-1]);
+                if (v_a_zero > vUppLim || v_a_zero < vLowLim) {
+                    return false;
+                }
+            }
+        }
+
+        profile.t = t;
+        profile.j = j;
+        profile.a = a;
+        profile.v = v;
+        profile.p = p;
+        profile.t_sum[0] = t[0];
+        for (size_t i = 0; i < 6; ++i) {
+            profile.t_sum[i+1] = profile.t_sum[i] + t[i+1];
+        }
+        profile.pf = pf;
+        profile.vf = 0.0;
+        profile.af = 0.0;
+        profile.brake = BrakeProfile();
+        return true;
+    }
+};
+
+} // namespace ruckig
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <algorithm>
 #include <array>
 #include <cfloat>
 #include <cmath>
@@ -64,8 +65,26 @@ public:
 };
 
 
+#ifdef RUCKIG_CAPTURE_ROOTS
+//! Observers of the solver calls for capturing polynomial corpora, e.g. by otg-roots-benchmark (only with RUCKIG_CAPTURE_ROOTS)
+struct Capture {
+    static inline void (*cubic)(double a, double b, double c, double d) {nullptr};
+    static inline void (*resolvent)(double a, double b, double c) {nullptr};
+    static inline void (*quartic)(double a, double b, double c, double d) {nullptr};
+    static inline void (*interval)(const double* p, size_t n, double l, double h) {nullptr};
+    static inline void (*iterations)(size_t iterations) {nullptr}; // Of the last shrinkInterval call that did not return a bound
+};
+#endif
+
+
 //! Calculate all roots of a*x^3 + b*x^2 + c*x + d = 0
 inline PositiveSet<double, 3> solveCub(double a, double b, double c, double d) {
+#ifdef RUCKIG_CAPTURE_ROOTS
+    if (Capture::cubic) {
+        Capture::cubic(a, b, c, d);
+    }
+#endif
+
     PositiveSet<double, 3> roots;
 
     if (std::abs(d) < DBL_EPSILON) {
@@ -160,6 +179,12 @@ inline PositiveSet<double, 3> solveCub(double a, double b, double c, double d) {
 // The input x must be of length 3
 // Number of zeros are returned
 inline int solveResolvent(double *x, double a, double b, double c) {
+#ifdef RUCKIG_CAPTURE_ROOTS
+    if (Capture::resolvent) {
+        Capture::resolvent(a, b, c);
+    }
+#endif
+
     constexpr double cos120 = -0.50;
     constexpr double sin120 = 0.866025403784438646764;
     
@@ -212,6 +237,12 @@ constexpr double DBL_EPSILON_SQRT {1.483e-8}; // approx std::sqrt(DBL_EPSILON)
 
 //! Calculate all roots of the monic quartic equation: x^4 + a*x^3 + b*x^2 + c*x + d = 0
 inline PositiveSet<double, 4> solveQuartMonic(double a, double b, double c, double d) {
+#ifdef RUCKIG_CAPTURE_ROOTS
+    if (Capture::quartic) {
+        Capture::quartic(a, b, c, d);
+    }
+#endif
+
     PositiveSet<double, 4> roots;
 
     if (std::abs(a) < DBL_EPSILON && std::abs(b) < DBL_EPSILON_SQRT && std::abs(c) < DBL_EPSILON_SQRT && std::abs(d) < DBL_EPSILON) {
@@ -371,13 +402,29 @@ inline std::array<double, N-1> polyMonicDeri(const std::array<double, N>& monic_
     return deriv;
 }
 
-// Safe Newton Method
-constexpr double tolerance {1e-14};
+// Safe Newton Method, the tolerance and the maximal number of iterations can be set when building the library (see
+// RUCKIG_ROOT_TOLERANCE and RUCKIG_ROOT_MAX_ITERATIONS in CMake) to bound the worst-case calculation duration.
+#ifndef RUCKIG_ROOT_TOLERANCE
+#define RUCKIG_ROOT_TOLERANCE 1e-14
+#endif
+
+#ifndef RUCKIG_ROOT_MAX_ITERATIONS
+#define RUCKIG_ROOT_MAX_ITERATIONS 128
+#endif
+
+constexpr double tolerance {RUCKIG_ROOT_TOLERANCE};
+constexpr size_t max_iterations {RUCKIG_ROOT_MAX_ITERATIONS};
 
 // Calculate a single zero of polynom p(x) inside [lbound, ubound]
 // Requirements: p(lbound)*p(ubound) < 0, lbound < ubound
-template <size_t N, size_t maxIts = 128>
+template <size_t N, size_t maxIts = max_iterations>
 inline double shrinkInterval(const std::array<double, N>& p, double l, double h) {
+#ifdef RUCKIG_CAPTURE_ROOTS
+    if (Capture::interval) {
+        Capture::interval(p.data(), N, l, h);
+    }
+#endif
+
     const auto deriv = polyDeri(p);
     const double fl = polyEval(p, l);
     const double fh = polyEval(p, h);
@@ -397,7 +444,8 @@ inline double shrinkInterval(const std::array<double, N>& p, double l, double h)
     double f = polyEval(p, rts);
     double df = polyEval(deriv, rts);
     double temp;
-    for (size_t j = 0; j < maxIts; j++) {
+    size_t j = 0;
+    for (; j < maxIts; j++) {
         if ((((rts - h) * df - f) * ((rts - l) * df - f) > 0.0) || (std::abs(2 * f) > std::abs(dxold * df))) {
             dxold = dx;
             dx = (h - l) / 2;
@@ -428,7 +476,101 @@ inline double shrinkInterval(const std::array<double, N>& p, double l, double h)
         }
     }
 
+#ifdef RUCKIG_CAPTURE_ROOTS
+    if (Capture::iterations) {
+        Capture::iterations(std::min(j + 1, maxIts));
+    }
+#endif
     return rts;
 }
 
+
+// Batch variants for many polynomials given as structure of arrays, e.g. for the batch calculation of trajectories
+
+//! Calculate all roots of a[i]*x^3 + b[i]*x^2 + c[i]*x + d[i] = 0 for i < n
+inline void solveCubBatch(const double* a, const double* b, const double* c, const double* d, PositiveSet<double, 3>* roots, size_t n) {
+    // The closed-form cases depend on the discriminant, so each polynomial takes its own branch
+    for (size_t i = 0; i < n; ++i) {
+        roots[i] = solveCub(a[i], b[i], c[i], d[i]);
+    }
+}
+
+//! Calculate the quartic equations x^4 + b[i]*x^3 + c[i]*x^2 + d[i]*x + e[i] = 0 for i < n
+inline void solveQuartMonicBatch(const double* b, const double* c, const double* d, const double* e, PositiveSet<double, 4>* roots, size_t n) {
+    for (size_t i = 0; i < n; ++i) {
+        roots[i] = solveQuartMonic(b[i], c[i], d[i], e[i]);
+    }
+}
+
+//! Calculate a single zero of each polynom p[i] inside [l[i], h[i]] for i < n, with the same result as shrinkInterval
+
+//! Each chunk of lanes is iterated in lockstep, and lanes that have already converged are masked out. As the loop
+//! over the lanes has no early exit, the compiler can vectorize it.
+template <size_t N, size_t maxIts = max_iterations>
+inline void shrinkIntervalBatch(const std::array<double, N>* p, const double* l, const double* h, double* roots, size_t n) {
+    constexpr size_t lanes {4};
+
+    for (size_t offset = 0; offset < n; offset += lanes) {
+        const size_t width = std::min(lanes, n - offset);
+
+        std::array<std::array<double, N - 1>, lanes> deriv;
+        std::array<double, lanes> lo, hi, rts, dx, dxold, f, df;
+        std::array<bool, lanes> active;
+        size_t number_active {0};
+
+        for (size_t k = 0; k < width; ++k) {
+            const auto& pk = p[offset + k];
+            deriv[k] = polyDeri(pk);
+            lo[k] = l[offset + k];
+            hi[k] = h[offset + k];
+
+            const double fl = polyEval(pk, lo[k]);
+            const double fh = polyEval(pk, hi[k]);
+            active[k] = (fl != 0.0 && fh != 0.0);
+            if (!active[k]) {
+                rts[k] = (fl == 0.0) ? lo[k] : hi[k];
+                continue;
+            }
+            if (fl > 0.0) {
+                std::swap(lo[k], hi[k]);
+            }
+
+            rts[k] = (lo[k] + hi[k]) / 2;
+            dxold[k] = std::abs(hi[k] - lo[k]);
+            dx[k] = dxold[k];
+            f[k] = polyEval(pk, rts[k]);
+            df[k] = polyEval(deriv[k], rts[k]);
+            number_active += 1;
+        }
+
+        for (size_t j = 0; j < maxIts && number_active > 0; j++) {
+            number_active = 0;
+            for (size_t k = 0; k < width; ++k) {
+                if (!active[k]) {
+                    continue;
+                }
+
+                const bool bisect = (((rts[k] - hi[k]) * df[k] - f[k]) * ((rts[k] - lo[k]) * df[k] - f[k]) > 0.0) || (std::abs(2 * f[k]) > std::abs(dxold[k] * df[k]));
+                const double previous = rts[k];
+                dxold[k] = dx[k];
+                dx[k] = bisect ? (hi[k] - lo[k]) / 2 : f[k] / df[k];
+                rts[k] = bisect ? lo[k] + dx[k] : rts[k] - dx[k];
+
+                const bool converged = (bisect ? (lo[k] == rts[k]) : (previous == rts[k])) || std::abs(dx[k]) < tolerance;
+                active[k] = !converged;
+                if (converged) {
+                    continue;
+                }
+
+                f[k] = polyEval(p[offset + k], rts[k]);
+                df[k] = polyEval(deriv[k], rts[k]);
+                (f[k] < 0.0 ? lo[k] : hi[k]) = rts[k];
+                number_active += 1;
+            }
+        }
+
+        std::copy_n(rts.begin(), width, roots + offset);
+    }
+}
+
 } // namespace Roots
@@ -2,17 +2,35 @@
 
 #include <algorithm>
 #include <array>
-#include <chrono>
-#include <iostream>
+#include <exception>
 #include <limits>
 #include <math.h>
 #include <numeric>
 #include <optional>
+#include <thread>
 #include <tuple>
+#include <vector>
 
+#ifndef RUCKIG_HARD_REALTIME
+    #include <iostream>
+#endif
+
+#include <ruckig/approximation.hpp>
+#include <ruckig/calculation_timing.hpp>
+#include <ruckig/case_statistics.hpp>
 #include <ruckig/input_parameter.hpp>
+#include <ruckig/latency_statistics.hpp>
 #include <ruckig/output_parameter.hpp>
+#include <ruckig/speed_override.hpp>
 #include <ruckig/trajectory.hpp>
+#include <ruckig/trajectory_cache.hpp>
+#include <ruckig/trajectory_mailbox.hpp>
+#include <ruckig/waypoint_trajectory.hpp>
+#include <ruckig/worker_pool.hpp>
+
+#ifdef RUCKIG_EXTERN_TEMPLATES
+    #include <ruckig/instantiated_dofs.hpp>
+#endif
 
 
 namespace ruckig {
@@ -20,10 +38,272 @@ namespace ruckig {
 constexpr static size_t DynamicDOFs {0};
 
 //! Main class for the Ruckig algorithm.
-template<size_t DOFs = 0, bool throw_error = false, bool return_error_at_maximal_duration = true>
+template<size_t DOFs = 0, bool throw_error = false, bool return_error_at_maximal_duration = true, size_t MaxDOFs = 0, Instrumentation instrumentation = Instrumentation::Duration, Features features = Features::All, class Limits = RuntimeLimits>
 class Ruckig {
+    static_assert(!(hard_realtime && throw_error), "[ruckig] throw_error is not available in the hard real-time profile.");
+
+    //! Kinematic limits known at compile-time are validated here once, instead of for each calculation
+    constexpr static bool constant_limits {has_constant_limits<Limits>};
+    static_assert(are_valid_constant_limits<Limits>(), "[ruckig] constant kinematic limits need to be positive.");
+
+    //! Kinematic limits of a DoF, either known at compile-time or from the input
+    static double get_max_velocity(const InputParameter<DOFs, MaxDOFs>& input, size_t dof) {
+        if constexpr (constant_limits) {
+            return Limits::max_velocity;
+        } else {
+            return input.max_velocity[dof];
+        }
+    }
+
+    static double get_max_acceleration(const InputParameter<DOFs, MaxDOFs>& input, size_t dof) {
+        if constexpr (constant_limits) {
+            return Limits::max_acceleration;
+        } else {
+            return input.max_acceleration[dof];
+        }
+    }
+
+    static double get_max_jerk(const InputParameter<DOFs, MaxDOFs>& input, size_t dof) {
+        if constexpr (constant_limits) {
+            return Limits::max_jerk;
+        } else {
+            return input.max_jerk[dof];
+        }
+    }
+
     //! Current input, only for comparison for recalculation
-    InputParameter<DOFs> current_input;
+    InputParameter<DOFs, MaxDOFs> current_input;
+
+    //! Was a trajectory calculated for the current input yet?
+    bool current_input_initialized {false};
+
+    //! Is a calculation interrupted, and the time since its start
+    bool calculation_interrupted {false};
+    double calculation_elapsed_time {0.0};
+
+    //! Section of the output trajectory through the intermediate positions of the current input
+    size_t current_section {0};
+    bool has_waypoints {false};
+
+    //! Output of the last update if it finished at rest, so that the next updates only check the input for changes
+    const OutputParameter<DOFs, MaxDOFs>* idle_output {nullptr};
+
+    //! Kinematic limits that were validated by register_limits (only the limits and the control interface are used)
+    InputParameter<DOFs, MaxDOFs> registered_limits;
+    bool has_registered_limits {false};
+
+    //! Profile cases of all calculations so far (only with Instrumentation::Cases)
+    constexpr static bool count_cases {instrumentation >= Instrumentation::Cases};
+
+    void precalculate_lazy_values(const Trajectory<DOFs, MaxDOFs>& trajectory) const {
+        if (precalculate_position_extrema) {
+            trajectory.get_position_extrema();
+        }
+        if (precalculate_kinematic_extrema) {
+            trajectory.get_kinematic_extrema();
+        }
+        if (precalculate_segment_coefficients) {
+            trajectory.get_segment_coefficients();
+        }
+    }
+
+    //! Sample the last time step evenly into the buffers (row-major), the last sample being at the current output time
+
+    //! The (ascending) samples continue the segment walk of the output cursor, and the output state is used as scratch.
+    void sample_subcycles(OutputParameter<DOFs, MaxDOFs>& output, double time_step, size_t number_subsamples, double* new_positions, double* new_velocities, double* new_accelerations) const {
+        size_t section;
+        for (size_t k = 0; k < number_subsamples; ++k) {
+            double time = output.time - time_step * static_cast<double>(number_subsamples - 1 - k) / number_subsamples;
+            if (time < 0.0 && has_waypoints && current_section > 0) {
+                // Before the switch to the current section
+                size_t previous_section = current_section;
+                while (time < 0.0 && previous_section > 0) {
+                    --previous_section;
+                    time += waypoint_trajectory.get_section(previous_section).get_duration();
+                }
+                waypoint_trajectory.get_section(previous_section).at_time(time, output.new_position, output.new_velocity, output.new_acceleration, section);
+            } else {
+                output.trajectory.at_time(time, output.new_position, output.new_velocity, output.new_acceleration, section, output.cursor);
+            }
+
+            const size_t offset = k * degrees_of_freedom;
+            std::copy(output.new_position.begin(), output.new_position.end(), new_positions + offset);
+            if (new_velocities) {
+                std::copy(output.new_velocity.begin(), output.new_velocity.end(), new_velocities + offset);
+            }
+            if (new_accelerations) {
+                std::copy(output.new_acceleration.begin(), output.new_acceleration.end(), new_accelerations + offset);
+            }
+        }
+    }
+
+    //! Convert the current state of the input to the trajectory time of the speed override before a calculation
+    const InputParameter<DOFs, MaxDOFs>& to_trajectory_time(const InputParameter<DOFs, MaxDOFs>& input) {
+        if (speed_override.is_identity()) {
+            return input;
+        }
+
+        // The input of an interrupted calculation is kept as well
+        calculation_input = input;
+        for (size_t dof = 0; dof < degrees_of_freedom; ++dof) {
+            speed_override.to_trajectory_time(calculation_input.current_velocity[dof], calculation_input.current_acceleration[dof]);
+        }
+        return calculation_input;
+    }
+
+    //! Advance the output along the current trajectory (and its sections) by the (real) time step, without the input
+    Result advance(OutputParameter<DOFs, MaxDOFs>& output, double time_step, size_t number_subsamples, double* new_positions, double* new_velocities, double* new_accelerations) {
+        // With a speed override, the trajectory time advances by the ratio
+        const bool is_time_warped = !speed_override.is_identity();
+        if (is_time_warped) {
+            time_step = speed_override.step(time_step);
+        }
+
+        // The sections of a new trajectory start again at zero
+        const size_t old_section = output.new_calculation ? 0 : output.new_section;
+        output.time += time_step;
+
+        if (has_waypoints) {
+            // Calculate the next section ahead, or right away if the current section is finished already
+            if (!waypoint_trajectory.is_calculated() && !output.new_calculation) {
+                const Result result = continue_calculation(waypoint_trajectory);
+                if (result != Result::Working) {
+                    return result;
+                }
+            }
+
+            while (output.time > output.trajectory.get_duration() && current_section + 1 < waypoint_trajectory.size()) {
+                if (waypoint_trajectory.calculated_sections() <= current_section + 1) {
+                    const Result result = continue_calculation(waypoint_trajectory);
+                    if (result != Result::Working) {
+                        return result;
+                    }
+                }
+
+                output.time -= output.trajectory.get_duration();
+                current_section += 1;
+                output.trajectory.assign(waypoint_trajectory.get_section(current_section));
+                output.cursor.reset();
+            }
+        }
+
+        if (number_subsamples > 0) {
+            sample_subcycles(output, time_step, number_subsamples, new_positions, new_velocities, new_accelerations);
+        }
+
+        size_t trajectory_section;
+        output.trajectory.at_time(output.time, output.new_position, output.new_velocity, output.new_acceleration, trajectory_section, output.cursor);
+        output.new_section = has_waypoints ? current_section + trajectory_section : trajectory_section;
+        output.did_section_change = (output.new_section != old_section);
+
+        if (is_time_warped) {
+            for (size_t dof = 0; dof < degrees_of_freedom; ++dof) {
+                speed_override.to_real_time(output.new_velocity[dof], output.new_acceleration[dof]);
+            }
+
+            // The sub-samples are converted with the ratio at the end of the cycle
+            for (size_t i = 0; i < number_subsamples * degrees_of_freedom; ++i) {
+                double velocity {new_velocities ? new_velocities[i] : 0.0}, acceleration {new_accelerations ? new_accelerations[i] : 0.0};
+                speed_override.to_real_time(velocity, acceleration);
+                if (new_velocities) {
+                    new_velocities[i] = velocity;
+                }
+                if (new_accelerations) {
+                    new_accelerations[i] = acceleration;
+                }
+            }
+        }
+
+        if (output.time > output.trajectory.get_duration()) {
+            return Result::Finished;
+        }
+
+        return Result::Working;
+    }
+
+    //! Is the output state at rest, so that it holds (exactly) after a finished trajectory?
+    bool is_at_rest(const OutputParameter<DOFs, MaxDOFs>& output) const {
+        for (size_t dof = 0; dof < degrees_of_freedom; ++dof) {
+            if (output.new_velocity[dof] != 0.0 || output.new_acceleration[dof] != 0.0) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    //! Trajectory with the degrees of freedom of this instance, e.g. as workspace of a calculation
+    Trajectory<DOFs, MaxDOFs> make_workspace() const {
+        if constexpr (DOFs == 0) {
+            return Trajectory<DOFs, MaxDOFs>(degrees_of_freedom);
+        } else {
+            return Trajectory<DOFs, MaxDOFs>();
+        }
+    }
+
+    //! Call the function with the index and the range [begin, end) of contiguous chunks of the given size, on the calling
+    //! thread or spread across threads
+
+    //! Exceptions of the threads are rethrown on the calling thread after all threads have finished.
+    template<class F>
+    static void run_chunks(size_t size, size_t number_threads, const F& calculate_chunk) {
+        if (number_threads == 1) {
+            calculate_chunk(0, 0, size);
+            return;
+        }
+
+        const size_t chunk_size = (size + number_threads - 1) / number_threads;
+        std::vector<std::thread> threads;
+        std::vector<std::exception_ptr> exceptions(number_threads);
+        threads.reserve(number_threads);
+        for (size_t t = 0; t < number_threads; ++t) {
+            const size_t begin = std::min(t * chunk_size, size);
+            const size_t end = std::min(begin + chunk_size, size);
+            threads.emplace_back([&calculate_chunk, &exceptions, t, begin, end]() {
+                try {
+                    calculate_chunk(t, begin, end);
+                } catch (...) {
+                    exceptions[t] = std::current_exception();
+                }
+            });
+        }
+
+        for (auto& thread: threads) {
+            thread.join();
+        }
+
+        for (auto& exception: exceptions) {
+            if (exception) {
+                std::rethrow_exception(exception);
+            }
+        }
+    }
+
+    //! Validate the input and calculate the trajectory, without looking it up in the cache
+
+    //! The error and the profile cases are written to calculation_error and statistics instead of the members, so that
+    //! the calculations of a batch can run on multiple threads.
+    Result calculate_uncached(const InputParameter<DOFs, MaxDOFs>& input, Trajectory<DOFs, MaxDOFs>& trajectory, bool& was_interrupted, WorkerPool* pool, CalculationError& calculation_error, CaseStatistics* statistics) {
+        if (!validate_input(input)) {
+            calculation_error = {Result::ErrorInvalidInput, CalculationPhase::Validation, -1, 0.0};
+            return Result::ErrorInvalidInput;
+        }
+
+        // A single trajectory cannot pass through intermediate positions, see WaypointTrajectory
+        if (!input.intermediate_positions.empty()) {
+            if constexpr (throw_error) {
+                throw std::runtime_error("[ruckig] intermediate positions require a WaypointTrajectory.");
+            }
+            calculation_error = {Result::ErrorInvalidInput, CalculationPhase::Validation, -1, 0.0};
+            return Result::ErrorInvalidInput;
+        }
+
+        const Result result = trajectory.template calculate<throw_error, return_error_at_maximal_duration, false, features, count_cases, Limits>(input, delta_time, was_interrupted, nullptr, pool, statistics);
+        calculation_error = trajectory.get_error();
+        if (result == Result::Working && !was_interrupted) {
+            precalculate_lazy_values(trajectory);
+        }
+        return result;
+    }
 
 public:
     size_t degrees_of_freedom;
@@ -31,6 +311,42 @@ public:
     //! Time step between updates (cycle time) in [s]
     const double delta_time;
 
+    //! Calculate the position extrema right away instead of on the first query, e.g. before sharing the trajectory across threads
+    bool precalculate_position_extrema {false};
+
+    //! Calculate the velocity and acceleration extrema right away as well
+    bool precalculate_kinematic_extrema {false};
+
+    //! Calculate the polynomial coefficients of all segments right away, so that sampling the trajectory (e.g. by
+    //! update) evaluates them with multiply-adds only
+    bool precalculate_segment_coefficients {false};
+
+    //! If only the kinematic limits of the input change (e.g. slightly lowered, or re-sent with numerical noise) and the
+    //! current trajectory still stays within them, update keeps the trajectory and adopts the limits for future
+    //! calculations only. Raised limits are then not used until the next calculation.
+    bool keep_trajectory_within_limits {false};
+
+    //! If only the target position of the input changes slightly (e.g. refined by a vision system during the motion),
+    //! update first corrects the remaining durations of the current trajectory (see Trajectory::calculate_retarget),
+    //! and only calculates a new trajectory if this correction is not possible.
+    bool fast_retargeting {false};
+
+    //! Number of sections that update calculates right away for an input with intermediate positions, afterwards
+    //! one section is calculated per cycle while the earlier sections are executed
+    size_t waypoint_initial_sections {1};
+
+    //! Optional cache of previously calculated trajectories, used by calculate and update (not owned)
+    TrajectoryCache<DOFs, MaxDOFs>* trajectory_cache {nullptr};
+
+    //! Optional pool of worker threads to calculate the DoFs of a trajectory in parallel (not owned)
+    WorkerPool* worker_pool {nullptr};
+
+    //! Speed override of the trajectory time in update, e.g. set `speed_override.target` from a feed-rate knob
+    SpeedOverride speed_override;
+
+    //! Optional latency histograms of the update calls, e.g. read by a monitoring thread (not owned, requires Instrumentation::Duration)
+    LatencyStatistics<DOFs, MaxDOFs>* latency_statistics {nullptr};
+
     template <size_t D = DOFs, typename std::enable_if<D >= 1, int>::type = 0>
     explicit Ruckig(): degrees_of_freedom(DOFs), delta_time(-1.0) {
     }
@@ -41,21 +357,17 @@ public:
 
 
     template <size_t D = DOFs, typename std::enable_if<D == 0, int>::type = 0>
-    explicit Ruckig(size_t dofs): degrees_of_freedom(dofs), delta_time(-1.0), current_input(InputParameter<0>(dofs)) {
+    explicit Ruckig(size_t dofs): current_input(InputParameter<0, MaxDOFs>(dofs)), registered_limits(InputParameter<0, MaxDOFs>(dofs)), degrees_of_freedom(dofs), delta_time(-1.0), calculation_input(InputParameter<0, MaxDOFs>(dofs)), calculation_trajectory(Trajectory<0, MaxDOFs>(dofs)), waypoint_trajectory(WaypointTrajectory<0, MaxDOFs>(dofs)) {
     }
 
     template <size_t D = DOFs, typename std::enable_if<D == 0, int>::type = 0>
-    explicit Ruckig(size_t dofs, double delta_time): degrees_of_freedom(dofs), delta_time(delta_time), current_input(InputParameter<0>(dofs)) {
+    explicit Ruckig(size_t dofs, double delta_time): current_input(InputParameter<0, MaxDOFs>(dofs)), registered_limits(InputParameter<0, MaxDOFs>(dofs)), degrees_of_freedom(dofs), delta_time(delta_time), calculation_input(InputParameter<0, MaxDOFs>(dofs)), calculation_trajectory(Trajectory<0, MaxDOFs>(dofs)), waypoint_trajectory(WaypointTrajectory<0, MaxDOFs>(dofs)) {
     }
 
 
-    //! Validate the input for the trajectory calculation
-    bool validate_input(const InputParameter<DOFs>& input) const {
+    //! Validate the kinematic limits of the input for the trajectory calculation, see register_limits
+    bool validate_limits(const InputParameter<DOFs, MaxDOFs>& input) const {
         for (size_t dof = 0; dof < degrees_of_freedom; ++dof) {
-            if (input.control_interface == ControlInterface::Position && std::isnan(input.current_position[dof])) {
-                return false;
-            }
-
             if (input.control_interface == ControlInterface::Position && std::isnan(input.max_velocity[dof])) {
                 return false;
             }
@@ -87,6 +399,53 @@ public:
             if (input.max_jerk[dof] <= std::numeric_limits<double>::min()) {
                 return false;
             }
+        }
+        return true;
+    }
+
+    //! Validate everything but the kinematic limits of the input, which need to be valid already
+    bool validate_state(const InputParameter<DOFs, MaxDOFs>& input) const {
+        // The input must not use features that are removed at compile-time
+        if constexpr (is_removed(features, Features::Symmetric) || constant_limits) {
+            if (input.min_velocity || input.min_acceleration) {
+                return false;
+            }
+        }
+
+        if constexpr (is_removed(features, Features::Uniform)) {
+            if (input.per_dof_control_interface || input.per_dof_synchronization || input.synchronization_groups) {
+                return false;
+            }
+        }
+
+        if constexpr (is_removed(features, Features::TimeSyncOnly)) {
+            if (input.synchronization != Synchronization::Time || (input.per_dof_synchronization && std::any_of(input.per_dof_synchronization->begin(), input.per_dof_synchronization->end(), [](Synchronization s){ return s != Synchronization::Time; }))) {
+                return false;
+            }
+        }
+
+        if constexpr (is_removed(features, Features::NoMinimumDuration)) {
+            if (input.minimum_duration) {
+                return false;
+            }
+        }
+
+        if constexpr (is_removed(features, Features::Continuous)) {
+            if (input.duration_discretization != DurationDiscretization::Continuous) {
+                return false;
+            }
+        }
+
+        if constexpr (is_removed(features, Features::AllEnabled)) {
+            if (std::any_of(input.enabled.begin(), input.enabled.end(), [](bool enabled){ return !enabled; })) {
+                return false;
+            }
+        }
+
+        for (size_t dof = 0; dof < degrees_of_freedom; ++dof) {
+            if (input.control_interface == ControlInterface::Position && std::isnan(input.current_position[dof])) {
+                return false;
+            }
 
             if (input.control_interface == ControlInterface::Position && std::isnan(input.target_position[dof])) {
                 return false;
@@ -94,33 +453,33 @@ public:
 
             if (input.control_interface == ControlInterface::Position) {
                 if (input.min_velocity) {
-                    if (input.target_velocity[dof] > input.max_velocity[dof] || input.target_velocity[dof] < input.min_velocity.value()[dof]) {
+                    if (input.target_velocity[dof] > get_max_velocity(input, dof) || input.target_velocity[dof] < input.min_velocity.value()[dof]) {
                         return false;
                     }
 
                 } else {
-                    if (std::abs(input.target_velocity[dof]) > input.max_velocity[dof]) {
+                    if (std::abs(input.target_velocity[dof]) > get_max_velocity(input, dof)) {
                         return false;
                     }
                 }
             }
 
             if (input.min_acceleration) {
-                if (input.target_acceleration[dof] > input.max_acceleration[dof] || input.target_acceleration[dof] < input.min_acceleration.value()[dof]) {
+                if (input.target_acceleration[dof] > get_max_acceleration(input, dof) || input.target_acceleration[dof] < input.min_acceleration.value()[dof]) {
                     return false;
                 }
 
             } else {
-                if (std::abs(input.target_acceleration[dof]) > input.max_acceleration[dof]) {
+                if (std::abs(input.target_acceleration[dof]) > get_max_acceleration(input, dof)) {
                     return false;
                 }
             }
 
-            // Target acceleration needs to be accessible from "above" and "below"
-            if (input.control_interface == ControlInterface::Position) {
-                const double min_velocity = input.min_velocity ? input.min_velocity.value()[dof] : -input.max_velocity[dof];
-                const double v_diff = std::min(std::abs(input.max_velocity[dof] - input.target_velocity[dof]), std::abs(min_velocity - input.target_velocity[dof]));
-                const double max_target_acceleration = std::sqrt(2 * input.max_jerk[dof] * v_diff);
+            // Target acceleration needs to be accessible from "above" and "below", which always holds for zero
+            if (input.control_interface == ControlInterface::Position && input.target_acceleration[dof] != 0.0) {
+                const double min_velocity = input.min_velocity ? input.min_velocity.value()[dof] : -get_max_velocity(input, dof);
+                const double v_diff = std::min(std::abs(get_max_velocity(input, dof) - input.target_velocity[dof]), std::abs(min_velocity - input.target_velocity[dof]));
+                const double max_target_acceleration = std::sqrt(2 * get_max_jerk(input, dof) * v_diff);
                 if (std::abs(input.target_acceleration[dof]) > max_target_acceleration) {
                     return false;
                 }
@@ -132,74 +491,622 @@ public:
                 return false;
             }
 
-            if (input.per_dof_control_interface || input.per_dof_synchronization) {
+            if (input.per_dof_control_interface || input.per_dof_synchronization || input.synchronization_groups) {
                 return false;
             }
         }
 
-        // Check for intermediate waypoints here
-        if (!input.intermediate_positions.empty()) {
-            return false;
+        for (const auto& intermediate_position: input.intermediate_positions) {
+            if (input.control_interface != ControlInterface::Position || intermediate_position.size() != degrees_of_freedom) {
+                return false;
+            }
+
+            if (std::any_of(intermediate_position.begin(), intermediate_position.end(), [](double p){ return !std::isfinite(p); })) {
+                return false;
+            }
         }
 
         return true;
     }
 
+    //! Validate the input for the trajectory calculation. The kinematic limits are only validated if they differ from
+    //! the registered ones, and not at all if they are known at compile-time.
+    bool validate_input(const InputParameter<DOFs, MaxDOFs>& input) const {
+        if constexpr (constant_limits) {
+            return validate_state(input);
+        } else {
+            const bool has_valid_limits = has_registered_limits && input.control_interface == registered_limits.control_interface && !input.has_changed_limits(registered_limits);
+            return (has_valid_limits || validate_limits(input)) && validate_state(input);
+        }
+    }
+
+    //! Validate the kinematic limits of the input once, e.g. from a validated configuration that changes rarely
+
+    //! Afterwards, the validation of each calculation with the same limits (and control interface) covers the other
+    //! fields of the input only. Limits that differ from the registered ones are validated as before, until they are
+    //! registered instead. Returns false (and clears the registered limits) if the limits are invalid.
+    bool register_limits(const InputParameter<DOFs, MaxDOFs>& input) {
+        has_registered_limits = validate_limits(input);
+        if (has_registered_limits) {
+            registered_limits.control_interface = input.control_interface;
+            registered_limits.max_velocity = input.max_velocity;
+            registered_limits.max_acceleration = input.max_acceleration;
+            registered_limits.max_jerk = input.max_jerk;
+            registered_limits.min_velocity = input.min_velocity;
+            registered_limits.min_acceleration = input.min_acceleration;
+        }
+        return has_registered_limits;
+    }
+
+    //! Validate the kinematic limits of each calculation again
+    void clear_registered_limits() {
+        has_registered_limits = false;
+    }
+
     //! Calculate a new trajectory for the given input
-    Result calculate(const InputParameter<DOFs>& input, Trajectory<DOFs>& trajectory) {
+    Result calculate(const InputParameter<DOFs, MaxDOFs>& input, Trajectory<DOFs, MaxDOFs>& trajectory) {
         bool was_interrupted {false};
         return calculate(input, trajectory, was_interrupted);
     }
 
     //! Calculate a new trajectory for the given input and check for interruption
-    Result calculate(const InputParameter<DOFs>& input, Trajectory<DOFs>& trajectory, bool& was_interrupted) {
+    Result calculate(const InputParameter<DOFs, MaxDOFs>& input, Trajectory<DOFs, MaxDOFs>& trajectory, bool& was_interrupted) {
+        if (trajectory_cache && trajectory_cache->find(input, trajectory)) {
+            was_interrupted = false;
+            error = {};
+            return Result::Working;
+        }
+
+        const Result result = calculate_uncached(input, trajectory, was_interrupted, worker_pool, error, &case_statistics);
+        if (trajectory_cache && result == Result::Working && !was_interrupted) {
+            trajectory_cache->insert(input, trajectory);
+        }
+        return result;
+    }
+
+    //! Continue a calculation that was interrupted after interrupt_calculation_duration, with the same input
+    Result continue_calculation(const InputParameter<DOFs, MaxDOFs>& input, Trajectory<DOFs, MaxDOFs>& trajectory, bool& was_interrupted) {
+        const Result result = trajectory.template continue_calculation<throw_error, return_error_at_maximal_duration, features, count_cases, Limits>(input, delta_time, was_interrupted, worker_pool, &case_statistics);
+        error = trajectory.get_error();
+        if (result == Result::Working && !was_interrupted) {
+            precalculate_lazy_values(trajectory);
+        }
+        if (trajectory_cache && result == Result::Working && !was_interrupted) {
+            trajectory_cache->insert(input, trajectory);
+        }
+        return result;
+    }
+
+    //! Calculate a new trajectory for the given input and measure the duration of each calculation phase
+    Result calculate(const InputParameter<DOFs, MaxDOFs>& input, Trajectory<DOFs, MaxDOFs>& trajectory, bool& was_interrupted, CalculationTiming<DOFs, MaxDOFs>& timing) {
         if (!validate_input(input)) {
+            error = {Result::ErrorInvalidInput, CalculationPhase::Validation, -1, 0.0};
             return Result::ErrorInvalidInput;
         }
 
-        const Result result = trajectory.template calculate<throw_error, return_error_at_maximal_duration>(input, delta_time, was_interrupted);
+        const Result result = trajectory.template calculate<throw_error, return_error_at_maximal_duration, true, features, count_cases, Limits>(input, delta_time, was_interrupted, &timing, worker_pool, &case_statistics);
+        error = trajectory.get_error();
         return result;
     }
 
+    //! Calculate only the duration of the time-optimal trajectory for the given input, e.g. to rank many candidate motions
+
+    //! Step 2 is skipped, so that the trajectory is only used as workspace (see Trajectory::calculate_min_duration). Its
+    //! independent minimal durations are valid as well. The trajectory cache is not used. A duration above max_duration
+    //! might only be a lower bound, as the calculation stops as soon as a single DoF exceeds it.
+    Result calculate_min_duration(const InputParameter<DOFs, MaxDOFs>& input, Trajectory<DOFs, MaxDOFs>& trajectory, double& duration, double max_duration = std::numeric_limits<double>::infinity()) {
+        if (!validate_input(input)) {
+            error = {Result::ErrorInvalidInput, CalculationPhase::Validation, -1, 0.0};
+            return Result::ErrorInvalidInput;
+        }
+
+        if (!input.intermediate_positions.empty()) {
+            if constexpr (throw_error) {
+                throw std::runtime_error("[ruckig] intermediate positions require a WaypointTrajectory.");
+            }
+            error = {Result::ErrorInvalidInput, CalculationPhase::Validation, -1, 0.0};
+            return Result::ErrorInvalidInput;
+        }
+
+        const Result result = trajectory.template calculate_min_duration<throw_error, return_error_at_maximal_duration, features, Limits>(input, delta_time, worker_pool, max_duration);
+        error = trajectory.get_error();
+        duration = trajectory.get_duration();
+        return result;
+    }
+
+    //! Calculate the duration of the trajectory for the given input, while Step 2 of each DoF is deferred to its first use
+
+    //! See Trajectory::calculate_deferred, the DoFs are then calculated by trajectory.resolve_step2(dof) or
+    //! trajectory.resolve_all_step2(). The trajectory cache is not used.
+    Result calculate_deferred(const InputParameter<DOFs, MaxDOFs>& input, Trajectory<DOFs, MaxDOFs>& trajectory) {
+        if (!validate_input(input)) {
+            error = {Result::ErrorInvalidInput, CalculationPhase::Validation, -1, 0.0};
+            return Result::ErrorInvalidInput;
+        }
+
+        if (!input.intermediate_positions.empty()) {
+            if constexpr (throw_error) {
+                throw std::runtime_error("[ruckig] intermediate positions require a WaypointTrajectory.");
+            }
+            error = {Result::ErrorInvalidInput, CalculationPhase::Validation, -1, 0.0};
+            return Result::ErrorInvalidInput;
+        }
+
+        const Result result = trajectory.template calculate_deferred<throw_error, return_error_at_maximal_duration, features, Limits>(input, delta_time, worker_pool);
+        error = trajectory.get_error();
+        return result;
+    }
+
+    //! Is the target of the input reachable with a synchronized trajectory of at most the given duration?
+
+    //! This is a feasibility check from the minimal durations and blocked intervals of Step 1, without Step 2. It stops
+    //! at the first DoF that cannot reach its target in time. Invalid inputs and failed calculations are unreachable.
+    bool is_reachable_within(const InputParameter<DOFs, MaxDOFs>& input, Trajectory<DOFs, MaxDOFs>& trajectory, double max_duration) {
+        double duration;
+        return calculate_min_duration(input, trajectory, duration, max_duration) == Result::Working && duration <= max_duration;
+    }
+
+    //! Calculate a trajectory through the intermediate positions of the input, optionally only its first sections
+    Result calculate(const InputParameter<DOFs, MaxDOFs>& input, WaypointTrajectory<DOFs, MaxDOFs>& trajectory, size_t number_sections = std::numeric_limits<size_t>::max()) {
+        if (!validate_input(input)) {
+            error = {Result::ErrorInvalidInput, CalculationPhase::Validation, -1, 0.0};
+            return Result::ErrorInvalidInput;
+        }
+
+        return trajectory.template calculate<throw_error, return_error_at_maximal_duration, features>(input, delta_time, number_sections, worker_pool);
+    }
+
+    //! Calculate the given number of following sections of a trajectory through intermediate positions
+    Result continue_calculation(WaypointTrajectory<DOFs, MaxDOFs>& trajectory, size_t number_sections = 1) {
+        return trajectory.template continue_calculation<throw_error, return_error_at_maximal_duration, features>(delta_time, number_sections, worker_pool);
+    }
+
+    //! Validate the current state and the acceleration and jerk limits, which are the only inputs of a stop trajectory
+    bool validate_stop_input(const InputParameter<DOFs, MaxDOFs>& input) const {
+        for (size_t dof = 0; dof < degrees_of_freedom; ++dof) {
+            if (!std::isfinite(input.current_position[dof]) || !std::isfinite(input.current_velocity[dof]) || !std::isfinite(input.current_acceleration[dof])) {
+                return false;
+            }
+
+            if (!(input.max_acceleration[dof] > std::numeric_limits<double>::min()) || !(input.max_jerk[dof] > std::numeric_limits<double>::min()) || std::isinf(input.max_acceleration[dof]) || std::isinf(input.max_jerk[dof])) {
+                return false;
+            }
+
+            if (input.min_acceleration && !(input.min_acceleration.value()[dof] < -std::numeric_limits<double>::min())) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    //! Calculate a trajectory that stops from the current state of the input with closed forms only, see Trajectory::calculate_stop
+    Result calculate_stop(const InputParameter<DOFs, MaxDOFs>& input, Trajectory<DOFs, MaxDOFs>& trajectory, bool synchronize = true) {
+        if constexpr (DOFs == 0 && throw_error) {
+            if (degrees_of_freedom != input.degrees_of_freedom || degrees_of_freedom != trajectory.degrees_of_freedom) {
+                throw std::runtime_error("[ruckig] mismatch in degrees of freedom (vector size).");
+            }
+        }
+
+        if (!validate_stop_input(input)) {
+            error = {Result::ErrorInvalidInput, CalculationPhase::Validation, -1, 0.0};
+            return Result::ErrorInvalidInput;
+        }
+
+        const Result result = trajectory.template calculate_stop<throw_error>(input, synchronize);
+        error = trajectory.get_error();
+        return result;
+    }
+
+    //! Stop from the current state right away, e.g. for an emergency stop, and output the first state of the stop trajectory
+
+    //! The following update calls continue along the stop trajectory as long as the input is unchanged, and calculate a
+    //! new trajectory (from the current state) once the input changes. The ratio of the speed override is reset to 1, so
+    //! that the stop starts with the full dynamics. Set its target to 1 as well to keep them until standstill.
+    Result stop(const InputParameter<DOFs, MaxDOFs>& input, OutputParameter<DOFs, MaxDOFs>& output, bool synchronize = true) {
+        Stopwatch<instrumentation != Instrumentation::None> stopwatch;
+
+        speed_override.reset();
+        idle_output = nullptr;
+        Result result = calculate_stop(input, calculation_trajectory, synchronize);
+        if (result != Result::Working) {
+            return result;
+        }
+
+        output.trajectory.assign(calculation_trajectory);
+        current_input = input;
+        current_input_initialized = true;
+        calculation_interrupted = false;
+        has_waypoints = false;
+        output.time = 0.0;
+        output.cursor.reset();
+        output.new_calculation = true;
+        output.was_calculation_interrupted = false;
+
+        result = advance(output, delta_time, 0, nullptr, nullptr, nullptr);
+        output.calculation_duration = stopwatch.lap();
+        output.pass_to_input(current_input);
+        return result;
+    }
+
+    //! Error of the last calculation (including within update), or Result::Working if it succeeded
+    const CalculationError& get_error() const {
+        return error;
+    }
+
+    //! Profile cases hit by the calculations of this instance so far, only counted with Instrumentation::Cases
+    const CaseStatistics& get_case_statistics() const {
+        return case_statistics;
+    }
+
+    void reset_case_statistics() {
+        case_statistics.reset();
+    }
+
+    //! Trajectory through the intermediate positions of the current input of update, if there are any
+    const WaypointTrajectory<DOFs, MaxDOFs>& get_waypoint_trajectory() const {
+        return waypoint_trajectory;
+    }
+
+    //! Calculate a trajectory for each input of a batch, optionally spread across multiple threads
+
+    //! The trajectories and results are resized to the number of inputs if necessary. Each thread processes
+    //! a contiguous chunk of the batch, so that no synchronization is needed between the calculations. The
+    //! trajectory cache is not used, and the worker pool only for a single thread. Afterwards, get_error returns the
+    //! error of the first failed input of the batch, or Result::Working if all of them succeeded. The profile cases are
+    //! counted per chunk and added to the case statistics afterwards.
+    void calculate_batch(const std::vector<InputParameter<DOFs, MaxDOFs>>& inputs, std::vector<Trajectory<DOFs, MaxDOFs>>& trajectories, std::vector<Result>& results, size_t number_threads = 1) {
+        if (trajectories.size() != inputs.size()) {
+            trajectories.resize(inputs.size(), make_workspace());
+        }
+        results.resize(inputs.size());
+
+        number_threads = std::max<size_t>(std::min(number_threads, inputs.size()), 1);
+
+        // The errors are kept per input and the profile cases per chunk, and both are only merged into the members
+        // after all threads have finished
+        std::vector<CalculationError> errors(inputs.size());
+        std::vector<CaseStatistics> chunk_statistics(count_cases ? number_threads : 0);
+        WorkerPool* pool = (number_threads == 1) ? worker_pool : nullptr;
+        run_chunks(inputs.size(), number_threads, [this, &inputs, &trajectories, &results, &errors, &chunk_statistics, pool](size_t chunk, size_t begin, size_t end) {
+            bool was_interrupted {false};
+            CaseStatistics* statistics = count_cases ? &chunk_statistics[chunk] : nullptr;
+            for (size_t i = begin; i < end; ++i) {
+                results[i] = calculate_uncached(inputs[i], trajectories[i], was_interrupted, pool, errors[i], statistics);
+            }
+        });
+
+        for (const auto& statistics: chunk_statistics) {
+            case_statistics += statistics;
+        }
+
+        const auto failed = std::find_if(errors.begin(), errors.end(), [](const CalculationError& e) { return e.result != Result::Working; });
+        error = (failed != errors.end()) ? *failed : CalculationError {};
+    }
+
+    //! Calculate a conservative approximation of the trajectory, i.e. an upper bound of its duration and bounds of its positions
+
+    //! This is much cheaper than the exact calculation, e.g. for the edges of a sampling-based planner that are evaluated
+    //! but not executed. The exact trajectory of a chosen edge is calculated with calculate afterwards.
+    Result calculate_approximation(const InputParameter<DOFs, MaxDOFs>& input, ConservativeApproximation<DOFs, MaxDOFs>& approximation) {
+        if (!validate_input(input) || !input.intermediate_positions.empty()) {
+            error = {Result::ErrorInvalidInput, CalculationPhase::Validation, -1, 0.0};
+            return Result::ErrorInvalidInput;
+        }
+
+        const Result result = approximation.calculate(input, delta_time);
+        error = {};
+        if (result != Result::Working) {
+            error = {result, (result == Result::ErrorInvalidInput) ? CalculationPhase::Validation : CalculationPhase::Step1, -1, 0.0};
+        }
+        return result;
+    }
+
+    //! Calculate the matrix of the minimal durations from each start to each target, e.g. for assignment problems
+
+    //! The current state, limits, and settings are taken from the starts, and only the target state from the targets.
+    //! The durations are written row-major (one row per start) into a matrix of size `starts.size() * targets.size()`,
+    //! with infinity for invalid inputs and failed calculations. Each thread calculates a contiguous chunk of rows with
+    //! its own workspace, so that the brake trajectories of a start are calculated only once for all its targets.
+    void calculate_min_duration_matrix(const std::vector<InputParameter<DOFs, MaxDOFs>>& starts, const std::vector<InputParameter<DOFs, MaxDOFs>>& targets, std::vector<double>& durations, size_t number_threads = 1) {
+        durations.resize(starts.size() * targets.size());
+        number_threads = std::max<size_t>(std::min(number_threads, starts.size()), 1);
+
+        WorkerPool* pool = (number_threads == 1) ? worker_pool : nullptr;
+        run_chunks(starts.size(), number_threads, [this, &starts, &targets, &durations, pool](size_t, size_t begin, size_t end) {
+            Trajectory<DOFs, MaxDOFs> trajectory = make_workspace();
+            for (size_t i = begin; i < end; ++i) {
+                InputParameter<DOFs, MaxDOFs> input = starts[i];
+                for (size_t j = 0; j < targets.size(); ++j) {
+                    input.target_position = targets[j].target_position;
+                    input.target_velocity = targets[j].target_velocity;
+                    input.target_acceleration = targets[j].target_acceleration;
+
+                    double& duration = durations[i * targets.size() + j];
+                    duration = std::numeric_limits<double>::infinity();
+                    if (validate_input(input) && input.intermediate_positions.empty()) {
+                        if (trajectory.template calculate_min_duration<throw_error, return_error_at_maximal_duration, features, Limits>(input, delta_time, pool) == Result::Working) {
+                            duration = trajectory.get_duration();
+                        }
+                    }
+                }
+            }
+        });
+    }
+
     //! Get the next output state (with step delta_time) along the calculated trajectory for the given input
-    Result update(const InputParameter<DOFs>& input, OutputParameter<DOFs>& output) {
-        const auto start = std::chrono::high_resolution_clock::now();
+    Result update(const InputParameter<DOFs, MaxDOFs>& input, OutputParameter<DOFs, MaxDOFs>& output) {
+        return update(input, output, delta_time);
+    }
+
+    //! Get the next output state along the calculated trajectory for the given input, advanced by the measured time
+    //! step since the last update instead of delta_time, e.g. for control loops with jitter
+
+    //! The output state is sampled from the existing trajectory, so that a varying time step never causes a
+    //! recalculation by itself. The delta_time of the constructor is still used for discrete durations.
+    Result update(const InputParameter<DOFs, MaxDOFs>& input, OutputParameter<DOFs, MaxDOFs>& output, double time_step) {
+        return update(input, output, time_step, 0, nullptr, nullptr, nullptr);
+    }
+
+    //! Get the next output state, and additionally evenly spaced sub-samples of the last cycle, e.g. for drives that are
+    //! commanded at a multiple of the update rate
 
+    //! The states at the times `output.time - delta_time * (number_subsamples - 1 - k) / number_subsamples` are written
+    //! row-major into the caller-provided buffers of size `number_subsamples * degrees_of_freedom`, so that the last
+    //! sub-sample equals the output state. The velocities and accelerations are optional (nullptr).
+    Result update(const InputParameter<DOFs, MaxDOFs>& input, OutputParameter<DOFs, MaxDOFs>& output, size_t number_subsamples, double* new_positions, double* new_velocities = nullptr, double* new_accelerations = nullptr) {
+        return update(input, output, delta_time, number_subsamples, new_positions, new_velocities, new_accelerations);
+    }
+
+    //! Get the next output state advanced by the measured time step, and the sub-samples of this time step
+
+    //! A cycle without a new calculation copies only the new state into the current input, which is kept for the
+    //! comparison with the next input. A new calculation is written into a scratch trajectory, and only if it succeeds,
+    //! the input is copied once and the executable part of the trajectory (its profiles, without the workspace) is copied
+    //! into the output. Otherwise, the output keeps its previous trajectory. Both copies reuse the existing memory. After
+    //! a trajectory finished at rest, the instance is idle: the following cycles only compare the input and advance the
+    //! time of the unchanged output, and are neither timed nor recorded in the latency statistics.
+    Result update(const InputParameter<DOFs, MaxDOFs>& input, OutputParameter<DOFs, MaxDOFs>& output, double time_step, size_t number_subsamples, double* new_positions, double* new_velocities = nullptr, double* new_accelerations = nullptr) {
         if constexpr (DOFs == 0 && throw_error) {
             if (degrees_of_freedom != input.degrees_of_freedom || degrees_of_freedom != output.degrees_of_freedom) {
                 throw std::runtime_error("[ruckig] mismatch in degrees of freedom (vector size).");
             }
         }
 
+        if (!(time_step >= 0.0) || std::isinf(time_step)) {
+            if constexpr (throw_error) {
+                throw std::runtime_error("[ruckig] the time step of the update needs to be finite and non-negative.");
+            }
+            return Result::ErrorInvalidInput;
+        }
+
+        // The output of a finished trajectory at rest stays the same, so it is kept as long as the input is unchanged
+        if (idle_output == &output && number_subsamples == 0 && speed_override.is_identity() && !input.has_changed(current_input)) {
+            output.time += time_step;
+            output.new_calculation = false;
+            output.was_calculation_interrupted = false;
+            output.did_section_change = false;
+            output.calculation_duration = 0.0;
+            return Result::Finished;
+        }
+        idle_output = nullptr;
+
+        Stopwatch<instrumentation != Instrumentation::None> stopwatch;
         output.new_calculation = false;
 
-        if (input != current_input) {
-            Result result = calculate(input, output.trajectory, output.was_calculation_interrupted);
+        if ((!current_input_initialized || input.has_changed(current_input)) && !input.intermediate_positions.empty()) {
+            // The first sections are calculated right away, the following ones in the next cycles
+            const Result result = calculate(to_trajectory_time(input), waypoint_trajectory, waypoint_initial_sections);
+            calculation_interrupted = false;
             if (result != Result::Working) {
                 return result;
             }
 
             current_input = input;
+            current_input_initialized = true;
+            has_waypoints = true;
+            current_section = 0;
+            output.trajectory.assign(waypoint_trajectory.get_section(0));
             output.time = 0.0;
+            output.cursor.reset();
             output.new_calculation = true;
+            output.was_calculation_interrupted = false;
+
+        } else if (keep_trajectory_within_limits && current_input_initialized && !has_waypoints && !calculation_interrupted && speed_override.is_identity()
+            && input.has_changed(current_input) && !input.has_changed_except_limits(current_input)
+            && (constant_limits || output.trajectory.is_within_limits(input.max_velocity, input.max_acceleration, input.max_jerk, input.min_velocity, input.min_acceleration))) {
+            current_input = input;
+            output.was_calculation_interrupted = false;
+
+        } else if (fast_retargeting && current_input_initialized && !has_waypoints && !calculation_interrupted && speed_override.is_identity()
+            && input.has_changed(current_input) && !input.has_changed_except_target_position(current_input)
+            && calculation_trajectory.template calculate_retarget<Limits>(output.trajectory, output.time, input)) {
+            current_input = input;
+            precalculate_lazy_values(calculation_trajectory);
+            output.trajectory.assign(calculation_trajectory);
+            output.time = 0.0;
+            output.cursor.reset();
+            output.new_calculation = true;
+            output.was_calculation_interrupted = false;
+
+        } else if (!current_input_initialized || input.has_changed(current_input)) {
+            has_waypoints = false;
+
+            // The output keeps the previous trajectory if the calculation fails, and with a soft deadline until it is finished
+            const bool interruptible = current_input_initialized && input.interrupt_calculation_duration;
+            const InputParameter<DOFs, MaxDOFs>& trajectory_input = to_trajectory_time(input);
+            Result result;
+            if constexpr (instrumentation >= Instrumentation::Phases) {
+                result = calculate(trajectory_input, calculation_trajectory, output.was_calculation_interrupted, output.calculation_timing);
+            } else {
+                result = calculate(trajectory_input, calculation_trajectory, output.was_calculation_interrupted);
+            }
+
+            // Without a previous trajectory, there is nothing to output in the meantime
+            while (result == Result::Working && output.was_calculation_interrupted && !interruptible) {
+                result = continue_calculation(trajectory_input, calculation_trajectory, output.was_calculation_interrupted);
+            }
+
+            calculation_interrupted = false;
+            if (result != Result::Working) {
+                return result;
+            }
+
+            current_input = input;
+            current_input_initialized = true;
+            if (output.was_calculation_interrupted) {
+                if (&trajectory_input == &input) {
+                    calculation_input = input;
+                }
+                calculation_interrupted = true;
+                calculation_elapsed_time = 0.0;
+            } else {
+                output.trajectory.assign(calculation_trajectory);
+                output.time = 0.0;
+                output.cursor.reset();
+                output.new_calculation = true;
+            }
+
+        } else if (calculation_interrupted) {
+            calculation_elapsed_time += speed_override.get_ratio() * time_step;
+            const Result result = continue_calculation(calculation_input, calculation_trajectory, output.was_calculation_interrupted);
+            if (result != Result::Working) {
+                calculation_interrupted = false;
+                return result;
+            }
+
+            // The new trajectory starts at the state of its input, so it is sampled at the time elapsed since then
+            if (!output.was_calculation_interrupted) {
+                calculation_interrupted = false;
+                output.trajectory.assign(calculation_trajectory);
+                output.time = calculation_elapsed_time;
+                output.cursor.reset();
+                output.new_calculation = true;
+            }
+
+        } else {
+            output.was_calculation_interrupted = false;
         }
 
-        const size_t old_section = output.new_section;
-        output.time += delta_time;
-        output.trajectory.at_time(output.time, output.new_position, output.new_velocity, output.new_acceleration, output.new_section);
-        output.did_section_change = (output.new_section != old_section);
+        const Result result = advance(output, time_step, number_subsamples, new_positions, new_velocities, new_accelerations);
+        if (result < 0) {
+            return result;
+        }
 
-        const auto stop = std::chrono::high_resolution_clock::now();
-        output.calculation_duration = std::chrono::duration_cast<std::chrono::nanoseconds>(stop - start).count() / 1000.0;
+        output.calculation_duration = stopwatch.lap();
+        if constexpr (instrumentation != Instrumentation::None) {
+            if (latency_statistics) {
+                latency_statistics->record(output.calculation_duration, output.new_calculation || output.was_calculation_interrupted, input);
+            }
+        }
 
         output.pass_to_input(current_input);
+        if (result == Result::Finished && !calculation_interrupted && (!has_waypoints || waypoint_trajectory.is_calculated()) && is_at_rest(output)) {
+            idle_output = &output;
+        }
+        return result;
+    }
 
-        if (output.time > output.trajectory.get_duration()) {
-            return Result::Finished;
+    //! Is the instance idle, i.e. did the last update finish at rest and only checks the input for changes?
+    bool is_idle() const {
+        return idle_output != nullptr;
+    }
+
+    //! Get the states of the next cycles at once, e.g. to fill the cyclic buffer of a fieldbus ahead
+
+    //! This is equivalent to calling update and output.pass_to_input(input) for each cycle, however the input is compared
+    //! (and a new trajectory is calculated if necessary) only in the first cycle, and the clock is read only once. The
+    //! states are written row-major into caller-provided buffers of size `number_cycles * degrees_of_freedom`, the
+    //! velocities and accelerations are optional (nullptr). Afterwards, the output and the input hold the state of the
+    //! last cycle, so that the following update calls continue seamlessly. Returns the result of the last cycle.
+    Result update_ahead(InputParameter<DOFs, MaxDOFs>& input, OutputParameter<DOFs, MaxDOFs>& output, size_t number_cycles, double* new_positions, double* new_velocities = nullptr, double* new_accelerations = nullptr) {
+        bool new_calculation {false};
+        Result result {Result::Working};
+        for (size_t cycle = 0; cycle < number_cycles; ++cycle) {
+            // Only the full update passes the output to the current input
+            const bool full_update = (cycle == 0 || calculation_interrupted);
+            if (full_update) {
+                result = update((cycle == 0) ? input : current_input, output);
+            } else {
+                output.new_calculation = false;
+                result = advance(output, delta_time, 0, nullptr, nullptr, nullptr);
+            }
+            if (result < 0) {
+                return result;
+            }
+
+            new_calculation |= output.new_calculation;
+            if (output.did_section_change) {
+                if (!input.intermediate_positions.empty()) {
+                    input.intermediate_positions.pop_front();
+                }
+                if (!full_update && !current_input.intermediate_positions.empty()) {
+                    current_input.intermediate_positions.pop_front();
+                }
+            }
+
+            const size_t offset = cycle * degrees_of_freedom;
+            std::copy(output.new_position.begin(), output.new_position.end(), new_positions + offset);
+            if (new_velocities) {
+                std::copy(output.new_velocity.begin(), output.new_velocity.end(), new_velocities + offset);
+            }
+            if (new_accelerations) {
+                std::copy(output.new_acceleration.begin(), output.new_acceleration.end(), new_accelerations + offset);
+            }
         }
 
-        return Result::Working;
+        output.new_calculation = new_calculation;
+        input.current_position = output.new_position;
+        input.current_velocity = output.new_velocity;
+        input.current_acceleration = output.new_acceleration;
+        current_input.current_position = output.new_position;
+        current_input.current_velocity = output.new_velocity;
+        current_input.current_acceleration = output.new_acceleration;
+        return result;
     }
+
+private:
+    // The workspace of the calculations is only accessed for new trajectories. It starts on its own cache line, so that
+    // the state of each cycle above (including the public members) is packed into as few cache lines as possible.
+
+    //! Scratch trajectory of the calculations within update, handed over to the output only if they succeed. Also the
+    //! input and trajectory of an interrupted calculation, which is continued in the next update calls
+    alignas(cache_line_size) InputParameter<DOFs, MaxDOFs> calculation_input;
+    Trajectory<DOFs, MaxDOFs> calculation_trajectory;
+
+    //! Sections through the intermediate positions of the current input
+    WaypointTrajectory<DOFs, MaxDOFs> waypoint_trajectory;
+
+    //! Error of the last calculation
+    CalculationError error;
+
+    //! Profile cases of all calculations so far
+    CaseStatistics case_statistics;
 };
 
+
+// With the CMake target, the common instantiations are precompiled in the library (see src/instantiations.cpp)
+#ifdef RUCKIG_EXTERN_TEMPLATES
+#define RUCKIG_EXTERN_TEMPLATE(D) \
+    extern template class ExecutableTrajectory<D>; \
+    extern template class Trajectory<D>; \
+    extern template class InputParameter<D>; \
+    extern template class OutputParameter<D>; \
+    extern template class Ruckig<D>; \
+    RUCKIG_EXTERN_TEMPLATE_THROWING(D)
+
+#ifdef RUCKIG_HARD_REALTIME
+    #define RUCKIG_EXTERN_TEMPLATE_THROWING(D)
+#else
+    #define RUCKIG_EXTERN_TEMPLATE_THROWING(D) extern template class Ruckig<D, true>;
+#endif
+
+RUCKIG_FOR_EACH_INSTANTIATED_DOFS(RUCKIG_EXTERN_TEMPLATE)
+#if RUCKIG_INSTANTIATED_DYNAMIC_DOFS && !defined(RUCKIG_HARD_REALTIME)
+RUCKIG_EXTERN_TEMPLATE(0)
+#endif
+
+#undef RUCKIG_EXTERN_TEMPLATE
+#undef RUCKIG_EXTERN_TEMPLATE_THROWING
+#endif
+
 } // namespace ruckig
@@ -0,0 +1,90 @@
+#ifndef RUCKIG_C_H
+#define RUCKIG_C_H
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+//! Version of the C interface, incremented with any change of its types or functions
+#define RUCKIG_C_API_VERSION 1
+
+//! Results of the calculation, with the same values as ruckig::Result
+enum RuckigResult {
+    RUCKIG_WORKING = 0,
+    RUCKIG_FINISHED = 1,
+    RUCKIG_ERROR = -1,
+    RUCKIG_ERROR_INVALID_INPUT = -100,
+    RUCKIG_ERROR_TRAJECTORY_DURATION = -101,
+    RUCKIG_ERROR_POSITIONAL_LIMITS = -102,
+    RUCKIG_ERROR_EXECUTION_TIME_CALCULATION = -110,
+    RUCKIG_ERROR_SYNCHRONIZATION_CALCULATION = -111,
+};
+
+enum RuckigControlInterface {
+    RUCKIG_CONTROL_POSITION = 0,
+    RUCKIG_CONTROL_VELOCITY = 1,
+};
+
+//! Generator with a dynamic number of DoFs, its online input and output, and scratch memory for batches
+typedef struct RuckigGenerator RuckigGenerator;
+
+//! Calculated trajectories of a batch, reused (without allocation) for batches of the same size
+typedef struct RuckigTrajectories RuckigTrajectories;
+
+//! Flat arrays of one or many inputs, all with the same DoFs and control interface
+
+//! The state arrays hold `number_inputs * degrees_of_freedom` values row-major, so that e.g. `current_position[i *
+//! degrees_of_freedom + dof]` belongs to input i. The limits of input i start at `i * limits_stride`, so that a stride
+//! of zero shares `degrees_of_freedom` limits between all inputs. Velocities and accelerations of the current and
+//! target state are zero if NULL, and the minimal limits are the negative maximal limits if NULL.
+typedef struct {
+    const double* current_position;
+    const double* current_velocity;
+    const double* current_acceleration;
+    const double* target_position;
+    const double* target_velocity;
+    const double* target_acceleration;
+    const double* max_velocity;
+    const double* max_acceleration;
+    const double* max_jerk;
+    const double* min_velocity;
+    const double* min_acceleration;
+    size_t limits_stride;
+    int control_interface; ///< RuckigControlInterface
+} RuckigInputArrays;
+
+//! Create a generator, returns NULL on failure. A delta_time of zero or less is only valid for batch calculations.
+RuckigGenerator* ruckig_create(size_t degrees_of_freedom, double delta_time);
+void ruckig_destroy(RuckigGenerator* generator);
+size_t ruckig_degrees_of_freedom(const RuckigGenerator* generator);
+
+//! Get the next state of the online trajectory for the first input of the arrays, returns a RuckigResult
+
+//! The new state is written into arrays of `degrees_of_freedom` values, and is passed as the current state of the next
+//! call by the caller.
+int ruckig_update(RuckigGenerator* generator, const RuckigInputArrays* input, double* new_position, double* new_velocity, double* new_acceleration);
+
+//! Create an empty set of trajectories for the DoFs of the generator, returns NULL on failure
+RuckigTrajectories* ruckig_trajectories_create(const RuckigGenerator* generator);
+void ruckig_trajectories_destroy(RuckigTrajectories* trajectories);
+size_t ruckig_trajectories_size(const RuckigTrajectories* trajectories);
+
+//! Calculate a trajectory for each of the number_inputs inputs of the arrays, optionally spread across multiple threads
+
+//! The results (RuckigResult) are written into an array of number_inputs values, and the durations (optional, NULL)
+//! as well. The trajectories are resized to the number of inputs.
+void ruckig_calculate_batch(RuckigGenerator* generator, const RuckigInputArrays* inputs, size_t number_inputs, RuckigTrajectories* trajectories, int* results, double* durations, size_t number_threads);
+
+//! Sample every trajectory of the batch at the same number_times times
+
+//! The states are written into arrays of `size * number_times * degrees_of_freedom` values, so that e.g.
+//! `new_positions[(k * number_times + i) * degrees_of_freedom + dof]` is the position of trajectory k at `times[i]`.
+void ruckig_sample_batch(const RuckigTrajectories* trajectories, const double* times, size_t number_times, double* new_positions, double* new_velocities, double* new_accelerations);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // RUCKIG_C_H
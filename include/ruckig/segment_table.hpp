@@ -0,0 +1,106 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <stdexcept>
+#include <type_traits>
+
+#include <ruckig/executable_trajectory.hpp>
+
+
+namespace ruckig {
+
+//! Structure-of-arrays copy of the segments of a trajectory, for sampling all DoFs at once with straight-line code
+
+//! On assignment, the profile of each DoF is split into its segments: two for the brake trajectory, seven for the
+//! profile, and one for the constant acceleration afterwards. Their start times and polynomial coefficients are stored
+//! in planes with one value per DoF and segment, so that at_time finds the segment of each DoF by counting the passed
+//! start times and evaluates all DoFs in a single loop without branches, which the compiler can vectorize (with
+//! gathers of the coefficients). This pays off for many DoFs that are sampled at arbitrary times, e.g. 32 DoFs in
+//! every control cycle. The samples agree with the trajectory up to the rounding of the relative times.
+template<size_t DOFs, size_t MaxDOFs = 0>
+class TrajectorySegmentTable {
+    constexpr static size_t number_segments {10};
+
+    template<class T> using Vector = DOFsVector<T, DOFs, MaxDOFs>;
+    template<class T> using Planes = DOFsVector<T, (DOFs >= 1) ? number_segments * DOFs : 0, (MaxDOFs >= 1) ? number_segments * MaxDOFs : 0>;
+    using Sampler = TrajectorySampler<DOFs, MaxDOFs>;
+
+    // Segment k of DoF dof at [k * degrees_of_freedom + dof]
+    Planes<double> starts, positions, velocities, accelerations, jerks;
+    double duration {0.0};
+
+public:
+    size_t degrees_of_freedom;
+
+    template <size_t D = DOFs, typename std::enable_if<D >= 1, int>::type = 0>
+    TrajectorySegmentTable(): degrees_of_freedom(DOFs) { }
+
+    template <size_t D = DOFs, typename std::enable_if<D == 0, int>::type = 0>
+    TrajectorySegmentTable(size_t dofs): degrees_of_freedom(dofs) {
+        starts.resize(number_segments * dofs);
+        positions.resize(number_segments * dofs);
+        velocities.resize(number_segments * dofs);
+        accelerations.resize(number_segments * dofs);
+        jerks.resize(number_segments * dofs);
+    }
+
+    //! Copy the segments of the trajectory, e.g. once after each calculation
+    void assign(const ExecutableTrajectory<DOFs, MaxDOFs>& trajectory) {
+        if constexpr (DOFs == 0) {
+            if (trajectory.degrees_of_freedom != degrees_of_freedom) {
+                throw std::runtime_error("[ruckig] mismatch in degrees of freedom (vector size).");
+            }
+        }
+
+        duration = trajectory.duration;
+        const auto& profiles = trajectory.profiles;
+        for (size_t dof = 0; dof < degrees_of_freedom; ++dof) {
+            // Missing brake segments are copies of the first profile segment, starting at zero as well
+            typename Sampler::Segment segment;
+            for (size_t k = 0; k < number_segments; ++k) {
+                Sampler::load(profiles[dof], k, segment);
+                const size_t i = k * degrees_of_freedom + dof;
+                starts[i] = segment.start;
+                positions[i] = segment.p;
+                velocities[i] = segment.v;
+                accelerations[i] = segment.a;
+                jerks[i] = segment.j;
+            }
+        }
+    }
+
+    //! Get the kinematic state at a given time, the same as ExecutableTrajectory::at_time
+    void at_time(double time, Vector<double>& new_position, Vector<double>& new_velocity, Vector<double>& new_acceleration) const {
+        if constexpr (DOFs == 0) {
+            if (degrees_of_freedom != new_position.size() || degrees_of_freedom != new_velocity.size() || degrees_of_freedom != new_acceleration.size()) {
+                throw std::runtime_error("[ruckig] mismatch in degrees of freedom (vector size).");
+            }
+        }
+
+        // After the duration, all DoFs keep their constant acceleration
+        const size_t n = degrees_of_freedom;
+        const size_t after_duration = (time >= duration) ? number_segments - 1 : 0;
+        for (size_t dof = 0; dof < n; ++dof) {
+            size_t k {0};
+            for (size_t s = 1; s < number_segments; ++s) {
+                k += (starts[s * n + dof] <= time);
+            }
+            const size_t i = std::max(k, after_duration) * n + dof;
+
+            const double t = time - starts[i];
+            const double j = jerks[i], a = accelerations[i], v = velocities[i];
+            new_position[dof] = positions[i] + t * (v + t * (a / 2 + t * j / 6));
+            new_velocity[dof] = v + t * (a + t * j / 2);
+            new_acceleration[dof] = a + t * j;
+        }
+    }
+
+    //! Get the duration of the copied trajectory
+    double get_duration() const {
+        return duration;
+    }
+};
+
+} // namespace ruckig
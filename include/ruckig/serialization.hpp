@@ -0,0 +1,273 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <tuple>
+#include <vector>
+
+#include <ruckig/profile.hpp>
+#include <ruckig/trajectory.hpp>
+
+
+namespace ruckig {
+
+//! Versioned binary format of the executable part of a trajectory
+
+//! A serialized trajectory consists of a header (the magic "RUCKIGTR", the format version and the number of DoFs as
+//! uint32, and the duration) followed by a record per DoF with the segments of its profile and of its brake
+//! sub-profile. All values are stored as little-endian 64-bit integers or IEEE 754 doubles, and every field is 8-byte
+//! aligned, so that multiple trajectories can be concatenated into a single (memory-mapped) archive.
+class TrajectorySerialization {
+    constexpr static std::array<char, 8> magic {'R', 'U', 'C', 'K', 'I', 'G', 'T', 'R'};
+
+    template<size_t N>
+    static uint8_t* store(uint8_t* data, const std::array<double, N>& values) {
+        for (size_t i = 0; i < N; ++i, data += 8) {
+            store(data, values[i]);
+        }
+        return data;
+    }
+
+    template<size_t N>
+    static const uint8_t* load(const uint8_t* data, std::array<double, N>& values) {
+        for (size_t i = 0; i < N; ++i, data += 8) {
+            values[i] = load_double(data);
+        }
+        return data;
+    }
+
+public:
+    //! Version of the binary format, incremented for incompatible changes
+    constexpr static uint32_t version {1};
+
+    constexpr static size_t header_size {24};
+    constexpr static size_t values_per_dof {59};
+
+    // Offsets (in doubles) of the fields within the record of a DoF
+    constexpr static size_t offset_t {0}, offset_t_sum {7}, offset_j {14}, offset_a {21}, offset_v {29}, offset_p {37}, offset_pf {45}, offset_vf {46}, offset_af {47};
+    constexpr static size_t offset_brake_duration {48}, offset_brake_t {49}, offset_brake_j {51}, offset_brake_a {53}, offset_brake_v {55}, offset_brake_p {57};
+
+    static void store(uint8_t* data, uint64_t value) {
+        for (size_t i = 0; i < 8; ++i) {
+            data[i] = static_cast<uint8_t>(value >> (8 * i));
+        }
+    }
+
+    static void store(uint8_t* data, double value) {
+        uint64_t bits;
+        std::memcpy(&bits, &value, sizeof(double));
+        store(data, bits);
+    }
+
+    static uint64_t load_integer(const uint8_t* data) {
+        uint64_t value {0};
+        for (size_t i = 0; i < 8; ++i) {
+            value |= static_cast<uint64_t>(data[i]) << (8 * i);
+        }
+        return value;
+    }
+
+    static double load_double(const uint8_t* data) {
+        const uint64_t bits = load_integer(data);
+        double value;
+        std::memcpy(&value, &bits, sizeof(double));
+        return value;
+    }
+
+    //! Size in bytes of a serialized trajectory with the given number of DoFs
+    constexpr static size_t size(size_t degrees_of_freedom) {
+        return header_size + 8 * values_per_dof * degrees_of_freedom;
+    }
+
+    //! Check the header, and get the number of DoFs of the serialized trajectory (false if it is invalid or incomplete)
+    static bool read_header(const uint8_t* data, size_t size, size_t& degrees_of_freedom) {
+        if (size < header_size || std::memcmp(data, magic.data(), magic.size()) != 0) {
+            return false;
+        }
+
+        const uint64_t version_and_dofs = load_integer(data + 8);
+        if (static_cast<uint32_t>(version_and_dofs) != version) {
+            return false;
+        }
+
+        degrees_of_freedom = static_cast<uint32_t>(version_and_dofs >> 32);
+        return size >= TrajectorySerialization::size(degrees_of_freedom);
+    }
+
+    //! Append the serialized trajectory to the buffer
+    template<size_t DOFs, size_t MaxDOFs>
+    static void write(const ExecutableTrajectory<DOFs, MaxDOFs>& trajectory, std::vector<uint8_t>& buffer) {
+        const size_t begin = buffer.size();
+        buffer.resize(begin + size(trajectory.degrees_of_freedom));
+
+        uint8_t* data = buffer.data() + begin;
+        std::memcpy(data, magic.data(), magic.size());
+        store(data + 8, static_cast<uint64_t>(version) | (static_cast<uint64_t>(trajectory.degrees_of_freedom) << 32));
+        store(data + 16, trajectory.duration);
+
+        data += header_size;
+        for (const Profile& p: trajectory.profiles) {
+            data = store(data, p.t);
+            data = store(data, p.t_sum);
+            data = store(data, p.j);
+            data = store(data, p.a);
+            data = store(data, p.v);
+            data = store(data, p.p);
+            data = store(data, std::array<double, 4> {p.pf, p.vf, p.af, p.brake.duration});
+            data = store(data, p.brake.t);
+            data = store(data, p.brake.j);
+            data = store(data, p.brake.a);
+            data = store(data, p.brake.v);
+            data = store(data, p.brake.p);
+        }
+    }
+
+    //! Load a serialized trajectory, e.g. to continue with its query methods
+
+    //! Returns false if the data is invalid or its number of DoFs does not match.
+    template<size_t DOFs, size_t MaxDOFs>
+    static bool read(const uint8_t* data, size_t size, ExecutableTrajectory<DOFs, MaxDOFs>& trajectory) {
+        size_t degrees_of_freedom;
+        if (!read_header(data, size, degrees_of_freedom) || degrees_of_freedom != trajectory.degrees_of_freedom) {
+            return false;
+        }
+
+        trajectory.duration = load_double(data + 16);
+        data += header_size;
+
+        std::array<double, 4> final_state;
+        for (size_t dof = 0; dof < degrees_of_freedom; ++dof) {
+            Profile& p = trajectory.profiles[dof];
+            data = load(data, p.t);
+            data = load(data, p.t_sum);
+            data = load(data, p.j);
+            data = load(data, p.a);
+            data = load(data, p.v);
+            data = load(data, p.p);
+            data = load(data, final_state);
+            std::tie(p.pf, p.vf, p.af, p.brake.duration) = std::make_tuple(final_state[0], final_state[1], final_state[2], final_state[3]);
+            data = load(data, p.brake.t);
+            data = load(data, p.brake.j);
+            data = load(data, p.brake.a);
+            data = load(data, p.brake.v);
+            data = load(data, p.brake.p);
+
+            trajectory.independent_min_durations[dof] = std::numeric_limits<double>::quiet_NaN(); // Not part of the format
+        }
+        trajectory.position_extrema.reset();
+        trajectory.kinematic_extrema.reset();
+        trajectory.segment_coefficients.reset();
+        return true;
+    }
+
+    //! Load a serialized trajectory into a full trajectory, whose calculation workspace is outdated afterwards
+    template<size_t DOFs, size_t MaxDOFs>
+    static bool read(const uint8_t* data, size_t size, Trajectory<DOFs, MaxDOFs>& trajectory) {
+        if (!read(data, size, static_cast<ExecutableTrajectory<DOFs, MaxDOFs>&>(trajectory))) {
+            return false;
+        }
+
+        for (auto& step1_input: trajectory.step1_inputs) {
+            step1_input.valid = false;
+        }
+        trajectory.has_step2_hints = false;
+        return true;
+    }
+};
+
+
+//! Read-only view of a serialized trajectory, e.g. within a memory-mapped archive
+
+//! The view does not copy the data, which needs to outlive it. Values are decoded on access, so that the data needs
+//! neither a specific alignment nor a little-endian host.
+class TrajectoryView {
+    using Format = TrajectorySerialization;
+
+    const uint8_t* data {nullptr};
+    size_t dofs {0};
+
+    double value(size_t dof, size_t offset) const {
+        return Format::load_double(data + Format::header_size + 8 * (dof * Format::values_per_dof + offset));
+    }
+
+public:
+    //! Create a view of the serialized trajectory at the beginning of the data, check is_valid() afterwards
+    explicit TrajectoryView(const void* data, size_t size) {
+        size_t degrees_of_freedom;
+        if (Format::read_header(static_cast<const uint8_t*>(data), size, degrees_of_freedom)) {
+            this->data = static_cast<const uint8_t*>(data);
+            dofs = degrees_of_freedom;
+        }
+    }
+
+    bool is_valid() const {
+        return data != nullptr;
+    }
+
+    size_t degrees_of_freedom() const {
+        return dofs;
+    }
+
+    //! Size in bytes of the serialized trajectory, i.e. the offset of the next one within an archive
+    size_t size() const {
+        return Format::size(dofs);
+    }
+
+    //! Get the duration of the (synchronized) trajectory
+    double get_duration() const {
+        return Format::load_double(data + 16);
+    }
+
+    //! Get the kinematic state of a single DoF at a given time
+    std::tuple<double, double, double> at_time(double time, size_t dof) const {
+        if (time >= get_duration()) {
+            // Keep constant acceleration
+            const double t_diff = time - (value(dof, Format::offset_brake_duration) + value(dof, Format::offset_t_sum + 6));
+            return Profile::integrate(t_diff, value(dof, Format::offset_pf), value(dof, Format::offset_vf), value(dof, Format::offset_af), 0);
+        }
+
+        double t_diff = time;
+        const double brake_duration = value(dof, Format::offset_brake_duration);
+        if (brake_duration > 0) {
+            if (t_diff < brake_duration) {
+                const size_t index = (t_diff < value(dof, Format::offset_brake_t)) ? 0 : 1;
+                if (index > 0) {
+                    t_diff -= value(dof, Format::offset_brake_t + index - 1);
+                }
+
+                return Profile::integrate(t_diff, value(dof, Format::offset_brake_p + index), value(dof, Format::offset_brake_v + index), value(dof, Format::offset_brake_a + index), value(dof, Format::offset_brake_j + index));
+            } else {
+                t_diff -= brake_duration;
+            }
+        }
+
+        // Non-time synchronization
+        if (t_diff >= value(dof, Format::offset_t_sum + 6)) {
+            // Keep constant acceleration
+            return Profile::integrate(t_diff - value(dof, Format::offset_t_sum + 6), value(dof, Format::offset_pf), value(dof, Format::offset_vf), value(dof, Format::offset_af), 0);
+        }
+
+        size_t index {0};
+        while (value(dof, Format::offset_t_sum + index) <= t_diff) {
+            ++index;
+        }
+
+        if (index > 0) {
+            t_diff -= value(dof, Format::offset_t_sum + index - 1);
+        }
+
+        return Profile::integrate(t_diff, value(dof, Format::offset_p + index), value(dof, Format::offset_v + index), value(dof, Format::offset_a + index), value(dof, Format::offset_j + index));
+    }
+
+    //! Get the kinematic state of all DoFs at a given time
+    template<class Vector>
+    void at_time(double time, Vector& new_position, Vector& new_velocity, Vector& new_acceleration) const {
+        for (size_t dof = 0; dof < dofs; ++dof) {
+            std::tie(new_position[dof], new_velocity[dof], new_acceleration[dof]) = at_time(time, dof);
+        }
+    }
+};
+
+} // namespace ruckig
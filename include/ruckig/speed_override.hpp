@@ -0,0 +1,96 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+
+
+namespace ruckig {
+
+//! Speed override of the trajectory time, e.g. for the feed-rate knob of a CNC or packaging machine
+
+//! The trajectory time advances by `ratio` times the real time, so that the same path is followed slower (or faster)
+//! without a recalculation. The ratio follows the commanded target with a limited rate and a limited change of the
+//! rate, so that the output velocity stays continuous and its acceleration changes by at most `max_rate * |v|`.
+//! With a trajectory velocity v(τ) and acceleration a(τ), the output is v = ratio * v(τ) and
+//! a = ratio² * a(τ) + rate * v(τ). The kinematic limits therefore only hold for ratios of at most 1 and small rates.
+class SpeedOverride {
+    double ratio {1.0};
+    double rate {0.0}; // [1/s]
+
+public:
+    //! Commanded ratio, e.g. 0.5 for half the speed or 0.0 for a feed hold
+    double target {1.0};
+
+    //! Maximal change of the ratio per second [1/s]
+    double max_rate {1.0};
+
+    //! Maximal change of the rate per second [1/s²], up to twice of it in the time step that lands on the target
+    double max_rate_change {10.0};
+
+    //! Current ratio of the trajectory time to the real time
+    double get_ratio() const {
+        return ratio;
+    }
+
+    //! Current change of the ratio per second [1/s]
+    double get_rate() const {
+        return rate;
+    }
+
+    //! Does the trajectory time equal the real time (so that update skips the override)?
+    bool is_identity() const {
+        return ratio == 1.0 && rate == 0.0 && target == 1.0;
+    }
+
+    //! Set the ratio right away with a zero rate, keeping the target
+    void reset(double new_ratio = 1.0) {
+        ratio = std::max(new_ratio, 0.0);
+        rate = 0.0;
+    }
+
+    //! Advance the ratio towards the target by the (real) time step, and return the step of the trajectory time
+    double step(double time_step) {
+        const double goal = std::max(target, 0.0);
+        const double error = goal - ratio;
+        const double max_change = max_rate_change * time_step;
+
+        // The highest rate towards the target from which the ratio can still settle onto it, including the delay of
+        // one time step until the rate changes, so that the ratio doesn't overshoot
+        const double settling_rate = max_rate_change * (std::sqrt(time_step * time_step + 2 * std::abs(error) / max_rate_change) - time_step);
+        const double desired_rate = std::copysign(std::min(max_rate, settling_rate), error);
+        const double new_rate = std::clamp(desired_rate, rate - max_change, rate + max_change);
+        double new_ratio = ratio + (rate + new_rate) / 2 * time_step;
+
+        const double trajectory_time_step = (ratio + std::max(new_ratio, 0.0)) / 2 * time_step;
+        if ((goal - new_ratio) * error <= 0.0 && std::abs(new_rate) <= max_change) {
+            // Land on the target if it is reached within the step
+            ratio = goal;
+            rate = 0.0;
+        } else {
+            ratio = std::max(new_ratio, 0.0);
+            rate = (ratio > 0.0) ? new_rate : 0.0;
+        }
+        return trajectory_time_step;
+    }
+
+    //! Convert a velocity and acceleration from the real time to the trajectory time, e.g. the current state of a recalculation
+    void to_trajectory_time(double& velocity, double& acceleration) const {
+        // Standing still during a feed hold, where any state of the trajectory time maps to rest
+        if (ratio < 1e-6) {
+            velocity = 0.0;
+            acceleration = 0.0;
+            return;
+        }
+
+        velocity /= ratio;
+        acceleration = (acceleration - rate * velocity) / (ratio * ratio);
+    }
+
+    //! Convert a velocity and acceleration sampled from the trajectory to the real time
+    void to_real_time(double& velocity, double& acceleration) const {
+        acceleration = ratio * ratio * acceleration + rate * velocity;
+        velocity *= ratio;
+    }
+};
+
+} // namespace ruckig
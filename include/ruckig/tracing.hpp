@@ -0,0 +1,87 @@
+#pragma once
+
+#include <cstddef>
+#include <limits>
+#include <type_traits>
+
+
+namespace ruckig {
+
+//! The sections of a trajectory calculation and sampling that are reported to the trace policy
+enum class TracePoint {
+    Calculate, ///< Trajectory::calculate or continue_calculation, encloses the other points except AtTime
+    Brake, ///< Brake pre-trajectory of a DoF
+    Step1, ///< Step 1 of a DoF
+    Synchronization, ///< Finding the synchronization duration, including the phase synchronization
+    Step2, ///< Step 2 of a DoF
+    AtTime, ///< Sampling the trajectory at a single time
+};
+
+//! Static name of a trace point, e.g. for trace event names that need to outlive the call
+constexpr const char* trace_point_name(TracePoint point) {
+    switch (point) {
+        case TracePoint::Calculate: return "ruckig::calculate";
+        case TracePoint::Brake: return "ruckig::brake";
+        case TracePoint::Step1: return "ruckig::step1";
+        case TracePoint::Synchronization: return "ruckig::synchronization";
+        case TracePoint::Step2: return "ruckig::step2";
+        case TracePoint::AtTime: return "ruckig::at_time";
+    }
+    return "ruckig";
+}
+
+//! Default trace policy, all trace points are compiled out
+struct NoTracing {
+    static void begin(TracePoint, size_t) { }
+    static void end(TracePoint, size_t) { }
+};
+
+} // namespace ruckig
+
+
+// A trace policy is a class with the static functions begin(TracePoint, size_t dof) and end(TracePoint, size_t dof),
+// chosen at compile-time by defining RUCKIG_TRACE_POLICY as its name. Its header can be given as RUCKIG_TRACE_POLICY_HEADER.
+#ifdef RUCKIG_TRACE_POLICY_HEADER
+#include RUCKIG_TRACE_POLICY_HEADER
+#endif
+
+
+namespace ruckig {
+
+#ifdef RUCKIG_TRACE_POLICY
+using Tracer = RUCKIG_TRACE_POLICY;
+#else
+using Tracer = NoTracing;
+#endif
+
+//! Reports the begin of a trace point at construction and its end at destruction, compiled out for NoTracing
+
+//! The policy is called from the thread that calculates or samples the trajectory, and from the threads of a worker
+//! pool for Step 1 and Step 2. It needs to be real-time safe to be used in a control loop.
+class TraceScope {
+    constexpr static bool enabled {!std::is_same_v<Tracer, NoTracing>};
+
+    TracePoint point;
+    size_t dof;
+
+public:
+    //! DoF of the trace points that are not specific to a single DoF
+    constexpr static size_t all_dofs {std::numeric_limits<size_t>::max()};
+
+    explicit TraceScope(TracePoint point, size_t dof = all_dofs): point(point), dof(dof) {
+        if constexpr (enabled) {
+            Tracer::begin(point, dof);
+        }
+    }
+
+    ~TraceScope() {
+        if constexpr (enabled) {
+            Tracer::end(point, dof);
+        }
+    }
+
+    TraceScope(const TraceScope&) = delete;
+    TraceScope& operator=(const TraceScope&) = delete;
+};
+
+} // namespace ruckig
@@ -2,63 +2,240 @@
 
 #include <algorithm>
 #include <array>
-#include <iostream>
+#include <atomic>
 #include <limits>
 #include <tuple>
 #include <type_traits>
+#include <vector>
 
 #include <ruckig/block.hpp>
 #include <ruckig/brake.hpp>
+#include <ruckig/calculation_timing.hpp>
+#include <ruckig/case_statistics.hpp>
+#include <ruckig/executable_trajectory.hpp>
 #include <ruckig/input_parameter.hpp>
 #include <ruckig/profile.hpp>
 #include <ruckig/position.hpp>
+#include <ruckig/retarget.hpp>
+#include <ruckig/tracing.hpp>
 #include <ruckig/velocity.hpp>
+#include <ruckig/worker_pool.hpp>
 
 
 namespace ruckig {
 
-// Forward declare alternative OTG algorithms for friend class
-template <size_t> class Reflexxes;
-
-
-//! Interface for the generated trajectory.
-template<size_t DOFs>
-class Trajectory {
-    template<class T> using Vector = typename std::conditional<DOFs >= 1, std::array<T, DOFs>, std::vector<T>>::type;
-    template<class T> using VectorIntervals = typename std::conditional<DOFs >= 1, std::array<T, 3*DOFs+1>, std::vector<T>>::type;
+//! Interface for the generated trajectory, i.e. its executable part together with the workspace of its calculation.
+template<size_t DOFs, size_t MaxDOFs = 0>
+class Trajectory: public ExecutableTrajectory<DOFs, MaxDOFs> {
+    using Base = ExecutableTrajectory<DOFs, MaxDOFs>;
+    template<class T> using Vector = DOFsVector<T, DOFs, MaxDOFs>;
+    template<class T> using VectorIntervals = DOFsVector<T, (DOFs >= 1) ? 3*DOFs+1 : 0, (MaxDOFs >= 1) ? 3*MaxDOFs+1 : 0>;
 
     // Allow alternative OTG algorithms to directly access members (i.e. duration)
     friend class Reflexxes<DOFs>;
+    friend class BatchRuckig<DOFs, MaxDOFs>;
+    friend class TrajectorySerialization;
+    template<size_t, size_t, class> friend class CompactTrajectory;
 
     constexpr static double eps {std::numeric_limits<double>::epsilon()};
 
-    // Set of current profiles for each DoF
-    Vector<Profile> profiles;
-
-    double duration {0.0};
-    Vector<double> independent_min_durations;
+    using Base::profiles;
+    using Base::duration;
+    using Base::independent_min_durations;
+    using Base::position_extrema;
+    using Base::kinematic_extrema;
+    using Base::segment_coefficients;
+    using Base::segment_at_time;
+    using Base::state_at_time;
 
     Vector<double> pd;
 
     VectorIntervals<double> possible_t_syncs;
     VectorIntervals<int> idx;
+    Vector<size_t> blocking_dofs;
 
     Vector<Block> blocks;
     Vector<double> p0s, v0s, a0s; // Starting point of profiles without brake trajectory
+    Vector<PositionExpressions> position_expressions; // Pre-calculated expressions for Step 1 and Step 2
     Vector<double> inp_min_velocity, inp_min_acceleration;
 
     Vector<ControlInterface> inp_per_dof_control_interface;
     Vector<Synchronization> inp_per_dof_synchronization;
 
-    Vector<double> new_max_jerk; // For phase synchronization
+    Vector<double> group_durations; // Synchronization duration of the group of each DoF
+    Vector<int> group_limiting_dofs; // Limiting DoF of the group of each DoF
+
 
-    Vector<PositionExtrema> position_extrema;
+    //! Inputs of the brake trajectory and Step 1 of a single DoF, to skip their recalculation if they are unchanged
+    struct Step1Input {
+        bool valid {false};
+        ControlInterface control_interface;
+        bool minimum_duration_only;
+        std::array<double, 11> values;
+
+        bool operator==(const Step1Input& rhs) const {
+            return valid && rhs.valid && control_interface == rhs.control_interface && minimum_duration_only == rhs.minimum_duration_only && values == rhs.values;
+        }
+
+        //! Is the brake trajectory the same, i.e. are only the targets different? E.g. for many targets from one start
+        bool has_same_brake(const Step1Input& rhs) const {
+            return valid && rhs.valid && control_interface == rhs.control_interface && std::equal(values.begin(), values.begin() + 3, rhs.values.begin()) && std::equal(values.begin() + 6, values.end(), rhs.values.begin() + 6);
+        }
+    };
+
+    Vector<Step1Input> step1_inputs; // Inputs of the last Step 1 calculation of each DoF
+    Vector<ProfileCaseHint> step2_hints; // Profile cases of the last time synchronization, for warm starts
+    bool has_step2_hints {false};
+
+    Vector<bool> is_step2_deferred {}; // Step 2 of each DoF that is only calculated on first use, see calculate_deferred
+    size_t number_deferred_step2 {0};
+
+    //! Profile cases of each DoF in the current calculation, only recorded if the cases are counted
+    struct DoFCases {
+        bool position_step1 {false};
+        size_t step1_cases {0}; // Evaluated cases of Step 1 in the position interface
+        bool step1_two_step {false};
+        bool step2 {false};
+        bool normalized {false}; // Step 1 or Step 2 was only solved in normalized units
+    };
+
+    Vector<DoFCases> dof_cases;
+    size_t synchronization_candidates {0}; // Tried in the last synchronization, zero if it was not necessary
+
+    //! Following synchronization candidate whose Step 2 is calculated speculatively, see speculate_step2
+    struct FollowingCandidate {
+        double duration;
+        int limiting_dof;
+        size_t synchronization_candidates;
+        Vector<Profile> profiles;
+    };
+
+    constexpr static size_t max_speculative_candidates {4};
+    std::array<FollowingCandidate, max_speculative_candidates - 1> following_candidates;
+
+    //! Stage at which an interrupted calculation is continued
+    enum class Stage {
+        None, ///< No calculation is in progress
+        Brake,
+        Step1,
+        Synchronization,
+        Step2,
+    };
+
+    Stage calculation_stage {Stage::None};
+    CalculationError error;
+    size_t next_index {0}; // Next DoF of Step 1 or Step 2, or next candidate of the synchronization
+    int limiting_dof {-1}; // The DoF that doesn't need step 2
+    size_t number_candidates {0}, number_blocking_dofs {0};
+    double max_duration_bound {std::numeric_limits<double>::infinity()}; // Of a duration-only calculation
+
+    //! Call the function for each DoF from next_index on, either in order or in chunks on the worker pool
+
+    //! Returns the smallest DoF for which the function failed, or the number of DoFs if it succeeded for all. In order,
+    //! the loop is interrupted after a DoF if the deadline has passed, and continues at next_index the next time.
+    template<class F>
+    size_t for_each_dof(WorkerPool* pool, const Deadline& deadline, bool& was_interrupted, const F& function) {
+        if (!pool || pool->number_threads() == 1) {
+            for (size_t dof = next_index; dof < profiles.size(); ++dof) {
+                if (!function(dof)) {
+                    return dof;
+                }
+
+                if (dof + 1 < profiles.size() && deadline.has_passed()) {
+                    next_index = dof + 1;
+                    was_interrupted = true;
+                    return profiles.size();
+                }
+            }
+            return profiles.size();
+        }
+
+        std::atomic<size_t> failed_dof {profiles.size()};
+        const size_t first_dof = next_index;
+        const size_t chunk_size = (profiles.size() - first_dof + pool->number_threads() - 1) / pool->number_threads();
+        pool->run([this, &function, &failed_dof, first_dof, chunk_size](size_t chunk) {
+            const size_t begin = std::min(first_dof + chunk * chunk_size, profiles.size());
+            const size_t end = std::min(begin + chunk_size, profiles.size());
+            for (size_t dof = begin; dof < end; ++dof) {
+                if (!function(dof)) {
+                    size_t expected = failed_dof.load();
+                    while (dof < expected && !failed_dof.compare_exchange_weak(expected, dof)) { }
+                    return;
+                }
+            }
+        });
+        return failed_dof.load();
+    }
+
+    //! Calculate Step 2 of the current synchronization candidate together with the following ones on the worker pool
+
+    //! Each task is a DoF of a candidate, assigned in turns so that all candidates progress evenly, and a candidate is
+    //! skipped as soon as one of its DoFs failed. The earliest candidate for which all DoFs succeeded is kept. Returns
+    //! the number of DoFs in this case, or else a failed DoF of the current candidate.
+    template<class N, class F>
+    size_t speculate_step2(WorkerPool* pool, size_t number_following, const N& next_candidate, const F& step2) {
+        const size_t current_candidates = synchronization_candidates;
+        size_t number_candidates_step2 {1};
+        for (; number_candidates_step2 <= number_following; ++number_candidates_step2) {
+            FollowingCandidate& candidate = following_candidates[number_candidates_step2 - 1];
+            candidate.profiles = profiles;
+            if (!next_candidate(candidate.duration, candidate.limiting_dof, candidate.profiles)) {
+                break;
+            }
+            candidate.synchronization_candidates = synchronization_candidates;
+        }
+        synchronization_candidates = current_candidates;
+        next_index = 0;
+
+        std::array<std::atomic<bool>, max_speculative_candidates> has_failed;
+        for (auto& failed: has_failed) {
+            failed.store(false, std::memory_order_relaxed);
+        }
+        std::atomic<size_t> failed_dof {profiles.size()};
+
+        const size_t number_tasks = number_candidates_step2 * profiles.size();
+        const size_t number_threads = pool->number_threads();
+        pool->run([&](size_t chunk) {
+            for (size_t task = chunk; task < number_tasks; task += number_threads) {
+                const size_t candidate = task / profiles.size();
+                const size_t dof = task % profiles.size();
+                if (has_failed[candidate].load(std::memory_order_relaxed)) {
+                    continue;
+                }
+
+                const bool found = (candidate == 0) ? step2(dof, duration, limiting_dof, profiles[dof], true) : step2(dof, following_candidates[candidate - 1].duration, following_candidates[candidate - 1].limiting_dof, following_candidates[candidate - 1].profiles[dof], false);
+                if (!found) {
+                    has_failed[candidate].store(true, std::memory_order_relaxed);
+                    if (candidate == 0) {
+                        size_t expected = failed_dof.load();
+                        while (dof < expected && !failed_dof.compare_exchange_weak(expected, dof)) { }
+                    }
+                }
+            }
+        });
+
+        for (size_t candidate = 0; candidate < number_candidates_step2; ++candidate) {
+            if (has_failed[candidate].load(std::memory_order_relaxed)) {
+                continue;
+            }
+
+            if (candidate > 0) {
+                const FollowingCandidate& following = following_candidates[candidate - 1];
+                profiles = following.profiles;
+                duration = following.duration;
+                limiting_dof = following.limiting_dof;
+                synchronization_candidates = following.synchronization_candidates;
+            }
+            return profiles.size();
+        }
+        return failed_dof.load();
+    }
 
     //! Is the trajectory (in principle) phase synchronizable?
-    bool is_input_collinear(const InputParameter<DOFs>& inp, const Vector<double>& jMax, Profile::Direction limiting_direction, size_t limiting_dof, Vector<double>& new_max_jerk) {
+    bool is_input_collinear(const InputParameter<DOFs, MaxDOFs>& inp, size_t limiting_dof) {
         // Get scaling factor of first DoF
         bool pd_found_nonzero {false};
-        double v0_scale, a0_scale, vf_scale, af_scale;
+        double v0_scale {0.0}, a0_scale {0.0}, vf_scale {0.0}, af_scale {0.0};
         for (size_t dof = 0; dof < pd.size(); ++dof) {
             if (inp_per_dof_synchronization[dof] != Synchronization::Phase) {
                 continue;
@@ -75,11 +252,12 @@ class Trajectory {
             }
         }
 
-        if (!pd_found_nonzero) { // position difference is zero everywhere...
+        // The other profiles are scaled by the position difference of the limiting DoF
+        pd[limiting_dof] = inp.target_position[limiting_dof] - inp.current_position[limiting_dof];
+        if (!pd_found_nonzero || std::abs(pd[limiting_dof]) <= eps) { // position difference is zero everywhere...
             return false;
         }
 
-        const double max_jerk_limiting = (limiting_direction == Profile::Direction::UP) ? jMax[limiting_dof] : -jMax[limiting_dof];
         constexpr double eps_colinear {10 * eps};
         
         for (size_t dof = 0; dof < pd.size(); ++dof) {
@@ -96,140 +274,993 @@ class Trajectory {
             ) {
                 return false;
             }
-
-            const double scale = pd[dof] / pd[limiting_dof];
-            new_max_jerk[dof] = scale * max_jerk_limiting;
         }
 
         return true;
     }
 
-    bool synchronize(const Vector<Block>& blocks, std::optional<double> t_min, double& t_sync, int& limiting_dof, Vector<Profile>& profiles, bool discrete_duration, double delta_time) {
-        if (degrees_of_freedom == 1 && !t_min && !discrete_duration) {
-            limiting_dof = 0;
-            t_sync = blocks[0].t_min;
-            profiles[0] = blocks[0].p_min;
+    //! Find the synchronization duration, continuing at the candidate next_index if it is non-zero
+
+    //! The candidates are tested in sorted order, and the loop is interrupted if the deadline has passed.
+    //! With groups, only the DoFs of the given group are synchronized.
+    bool synchronize(const Vector<Block>& blocks, std::optional<double> t_min, double& t_sync, int& limiting_dof, Vector<Profile>& profiles, bool discrete_duration, double delta_time, const Deadline& deadline, bool& was_interrupted, const Vector<size_t>* groups = nullptr, size_t group = 0) {
+        if (next_index == 0) {
+            if (degrees_of_freedom == 1 && !t_min && !discrete_duration) {
+                limiting_dof = 0;
+                t_sync = blocks[0].t_min;
+                profiles[0] = blocks[0].get_min_profile();
+                synchronization_candidates = 0;
+                return true;
+            }
+
+            prepare_synchronization(blocks, t_min, discrete_duration, delta_time, groups, group);
+        }
+
+        for (size_t i = next_index; i < number_candidates; ++i) {
+            const double possible_t_sync = possible_t_syncs[idx[i]];
+            if (std::any_of(blocking_dofs.begin(), blocking_dofs.begin() + number_blocking_dofs, [&blocks, possible_t_sync](size_t dof){ return blocks[dof].is_blocked(possible_t_sync); })) {
+                if (i + 1 < number_candidates && deadline.has_passed()) {
+                    next_index = i + 1;
+                    was_interrupted = true;
+                    return false;
+                }
+                continue;
+            }
+
+            t_sync = possible_t_sync;
+            synchronization_candidates = i + 1;
+            if (static_cast<size_t>(idx[i]) == 3*degrees_of_freedom) { // Optional t_min
+                limiting_dof = -1;
+                return true;
+            }
+
+            const auto div = std::div(idx[i], degrees_of_freedom);
+            limiting_dof = div.rem;
+            switch (div.quot) {
+                case 0: {
+                    profiles[limiting_dof] = blocks[limiting_dof].get_min_profile();
+                } break;
+                case 1: {
+                    profiles[limiting_dof] = blocks[limiting_dof].get_profile(blocks[limiting_dof].a);
+                } break;
+                case 2: {
+                    profiles[limiting_dof] = blocks[limiting_dof].get_profile(blocks[limiting_dof].b);
+                } break;
+            }
             return true;
         }
 
+        return false;
+    }
+
+    //! Find the synchronization duration of each group independently, the duration of the trajectory is the longest one
+
+    //! The groups are synchronized at once, without interruption by the deadline.
+    bool synchronize_groups(const Vector<size_t>& groups, std::optional<double> t_min, bool discrete_duration, double delta_time) {
+        const Deadline no_deadline {std::nullopt};
+        bool was_interrupted {false};
+
+        duration = 0.0;
+        limiting_dof = -1;
+        for (size_t dof = 0; dof < degrees_of_freedom; ++dof) {
+            // Each group is synchronized at its first DoF
+            if (std::find(groups.begin(), groups.begin() + dof, groups[dof]) != groups.begin() + dof) {
+                continue;
+            }
+
+            double t_sync;
+            int group_limiting_dof;
+            next_index = 0;
+            if (!synchronize(blocks, t_min, t_sync, group_limiting_dof, profiles, discrete_duration, delta_time, no_deadline, was_interrupted, &groups, groups[dof])) {
+                return false;
+            }
+
+            for (size_t other = dof; other < degrees_of_freedom; ++other) {
+                if (groups[other] == groups[dof]) {
+                    group_durations[other] = t_sync;
+                    group_limiting_dofs[other] = group_limiting_dof;
+                }
+            }
+            if (t_sync > duration) {
+                duration = t_sync;
+                limiting_dof = group_limiting_dof;
+            }
+        }
+        return true;
+    }
+
+    //! First multiple of delta_time at or after the given time, robust against the rounding of the division
+    static double first_multiple_at(double time, double delta_time) {
+        double steps = std::ceil(time / delta_time);
+        if (steps * delta_time < time) {
+            steps += 1;
+        }
+        return steps * delta_time;
+    }
+
+    //! Collect the possible synchronization durations (of the DoFs of the group) and sort them
+    void prepare_synchronization(const Vector<Block>& blocks, std::optional<double> t_min, bool discrete_duration, double delta_time, const Vector<size_t>* groups, size_t group) {
+        const auto is_in_group = [groups, group](size_t dof) {
+            return !groups || (*groups)[dof] == group;
+        };
+
         // Possible t_syncs are the start times of the intervals and optional t_min
-        bool any_interval {false};
         for (size_t dof = 0; dof < degrees_of_freedom; ++dof) {
-            possible_t_syncs[dof] = blocks[dof].t_min;
-            possible_t_syncs[degrees_of_freedom + dof] = blocks[dof].a ? blocks[dof].a->right : std::numeric_limits<double>::infinity();
-            possible_t_syncs[2 * degrees_of_freedom + dof] = blocks[dof].b ? blocks[dof].b->right : std::numeric_limits<double>::infinity();
-            any_interval |= blocks[dof].a || blocks[dof].b;
+            const bool in_group = is_in_group(dof);
+            possible_t_syncs[dof] = in_group ? blocks[dof].t_min : std::numeric_limits<double>::infinity();
+            possible_t_syncs[degrees_of_freedom + dof] = (in_group && blocks[dof].has_a) ? blocks[dof].a.right : std::numeric_limits<double>::infinity();
+            possible_t_syncs[2 * degrees_of_freedom + dof] = (in_group && blocks[dof].has_b) ? blocks[dof].b.right : std::numeric_limits<double>::infinity();
         }
         possible_t_syncs[3 * degrees_of_freedom] = t_min.value_or(std::numeric_limits<double>::infinity());
-        any_interval |= t_min.has_value();
 
+        // The first admissible multiple of delta_time is the first multiple after the start of an unblocked region,
+        // so rounding each candidate up finds it from the blocked intervals alone, without any Step 2 calculation.
+        // The rounding must never fall below the candidate, which would be blocked by its own DoF.
         if (discrete_duration) {
             for (size_t i = 0; i < possible_t_syncs.size(); ++i) {
-                possible_t_syncs[i] = std::ceil(possible_t_syncs[i] / delta_time) * delta_time;
+                if (possible_t_syncs[i] < std::numeric_limits<double>::infinity()) {
+                    possible_t_syncs[i] = first_multiple_at(possible_t_syncs[i], delta_time);
+                }
+            }
+        }
+
+        // Every t_sync below the largest minimal duration is blocked, so that only the few remaining candidates need
+        // to be sorted. Only DoFs with blocked intervals can block a remaining candidate.
+        double t_lower = t_min.value_or(0.0);
+        number_blocking_dofs = 0;
+        for (size_t dof = 0; dof < degrees_of_freedom; ++dof) {
+            if (!is_in_group(dof)) {
+                continue;
+            }
+            t_lower = std::max(t_lower, blocks[dof].t_min);
+            if (blocks[dof].has_a || blocks[dof].has_b) {
+                blocking_dofs[number_blocking_dofs] = dof;
+                ++number_blocking_dofs;
+            }
+        }
+
+        auto idx_end = idx.begin();
+        for (size_t i = 0; i < possible_t_syncs.size(); ++i) {
+            if (possible_t_syncs[i] >= t_lower && possible_t_syncs[i] < std::numeric_limits<double>::infinity()) {
+                *idx_end = i;
+                ++idx_end;
             }
         }
 
         // Test them in sorted order
-        auto idx_end = any_interval ? idx.end() : idx.begin() + degrees_of_freedom;
-        std::iota(idx.begin(), idx_end, 0);
         std::sort(idx.begin(), idx_end, [&possible_t_syncs=possible_t_syncs](size_t i, size_t j) { return possible_t_syncs[i] < possible_t_syncs[j]; });
+        number_candidates = std::distance(idx.begin(), idx_end);
+    }
 
-        // Start at last tmin (or worse)
-        for (auto i = idx.begin() + degrees_of_freedom - 1; i != idx_end; ++i) {
-            const double possible_t_sync = possible_t_syncs[*i];
-            if (std::any_of(blocks.begin(), blocks.end(), [possible_t_sync](const Block& block){ return block.is_blocked(possible_t_sync); }) || possible_t_sync < t_min.value_or(0.0)) {
-                continue;
+    //! Run the calculation from calculation_stage on, until it is finished or interrupted by the deadline
+
+    //! If duration_only is set, the calculation is neither interrupted nor continued after the synchronization. It stops
+    //! early at the first DoF whose minimal duration exceeds max_duration_bound, with this lower bound as the duration.
+    //! Kinematic limits known at compile-time replace the limits of the input (see has_constant_limits). If defer_step2
+    //! is set, the calculation is not interrupted and returns before Step 2, which is deferred for each DoF instead.
+    template<bool throw_error, bool return_error_at_maximal_duration, bool measure_timing, Features features, bool count_cases, bool duration_only = false, class Limits = RuntimeLimits, bool defer_step2 = false>
+    Result calculate_stages(const InputParameter<DOFs, MaxDOFs>& inp, double delta_time, bool& was_interrupted, CalculationTiming<DOFs, MaxDOFs>* timing, WorkerPool* pool) {
+        was_interrupted = false;
+        const Deadline deadline {(duration_only || defer_step2) ? std::nullopt : inp.interrupt_calculation_duration};
+        const bool parallel = pool && pool->number_threads() > 1;
+
+        constexpr bool time_sync_only = is_removed(features, Features::TimeSyncOnly);
+        const auto is_enabled = [&inp](size_t dof) {
+            if constexpr (is_removed(features, Features::AllEnabled)) {
+                return true;
+            } else {
+                return static_cast<bool>(inp.enabled[dof]);
+            }
+        };
+        const std::optional<double> minimum_duration = is_removed(features, Features::NoMinimumDuration) ? std::nullopt : inp.minimum_duration;
+        const bool discrete_duration = !is_removed(features, Features::Continuous) && (inp.duration_discretization == DurationDiscretization::Discrete);
+        const bool has_groups = !is_removed(features, Features::Uniform) && inp.synchronization_groups.has_value();
+        const auto is_limiting = [this, has_groups](size_t dof) {
+            return static_cast<int>(dof) == (has_groups ? group_limiting_dofs[dof] : limiting_dof);
+        };
+
+        // Constant limits are folded into the calculation, the minimal limits are then symmetric
+        constexpr bool constant_limits = has_constant_limits<Limits>;
+        const auto vMax = [&inp](size_t dof) {
+            if constexpr (constant_limits) {
+                return Limits::max_velocity;
+            } else {
+                return inp.max_velocity[dof];
+            }
+        };
+        const auto vMin = [this](size_t dof) {
+            if constexpr (constant_limits) {
+                return -Limits::max_velocity;
+            } else {
+                return inp_min_velocity[dof];
             }
+        };
+        const auto aMax = [&inp](size_t dof) {
+            if constexpr (constant_limits) {
+                return Limits::max_acceleration;
+            } else {
+                return inp.max_acceleration[dof];
+            }
+        };
+        const auto aMin = [this](size_t dof) {
+            if constexpr (constant_limits) {
+                return -Limits::max_acceleration;
+            } else {
+                return inp_min_acceleration[dof];
+            }
+        };
+        const auto jMax = [&inp](size_t dof) {
+            if constexpr (constant_limits) {
+                return Limits::max_jerk;
+            } else {
+                return inp.max_jerk[dof];
+            }
+        };
 
-            t_sync = possible_t_sync;
-            if (*i == 3*degrees_of_freedom) { // Optional t_min
-                limiting_dof = -1;
+        Stopwatch<measure_timing> stopwatch;
+
+        if (calculation_stage == Stage::Brake) {
+            if constexpr (measure_timing) {
+                timing->reset();
+            }
+            if constexpr (count_cases) {
+                std::fill(dof_cases.begin(), dof_cases.end(), DoFCases());
+            }
+            clear_deferred_step2();
+
+            for (size_t dof = 0; dof < profiles.size(); ++dof) {
+                auto& p = profiles[dof];
+                if (!is_enabled(dof)) {
+                    p.brake.duration = 0.0;
+                    p.pf = inp.current_position[dof];
+                    p.vf = inp.current_velocity[dof];
+                    p.af = inp.current_acceleration[dof];
+                    p.t_sum[6] = 0.0;
+                    step1_inputs[dof].valid = false;
+
+                    // A disabled DoF must not block the synchronization with the blocks of an earlier calculation
+                    blocks[dof].set_min_profile(p);
+                    continue;
+                }
+
+                if constexpr (constant_limits) {
+                    // The minimal limits are not read from the workspace
+                } else if constexpr (is_removed(features, Features::Symmetric)) {
+                    inp_min_velocity[dof] = -inp.max_velocity[dof];
+                    inp_min_acceleration[dof] = -inp.max_acceleration[dof];
+                } else {
+                    inp_min_velocity[dof] = inp.min_velocity ? inp.min_velocity.value()[dof] : -inp.max_velocity[dof];
+                    inp_min_acceleration[dof] = inp.min_acceleration ? inp.min_acceleration.value()[dof] : -inp.max_acceleration[dof];
+                }
+
+                if constexpr (is_removed(features, Features::Uniform)) {
+                    inp_per_dof_control_interface[dof] = inp.control_interface;
+                    inp_per_dof_synchronization[dof] = time_sync_only ? Synchronization::Time : inp.synchronization;
+                } else {
+                    inp_per_dof_control_interface[dof] = inp.per_dof_control_interface ? inp.per_dof_control_interface.value()[dof] : inp.control_interface;
+                    inp_per_dof_synchronization[dof] = time_sync_only ? Synchronization::Time : (inp.per_dof_synchronization ? inp.per_dof_synchronization.value()[dof] : inp.synchronization);
+                }
+
+                // The blocked intervals are only needed if the DoF might be time synchronized
+                const bool minimum_duration_only = (
+                    (!time_sync_only && inp_per_dof_synchronization[dof] == Synchronization::None)
+                    || (!time_sync_only && inp_per_dof_synchronization[dof] == Synchronization::TimeIfNecessary && std::abs(inp.target_velocity[dof]) < eps && std::abs(inp.target_acceleration[dof]) < eps)
+                    || (degrees_of_freedom == 1 && !minimum_duration && !discrete_duration)
+                );
+
+                // Keep the brake trajectory and the Step 1 blocks if the inputs of this DoF didn't change (the brake of the
+                // profile is restored from its block, as it might have been scaled from another DoF)
+                const Step1Input step1_input {true, inp_per_dof_control_interface[dof], minimum_duration_only, {inp.current_position[dof], inp.current_velocity[dof], inp.current_acceleration[dof], inp.target_position[dof], inp.target_velocity[dof], inp.target_acceleration[dof], vMax(dof), vMin(dof), aMax(dof), aMin(dof), jMax(dof)}};
+                if (step1_input == step1_inputs[dof]) {
+                    p.brake = blocks[dof].get_min_profile().brake;
+                    continue;
+                }
+
+                // The brake trajectory of the last successful Step 1 is kept in its block, as the profile might be scaled
+                const bool same_brake = step1_inputs[dof].has_same_brake(step1_input);
+                step1_inputs[dof] = step1_input;
+                step1_inputs[dof].valid = false; // Until Step 1 was successful
+                if (same_brake) {
+                    p.brake = blocks[dof].get_min_profile().brake;
+                    continue;
+                }
+
+                const TraceScope trace {TracePoint::Brake, dof};
+
+                // Calculate brake (if input exceeds or will exceed limits)
+                switch (inp_per_dof_control_interface[dof]) {
+                    case ControlInterface::Position: {
+                        BrakeProfile::get_position_brake_trajectory(inp.current_velocity[dof], inp.current_acceleration[dof], vMax(dof), vMin(dof), aMax(dof), aMin(dof), jMax(dof), p.brake.t, p.brake.j);
+                    } break;
+                    case ControlInterface::Velocity: {
+                        BrakeProfile::get_velocity_brake_trajectory(inp.current_acceleration[dof], aMax(dof), aMin(dof), jMax(dof), p.brake.t, p.brake.j);
+                    } break;
+                }
+
+                p.brake.duration = p.brake.t[0] + p.brake.t[1];
+                p0s[dof] = inp.current_position[dof];
+                v0s[dof] = inp.current_velocity[dof];
+                a0s[dof] = inp.current_acceleration[dof];
+
+                // Integrate brake pre-trajectory
+                for (size_t i = 0; i < 2 && p.brake.t[i] > 0; ++i) {
+                    p.brake.p[i] = p0s[dof];
+                    p.brake.v[i] = v0s[dof];
+                    p.brake.a[i] = a0s[dof];
+                    std::tie(p0s[dof], v0s[dof], a0s[dof]) = Profile::integrate(p.brake.t[i], p0s[dof], v0s[dof], a0s[dof], p.brake.j[i]);
+                }
+
+                if constexpr (measure_timing) {
+                    timing->brake[dof] = stopwatch.lap();
+                }
+            }
+
+            // Pre-calculate the expressions for Step 1 and Step 2 in a separate, branch-free pass over all DoFs, so that it can be
+            // vectorized by the compiler (in particular for a static number of DoFs)
+            for (size_t dof = 0; dof < profiles.size(); ++dof) {
+                position_expressions[dof].set(p0s[dof], v0s[dof], a0s[dof], inp.target_position[dof], inp.target_velocity[dof], inp.target_acceleration[dof], jMax(dof));
+            }
+
+            if constexpr (measure_timing) {
+                const double setup_duration = stopwatch.lap() / profiles.size();
+                std::fill(timing->step1.begin(), timing->step1.end(), setup_duration);
+            }
+
+            calculation_stage = Stage::Step1;
+            next_index = 0;
+        }
+
+        if (calculation_stage == Stage::Step1) {
+            const auto is_within_bound = [this](size_t dof) {
+                if constexpr (duration_only) {
+                    return blocks[dof].t_min <= max_duration_bound;
+                } else {
+                    return true;
+                }
+            };
+
+            const size_t failed_step1_dof = for_each_dof(pool, deadline, was_interrupted, [&](size_t dof) {
+                if (!is_enabled(dof)) {
+                    return true;
+                }
+                if (step1_inputs[dof].valid) {
+                    return is_within_bound(dof);
+                }
+
+                const TraceScope trace {TracePoint::Step1, dof};
+
+                auto& p = profiles[dof];
+                const bool minimum_duration_only = step1_inputs[dof].minimum_duration_only;
+
+                bool found_profile {false};
+                switch (inp_per_dof_control_interface[dof]) {
+                    case ControlInterface::Position: {
+                        PositionStep1 step1 {position_expressions[dof], vMax(dof), vMin(dof), aMax(dof), aMin(dof), jMax(dof)};
+                        found_profile = step1.get_profile(p, blocks[dof], minimum_duration_only);
+                        if constexpr (count_cases) {
+                            dof_cases[dof].position_step1 = true;
+                            dof_cases[dof].step1_cases = step1.number_evaluated_cases;
+                            dof_cases[dof].step1_two_step = step1.used_two_step_fallback;
+                        }
+                        if (!found_profile) {
+                            found_profile = step1.get_profile_normalized(p, blocks[dof], minimum_duration_only);
+                            if constexpr (count_cases) {
+                                dof_cases[dof].normalized = found_profile;
+                            }
+                        }
+                    } break;
+                    case ControlInterface::Velocity: {
+                        VelocityStep1 step1 {p0s[dof], v0s[dof], a0s[dof], inp.target_velocity[dof], inp.target_acceleration[dof], aMax(dof), aMin(dof), jMax(dof)};
+                        found_profile = step1.get_profile(p, blocks[dof], minimum_duration_only);
+                    } break;
+                }
+
+                if (!found_profile) {
+                    return false;
+                }
+
+                independent_min_durations[dof] = blocks[dof].get_min_profile().brake.duration + blocks[dof].t_min;
+                step1_inputs[dof].valid = true;
+                // std::cout << dof << " profile step1: " << blocks[dof].to_string() << std::endl;
+
+                if constexpr (measure_timing) {
+                    if (!parallel) {
+                        timing->step1[dof] += stopwatch.lap();
+                    }
+                }
+                return is_within_bound(dof);
+            });
+
+            if (was_interrupted) {
+                return Result::Working;
+            }
+
+            if (duration_only && failed_step1_dof < profiles.size() && step1_inputs[failed_step1_dof].valid) {
+                duration = blocks[failed_step1_dof].t_min;
+                return Result::Working;
+            }
+
+            if (failed_step1_dof < profiles.size()) {
+                error = {Result::ErrorExecutionTimeCalculation, CalculationPhase::Step1, static_cast<int>(failed_step1_dof), 0.0};
+                if constexpr (throw_error) {
+                    throw std::runtime_error("[ruckig] error in step 1, dof: " + std::to_string(failed_step1_dof) + " input: " + inp.to_string());
+                }
+                return Result::ErrorExecutionTimeCalculation;
+            }
+
+            if constexpr (measure_timing) {
+                if (parallel) {
+                    const double step1_duration = stopwatch.lap() / profiles.size();
+                    for (auto& t: timing->step1) {
+                        t += step1_duration;
+                    }
+                }
+            }
+
+            calculation_stage = Stage::Synchronization;
+            next_index = 0;
+        }
+
+        if (calculation_stage == Stage::Synchronization) {
+            const TraceScope trace {TracePoint::Synchronization};
+            const bool found_synchronization = has_groups ? synchronize_groups(inp.synchronization_groups.value(), minimum_duration, discrete_duration, delta_time) : synchronize(blocks, minimum_duration, duration, limiting_dof, profiles, discrete_duration, delta_time, deadline, was_interrupted);
+            if constexpr (measure_timing) {
+                timing->synchronization += stopwatch.lap();
+            }
+            if (was_interrupted) {
+                return Result::Working;
+            }
+            if (!found_synchronization) {
+                error = {Result::ErrorSynchronizationCalculation, CalculationPhase::Synchronization, -1, 0.0};
+                if constexpr (throw_error) {
+                    throw std::runtime_error("[ruckig] error in time synchronization: " + std::to_string(duration));
+                }
+                return Result::ErrorSynchronizationCalculation;
+            }
+
+            if constexpr (return_error_at_maximal_duration) {
+                if (duration > 7.6e3) {
+                    error = {Result::ErrorTrajectoryDuration, CalculationPhase::Synchronization, limiting_dof, duration};
+                    return Result::ErrorTrajectoryDuration;
+                }
+            }
+
+            if (duration_only || duration == 0.0) {
+                return Result::Working;
+            }
+
+            if constexpr (!time_sync_only) {
+                // None Synchronization
+                for (size_t dof = 0; dof < blocks.size(); ++dof) {
+                    if (is_enabled(dof) && !is_limiting(dof) && inp_per_dof_synchronization[dof] == Synchronization::None) {
+                        profiles[dof] = blocks[dof].get_min_profile();
+                    }
+                }
+                if (std::all_of(inp_per_dof_synchronization.begin(), inp_per_dof_synchronization.end(), [](Synchronization s){ return s == Synchronization::None; })) {
+                    return Result::Working;
+                }
+
+                // Phase Synchronization (with groups, the DoFs are time synchronized within their group)
+                if (!has_groups && std::any_of(inp_per_dof_synchronization.begin(), inp_per_dof_synchronization.end(), [](Synchronization s){ return s == Synchronization::Phase; }) && std::all_of(inp_per_dof_control_interface.begin(), inp_per_dof_control_interface.end(), [](ControlInterface s){ return s == ControlInterface::Position; })) {
+                    if (limiting_dof >= 0 && is_input_collinear(inp, limiting_dof)) {
+                        bool found_time_synchronization {true};
+                        for (size_t dof = 0; dof < profiles.size(); ++dof) {
+                            if (!is_enabled(dof) || static_cast<int>(dof) == limiting_dof || inp_per_dof_synchronization[dof] != Synchronization::Phase) {
+                                continue;
+                            }
+
+                            // The profile of a collinear DoF is the profile of the limiting DoF scaled by the ratio of
+                            // their position differences, so that only the limits need to be checked.
+                            const double scale = pd[dof] / pd[limiting_dof];
+                            if (!profiles[dof].set_scaled(profiles[limiting_dof], scale, inp.current_position[dof], inp.target_position[dof], vMax(dof), vMin(dof), aMax(dof), aMin(dof), jMax(dof))) {
+                                found_time_synchronization = false;
+                                break;
+                            }
+                        }
+
+                        // Step 2 of the time synchronization starts after the own brake trajectory of each DoF
+                        if (!found_time_synchronization) {
+                            for (size_t dof = 0; dof < profiles.size(); ++dof) {
+                                if (is_enabled(dof) && static_cast<int>(dof) != limiting_dof) {
+                                    profiles[dof].brake = blocks[dof].get_min_profile().brake;
+                                }
+                            }
+                        }
+
+                        if constexpr (measure_timing) {
+                            timing->phase_synchronization = stopwatch.lap();
+                        }
+
+                        if (found_time_synchronization && std::all_of(inp_per_dof_synchronization.begin(), inp_per_dof_synchronization.end(), [](Synchronization s){ return s == Synchronization::Phase || s == Synchronization::None; })) {
+                            return Result::Working;
+                        }
+                    }
+
+                    if constexpr (measure_timing) {
+                        timing->phase_synchronization += stopwatch.lap();
+                    }
+                }
+            }
+
+            calculation_stage = Stage::Step2;
+            next_index = 0;
+        }
+
+        // The remaining DoFs need Step 2 for the time synchronization, which is calculated on first use instead
+        if constexpr (defer_step2) {
+            if (!has_groups) {
+                for (size_t dof = 0; dof < profiles.size(); ++dof) {
+                    if (is_enabled(dof) && static_cast<int>(dof) != limiting_dof && (time_sync_only || inp_per_dof_synchronization[dof] != Synchronization::None)) {
+                        is_step2_deferred[dof] = true;
+                        ++number_deferred_step2;
+                    }
+                }
+                return Result::Working;
+            }
+        }
+
+        // Time Synchronization of a candidate duration, whose limiting DoF keeps its profile of Step 1
+        const auto step2 = [&](size_t dof, double t_sync, int candidate_limiting_dof, Profile& p, bool is_primary) {
+            if (!is_enabled(dof) || (has_groups ? is_limiting(dof) : static_cast<int>(dof) == candidate_limiting_dof) || (!time_sync_only && inp_per_dof_synchronization[dof] == Synchronization::None)) {
                 return true;
             }
 
-            const auto div = std::div(*i, degrees_of_freedom);
-            limiting_dof = div.rem;
-            switch (div.quot) {
-                case 0: {
-                    profiles[limiting_dof] = blocks[limiting_dof].p_min;
-                } break;
-                case 1: {
-                    profiles[limiting_dof] = blocks[limiting_dof].a->profile;
+            const TraceScope trace {TracePoint::Step2, dof};
+            const double t_profile = (has_groups ? group_durations[dof] : t_sync) - p.brake.duration;
+
+            if (!time_sync_only && inp_per_dof_synchronization[dof] == Synchronization::TimeIfNecessary && std::abs(inp.target_velocity[dof]) < eps && std::abs(inp.target_acceleration[dof]) < eps) {
+                p = blocks[dof].get_min_profile();
+                return true;
+            }
+
+            // Check if the final time corresponds to an extremal profile calculated in step 1
+            if (std::abs(t_profile - blocks[dof].t_min) < eps) {
+                p = blocks[dof].get_min_profile();
+                return true;
+            } else if (blocks[dof].has_a && std::abs(t_profile - blocks[dof].a.right) < eps) {
+                p = blocks[dof].get_profile(blocks[dof].a);
+                return true;
+            } else if (blocks[dof].has_b && std::abs(t_profile - blocks[dof].b.right) < eps) {
+                p = blocks[dof].get_profile(blocks[dof].b);
+                return true;
+            }
+
+            bool found_time_synchronization {false};
+            switch (inp_per_dof_control_interface[dof]) {
+                case ControlInterface::Position: {
+                    PositionStep2 step2 {t_profile, position_expressions[dof], vMax(dof), vMin(dof), aMax(dof), aMin(dof), jMax(dof)};
+                    found_time_synchronization = (inp.warm_start && has_step2_hints) ? step2.get_profile(p, step2_hints[dof]) : step2.get_profile(p);
+                    if (!found_time_synchronization) {
+                        found_time_synchronization = step2.get_profile_normalized(p);
+                        if constexpr (count_cases) {
+                            if (is_primary) {
+                                dof_cases[dof].normalized |= found_time_synchronization;
+                            }
+                        }
+                    }
                 } break;
-                case 2: {
-                    profiles[limiting_dof] = blocks[limiting_dof].b->profile;
+                case ControlInterface::Velocity: {
+                    VelocityStep2 step2 {t_profile, p0s[dof], v0s[dof], a0s[dof], inp.target_velocity[dof], inp.target_acceleration[dof], aMax(dof), aMin(dof), jMax(dof)};
+                    found_time_synchronization = step2.get_profile(p);
                 } break;
             }
+            if (!found_time_synchronization) {
+                return false;
+            }
+            // std::cout << dof << " profile step2: " << p.to_string() << std::endl;
+
+            if constexpr (count_cases) {
+                if (is_primary) {
+                    dof_cases[dof].step2 = true;
+                }
+            }
+
+            if constexpr (measure_timing) {
+                if (!parallel) {
+                    timing->step2[dof] = stopwatch.lap();
+                }
+            }
             return true;
+        };
+
+        // The following candidates are only needed if Step 2 fails for the first one
+        const size_t number_following = (has_groups || synchronization_candidates == 0) ? 0 : std::clamp<size_t>(inp.speculative_candidates, 1, max_speculative_candidates) - 1;
+        const auto next_candidate = [&](double& t_sync, int& candidate_limiting_dof, Vector<Profile>& candidate_profiles) {
+            const Deadline no_deadline {std::nullopt};
+            bool no_interruption {false};
+            next_index = synchronization_candidates;
+            if (!synchronize(blocks, minimum_duration, t_sync, candidate_limiting_dof, candidate_profiles, discrete_duration, delta_time, no_deadline, no_interruption)) {
+                return false;
+            }
+            return !return_error_at_maximal_duration || t_sync <= 7.6e3;
+        };
+
+        size_t failed_step2_dof;
+        if (parallel && number_following > 0 && next_index == 0) {
+            failed_step2_dof = speculate_step2(pool, number_following, next_candidate, step2);
+
+        } else {
+            failed_step2_dof = for_each_dof(pool, deadline, was_interrupted, [&](size_t dof) {
+                return step2(dof, duration, limiting_dof, profiles[dof], true);
+            });
+
+            // Without a worker pool, the following candidates are calculated one after another, without interruption
+            for (size_t i = 0; i < number_following && failed_step2_dof < profiles.size() && !was_interrupted; ++i) {
+                if (!next_candidate(duration, limiting_dof, profiles)) {
+                    break;
+                }
+
+                next_index = 0;
+                failed_step2_dof = for_each_dof(nullptr, Deadline {std::nullopt}, was_interrupted, [&](size_t dof) {
+                    return step2(dof, duration, limiting_dof, profiles[dof], true);
+                });
+            }
         }
 
-        return false;
+        if (was_interrupted) {
+            return Result::Working;
+        }
+
+        if (failed_step2_dof < profiles.size()) {
+            error = {Result::ErrorSynchronizationCalculation, CalculationPhase::Step2, static_cast<int>(failed_step2_dof), duration};
+            if constexpr (throw_error) {
+                throw std::runtime_error("[ruckig] error in step 2 in dof: " + std::to_string(failed_step2_dof) + " for t sync: " + std::to_string(duration) + " input: " + inp.to_string());
+            }
+            return Result::ErrorSynchronizationCalculation;
+        }
+
+        if (inp.warm_start) {
+            for (size_t dof = 0; dof < profiles.size(); ++dof) {
+                if (is_enabled(dof)) {
+                    step2_hints[dof] = {profiles[dof].limits, profiles[dof].j[0] > 0};
+                }
+            }
+            has_step2_hints = true;
+        }
+
+        return Result::Working;
+    }
+
+    //! Add the profile cases of the finished calculation to the statistics
+    void add_cases(const InputParameter<DOFs, MaxDOFs>& inp, CaseStatistics& cases) const {
+        cases.calculations += 1;
+        for (size_t dof = 0; dof < profiles.size(); ++dof) {
+            if (!inp.enabled[dof]) {
+                continue;
+            }
+
+            const auto& p = profiles[dof];
+            const bool is_position = (inp_per_dof_control_interface[dof] == ControlInterface::Position);
+            (is_position ? cases.position_limits : cases.velocity_limits)[static_cast<size_t>(p.limits)] += 1;
+            (is_position ? cases.position_jerk_signs : cases.velocity_jerk_signs)[static_cast<size_t>(p.jerk_signs)] += 1;
+
+            if (dof_cases[dof].position_step1) {
+                cases.position_step1 += 1;
+                cases.position_step1_cases += dof_cases[dof].step1_cases;
+                cases.position_step1_two_step += dof_cases[dof].step1_two_step;
+            }
+            cases.step2 += dof_cases[dof].step2;
+            cases.normalized += dof_cases[dof].normalized;
+        }
+
+        if (synchronization_candidates > 0) {
+            cases.synchronization_candidates[std::min(synchronization_candidates, cases.synchronization_candidates.size()) - 1] += 1;
+        }
+    }
+
+    void clear_deferred_step2() {
+        if (number_deferred_step2 > 0) {
+            std::fill(is_step2_deferred.begin(), is_step2_deferred.end(), false);
+            number_deferred_step2 = 0;
+        }
+    }
+
+    //! Calculate the deferred Step 2 of a DoF from the workspace of the calculation, as the input might have changed
+
+    //! Same as the time synchronization in calculate_stages, but without warm start hints. If Step 2 fails, the DoF
+    //! keeps its time-optimal profile of Step 1, so that it is not synchronized anymore.
+    bool solve_deferred_step2(size_t dof) {
+        const TraceScope trace {TracePoint::Step2, dof};
+        const auto& values = step1_inputs[dof].values; // State, target, and limits of the DoF
+        Profile& p = profiles[dof];
+        const double t_profile = duration - p.brake.duration;
+
+        if (inp_per_dof_synchronization[dof] == Synchronization::TimeIfNecessary && std::abs(values[4]) < eps && std::abs(values[5]) < eps) {
+            p = blocks[dof].get_min_profile();
+            return true;
+        }
+
+        if (std::abs(t_profile - blocks[dof].t_min) < eps) {
+            p = blocks[dof].get_min_profile();
+            return true;
+        } else if (blocks[dof].has_a && std::abs(t_profile - blocks[dof].a.right) < eps) {
+            p = blocks[dof].get_profile(blocks[dof].a);
+            return true;
+        } else if (blocks[dof].has_b && std::abs(t_profile - blocks[dof].b.right) < eps) {
+            p = blocks[dof].get_profile(blocks[dof].b);
+            return true;
+        }
+
+        bool found_time_synchronization {false};
+        switch (inp_per_dof_control_interface[dof]) {
+            case ControlInterface::Position: {
+                PositionStep2 step2 {t_profile, position_expressions[dof], values[6], values[7], values[8], values[9], values[10]};
+                found_time_synchronization = step2.get_profile(p) || step2.get_profile_normalized(p);
+            } break;
+            case ControlInterface::Velocity: {
+                VelocityStep2 step2 {t_profile, p0s[dof], v0s[dof], a0s[dof], values[4], values[5], values[8], values[9], values[10]};
+                found_time_synchronization = step2.get_profile(p);
+            } break;
+        }
+        if (!found_time_synchronization) {
+            p = blocks[dof].get_min_profile();
+        }
+        return found_time_synchronization;
     }
 
 public:
-    size_t degrees_of_freedom;
+    using Base::degrees_of_freedom;
 
     template <size_t D = DOFs, typename std::enable_if<D >= 1, int>::type = 0>
-    Trajectory(): degrees_of_freedom(DOFs) { }
+    Trajectory(): Base() { }
 
     template <size_t D = DOFs, typename std::enable_if<D == 0, int>::type = 0>
-    Trajectory(size_t dofs): degrees_of_freedom(dofs) {
+    Trajectory(size_t dofs): Base(dofs) {
         blocks.resize(dofs);
         p0s.resize(dofs);
         v0s.resize(dofs);
         a0s.resize(dofs);
+        position_expressions.resize(dofs);
+        step1_inputs.resize(dofs);
+        step2_hints.resize(dofs);
+        dof_cases.resize(dofs);
         inp_min_velocity.resize(dofs);
         inp_min_acceleration.resize(dofs);
         inp_per_dof_control_interface.resize(dofs);
         inp_per_dof_synchronization.resize(dofs);
-        profiles.resize(dofs);
-        independent_min_durations.resize(dofs);
+        group_durations.resize(dofs);
+        group_limiting_dofs.resize(dofs);
+        is_step2_deferred.resize(dofs);
         pd.resize(dofs);
+        for (auto& candidate: following_candidates) {
+            candidate.profiles.resize(dofs);
+        }
 
-        new_max_jerk.resize(dofs);
-
-        position_extrema.resize(dofs);
 
         possible_t_syncs.resize(3*dofs+1);
         idx.resize(3*dofs+1);
+        blocking_dofs.resize(dofs);
+    }
+
+    //! Adopt an executable trajectory (e.g. from a cache), the workspace of the calculation is kept but outdated
+    void assign(const Base& trajectory) {
+        Base::operator=(trajectory);
+        for (auto& step1_input: step1_inputs) {
+            step1_input.valid = false;
+        }
+        has_step2_hints = false;
+        clear_deferred_step2();
+        calculation_stage = Stage::None;
     }
 
     //! Calculate the time-optimal waypoint-based trajectory
-    template<bool throw_error, bool return_error_at_maximal_duration>
-    Result calculate(const InputParameter<DOFs>& inp, double delta_time, bool& was_interrupted) {
+
+    //! If measure_timing is set, the durations of the calculation phases are written into timing. The input features
+    //! that are removed at compile-time are ignored, and their branches are not compiled in. With a worker pool, Step 1
+    //! and Step 2 of the DoFs are calculated in parallel (and their durations are not measured per DoF). If count_cases
+    //! is set, the profile cases of the finished calculation are added to cases. With Limits known at compile-time, the
+    //! kinematic limits of the input are not read (see has_constant_limits).
+    template<bool throw_error, bool return_error_at_maximal_duration, bool measure_timing = false, Features features = Features::All, bool count_cases = false, class Limits = RuntimeLimits>
+    Result calculate(const InputParameter<DOFs, MaxDOFs>& inp, double delta_time, bool& was_interrupted, CalculationTiming<DOFs, MaxDOFs>* timing = nullptr, WorkerPool* pool = nullptr, CaseStatistics* cases = nullptr) {
+        static_assert(!(hard_realtime && throw_error), "[ruckig] throw_error is not available in the hard real-time profile.");
+
+        const TraceScope trace {TracePoint::Calculate};
+        calculation_stage = Stage::Brake;
+        error = {};
+        next_index = 0;
+        position_extrema.reset();
+        kinematic_extrema.reset();
+        segment_coefficients.reset();
+        const Result result = calculate_stages<throw_error, return_error_at_maximal_duration, measure_timing, features, count_cases, false, Limits>(inp, delta_time, was_interrupted, timing, pool);
+        if (!was_interrupted) {
+            calculation_stage = Stage::None;
+            if constexpr (count_cases) {
+                if (result == Result::Working) {
+                    add_cases(inp, *cases);
+                }
+            }
+        }
+        return result;
+    }
+
+    //! Calculate only the duration of the time-optimal trajectory, without the profiles of Step 2
+
+    //! The brake trajectories, Step 1, and the synchronization are calculated as in calculate, so that the duration and
+    //! the independent minimal durations are the same. Afterwards, the trajectory is only a workspace and must not be
+    //! sampled, however a following calculate with the same input skips Step 1. The calculation is not interrupted. If
+    //! the duration exceeds max_duration, the calculation might stop after the Step 1 of a DoF that exceeds it already,
+    //! so that the duration is only a lower bound (still above max_duration).
+    template<bool throw_error, bool return_error_at_maximal_duration, Features features = Features::All, class Limits = RuntimeLimits>
+    Result calculate_min_duration(const InputParameter<DOFs, MaxDOFs>& inp, double delta_time, WorkerPool* pool = nullptr, double max_duration = std::numeric_limits<double>::infinity()) {
+        static_assert(!(hard_realtime && throw_error), "[ruckig] throw_error is not available in the hard real-time profile.");
+
+        const TraceScope trace {TracePoint::Calculate};
+        calculation_stage = Stage::Brake;
+        error = {};
+        next_index = 0;
+        position_extrema.reset();
+        kinematic_extrema.reset();
+        segment_coefficients.reset();
+        max_duration_bound = max_duration;
+        bool was_interrupted {false};
+        const Result result = calculate_stages<throw_error, return_error_at_maximal_duration, false, features, false, true, Limits>(inp, delta_time, was_interrupted, nullptr, pool);
+        calculation_stage = Stage::None;
+        return result;
+    }
+
+    //! Calculate the duration and the profiles of the limiting DoF, while the time synchronization of the other DoFs is deferred
+
+    //! The brake trajectories, Step 1, and the synchronization (including DoFs without time synchronization) are
+    //! calculated as in calculate, but Step 2 of each remaining DoF is only calculated on first use by resolve_step2 or
+    //! resolve_all_step2, e.g. if a scheduler needs only a few DoFs before the trajectory is replaced. Until then, the
+    //! trajectory must not be sampled or queried for these DoFs. It does not depend on the input anymore, and is not
+    //! interrupted. With synchronization groups, Step 2 is calculated right away.
+    template<bool throw_error, bool return_error_at_maximal_duration, Features features = Features::All, class Limits = RuntimeLimits>
+    Result calculate_deferred(const InputParameter<DOFs, MaxDOFs>& inp, double delta_time, WorkerPool* pool = nullptr) {
+        static_assert(!(hard_realtime && throw_error), "[ruckig] throw_error is not available in the hard real-time profile.");
+
+        const TraceScope trace {TracePoint::Calculate};
+        calculation_stage = Stage::Brake;
+        error = {};
+        next_index = 0;
+        position_extrema.reset();
+        kinematic_extrema.reset();
+        segment_coefficients.reset();
+        bool was_interrupted {false};
+        const Result result = calculate_stages<throw_error, return_error_at_maximal_duration, false, features, false, false, Limits, true>(inp, delta_time, was_interrupted, nullptr, pool);
+        calculation_stage = Stage::None;
+        return result;
+    }
+
+    //! Is Step 2 of some DoFs still deferred (see calculate_deferred)?
+    bool has_deferred_step2() const {
+        return number_deferred_step2 > 0;
+    }
+
+    //! Is Step 2 of the given DoF still deferred (see calculate_deferred)?
+    bool is_deferred(size_t dof) const {
+        return is_step2_deferred[dof];
+    }
+
+    //! Calculate the deferred Step 2 of a single DoF right before its profile is used, nothing happens otherwise
+
+    //! Returns false if Step 2 failed, then the DoF keeps its time-optimal profile and is not synchronized anymore.
+    bool resolve_step2(size_t dof) {
+        if (!is_step2_deferred[dof]) {
+            return true;
+        }
+
+        const bool found_time_synchronization = solve_deferred_step2(dof);
+        is_step2_deferred[dof] = false;
+        --number_deferred_step2;
+        position_extrema.reset();
+        kinematic_extrema.reset();
+        segment_coefficients.reset();
+        if (!found_time_synchronization) {
+            error = {Result::ErrorSynchronizationCalculation, CalculationPhase::Step2, static_cast<int>(dof), duration};
+        }
+        return found_time_synchronization;
+    }
+
+    //! Calculate the deferred Step 2 of all DoFs, e.g. prefetched on a worker pool or within a bounded duration [µs]
+
+    //! In order, the calculation is interrupted after a DoF if the calculation_duration has passed, and the remaining
+    //! DoFs stay deferred. On the worker pool, the calculation_duration is ignored. Returns false if Step 2 failed for a
+    //! DoF (see resolve_step2).
+    bool resolve_all_step2(bool& was_interrupted, std::optional<double> calculation_duration = std::nullopt, WorkerPool* pool = nullptr) {
         was_interrupted = false;
+        if (number_deferred_step2 == 0) {
+            return true;
+        }
+
+        std::atomic<size_t> failed_dof {profiles.size()};
+        next_index = 0;
+        for_each_dof(pool, Deadline {calculation_duration}, was_interrupted, [this, &failed_dof](size_t dof) {
+            if (is_step2_deferred[dof] && !solve_deferred_step2(dof)) {
+                size_t expected = failed_dof.load();
+                while (dof < expected && !failed_dof.compare_exchange_weak(expected, dof)) { }
+            }
+            return true;
+        });
+
+        // The flags are only changed afterwards, as the DoFs on the worker pool share them
+        const size_t end = was_interrupted ? next_index : profiles.size();
+        for (size_t dof = 0; dof < end; ++dof) {
+            if (is_step2_deferred[dof]) {
+                is_step2_deferred[dof] = false;
+                --number_deferred_step2;
+            }
+        }
+        next_index = 0;
+        was_interrupted = was_interrupted && number_deferred_step2 > 0;
+        position_extrema.reset();
+        kinematic_extrema.reset();
+        segment_coefficients.reset();
+
+        if (failed_dof.load() < profiles.size()) {
+            error = {Result::ErrorSynchronizationCalculation, CalculationPhase::Step2, static_cast<int>(failed_dof.load()), duration};
+            return false;
+        }
+        return true;
+    }
+
+    //! Calculate the deferred Step 2 of all DoFs (see resolve_all_step2)
+    bool resolve_all_step2(WorkerPool* pool = nullptr) {
+        bool was_interrupted;
+        return resolve_all_step2(was_interrupted, std::nullopt, pool);
+    }
+
+    //! Continue an interrupted calculation with the same input, until it is finished or interrupted again
+
+    //! Each call has its own interrupt_calculation_duration. The trajectory is only valid after a call without interruption.
+    template<bool throw_error, bool return_error_at_maximal_duration, Features features = Features::All, bool count_cases = false, class Limits = RuntimeLimits>
+    Result continue_calculation(const InputParameter<DOFs, MaxDOFs>& inp, double delta_time, bool& was_interrupted, WorkerPool* pool = nullptr, CaseStatistics* cases = nullptr) {
+        if (calculation_stage == Stage::None) {
+            was_interrupted = false;
+            return Result::Working;
+        }
 
+        const TraceScope trace {TracePoint::Calculate};
+        const Result result = calculate_stages<throw_error, return_error_at_maximal_duration, false, features, count_cases, false, Limits>(inp, delta_time, was_interrupted, nullptr, pool);
+        if (!was_interrupted) {
+            calculation_stage = Stage::None;
+            if constexpr (count_cases) {
+                if (result == Result::Working) {
+                    add_cases(inp, *cases);
+                }
+            }
+        }
+        return result;
+    }
+
+    //! Calculate a trajectory that stops all DoFs from the current state of the input, to zero velocity and acceleration
+
+    //! Only the closed forms of the velocity brake, Step 1, and Step 2 of the velocity interface are evaluated (a fixed
+    //! number of cases per DoF, without any numerical fallback), so that the calculation has a small, constant worst-case
+    //! duration. The targets, velocity limits, and synchronization of the input are ignored. If synchronized, all DoFs
+    //! stop at the time of the slowest one, or at the end of the earliest interval that blocks it for another DoF. A DoF
+    //! that still cannot be slowed down to that time stops on its own instead.
+    template<bool throw_error>
+    Result calculate_stop(const InputParameter<DOFs, MaxDOFs>& inp, bool synchronize) {
+        const TraceScope trace {TracePoint::Calculate};
+        calculation_stage = Stage::None;
+        error = {};
+        position_extrema.reset();
+        kinematic_extrema.reset();
+        segment_coefficients.reset();
+        has_step2_hints = false;
+        clear_deferred_step2();
+
+        duration = 0.0;
         for (size_t dof = 0; dof < profiles.size(); ++dof) {
             auto& p = profiles[dof];
+            step1_inputs[dof].valid = false;
             if (!inp.enabled[dof]) {
+                p.brake.duration = 0.0;
                 p.pf = inp.current_position[dof];
                 p.vf = inp.current_velocity[dof];
                 p.af = inp.current_acceleration[dof];
                 p.t_sum[6] = 0.0;
+                independent_min_durations[dof] = 0.0;
                 continue;
             }
 
-            inp_min_velocity[dof] = inp.min_velocity ? inp.min_velocity.value()[dof] : -inp.max_velocity[dof];
             inp_min_acceleration[dof] = inp.min_acceleration ? inp.min_acceleration.value()[dof] : -inp.max_acceleration[dof];
-            inp_per_dof_control_interface[dof] = inp.per_dof_control_interface ? inp.per_dof_control_interface.value()[dof] : inp.control_interface;
-            inp_per_dof_synchronization[dof] = inp.per_dof_synchronization ? inp.per_dof_synchronization.value()[dof] : inp.synchronization;
-
-            // Calculate brake (if input exceeds or will exceed limits)
-            switch (inp_per_dof_control_interface[dof]) {
-                case ControlInterface::Position: {
-                    BrakeProfile::get_position_brake_trajectory(inp.current_velocity[dof], inp.current_acceleration[dof], inp.max_velocity[dof], inp_min_velocity[dof], inp.max_acceleration[dof], inp_min_acceleration[dof], inp.max_jerk[dof], p.brake.t, p.brake.j);
-                } break;
-                case ControlInterface::Velocity: {
-                    BrakeProfile::get_velocity_brake_trajectory(inp.current_acceleration[dof], inp.max_acceleration[dof], inp_min_acceleration[dof], inp.max_jerk[dof], p.brake.t, p.brake.j);
-                } break;
-            }
-
+            BrakeProfile::get_velocity_brake_trajectory(inp.current_acceleration[dof], inp.max_acceleration[dof], inp_min_acceleration[dof], inp.max_jerk[dof], p.brake.t, p.brake.j);
             p.brake.duration = p.brake.t[0] + p.brake.t[1];
             p0s[dof] = inp.current_position[dof];
             v0s[dof] = inp.current_velocity[dof];
             a0s[dof] = inp.current_acceleration[dof];
-
-            // Integrate brake pre-trajectory
             for (size_t i = 0; i < 2 && p.brake.t[i] > 0; ++i) {
                 p.brake.p[i] = p0s[dof];
                 p.brake.v[i] = v0s[dof];
@@ -237,251 +1268,208 @@ public:
                 std::tie(p0s[dof], v0s[dof], a0s[dof]) = Profile::integrate(p.brake.t[i], p0s[dof], v0s[dof], a0s[dof], p.brake.j[i]);
             }
 
-            bool found_profile;
-            switch (inp_per_dof_control_interface[dof]) {
-                case ControlInterface::Position: {
-                    PositionStep1 step1 {p0s[dof], v0s[dof], a0s[dof], inp.target_position[dof], inp.target_velocity[dof], inp.target_acceleration[dof], inp.max_velocity[dof], inp_min_velocity[dof], inp.max_acceleration[dof], inp_min_acceleration[dof], inp.max_jerk[dof]};
-                    found_profile = step1.get_profile(p, blocks[dof]);
-                } break;
-                case ControlInterface::Velocity: {
-                    VelocityStep1 step1 {p0s[dof], v0s[dof], a0s[dof], inp.target_velocity[dof], inp.target_acceleration[dof], inp.max_acceleration[dof], inp_min_acceleration[dof], inp.max_jerk[dof]};
-                    found_profile = step1.get_profile(p, blocks[dof]);
-                } break;
-            }
-
-            if (!found_profile) {
+            VelocityStep1 step1 {p0s[dof], v0s[dof], a0s[dof], 0.0, 0.0, inp.max_acceleration[dof], inp_min_acceleration[dof], inp.max_jerk[dof]};
+            if (!step1.get_profile(p, blocks[dof], !synchronize)) {
+                error = {Result::ErrorExecutionTimeCalculation, CalculationPhase::Step1, static_cast<int>(dof), 0.0};
                 if constexpr (throw_error) {
-                    throw std::runtime_error("[ruckig] error in step 1, dof: " + std::to_string(dof) + " input: " + inp.to_string());
+                    throw std::runtime_error("[ruckig] error in step 1 of the stop trajectory, dof: " + std::to_string(dof));
                 }
                 return Result::ErrorExecutionTimeCalculation;
             }
 
-            independent_min_durations[dof] = blocks[dof].p_min.brake.duration + blocks[dof].t_min;
-            // std::cout << dof << " profile step1: " << blocks[dof].to_string() << std::endl;
+            independent_min_durations[dof] = p.brake.duration + blocks[dof].t_min; // As in calculate
+            duration = std::max(duration, blocks[dof].t_min);
         }
 
-        int limiting_dof; // The DoF that doesn't need step 2
-        const bool discrete_duration = (inp.duration_discretization == DurationDiscretization::Discrete);
-        const bool found_synchronization = synchronize(blocks, inp.minimum_duration, duration, limiting_dof, profiles, discrete_duration, delta_time);
-        if (!found_synchronization) {
-            if constexpr (throw_error) {
-                throw std::runtime_error("[ruckig] error in time synchronization: " + std::to_string(duration));
-            }
-            return Result::ErrorSynchronizationCalculation;
-        }
-
-        if constexpr (return_error_at_maximal_duration) {
-            if (duration > 7.6e3) {
-                return Result::ErrorTrajectoryDuration;
+        if (!synchronize) {
+            for (size_t dof = 0; dof < profiles.size(); ++dof) {
+                if (inp.enabled[dof]) {
+                    profiles[dof] = blocks[dof].get_min_profile();
+                }
             }
-        }
-
-        if (duration == 0.0) {
             return Result::Working;
         }
 
-        // None Synchronization
-        for (size_t dof = 0; dof < blocks.size(); ++dof) {
-            if (inp.enabled[dof] && dof != limiting_dof && inp_per_dof_synchronization[dof] == Synchronization::None) {
-                profiles[dof] = blocks[dof].p_min;
+        // The earliest duration that is not blocked for any DoF, from at most two interval boundaries per DoF
+        const auto is_feasible = [&](double t) {
+            for (size_t dof = 0; dof < profiles.size(); ++dof) {
+                if (inp.enabled[dof] && blocks[dof].is_blocked(t)) {
+                    return false;
+                }
             }
-        }
-        if (std::all_of(inp_per_dof_synchronization.begin(), inp_per_dof_synchronization.end(), [](Synchronization s){ return s == Synchronization::None; })) {
-            return Result::Working;
-        }
-
-        // Phase Synchronization
-        if (std::any_of(inp_per_dof_synchronization.begin(), inp_per_dof_synchronization.end(), [](Synchronization s){ return s == Synchronization::Phase; }) && std::all_of(inp_per_dof_control_interface.begin(), inp_per_dof_control_interface.end(), [](ControlInterface s){ return s == ControlInterface::Position; })) {
-            if (is_input_collinear(inp, inp.max_jerk, profiles[limiting_dof].direction, limiting_dof, new_max_jerk)) {
-                bool found_time_synchronization {true};
-                for (size_t dof = 0; dof < profiles.size(); ++dof) {
-                    if (!inp.enabled[dof] || dof == limiting_dof || inp_per_dof_synchronization[dof] != Synchronization::Phase) {
-                        continue;
-                    }
-
-                    Profile& p = profiles[dof];
-                    const double t_profile = duration - p.brake.duration;
-
-                    p.t = profiles[limiting_dof].t; // Copy timing information from limiting DoF
-                    p.jerk_signs = profiles[limiting_dof].jerk_signs;
-                    p.set_boundary(inp.current_position[dof], inp.current_velocity[dof], inp.current_acceleration[dof], inp.target_position[dof], inp.target_velocity[dof], inp.target_acceleration[dof]);
+            return true;
+        };
 
-                    // Profile::Limits::NONE is a small hack, as there is no specialization for that in the check function
-                    switch (p.jerk_signs) {
-                        case Profile::JerkSigns::UDDU: {
-                            if (!p.check_with_timing<Profile::JerkSigns::UDDU, Profile::Limits::NONE>(t_profile, new_max_jerk[dof], inp.max_velocity[dof], inp_min_velocity[dof], inp.max_acceleration[dof], inp_min_acceleration[dof], inp.max_jerk[dof])) {
-                                found_time_synchronization = false;
-                            }
-                        } break;
-                        case Profile::JerkSigns::UDUD: {
-                            if (!p.check_with_timing<Profile::JerkSigns::UDUD, Profile::Limits::NONE>(t_profile, new_max_jerk[dof], inp.max_velocity[dof], inp_min_velocity[dof], inp.max_acceleration[dof], inp_min_acceleration[dof], inp.max_jerk[dof])) {
-                                found_time_synchronization = false;
-                            }
-                        } break;
+        if (!is_feasible(duration)) {
+            double t_sync {std::numeric_limits<double>::infinity()};
+            for (size_t dof = 0; dof < profiles.size(); ++dof) {
+                for (const auto& [interval, has_interval]: {std::make_pair(&blocks[dof].a, blocks[dof].has_a), std::make_pair(&blocks[dof].b, blocks[dof].has_b)}) {
+                    if (inp.enabled[dof] && has_interval && interval->right >= duration && interval->right < t_sync && is_feasible(interval->right)) {
+                        t_sync = interval->right;
                     }
-
-                    p.limits = profiles[limiting_dof].limits; // After check method call to set correct limits
-                }
-
-                if (found_time_synchronization && std::all_of(inp_per_dof_synchronization.begin(), inp_per_dof_synchronization.end(), [](Synchronization s){ return s == Synchronization::Phase || s == Synchronization::None; })) {
-                    return Result::Working;
                 }
             }
+            if (t_sync < std::numeric_limits<double>::infinity()) {
+                duration = t_sync;
+            }
         }
 
-        // Time Synchronization
         for (size_t dof = 0; dof < profiles.size(); ++dof) {
-            if (!inp.enabled[dof] || dof == limiting_dof || inp_per_dof_synchronization[dof] == Synchronization::None) {
+            if (!inp.enabled[dof]) {
                 continue;
             }
 
+            // The profile still holds the brake trajectory of Step 1
             Profile& p = profiles[dof];
-            const double t_profile = duration - p.brake.duration;
-
-            if (inp_per_dof_synchronization[dof] == Synchronization::TimeIfNecessary && std::abs(inp.target_velocity[dof]) < eps && std::abs(inp.target_acceleration[dof]) < eps) {
-                p = blocks[dof].p_min;
-                continue;
-            }
-
-            // Check if the final time corresponds to an extremal profile calculated in step 1
-            if (std::abs(t_profile - blocks[dof].t_min) < eps) {
-                p = blocks[dof].p_min;
+            if (std::abs(duration - blocks[dof].t_min) < eps) {
+                p = blocks[dof].get_min_profile();
                 continue;
-            } else if (blocks[dof].a && std::abs(t_profile - blocks[dof].a->right) < eps) {
-                p = blocks[dof].a->profile;
+            } else if (blocks[dof].has_a && std::abs(duration - blocks[dof].a.right) < eps) {
+                p = blocks[dof].get_profile(blocks[dof].a);
                 continue;
-            } else if (blocks[dof].b && std::abs(t_profile - blocks[dof].b->right) < eps) {
-                p = blocks[dof].b->profile;
+            } else if (blocks[dof].has_b && std::abs(duration - blocks[dof].b.right) < eps) {
+                p = blocks[dof].get_profile(blocks[dof].b);
                 continue;
             }
 
-            bool found_time_synchronization;
-            switch (inp_per_dof_control_interface[dof]) {
-                case ControlInterface::Position: {
-                    PositionStep2 step2 {t_profile, p0s[dof], v0s[dof], a0s[dof], inp.target_position[dof], inp.target_velocity[dof], inp.target_acceleration[dof], inp.max_velocity[dof], inp_min_velocity[dof], inp.max_acceleration[dof], inp_min_acceleration[dof], inp.max_jerk[dof]};
-                    found_time_synchronization = step2.get_profile(p);
-                } break;
-                case ControlInterface::Velocity: {
-                    VelocityStep2 step2 {t_profile, p0s[dof], v0s[dof], a0s[dof], inp.target_velocity[dof], inp.target_acceleration[dof], inp.max_acceleration[dof], inp_min_acceleration[dof], inp.max_jerk[dof]};
-                    found_time_synchronization = step2.get_profile(p);
-                } break;
+            VelocityStep2 step2 {duration - p.brake.duration, p0s[dof], v0s[dof], a0s[dof], 0.0, 0.0, inp.max_acceleration[dof], inp_min_acceleration[dof], inp.max_jerk[dof]};
+            if (!step2.get_profile(p)) {
+                p = blocks[dof].get_min_profile();
             }
-            if (!found_time_synchronization) {
-                if constexpr (throw_error) {
-                    throw std::runtime_error("[ruckig] error in step 2 in dof: " + std::to_string(dof) + " for t sync: " + std::to_string(duration) + " input: " + inp.to_string());
-                }
-                return Result::ErrorSynchronizationCalculation;
-            }
-            // std::cout << dof << " profile step2: " << p.to_string() << std::endl;
         }
-
         return Result::Working;
     }
 
-    //! Continue the trajectory calculation
-    template<bool throw_error, bool return_error_at_maximal_duration>
-    Result continue_calculation(const InputParameter<DOFs>&, double, bool&) {
-        return Result::Error;
-    }
-
-    //! Get the kinematic state at a given time
+    //! Correct the remaining part of a previous trajectory for a slightly changed target position, instead of a full
+    //! calculation (see ProfileRetargeting)
+
+    //! The previous trajectory is cut at the given time, whose state needs to be the current state of the input. Each
+    //! DoF keeps the jerks of its profile, and only its remaining segment durations are corrected. The limiting DoFs
+    //! keep their time-optimal structure, which determines the new duration, and all other DoFs are synchronized to it.
+    //! Only a position interface with time synchronization to targets at rest is supported, without minimum duration,
+    //! discrete durations, or position limits. Returns false if the correction is not supported or fails the checks of
+    //! a calculated profile, so that a full calculation is needed. The previous trajectory must not defer Step 2. Limits
+    //! known at compile-time replace the limits of the input (see has_constant_limits).
+    template<class Limits = RuntimeLimits>
+    bool calculate_retarget(const Trajectory<DOFs, MaxDOFs>& previous, double time, const InputParameter<DOFs, MaxDOFs>& inp) {
+        if (inp.control_interface != ControlInterface::Position || inp.synchronization != Synchronization::Time || inp.duration_discretization != DurationDiscretization::Continuous
+            || inp.per_dof_control_interface || inp.per_dof_synchronization || inp.synchronization_groups || inp.minimum_duration
+            || inp.max_position || inp.min_position || !inp.intermediate_positions.empty() || !(time >= 0.0 && time < previous.duration) || previous.has_deferred_step2()) {
+            return false;
+        }
 
-    //! The Python wrapper takes `time` as an argument, and returns `new_position`, `new_velocity`, and `new_acceleration` instead.
-    void at_time(double time, Vector<double>& new_position, Vector<double>& new_velocity, Vector<double>& new_acceleration, size_t& new_section) const {
-        if constexpr (DOFs == 0) {
-            if (degrees_of_freedom != new_position.size() || degrees_of_freedom != new_velocity.size() || degrees_of_freedom != new_acceleration.size()) {
-                throw std::runtime_error("[ruckig] mismatch in degrees of freedom (vector size).");
-            }
+        const TraceScope trace {TracePoint::Calculate};
+        calculation_stage = Stage::None;
+        error = {};
+        position_extrema.reset();
+        kinematic_extrema.reset();
+        segment_coefficients.reset();
+        clear_deferred_step2();
+        has_step2_hints = false;
+        for (size_t dof = 0; dof < profiles.size(); ++dof) {
+            step1_inputs[dof].valid = false;
         }
 
-        if (time >= duration) {
-            // Keep constant acceleration
-            new_section = 1;
-            for (size_t dof = 0; dof < profiles.size(); ++dof) {
-                const double t_diff = time - (profiles[dof].brake.duration + profiles[dof].t_sum[6]);
-                std::tie(new_position[dof], new_velocity[dof], new_acceleration[dof]) = Profile::integrate(t_diff, profiles[dof].pf, profiles[dof].vf, profiles[dof].af, 0);
+        const auto is_limiting = [&](size_t dof) {
+            return std::abs(previous.independent_min_durations[dof] - previous.duration) < 1e-8;
+        };
+
+        const auto is_finished = [&](size_t dof) {
+            return time >= previous.profiles[dof].brake.duration + previous.profiles[dof].t_sum[6];
+        };
+
+        const auto retarget = [&](size_t dof, std::optional<double> synchronized_duration) {
+            double vMax, vMin, aMax, aMin;
+            if constexpr (has_constant_limits<Limits>) {
+                vMax = Limits::max_velocity;
+                vMin = -Limits::max_velocity;
+                aMax = Limits::max_acceleration;
+                aMin = -Limits::max_acceleration;
+            } else {
+                vMax = inp.max_velocity[dof];
+                vMin = inp.min_velocity ? inp.min_velocity.value()[dof] : -inp.max_velocity[dof];
+                aMax = inp.max_acceleration[dof];
+                aMin = inp.min_acceleration ? inp.min_acceleration.value()[dof] : -inp.max_acceleration[dof];
             }
-            return;
-        }
+            ProfileRetargeting retargeting {previous.profiles[dof], time, inp.current_position[dof], inp.current_velocity[dof], inp.current_acceleration[dof], inp.target_position[dof], vMax, vMin, aMax, aMin, !synchronized_duration};
+            profiles[dof] = previous.profiles[dof]; // Keeps the limits and direction
+            return retargeting.solve(synchronized_duration, profiles[dof]);
+        };
 
-        new_section = 0;
+        // The limiting DoFs determine the new duration
+        bool has_duration {false};
         for (size_t dof = 0; dof < profiles.size(); ++dof) {
-            const Profile& p = profiles[dof];
-
-            double t_diff = time;
-            if (p.brake.duration > 0) {
-                if (t_diff < p.brake.duration) {
-                    const size_t index = (t_diff < p.brake.t[0]) ? 0 : 1;
-                    if (index > 0) {
-                        t_diff -= p.brake.t[index - 1];
-                    }
+            if (!inp.enabled[dof]) {
+                continue;
+            }
 
-                    std::tie(new_position[dof], new_velocity[dof], new_acceleration[dof]) = Profile::integrate(t_diff, p.brake.p[index], p.brake.v[index], p.brake.a[index], p.brake.j[index]);
-                    continue;
-                } else {
-                    t_diff -= p.brake.duration;
-                }
+            const Profile& previous_profile = previous.profiles[dof];
+            if (inp.target_velocity[dof] != 0.0 || inp.target_acceleration[dof] != 0.0 || !std::isfinite(inp.target_position[dof]) || time < previous_profile.brake.duration) {
+                return false;
             }
 
-            // Non-time synchronization
-            if (t_diff >= p.t_sum[6]) {
-                // Keep constant acceleration
-                std::tie(new_position[dof], new_velocity[dof], new_acceleration[dof]) = Profile::integrate(t_diff - p.t_sum[6], p.pf, p.vf, p.af, 0);
+            // A finished DoF needs to stay at its target
+            if (is_finished(dof)) {
+                if (inp.target_position[dof] != previous_profile.pf || inp.current_velocity[dof] != 0.0 || inp.current_acceleration[dof] != 0.0) {
+                    return false;
+                }
                 continue;
             }
 
-            const auto index_ptr = std::upper_bound(p.t_sum.begin(), p.t_sum.end(), t_diff);
-            const size_t index = std::distance(p.t_sum.begin(), index_ptr);
-
-            if (index > 0) {
-                t_diff -= p.t_sum[index - 1];
+            if (!is_limiting(dof)) {
+                continue;
+            }
+            if (!retarget(dof, std::nullopt)) {
+                return false;
             }
 
-            std::tie(new_position[dof], new_velocity[dof], new_acceleration[dof]) = Profile::integrate(t_diff, p.p[index], p.v[index], p.a[index], p.j[index]);
+            if (!has_duration) {
+                duration = profiles[dof].t_sum[6];
+                has_duration = true;
+            } else if (std::abs(profiles[dof].t_sum[6] - duration) > 1e-8) {
+                return false;
+            }
+        }
+        if (!has_duration) {
+            return false;
         }
-    }
 
-    //! Get the kinematic state and current section at a given time
-    void at_time(double time, Vector<double>& new_position, Vector<double>& new_velocity, Vector<double>& new_acceleration) const {
-        size_t new_section;
-        at_time(time, new_position, new_velocity, new_acceleration, new_section);
-    }
+        for (size_t dof = 0; dof < profiles.size(); ++dof) {
+            if (!inp.enabled[dof] || is_finished(dof)) {
+                Profile& p = profiles[dof];
+                p.brake.duration = 0.0;
+                p.pf = inp.current_position[dof];
+                p.vf = inp.current_velocity[dof];
+                p.af = inp.current_acceleration[dof];
+                p.t_sum[6] = 0.0;
+                independent_min_durations[dof] = 0.0;
+                continue;
+            }
 
-    //! Get the duration of the (synchronized) trajectory
-    double get_duration() const {
-        return duration;
-    }
+            if (is_limiting(dof)) {
+                independent_min_durations[dof] = duration;
+                continue;
+            }
+            if (!retarget(dof, duration)) {
+                return false;
+            }
 
-    //! Get the durations when the intermediate waypoints are reached
-    std::vector<double> get_intermediate_durations() const {
-        return {duration};
+            // Not recalculated, the previous minimal duration from the new start is kept for the small target change
+            independent_min_durations[dof] = std::clamp(previous.independent_min_durations[dof] - time, 0.0, duration);
+        }
+        return true;
     }
 
-    //! Get the minimum duration of each independent DoF
-    Vector<double> get_independent_min_durations() const {
-        return independent_min_durations;
+    //! Error of the last calculation, or Result::Working if it succeeded
+    const CalculationError& get_error() const {
+        return error;
     }
 
-    //! Get the min/max values of the position for each DoF
-    Vector<PositionExtrema> get_position_extrema() {
-        for (size_t dof = 0; dof < profiles.size(); ++dof) {
-            position_extrema[dof] = profiles[dof].get_position_extrema();
-        }
-        return position_extrema;
+    //! Is a calculation interrupted and waiting to be continued?
+    bool is_calculation_interrupted() const {
+        return calculation_stage != Stage::None;
     }
 
-    //! Get the time that this trajectory passes a specific position of a given DoF the first time
-
-    //! If the position is passed, this method returns true, otherwise false
-    //! The Python wrapper takes `dof` and `position` as arguments and returns `time` (or `None`) instead
-    bool get_first_time_at_position(size_t dof, double position, double& time) const {
-        if (dof >= degrees_of_freedom) {
-            return false;
-        }
-
-        double v, a;
-        return profiles[dof].get_first_state_at_position(position, time, v, a);
-    }
 };
 
 } // namespace ruckig
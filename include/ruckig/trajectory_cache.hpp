@@ -0,0 +1,287 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <vector>
+
+#include <ruckig/input_parameter.hpp>
+#include <ruckig/input_recorder.hpp>
+#include <ruckig/serialization.hpp>
+#include <ruckig/trajectory.hpp>
+
+#ifndef RUCKIG_VERSION
+#define RUCKIG_VERSION "unknown"
+#endif
+
+
+namespace ruckig {
+
+//! Fixed-size cache of calculated trajectories with least-recently-used replacement
+
+//! All entries are allocated at construction, so that lookups and insertions do not allocate memory (except for
+//! inputs with intermediate positions in case of dynamic DoFs). Inputs are matched exactly by default; with a positive
+//! quantization, the kinematic state and limits are compared after rounding to multiples of the quantization instead.
+//! Only the executable part of the trajectories is stored, without the workspace of their calculation.
+//!
+//! A snapshot of the cache (e.g. written to a file) restores a warm cache at startup without any calculation. It
+//! consists of a header (the magic "RUCKIGCA", the snapshot and input recording versions as uint32 each, a hash of the
+//! library version, the quantization, and the number of entries) followed by the entries from the least to the most
+//! recently used. Each entry holds the hash of its input, the input as a record of the InputRecording, and the
+//! serialized trajectory, so that all fields stay 8-byte aligned, e.g. in a memory-mapped file. Entries with
+//! intermediate positions are not part of a snapshot.
+template<size_t DOFs, size_t MaxDOFs = 0>
+class TrajectoryCache {
+    struct Entry {
+        bool valid {false};
+        uint64_t hash;
+        uint64_t last_used;
+        InputParameter<DOFs, MaxDOFs> input;
+        ExecutableTrajectory<DOFs, MaxDOFs> trajectory;
+    };
+
+    std::vector<Entry> entries;
+    uint64_t use_counter {0};
+
+    uint64_t key(double value) const {
+        if (quantization > 0.0) {
+            return static_cast<uint64_t>(std::llround(value / quantization));
+        }
+
+        uint64_t bits;
+        std::memcpy(&bits, &value, sizeof(double));
+        return bits;
+    }
+
+    //! FNV-1a hash of the kinematic state, limits, and settings
+    uint64_t hash(const InputParameter<DOFs, MaxDOFs>& input) const {
+        uint64_t result {14695981039346656037ULL};
+        auto add = [&result](uint64_t value) {
+            result ^= value;
+            result *= 1099511628211ULL;
+        };
+
+        add(static_cast<uint64_t>(input.control_interface));
+        add(static_cast<uint64_t>(input.synchronization));
+        add(static_cast<uint64_t>(input.duration_discretization));
+        for (const auto* vector: {&input.current_position, &input.current_velocity, &input.current_acceleration, &input.target_position, &input.target_velocity, &input.target_acceleration, &input.max_velocity, &input.max_acceleration, &input.max_jerk}) {
+            for (const double value: *vector) {
+                add(key(value));
+            }
+        }
+        return result;
+    }
+
+    bool is_equal(const InputParameter<DOFs, MaxDOFs>& a, const InputParameter<DOFs, MaxDOFs>& b) const {
+        if (quantization <= 0.0) {
+            return !(a != b);
+        }
+
+        for (size_t dof = 0; dof < a.degrees_of_freedom; ++dof) {
+            if (key(a.current_position[dof]) != key(b.current_position[dof])
+                || key(a.current_velocity[dof]) != key(b.current_velocity[dof])
+                || key(a.current_acceleration[dof]) != key(b.current_acceleration[dof])
+                || key(a.target_position[dof]) != key(b.target_position[dof])
+                || key(a.target_velocity[dof]) != key(b.target_velocity[dof])
+                || key(a.target_acceleration[dof]) != key(b.target_acceleration[dof])
+                || key(a.max_velocity[dof]) != key(b.max_velocity[dof])
+                || key(a.max_acceleration[dof]) != key(b.max_acceleration[dof])
+                || key(a.max_jerk[dof]) != key(b.max_jerk[dof])) {
+                return false;
+            }
+        }
+
+        return (
+            a.intermediate_positions == b.intermediate_positions
+            && a.max_position == b.max_position
+            && a.min_position == b.min_position
+            && a.enabled == b.enabled
+            && a.minimum_duration == b.minimum_duration
+            && a.min_velocity == b.min_velocity
+            && a.min_acceleration == b.min_acceleration
+            && a.control_interface == b.control_interface
+            && a.synchronization == b.synchronization
+            && a.duration_discretization == b.duration_discretization
+            && a.per_dof_control_interface == b.per_dof_control_interface
+            && a.per_dof_synchronization == b.per_dof_synchronization
+        );
+    }
+
+    //! FNV-1a hash of the library version, as trajectories of a different version may differ
+    static uint64_t library_version_hash() {
+        uint64_t result {14695981039346656037ULL};
+        for (const char* c = RUCKIG_VERSION; *c != '\0'; ++c) {
+            result ^= static_cast<uint8_t>(*c);
+            result *= 1099511628211ULL;
+        }
+        return result;
+    }
+
+public:
+    constexpr static std::array<char, 8> snapshot_magic {'R', 'U', 'C', 'K', 'I', 'G', 'C', 'A'};
+
+    //! Version of the snapshot format, incremented for incompatible changes
+    constexpr static uint32_t snapshot_version {1};
+
+    constexpr static size_t snapshot_header_size {40};
+
+    //! Resolution for matching inputs, or zero for exact matches
+    double quantization {0.0};
+
+    //! Statistics of the lookups
+    size_t hits {0}, misses {0};
+
+    template <size_t D = DOFs, typename std::enable_if<D >= 1, int>::type = 0>
+    explicit TrajectoryCache(size_t capacity, double quantization = 0.0): entries(capacity), quantization(quantization) { }
+
+    template <size_t D = DOFs, typename std::enable_if<D == 0, int>::type = 0>
+    explicit TrajectoryCache(size_t capacity, size_t dofs, double quantization = 0.0): entries(capacity, Entry {false, 0, 0, InputParameter<0, MaxDOFs>(dofs), ExecutableTrajectory<0, MaxDOFs>(dofs)}), quantization(quantization) { }
+
+    //! Copy a previously calculated trajectory for the input into the given trajectory, returns whether it was found
+    bool find(const InputParameter<DOFs, MaxDOFs>& input, Trajectory<DOFs, MaxDOFs>& trajectory) {
+        const uint64_t input_hash = hash(input);
+        for (auto& entry: entries) {
+            if (entry.valid && entry.hash == input_hash && is_equal(entry.input, input)) {
+                entry.last_used = ++use_counter;
+                trajectory.assign(entry.trajectory);
+                ++hits;
+                return true;
+            }
+        }
+
+        ++misses;
+        return false;
+    }
+
+    //! Store a calculated trajectory, replacing the least recently used entry if the cache is full
+    void insert(const InputParameter<DOFs, MaxDOFs>& input, const Trajectory<DOFs, MaxDOFs>& trajectory) {
+        if (entries.empty()) {
+            return;
+        }
+
+        Entry* replaced {&entries.front()};
+        for (auto& entry: entries) {
+            if (!entry.valid) {
+                replaced = &entry;
+                break;
+            }
+            if (entry.last_used < replaced->last_used) {
+                replaced = &entry;
+            }
+        }
+
+        replaced->valid = true;
+        replaced->hash = hash(input);
+        replaced->last_used = ++use_counter;
+        replaced->input = input;
+        replaced->trajectory = trajectory;
+    }
+
+    //! Remove all entries (keeping the allocated memory) and reset the statistics
+    void clear() {
+        for (auto& entry: entries) {
+            entry.valid = false;
+        }
+        hits = 0;
+        misses = 0;
+    }
+
+    //! Append a snapshot of all entries to the buffer, e.g. to write it to a file before shutdown (not real-time capable)
+    void save(std::vector<uint8_t>& buffer) const {
+        std::vector<const Entry*> saved;
+        for (const auto& entry: entries) {
+            if (entry.valid && entry.input.intermediate_positions.empty()) {
+                saved.push_back(&entry);
+            }
+        }
+        std::sort(saved.begin(), saved.end(), [](const Entry* a, const Entry* b) { return a->last_used < b->last_used; });
+
+        const size_t begin = buffer.size();
+        buffer.resize(begin + snapshot_header_size);
+        uint8_t* header = buffer.data() + begin;
+        std::memcpy(header, snapshot_magic.data(), snapshot_magic.size());
+        TrajectorySerialization::store(header + 8, static_cast<uint64_t>(snapshot_version) | (InputRecording::version << 32));
+        TrajectorySerialization::store(header + 16, library_version_hash());
+        TrajectorySerialization::store(header + 24, quantization);
+        TrajectorySerialization::store(header + 32, static_cast<uint64_t>(saved.size()));
+
+        for (const Entry* entry: saved) {
+            const size_t offset = buffer.size();
+            buffer.resize(offset + 8 + InputRecording::max_record_size(entry->input.degrees_of_freedom));
+            TrajectorySerialization::store(buffer.data() + offset, entry->hash);
+            const size_t record_size = InputRecording::write_record(0, entry->input, buffer.data() + offset + 8);
+            buffer.resize(offset + 8 + record_size);
+            TrajectorySerialization::write(entry->trajectory, buffer);
+        }
+    }
+
+    //! Replace all entries with a snapshot, e.g. from a memory-mapped file at startup (not real-time capable)
+
+    //! Returns false and leaves the cache empty if the snapshot is invalid or incomplete, was written by a different
+    //! library version or with a different quantization, or if the hash or the number of DoFs of any entry does not
+    //! match. If the snapshot holds more entries than the capacity, the most recently used ones are kept.
+    bool load(const uint8_t* data, size_t size) {
+        clear();
+        use_counter = 0;
+
+        if (size < snapshot_header_size || std::memcmp(data, snapshot_magic.data(), snapshot_magic.size()) != 0
+            || TrajectorySerialization::load_integer(data + 8) != (static_cast<uint64_t>(snapshot_version) | (InputRecording::version << 32))
+            || TrajectorySerialization::load_integer(data + 16) != library_version_hash()
+            || TrajectorySerialization::load_double(data + 24) != quantization) {
+            return false;
+        }
+
+        const size_t number_entries = TrajectorySerialization::load_integer(data + 32);
+        const size_t skipped = (number_entries > entries.size()) ? number_entries - entries.size() : 0;
+
+        size_t offset {snapshot_header_size};
+        for (size_t i = 0; i < number_entries; ++i) {
+            Entry& entry = entries[(i < skipped) ? 0 : i - skipped];
+            entry.valid = false;
+
+            uint64_t cycle;
+            if (offset + 8 > size) {
+                clear();
+                return false;
+            }
+            entry.hash = TrajectorySerialization::load_integer(data + offset);
+            offset += 8;
+            if (!InputRecording::read_record(data, size, offset, cycle, entry.input) || entry.input.degrees_of_freedom != entry.trajectory.degrees_of_freedom || hash(entry.input) != entry.hash) {
+                clear();
+                return false;
+            }
+
+            if (!TrajectorySerialization::read(data + offset, size - offset, entry.trajectory)) {
+                clear();
+                return false;
+            }
+            offset += TrajectorySerialization::size(entry.trajectory.degrees_of_freedom);
+
+            entry.valid = true;
+            entry.last_used = ++use_counter;
+        }
+        return true;
+    }
+
+    size_t capacity() const {
+        return entries.size();
+    }
+
+    size_t size() const {
+        size_t result {0};
+        for (const auto& entry: entries) {
+            result += entry.valid;
+        }
+        return result;
+    }
+
+    //! Ratio of lookups that were found in the cache
+    double hit_rate() const {
+        return (hits + misses > 0) ? static_cast<double>(hits) / (hits + misses) : 0.0;
+    }
+};
+
+} // namespace ruckig
@@ -0,0 +1,260 @@
+#pragma once
+
+#include <array>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <mutex>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <ruckig/executable_trajectory.hpp>
+#include <ruckig/serialization.hpp>
+
+
+namespace ruckig {
+
+enum class ExportFormat {
+    Binary, ///< Chunks of columns, see TrajectoryExporter
+    CSV, ///< A row per sample with the trajectory index, the time, and the positions, velocities, and accelerations
+};
+
+
+//! Streaming writer of sampled trajectories, e.g. for exporting every move of a production run
+
+//! Each written trajectory is sampled with the TrajectorySampler (at multiples of the time step and exactly at the
+//! duration) into a chunk of a bounded number of samples, which is written to the stream once it is full. Therefore,
+//! the memory is independent of the trajectory durations. Asynchronously, a background thread writes the previous
+//! chunk while the next one is sampled, so that at most two chunks are buffered.
+//!
+//! In the binary format, a chunk consists of a header (the magic "RUCKIGSC", the format version and the number of DoFs
+//! as uint32, the number of samples and the index of the trajectory as uint64) followed by the columns of the time and
+//! of the position, velocity, and acceleration of each DoF (in this order, DoF by DoF). All values are little-endian,
+//! as in the TrajectorySerialization; a chunk never spans two trajectories.
+class TrajectoryExporter {
+    constexpr static std::array<char, 8> magic {'R', 'U', 'C', 'K', 'I', 'G', 'S', 'C'};
+
+    std::ostream& stream;
+
+    std::vector<double> columns; // Of the current binary chunk
+    std::string buffer; // Encoded current chunk
+    size_t chunk_size {0}; // Number of samples in the current chunk
+    size_t dofs {0};
+    size_t trajectory_index {0};
+    size_t number_samples {0};
+
+    // Handoff to the background thread
+    std::string pending;
+    bool has_pending {false}, stop {false}, failed {false};
+    std::mutex mutex;
+    std::condition_variable condition;
+    std::thread thread;
+
+    void run() {
+        std::unique_lock<std::mutex> lock {mutex};
+        while (true) {
+            condition.wait(lock, [this]{ return has_pending || stop; });
+            if (!has_pending) {
+                return;
+            }
+
+            lock.unlock();
+            stream.write(pending.data(), pending.size());
+            const bool success = static_cast<bool>(stream);
+            lock.lock();
+
+            failed |= !success;
+            pending.clear();
+            has_pending = false;
+            condition.notify_all();
+        }
+    }
+
+    //! Hand the encoded buffer over to the stream
+    void emit() {
+        if (thread.joinable()) {
+            std::unique_lock<std::mutex> lock {mutex};
+            condition.wait(lock, [this]{ return !has_pending; });
+            if (failed) {
+                throw std::runtime_error("[ruckig] writing the exported trajectory failed.");
+            }
+
+            std::swap(buffer, pending); // The former pending buffer is empty, but keeps its memory
+            has_pending = true;
+            condition.notify_all();
+
+        } else {
+            stream.write(buffer.data(), buffer.size());
+            buffer.clear();
+            if (!stream) {
+                throw std::runtime_error("[ruckig] writing the exported trajectory failed.");
+            }
+        }
+    }
+
+    void encode_chunk() {
+        const size_t column_count = 1 + 3 * dofs;
+        const size_t begin = buffer.size();
+        buffer.resize(begin + header_size + 8 * column_count * chunk_size);
+
+        uint8_t* data = reinterpret_cast<uint8_t*>(&buffer[begin]);
+        std::memcpy(data, magic.data(), magic.size());
+        TrajectorySerialization::store(data + 8, static_cast<uint64_t>(version) | (static_cast<uint64_t>(dofs) << 32));
+        TrajectorySerialization::store(data + 16, static_cast<uint64_t>(chunk_size));
+        TrajectorySerialization::store(data + 24, static_cast<uint64_t>(trajectory_index));
+
+        data += header_size;
+        for (size_t column = 0; column < column_count; ++column) {
+            for (size_t i = 0; i < chunk_size; ++i, data += 8) {
+                TrajectorySerialization::store(data, columns[column * chunk_samples + i]);
+            }
+        }
+    }
+
+    void finish_chunk() {
+        if (chunk_size == 0) {
+            return;
+        }
+
+        if (format == ExportFormat::Binary) {
+            encode_chunk();
+        }
+        emit();
+        chunk_size = 0;
+    }
+
+    template<class Vector>
+    void append_row(double time, const Vector& position, const Vector& velocity, const Vector& acceleration) {
+        std::array<char, 32> text;
+        const auto append = [&](double value) {
+            const int length = std::snprintf(text.data(), text.size(), ",%.17g", value);
+            buffer.append(text.data(), static_cast<size_t>(length));
+        };
+
+        buffer.append(std::to_string(trajectory_index));
+        append(time);
+        for (const auto* values: {&position, &velocity, &acceleration}) {
+            for (size_t dof = 0; dof < dofs; ++dof) {
+                append((*values)[dof]);
+            }
+        }
+        buffer.push_back('\n');
+    }
+
+    void write_csv_header() {
+        buffer.append("trajectory,time");
+        for (const char* name: {"position", "velocity", "acceleration"}) {
+            for (size_t dof = 0; dof < dofs; ++dof) {
+                buffer.append(",").append(name).append("_").append(std::to_string(dof));
+            }
+        }
+        buffer.push_back('\n');
+    }
+
+public:
+    //! Version of the binary format, incremented for incompatible changes
+    constexpr static uint32_t version {1};
+    constexpr static size_t header_size {32};
+
+    const ExportFormat format;
+
+    //! Maximal number of samples per chunk
+    const size_t chunk_samples;
+
+    //! Export into the stream (which needs to outlive the exporter, and be opened in binary mode for the binary format)
+    explicit TrajectoryExporter(std::ostream& stream, ExportFormat format = ExportFormat::Binary, size_t chunk_samples = 4096, bool asynchronous = false): stream(stream), format(format), chunk_samples(chunk_samples) {
+        if (chunk_samples == 0) {
+            throw std::runtime_error("[ruckig] the chunk size of the export needs to be positive.");
+        }
+
+        if (asynchronous) {
+            thread = std::thread([this]{ run(); });
+        }
+    }
+
+    TrajectoryExporter(const TrajectoryExporter&) = delete;
+    TrajectoryExporter& operator=(const TrajectoryExporter&) = delete;
+
+    ~TrajectoryExporter() {
+        try {
+            close();
+        } catch (...) { }
+    }
+
+    //! Sample the trajectory with the given time step and append it to the export
+    template<size_t DOFs, size_t MaxDOFs>
+    void write(const ExecutableTrajectory<DOFs, MaxDOFs>& trajectory, double delta_time) {
+        if (trajectory_index == 0) {
+            dofs = trajectory.degrees_of_freedom;
+            if (format == ExportFormat::Binary) {
+                columns.resize((1 + 3 * dofs) * chunk_samples);
+            } else {
+                write_csv_header();
+            }
+
+        } else if (trajectory.degrees_of_freedom != dofs) {
+            throw std::runtime_error("[ruckig] mismatch in degrees of freedom (vector size).");
+        }
+
+        TrajectorySampler<DOFs, MaxDOFs> sampler {trajectory, delta_time};
+        do {
+            if (format == ExportFormat::Binary) {
+                double* column = columns.data() + chunk_size;
+                column[0] = sampler.time;
+                for (size_t dof = 0; dof < dofs; ++dof) {
+                    column[(1 + dof) * chunk_samples] = sampler.position[dof];
+                    column[(1 + dofs + dof) * chunk_samples] = sampler.velocity[dof];
+                    column[(1 + 2 * dofs + dof) * chunk_samples] = sampler.acceleration[dof];
+                }
+            } else {
+                append_row(sampler.time, sampler.position, sampler.velocity, sampler.acceleration);
+            }
+
+            ++number_samples;
+            if (++chunk_size == chunk_samples) {
+                finish_chunk();
+            }
+        } while (sampler.next());
+
+        // A binary chunk belongs to a single trajectory
+        if (format == ExportFormat::Binary) {
+            finish_chunk();
+        }
+        ++trajectory_index;
+    }
+
+    //! Write the remaining samples and wait until the stream received them, throws if writing failed
+    void close() {
+        finish_chunk();
+
+        if (thread.joinable()) {
+            {
+                std::lock_guard<std::mutex> lock {mutex};
+                stop = true;
+            }
+            condition.notify_all();
+            thread.join();
+
+            if (failed) {
+                throw std::runtime_error("[ruckig] writing the exported trajectory failed.");
+            }
+        }
+        stream.flush();
+    }
+
+    //! Number of samples written so far, in total
+    size_t size() const {
+        return number_samples;
+    }
+
+    //! Number of trajectories written so far
+    size_t trajectories() const {
+        return trajectory_index;
+    }
+};
+
+} // namespace ruckig
@@ -0,0 +1,93 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+#include <ruckig/trajectory.hpp>
+
+
+namespace ruckig {
+
+//! Wait-free, triple-buffered handoff of trajectories from a single producer to a single consumer thread
+
+//! The producer (e.g. a planning thread) calculates into its back buffer and publishes it, the consumer (e.g. the
+//! real-time thread) adopts the latest published trajectory together with its sampling time offset. Both sides only
+//! exchange a buffer index with a single atomic operation, so that neither locks, allocates, nor copies a trajectory.
+//! Trajectories published in between two receive calls are dropped, only the latest one is adopted.
+template<size_t DOFs, size_t MaxDOFs = 0>
+class TrajectoryMailbox {
+    struct Slot {
+        Trajectory<DOFs, MaxDOFs> trajectory;
+        double time_offset {0.0};
+    };
+
+    constexpr static uint8_t index_mask {0b011};
+    constexpr static uint8_t fresh_flag {0b100}; // The middle buffer was published but not received yet
+
+    static_assert(std::atomic<uint8_t>::is_always_lock_free, "[ruckig] the trajectory mailbox requires lock-free atomics.");
+
+    std::array<Slot, 3> slots;
+
+    uint8_t back_index {0}; // Owned by the producer
+    std::atomic<uint8_t> middle {1};
+    uint8_t front_index {2}; // Owned by the consumer
+
+public:
+    template <size_t D = DOFs, typename std::enable_if<D >= 1, int>::type = 0>
+    TrajectoryMailbox() { }
+
+    template <size_t D = DOFs, typename std::enable_if<D == 0, int>::type = 0>
+    TrajectoryMailbox(size_t dofs): slots({Slot {Trajectory<0, MaxDOFs>(dofs)}, Slot {Trajectory<0, MaxDOFs>(dofs)}, Slot {Trajectory<0, MaxDOFs>(dofs)}}) { }
+
+    TrajectoryMailbox(const TrajectoryMailbox&) = delete;
+    TrajectoryMailbox& operator=(const TrajectoryMailbox&) = delete;
+
+    // Producer side
+
+    //! Trajectory to calculate into before publishing it (a different buffer after each publish)
+    Trajectory<DOFs, MaxDOFs>& back() {
+        return slots[back_index].trajectory;
+    }
+
+    //! Publish the back buffer, which should be sampled at times relative to the given offset
+    void publish(double time_offset = 0.0) {
+        slots[back_index].time_offset = time_offset;
+        back_index = middle.exchange(back_index | fresh_flag, std::memory_order_acq_rel) & index_mask;
+    }
+
+    //! Copy the trajectory into the back buffer and publish it
+    void publish(const Trajectory<DOFs, MaxDOFs>& trajectory, double time_offset = 0.0) {
+        slots[back_index].trajectory = trajectory;
+        publish(time_offset);
+    }
+
+    // Consumer side
+
+    //! Is a trajectory published that was not received yet?
+    bool has_new() const {
+        return (middle.load(std::memory_order_acquire) & fresh_flag) != 0;
+    }
+
+    //! Adopt the latest published trajectory as the front buffer, returns false if there is no new one
+    bool receive() {
+        if (!has_new()) {
+            return false;
+        }
+
+        front_index = middle.exchange(front_index, std::memory_order_acq_rel) & index_mask;
+        return true;
+    }
+
+    //! The last received trajectory
+    const Trajectory<DOFs, MaxDOFs>& front() const {
+        return slots[front_index].trajectory;
+    }
+
+    //! The sampling time offset of the last received trajectory
+    double front_time_offset() const {
+        return slots[front_index].time_offset;
+    }
+};
+
+} // namespace ruckig
@@ -1,12 +1,296 @@
 #pragma once
 
-#include <string>
-#include <sstream>
-#include <iomanip>
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <initializer_list>
+#include <stdexcept>
+#include <thread>
 #include <type_traits>
+#include <utility>
+#include <vector>
+
+#ifdef RUCKIG_PMR
+    #include <memory_resource>
+#endif
+
+#ifndef RUCKIG_HARD_REALTIME
+    #include <iomanip>
+    #include <sstream>
+    #include <string>
+#endif
 
 namespace ruckig {
- 
+
+    //! Is the hard real-time profile enabled? Then, no diagnostics use exceptions, streams, or string building.
+#ifdef RUCKIG_HARD_REALTIME
+    constexpr static bool hard_realtime {true};
+#else
+    constexpr static bool hard_realtime {false};
+#endif
+
+    //! Do the heap-allocated containers (for dynamic DoFs and intermediate positions) use polymorphic allocators?
+#ifdef RUCKIG_PMR
+    constexpr static bool pmr_containers {true};
+
+    //! Vector on the heap, allocating from the default memory resource at the time of its construction
+    template<class T> using HeapVector = std::pmr::vector<T>;
+
+    //! Sets the default memory resource for its lifetime, e.g. to construct all dynamic-DoF types within an arena
+
+    //! Containers keep the resource of their construction, and copy assignments reuse the memory of the target. As
+    //! the default memory resource is global for the program, this should be used during the setup only.
+    class ScopedMemoryResource {
+        std::pmr::memory_resource* previous;
+
+    public:
+        explicit ScopedMemoryResource(std::pmr::memory_resource* resource): previous(std::pmr::set_default_resource(resource)) { }
+        ~ScopedMemoryResource() { std::pmr::set_default_resource(previous); }
+
+        ScopedMemoryResource(const ScopedMemoryResource&) = delete;
+        ScopedMemoryResource& operator=(const ScopedMemoryResource&) = delete;
+    };
+#else
+    constexpr static bool pmr_containers {false};
+
+    template<class T> using HeapVector = std::vector<T>;
+#endif
+
+    //! Size of a cache line in bytes, for separating data that is written by different threads
+    constexpr static size_t cache_line_size {64};
+
+    //! Places an object on its own cache lines, e.g. an instance together with its input and output in an array
+
+    //! In `std::vector<CacheAligned<Ruckig<3>>>` (or of a struct with an instance, input, and output), elements that
+    //! are updated from different threads don't share a cache line, so that there is no false sharing between them.
+    template<class T>
+    struct alignas(cache_line_size) CacheAligned: T {
+        using T::T;
+    };
+
+    //! Vector with inline storage of a fixed capacity, for a number of DoFs known only at runtime without heap allocations
+    template<class T, size_t Capacity>
+    class BoundedVector {
+        std::array<T, Capacity> values;
+        size_t count {0};
+
+    public:
+        using value_type = T;
+        using size_type = size_t;
+        using iterator = T*;
+        using const_iterator = const T*;
+
+        BoundedVector() { }
+        explicit BoundedVector(size_t size) { resize(size); }
+        BoundedVector(size_t size, const T& value) { resize(size, value); }
+        BoundedVector(std::initializer_list<T> list) {
+            resize(list.size());
+            std::copy(list.begin(), list.end(), values.begin());
+        }
+
+        void resize(size_t size) {
+            if (size > Capacity) {
+                throw std::runtime_error("[ruckig] number of DoFs exceeds the capacity of the bounded vector.");
+            }
+            count = size;
+        }
+
+        void resize(size_t size, const T& value) {
+            const size_t old_count = count;
+            resize(size);
+            if (count > old_count) {
+                std::fill(values.begin() + old_count, values.begin() + count, value);
+            }
+        }
+
+        constexpr static size_t capacity() { return Capacity; }
+        size_t size() const { return count; }
+        bool empty() const { return count == 0; }
+
+        T* data() { return values.data(); }
+        const T* data() const { return values.data(); }
+
+        T& operator[](size_t i) { return values[i]; }
+        const T& operator[](size_t i) const { return values[i]; }
+
+        T& front() { return values[0]; }
+        const T& front() const { return values[0]; }
+        T& back() { return values[count - 1]; }
+        const T& back() const { return values[count - 1]; }
+
+        iterator begin() { return values.data(); }
+        const_iterator begin() const { return values.data(); }
+        iterator end() { return values.data() + count; }
+        const_iterator end() const { return values.data() + count; }
+
+        bool operator==(const BoundedVector<T, Capacity>& rhs) const {
+            return count == rhs.count && std::equal(begin(), end(), rhs.begin());
+        }
+
+        bool operator!=(const BoundedVector<T, Capacity>& rhs) const {
+            return !(*this == rhs);
+        }
+    };
+
+    //! List of waypoints with an O(1) removal of its front, and an O(1) comparison with an unchanged copy
+
+    //! Removed elements are only skipped (keeping their memory until the list is assigned or cleared). Every other
+    //! modification, including a non-const access, gives the list a new globally unique revision. A copy keeps the
+    //! revision, so that comparing it with its origin only needs to check the revision and the removed count, as long
+    //! as both had the same elements removed since. Otherwise, the remaining elements are compared.
+    template<class T>
+    class WaypointList {
+        inline static std::atomic<uint64_t> last_revision {0};
+
+        HeapVector<T> values;
+        size_t offset {0}; // Number of removed elements at the front
+        uint64_t revision {next_revision()};
+
+        static uint64_t next_revision() {
+            return last_revision.fetch_add(1, std::memory_order_relaxed) + 1;
+        }
+
+        void modify() {
+            revision = next_revision();
+        }
+
+    public:
+        using value_type = T;
+        using size_type = size_t;
+        using iterator = typename HeapVector<T>::iterator;
+        using const_iterator = typename HeapVector<T>::const_iterator;
+
+        WaypointList() { }
+        WaypointList(std::initializer_list<T> list): values(list) { }
+        WaypointList(const std::vector<T>& values): values(values.begin(), values.end()) { }
+
+        WaypointList& operator=(std::initializer_list<T> list) {
+            values = list;
+            offset = 0;
+            modify();
+            return *this;
+        }
+
+        WaypointList& operator=(const std::vector<T>& new_values) {
+            values.assign(new_values.begin(), new_values.end());
+            offset = 0;
+            modify();
+            return *this;
+        }
+
+        size_t size() const { return values.size() - offset; }
+        bool empty() const { return values.size() == offset; }
+
+        //! Number of elements removed from the front since the last assignment
+        size_t removed() const { return offset; }
+
+        const T& operator[](size_t i) const { return values[offset + i]; }
+        T& operator[](size_t i) { modify(); return values[offset + i]; }
+
+        const T& front() const { return values[offset]; }
+        const T& back() const { return values.back(); }
+
+        const_iterator begin() const { return values.begin() + offset; }
+        const_iterator end() const { return values.end(); }
+        iterator begin() { modify(); return values.begin() + offset; }
+        iterator end() { modify(); return values.end(); }
+
+        void reserve(size_t capacity) { values.reserve(offset + capacity); }
+
+        void push_back(const T& value) {
+            values.push_back(value);
+            modify();
+        }
+
+        template<class... Args>
+        T& emplace_back(Args&&... args) {
+            modify();
+            return values.emplace_back(std::forward<Args>(args)...);
+        }
+
+        void clear() {
+            values.clear();
+            offset = 0;
+            modify();
+        }
+
+        //! Remove the first element in O(1)
+        void pop_front() {
+            ++offset;
+        }
+
+        //! Copy of the remaining elements
+        std::vector<T> to_vector() const {
+            return std::vector<T>(begin(), end());
+        }
+
+        bool operator==(const WaypointList<T>& rhs) const {
+            if (revision == rhs.revision && offset == rhs.offset) {
+                return true;
+            }
+            return size() == rhs.size() && std::equal(begin(), end(), rhs.begin());
+        }
+
+        bool operator!=(const WaypointList<T>& rhs) const {
+            return !(*this == rhs);
+        }
+    };
+
+    //! Container for per-DoF values: an array for a compile-time number of DoFs, otherwise a bounded (MaxDOFs > 0) or dynamic vector
+    template<class T, size_t DOFs, size_t MaxDOFs>
+    using DOFsVector = typename std::conditional<DOFs >= 1, std::array<T, DOFs>, typename std::conditional<MaxDOFs >= 1, BoundedVector<T, MaxDOFs>, HeapVector<T>>::type>::type;
+
+    //! Value that is calculated at most once on the first, possibly concurrent, access
+
+    //! Unlike std::once_flag, it is copyable (copying a calculated value only) and can be reset by its owner.
+    template<class T>
+    class LazyValue {
+        enum State : int { Empty, Calculating, Ready };
+
+        mutable T value;
+        mutable std::atomic<int> state {Empty};
+
+    public:
+        LazyValue() { }
+        explicit LazyValue(const T& value): value(value) { }
+        LazyValue(const LazyValue& other): value(other.value), state(other.state.load(std::memory_order_acquire) == Ready ? Ready : Empty) { }
+
+        LazyValue& operator=(const LazyValue& other) {
+            value = other.value;
+            state.store(other.state.load(std::memory_order_acquire) == Ready ? Ready : Empty, std::memory_order_release);
+            return *this;
+        }
+
+        //! Mark the value as outdated (must not be called concurrently with get)
+        void reset() {
+            state.store(Empty, std::memory_order_relaxed);
+        }
+
+        //! Get the value if it is calculated already, otherwise nullptr
+        const T* get_if_ready() const {
+            return (state.load(std::memory_order_acquire) == Ready) ? &value : nullptr;
+        }
+
+        //! Get the value, calling calculate(T&) first if it is outdated
+        template<class F>
+        const T& get(const F& calculate) const {
+            int expected {Empty};
+            if (state.load(std::memory_order_acquire) != Ready) {
+                if (state.compare_exchange_strong(expected, Calculating, std::memory_order_acquire)) {
+                    calculate(value);
+                    state.store(Ready, std::memory_order_release);
+                } else {
+                    while (state.load(std::memory_order_acquire) != Ready) {
+                        std::this_thread::yield();
+                    }
+                }
+            }
+            return value;
+        }
+    };
+
+#ifndef RUCKIG_HARD_REALTIME
     template<class Vector>
     std::string join(const Vector& array) {
         std::ostringstream ss;
@@ -16,5 +300,6 @@ namespace ruckig {
         }
         return ss.str();
     }
+#endif
 
 } // namespace ruckig
@@ -15,8 +15,8 @@ class VelocityStep1 {
     double vf, af;
     double _aMax, _aMin, _jMax;
 
-    // Max 3 valid profiles
-    std::array<Profile, 3> valid_profiles;
+    // Candidate pool of the block of the current get_profile call
+    Profile* valid_profiles;
     size_t valid_profile_counter;
 
     void time_acc0(Profile& profile, double aMax, double aMin, double jMax);
@@ -32,7 +32,8 @@ class VelocityStep1 {
 public:
     explicit VelocityStep1(double p0, double v0, double a0, double vf, double af, double aMax, double aMin, double jMax);
 
-    bool get_profile(const Profile& input, Block& block);
+    //! Calculate the time-optimal profile and the blocked intervals, or only the time-optimal profile if minimum_duration_only is set
+    bool get_profile(const Profile& input, Block& block, bool minimum_duration_only = false);
 };
 
 
@@ -0,0 +1,337 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <limits>
+#include <optional>
+#include <tuple>
+#include <type_traits>
+
+#ifndef RUCKIG_HARD_REALTIME
+    #include <stdexcept>
+    #include <string>
+#endif
+
+#include <ruckig/block.hpp>
+#include <ruckig/brake.hpp>
+#include <ruckig/input_parameter.hpp>
+#include <ruckig/profile.hpp>
+#include <ruckig/velocity.hpp>
+
+
+namespace ruckig {
+
+//! Output type of VelocityRuckig, with the current state only (the profiles are kept by the generator)
+template<size_t DOFs, size_t MaxDOFs = 0>
+class VelocityOutputParameter {
+    template<class T> using Vector = DOFsVector<T, DOFs, MaxDOFs>;
+
+public:
+    size_t degrees_of_freedom;
+
+    // Current kinematic state
+    Vector<double> new_position, new_velocity, new_acceleration;
+
+    //! Current time on trajectory
+    double time {0.0};
+
+    //! Was a new trajectory calculation performed in the last cycle?
+    bool new_calculation {false};
+
+    //! Computational duration of the last update call
+    double calculation_duration {0.0}; // [µs]
+
+    template <size_t D = DOFs, typename std::enable_if<D >= 1, int>::type = 0>
+    VelocityOutputParameter(): degrees_of_freedom(DOFs) { }
+
+    template <size_t D = DOFs, typename std::enable_if<D == 0, int>::type = 0>
+    VelocityOutputParameter(size_t dofs): degrees_of_freedom(dofs) {
+        new_position.resize(dofs);
+        new_velocity.resize(dofs);
+        new_acceleration.resize(dofs);
+    }
+
+    void pass_to_input(InputParameter<DOFs, MaxDOFs>& input) const {
+        input.current_position = new_position;
+        input.current_velocity = new_velocity;
+        input.current_acceleration = new_acceleration;
+    }
+};
+
+
+//! Online trajectory generator for the velocity interface only, e.g. for conveyors, spindles, or jogging
+
+//! It is built directly on the velocity brake, VelocityStep1, and VelocityStep2, without the position interface, the
+//! interruptible calculation stages, the extrema, waypoints, or the instrumentation of Ruckig. The control_interface
+//! and target_position of the input are ignored, and the trajectory is kept within the generator instead of the
+//! output, so that its state is much smaller. Time synchronization finds the earliest duration that is not blocked
+//! for any DoF from the interval boundaries directly. Synchronization::Phase is calculated as time synchronization,
+//! as phase synchronization is only defined for the position interface.
+template<size_t DOFs, bool throw_error = false, size_t MaxDOFs = 0>
+class VelocityRuckig {
+    template<class T> using Vector = DOFsVector<T, DOFs, MaxDOFs>;
+
+    constexpr static double eps {std::numeric_limits<double>::epsilon()};
+
+    Vector<Profile> profiles;
+    Vector<Block> blocks;
+    Vector<size_t> segments; // Current segment of each profile for sampling at ascending times
+    Vector<double> p0s, v0s, a0s, min_accelerations; // State after the brake trajectory
+    Vector<Synchronization> synchronizations;
+    double duration {0.0};
+
+    InputParameter<DOFs, MaxDOFs> current_input;
+    bool current_input_initialized {false};
+
+    void state_at_time(size_t dof, double time, double& new_position, double& new_velocity, double& new_acceleration) {
+        const Profile& p = profiles[dof];
+        double t_diff = time;
+        if (p.brake.duration > 0) {
+            if (t_diff < p.brake.duration) {
+                const size_t index = (t_diff < p.brake.t[0]) ? 0 : 1;
+                if (index > 0) {
+                    t_diff -= p.brake.t[0];
+                }
+                std::tie(new_position, new_velocity, new_acceleration) = Profile::integrate(t_diff, p.brake.p[index], p.brake.v[index], p.brake.a[index], p.brake.j[index]);
+                return;
+            }
+            t_diff -= p.brake.duration;
+        }
+
+        if (t_diff >= p.t_sum[6]) {
+            // Keep constant acceleration
+            std::tie(new_position, new_velocity, new_acceleration) = Profile::integrate(t_diff - p.t_sum[6], p.pf, p.vf, p.af, 0);
+            return;
+        }
+
+        size_t& segment = segments[dof];
+        if (segment > 0 && t_diff < p.t_sum[segment - 1]) {
+            segment = 0;
+        }
+        while (p.t_sum[segment] <= t_diff) {
+            ++segment;
+        }
+        if (segment > 0) {
+            t_diff -= p.t_sum[segment - 1];
+        }
+        std::tie(new_position, new_velocity, new_acceleration) = Profile::integrate(t_diff, p.p[segment], p.v[segment], p.a[segment], p.j[segment]);
+    }
+
+    Result fail(Result result, [[maybe_unused]] const char* message, [[maybe_unused]] size_t dof) {
+#ifndef RUCKIG_HARD_REALTIME
+        if constexpr (throw_error) {
+            throw std::runtime_error(std::string("[ruckig] ") + message + ", dof: " + std::to_string(dof));
+        }
+#endif
+        return result;
+    }
+
+public:
+    size_t degrees_of_freedom;
+
+    //! Time step between updates (cycle time) in [s]
+    const double delta_time;
+
+    template <size_t D = DOFs, typename std::enable_if<D >= 1, int>::type = 0>
+    explicit VelocityRuckig(double delta_time): degrees_of_freedom(DOFs), delta_time(delta_time) { }
+
+    template <size_t D = DOFs, typename std::enable_if<D == 0, int>::type = 0>
+    explicit VelocityRuckig(size_t dofs, double delta_time): current_input(InputParameter<0, MaxDOFs>(dofs)), degrees_of_freedom(dofs), delta_time(delta_time) {
+        profiles.resize(dofs);
+        blocks.resize(dofs);
+        segments.resize(dofs);
+        p0s.resize(dofs);
+        v0s.resize(dofs);
+        a0s.resize(dofs);
+        min_accelerations.resize(dofs);
+        synchronizations.resize(dofs);
+    }
+
+    //! Validate the input for the velocity interface
+    bool validate_input(const InputParameter<DOFs, MaxDOFs>& input) const {
+        if (input.per_dof_control_interface || input.synchronization_groups || !input.intermediate_positions.empty()) {
+            return false;
+        }
+
+        for (size_t dof = 0; dof < degrees_of_freedom; ++dof) {
+            const double max_acceleration = input.max_acceleration[dof];
+            const double min_acceleration = input.min_acceleration ? input.min_acceleration.value()[dof] : -max_acceleration;
+            if (std::isnan(max_acceleration) || max_acceleration <= std::numeric_limits<double>::min() || !(min_acceleration < -std::numeric_limits<double>::min())) {
+                return false;
+            }
+            if (std::isnan(input.max_jerk[dof]) || input.max_jerk[dof] <= std::numeric_limits<double>::min()) {
+                return false;
+            }
+            if (!(input.target_acceleration[dof] <= max_acceleration && input.target_acceleration[dof] >= min_acceleration)) {
+                return false;
+            }
+            if (!std::isfinite(input.current_position[dof]) || !std::isfinite(input.current_velocity[dof]) || !std::isfinite(input.current_acceleration[dof]) || !std::isfinite(input.target_velocity[dof])) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    //! Calculate a new trajectory for the given input
+    Result calculate(const InputParameter<DOFs, MaxDOFs>& input) {
+        if (!validate_input(input)) {
+            return fail(Result::ErrorInvalidInput, "invalid input for the velocity interface", 0);
+        }
+
+        const bool discrete_duration = (input.duration_discretization == DurationDiscretization::Discrete);
+        duration = input.minimum_duration.value_or(0.0);
+        for (size_t dof = 0; dof < degrees_of_freedom; ++dof) {
+            Profile& p = profiles[dof];
+            segments[dof] = 0;
+            if (!input.enabled[dof]) {
+                p.brake.duration = 0.0;
+                p.pf = input.current_position[dof];
+                p.vf = input.current_velocity[dof];
+                p.af = input.current_acceleration[dof];
+                p.t_sum[6] = 0.0;
+                continue;
+            }
+
+            synchronizations[dof] = input.per_dof_synchronization ? input.per_dof_synchronization.value()[dof] : input.synchronization;
+            if (synchronizations[dof] == Synchronization::TimeIfNecessary && std::abs(input.target_velocity[dof]) < eps && std::abs(input.target_acceleration[dof]) < eps) {
+                synchronizations[dof] = Synchronization::None;
+            }
+            const bool minimum_duration_only = (synchronizations[dof] == Synchronization::None) || (degrees_of_freedom == 1 && !input.minimum_duration && !discrete_duration);
+
+            min_accelerations[dof] = input.min_acceleration ? input.min_acceleration.value()[dof] : -input.max_acceleration[dof];
+            BrakeProfile::get_velocity_brake_trajectory(input.current_acceleration[dof], input.max_acceleration[dof], min_accelerations[dof], input.max_jerk[dof], p.brake.t, p.brake.j);
+            p.brake.duration = p.brake.t[0] + p.brake.t[1];
+            p0s[dof] = input.current_position[dof];
+            v0s[dof] = input.current_velocity[dof];
+            a0s[dof] = input.current_acceleration[dof];
+            for (size_t i = 0; i < 2 && p.brake.t[i] > 0; ++i) {
+                p.brake.p[i] = p0s[dof];
+                p.brake.v[i] = v0s[dof];
+                p.brake.a[i] = a0s[dof];
+                std::tie(p0s[dof], v0s[dof], a0s[dof]) = Profile::integrate(p.brake.t[i], p0s[dof], v0s[dof], a0s[dof], p.brake.j[i]);
+            }
+
+            VelocityStep1 step1 {p0s[dof], v0s[dof], a0s[dof], input.target_velocity[dof], input.target_acceleration[dof], input.max_acceleration[dof], min_accelerations[dof], input.max_jerk[dof]};
+            if (!step1.get_profile(p, blocks[dof], minimum_duration_only)) {
+                return fail(Result::ErrorExecutionTimeCalculation, "error in step 1", dof);
+            }
+            duration = std::max(duration, blocks[dof].t_min);
+        }
+
+        const auto is_feasible = [&](double t) {
+            for (size_t dof = 0; dof < degrees_of_freedom; ++dof) {
+                if (input.enabled[dof] && blocks[dof].is_blocked(t)) {
+                    return false;
+                }
+            }
+            return true;
+        };
+        const auto round = [&](double t) {
+            if (!discrete_duration) {
+                return t;
+            }
+
+            double steps = std::ceil(t / delta_time);
+            if (steps * delta_time < t) {
+                steps += 1;
+            }
+            return steps * delta_time;
+        };
+
+        // The earliest duration that is not blocked for any DoF, from at most two interval boundaries per DoF. DoFs
+        // without synchronization only have a minimum duration, as their blocks are calculated without intervals.
+        duration = round(duration);
+        if (!is_feasible(duration)) {
+            double t_sync {std::numeric_limits<double>::infinity()};
+            for (size_t dof = 0; dof < degrees_of_freedom; ++dof) {
+                if (!input.enabled[dof]) {
+                    continue;
+                }
+
+                for (const auto& [interval, has_interval]: {std::make_pair(&blocks[dof].a, blocks[dof].has_a), std::make_pair(&blocks[dof].b, blocks[dof].has_b)}) {
+                    const double candidate = has_interval ? round(interval->right) : t_sync;
+                    if (candidate >= duration && candidate < t_sync && is_feasible(candidate)) {
+                        t_sync = candidate;
+                    }
+                }
+            }
+            if (!(t_sync < std::numeric_limits<double>::infinity())) {
+                return fail(Result::ErrorSynchronizationCalculation, "error in time synchronization", 0);
+            }
+            duration = t_sync;
+        }
+
+        for (size_t dof = 0; dof < degrees_of_freedom; ++dof) {
+            if (!input.enabled[dof]) {
+                continue;
+            }
+
+            Profile& p = profiles[dof];
+            if (synchronizations[dof] == Synchronization::None || std::abs(duration - blocks[dof].t_min) < eps) {
+                p = blocks[dof].get_min_profile();
+                continue;
+            } else if (blocks[dof].has_a && std::abs(duration - blocks[dof].a.right) < eps) {
+                p = blocks[dof].get_profile(blocks[dof].a);
+                continue;
+            } else if (blocks[dof].has_b && std::abs(duration - blocks[dof].b.right) < eps) {
+                p = blocks[dof].get_profile(blocks[dof].b);
+                continue;
+            }
+
+            // The profile still holds the brake trajectory of Step 1
+            VelocityStep2 step2 {duration - p.brake.duration, p0s[dof], v0s[dof], a0s[dof], input.target_velocity[dof], input.target_acceleration[dof], input.max_acceleration[dof], min_accelerations[dof], input.max_jerk[dof]};
+            if (!step2.get_profile(p)) {
+                return fail(Result::ErrorSynchronizationCalculation, "error in step 2", dof);
+            }
+        }
+        return Result::Working;
+    }
+
+    //! Get the next output state (and calculate a new trajectory if the input has changed)
+    Result update(const InputParameter<DOFs, MaxDOFs>& input, VelocityOutputParameter<DOFs, MaxDOFs>& output) {
+        const auto start = std::chrono::steady_clock::now();
+
+        output.new_calculation = false;
+        if (!current_input_initialized || input.has_changed(current_input)) {
+            const Result result = calculate(input);
+            if (result != Result::Working) {
+                return result;
+            }
+
+            current_input = input;
+            current_input_initialized = true;
+            output.time = 0.0;
+            output.new_calculation = true;
+        }
+
+        output.time += delta_time;
+        at_time(output.time, output.new_position, output.new_velocity, output.new_acceleration);
+
+        const auto stop = std::chrono::steady_clock::now();
+        output.calculation_duration = std::chrono::duration_cast<std::chrono::nanoseconds>(stop - start).count() / 1000.0;
+
+        output.pass_to_input(current_input);
+        return (output.time > duration) ? Result::Finished : Result::Working;
+    }
+
+    //! Get the kinematic state at a given time, continuing the segment search for ascending times
+    void at_time(double time, Vector<double>& new_position, Vector<double>& new_velocity, Vector<double>& new_acceleration) {
+        for (size_t dof = 0; dof < degrees_of_freedom; ++dof) {
+            state_at_time(dof, time, new_position[dof], new_velocity[dof], new_acceleration[dof]);
+        }
+    }
+
+    //! Get the duration of the (synchronized) trajectory
+    double get_duration() const {
+        return duration;
+    }
+
+    //! Get the profile of a DoF, e.g. to inspect its phases
+    const Profile& get_profile(size_t dof) const {
+        return profiles[dof];
+    }
+};
+
+} // namespace ruckig
@@ -0,0 +1,161 @@
+#pragma once
+
+#include <utility>
+#include <vector>
+
+#include <ruckig/ruckig.hpp>
+
+
+namespace ruckig {
+
+//! Online planner for a stream of waypoints through a bounded lookahead window, e.g. for long CAM paths
+
+//! Waypoints are pushed into a ring buffer of a fixed capacity and consumed when they are reached. Only the section
+//! towards the next waypoint is calculated, with the pass velocity of WaypointTrajectory from its neighboring positions.
+//! The last waypoint of the window is always targeted with zero velocity, so that the motion stops safely there if no
+//! further waypoints arrive in time. Pushing a waypoint behind it recalculates the running section from the current
+//! state (braking first if necessary), so that it can pass without stopping. A cycle calculates at most one section
+//! (two if a waypoint is pushed just as the running section ends), and neither memory nor the cost of a cycle depend on
+//! the length of the path.
+template<size_t DOFs, size_t MaxDOFs = 0>
+class WaypointStream {
+    template<class T> using Vector = DOFsVector<T, DOFs, MaxDOFs>;
+
+    Ruckig<DOFs, false, true, MaxDOFs> otg;
+    InputParameter<DOFs, MaxDOFs> section_input;
+
+    std::vector<Vector<double>> window; // Ring buffer with a fixed capacity
+    size_t head {0}, count {0};
+
+    Vector<double> previous_position; // Last reached waypoint, or the position at the start
+    bool needs_calculation {false};
+    bool initialized {false};
+
+    const Vector<double>& waypoint(size_t i) const {
+        return window[(head + i) % window.size()];
+    }
+
+    void pop() {
+        head = (head + 1) % window.size();
+        --count;
+    }
+
+    //! Calculate the section from the current state towards the first waypoint of the window
+    Result calculate_section(OutputParameter<DOFs, MaxDOFs>& output) {
+        section_input = input; // Current state and limits, without reallocations
+
+        const Vector<double>& target = waypoint(0);
+        for (size_t dof = 0; dof < input.degrees_of_freedom; ++dof) {
+            section_input.target_position[dof] = target[dof];
+            section_input.target_velocity[dof] = (count > 1) ? WaypointTrajectory<DOFs, MaxDOFs>::pass_velocity(input, dof, target[dof] - previous_position[dof], waypoint(1)[dof] - target[dof]) : 0.0;
+            section_input.target_acceleration[dof] = 0.0;
+        }
+
+        const Result result = otg.calculate(section_input, output.trajectory);
+        if (result != Result::Working) {
+            return result;
+        }
+
+        needs_calculation = false;
+        output.time = 0.0;
+        output.cursor.reset();
+        output.new_calculation = true;
+        return Result::Working;
+    }
+
+public:
+    //! Current state (updated by update) and the kinematic limits, the target and intermediate positions are ignored
+    InputParameter<DOFs, MaxDOFs> input;
+
+    //! Number of waypoints reached so far
+    size_t reached_waypoints {0};
+
+    template <size_t D = DOFs, typename std::enable_if<D >= 1, int>::type = 0>
+    explicit WaypointStream(double delta_time, size_t capacity): otg(delta_time), window(capacity) { }
+
+    template <size_t D = DOFs, typename std::enable_if<D == 0, int>::type = 0>
+    explicit WaypointStream(size_t dofs, double delta_time, size_t capacity): otg(dofs, delta_time), section_input(dofs), window(capacity, Vector<double>(dofs)), previous_position(dofs), input(dofs) { }
+
+    //! Maximal number of waypoints in the lookahead window
+    size_t capacity() const {
+        return window.size();
+    }
+
+    //! Number of waypoints in the window, including the one that is currently approached
+    size_t size() const {
+        return count;
+    }
+
+    //! Append a waypoint to the window, returns false if it is full
+    bool push(const Vector<double>& position) {
+        if (count == window.size()) {
+            return false;
+        }
+
+        // The last waypoint so far was approached with zero velocity, otherwise the running section is unaffected
+        if (count <= 1) {
+            needs_calculation = true;
+        }
+
+        window[(head + count) % window.size()] = position;
+        ++count;
+        return true;
+    }
+
+    //! Get the next output state along the stream, Finished means that the motion stopped at the last waypoint
+    Result update(OutputParameter<DOFs, MaxDOFs>& output) {
+        output.new_calculation = false;
+        output.did_section_change = false;
+
+        if (!initialized) {
+            previous_position = input.current_position;
+            initialized = true;
+        }
+
+        if (count == 0) {
+            output.new_position = input.current_position;
+            output.new_velocity = input.current_velocity;
+            output.new_acceleration = input.current_acceleration;
+            return Result::Finished;
+        }
+
+        if (needs_calculation) {
+            const Result result = calculate_section(output);
+            if (result != Result::Working) {
+                return result;
+            }
+        }
+
+        output.time += otg.delta_time;
+
+        // Continue with the next section from the state at the reached waypoint
+        if (output.time > output.trajectory.get_duration()) {
+            const double remaining_time = output.time - output.trajectory.get_duration();
+            previous_position = waypoint(0);
+            pop();
+            ++reached_waypoints;
+            output.did_section_change = true;
+
+            if (count > 0) {
+                output.trajectory.at_time(output.trajectory.get_duration(), input.current_position, input.current_velocity, input.current_acceleration);
+                const Result result = calculate_section(output);
+                if (result != Result::Working) {
+                    return result;
+                }
+                output.time = remaining_time;
+            }
+        }
+
+        size_t section;
+        output.trajectory.at_time(output.time, output.new_position, output.new_velocity, output.new_acceleration, section, output.cursor);
+        output.new_section = reached_waypoints;
+        output.pass_to_input(input);
+
+        if (count == 0) {
+            return Result::Finished;
+        }
+        return Result::Working;
+    }
+};
+
+} // namespace ruckig
@@ -0,0 +1,195 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <utility>
+#include <vector>
+
+#include <ruckig/input_parameter.hpp>
+#include <ruckig/trajectory.hpp>
+#include <ruckig/worker_pool.hpp>
+
+
+namespace ruckig {
+
+//! Trajectory through the intermediate positions of an input, as a chain of state-to-state sections
+
+//! Each section ends at a waypoint (the last one at the target state) and is calculated like a trajectory without
+//! waypoints. The velocity at a waypoint is chosen from its neighboring positions only: it is zero if a DoF reverses
+//! its direction there, and otherwise the highest velocity from which the DoF could still stop within half of the
+//! shorter adjacent distance. Therefore, a section depends only on the previous sections, and the calculation can be
+//! pipelined: the first sections are calculated right away so that the motion can start, and the following ones while
+//! the earlier sections are executed. The queries cover the calculated sections.
+template<size_t DOFs, size_t MaxDOFs = 0>
+class WaypointTrajectory {
+    template<class T> using Vector = DOFsVector<T, DOFs, MaxDOFs>;
+
+    InputParameter<DOFs, MaxDOFs> input; // Including all waypoints
+    InputParameter<DOFs, MaxDOFs> section_input;
+
+    std::vector<Trajectory<DOFs, MaxDOFs>> sections; // Only the first number_sections are used, to reuse their memory
+    std::vector<double> cumulative_durations;
+    size_t number_sections {0};
+    size_t number_calculated_sections {0};
+
+    //! Set the section input from the end of the previous section towards the next waypoint
+    void set_section_input(size_t section) {
+        if (section == 0) {
+            section_input.current_position = input.current_position;
+            section_input.current_velocity = input.current_velocity;
+            section_input.current_acceleration = input.current_acceleration;
+        } else {
+            const auto& previous = sections[section - 1];
+            previous.at_time(previous.get_duration(), section_input.current_position, section_input.current_velocity, section_input.current_acceleration);
+        }
+
+        if (section + 1 == number_sections) {
+            section_input.target_position = input.target_position;
+            section_input.target_velocity = input.target_velocity;
+            section_input.target_acceleration = input.target_acceleration;
+            return;
+        }
+
+        const auto& waypoints = std::as_const(input.intermediate_positions);
+        const auto& waypoint = waypoints[section];
+        const auto& previous_position = (section == 0) ? input.current_position : waypoints[section - 1];
+        const auto& next_position = (section + 2 == number_sections) ? input.target_position : waypoints[section + 1];
+        for (size_t dof = 0; dof < degrees_of_freedom; ++dof) {
+            const double distance_in = waypoint[dof] - previous_position[dof];
+            const double distance_out = next_position[dof] - waypoint[dof];
+
+            section_input.target_position[dof] = waypoint[dof];
+            section_input.target_velocity[dof] = pass_velocity(input, dof, distance_in, distance_out);
+            section_input.target_acceleration[dof] = 0.0;
+        }
+    }
+
+public:
+    size_t degrees_of_freedom;
+
+    //! Highest velocity from which a DoF can stop within the distance, starting without acceleration
+    static double max_pass_velocity(double distance, double max_velocity, double max_acceleration, double max_jerk) {
+        // Velocity up to which braking does not reach the acceleration limit, with a stopping distance of v * sqrt(v / j)
+        const double v_acc = max_acceleration * max_acceleration / max_jerk;
+        double velocity = std::cbrt(distance * distance * max_jerk);
+        if (velocity > v_acc) {
+            // Stopping distance of v^2 / (2 a) + v a / (2 j)
+            velocity = (-v_acc + std::sqrt(v_acc * v_acc + 8 * max_acceleration * distance)) / 2;
+        }
+        return std::min(velocity, max_velocity);
+    }
+
+    //! Velocity of a DoF at a waypoint, given the distances from the previous and to the next position
+    static double pass_velocity(const InputParameter<DOFs, MaxDOFs>& input, size_t dof, double distance_in, double distance_out) {
+        if (!input.enabled[dof] || distance_in * distance_out <= 0.0) {
+            return 0.0;
+        }
+
+        const double max_velocity = (distance_out > 0.0 || !input.min_velocity) ? input.max_velocity[dof] : -input.min_velocity.value()[dof];
+        const double max_acceleration = input.min_acceleration ? std::min(input.max_acceleration[dof], -input.min_acceleration.value()[dof]) : input.max_acceleration[dof];
+        const double velocity = max_pass_velocity(std::min(std::abs(distance_in), std::abs(distance_out)) / 2, max_velocity, max_acceleration, input.max_jerk[dof]);
+        return std::copysign(velocity, distance_out);
+    }
+
+    template <size_t D = DOFs, typename std::enable_if<D >= 1, int>::type = 0>
+    WaypointTrajectory(): degrees_of_freedom(DOFs) { }
+
+    template <size_t D = DOFs, typename std::enable_if<D == 0, int>::type = 0>
+    WaypointTrajectory(size_t dofs): input(dofs), section_input(dofs), degrees_of_freedom(dofs) { }
+
+    //! Start a new calculation for the input, and calculate its first sections (all by default)
+    template<bool throw_error, bool return_error_at_maximal_duration, Features features = Features::All>
+    Result calculate(const InputParameter<DOFs, MaxDOFs>& new_input, double delta_time, size_t number_sections_now = std::numeric_limits<size_t>::max(), WorkerPool* pool = nullptr) {
+        input = new_input;
+        section_input = new_input;
+        section_input.intermediate_positions.clear();
+        section_input.interrupt_calculation_duration = std::nullopt;
+
+        number_sections = input.intermediate_positions.size() + 1;
+        number_calculated_sections = 0;
+        cumulative_durations.clear();
+        if (sections.size() < number_sections) {
+            if constexpr (DOFs == 0) {
+                sections.resize(number_sections, Trajectory<0, MaxDOFs>(degrees_of_freedom));
+            } else {
+                sections.resize(number_sections);
+            }
+        }
+
+        return continue_calculation<throw_error, return_error_at_maximal_duration, features>(delta_time, std::max<size_t>(number_sections_now, 1), pool);
+    }
+
+    //! Calculate the given number of following sections
+    template<bool throw_error, bool return_error_at_maximal_duration, Features features = Features::All>
+    Result continue_calculation(double delta_time, size_t number_sections_now = 1, WorkerPool* pool = nullptr) {
+        bool was_interrupted {false};
+        for (; number_sections_now > 0 && number_calculated_sections < number_sections; --number_sections_now) {
+            const size_t section = number_calculated_sections;
+            set_section_input(section);
+
+            const Result result = sections[section].template calculate<throw_error, return_error_at_maximal_duration, false, features>(section_input, delta_time, was_interrupted, nullptr, pool);
+            if (result != Result::Working) {
+                return result;
+            }
+
+            cumulative_durations.push_back(sections[section].get_duration() + (cumulative_durations.empty() ? 0.0 : cumulative_durations.back()));
+            ++number_calculated_sections;
+        }
+        return Result::Working;
+    }
+
+    //! Number of sections, i.e. the number of intermediate positions plus one
+    size_t size() const {
+        return number_sections;
+    }
+
+    //! Number of sections calculated so far
+    size_t calculated_sections() const {
+        return number_calculated_sections;
+    }
+
+    //! Are all sections calculated?
+    bool is_calculated() const {
+        return number_calculated_sections == number_sections;
+    }
+
+    //! Trajectory of a single calculated section, starting at time zero
+    const Trajectory<DOFs, MaxDOFs>& get_section(size_t section) const {
+        return sections[section];
+    }
+
+    //! Get the kinematic state and the current section at a given time
+
+    //! The section equals size() after the duration (if all sections are calculated).
+    void at_time(double time, Vector<double>& new_position, Vector<double>& new_velocity, Vector<double>& new_acceleration, size_t& new_section) const {
+        if (number_calculated_sections == 0) {
+            return;
+        }
+
+        const size_t section = std::min<size_t>(std::upper_bound(cumulative_durations.begin(), cumulative_durations.end(), time) - cumulative_durations.begin(), number_calculated_sections - 1);
+        const double section_time = time - ((section > 0) ? cumulative_durations[section - 1] : 0.0);
+
+        size_t section_part;
+        sections[section].at_time(section_time, new_position, new_velocity, new_acceleration, section_part);
+        new_section = section + ((section + 1 == number_sections) ? section_part : 0);
+    }
+
+    //! Get the kinematic state at a given time
+    void at_time(double time, Vector<double>& new_position, Vector<double>& new_velocity, Vector<double>& new_acceleration) const {
+        size_t new_section;
+        at_time(time, new_position, new_velocity, new_acceleration, new_section);
+    }
+
+    //! Get the duration of the calculated sections
+    double get_duration() const {
+        return cumulative_durations.empty() ? 0.0 : cumulative_durations.back();
+    }
+
+    //! Get the durations when the intermediate positions (and finally the target) are reached, for the calculated sections
+    std::vector<double> get_intermediate_durations() const {
+        return cumulative_durations;
+    }
+};
+
+} // namespace ruckig
@@ -0,0 +1,100 @@
+#pragma once
+
+#include <atomic>
+#include <functional>
+#include <thread>
+#include <vector>
+
+#if defined(__linux__)
+#include <pthread.h>
+#endif
+
+
+namespace ruckig {
+
+//! Preallocated pool of worker threads for splitting the calculation of a trajectory across multiple cores
+
+//! All threads are created (and optionally pinned to CPUs) at construction. Afterwards, run() neither allocates
+//! memory nor locks a mutex: the workers busy-wait for a new task and the calling thread works on the first chunk
+//! itself. A pool must only be used by a single calculation at the same time.
+class WorkerPool {
+    std::vector<std::thread> threads;
+
+    std::atomic<size_t> generation {0}; // Incremented for every new task
+    std::atomic<size_t> remaining {0}; // Number of workers that did not finish the current task yet
+    std::atomic<bool> running {true};
+
+    void (*task)(const void*, size_t) {nullptr};
+    const void* task_context {nullptr};
+
+    static void pause() {
+        std::this_thread::yield();
+    }
+
+    void work(size_t chunk) {
+        size_t seen_generation {0};
+        while (true) {
+            size_t current_generation;
+            while ((current_generation = generation.load(std::memory_order_acquire)) == seen_generation) {
+                if (!running.load(std::memory_order_acquire)) {
+                    return;
+                }
+                pause();
+            }
+
+            seen_generation = current_generation;
+            task(task_context, chunk);
+            remaining.fetch_sub(1, std::memory_order_acq_rel);
+        }
+    }
+
+public:
+    //! Start the given number of worker threads in addition to the calling thread, optionally pinned to the given CPUs (only on Linux)
+    explicit WorkerPool(size_t number_workers, const std::vector<int>& cpus = {}) {
+        threads.reserve(number_workers);
+        for (size_t i = 0; i < number_workers; ++i) {
+            threads.emplace_back(&WorkerPool::work, this, i + 1);
+
+#if defined(__linux__)
+            if (i < cpus.size()) {
+                cpu_set_t cpu_set;
+                CPU_ZERO(&cpu_set);
+                CPU_SET(cpus[i], &cpu_set);
+                pthread_setaffinity_np(threads.back().native_handle(), sizeof(cpu_set_t), &cpu_set);
+            }
+#endif
+        }
+    }
+
+    ~WorkerPool() {
+        running.store(false, std::memory_order_release);
+        for (auto& thread: threads) {
+            thread.join();
+        }
+    }
+
+    WorkerPool(const WorkerPool&) = delete;
+    WorkerPool& operator=(const WorkerPool&) = delete;
+
+    //! Number of threads working on a task, including the calling thread
+    size_t number_threads() const {
+        return threads.size() + 1;
+    }
+
+    //! Call function(chunk) for each chunk in [0, number_threads()) in parallel, and wait until all are finished
+    template<class F>
+    void run(const F& function) {
+        task = [](const void* context, size_t chunk) { (*static_cast<const F*>(context))(chunk); };
+        task_context = &function;
+        remaining.store(threads.size(), std::memory_order_relaxed);
+        generation.fetch_add(1, std::memory_order_release);
+
+        function(0);
+
+        while (remaining.load(std::memory_order_acquire) > 0) {
+            pause();
+        }
+    }
+};
+
+} // namespace ruckig
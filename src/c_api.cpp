@@ -0,0 +1,171 @@
+// C interface for bindings via FFI, see include/ruckig/ruckig_c.h
+#include <algorithm>
+#include <new>
+#include <vector>
+
+#include <ruckig/ruckig.hpp>
+#include <ruckig/ruckig_c.h>
+
+
+using namespace ruckig;
+
+
+struct RuckigGenerator {
+    Ruckig<DynamicDOFs> otg;
+    InputParameter<DynamicDOFs> input;
+    OutputParameter<DynamicDOFs> output;
+
+    std::vector<InputParameter<DynamicDOFs>> inputs;
+    std::vector<Result> results;
+
+    explicit RuckigGenerator(size_t dofs, double delta_time): otg(dofs, delta_time), input(dofs), output(dofs) { }
+};
+
+struct RuckigTrajectories {
+    size_t degrees_of_freedom;
+    std::vector<Trajectory<DynamicDOFs>> trajectories;
+
+    explicit RuckigTrajectories(size_t dofs): degrees_of_freedom(dofs) { }
+};
+
+
+namespace {
+
+void copy_or_fill(const double* values, size_t offset, std::vector<double>& vector, double fill) {
+    if (values) {
+        std::copy_n(values + offset, vector.size(), vector.begin());
+    } else {
+        std::fill(vector.begin(), vector.end(), fill);
+    }
+}
+
+void copy_optional(const double* values, size_t offset, std::optional<std::vector<double>>& optional, size_t dofs) {
+    if (!values) {
+        optional.reset();
+        return;
+    }
+    if (!optional) {
+        optional.emplace(dofs);
+    }
+    std::copy_n(values + offset, dofs, optional->begin());
+}
+
+//! Copy the input with the given index from the flat arrays, reusing the memory of the parameter
+void assign(const RuckigInputArrays& arrays, size_t index, InputParameter<DynamicDOFs>& input) {
+    const size_t dofs = input.degrees_of_freedom;
+    const size_t state = index * dofs;
+    const size_t limits = index * arrays.limits_stride;
+
+    input.control_interface = (arrays.control_interface == RUCKIG_CONTROL_VELOCITY) ? ControlInterface::Velocity : ControlInterface::Position;
+    copy_or_fill(arrays.current_position, state, input.current_position, 0.0);
+    copy_or_fill(arrays.current_velocity, state, input.current_velocity, 0.0);
+    copy_or_fill(arrays.current_acceleration, state, input.current_acceleration, 0.0);
+    copy_or_fill(arrays.target_position, state, input.target_position, 0.0);
+    copy_or_fill(arrays.target_velocity, state, input.target_velocity, 0.0);
+    copy_or_fill(arrays.target_acceleration, state, input.target_acceleration, 0.0);
+    copy_or_fill(arrays.max_velocity, limits, input.max_velocity, 0.0);
+    copy_or_fill(arrays.max_acceleration, limits, input.max_acceleration, 0.0);
+    copy_or_fill(arrays.max_jerk, limits, input.max_jerk, 0.0);
+    copy_optional(arrays.min_velocity, limits, input.min_velocity, dofs);
+    copy_optional(arrays.min_acceleration, limits, input.min_acceleration, dofs);
+}
+
+} // namespace
+
+
+// No exception may pass the C interface, so that the calls fail with an error result instead
+
+RuckigGenerator* ruckig_create(size_t degrees_of_freedom, double delta_time) {
+    if (degrees_of_freedom == 0) {
+        return nullptr;
+    }
+    try {
+        return new RuckigGenerator(degrees_of_freedom, delta_time);
+    } catch (...) {
+        return nullptr;
+    }
+}
+
+void ruckig_destroy(RuckigGenerator* generator) {
+    delete generator;
+}
+
+size_t ruckig_degrees_of_freedom(const RuckigGenerator* generator) {
+    return generator ? generator->otg.degrees_of_freedom : 0;
+}
+
+int ruckig_update(RuckigGenerator* generator, const RuckigInputArrays* input, double* new_position, double* new_velocity, double* new_acceleration) {
+    if (!generator || !input || !new_position || !new_velocity || !new_acceleration) {
+        return RUCKIG_ERROR_INVALID_INPUT;
+    }
+
+    try {
+        assign(*input, 0, generator->input);
+        const Result result = generator->otg.update(generator->input, generator->output);
+        std::copy(generator->output.new_position.begin(), generator->output.new_position.end(), new_position);
+        std::copy(generator->output.new_velocity.begin(), generator->output.new_velocity.end(), new_velocity);
+        std::copy(generator->output.new_acceleration.begin(), generator->output.new_acceleration.end(), new_acceleration);
+        return result;
+    } catch (...) {
+        return RUCKIG_ERROR;
+    }
+}
+
+RuckigTrajectories* ruckig_trajectories_create(const RuckigGenerator* generator) {
+    if (!generator) {
+        return nullptr;
+    }
+    try {
+        return new RuckigTrajectories(generator->otg.degrees_of_freedom);
+    } catch (...) {
+        return nullptr;
+    }
+}
+
+void ruckig_trajectories_destroy(RuckigTrajectories* trajectories) {
+    delete trajectories;
+}
+
+size_t ruckig_trajectories_size(const RuckigTrajectories* trajectories) {
+    return trajectories ? trajectories->trajectories.size() : 0;
+}
+
+void ruckig_calculate_batch(RuckigGenerator* generator, const RuckigInputArrays* inputs, size_t number_inputs, RuckigTrajectories* trajectories, int* results, double* durations, size_t number_threads) {
+    if (!results) {
+        return;
+    }
+    if (!generator || !inputs || !trajectories || trajectories->degrees_of_freedom != generator->otg.degrees_of_freedom) {
+        std::fill_n(results, number_inputs, RUCKIG_ERROR_INVALID_INPUT);
+        return;
+    }
+
+    try {
+        const size_t dofs = generator->otg.degrees_of_freedom;
+        generator->inputs.resize(number_inputs, InputParameter<DynamicDOFs>(dofs));
+        for (size_t i = 0; i < number_inputs; ++i) {
+            assign(*inputs, i, generator->inputs[i]);
+        }
+
+        generator->otg.calculate_batch(generator->inputs, trajectories->trajectories, generator->results, number_threads);
+        for (size_t i = 0; i < number_inputs; ++i) {
+            results[i] = generator->results[i];
+            if (durations) {
+                durations[i] = trajectories->trajectories[i].get_duration();
+            }
+        }
+    } catch (...) {
+        std::fill_n(results, number_inputs, RUCKIG_ERROR);
+    }
+}
+
+void ruckig_sample_batch(const RuckigTrajectories* trajectories, const double* times, size_t number_times, double* new_positions, double* new_velocities, double* new_accelerations) {
+    if (!trajectories || !times || !new_positions || !new_velocities || !new_accelerations) {
+        return;
+    }
+
+    const size_t stride = number_times * trajectories->degrees_of_freedom;
+    for (size_t k = 0; k < trajectories->trajectories.size(); ++k) {
+        const size_t offset = k * stride;
+        trajectories->trajectories[k].at_times(times, number_times, new_positions + offset, new_velocities + offset, new_accelerations + offset);
+    }
+}
@@ -0,0 +1,28 @@
+// Precompiled instantiations of the main templates, see RUCKIG_INSTANTIATED_DOFS in CMakeLists.txt
+#include <ruckig/ruckig.hpp>
+
+
+namespace ruckig {
+
+#define RUCKIG_INSTANTIATE(D) \
+    template class ExecutableTrajectory<D>; \
+    template class Trajectory<D>; \
+    template class InputParameter<D>; \
+    template class OutputParameter<D>; \
+    template class Ruckig<D>; \
+    RUCKIG_INSTANTIATE_THROWING(D)
+
+#ifdef RUCKIG_HARD_REALTIME
+    #define RUCKIG_INSTANTIATE_THROWING(D)
+#else
+    #define RUCKIG_INSTANTIATE_THROWING(D) template class Ruckig<D, true>;
+#endif
+
+RUCKIG_FOR_EACH_INSTANTIATED_DOFS(RUCKIG_INSTANTIATE)
+
+// The dynamic DoFs check the vector sizes with exceptions
+#if RUCKIG_INSTANTIATED_DYNAMIC_DOFS && !defined(RUCKIG_HARD_REALTIME)
+RUCKIG_INSTANTIATE(0)
+#endif
+
+} // namespace ruckig
@@ -4,23 +4,9 @@
 
 namespace ruckig {
 
-PositionStep1::PositionStep1(double p0, double v0, double a0, double pf, double vf, double af, double vMax, double vMin, double aMax, double aMin, double jMax): p0(p0), v0(v0), a0(a0), pf(pf), vf(vf), af(af), _vMax(vMax), _vMin(vMin), _aMax(aMax), _aMin(aMin), _jMax(jMax) {
-    pd = pf - p0;
+PositionStep1::PositionStep1(double p0, double v0, double a0, double pf, double vf, double af, double vMax, double vMin, double aMax, double aMin, double jMax): PositionStep1(PositionExpressions(p0, v0, a0, pf, vf, af, jMax), vMax, vMin, aMax, aMin, jMax) { }
 
-    v0_v0 = v0 * v0;
-    vf_vf = vf * vf;
-
-    a0_a0 = a0 * a0;
-    af_af = af * af;
-
-    a0_p3 = a0 * a0_a0;
-    a0_p4 = a0_a0 * a0_a0;
-    af_p3 = af * af_af;
-    af_p4 = af_af * af_af;
-
-    // max values needs to be invariant to plus minus sign change
-    jMax_jMax = jMax * jMax;
-}
+PositionStep1::PositionStep1(const PositionExpressions& expr, double vMax, double vMin, double aMax, double aMin, double jMax): p0(expr.p0), v0(expr.v0), a0(expr.a0), pf(expr.pf), vf(expr.vf), af(expr.af), _vMax(vMax), _vMin(vMin), _aMax(aMax), _aMin(aMin), _jMax(jMax), pd(expr.pd), v0_v0(expr.v0_v0), vf_vf(expr.vf_vf), a0_a0(expr.a0_a0), a0_p3(expr.a0_p3), a0_p4(expr.a0_p4), af_af(expr.af_af), af_p3(expr.af_p3), af_p4(expr.af_p4), jMax_jMax(expr.jMax_jMax) { }
 
 void PositionStep1::time_all_vel(Profile& profile, double vMax, double vMin, double aMax, double aMin, double jMax) {
     // ACC0_ACC1_VEL
@@ -474,10 +460,51 @@ void PositionStep1::time_none_two_step(Profile& profile, double vMax, double vMi
 }
 
 
-bool PositionStep1::get_profile(const Profile& input, Block& block) {
+Profile::Limits PositionStep1::predict_limits_to_rest(double vMax, double aMax, double aMin, double jMax) const {
+    // Approximation in the direction of the profile, assuming symmetric acceleration phases
+    const double s = (jMax > 0) ? 1.0 : -1.0;
+    const double v = s * v0, a = s * a0, d = s * pd;
+    const double vUp = s * vMax, aUp = s * aMax, aDown = -s * aMin, j = std::abs(jMax);
+
+    // Velocity after the current acceleration is ramped down to zero
+    const double v_start = v + a * std::abs(a) / (2 * j);
+
+    // Distance to change between two velocities at rest acceleration
+    auto distance = [j](double v_from, double v_to, double acc) {
+        const double dv = std::abs(v_to - v_from);
+        const double t = (dv * j >= acc * acc) ? dv / acc + acc / j : 2 * std::sqrt(dv / j);
+        return (v_from + v_to) / 2 * t;
+    };
+    auto distance_via = [&](double v_peak) {
+        return distance(v_start, v_peak, aUp) + distance(v_peak, 0.0, aDown);
+    };
+
+    if (d >= distance_via(vUp)) {
+        return Profile::Limits::VEL;
+    }
+
+    const double v_peak_acc0 = v_start + aUp * aUp / j;
+    const double v_peak_acc1 = std::max(v_start, aDown * aDown / j);
+    const bool reaches_acc0 = (v_peak_acc0 < vUp) && d >= distance_via(v_peak_acc0);
+    const bool reaches_acc1 = (v_peak_acc1 < vUp) && d >= distance_via(v_peak_acc1);
+
+    if (reaches_acc0 && reaches_acc1) {
+        return Profile::Limits::ACC0_ACC1;
+    } else if (reaches_acc0) {
+        return Profile::Limits::ACC0;
+    } else if (reaches_acc1) {
+        return Profile::Limits::ACC1;
+    }
+    return Profile::Limits::NONE;
+}
+
+bool PositionStep1::get_profile(const Profile& input, Block& block, bool minimum_duration_only) {
     Profile profile = input;
     profile.set_boundary(p0, v0, a0, pf, vf, af);
+    valid_profiles = block.profiles.data();
     valid_profile_counter = 0;
+    number_evaluated_cases = 0;
+    used_two_step_fallback = false;
 
     if (std::abs(vf) < DBL_EPSILON && std::abs(af) < DBL_EPSILON) {
         const double vMax = (pd >= 0) ? _vMax : _vMin;
@@ -488,29 +515,35 @@ bool PositionStep1::get_profile(const Profile& input, Block& block) {
 
         if (std::abs(v0) < DBL_EPSILON && std::abs(a0) < DBL_EPSILON && std::abs(pd) < DBL_EPSILON) {
             time_none(profile, vMax, vMin, aMax, aMin, jMax);
+            number_evaluated_cases = 1;
 
         } else {
+            using ProfileCase = void (PositionStep1::*)(Profile&, double, double, double, double, double);
+            std::array<ProfileCase, 5> cases {&PositionStep1::time_all_vel, &PositionStep1::time_none, &PositionStep1::time_acc0, &PositionStep1::time_acc1, &PositionStep1::time_acc0_acc1};
+
+            // Try the predicted case first, as the (more expensive) remaining cases can then be skipped
+            size_t predicted_index {0};
+            switch (predict_limits_to_rest(vMax, aMax, aMin, jMax)) {
+                case Profile::Limits::NONE: predicted_index = 1; break;
+                case Profile::Limits::ACC0: predicted_index = 2; break;
+                case Profile::Limits::ACC1: predicted_index = 3; break;
+                case Profile::Limits::ACC0_ACC1: predicted_index = 4; break;
+                default: break;
+            }
+            std::rotate(cases.begin(), cases.begin() + predicted_index, cases.begin() + predicted_index + 1);
+
             // There is no blocked interval when vf==0 && af==0, so return after first found profile
-            time_all_vel(profile, vMax, vMin, aMax, aMin, jMax);
-            if (valid_profile_counter > 0) { return Block::calculate_block(block, valid_profiles, valid_profile_counter); }
-            time_none(profile, vMax, vMin, aMax, aMin, jMax);
-            if (valid_profile_counter > 0) { return Block::calculate_block(block, valid_profiles, valid_profile_counter); }
-            time_acc0(profile, vMax, vMin, aMax, aMin, jMax);
-            if (valid_profile_counter > 0) { return Block::calculate_block(block, valid_profiles, valid_profile_counter); }
-            time_acc1(profile, vMax, vMin, aMax, aMin, jMax);
-            if (valid_profile_counter > 0) { return Block::calculate_block(block, valid_profiles, valid_profile_counter); }
-            time_acc0_acc1(profile, vMax, vMin, aMax, aMin, jMax);
-            if (valid_profile_counter > 0) { return Block::calculate_block(block, valid_profiles, valid_profile_counter); }
-
-            time_all_vel(profile, vMin, vMax, aMin, aMax, -jMax);
-            if (valid_profile_counter > 0) { return Block::calculate_block(block, valid_profiles, valid_profile_counter); }
-            time_none(profile, vMin, vMax, aMin, aMax, -jMax);
-            if (valid_profile_counter > 0) { return Block::calculate_block(block, valid_profiles, valid_profile_counter); }
-            time_acc0(profile, vMin, vMax, aMin, aMax, -jMax);
-            if (valid_profile_counter > 0) { return Block::calculate_block(block, valid_profiles, valid_profile_counter); }
-            time_acc1(profile, vMin, vMax, aMin, aMax, -jMax);
-            if (valid_profile_counter > 0) { return Block::calculate_block(block, valid_profiles, valid_profile_counter); }
-            time_acc0_acc1(profile, vMin, vMax, aMin, aMax, -jMax);
+            for (auto profile_case: cases) {
+                (this->*profile_case)(profile, vMax, vMin, aMax, aMin, jMax);
+                ++number_evaluated_cases;
+                if (valid_profile_counter > 0) { return Block::calculate_block(block, valid_profile_counter, minimum_duration_only); }
+            }
+
+            for (auto profile_case: {&PositionStep1::time_all_vel, &PositionStep1::time_none, &PositionStep1::time_acc0, &PositionStep1::time_acc1, &PositionStep1::time_acc0_acc1}) {
+                (this->*profile_case)(profile, vMin, vMax, aMin, aMax, -jMax);
+                ++number_evaluated_cases;
+                if (valid_profile_counter > 0) { return Block::calculate_block(block, valid_profile_counter, minimum_duration_only); }
+            }
         }
 
     } else {
@@ -524,27 +557,46 @@ bool PositionStep1::get_profile(const Profile& input, Block& block) {
         time_acc0(profile, _vMin, _vMax, _aMin, _aMax, -_jMax);
         time_acc1(profile, _vMin, _vMax, _aMin, _aMax, -_jMax);
         time_acc0_acc1(profile, _vMin, _vMax, _aMin, _aMax, -_jMax);
+        number_evaluated_cases = 10;
     }
 
     if (valid_profile_counter == 0) {
+        used_two_step_fallback = true;
         time_none_two_step(profile, _vMax, _vMin, _aMax, _aMin, _jMax);
-        if (valid_profile_counter > 0) { return Block::calculate_block(block, valid_profiles, valid_profile_counter); }
+        if (valid_profile_counter > 0) { return Block::calculate_block(block, valid_profile_counter, minimum_duration_only); }
         time_none_two_step(profile, _vMin, _vMax, _aMin, _aMax, -_jMax);
-        if (valid_profile_counter > 0) { return Block::calculate_block(block, valid_profiles, valid_profile_counter); }
+        if (valid_profile_counter > 0) { return Block::calculate_block(block, valid_profile_counter, minimum_duration_only); }
         time_acc0_two_step(profile, _vMax, _vMin, _aMax, _aMin, _jMax);
-        if (valid_profile_counter > 0) { return Block::calculate_block(block, valid_profiles, valid_profile_counter); }
+        if (valid_profile_counter > 0) { return Block::calculate_block(block, valid_profile_counter, minimum_duration_only); }
         time_acc0_two_step(profile, _vMin, _vMax, _aMin, _aMax, -_jMax);
-        if (valid_profile_counter > 0) { return Block::calculate_block(block, valid_profiles, valid_profile_counter); }
+        if (valid_profile_counter > 0) { return Block::calculate_block(block, valid_profile_counter, minimum_duration_only); }
         time_vel_two_step(profile, _vMax, _vMin, _aMax, _aMin, _jMax);
-        if (valid_profile_counter > 0) { return Block::calculate_block(block, valid_profiles, valid_profile_counter); }
+        if (valid_profile_counter > 0) { return Block::calculate_block(block, valid_profile_counter, minimum_duration_only); }
         time_vel_two_step(profile, _vMin, _vMax, _aMin, _aMax, -_jMax);
-        if (valid_profile_counter > 0) { return Block::calculate_block(block, valid_profiles, valid_profile_counter); }
+        if (valid_profile_counter > 0) { return Block::calculate_block(block, valid_profile_counter, minimum_duration_only); }
         time_acc1_vel_two_step(profile, _vMax, _vMin, _aMax, _aMin, _jMax);
-        if (valid_profile_counter > 0) { return Block::calculate_block(block, valid_profiles, valid_profile_counter); }
+        if (valid_profile_counter > 0) { return Block::calculate_block(block, valid_profile_counter, minimum_duration_only); }
         time_acc1_vel_two_step(profile, _vMin, _vMax, _aMin, _aMax, -_jMax);
     }
 
-    return Block::calculate_block(block, valid_profiles, valid_profile_counter);
+    return Block::calculate_block(block, valid_profile_counter, minimum_duration_only);
+}
+
+bool PositionStep1::get_profile_normalized(const Profile& input, Block& block, bool minimum_duration_only) const {
+    const NormalizedUnits unit {p0, _aMax, _jMax};
+    if (!unit.is_applicable()) {
+        return false;
+    }
+
+    PositionStep1 step1 {0.0, v0 / unit.velocity, a0 / unit.acceleration, pd / unit.position, vf / unit.velocity, af / unit.acceleration, _vMax / unit.velocity, _vMin / unit.velocity, _aMax / unit.acceleration, _aMin / unit.acceleration, _jMax / unit.jerk};
+    Profile profile = input;
+    profile.scale_units(1 / unit.time, 1 / unit.position, -unit.offset / unit.position);
+    if (!step1.get_profile(profile, block, minimum_duration_only)) {
+        return false;
+    }
+
+    block.scale_units(unit.time, unit.position, unit.offset);
+    return true;
 }
 
 } // namespace ruckig
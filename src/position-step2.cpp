@@ -4,34 +4,14 @@
 
 namespace ruckig {
 
-PositionStep2::PositionStep2(double tf, double p0, double v0, double a0, double pf, double vf, double af, double vMax, double vMin, double aMax, double aMin, double jMax): p0(p0), v0(v0), a0(a0), tf(tf), pf(pf), vf(vf), af(af), _vMax(vMax), _vMin(vMin), _aMax(aMax), _aMin(aMin), _jMax(jMax)  {
-    pd = pf - p0;
+PositionStep2::PositionStep2(double tf, double p0, double v0, double a0, double pf, double vf, double af, double vMax, double vMin, double aMax, double aMin, double jMax): PositionStep2(tf, PositionExpressions(p0, v0, a0, pf, vf, af, jMax), vMax, vMin, aMax, aMin, jMax) { }
+
+PositionStep2::PositionStep2(double tf, const PositionExpressions& expr, double vMax, double vMin, double aMax, double aMin, double jMax): p0(expr.p0), v0(expr.v0), a0(expr.a0), tf(tf), pf(expr.pf), vf(expr.vf), af(expr.af), _vMax(vMax), _vMin(vMin), _aMax(aMax), _aMin(aMin), _jMax(jMax), pd(expr.pd), vd(expr.vd), vd_vd(expr.vd_vd), ad(expr.ad), ad_ad(expr.ad_ad), v0_v0(expr.v0_v0), vf_vf(expr.vf_vf), a0_a0(expr.a0_a0), a0_p3(expr.a0_p3), a0_p4(expr.a0_p4), a0_p5(expr.a0_p5), a0_p6(expr.a0_p6), af_af(expr.af_af), af_p3(expr.af_p3), af_p4(expr.af_p4), af_p5(expr.af_p5), af_p6(expr.af_p6), jMax_jMax(expr.jMax_jMax) {
+    // Only the expressions depending on the duration are calculated here
     tf_tf = tf * tf;
     tf_p3 = tf_tf * tf;
     tf_p4 = tf_tf * tf_tf;
 
-    vd = vf - v0;
-    vd_vd = vd * vd;
-    v0_v0 = v0 * v0;
-    vf_vf = vf * vf;
-
-    ad = af - a0;
-    ad_ad = ad * ad;
-    a0_a0 = a0 * a0;
-    af_af = af * af;
-
-    a0_p3 = a0 * a0_a0;
-    a0_p4 = a0_a0 * a0_a0;
-    a0_p5 = a0_p3 * a0_a0;
-    a0_p6 = a0_p4 * a0_a0;
-    af_p3 = af * af_af;
-    af_p4 = af_af * af_af;
-    af_p5 = af_p3 * af_af;
-    af_p6 = af_p4 * af_af;
-
-    // max values needs to be invariant to plus minus sign change
-    jMax_jMax = jMax * jMax;
-
     g1 = -pd + tf*v0;
     g2 = -2*pd + tf*(v0 + vf);
 }
@@ -1078,4 +1058,46 @@ bool PositionStep2::get_profile(Profile& profile) {
         || time_none(profile, vMin, vMax, aMin, aMax, -jMax);
 }
 
+bool PositionStep2::get_profile(Profile& profile, const ProfileCaseHint& hint) {
+    profile.set_boundary(p0, v0, a0, pf, vf, af);
+
+    const double vMax = hint.positive_jerk ? _vMax : _vMin;
+    const double vMin = hint.positive_jerk ? _vMin : _vMax;
+    const double aMax = hint.positive_jerk ? _aMax : _aMin;
+    const double aMin = hint.positive_jerk ? _aMin : _aMax;
+    const double jMax = hint.positive_jerk ? _jMax : -_jMax;
+
+    bool found_profile {false};
+    switch (hint.limits) {
+        case Limits::ACC0_ACC1_VEL: found_profile = time_acc0_acc1_vel(profile, vMax, vMin, aMax, aMin, jMax); break;
+        case Limits::VEL: found_profile = time_vel(profile, vMax, vMin, aMax, aMin, jMax); break;
+        case Limits::ACC0_VEL: found_profile = time_acc0_vel(profile, vMax, vMin, aMax, aMin, jMax); break;
+        case Limits::ACC1_VEL: found_profile = time_acc1_vel(profile, vMax, vMin, aMax, aMin, jMax); break;
+        case Limits::ACC0_ACC1: found_profile = time_acc0_acc1(profile, vMax, vMin, aMax, aMin, jMax); break;
+        case Limits::ACC0: found_profile = time_acc0(profile, vMax, vMin, aMax, aMin, jMax); break;
+        case Limits::ACC1: found_profile = time_acc1(profile, vMax, vMin, aMax, aMin, jMax); break;
+        case Limits::NONE: found_profile = time_none(profile, vMax, vMin, aMax, aMin, jMax); break;
+    }
+
+    return found_profile || get_profile(profile);
+}
+
+bool PositionStep2::get_profile_normalized(Profile& profile) const {
+    const NormalizedUnits unit {p0, _aMax, _jMax};
+    if (!unit.is_applicable()) {
+        return false;
+    }
+
+    PositionStep2 step2 {tf / unit.time, 0.0, v0 / unit.velocity, a0 / unit.acceleration, pd / unit.position, vf / unit.velocity, af / unit.acceleration, _vMax / unit.velocity, _vMin / unit.velocity, _aMax / unit.acceleration, _aMin / unit.acceleration, _jMax / unit.jerk};
+    Profile normalized = profile;
+    normalized.scale_units(1 / unit.time, 1 / unit.position, -unit.offset / unit.position);
+    if (!step2.get_profile(normalized)) {
+        return false;
+    }
+
+    normalized.scale_units(unit.time, unit.position, unit.offset);
+    profile = normalized;
+    return true;
+}
+
 } // namespace ruckig
@@ -1,7 +1,19 @@
+#include <algorithm>
 #include <array>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <limits>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
 #include <string>
+#include <thread>
+#include <tuple>
+#include <vector>
 
 #include <pybind11/pybind11.h>
+#include <pybind11/numpy.h>
 #include <pybind11/stl.h>
 #include <pybind11/operators.h>
 
@@ -17,6 +29,165 @@ using namespace pybind11::literals; // to bring in the `_a` literal
 using namespace ruckig;
 
 
+//! Expose a per-DoF vector as a writable NumPy view over the C++ storage, so that in-place updates need no conversion
+template<class Class>
+void def_array_view(py::class_<Class>& cls, const char* name, std::vector<double> Class::* member) {
+    cls.def_property(name, [member](py::object self) {
+        auto& vector = self.cast<Class&>().*member;
+        return py::array_t<double>(vector.size(), vector.data(), self);
+    }, [member](Class& self, const std::vector<double>& values) {
+        auto& vector = self.*member;
+        if (values.size() != vector.size()) {
+            throw std::invalid_argument("[ruckig] mismatch in degrees of freedom (vector size).");
+        }
+        std::copy(values.begin(), values.end(), vector.begin()); // In-place, so that existing views stay valid
+    });
+}
+
+//! Expose an optional per-DoF vector as a NumPy copy, or None if it is not set
+
+//! Unlike the other vectors, its storage is replaced (or removed) by an assignment, which would invalidate a view.
+template<class Class>
+void def_array_view(py::class_<Class>& cls, const char* name, std::optional<std::vector<double>> Class::* member) {
+    cls.def_property(name, [member](const Class& self) -> py::object {
+        const auto& optional = self.*member;
+        if (!optional) {
+            return py::none();
+        }
+        return py::array_t<double>(optional->size(), optional->data());
+    }, [member](Class& self, const std::optional<std::vector<double>>& values) {
+        self.*member = values;
+    });
+}
+
+
+//! Background threads for the awaitable calculations, so that the asyncio event loop is never blocked
+
+//! A job calculates without the GIL, and then acquires it only to schedule the resolution of its future on the event
+//! loop. The threads are stopped at interpreter exit, and jobs that were not started until then are dropped.
+class BackgroundExecutor {
+    std::mutex mutex;
+    std::condition_variable condition;
+    std::deque<std::function<void()>> jobs;
+    std::vector<std::thread> threads;
+    bool running {true};
+
+    void work() {
+        while (true) {
+            std::function<void()> job;
+            {
+                std::unique_lock<std::mutex> lock {mutex};
+                condition.wait(lock, [this] { return !jobs.empty() || !running; });
+                if (!running) {
+                    return;
+                }
+                job = std::move(jobs.front());
+                jobs.pop_front();
+            }
+            job();
+        }
+    }
+
+public:
+    const size_t number_threads;
+
+    explicit BackgroundExecutor(size_t number_threads): number_threads(number_threads) { }
+
+    ~BackgroundExecutor() {
+        {
+            std::lock_guard<std::mutex> lock {mutex};
+            running = false;
+        }
+        condition.notify_all();
+        for (auto& thread: threads) {
+            if (thread.joinable()) {
+                thread.join();
+            }
+        }
+    }
+
+    static BackgroundExecutor& instance() {
+        static BackgroundExecutor executor {std::max<unsigned>(std::thread::hardware_concurrency(), 1)};
+        return executor;
+    }
+
+    //! Queue a job, which must release all its Python objects itself (with the GIL)
+    void submit(std::function<void()>&& job) {
+        {
+            std::lock_guard<std::mutex> lock {mutex};
+            if (!running) {
+                throw std::runtime_error("[ruckig] the background calculations are stopped at interpreter exit.");
+            }
+            if (threads.empty()) { // Started with the first job
+                threads.reserve(number_threads);
+                for (size_t i = 0; i < number_threads; ++i) {
+                    threads.emplace_back(&BackgroundExecutor::work, this);
+                }
+            }
+            jobs.push_back(std::move(job));
+        }
+        condition.notify_one();
+    }
+
+    //! Join all threads, called with the GIL held so that running jobs can still resolve their futures
+    void stop() {
+        {
+            std::lock_guard<std::mutex> lock {mutex};
+            running = false;
+        }
+        condition.notify_all();
+
+        {
+            py::gil_scoped_release release;
+            for (auto& thread: threads) {
+                if (thread.joinable()) {
+                    thread.join();
+                }
+            }
+        }
+        jobs.clear();
+    }
+};
+
+//! Run the calculation on the background executor and return an asyncio future of its result
+template<class F>
+py::object submit_awaitable(F&& calculate) {
+    py::object loop = py::module_::import("asyncio").attr("get_running_loop")();
+    py::object future = loop.attr("create_future")();
+
+    BackgroundExecutor::instance().submit([loop, future, calculate = std::forward<F>(calculate)]() mutable {
+        std::optional<decltype(calculate())> value;
+        std::string error;
+        bool is_invalid_argument {false};
+        try {
+            value = calculate();
+        } catch (const std::invalid_argument& exception) {
+            error = exception.what();
+            is_invalid_argument = true;
+        } catch (const std::exception& exception) {
+            error = exception.what();
+        }
+
+        py::gil_scoped_acquire acquire;
+        try {
+            py::object outcome = value ? py::cast(std::move(*value)) : py::reinterpret_borrow<py::object>(is_invalid_argument ? PyExc_ValueError : PyExc_RuntimeError)(error);
+            const char* method = value ? "set_result" : "set_exception";
+            py::cpp_function resolve {[method](py::object future, py::object outcome) {
+                if (!future.attr("done")().cast<bool>()) { // e.g. cancelled in the meantime
+                    future.attr(method)(outcome);
+                }
+            }};
+            loop.attr("call_soon_threadsafe")(resolve, future, outcome);
+        } catch (py::error_already_set&) {
+            // The event loop was closed before the calculation finished
+        }
+        future = py::object();
+        loop = py::object();
+    });
+    return future;
+}
+
+
 PYBIND11_MODULE(ruckig, m) {
     m.doc() = "Instantaneous Motion Generation for Robots and Machines. Real-time and time-optimal trajectory calculation \
 given a target waypoint with position, velocity, and acceleration, starting from any initial state \
@@ -39,6 +210,11 @@ limited by velocity, acceleration, and jerk constraints.";
         .value("Discrete", DurationDiscretization::Discrete)
         .export_values();
 
+    py::enum_<ChangeDetection>(m, "ChangeDetection")
+        .value("Full", ChangeDetection::Full)
+        .value("Generation", ChangeDetection::Generation)
+        .export_values();
+
     py::enum_<Result>(m, "Result", py::arithmetic())
         .value("Working", Result::Working)
         .value("Finished", Result::Finished)
@@ -58,6 +234,38 @@ limited by velocity, acceleration, and jerk constraints.";
             return "[" + std::to_string(ext.min) + ", " + std::to_string(ext.max) + "]";
         });
 
+    py::class_<KinematicExtrema>(m, "KinematicExtrema")
+        .def_readonly("min_velocity", &KinematicExtrema::min_velocity)
+        .def_readonly("max_velocity", &KinematicExtrema::max_velocity)
+        .def_readonly("min_acceleration", &KinematicExtrema::min_acceleration)
+        .def_readonly("max_acceleration", &KinematicExtrema::max_acceleration)
+        .def_readonly("t_min_velocity", &KinematicExtrema::t_min_velocity)
+        .def_readonly("t_max_velocity", &KinematicExtrema::t_max_velocity)
+        .def_readonly("t_min_acceleration", &KinematicExtrema::t_min_acceleration)
+        .def_readonly("t_max_acceleration", &KinematicExtrema::t_max_acceleration);
+
+    py::class_<PositionCrossing>(m, "PositionCrossing")
+        .def_readonly("dof", &PositionCrossing::dof)
+        .def_readonly("index", &PositionCrossing::index)
+        .def_readonly("time", &PositionCrossing::time)
+        .def_readonly("velocity", &PositionCrossing::velocity)
+        .def("__repr__", [](const PositionCrossing& crossing) {
+            return "[" + std::to_string(crossing.dof) + ", " + std::to_string(crossing.index) + ", " + std::to_string(crossing.time) + "]";
+        });
+
+    py::enum_<TrajectoryEventType>(m, "TrajectoryEventType")
+        .value("BrakeEnd", TrajectoryEventType::BrakeEnd)
+        .value("SegmentBoundary", TrajectoryEventType::SegmentBoundary)
+        .value("Arrival", TrajectoryEventType::Arrival)
+        .value("Finished", TrajectoryEventType::Finished)
+        .export_values();
+
+    py::class_<TrajectoryEvent>(m, "TrajectoryEvent")
+        .def_readonly("type", &TrajectoryEvent::type)
+        .def_readonly("dof", &TrajectoryEvent::dof)
+        .def_readonly("segment", &TrajectoryEvent::segment)
+        .def_readonly("time", &TrajectoryEvent::time);
+
     py::class_<Trajectory<DynamicDOFs>>(m, "Trajectory")
         .def(py::init<size_t>(), "dofs"_a)
         .def_readonly("degrees_of_freedom", &Trajectory<DynamicDOFs>::degrees_of_freedom)
@@ -65,51 +273,105 @@ limited by velocity, acceleration, and jerk constraints.";
         .def_property_readonly("intermediate_durations", &Trajectory<DynamicDOFs>::get_intermediate_durations)
         .def_property_readonly("independent_min_durations", &Trajectory<DynamicDOFs>::get_independent_min_durations)
         .def_property_readonly("position_extrema", &Trajectory<DynamicDOFs>::get_position_extrema)
-        .def("at_time", [](const Trajectory<DynamicDOFs>& traj, double time, bool return_section=false) {
+        .def_property_readonly("kinematic_extrema", &Trajectory<DynamicDOFs>::get_kinematic_extrema)
+        .def_property_readonly("is_calculation_interrupted", &Trajectory<DynamicDOFs>::is_calculation_interrupted)
+        .def("at_time", [](const Trajectory<DynamicDOFs>& traj, py::object time_object, bool return_section=false) -> py::tuple {
+            // Sample a NumPy array of times directly into (N, DoFs) arrays
+            if (py::isinstance<py::array>(time_object)) {
+                const auto times = py::array_t<double, py::array::c_style | py::array::forcecast>::ensure(time_object);
+                if (!times || times.ndim() != 1) {
+                    throw std::invalid_argument("[ruckig] times need to be a one-dimensional array.");
+                }
+
+                const size_t number_times = times.shape(0);
+                const std::vector<py::ssize_t> shape {static_cast<py::ssize_t>(number_times), static_cast<py::ssize_t>(traj.degrees_of_freedom)};
+                py::array_t<double> new_positions(shape), new_velocities(shape), new_accelerations(shape);
+                const double* times_data = times.data();
+                double* new_positions_data = new_positions.mutable_data();
+                double* new_velocities_data = new_velocities.mutable_data();
+                double* new_accelerations_data = new_accelerations.mutable_data();
+                {
+                    py::gil_scoped_release release;
+                    traj.at_times(times_data, number_times, new_positions_data, new_velocities_data, new_accelerations_data);
+                }
+                return py::make_tuple(new_positions, new_velocities, new_accelerations);
+            }
+
+            const double time = time_object.cast<double>();
             std::vector<double> new_position(traj.degrees_of_freedom), new_velocity(traj.degrees_of_freedom), new_acceleration(traj.degrees_of_freedom);
             size_t new_section;
-            traj.at_time(time, new_position, new_velocity, new_acceleration, new_section);
+            {
+                py::gil_scoped_release release;
+                traj.at_time(time, new_position, new_velocity, new_acceleration, new_section);
+            }
             if (return_section) {
                 return py::make_tuple(new_position, new_velocity, new_acceleration, new_section);
             }
             return py::make_tuple(new_position, new_velocity, new_acceleration);
         }, "time"_a, "return_section"_a=false)
+        .def("scale_time", &Trajectory<DynamicDOFs>::scale_time, "factor"_a)
         .def("get_first_time_at_position", [](const Trajectory<DynamicDOFs>& traj, size_t dof, double position) -> py::object {
             double time;
-            if (traj.get_first_time_at_position(dof, position, time)) {
+            bool found;
+            {
+                py::gil_scoped_release release;
+                found = traj.get_first_time_at_position(dof, position, time);
+            }
+            if (found) {
                 return py::cast(time);
             }
             return py::none();
-        }, "dof"_a, "position"_a);
+        }, "dof"_a, "position"_a)
+        .def("get_events", [](const Trajectory<DynamicDOFs>& traj) {
+            std::vector<TrajectoryEvent> events;
+            traj.get_events(events);
+            return events;
+        })
+        .def("get_next_event_time", &Trajectory<DynamicDOFs>::get_next_event_time, "time"_a)
+        .def("get_position_crossings", [](const Trajectory<DynamicDOFs>& traj, size_t dof, const std::vector<double>& positions) {
+            std::vector<PositionCrossing> crossings;
+            {
+                py::gil_scoped_release release;
+                traj.get_position_crossings(dof, positions, crossings);
+            }
+            return crossings;
+        }, "dof"_a, "positions"_a);
 
-    py::class_<InputParameter<DynamicDOFs>>(m, "InputParameter")
+    py::class_<InputParameter<DynamicDOFs>> input_parameter(m, "InputParameter");
+    input_parameter
         .def(py::init<size_t>(), "dofs"_a)
         .def_readonly("degrees_of_freedom", &InputParameter<DynamicDOFs>::degrees_of_freedom)
-        .def_readwrite("current_position", &InputParameter<DynamicDOFs>::current_position)
-        .def_readwrite("current_velocity", &InputParameter<DynamicDOFs>::current_velocity)
-        .def_readwrite("current_acceleration", &InputParameter<DynamicDOFs>::current_acceleration)
-        .def_readwrite("target_position", &InputParameter<DynamicDOFs>::target_position)
-        .def_readwrite("target_velocity", &InputParameter<DynamicDOFs>::target_velocity)
-        .def_readwrite("target_acceleration", &InputParameter<DynamicDOFs>::target_acceleration)
-        .def_readwrite("max_velocity", &InputParameter<DynamicDOFs>::max_velocity)
-        .def_readwrite("max_acceleration", &InputParameter<DynamicDOFs>::max_acceleration)
-        .def_readwrite("max_jerk", &InputParameter<DynamicDOFs>::max_jerk)
-        .def_readwrite("min_velocity", &InputParameter<DynamicDOFs>::min_velocity)
-        .def_readwrite("min_acceleration", &InputParameter<DynamicDOFs>::min_acceleration)
-        .def_readwrite("intermediate_positions", &InputParameter<DynamicDOFs>::intermediate_positions)
-        .def_readwrite("max_position", &InputParameter<DynamicDOFs>::max_position)
-        .def_readwrite("min_position", &InputParameter<DynamicDOFs>::min_position)
+        .def_property("intermediate_positions", [](const InputParameter<DynamicDOFs>& input) { return input.intermediate_positions.to_vector(); }, [](InputParameter<DynamicDOFs>& input, const std::vector<std::vector<double>>& positions) { input.intermediate_positions = positions; })
         .def_readwrite("enabled", &InputParameter<DynamicDOFs>::enabled)
         .def_readwrite("control_interface", &InputParameter<DynamicDOFs>::control_interface)
         .def_readwrite("synchronization", &InputParameter<DynamicDOFs>::synchronization)
         .def_readwrite("duration_discretization", &InputParameter<DynamicDOFs>::duration_discretization)
+        .def_readwrite("change_detection", &InputParameter<DynamicDOFs>::change_detection)
+        .def_readwrite("generation", &InputParameter<DynamicDOFs>::generation)
         .def_readwrite("per_dof_control_interface", &InputParameter<DynamicDOFs>::per_dof_control_interface)
         .def_readwrite("per_dof_synchronization", &InputParameter<DynamicDOFs>::per_dof_synchronization)
+        .def_readwrite("synchronization_groups", &InputParameter<DynamicDOFs>::synchronization_groups)
         .def_readwrite("minimum_duration", &InputParameter<DynamicDOFs>::minimum_duration)
         .def_readwrite("interrupt_calculation_duration", &InputParameter<DynamicDOFs>::interrupt_calculation_duration)
+        .def_readwrite("warm_start", &InputParameter<DynamicDOFs>::warm_start)
+        .def("mark_changed", &InputParameter<DynamicDOFs>::mark_changed)
         .def(py::self != py::self)
         .def("__repr__", &InputParameter<DynamicDOFs>::to_string);
 
+    def_array_view(input_parameter, "current_position", &InputParameter<DynamicDOFs>::current_position);
+    def_array_view(input_parameter, "current_velocity", &InputParameter<DynamicDOFs>::current_velocity);
+    def_array_view(input_parameter, "current_acceleration", &InputParameter<DynamicDOFs>::current_acceleration);
+    def_array_view(input_parameter, "target_position", &InputParameter<DynamicDOFs>::target_position);
+    def_array_view(input_parameter, "target_velocity", &InputParameter<DynamicDOFs>::target_velocity);
+    def_array_view(input_parameter, "target_acceleration", &InputParameter<DynamicDOFs>::target_acceleration);
+    def_array_view(input_parameter, "max_velocity", &InputParameter<DynamicDOFs>::max_velocity);
+    def_array_view(input_parameter, "max_acceleration", &InputParameter<DynamicDOFs>::max_acceleration);
+    def_array_view(input_parameter, "max_jerk", &InputParameter<DynamicDOFs>::max_jerk);
+    def_array_view(input_parameter, "min_velocity", &InputParameter<DynamicDOFs>::min_velocity);
+    def_array_view(input_parameter, "min_acceleration", &InputParameter<DynamicDOFs>::min_acceleration);
+    def_array_view(input_parameter, "max_position", &InputParameter<DynamicDOFs>::max_position);
+    def_array_view(input_parameter, "min_position", &InputParameter<DynamicDOFs>::min_position);
+
     py::class_<OutputParameter<DynamicDOFs>>(m, "OutputParameter")
         .def(py::init<size_t>(), "dofs"_a)
         .def_readonly("degrees_of_freedom", &OutputParameter<DynamicDOFs>::degrees_of_freedom)
@@ -129,15 +391,120 @@ limited by velocity, acceleration, and jerk constraints.";
             return OutputParameter<DynamicDOFs>(self);
         });
 
+    py::class_<SpeedOverride>(m, "SpeedOverride")
+        .def_readwrite("target", &SpeedOverride::target)
+        .def_readwrite("max_rate", &SpeedOverride::max_rate)
+        .def_readwrite("max_rate_change", &SpeedOverride::max_rate_change)
+        .def_property_readonly("ratio", &SpeedOverride::get_ratio)
+        .def_property_readonly("rate", &SpeedOverride::get_rate)
+        .def("reset", &SpeedOverride::reset, "ratio"_a=1.0);
+
     py::class_<Ruckig<0, true>>(m, "Ruckig")
         .def(py::init<size_t>(), "dofs"_a)
         .def(py::init<size_t, double>(), "dofs"_a, "delta_time"_a)
         .def_readonly("delta_time", &Ruckig<0, true>::delta_time)
         .def_readonly("degrees_of_freedom", &Ruckig<0, true>::degrees_of_freedom)
-        .def("validate_input", &Ruckig<0, true>::validate_input, "input"_a)
-        .def("calculate", static_cast<Result (Ruckig<0, true>::*)(const InputParameter<0>&, Trajectory<0>&)>(&Ruckig<0, true>::calculate), "input"_a, "trajectory"_a)
-        .def("calculate", static_cast<Result (Ruckig<0, true>::*)(const InputParameter<0>&, Trajectory<0>&, bool&)>(&Ruckig<0, true>::calculate), "input"_a, "trajectory"_a, "was_interrupted"_a)
-        .def("update", &Ruckig<0, true>::update, "input"_a, "output"_a);
+        .def_readwrite("speed_override", &Ruckig<0, true>::speed_override)
+        .def("validate_input", &Ruckig<0, true>::validate_input, "input"_a, py::call_guard<py::gil_scoped_release>())
+        .def("calculate", static_cast<Result (Ruckig<0, true>::*)(const InputParameter<0>&, Trajectory<0>&)>(&Ruckig<0, true>::calculate), "input"_a, "trajectory"_a, py::call_guard<py::gil_scoped_release>())
+        .def("calculate", static_cast<Result (Ruckig<0, true>::*)(const InputParameter<0>&, Trajectory<0>&, bool&)>(&Ruckig<0, true>::calculate), "input"_a, "trajectory"_a, "was_interrupted"_a, py::call_guard<py::gil_scoped_release>())
+        .def("continue_calculation", &Ruckig<0, true>::continue_calculation, "input"_a, "trajectory"_a, "was_interrupted"_a, py::call_guard<py::gil_scoped_release>())
+        .def("calculate_min_duration", [](Ruckig<0, true>& otg, const InputParameter<0>& input, Trajectory<0>& trajectory) {
+            double duration {0.0};
+            const Result result = otg.calculate_min_duration(input, trajectory, duration);
+            return std::make_tuple(result, duration); // Cast to Python after the call guard, with the GIL
+        }, "input"_a, "trajectory"_a, py::call_guard<py::gil_scoped_release>())
+        .def("is_reachable_within", &Ruckig<0, true>::is_reachable_within, "input"_a, "trajectory"_a, "max_duration"_a, py::call_guard<py::gil_scoped_release>())
+        .def("calculate_many", [](Ruckig<0, true>& otg, const std::vector<InputParameter<0>>& inputs, size_t number_threads) {
+            std::vector<Trajectory<0>> trajectories;
+            std::vector<Result> results;
+            {
+                py::gil_scoped_release release;
+                otg.calculate_batch(inputs, trajectories, results, number_threads);
+            }
+            return std::make_tuple(std::move(results), std::move(trajectories));
+        }, "inputs"_a, "number_threads"_a=std::max<unsigned>(std::thread::hardware_concurrency(), 1))
+        .def("calculate_async", [](const Ruckig<0, true>& otg, const InputParameter<0>& input) {
+            return submit_awaitable([input, dofs = otg.degrees_of_freedom, delta_time = otg.delta_time]() {
+                Ruckig<0, true> background_otg {dofs, delta_time};
+                Trajectory<0> trajectory {dofs};
+                const Result result = background_otg.calculate(input, trajectory);
+                return std::make_tuple(result, std::move(trajectory));
+            });
+        }, "input"_a, "Awaitable calculate on a background thread, resolving to the result and the trajectory")
+        .def("calculate_many_async", [](const Ruckig<0, true>& otg, const std::vector<InputParameter<0>>& inputs, size_t number_threads) {
+            return submit_awaitable([inputs, number_threads, dofs = otg.degrees_of_freedom, delta_time = otg.delta_time]() {
+                Ruckig<0, true> background_otg {dofs, delta_time};
+                std::vector<Trajectory<0>> trajectories;
+                std::vector<Result> results;
+                background_otg.calculate_batch(inputs, trajectories, results, number_threads);
+                return std::make_tuple(std::move(results), std::move(trajectories));
+            });
+        }, "inputs"_a, "number_threads"_a=std::max<unsigned>(std::thread::hardware_concurrency(), 1), "Awaitable calculate_many on a background thread, resolving to the lists of results and trajectories")
+        .def("calculate_min_duration_matrix", [](Ruckig<0, true>& otg, const std::vector<InputParameter<0>>& starts, const std::vector<InputParameter<0>>& targets, size_t number_threads) {
+            std::vector<double> durations;
+            otg.calculate_min_duration_matrix(starts, targets, durations, number_threads);
+            return durations;
+        }, "starts"_a, "targets"_a, "number_threads"_a=std::max<unsigned>(std::thread::hardware_concurrency(), 1), py::call_guard<py::gil_scoped_release>())
+        .def("update", static_cast<Result (Ruckig<0, true>::*)(const InputParameter<0>&, OutputParameter<0>&)>(&Ruckig<0, true>::update), "input"_a, "output"_a, py::call_guard<py::gil_scoped_release>())
+        .def("update", static_cast<Result (Ruckig<0, true>::*)(const InputParameter<0>&, OutputParameter<0>&, double)>(&Ruckig<0, true>::update), "input"_a, "output"_a, "time_step"_a, py::call_guard<py::gil_scoped_release>());
+
+    // Stop the background threads while the interpreter is still alive
+    py::module_::import("atexit").attr("register")(py::cpp_function([]() { BackgroundExecutor::instance().stop(); }));
+
+    m.def("generate", [](const InputParameter<DynamicDOFs>& input, double delta_time, std::optional<double> max_duration, size_t decimation) {
+        if (decimation == 0) {
+            throw std::invalid_argument("[ruckig] decimation needs to be positive.");
+        }
+
+        const size_t dofs = input.degrees_of_freedom;
+        std::vector<double> times, positions, velocities, accelerations;
+        {
+            // Run the complete update loop in C++
+            py::gil_scoped_release release;
+            Ruckig<0, true> otg {dofs, delta_time};
+            InputParameter<DynamicDOFs> current_input {input};
+            OutputParameter<DynamicDOFs> output {dofs};
+
+            Result result {Result::Working};
+            for (size_t cycle = 0; result == Result::Working; ++cycle) {
+                result = otg.update(current_input, output);
+                if (result < 0) {
+                    throw std::runtime_error("[ruckig] error during trajectory generation: " + std::to_string(result));
+                }
+
+                if (cycle == 0) {
+                    const double duration = std::min(output.trajectory.get_duration(), max_duration.value_or(std::numeric_limits<double>::infinity()));
+                    const size_t expected_samples = static_cast<size_t>(duration / delta_time / decimation) + 2;
+                    times.reserve(expected_samples);
+                    positions.reserve(expected_samples * dofs);
+                    velocities.reserve(expected_samples * dofs);
+                    accelerations.reserve(expected_samples * dofs);
+                }
+
+                const bool is_last = (result == Result::Finished) || (max_duration && output.time >= max_duration.value());
+                if (cycle % decimation == 0 || is_last) {
+                    times.push_back(output.time);
+                    positions.insert(positions.end(), output.new_position.begin(), output.new_position.end());
+                    velocities.insert(velocities.end(), output.new_velocity.begin(), output.new_velocity.end());
+                    accelerations.insert(accelerations.end(), output.new_acceleration.begin(), output.new_acceleration.end());
+                }
+                if (is_last) {
+                    break;
+                }
+
+                output.pass_to_input(current_input);
+            }
+        }
+
+        const std::vector<py::ssize_t> shape {static_cast<py::ssize_t>(times.size()), static_cast<py::ssize_t>(dofs)};
+        return py::make_tuple(
+            py::array_t<double>(times.size(), times.data()),
+            py::array_t<double>(shape, positions.data()),
+            py::array_t<double>(shape, velocities.data()),
+            py::array_t<double>(shape, accelerations.data())
+        );
+    }, "input"_a, "delta_time"_a, "max_duration"_a=py::none(), "decimation"_a=1, "Calculate and sample the complete trajectory for the input, returning the times and the kinematic states as NumPy arrays");
 
 #ifdef WITH_REFLEXXES
     py::class_<Reflexxes<DynamicDOFs>>(m, "Reflexxes")
@@ -72,9 +72,10 @@ void VelocityStep1::time_none(Profile& profile, double aMax, double aMin, double
     }
 }
 
-bool VelocityStep1::get_profile(const Profile& input, Block& block) {
+bool VelocityStep1::get_profile(const Profile& input, Block& block, bool minimum_duration_only) {
     Profile profile = input;
     profile.set_boundary(p0, v0, a0, vf, af);
+    valid_profiles = block.profiles.data();
     valid_profile_counter = 0;
 
     if (std::abs(v0) < DBL_EPSILON && std::abs(vf) < DBL_EPSILON && std::abs(a0) < DBL_EPSILON && std::abs(af) < DBL_EPSILON) {
@@ -87,7 +88,7 @@ bool VelocityStep1::get_profile(const Profile& input, Block& block) {
         time_acc0(profile, _aMin, _aMax, -_jMax);
     }
 
-    return Block::calculate_block(block, valid_profiles, valid_profile_counter);
+    return Block::calculate_block(block, valid_profile_counter, minimum_duration_only);
 }
 
 } // namespace ruckig
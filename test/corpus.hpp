@@ -0,0 +1,151 @@
+#pragma once
+
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <ruckig/input_parameter.hpp>
+
+
+//! Text format for a set of inputs with bit-exact (hexadecimal) doubles, one input per line
+
+//! Each line contains the number of DoFs, the control interface, synchronization, and duration discretization as
+//! integers, followed by the current state, target state, and kinematic limits, each with one value per DoF. Asymmetric
+//! limits follow after the token "min" as the minimum velocity and acceleration. Empty lines and lines starting with
+//! '#' are skipped, except that a line "# section: NAME" starts a named group of inputs (see read_sections).
+namespace corpus {
+
+template<size_t DOFs>
+void write_input(std::ostream& os, const ruckig::InputParameter<DOFs>& input) {
+    os << input.degrees_of_freedom << " " << static_cast<int>(input.control_interface) << " " << static_cast<int>(input.synchronization) << " " << static_cast<int>(input.duration_discretization);
+    os << std::hexfloat;
+    for (const auto* vector: {&input.current_position, &input.current_velocity, &input.current_acceleration, &input.target_position, &input.target_velocity, &input.target_acceleration, &input.max_velocity, &input.max_acceleration, &input.max_jerk}) {
+        for (const double value: *vector) {
+            os << " " << value;
+        }
+    }
+    if (input.min_velocity || input.min_acceleration) {
+        os << " min";
+        for (size_t dof = 0; dof < input.degrees_of_freedom; ++dof) {
+            os << " " << (input.min_velocity ? input.min_velocity.value()[dof] : -input.max_velocity[dof]);
+        }
+        for (size_t dof = 0; dof < input.degrees_of_freedom; ++dof) {
+            os << " " << (input.min_acceleration ? input.min_acceleration.value()[dof] : -input.max_acceleration[dof]);
+        }
+    }
+    os << std::defaultfloat << "\n";
+}
+
+inline void write_section(std::ostream& os, const std::string& name) {
+    os << "# section: " << name << "\n";
+}
+
+//! Number of DoFs of an input line
+inline size_t line_dofs(const std::string& line) {
+    std::istringstream ss {line};
+    size_t dofs {0};
+    ss >> dofs;
+    return dofs;
+}
+
+template<size_t DOFs>
+bool read_input(const std::string& line, ruckig::InputParameter<DOFs>& input) {
+    std::istringstream ss {line};
+    size_t dofs;
+    int control_interface, synchronization, duration_discretization;
+    if (!(ss >> dofs >> control_interface >> synchronization >> duration_discretization) || dofs != input.degrees_of_freedom) {
+        return false;
+    }
+
+    input.control_interface = static_cast<ruckig::ControlInterface>(control_interface);
+    input.synchronization = static_cast<ruckig::Synchronization>(synchronization);
+    input.duration_discretization = static_cast<ruckig::DurationDiscretization>(duration_discretization);
+
+    // Parse with strtod, as reading hexadecimal floats via streams is not supported by all standard libraries
+    const auto read_vector = [&ss](auto& vector) {
+        for (double& value: vector) {
+            std::string token;
+            if (!(ss >> token)) {
+                return false;
+            }
+            value = std::strtod(token.c_str(), nullptr);
+        }
+        return true;
+    };
+
+    for (auto* vector: {&input.current_position, &input.current_velocity, &input.current_acceleration, &input.target_position, &input.target_velocity, &input.target_acceleration, &input.max_velocity, &input.max_acceleration, &input.max_jerk}) {
+        if (!read_vector(*vector)) {
+            return false;
+        }
+    }
+
+    std::string token;
+    if (ss >> token && token == "min") {
+        input.min_velocity = input.max_velocity;
+        input.min_acceleration = input.max_acceleration;
+        return read_vector(input.min_velocity.value()) && read_vector(input.min_acceleration.value());
+    }
+    input.min_velocity.reset();
+    input.min_acceleration.reset();
+    return true;
+}
+
+//! Read all inputs with a matching number of DoFs from a stream
+template<size_t DOFs>
+std::vector<ruckig::InputParameter<DOFs>> read(std::istream& is, size_t dofs = DOFs) {
+    std::vector<ruckig::InputParameter<DOFs>> inputs;
+    std::string line;
+    while (std::getline(is, line)) {
+        if (line.empty() || line[0] == '#') {
+            continue;
+        }
+
+        ruckig::InputParameter<DOFs> input = [dofs]() {
+            if constexpr (DOFs == 0) {
+                return ruckig::InputParameter<DOFs> {dofs};
+            } else {
+                return ruckig::InputParameter<DOFs> {};
+            }
+        }();
+        if (read_input(line, input)) {
+            inputs.push_back(input);
+        }
+    }
+    return inputs;
+}
+
+//! Named group of inputs, with dynamic DoFs as the number of DoFs may differ between its inputs
+struct Section {
+    std::string name;
+    std::vector<ruckig::InputParameter<0>> inputs;
+};
+
+//! Read all inputs grouped by their sections, inputs before the first section are in a section without name
+inline std::vector<Section> read_sections(std::istream& is) {
+    std::vector<Section> sections;
+    std::string line;
+    const std::string section_prefix {"# section: "};
+    while (std::getline(is, line)) {
+        if (line.compare(0, section_prefix.size(), section_prefix) == 0) {
+            sections.push_back({line.substr(section_prefix.size()), {}});
+            continue;
+        }
+        if (line.empty() || line[0] == '#') {
+            continue;
+        }
+
+        ruckig::InputParameter<0> input {line_dofs(line)};
+        if (input.degrees_of_freedom > 0 && read_input(line, input)) {
+            if (sections.empty()) {
+                sections.push_back({"", {}});
+            }
+            sections.back().inputs.push_back(input);
+        }
+    }
+    return sections;
+}
+
+} // namespace corpus
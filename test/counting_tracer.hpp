@@ -0,0 +1,32 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+
+
+//! Trace policy of otg-tracing: counts the begin and end of each trace point, and checks that they are nested
+struct CountingTracer {
+    constexpr static size_t number_points {6};
+
+    static inline std::array<std::atomic<size_t>, number_points> begins {};
+    static inline std::array<std::atomic<size_t>, number_points> ends {};
+    static inline std::atomic<size_t> nesting_errors {0};
+    static inline thread_local size_t calculate_depth {0};
+
+    static void begin(ruckig::TracePoint point, size_t) {
+        begins[static_cast<size_t>(point)].fetch_add(1, std::memory_order_relaxed);
+        if (point == ruckig::TracePoint::Calculate) {
+            ++calculate_depth;
+        } else if (point != ruckig::TracePoint::AtTime && calculate_depth != 1) {
+            nesting_errors.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    static void end(ruckig::TracePoint point, size_t) {
+        ends[static_cast<size_t>(point)].fetch_add(1, std::memory_order_relaxed);
+        if (point == ruckig::TracePoint::Calculate) {
+            --calculate_depth;
+        }
+    }
+};
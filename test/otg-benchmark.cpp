@@ -1,41 +1,231 @@
 #include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <numeric>
+#include <string>
+#include <thread>
+#include <vector>
 
+#include "corpus.hpp"
 #include "randomizer.hpp"
 
+#include <ruckig/batch_ruckig.hpp>
+#include <ruckig/candidate_batch.hpp>
 #include <ruckig/ruckig.hpp>
+#include <ruckig/segment_table.hpp>
+#include <ruckig/velocity_ruckig.hpp>
+
+// Count the heap allocations of the program, so that the allocations per call can be reported
+#define RUCKIG_ALLOCATION_COUNTER_IMPLEMENT
+#include <ruckig/memory_report.hpp>
 
 #ifdef WITH_REFLEXXES
 #include <ruckig/reflexxes_comparison.hpp>
 #endif
 
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
 
 using namespace ruckig;
 
 
-template<size_t DOFs, class OTGType>
-double check_calculation(OTGType& otg, InputParameter<DOFs>& input) {
-    OutputParameter<DOFs> output;
-    auto result = otg.update(input, output);
-    return output.calculation_duration;
+//! Group of hardware event counters of the calling thread via Linux perf_event, unavailable on other platforms or without permission
+class PerfCounters {
+public:
+    enum class Event {
+        Cycles,
+        Instructions,
+        BranchMisses,
+        L1DMisses, ///< L1 data cache read misses
+        LLCMisses, ///< Last level cache read misses
+        CacheMisses, ///< Generic cache misses, usually of the last level cache
+    };
+
+private:
+    std::vector<Event> events;
+    std::vector<int> fds;
+    std::vector<uint64_t> buffer; // Number of events followed by their values, as read with PERF_FORMAT_GROUP
+
+public:
+    explicit PerfCounters(const std::vector<Event>& events): events(events) {
+#ifdef __linux__
+        for (const auto event: events) {
+            perf_event_attr attr {};
+            attr.size = sizeof(attr);
+            attr.type = PERF_TYPE_HARDWARE;
+            switch (event) {
+                case Event::Cycles: attr.config = PERF_COUNT_HW_CPU_CYCLES; break;
+                case Event::Instructions: attr.config = PERF_COUNT_HW_INSTRUCTIONS; break;
+                case Event::BranchMisses: attr.config = PERF_COUNT_HW_BRANCH_MISSES; break;
+                case Event::L1DMisses: {
+                    attr.type = PERF_TYPE_HW_CACHE;
+                    attr.config = PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+                } break;
+                case Event::LLCMisses: {
+                    attr.type = PERF_TYPE_HW_CACHE;
+                    attr.config = PERF_COUNT_HW_CACHE_LL | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+                } break;
+                case Event::CacheMisses: attr.config = PERF_COUNT_HW_CACHE_MISSES; break;
+            }
+            attr.disabled = fds.empty() ? 1 : 0; // The group is enabled via its leader
+            attr.exclude_kernel = 1;
+            attr.exclude_hv = 1;
+            attr.read_format = PERF_FORMAT_GROUP;
+
+            const int fd = static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, fds.empty() ? -1 : fds.front(), 0));
+            if (fd < 0) {
+                for (const int other: fds) {
+                    close(other);
+                }
+                fds.clear();
+                return;
+            }
+            fds.push_back(fd);
+        }
+        buffer.resize(events.size() + 1);
+#endif
+    }
+
+    ~PerfCounters() {
+#ifdef __linux__
+        for (const int fd: fds) {
+            close(fd);
+        }
+#endif
+    }
+
+    PerfCounters(const PerfCounters&) = delete;
+    PerfCounters& operator=(const PerfCounters&) = delete;
+
+    bool is_available() const {
+        return !fds.empty();
+    }
+
+    static std::string name(Event event) {
+        switch (event) {
+            case Event::Cycles: return "cycles";
+            case Event::Instructions: return "instructions";
+            case Event::BranchMisses: return "branch misses";
+            case Event::L1DMisses: return "L1d misses";
+            case Event::LLCMisses: return "LLC misses";
+            case Event::CacheMisses: return "cache misses";
+        }
+        return "";
+    }
+
+    void start() {
+#ifdef __linux__
+        if (!fds.empty()) {
+            ioctl(fds.front(), PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+            ioctl(fds.front(), PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+        }
+#endif
+    }
+
+    //! Add the number of each event since start to sums, in the order of the events
+    void stop(std::vector<uint64_t>& sums) {
+        sums.resize(events.size());
+#ifdef __linux__
+        if (!fds.empty()) {
+            ioctl(fds.front(), PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+            const auto size = static_cast<ssize_t>(buffer.size() * sizeof(uint64_t));
+            if (read(fds.front(), buffer.data(), buffer.size() * sizeof(uint64_t)) == size) {
+                for (size_t i = 0; i < events.size(); ++i) {
+                    sums[i] += buffer[i + 1];
+                }
+            }
+        }
+#endif
+    }
+};
+
+
+//! Settings of a single benchmark run
+struct Configuration {
+    ControlInterface control_interface {ControlInterface::Position};
+    Synchronization synchronization {Synchronization::Time};
+    DurationDiscretization duration_discretization {DurationDiscretization::Continuous};
+    size_t number_trajectories {16 * 1024};
+};
+
+
+//! Statistics of the calculation duration [µs] over all trajectories of a run
+struct Statistics {
+    std::string algorithm;
+    size_t degrees_of_freedom;
+    bool dynamic_dofs;
+    Configuration configuration;
+
+    size_t number_calculations;
+    double mean, p50, p99, p999, max;
+    double throughput; // [calculations / s]
+};
+
+
+std::string to_string(ControlInterface control_interface) {
+    switch (control_interface) {
+        case ControlInterface::Position: return "position";
+        case ControlInterface::Velocity: return "velocity";
+    }
+    return "";
+}
+
+std::string to_string(Synchronization synchronization) {
+    switch (synchronization) {
+        case Synchronization::Time: return "time";
+        case Synchronization::TimeIfNecessary: return "time_if_necessary";
+        case Synchronization::Phase: return "phase";
+        case Synchronization::None: return "none";
+    }
+    return "";
 }
 
+std::string to_string(DurationDiscretization duration_discretization) {
+    switch (duration_discretization) {
+        case DurationDiscretization::Continuous: return "continuous";
+        case DurationDiscretization::Discrete: return "discrete";
+    }
+    return "";
+}
 
-std::tuple<double, double> analyze(const std::vector<double>& v) {
-    double sum = std::accumulate(v.begin(), v.end(), 0.0);
-    double mean = sum / v.size();
 
-    std::vector<double> diff(v.size());
-    std::transform(v.begin(), v.end(), diff.begin(), [mean](double x) { return x - mean; });
-    double sq_sum = std::inner_product(diff.begin(), diff.end(), diff.begin(), 0.0);
-    double std_deviation = std::sqrt(sq_sum / v.size());
-    return std::make_tuple(mean, std_deviation);
+double percentile(const std::vector<double>& sorted, double q) {
+    const size_t index = static_cast<size_t>(std::ceil(q * sorted.size()));
+    return sorted[std::min(std::max<size_t>(index, 1), sorted.size()) - 1];
 }
 
 
 template<size_t DOFs, class OTGType>
-void benchmark(size_t n, double number_trajectories, bool verbose = true) {
-    OTGType otg {0.005};
+Statistics benchmark(const std::string& algorithm, size_t dofs, const Configuration& configuration) {
+    constexpr bool is_ruckig = std::is_same<OTGType, Ruckig<DOFs, true>>::value;
+
+    OTGType otg = [dofs]() {
+        if constexpr (DOFs == 0) {
+            return OTGType {dofs, 0.005};
+        } else {
+            return OTGType {0.005};
+        }
+    }();
 
+    InputParameter<DOFs> input = [dofs]() {
+        if constexpr (DOFs == 0) {
+            return InputParameter<DOFs> {dofs};
+        } else {
+            return InputParameter<DOFs> {};
+        }
+    }();
+
+    // Keep the distributions of the previous benchmark to stay comparable
     std::normal_distribution<double> position_dist {0.0, 4.0};
     std::normal_distribution<double> dynamic_dist {0.0, 0.8};
     std::uniform_real_distribution<double> limit_dist {0.1, 12.0};
@@ -44,95 +234,1598 @@ void benchmark(size_t n, double number_trajectories, bool verbose = true) {
     Randomizer<DOFs, decltype(dynamic_dist)> d { dynamic_dist, 43 };
     Randomizer<DOFs, decltype(limit_dist)> l { limit_dist, 44 };
 
-    InputParameter<DOFs> input;
-    std::vector<double> average, worst;
+    input.control_interface = configuration.control_interface;
+    input.synchronization = configuration.synchronization;
+    input.duration_discretization = configuration.duration_discretization;
+
+    std::vector<double> durations;
+    durations.reserve(configuration.number_trajectories);
+    double wall_duration {0.0};
+
+    for (size_t i = 0; i < configuration.number_trajectories; ++i) {
+        p.fill(input.current_position);
+        d.fill_or_zero(input.current_velocity, 0.9);
+        d.fill_or_zero(input.current_acceleration, 0.8);
+        p.fill(input.target_position);
+        d.fill_or_zero(input.target_velocity, 0.7);
+        if constexpr (is_ruckig) {
+            d.fill_or_zero(input.target_acceleration, 0.6);
+        }
+
+        l.fill(input.max_velocity, input.target_velocity);
+        l.fill(input.max_acceleration, input.target_acceleration);
+        l.fill(input.max_jerk);
+
+        if constexpr (is_ruckig) {
+            if (!otg.validate_input(input)) {
+                continue;
+            }
+        }
+
+        OutputParameter<DOFs> output = [dofs]() {
+            if constexpr (DOFs == 0) {
+                return OutputParameter<DOFs> {dofs};
+            } else {
+                return OutputParameter<DOFs> {};
+            }
+        }();
+
+        const auto start = std::chrono::high_resolution_clock::now();
+        otg.update(input, output);
+        const auto stop = std::chrono::high_resolution_clock::now();
+
+        wall_duration += std::chrono::duration_cast<std::chrono::nanoseconds>(stop - start).count() / 1000.0;
+        durations.push_back(output.calculation_duration);
+    }
 
-    // Initial warm-up calculation
-    // p.fill(input.current_position);
-    // p.fill(input.target_position);
-    // l.fill(input.max_velocity, input.target_velocity);
-    // l.fill(input.max_acceleration, input.target_acceleration);
-    // l.fill(input.max_jerk);
-    // check_calculation(otg, input);
+    std::sort(durations.begin(), durations.end());
+
+    Statistics statistics;
+    statistics.algorithm = algorithm;
+    statistics.degrees_of_freedom = dofs;
+    statistics.dynamic_dofs = (DOFs == 0);
+    statistics.configuration = configuration;
+    statistics.number_calculations = durations.size();
+    statistics.mean = std::accumulate(durations.begin(), durations.end(), 0.0) / durations.size();
+    statistics.p50 = percentile(durations, 0.5);
+    statistics.p99 = percentile(durations, 0.99);
+    statistics.p999 = percentile(durations, 0.999);
+    statistics.max = durations.back();
+    statistics.throughput = durations.size() / (wall_duration / 1e6);
+    return statistics;
+}
+
+
+//! Number of evaluated Step 1 profile cases with the predicted order vs. the fixed order (for a target at rest)
+void benchmark_case_prediction(size_t number_trajectories) {
+    std::normal_distribution<double> position_dist {0.0, 4.0};
+    std::normal_distribution<double> dynamic_dist {0.0, 0.8};
+    std::uniform_real_distribution<double> limit_dist {0.1, 12.0};
+
+    Randomizer<1, decltype(position_dist)> p { position_dist, 42 };
+    Randomizer<1, decltype(dynamic_dist)> d { dynamic_dist, 43 };
+    Randomizer<1, decltype(limit_dist)> l { limit_dist, 44 };
+
+    std::array<double, 1> p0, v0, a0, pf, vMax, aMax, jMax;
+    size_t predicted {0}, fixed {0}, number {0};
+    for (size_t i = 0; i < number_trajectories; ++i) {
+        p.fill(p0);
+        d.fill_or_zero(v0, 0.9);
+        d.fill_or_zero(a0, 0.8);
+        p.fill(pf);
+        l.fill(vMax, v0);
+        l.fill(aMax, a0);
+        l.fill(jMax);
+
+        PositionStep1 step1 {p0[0], v0[0], a0[0], pf[0], 0.0, 0.0, vMax[0], -vMax[0], aMax[0], -aMax[0], jMax[0]};
+        Block block;
+        if (!step1.get_profile(Profile(), block) || step1.number_evaluated_cases == 0) {
+            continue;
+        }
+
+        // Position of the found case in the fixed order: all_vel, none, acc0, acc1, acc0_acc1 (first up, then down)
+        size_t index {1};
+        switch (block.get_min_profile().limits) {
+            case Profile::Limits::NONE: index = 2; break;
+            case Profile::Limits::ACC0: index = 3; break;
+            case Profile::Limits::ACC1: index = 4; break;
+            case Profile::Limits::ACC0_ACC1: index = 5; break;
+            default: break;
+        }
+        const bool is_down = (block.get_min_profile().direction == Profile::Direction::UP) != (pf[0] - p0[0] >= 0);
+        fixed += is_down ? index + 5 : index;
+        predicted += step1.number_evaluated_cases;
+        ++number;
+    }
+
+    std::cout << "Step 1 cases evaluated per target at rest: " << static_cast<double>(predicted) / number << " predicted vs. " << static_cast<double>(fixed) / number << " fixed order" << std::endl;
+}
 
-    for (size_t j = 0; j < n; ++j) {
-        double average_ = 0.0;
-        double worst_ = 0.0;
-        size_t n {1};
 
+//! Mean duration [µs] of only the synchronization phase for a high number of DoFs
+void benchmark_synchronization(size_t number_trajectories) {
+    std::normal_distribution<double> position_dist {0.0, 4.0};
+    std::normal_distribution<double> dynamic_dist {0.0, 0.8};
+    std::uniform_real_distribution<double> limit_dist {0.1, 12.0};
+
+    for (const size_t dofs: {6, 32, 64, 128}) {
+        Randomizer<0, decltype(position_dist)> p { position_dist, 42 };
+        Randomizer<0, decltype(dynamic_dist)> d { dynamic_dist, 43 };
+        Randomizer<0, decltype(limit_dist)> l { limit_dist, 44 };
+
+        Ruckig<0> otg {dofs, 0.005};
+        InputParameter<0> input {dofs};
+        Trajectory<0> trajectory {dofs};
+        CalculationTiming<0> timing {dofs};
+
+        double sum {0.0};
+        size_t number {0};
         for (size_t i = 0; i < number_trajectories; ++i) {
             p.fill(input.current_position);
             d.fill_or_zero(input.current_velocity, 0.9);
             d.fill_or_zero(input.current_acceleration, 0.8);
             p.fill(input.target_position);
             d.fill_or_zero(input.target_velocity, 0.7);
-            if constexpr (std::is_same<OTGType, Ruckig<DOFs, true>>::value) {
+            d.fill_or_zero(input.target_acceleration, 0.6);
+            l.fill(input.max_velocity, input.target_velocity);
+            l.fill(input.max_acceleration, input.target_acceleration);
+            l.fill(input.max_jerk);
+
+            bool was_interrupted {false};
+            if (otg.calculate(input, trajectory, was_interrupted, timing) == Result::Working) {
+                sum += timing.synchronization;
+                ++number;
+            }
+        }
+
+        std::cout << "Synchronization of " << dofs << " DoFs: mean " << sum / number << " [µs]" << std::endl;
+    }
+}
+
+
+//! Mean calculation duration [µs] with the DoFs split across a worker pool
+void benchmark_worker_pool(size_t number_trajectories) {
+    std::normal_distribution<double> position_dist {0.0, 4.0};
+    std::normal_distribution<double> dynamic_dist {0.0, 0.8};
+    std::uniform_real_distribution<double> limit_dist {0.1, 12.0};
+
+    const size_t max_threads = std::min<size_t>(16, std::max<unsigned>(std::thread::hardware_concurrency(), 1));
+    for (const size_t dofs: {32, 128}) {
+        for (size_t number_threads = 1; number_threads <= max_threads; number_threads *= 2) {
+            Randomizer<0, decltype(position_dist)> p { position_dist, 42 };
+            Randomizer<0, decltype(dynamic_dist)> d { dynamic_dist, 43 };
+            Randomizer<0, decltype(limit_dist)> l { limit_dist, 44 };
+
+            WorkerPool pool {number_threads - 1};
+            Ruckig<0> otg {dofs, 0.005};
+            otg.worker_pool = &pool;
+            InputParameter<0> input {dofs};
+            Trajectory<0> trajectory {dofs};
+
+            double sum {0.0};
+            size_t number {0};
+            for (size_t i = 0; i < number_trajectories; ++i) {
+                p.fill(input.current_position);
+                d.fill_or_zero(input.current_velocity, 0.9);
+                d.fill_or_zero(input.current_acceleration, 0.8);
+                p.fill(input.target_position);
+                d.fill_or_zero(input.target_velocity, 0.7);
                 d.fill_or_zero(input.target_acceleration, 0.6);
+                l.fill(input.max_velocity, input.target_velocity);
+                l.fill(input.max_acceleration, input.target_acceleration);
+                l.fill(input.max_jerk);
+
+                const auto start = std::chrono::high_resolution_clock::now();
+                const Result result = otg.calculate(input, trajectory);
+                const auto stop = std::chrono::high_resolution_clock::now();
+                if (result == Result::Working) {
+                    sum += std::chrono::duration_cast<std::chrono::nanoseconds>(stop - start).count() / 1000.0;
+                    ++number;
+                }
             }
 
+            std::cout << dofs << " DoFs on " << number_threads << " threads: mean " << sum / number << " [µs]" << std::endl;
+        }
+    }
+}
+
+
+//! Mean and maximal duration [µs] of 7-DoF calculations on a worker pool, with Step 2 of the following synchronization
+//! candidates calculated speculatively or not
+void benchmark_speculative_candidates(size_t number_trajectories) {
+    std::normal_distribution<double> position_dist {0.0, 4.0};
+    std::normal_distribution<double> dynamic_dist {0.0, 0.8};
+    std::uniform_real_distribution<double> limit_dist {0.1, 12.0};
+
+    WorkerPool pool {3};
+    for (const size_t speculative_candidates: {1, 4}) {
+        Randomizer<7, decltype(position_dist)> p { position_dist, 42 };
+        Randomizer<7, decltype(dynamic_dist)> d { dynamic_dist, 43 };
+        Randomizer<7, decltype(limit_dist)> l { limit_dist, 44 };
+
+        Ruckig<7> otg {0.005};
+        otg.worker_pool = &pool;
+        InputParameter<7> input;
+        input.speculative_candidates = speculative_candidates;
+        Trajectory<7> trajectory;
+
+        double sum {0.0}, max {0.0};
+        size_t number {0}, number_errors {0};
+        for (size_t i = 0; i < number_trajectories; ++i) {
+            p.fill(input.current_position);
+            d.fill_or_zero(input.current_velocity, 0.9);
+            d.fill_or_zero(input.current_acceleration, 0.8);
+            p.fill(input.target_position);
+            d.fill_or_zero(input.target_velocity, 0.7);
+            d.fill_or_zero(input.target_acceleration, 0.6);
             l.fill(input.max_velocity, input.target_velocity);
             l.fill(input.max_acceleration, input.target_acceleration);
             l.fill(input.max_jerk);
+            if (!otg.validate_input(input)) {
+                continue;
+            }
+
+            const auto start = std::chrono::high_resolution_clock::now();
+            const Result result = otg.calculate(input, trajectory);
+            const auto stop = std::chrono::high_resolution_clock::now();
+            if (result != Result::Working) {
+                ++number_errors;
+                continue;
+            }
+
+            const double duration = std::chrono::duration_cast<std::chrono::nanoseconds>(stop - start).count() / 1000.0;
+            sum += duration;
+            max = std::max(max, duration);
+            ++number;
+        }
+
+        std::cout << speculative_candidates << " synchronization candidates in Step 2 on 4 threads: mean " << sum / number << "  max " << max << " [µs] (" << number_errors << " errors)" << std::endl;
+    }
+}
+
+//! Throughput of the minimal durations of many 7-DoF candidates with the CandidateBatch, on increasing numbers of threads
+void benchmark_candidate_batch(size_t number_candidates) {
+    constexpr size_t DOFs {7};
+    std::normal_distribution<double> position_dist {0.0, 4.0};
+    std::normal_distribution<double> dynamic_dist {0.0, 0.8};
+    std::uniform_real_distribution<double> limit_dist {0.1, 12.0};
+    Randomizer<DOFs, decltype(position_dist)> p { position_dist, 42 };
+    Randomizer<DOFs, decltype(dynamic_dist)> d { dynamic_dist, 43 };
+    Randomizer<DOFs, decltype(limit_dist)> l { limit_dist, 44 };
+
+    CandidateBatch<DOFs> batch {number_candidates};
+    InputParameter<DOFs> input;
+    for (size_t candidate = 0; candidate < number_candidates; ++candidate) {
+        p.fill(input.current_position);
+        d.fill_or_zero(input.current_velocity, 0.9);
+        p.fill(input.target_position);
+        l.fill(input.max_velocity, input.current_velocity);
+        l.fill(input.max_acceleration);
+        l.fill(input.max_jerk);
+
+        for (size_t dof = 0; dof < DOFs; ++dof) {
+            const size_t i = dof * number_candidates + candidate;
+            batch.current_positions[i] = input.current_position[dof];
+            batch.current_velocities[i] = input.current_velocity[dof];
+            batch.current_accelerations[i] = 0.0;
+            batch.target_positions[i] = input.target_position[dof];
+            batch.target_velocities[i] = 0.0;
+            batch.target_accelerations[i] = 0.0;
+            batch.max_velocities[i] = input.max_velocity[dof];
+            batch.max_accelerations[i] = input.max_acceleration[dof];
+            batch.max_jerks[i] = input.max_jerk[dof];
+        }
+    }
+
+    const size_t max_threads = std::min<size_t>(16, std::max<unsigned>(std::thread::hardware_concurrency(), 1));
+    for (size_t number_threads = 1; number_threads <= max_threads; number_threads *= 2) {
+        WorkerPool pool {number_threads - 1};
+        batch.worker_pool = &pool;
+
+        const auto start = std::chrono::high_resolution_clock::now();
+        batch.evaluate();
+        const auto stop = std::chrono::high_resolution_clock::now();
+        const double seconds = std::chrono::duration<double>(stop - start).count();
+        const size_t number_valid = std::count(batch.results.begin(), batch.results.end(), Result::Working);
+
+        std::cout << number_candidates << " candidates on " << number_threads << " threads: " << number_candidates / seconds / 1e6 << " [M/s] (" << number_valid << " valid)" << std::endl;
+    }
+}
+
+
+//! Mean duration [µs] of a control cycle of many 3-DoF instances, separately and with BatchRuckig
+void benchmark_batch_ruckig(size_t number_cycles) {
+    std::normal_distribution<double> position_dist {0.0, 4.0};
+    std::uniform_real_distribution<double> limit_dist {0.1, 12.0};
+
+    constexpr size_t number_instances {200};
+    Randomizer<3, decltype(position_dist)> p { position_dist, 42 };
+    Randomizer<3, decltype(limit_dist)> l { limit_dist, 44 };
+
+    std::vector<InputParameter<3>> inputs(number_instances);
+    for (auto& input: inputs) {
+        p.fill(input.current_position);
+        p.fill(input.target_position);
+        l.fill(input.max_velocity);
+        l.fill(input.max_acceleration);
+        l.fill(input.max_jerk);
+    }
+    auto batch_inputs = inputs;
+
+    std::vector<Ruckig<3>> otgs(number_instances, Ruckig<3> {0.001});
+    std::vector<OutputParameter<3>> outputs(number_instances);
+    BatchRuckig<3> batch {number_instances, 0.001};
+
+    double sum_separate {0.0}, sum_batch {0.0};
+    for (size_t cycle = 0; cycle < number_cycles; ++cycle) {
+        // Retarget one instance per cycle
+        p.fill(inputs[cycle % number_instances].target_position);
+        batch_inputs[cycle % number_instances].target_position = inputs[cycle % number_instances].target_position;
+
+        auto start = std::chrono::high_resolution_clock::now();
+        for (size_t i = 0; i < number_instances; ++i) {
+            otgs[i].update(inputs[i], outputs[i]);
+            outputs[i].pass_to_input(inputs[i]);
+        }
+        auto stop = std::chrono::high_resolution_clock::now();
+        sum_separate += std::chrono::duration_cast<std::chrono::nanoseconds>(stop - start).count() / 1000.0;
+
+        start = std::chrono::high_resolution_clock::now();
+        batch.update_all(batch_inputs);
+        for (size_t i = 0; i < number_instances; ++i) {
+            batch.pass_to_input(i, batch_inputs[i]);
+        }
+        stop = std::chrono::high_resolution_clock::now();
+        sum_batch += std::chrono::duration_cast<std::chrono::nanoseconds>(stop - start).count() / 1000.0;
+    }
+
+    std::cout << number_instances << " instances separately: mean " << sum_separate / number_cycles << " [µs] per cycle" << std::endl;
+    std::cout << number_instances << " instances with BatchRuckig: mean " << sum_batch / number_cycles << " [µs] per cycle" << std::endl;
+}
+
+
+//! Mean duration [ns] per sample of a 6-DoF trajectory, with at_time and with the incremental sampler
+void benchmark_sampler(size_t number_trajectories) {
+    std::normal_distribution<double> position_dist {0.0, 4.0};
+    std::uniform_real_distribution<double> limit_dist {0.1, 12.0};
+
+    Randomizer<6, decltype(position_dist)> p { position_dist, 42 };
+    Randomizer<6, decltype(limit_dist)> l { limit_dist, 44 };
+
+    Ruckig<6> otg;
+    InputParameter<6> input;
+    Trajectory<6> trajectory;
+    std::array<double, 6> new_position, new_velocity, new_acceleration;
+
+    double sum_at_time {0.0}, sum_sampler {0.0}, checksum {0.0};
+    size_t number_samples {0};
+    for (size_t i = 0; i < number_trajectories; ++i) {
+        p.fill(input.current_position);
+        p.fill(input.target_position);
+        l.fill(input.max_velocity);
+        l.fill(input.max_acceleration);
+        l.fill(input.max_jerk);
+        if (otg.calculate(input, trajectory) != Result::Working) {
+            continue;
+        }
+
+        auto sampler = trajectory.sample(0.001);
+        const size_t size = sampler.size();
+
+        auto start = std::chrono::high_resolution_clock::now();
+        for (size_t j = 0; j < size; ++j) {
+            trajectory.at_time(std::min(j * 0.001, trajectory.get_duration()), new_position, new_velocity, new_acceleration);
+            checksum += new_position[0];
+        }
+        auto stop = std::chrono::high_resolution_clock::now();
+        sum_at_time += std::chrono::duration_cast<std::chrono::nanoseconds>(stop - start).count();
+
+        start = std::chrono::high_resolution_clock::now();
+        for (const auto& sample: sampler) {
+            checksum -= sample.position[0];
+        }
+        stop = std::chrono::high_resolution_clock::now();
+        sum_sampler += std::chrono::duration_cast<std::chrono::nanoseconds>(stop - start).count();
+        number_samples += size;
+    }
+
+    std::cout << "Sampling with at_time: mean " << sum_at_time / number_samples << " [ns] per sample" << std::endl;
+    std::cout << "Sampling with TrajectorySampler: mean " << sum_sampler / number_samples << " [ns] per sample (checksum " << checksum << ")" << std::endl;
+}
+
+
+//! Time per sample [ns] of dense sampling of a single long 6-DoF trajectory into arrays, on increasing numbers of threads
+void benchmark_parallel_sampling() {
+    Ruckig<6> otg;
+    InputParameter<6> input;
+    Trajectory<6> trajectory;
+    input.current_position = {0.0, 0.0, 0.0, 0.0, 0.0, 0.0};
+    input.target_position = {400.0, -300.0, 250.0, 100.0, -50.0, 20.0};
+    input.max_velocity = {0.5, 0.5, 0.5, 0.5, 0.5, 0.5};
+    input.max_acceleration = {0.2, 0.2, 0.2, 0.2, 0.2, 0.2};
+    input.max_jerk = {0.1, 0.1, 0.1, 0.1, 0.1, 0.1};
+    if (otg.calculate(input, trajectory) != Result::Working) {
+        return;
+    }
+
+    constexpr double delta_time {0.0001};
+    const size_t size = trajectory.number_samples(delta_time);
+    std::vector<double> positions(size * 6), velocities(size * 6), accelerations(size * 6);
+
+    const size_t max_threads = std::min<size_t>(16, std::max<unsigned>(std::thread::hardware_concurrency(), 1));
+    for (size_t number_threads = 1; number_threads <= max_threads; number_threads *= 2) {
+        WorkerPool pool {number_threads - 1};
+
+        const auto start = std::chrono::high_resolution_clock::now();
+        trajectory.sample_into(delta_time, positions.data(), velocities.data(), accelerations.data(), &pool);
+        const auto stop = std::chrono::high_resolution_clock::now();
+        const double sum = std::chrono::duration_cast<std::chrono::nanoseconds>(stop - start).count();
+
+        std::cout << "Sampling " << size << " samples (" << trajectory.get_duration() << " [s]) on " << number_threads << " threads: mean " << sum / size << " [ns] per sample (checksum " << positions[size * 3] << ")" << std::endl;
+    }
+}
+
+
+//! Sampling duration [ns] of 32 DoFs at arbitrary times, with at_time vs. the structure-of-arrays segment table
+void benchmark_segment_table(size_t number_trajectories) {
+    constexpr size_t DOFs {32};
+    std::normal_distribution<double> position_dist {0.0, 4.0};
+    std::uniform_real_distribution<double> limit_dist {0.1, 12.0};
+    std::uniform_real_distribution<double> time_dist {0.0, 1.0};
+    std::default_random_engine time_gen {45};
+
+    Randomizer<DOFs, decltype(position_dist)> p { position_dist, 42 };
+    Randomizer<DOFs, decltype(limit_dist)> l { limit_dist, 44 };
+
+    Ruckig<DOFs> otg;
+    InputParameter<DOFs> input;
+    Trajectory<DOFs> trajectory;
+    TrajectorySegmentTable<DOFs> table;
+    std::array<double, DOFs> new_position, new_velocity, new_acceleration;
+    std::vector<double> times(256);
+
+    double sum_at_time {0.0}, sum_table {0.0}, checksum {0.0};
+    size_t number_samples {0};
+    for (size_t i = 0; i < number_trajectories; ++i) {
+        p.fill(input.current_position);
+        p.fill(input.target_position);
+        l.fill(input.max_velocity);
+        l.fill(input.max_acceleration);
+        l.fill(input.max_jerk);
+        if (otg.calculate(input, trajectory) != Result::Working) {
+            continue;
+        }
+
+        for (double& time: times) {
+            time = time_dist(time_gen) * trajectory.get_duration();
+        }
+
+        auto start = std::chrono::high_resolution_clock::now();
+        for (const double time: times) {
+            trajectory.at_time(time, new_position, new_velocity, new_acceleration);
+            checksum += new_position[0];
+        }
+        auto stop = std::chrono::high_resolution_clock::now();
+        sum_at_time += std::chrono::duration_cast<std::chrono::nanoseconds>(stop - start).count();
+
+        // Including the copy into the table
+        start = std::chrono::high_resolution_clock::now();
+        table.assign(trajectory);
+        for (const double time: times) {
+            table.at_time(time, new_position, new_velocity, new_acceleration);
+            checksum -= new_position[0];
+        }
+        stop = std::chrono::high_resolution_clock::now();
+        sum_table += std::chrono::duration_cast<std::chrono::nanoseconds>(stop - start).count();
+        number_samples += times.size();
+    }
+
+    std::cout << "Sampling " << DOFs << " DoFs with at_time: mean " << sum_at_time / number_samples << " [ns] per sample" << std::endl;
+    std::cout << "Sampling " << DOFs << " DoFs with TrajectorySegmentTable: mean " << sum_table / number_samples << " [ns] per sample (checksum " << checksum << ")" << std::endl;
+}
+
+//! Duration [ns] of an update cycle of 32 DoFs that only samples the calculated trajectory, with and without the
+//! precomputed segment coefficients
+void benchmark_update_sampling(size_t number_trajectories) {
+    constexpr size_t DOFs {32};
+    std::normal_distribution<double> position_dist {0.0, 4.0};
+    std::uniform_real_distribution<double> limit_dist {0.1, 12.0};
+
+    for (const bool precalculate: {false, true}) {
+        Randomizer<DOFs, decltype(position_dist)> p { position_dist, 42 };
+        Randomizer<DOFs, decltype(limit_dist)> l { limit_dist, 44 };
+
+        Ruckig<DOFs> otg {0.001};
+        otg.precalculate_segment_coefficients = precalculate;
+        InputParameter<DOFs> input;
+        OutputParameter<DOFs> output;
+
+        double sum_update {0.0}, checksum {0.0};
+        size_t number_cycles {0};
+        for (size_t i = 0; i < number_trajectories; ++i) {
+            p.fill(input.current_position);
+            p.fill(input.target_position);
+            l.fill(input.max_velocity);
+            l.fill(input.max_acceleration);
+            l.fill(input.max_jerk);
+            input.current_velocity.fill(0.0);
+            input.current_acceleration.fill(0.0);
+            if (otg.update(input, output) != Result::Working) {
+                continue;
+            }
+            output.pass_to_input(input);
+
+            const auto start = std::chrono::high_resolution_clock::now();
+            while (otg.update(input, output) == Result::Working) {
+                output.pass_to_input(input);
+                ++number_cycles;
+            }
+            const auto stop = std::chrono::high_resolution_clock::now();
+            sum_update += std::chrono::duration_cast<std::chrono::nanoseconds>(stop - start).count();
+            checksum += output.new_position[0];
+        }
+
+        std::cout << "Update of " << DOFs << " DoFs without recalculation" << (precalculate ? ", precomputed segment coefficients" : "") << ": mean " << sum_update / number_cycles << " [ns] per cycle (checksum " << checksum << ")" << std::endl;
+    }
+}
+
+//! Mean duration [ns] of an update of an idle axis, i.e. after its trajectory finished at rest
+void benchmark_idle(size_t number_cycles) {
+    constexpr size_t number_axes {400};
+
+    for (const ChangeDetection change_detection: {ChangeDetection::Full, ChangeDetection::Generation}) {
+        std::vector<Ruckig<1>> otgs(number_axes, Ruckig<1> {0.001});
+        std::vector<InputParameter<1>> inputs(number_axes);
+        std::vector<OutputParameter<1>> outputs(number_axes);
+        for (size_t i = 0; i < number_axes; ++i) {
+            inputs[i].change_detection = change_detection;
+            inputs[i].target_position = {0.001 * i};
+            inputs[i].max_velocity = {1.0};
+            inputs[i].max_acceleration = {1.0};
+            inputs[i].max_jerk = {1.0};
+            while (otgs[i].update(inputs[i], outputs[i]) == Result::Working) {
+                outputs[i].pass_to_input(inputs[i]);
+            }
+            outputs[i].pass_to_input(inputs[i]);
+        }
+
+        double checksum {0.0};
+        const auto start = std::chrono::high_resolution_clock::now();
+        for (size_t cycle = 0; cycle < number_cycles; ++cycle) {
+            for (size_t i = 0; i < number_axes; ++i) {
+                otgs[i].update(inputs[i], outputs[i]);
+                outputs[i].pass_to_input(inputs[i]);
+            }
+            checksum += outputs[cycle % number_axes].new_position[0];
+        }
+        const auto stop = std::chrono::high_resolution_clock::now();
+        const double duration = std::chrono::duration_cast<std::chrono::nanoseconds>(stop - start).count();
+
+        std::cout << "Update of " << number_axes << " idle axes" << ((change_detection == ChangeDetection::Generation) ? ", generation-based change detection" : "") << ": mean " << duration / (number_cycles * number_axes) << " [ns] per axis (checksum " << checksum << ")" << std::endl;
+    }
+}
+
+//! Calculation duration [µs] of a stop trajectory, closed-form vs. with the velocity interface
+void benchmark_stop(size_t number_trajectories) {
+    std::normal_distribution<double> position_dist {0.0, 4.0};
+    std::normal_distribution<double> dynamic_dist {0.0, 0.8};
+    std::uniform_real_distribution<double> limit_dist {0.1, 12.0};
+    Randomizer<6, decltype(position_dist)> p { position_dist, 42 };
+    Randomizer<6, decltype(dynamic_dist)> d { dynamic_dist, 43 };
+    Randomizer<6, decltype(limit_dist)> l { limit_dist, 44 };
+
+    Ruckig<6> otg {0.005};
+    InputParameter<6> input, velocity_input;
+    Trajectory<6> trajectory;
+
+    double sum_stop {0.0}, max_stop {0.0}, sum_velocity {0.0}, max_velocity {0.0};
+    for (size_t i = 0; i < number_trajectories; ++i) {
+        p.fill(input.current_position);
+        d.fill_or_zero(input.current_velocity, 0.9);
+        d.fill_or_zero(input.current_acceleration, 0.8);
+        l.fill(input.max_acceleration);
+        l.fill(input.max_jerk);
+        velocity_input = input;
+        velocity_input.control_interface = ControlInterface::Velocity;
+
+        // The minimum of a few repetitions, so that the maximum reflects the input instead of the scheduler
+        double duration_stop {std::numeric_limits<double>::infinity()}, duration_velocity {std::numeric_limits<double>::infinity()};
+        for (size_t repetition = 0; repetition < 5; ++repetition) {
+            auto start = std::chrono::steady_clock::now();
+            otg.calculate_stop(input, trajectory);
+            auto stop = std::chrono::steady_clock::now();
+            duration_stop = std::min(duration_stop, std::chrono::duration<double, std::micro>(stop - start).count());
+
+            start = std::chrono::steady_clock::now();
+            otg.calculate(velocity_input, trajectory);
+            stop = std::chrono::steady_clock::now();
+            duration_velocity = std::min(duration_velocity, std::chrono::duration<double, std::micro>(stop - start).count());
+        }
+
+        sum_stop += duration_stop;
+        max_stop = std::max(max_stop, duration_stop);
+        sum_velocity += duration_velocity;
+        max_velocity = std::max(max_velocity, duration_velocity);
+    }
+
+    std::cout << "Stop with calculate_stop: mean " << sum_stop / number_trajectories << "  max " << max_stop << " [µs]" << std::endl;
+    std::cout << "Stop with the velocity interface: mean " << sum_velocity / number_trajectories << "  max " << max_velocity << " [µs]" << std::endl;
+}
+
+//! Mean duration [ns] of the input validation, with the limits validated each time or registered once
+void benchmark_validation(size_t number_inputs) {
+    std::normal_distribution<double> position_dist {0.0, 4.0};
+    std::normal_distribution<double> dynamic_dist {0.0, 0.8};
+    std::uniform_real_distribution<double> limit_dist {0.1, 12.0};
+    Randomizer<7, decltype(position_dist)> p { position_dist, 42 };
+    Randomizer<7, decltype(dynamic_dist)> d { dynamic_dist, 43 };
+    Randomizer<7, decltype(limit_dist)> l { limit_dist, 44 };
+
+    InputParameter<7> input;
+    l.fill(input.max_velocity);
+    l.fill(input.max_acceleration);
+    l.fill(input.max_jerk);
 
-            if constexpr (std::is_same<OTGType, Ruckig<DOFs, true>>::value) {
-                if (!otg.validate_input(input)) {
-                    continue;
+    std::vector<InputParameter<7>> inputs(number_inputs, input);
+    for (auto& state: inputs) {
+        p.fill(state.current_position);
+        d.fill_or_zero(state.current_velocity, 0.9);
+        p.fill(state.target_position);
+        d.fill_or_zero(state.target_velocity, 0.5);
+        d.fill_or_zero(state.target_acceleration, 0.5);
+    }
+
+    Ruckig<7> otg {0.005};
+    for (const bool registered: {false, true}) {
+        if (registered) {
+            otg.register_limits(input);
+        }
+
+        size_t number_valid {0};
+        const auto start = std::chrono::steady_clock::now();
+        for (const auto& state: inputs) {
+            number_valid += otg.validate_input(state);
+        }
+        const auto stop = std::chrono::steady_clock::now();
+
+        const double duration = std::chrono::duration<double, std::nano>(stop - start).count();
+        std::cout << "Validation of 7 DoFs" << (registered ? " with registered limits" : "") << ": mean " << duration / number_inputs << " [ns] (" << number_valid << " valid)" << std::endl;
+    }
+}
+
+struct FixedAxisLimits {
+    static constexpr double max_velocity {3.0};
+    static constexpr double max_acceleration {5.0};
+    static constexpr double max_jerk {12.0};
+};
+
+//! Mean duration [µs] of the validation and calculation of 7 DoFs, with the limits of the input or known at compile-time
+template<class Limits>
+void benchmark_constant_limits(size_t number_trajectories) {
+    std::normal_distribution<double> position_dist {0.0, 4.0};
+    std::normal_distribution<double> dynamic_dist {0.0, 0.8};
+    Randomizer<7, decltype(position_dist)> p { position_dist, 42 };
+    Randomizer<7, decltype(dynamic_dist)> d { dynamic_dist, 43 };
+
+    Ruckig<7, false, true, 0, Instrumentation::Duration, Features::All, Limits> otg {0.005};
+    InputParameter<7> input;
+    input.set_limits<FixedAxisLimits>();
+    Trajectory<7> trajectory;
+
+    double duration {0.0};
+    for (size_t i = 0; i < number_trajectories; ++i) {
+        p.fill(input.current_position);
+        d.fill_or_zero(input.current_velocity, 0.9);
+        p.fill(input.target_position);
+        d.fill_or_zero(input.target_velocity, 0.5);
+
+        const auto start = std::chrono::steady_clock::now();
+        if (otg.validate_input(input)) {
+            otg.calculate(input, trajectory);
+        }
+        const auto stop = std::chrono::steady_clock::now();
+        duration += std::chrono::duration<double, std::micro>(stop - start).count();
+    }
+
+    std::cout << "Calculation of 7 DoFs with " << (has_constant_limits<Limits> ? "constant" : "runtime") << " limits: mean " << duration / number_trajectories << " [µs]" << std::endl;
+}
+
+//! Share and mean duration [µs] of retargeted trajectories for small target changes (±1mm) at different progress
+void benchmark_retargeting(size_t number_trajectories) {
+    std::normal_distribution<double> position_dist {0.0, 4.0};
+    std::uniform_real_distribution<double> limit_dist {0.1, 12.0};
+    std::uniform_real_distribution<double> change_dist {-1e-3, 1e-3};
+    Randomizer<6, decltype(position_dist)> p { position_dist, 42 };
+    Randomizer<6, decltype(limit_dist)> l { limit_dist, 44 };
+    Randomizer<6, decltype(change_dist)> c { change_dist, 45 };
+
+    Ruckig<6> otg {0.005};
+    InputParameter<6> input, changed;
+    Trajectory<6> trajectory, retargeted;
+    std::array<double, 6> change;
+
+    for (const double progress: {0.05, 0.2, 0.5}) {
+        size_t number_retargeted {0};
+        double sum_retarget {0.0}, sum_calculate {0.0};
+        for (size_t i = 0; i < number_trajectories; ++i) {
+            p.fill(input.current_position);
+            p.fill(input.target_position);
+            l.fill(input.max_velocity);
+            l.fill(input.max_acceleration);
+            l.fill(input.max_jerk);
+            c.fill(change);
+            if (otg.calculate(input, trajectory) != Result::Working) {
+                continue;
+            }
+
+            const double time = progress * trajectory.get_duration();
+            changed = input;
+            trajectory.at_time(time, changed.current_position, changed.current_velocity, changed.current_acceleration);
+            for (size_t dof = 0; dof < 6; ++dof) {
+                changed.target_position[dof] += change[dof];
+            }
+
+            double duration_retarget {std::numeric_limits<double>::infinity()}, duration_calculate {std::numeric_limits<double>::infinity()};
+            bool is_retargeted {false};
+            for (size_t repetition = 0; repetition < 5; ++repetition) {
+                auto start = std::chrono::steady_clock::now();
+                is_retargeted = retargeted.calculate_retarget(trajectory, time, changed);
+                auto stop = std::chrono::steady_clock::now();
+                duration_retarget = std::min(duration_retarget, std::chrono::duration<double, std::micro>(stop - start).count());
+
+                start = std::chrono::steady_clock::now();
+                otg.calculate(changed, retargeted);
+                stop = std::chrono::steady_clock::now();
+                duration_calculate = std::min(duration_calculate, std::chrono::duration<double, std::micro>(stop - start).count());
+            }
+
+            if (is_retargeted) {
+                number_retargeted += 1;
+                sum_retarget += duration_retarget;
+                sum_calculate += duration_calculate;
+            }
+        }
+
+        std::cout << "Retargeting at " << 100 * progress << "% of the trajectory: " << 100.0 * number_retargeted / number_trajectories << "% retargeted, mean " << sum_retarget / std::max<size_t>(number_retargeted, 1) << " [µs] instead of " << sum_calculate / std::max<size_t>(number_retargeted, 1) << " [µs]" << std::endl;
+    }
+}
+
+//! Calculation and update duration [µs] of the velocity-only VelocityRuckig compared to Ruckig with the velocity interface
+void benchmark_velocity_ruckig(size_t number_trajectories) {
+    std::normal_distribution<double> dynamic_dist {0.0, 0.8};
+    std::uniform_real_distribution<double> limit_dist {0.1, 12.0};
+    Randomizer<6, decltype(dynamic_dist)> d { dynamic_dist, 42 };
+    Randomizer<6, decltype(limit_dist)> l { limit_dist, 43 };
+
+    Ruckig<6> otg {0.005};
+    VelocityRuckig<6> velocity_otg {0.005};
+    InputParameter<6> input;
+    input.control_interface = ControlInterface::Velocity;
+    OutputParameter<6> output;
+    VelocityOutputParameter<6> velocity_output;
+
+    double sum_ruckig {0.0}, max_ruckig {0.0}, sum_velocity {0.0}, max_velocity {0.0};
+    double sum_update_ruckig {0.0}, sum_update_velocity {0.0};
+    size_t number_updates {0};
+    for (size_t i = 0; i < number_trajectories; ++i) {
+        d.fill(input.current_velocity);
+        d.fill_or_zero(input.current_acceleration, 0.8);
+        d.fill(input.target_velocity);
+        l.fill(input.max_acceleration, input.current_acceleration);
+        l.fill(input.max_jerk);
+
+        // The minimum of a few repetitions, so that the maximum reflects the input instead of the scheduler
+        double duration_ruckig {std::numeric_limits<double>::infinity()}, duration_velocity {std::numeric_limits<double>::infinity()};
+        for (size_t repetition = 0; repetition < 5; ++repetition) {
+            Trajectory<6> trajectory; // Without the Step 1 results of the previous repetition
+
+            auto start = std::chrono::steady_clock::now();
+            otg.calculate(input, trajectory);
+            auto stop = std::chrono::steady_clock::now();
+            duration_ruckig = std::min(duration_ruckig, std::chrono::duration<double, std::micro>(stop - start).count());
+
+            start = std::chrono::steady_clock::now();
+            velocity_otg.calculate(input);
+            stop = std::chrono::steady_clock::now();
+            duration_velocity = std::min(duration_velocity, std::chrono::duration<double, std::micro>(stop - start).count());
+        }
+
+        sum_ruckig += duration_ruckig;
+        max_ruckig = std::max(max_ruckig, duration_ruckig);
+        sum_velocity += duration_velocity;
+        max_velocity = std::max(max_velocity, duration_velocity);
+
+        // A few control cycles including the calculation in the first one
+        InputParameter<6> ruckig_input {input}, velocity_input {input};
+        for (size_t cycle = 0; cycle < 16; ++cycle) {
+            otg.update(ruckig_input, output);
+            output.pass_to_input(ruckig_input);
+            sum_update_ruckig += output.calculation_duration;
+
+            velocity_otg.update(velocity_input, velocity_output);
+            velocity_output.pass_to_input(velocity_input);
+            sum_update_velocity += velocity_output.calculation_duration;
+            ++number_updates;
+        }
+    }
+
+    std::cout << "Ruckig with the velocity interface: sizeof " << sizeof(otg) + sizeof(output) << " [B]  calculation mean " << sum_ruckig / number_trajectories << "  max " << max_ruckig << "  update mean " << sum_update_ruckig / number_updates << " [µs]" << std::endl;
+    std::cout << "VelocityRuckig: sizeof " << sizeof(velocity_otg) + sizeof(velocity_output) << " [B]  calculation mean " << sum_velocity / number_trajectories << "  max " << max_velocity << "  update mean " << sum_update_velocity / number_updates << " [µs]" << std::endl;
+}
+
+//! Duration [µs] of a feed-rate override by time-scaling the trajectory compared to a recalculation with scaled limits
+void benchmark_time_scaling(size_t number_trajectories) {
+    std::normal_distribution<double> position_dist {0.0, 4.0};
+    std::uniform_real_distribution<double> limit_dist {0.1, 12.0};
+    Randomizer<6, decltype(position_dist)> p { position_dist, 42 };
+    Randomizer<6, decltype(limit_dist)> l { limit_dist, 43 };
+
+    Ruckig<6> otg {0.005};
+    InputParameter<6> input, scaled_input;
+    Trajectory<6> trajectory;
+    constexpr double factor {0.7};
+
+    double sum_recalculation {0.0}, sum_scaling {0.0};
+    for (size_t i = 0; i < number_trajectories; ++i) {
+        p.fill(input.current_position);
+        p.fill(input.target_position);
+        l.fill(input.max_velocity);
+        l.fill(input.max_acceleration);
+        l.fill(input.max_jerk);
+        otg.calculate(input, trajectory);
+
+        scaled_input = input;
+        for (size_t dof = 0; dof < 6; ++dof) {
+            scaled_input.max_velocity[dof] *= factor;
+            scaled_input.max_acceleration[dof] *= factor * factor;
+            scaled_input.max_jerk[dof] *= factor * factor * factor;
+        }
+
+        Trajectory<6> recalculated;
+        auto start = std::chrono::steady_clock::now();
+        otg.calculate(scaled_input, recalculated);
+        auto stop = std::chrono::steady_clock::now();
+        sum_recalculation += std::chrono::duration<double, std::micro>(stop - start).count();
+
+        start = std::chrono::steady_clock::now();
+        trajectory.scale_time(factor);
+        stop = std::chrono::steady_clock::now();
+        sum_scaling += std::chrono::duration<double, std::micro>(stop - start).count();
+    }
+
+    std::cout << "Recalculation with scaled limits: mean " << sum_recalculation / number_trajectories << " [µs]" << std::endl;
+    std::cout << "Time-scaling the trajectory: mean " << sum_scaling / number_trajectories << " [µs]" << std::endl;
+}
+
+//! Calculation duration [µs] of only the minimal duration compared to the full calculation, e.g. for ranking candidate motions
+void benchmark_min_duration(size_t number_trajectories) {
+    std::normal_distribution<double> position_dist {0.0, 4.0};
+    std::normal_distribution<double> dynamic_dist {0.0, 0.8};
+    std::uniform_real_distribution<double> limit_dist {0.1, 12.0};
+    Randomizer<6, decltype(position_dist)> p { position_dist, 42 };
+    Randomizer<6, decltype(dynamic_dist)> d { dynamic_dist, 43 };
+    Randomizer<6, decltype(limit_dist)> l { limit_dist, 44 };
+
+    Ruckig<6> otg {0.005};
+    InputParameter<6> input;
+    Trajectory<6> trajectory, workspace;
+
+    double sum_calculate {0.0}, sum_min_duration {0.0};
+    for (size_t i = 0; i < number_trajectories; ++i) {
+        p.fill(input.current_position);
+        d.fill_or_zero(input.current_velocity, 0.9);
+        d.fill_or_zero(input.current_acceleration, 0.8);
+        p.fill(input.target_position);
+        d.fill_or_zero(input.target_velocity, 0.7);
+        l.fill(input.max_velocity, input.target_velocity);
+        l.fill(input.max_acceleration);
+        l.fill(input.max_jerk);
+
+        auto start = std::chrono::steady_clock::now();
+        otg.calculate(input, trajectory);
+        auto stop = std::chrono::steady_clock::now();
+        sum_calculate += std::chrono::duration<double, std::micro>(stop - start).count();
+
+        double duration;
+        start = std::chrono::steady_clock::now();
+        otg.calculate_min_duration(input, workspace, duration);
+        stop = std::chrono::steady_clock::now();
+        sum_min_duration += std::chrono::duration<double, std::micro>(stop - start).count();
+    }
+
+    std::cout << "Full calculation: mean " << sum_calculate / number_trajectories << " [µs]" << std::endl;
+    std::cout << "Minimal duration only: mean " << sum_min_duration / number_trajectories << " [µs]" << std::endl;
+}
+
+//! Calculation duration [µs] with deferred Step 2 compared to the full calculation, e.g. if only a single DoF is used
+void benchmark_deferred_step2(size_t number_trajectories) {
+    std::normal_distribution<double> position_dist {0.0, 4.0};
+    std::normal_distribution<double> dynamic_dist {0.0, 0.8};
+    std::uniform_real_distribution<double> limit_dist {0.1, 12.0};
+    Randomizer<6, decltype(position_dist)> p { position_dist, 42 };
+    Randomizer<6, decltype(dynamic_dist)> d { dynamic_dist, 43 };
+    Randomizer<6, decltype(limit_dist)> l { limit_dist, 44 };
+
+    Ruckig<6> otg {0.005};
+    InputParameter<6> input;
+    Trajectory<6> trajectory, deferred, deferred_single;
+
+    double sum_calculate {0.0}, sum_deferred {0.0}, sum_single {0.0};
+    for (size_t i = 0; i < number_trajectories; ++i) {
+        p.fill(input.current_position);
+        d.fill_or_zero(input.current_velocity, 0.9);
+        d.fill_or_zero(input.current_acceleration, 0.8);
+        p.fill(input.target_position);
+        d.fill_or_zero(input.target_velocity, 0.7);
+        l.fill(input.max_velocity, input.target_velocity);
+        l.fill(input.max_acceleration);
+        l.fill(input.max_jerk);
+
+        auto start = std::chrono::steady_clock::now();
+        otg.calculate(input, trajectory);
+        auto stop = std::chrono::steady_clock::now();
+        sum_calculate += std::chrono::duration<double, std::micro>(stop - start).count();
+
+        start = std::chrono::steady_clock::now();
+        otg.calculate_deferred(input, deferred);
+        stop = std::chrono::steady_clock::now();
+        sum_deferred += std::chrono::duration<double, std::micro>(stop - start).count();
+
+        start = std::chrono::steady_clock::now();
+        if (otg.calculate_deferred(input, deferred_single) == Result::Working) {
+            deferred_single.resolve_step2(0);
+        }
+        stop = std::chrono::steady_clock::now();
+        sum_single += std::chrono::duration<double, std::micro>(stop - start).count();
+    }
+
+    std::cout << "Full calculation: mean " << sum_calculate / number_trajectories << " [µs]" << std::endl;
+    std::cout << "Deferred Step 2: mean " << sum_deferred / number_trajectories << " [µs]" << std::endl;
+    std::cout << "Deferred Step 2 with a single resolved DoF: mean " << sum_single / number_trajectories << " [µs]" << std::endl;
+}
+
+//! Calculation duration [µs] of the conservative approximation compared to the exact calculation, and its overestimation
+void benchmark_approximation(size_t number_trajectories) {
+    std::normal_distribution<double> position_dist {0.0, 4.0};
+    std::normal_distribution<double> dynamic_dist {0.0, 0.8};
+    std::uniform_real_distribution<double> limit_dist {0.1, 12.0};
+    Randomizer<6, decltype(position_dist)> p { position_dist, 42 };
+    Randomizer<6, decltype(dynamic_dist)> d { dynamic_dist, 43 };
+    Randomizer<6, decltype(limit_dist)> l { limit_dist, 44 };
+
+    Ruckig<6> otg {0.005};
+    InputParameter<6> input;
+    Trajectory<6> trajectory;
+    ConservativeApproximation<6> approximation;
+
+    double sum_calculate {0.0}, sum_approximation {0.0}, sum_ratio {0.0};
+    size_t number_valid {0};
+    for (size_t i = 0; i < number_trajectories; ++i) {
+        p.fill(input.current_position);
+        d.fill_or_zero(input.current_velocity, 0.9);
+        d.fill_or_zero(input.current_acceleration, 0.8);
+        p.fill(input.target_position);
+        d.fill_or_zero(input.target_velocity, 0.7);
+        l.fill(input.max_velocity, input.target_velocity);
+        l.fill(input.max_acceleration);
+        l.fill(input.max_jerk);
+
+        auto start = std::chrono::steady_clock::now();
+        const Result result = otg.calculate(input, trajectory);
+        auto stop = std::chrono::steady_clock::now();
+        sum_calculate += std::chrono::duration<double, std::micro>(stop - start).count();
+
+        start = std::chrono::steady_clock::now();
+        otg.calculate_approximation(input, approximation);
+        stop = std::chrono::steady_clock::now();
+        sum_approximation += std::chrono::duration<double, std::micro>(stop - start).count();
+
+        if (result == Result::Working && trajectory.get_duration() > 0.0) {
+            sum_ratio += approximation.duration / trajectory.get_duration();
+            number_valid += 1;
+        }
+    }
+
+    std::cout << "Exact calculation: mean " << sum_calculate / number_trajectories << " [µs]" << std::endl;
+    std::cout << "Conservative approximation: mean " << sum_approximation / number_trajectories << " [µs]  mean duration ratio " << sum_ratio / std::max<size_t>(number_valid, 1) << std::endl;
+}
+
+//! Step 1 duration [µs] for states along trajectories to rest, separately for the inputs that need the two-step fallbacks
+void benchmark_two_step_fallbacks(size_t number_trajectories) {
+    std::normal_distribution<double> position_dist {0.0, 4.0};
+    std::normal_distribution<double> dynamic_dist {0.0, 0.8};
+    std::uniform_real_distribution<double> limit_dist {0.1, 12.0};
+    std::uniform_real_distribution<double> time_dist {0.0, 1.0};
+    Randomizer<1, decltype(position_dist)> p { position_dist, 42 };
+    Randomizer<1, decltype(dynamic_dist)> d { dynamic_dist, 43 };
+    Randomizer<1, decltype(limit_dist)> l { limit_dist, 44 };
+    std::mt19937 gen (45);
+
+    Ruckig<1> otg {0.005};
+    InputParameter<1> input;
+    Trajectory<1> trajectory;
+
+    double sum_fallback {0.0}, max_fallback {0.0}, sum_regular {0.0};
+    size_t number_fallback {0}, number_regular {0};
+    for (size_t i = 0; i < number_trajectories; ++i) {
+        p.fill(input.current_position);
+        d.fill_or_zero(input.current_velocity, 0.9);
+        d.fill_or_zero(input.current_acceleration, 0.8);
+        p.fill(input.target_position);
+        l.fill(input.max_velocity, input.current_velocity);
+        l.fill(input.max_acceleration, input.current_acceleration);
+        l.fill(input.max_jerk);
+        if (otg.calculate(input, trajectory) != Result::Working) {
+            continue;
+        }
+
+        // Recalculations from a state along the trajectory, as in an online control loop
+        std::array<double, 1> p0, v0, a0;
+        trajectory.at_time(time_dist(gen) * trajectory.get_duration(), p0, v0, a0);
+
+        PositionStep1 step1 {p0[0], v0[0], a0[0], input.target_position[0], 0.0, 0.0, input.max_velocity[0], -input.max_velocity[0], input.max_acceleration[0], -input.max_acceleration[0], input.max_jerk[0]};
+        Block block;
+        double duration {std::numeric_limits<double>::infinity()};
+        bool found {true};
+        for (size_t repetition = 0; repetition < 5; ++repetition) {
+            const auto start = std::chrono::steady_clock::now();
+            found &= step1.get_profile(Profile(), block);
+            const auto stop = std::chrono::steady_clock::now();
+            duration = std::min(duration, std::chrono::duration<double, std::micro>(stop - start).count());
+        }
+        if (!found) {
+            continue;
+        }
+
+        if (step1.used_two_step_fallback) {
+            sum_fallback += duration;
+            max_fallback = std::max(max_fallback, duration);
+            ++number_fallback;
+        } else {
+            sum_regular += duration;
+            ++number_regular;
+        }
+    }
+
+    std::cout << "Step 1 with two-step fallbacks (" << number_fallback << " inputs): mean " << sum_fallback / number_fallback << "  max " << max_fallback << " [µs]" << std::endl;
+    std::cout << "Step 1 without fallbacks (" << number_regular << " inputs): mean " << sum_regular / number_regular << " [µs]" << std::endl;
+}
+
+//! Aggregate throughput and latency [µs] of independent instances on 1 to max_threads threads, on the same input stream
+template<size_t DOFs, class OTGType>
+void benchmark_throughput(const std::string& algorithm, size_t number_trajectories, size_t max_threads) {
+    std::normal_distribution<double> position_dist {0.0, 4.0};
+    std::normal_distribution<double> dynamic_dist {0.0, 0.8};
+    std::uniform_real_distribution<double> limit_dist {0.1, 12.0};
+    Randomizer<DOFs, decltype(position_dist)> p { position_dist, 42 };
+    Randomizer<DOFs, decltype(dynamic_dist)> d { dynamic_dist, 43 };
+    Randomizer<DOFs, decltype(limit_dist)> l { limit_dist, 44 };
+
+    // The stream is generated up-front and without target accelerations, so that every algorithm gets the same inputs
+    Ruckig<DOFs> validator {0.005};
+    std::vector<InputParameter<DOFs>> inputs;
+    inputs.reserve(number_trajectories);
+    InputParameter<DOFs> input;
+    while (inputs.size() < number_trajectories) {
+        p.fill(input.current_position);
+        d.fill_or_zero(input.current_velocity, 0.9);
+        d.fill_or_zero(input.current_acceleration, 0.8);
+        p.fill(input.target_position);
+        d.fill_or_zero(input.target_velocity, 0.7);
+        l.fill(input.max_velocity, input.target_velocity);
+        l.fill(input.max_acceleration);
+        l.fill(input.max_jerk);
+        if (validator.validate_input(input)) {
+            inputs.push_back(input);
+        }
+    }
+
+    double single_thread_throughput {0.0};
+    for (size_t number_threads = 1; number_threads <= max_threads; number_threads *= 2) {
+        std::vector<std::vector<double>> thread_durations(number_threads);
+        std::atomic<size_t> ready {0};
+        std::atomic<bool> start_flag {false};
+
+        std::vector<std::thread> threads;
+        for (size_t t = 0; t < number_threads; ++t) {
+            threads.emplace_back([&, t]() {
+                OTGType otg {0.005};
+                OutputParameter<DOFs> output;
+                auto& durations = thread_durations[t];
+                durations.reserve(inputs.size() / number_threads + 1);
+
+                ++ready;
+                while (!start_flag) {
+                    std::this_thread::yield();
+                }
+
+                // Each thread plans every number_threads-th trajectory of the stream
+                for (size_t i = t; i < inputs.size(); i += number_threads) {
+                    const auto start = std::chrono::steady_clock::now();
+                    otg.update(inputs[i], output);
+                    const auto stop = std::chrono::steady_clock::now();
+                    durations.push_back(std::chrono::duration<double, std::micro>(stop - start).count());
                 }
+            });
+        }
+
+        while (ready < number_threads) {
+            std::this_thread::yield();
+        }
+        const auto start = std::chrono::steady_clock::now();
+        start_flag = true;
+        for (auto& thread: threads) {
+            thread.join();
+        }
+        const double wall_duration = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        std::vector<double> durations;
+        for (const auto& values: thread_durations) {
+            durations.insert(durations.end(), values.begin(), values.end());
+        }
+        std::sort(durations.begin(), durations.end());
+
+        const double throughput = durations.size() / wall_duration;
+        if (number_threads == 1) {
+            single_thread_throughput = throughput;
+        }
+
+        std::cout << algorithm << " " << DOFs << " DoFs on " << number_threads << " threads: throughput " << throughput << " [1/s]"
+            << "  efficiency " << throughput / (number_threads * single_thread_throughput)
+            << "  p50 " << percentile(durations, 0.5) << "  p99 " << percentile(durations, 0.99) << "  p99.9 " << percentile(durations, 0.999) << "  max " << durations.back() << " [µs]" << std::endl;
+    }
+}
+
+//! Per-call duration, heap allocations, and cache misses of calculate and of the sampling-only update cycles
+template<class OTGType, class InputType, class OutputType, class TrajectoryType>
+void benchmark_call_overhead(const std::string& name, OTGType& otg, std::vector<InputType> inputs, OutputType output, TrajectoryType trajectory) {
+    constexpr size_t cycles_per_input {10};
+    PerfCounters cache_misses {{PerfCounters::Event::CacheMisses}};
+    std::vector<uint64_t> calculate_cache_misses, update_cache_misses;
+
+    for (const auto& input: inputs) {
+        otg.calculate(input, trajectory); // Warm-up
+    }
+
+    double calculate_duration {0.0};
+    size_t calculate_allocations {0};
+    cache_misses.start();
+    for (const auto& input: inputs) {
+        const size_t allocations = AllocationCounter::now().allocations;
+        const auto start = std::chrono::steady_clock::now();
+        otg.calculate(input, trajectory);
+        const auto stop = std::chrono::steady_clock::now();
+        calculate_allocations += AllocationCounter::now().allocations - allocations;
+        calculate_duration += std::chrono::duration<double, std::nano>(stop - start).count();
+    }
+    cache_misses.stop(calculate_cache_misses);
+
+    double update_duration {0.0};
+    size_t update_allocations {0};
+    for (auto& input: inputs) {
+        otg.update(input, output);
+        output.pass_to_input(input);
+
+        // Steady state of the control loop: the input follows the output, so that the trajectory is only sampled
+        cache_misses.start();
+        for (size_t cycle = 0; cycle < cycles_per_input; ++cycle) {
+            const size_t allocations = AllocationCounter::now().allocations;
+            const auto start = std::chrono::steady_clock::now();
+            otg.update(input, output);
+            const auto stop = std::chrono::steady_clock::now();
+            update_allocations += AllocationCounter::now().allocations - allocations;
+            update_duration += std::chrono::duration<double, std::nano>(stop - start).count();
+            output.pass_to_input(input);
+        }
+        cache_misses.stop(update_cache_misses);
+    }
+
+    const double number_calculations = inputs.size();
+    const double number_cycles = inputs.size() * cycles_per_input;
+    std::cout << std::left << std::setw(20) << name << std::right << std::fixed << std::setprecision(1)
+        << " calculate " << std::setw(8) << calculate_duration / number_calculations << " ns, " << calculate_allocations / number_calculations << " allocations"
+        << " | sampling update " << std::setw(6) << update_duration / number_cycles << " ns, " << update_allocations / number_cycles << " allocations";
+    if (cache_misses.is_available()) {
+        std::cout << " | cache misses per calculate " << calculate_cache_misses[0] / number_calculations << ", per update " << update_cache_misses[0] / number_cycles;
+    }
+    std::cout << std::defaultfloat << std::setprecision(6) << std::endl;
+}
+
+//! Copy the state and limits between inputs of different DoF storage
+template<class Target, class Source>
+Target convert_input(const Source& source, Target target) {
+    const auto copy = [](const auto& from, auto& to) { std::copy(from.begin(), from.end(), to.begin()); };
+    copy(source.current_position, target.current_position);
+    copy(source.current_velocity, target.current_velocity);
+    copy(source.current_acceleration, target.current_acceleration);
+    copy(source.target_position, target.target_position);
+    copy(source.target_velocity, target.target_velocity);
+    copy(source.target_acceleration, target.target_acceleration);
+    copy(source.max_velocity, target.max_velocity);
+    copy(source.max_acceleration, target.max_acceleration);
+    copy(source.max_jerk, target.max_jerk);
+    return target;
+}
+
+//! Per-call overhead of static (array-backed) vs. dynamic (vector-backed or bounded inline) DoFs on the same inputs
+template<size_t DOFs>
+void benchmark_dof_storage(size_t number_trajectories) {
+    std::normal_distribution<double> position_dist {0.0, 4.0};
+    std::normal_distribution<double> dynamic_dist {0.0, 0.8};
+    std::uniform_real_distribution<double> limit_dist {0.1, 12.0};
+    Randomizer<DOFs, decltype(position_dist)> p { position_dist, 42 };
+    Randomizer<DOFs, decltype(dynamic_dist)> d { dynamic_dist, 43 };
+    Randomizer<DOFs, decltype(limit_dist)> l { limit_dist, 44 };
+
+    Ruckig<DOFs> otg {0.005};
+    std::vector<InputParameter<DOFs>> inputs;
+    InputParameter<DOFs> input;
+    while (inputs.size() < number_trajectories) {
+        p.fill(input.current_position);
+        d.fill_or_zero(input.current_velocity, 0.9);
+        d.fill_or_zero(input.current_acceleration, 0.8);
+        p.fill(input.target_position);
+        d.fill_or_zero(input.target_velocity, 0.7);
+        d.fill_or_zero(input.target_acceleration, 0.6);
+        l.fill(input.max_velocity, input.target_velocity);
+        l.fill(input.max_acceleration, input.target_acceleration);
+        l.fill(input.max_jerk);
+        if (otg.validate_input(input)) {
+            inputs.push_back(input);
+        }
+    }
+
+    std::vector<InputParameter<0>> dynamic_inputs;
+    std::vector<InputParameter<0, DOFs>> bounded_inputs;
+    for (const auto& static_input: inputs) {
+        dynamic_inputs.push_back(convert_input(static_input, InputParameter<0> {DOFs}));
+        bounded_inputs.push_back(convert_input(static_input, InputParameter<0, DOFs> {DOFs}));
+    }
+
+    benchmark_call_overhead("Ruckig<" + std::to_string(DOFs) + ">", otg, inputs, OutputParameter<DOFs>(), Trajectory<DOFs>());
+
+    Ruckig<0> dynamic_otg {DOFs, 0.005};
+    benchmark_call_overhead("Ruckig<0>", dynamic_otg, dynamic_inputs, OutputParameter<0>(DOFs), Trajectory<0>(DOFs));
+
+    Ruckig<0, false, true, DOFs> bounded_otg {DOFs, 0.005};
+    benchmark_call_overhead("Ruckig<0, MaxDOFs=" + std::to_string(DOFs) + ">", bounded_otg, bounded_inputs, OutputParameter<0, DOFs>(DOFs), Trajectory<0, DOFs>(DOFs));
+}
+
+//! Hardware events and latency per calculate, attributed to Step 1 and Step 2 by calling them separately on the same inputs
+void benchmark_perf_counters(size_t number_trajectories) {
+    using Event = PerfCounters::Event;
+    const std::vector<Event> events {Event::Cycles, Event::Instructions, Event::BranchMisses, Event::L1DMisses, Event::LLCMisses};
+    PerfCounters counters {events};
+    if (!counters.is_available()) {
+        std::cout << "Hardware performance counters are not available (see /proc/sys/kernel/perf_event_paranoid)" << std::endl;
+        return;
+    }
+
+    std::normal_distribution<double> position_dist {0.0, 4.0};
+    std::normal_distribution<double> dynamic_dist {0.0, 0.8};
+    std::uniform_real_distribution<double> limit_dist {0.1, 12.0};
+    Randomizer<3, decltype(position_dist)> p { position_dist, 42 };
+    Randomizer<3, decltype(dynamic_dist)> d { dynamic_dist, 43 };
+    Randomizer<3, decltype(limit_dist)> l { limit_dist, 44 };
+
+    Ruckig<3> otg {0.005};
+    InputParameter<3> input;
+    Trajectory<3> trajectory;
+
+    std::vector<uint64_t> calculate_events, step1_events, step2_events;
+    double calculate_duration {0.0}, step1_duration {0.0}, step2_duration {0.0};
+    size_t number_calculations {0}, number_step1 {0}, number_step2 {0};
+    for (size_t i = 0; i < number_trajectories; ++i) {
+        p.fill(input.current_position);
+        d.fill_or_zero(input.current_velocity, 0.9);
+        d.fill_or_zero(input.current_acceleration, 0.8);
+        p.fill(input.target_position);
+        d.fill_or_zero(input.target_velocity, 0.7);
+        d.fill_or_zero(input.target_acceleration, 0.6);
+        l.fill(input.max_velocity, input.target_velocity);
+        l.fill(input.max_acceleration, input.target_acceleration);
+        l.fill(input.max_jerk);
+
+        // Without a brake pre-trajectory, Step 1 and Step 2 start from the current state as within calculate
+        for (size_t dof = 0; dof < 3; ++dof) {
+            input.max_velocity[dof] = std::max(input.max_velocity[dof], std::abs(input.current_velocity[dof]));
+            input.max_acceleration[dof] = std::max(input.max_acceleration[dof], std::abs(input.current_acceleration[dof]));
+        }
+        if (!otg.validate_input(input)) {
+            continue;
+        }
+
+        counters.start();
+        const auto start = std::chrono::steady_clock::now();
+        const Result result = otg.calculate(input, trajectory);
+        const auto stop = std::chrono::steady_clock::now();
+        counters.stop(calculate_events);
+        calculate_duration += std::chrono::duration<double, std::micro>(stop - start).count();
+        ++number_calculations;
+        if (result != Result::Working) {
+            continue;
+        }
+
+        const double tf = trajectory.get_duration();
+        const auto min_durations = trajectory.get_independent_min_durations();
+        for (size_t dof = 0; dof < 3; ++dof) {
+            PositionStep1 step1 {input.current_position[dof], input.current_velocity[dof], input.current_acceleration[dof], input.target_position[dof], input.target_velocity[dof], input.target_acceleration[dof], input.max_velocity[dof], -input.max_velocity[dof], input.max_acceleration[dof], -input.max_acceleration[dof], input.max_jerk[dof]};
+            Block block;
+            counters.start();
+            const auto step1_start = std::chrono::steady_clock::now();
+            step1.get_profile(Profile(), block);
+            const auto step1_stop = std::chrono::steady_clock::now();
+            counters.stop(step1_events);
+            step1_duration += std::chrono::duration<double, std::micro>(step1_stop - step1_start).count();
+            ++number_step1;
+
+            if (min_durations[dof] >= tf) {
+                continue;
             }
 
-            double time = check_calculation(otg, input);
-            average_ = average_ + (time - average_) / n;
-            worst_ = std::max(worst_, time);
-            ++n;
+            PositionStep2 step2 {tf, input.current_position[dof], input.current_velocity[dof], input.current_acceleration[dof], input.target_position[dof], input.target_velocity[dof], input.target_acceleration[dof], input.max_velocity[dof], -input.max_velocity[dof], input.max_acceleration[dof], -input.max_acceleration[dof], input.max_jerk[dof]};
+            Profile profile;
+            counters.start();
+            const auto step2_start = std::chrono::steady_clock::now();
+            step2.get_profile(profile);
+            const auto step2_stop = std::chrono::steady_clock::now();
+            counters.stop(step2_events);
+            step2_duration += std::chrono::duration<double, std::micro>(step2_stop - step2_start).count();
+            ++number_step2;
         }
+    }
 
-        average.emplace_back(average_);
-        worst.emplace_back(worst_);
+    // The remainder are the brake pre-trajectories, the synchronization, and the setup of the trajectory
+    std::vector<double> remainder_events(events.size());
+    const double step1_per_calculation = static_cast<double>(number_step1) / number_calculations;
+    const double step2_per_calculation = static_cast<double>(number_step2) / number_calculations;
+    for (size_t e = 0; e < events.size(); ++e) {
+        remainder_events[e] = calculate_events[e] / static_cast<double>(number_calculations) - step1_per_calculation * step1_events[e] / std::max<double>(number_step1, 1) - step2_per_calculation * step2_events[e] / std::max<double>(number_step2, 1);
     }
+    const double remainder_duration = calculate_duration / number_calculations - step1_per_calculation * step1_duration / std::max<double>(number_step1, 1) - step2_per_calculation * step2_duration / std::max<double>(number_step2, 1);
+
+    const auto print_row = [&](const std::string& name, size_t number, double duration, const auto& values, double divisor) {
+        std::cout << std::left << std::setw(22) << name << std::right << std::setw(8) << number << " calls  " << std::fixed << std::setprecision(3) << duration / divisor << " [µs]" << std::setprecision(0);
+        for (size_t e = 0; e < events.size(); ++e) {
+            std::cout << "  " << PerfCounters::name(events[e]) << " " << values[e] / divisor;
+        }
+        if (values[0] > 0) {
+            std::cout << std::setprecision(2) << "  IPC " << static_cast<double>(values[1]) / values[0];
+        }
+        std::cout << std::defaultfloat << std::setprecision(6) << std::endl;
+    };
+
+    print_row("calculate (3 DoFs)", number_calculations, calculate_duration, calculate_events, number_calculations);
+    print_row("Step 1 (per DoF)", number_step1, step1_duration, step1_events, std::max<double>(number_step1, 1));
+    print_row("Step 2 (per DoF)", number_step2, step2_duration, step2_events, std::max<double>(number_step2, 1));
+    print_row("Remainder per calculate", number_calculations, remainder_duration, remainder_events, 1.0);
+}
 
-    auto [average_mean, average_std] = analyze(average);
-    auto [worst_mean, worst_std] = analyze(worst);
+//! Calculation duration [µs] of each section of a corpus (e.g. the hard inputs of otg-test), separately from the random inputs
 
-    if (verbose) {
-        std::cout << "---" << std::endl;
-        std::cout << "Benchmark for " << otg.degrees_of_freedom << " DoFs on " << number_trajectories << " trajectories" << std::endl;
-        std::cout << "Average Calculation Duration " << average_mean << " pm " << average_std << " [µs]" << std::endl;
-        std::cout << "Worst Calculation Duration " << worst_mean << " pm " << worst_std << " [µs]" << std::endl;
+//! Each input is calculated with a new trajectory, so that no Step 1 results are reused from the previous input, and
+//! the durations are the minima over the repetitions.
+std::vector<Statistics> benchmark_corpus(const std::string& filename, size_t number_repetitions) {
+    std::ifstream file {filename};
+    std::vector<Statistics> results;
+    for (const auto& section: corpus::read_sections(file)) {
+        if (section.inputs.empty()) {
+            continue;
+        }
+
+        std::vector<double> durations(section.inputs.size(), std::numeric_limits<double>::infinity());
+        double wall_duration {0.0};
+        for (size_t repetition = 0; repetition < number_repetitions; ++repetition) {
+            for (size_t i = 0; i < section.inputs.size(); ++i) {
+                const auto& input = section.inputs[i];
+                Ruckig<0> otg {input.degrees_of_freedom, 0.005};
+                Trajectory<0> trajectory {input.degrees_of_freedom};
+
+                const auto start = std::chrono::high_resolution_clock::now();
+                otg.calculate(input, trajectory);
+                const auto stop = std::chrono::high_resolution_clock::now();
+                const double duration = std::chrono::duration_cast<std::chrono::nanoseconds>(stop - start).count() / 1000.0;
+                durations[i] = std::min(durations[i], duration);
+                wall_duration += duration;
+            }
+        }
+        std::sort(durations.begin(), durations.end());
+
+        const auto& first = section.inputs.front();
+        Statistics statistics;
+        statistics.algorithm = "corpus/" + (section.name.empty() ? filename : section.name);
+        statistics.degrees_of_freedom = first.degrees_of_freedom;
+        statistics.dynamic_dofs = true;
+        statistics.configuration = {first.control_interface, first.synchronization, first.duration_discretization, section.inputs.size()};
+        statistics.number_calculations = durations.size();
+        statistics.mean = std::accumulate(durations.begin(), durations.end(), 0.0) / durations.size();
+        statistics.p50 = percentile(durations, 0.5);
+        statistics.p99 = percentile(durations, 0.99);
+        statistics.p999 = percentile(durations, 0.999);
+        statistics.max = durations.back();
+        statistics.throughput = durations.size() * number_repetitions / (wall_duration / 1e6);
+        results.push_back(statistics);
     }
+    return results;
+}
+
 
-    // std::cout << otg.degrees_of_freedom << "\t" << average_mean << "\t" << average_std << "\t" << worst_mean << "\t" << worst_std << std::endl;
+void print(const Statistics& s) {
+    std::cout << s.algorithm << " " << s.degrees_of_freedom << (s.dynamic_dofs ? " dynamic" : "") << " DoFs, "
+        << to_string(s.configuration.control_interface) << ", " << to_string(s.configuration.synchronization) << ", " << to_string(s.configuration.duration_discretization)
+        << " (" << s.number_calculations << " calculations)" << std::endl;
+    std::cout << "    mean " << s.mean << "  p50 " << s.p50 << "  p99 " << s.p99 << "  p99.9 " << s.p999 << "  max " << s.max << " [µs]"
+        << "  throughput " << s.throughput << " [1/s]" << std::endl;
+}
+
+
+void write_json(const std::string& filename, const std::vector<Statistics>& results) {
+    std::ofstream file {filename};
+    file << "{\n  \"version\": \"" << RUCKIG_VERSION << "\",\n";
+    file << "  \"block_size\": " << sizeof(Block) << ",\n";
+    file << "  \"profile_size\": " << sizeof(Profile) << ",\n";
+    file << "  \"results\": [\n";
+    for (size_t i = 0; i < results.size(); ++i) {
+        const Statistics& s = results[i];
+        file << "    {\"algorithm\": \"" << s.algorithm << "\", \"dofs\": " << s.degrees_of_freedom << ", \"dynamic_dofs\": " << (s.dynamic_dofs ? "true" : "false");
+        file << ", \"control_interface\": \"" << to_string(s.configuration.control_interface) << "\"";
+        file << ", \"synchronization\": \"" << to_string(s.configuration.synchronization) << "\"";
+        file << ", \"duration_discretization\": \"" << to_string(s.configuration.duration_discretization) << "\"";
+        file << ", \"calculations\": " << s.number_calculations;
+        file << std::setprecision(6) << ", \"mean\": " << s.mean << ", \"p50\": " << s.p50 << ", \"p99\": " << s.p99 << ", \"p99_9\": " << s.p999 << ", \"max\": " << s.max;
+        file << ", \"throughput\": " << s.throughput << "}" << (i + 1 < results.size() ? "," : "") << "\n";
+    }
+    file << "  ]\n}\n";
 }
 
 
-int main() {
-    const size_t n {5}; // Number of iterations
-    const size_t number_trajectories {64 * 1024};
-    
-    std::cout << "Block size: " << sizeof(Block) << " Byte" << std::endl;
-    std::cout << "Profile size: " << sizeof(Profile) << " Byte" << std::endl;
-    std::cout << "Trajectory<3> size: " << sizeof(Trajectory<3>) << " Byte" << std::endl;
+int main(int argc, char** argv) {
+    // Usage: otg-benchmark [--trajectories N] [--json FILE] [--threads N] [--perf-counters] [--corpus FILE]
+    Configuration base;
+    std::string json_filename, corpus_filename;
+    size_t max_threads = std::min<size_t>(16, std::max<unsigned>(std::thread::hardware_concurrency(), 1));
+    bool perf_counters {false};
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg {argv[i]};
+        if (i + 1 < argc && arg == "--trajectories") {
+            base.number_trajectories = std::stoul(argv[++i]);
+        } else if (i + 1 < argc && arg == "--json") {
+            json_filename = argv[++i];
+        } else if (i + 1 < argc && arg == "--threads") {
+            max_threads = std::max<size_t>(std::stoul(argv[++i]), 1);
+        } else if (arg == "--perf-counters") {
+            perf_counters = true;
+        } else if (i + 1 < argc && arg == "--corpus") {
+            corpus_filename = argv[++i];
+        }
+    }
+
+    std::cout << "--- Memory" << std::endl;
+    for (const auto& report: {MemoryReport::of<1>(), MemoryReport::of<3>(), MemoryReport::of<6>(), MemoryReport::of<7>(), MemoryReport::of<0>(7), MemoryReport::of<0, 7>(7)}) {
+        std::cout << report.to_string() << std::endl;
+    }
+
+    std::vector<Statistics> results;
+    auto run = [&results](const Statistics& statistics) {
+        print(statistics);
+        results.push_back(statistics);
+    };
+
+    // Dependence of the performance on the DoFs, static vs. dynamic
+    std::cout << "--- DoF sweep" << std::endl;
+    run(benchmark<1, Ruckig<1, true>>("ruckig", 1, base));
+    run(benchmark<3, Ruckig<3, true>>("ruckig", 3, base));
+    run(benchmark<6, Ruckig<6, true>>("ruckig", 6, base));
+    run(benchmark<7, Ruckig<7, true>>("ruckig", 7, base));
+    run(benchmark<12, Ruckig<12, true>>("ruckig", 12, base));
+    run(benchmark<32, Ruckig<32, true>>("ruckig", 32, base));
+    run(benchmark<64, Ruckig<64, true>>("ruckig", 64, base));
+    run(benchmark<128, Ruckig<128, true>>("ruckig", 128, base));
+    for (const size_t dofs: {1, 3, 6, 7, 12, 32, 64, 128}) {
+        run(benchmark<0, Ruckig<0, true>>("ruckig", dofs, base));
+    }
+
+    // Per-call overhead of the DoF storage, including the sampling-only cycles of the control loop
+    // Known hard inputs, so that a speedup of the random inputs cannot hide a regression of the pathological ones
+    if (!corpus_filename.empty()) {
+        std::cout << "--- Corpus" << std::endl;
+        for (const auto& statistics: benchmark_corpus(corpus_filename, 5)) {
+            run(statistics);
+        }
+    }
+
+    std::cout << "--- Static vs. dynamic DoFs" << std::endl;
+    std::cout << "3 DoFs" << std::endl;
+    benchmark_dof_storage<3>(base.number_trajectories / 4);
+    std::cout << "7 DoFs" << std::endl;
+    benchmark_dof_storage<7>(base.number_trajectories / 4);
+
+    // Dependence of the performance on the input settings
+    std::cout << "--- Interface, synchronization, and discretization sweep" << std::endl;
+    for (const auto control_interface: {ControlInterface::Position, ControlInterface::Velocity}) {
+        for (const auto synchronization: {Synchronization::Time, Synchronization::TimeIfNecessary, Synchronization::Phase, Synchronization::None}) {
+            for (const auto duration_discretization: {DurationDiscretization::Continuous, DurationDiscretization::Discrete}) {
+                Configuration configuration {base};
+                configuration.control_interface = control_interface;
+                configuration.synchronization = synchronization;
+                configuration.duration_discretization = duration_discretization;
+                run(benchmark<6, Ruckig<6, true>>("ruckig", 6, configuration));
+            }
+        }
+    }
+
+    std::cout << "--- Step 1 case prediction" << std::endl;
+    benchmark_case_prediction(base.number_trajectories);
+
+    std::cout << "--- Synchronization" << std::endl;
+    benchmark_synchronization(base.number_trajectories / 16);
+
+    std::cout << "--- Worker pool" << std::endl;
+    benchmark_worker_pool(base.number_trajectories / 16);
+    benchmark_speculative_candidates(base.number_trajectories / 4);
+
+    std::cout << "--- Batch of instances" << std::endl;
+    benchmark_batch_ruckig(base.number_trajectories / 16);
+
+    std::cout << "--- Batch of candidates" << std::endl;
+    benchmark_candidate_batch(base.number_trajectories * 4);
+
+    std::cout << "--- Stop trajectory" << std::endl;
+    benchmark_stop(base.number_trajectories);
+
+    std::cout << "--- Input validation" << std::endl;
+    benchmark_validation(base.number_trajectories * 4);
+    benchmark_constant_limits<RuntimeLimits>(base.number_trajectories);
+    benchmark_constant_limits<FixedAxisLimits>(base.number_trajectories);
+
+    std::cout << "--- Retargeting" << std::endl;
+    benchmark_retargeting(base.number_trajectories / 4);
 
-    // Main comparison
-    // benchmark<0, Ruckig<0, true>>(n, number_trajectories);
-    benchmark<7, Ruckig<7, true>>(n, number_trajectories);
-    // benchmark<7, Reflexxes<7>>(n, number_trajectories);
+    std::cout << "--- Velocity-only generator" << std::endl;
+    benchmark_velocity_ruckig(base.number_trajectories);
 
-    // Dependence performance vs. DoFs
-    // benchmark<1, Ruckig<1, true>>(n, number_trajectories, false);
-    // benchmark<2, Ruckig<2, true>>(n, number_trajectories, false);
-    // benchmark<3, Ruckig<3, true>>(n, number_trajectories, false);
-    // benchmark<4, Ruckig<4, true>>(n, number_trajectories, false);
-    // benchmark<5, Ruckig<5, true>>(n, number_trajectories, false);
-    // benchmark<6, Ruckig<6, true>>(n, number_trajectories, false);
-    // benchmark<7, Ruckig<7, true>>(n, number_trajectories, false);
-    // benchmark<8, Ruckig<8, true>>(n, number_trajectories, false);
-    // benchmark<9, Ruckig<9, true>>(n, number_trajectories, false);
-    // benchmark<10, Ruckig<10, true>>(n, number_trajectories, false);
-    // benchmark<11, Ruckig<11, true>>(n, number_trajectories, false);
-    // benchmark<12, Ruckig<12, true>>(n, number_trajectories, false);
-    // benchmark<13, Ruckig<13, true>>(n, number_trajectories, false);
-    // benchmark<14, Ruckig<14, true>>(n, number_trajectories, false);
+    std::cout << "--- Time-scaling" << std::endl;
+    benchmark_time_scaling(base.number_trajectories);
 
-    // 1ms worst case
-    // benchmark<Ruckig<82, true>>(n, number_trajectories);
+    std::cout << "--- Minimal duration only" << std::endl;
+    benchmark_min_duration(base.number_trajectories);
+
+    std::cout << "--- Deferred Step 2" << std::endl;
+    benchmark_deferred_step2(base.number_trajectories);
+
+    std::cout << "--- Conservative approximation" << std::endl;
+    benchmark_approximation(base.number_trajectories);
+
+    std::cout << "--- Two-step fallbacks" << std::endl;
+    benchmark_two_step_fallbacks(base.number_trajectories);
+
+    if (perf_counters) {
+        std::cout << "--- Hardware performance counters" << std::endl;
+        benchmark_perf_counters(base.number_trajectories);
+    }
+
+    std::cout << "--- Fixed-rate sampling" << std::endl;
+    benchmark_sampler(base.number_trajectories / 64);
+    benchmark_parallel_sampling();
+
+    std::cout << "--- Segment table" << std::endl;
+    benchmark_segment_table(base.number_trajectories / 64);
+    benchmark_update_sampling(base.number_trajectories / 64);
+    benchmark_idle(base.number_trajectories / 16);
+
+#ifdef WITH_REFLEXXES
+    std::cout << "--- Comparison" << std::endl;
+    run(benchmark<7, Reflexxes<7>>("reflexxes", 7, base));
+#endif
+
+    std::cout << "--- Multi-threaded throughput" << std::endl;
+    benchmark_throughput<7, Ruckig<7>>("ruckig", base.number_trajectories, max_threads);
+#ifdef WITH_REFLEXXES
+    benchmark_throughput<7, Reflexxes<7>>("reflexxes", base.number_trajectories, max_threads);
+#endif
+
+    if (!json_filename.empty()) {
+        write_json(json_filename, results);
+        std::cout << "Results written to " << json_filename << std::endl;
+    }
 }
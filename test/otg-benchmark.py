@@ -0,0 +1,87 @@
+from pathlib import Path
+from random import Random
+from statistics import median
+from sys import path
+from time import perf_counter_ns
+
+# Path to the build directory including a file similar to 'ruckig.cpython-37m-x86_64-linux-gnu'.
+path.insert(0, str(Path(__file__).parent.absolute().parent / 'build'))
+
+from ruckig import InputParameter, OutputParameter, Result, Ruckig, Trajectory, generate
+
+
+def random_input(dofs: int, rng: Random) -> InputParameter:
+    inp = InputParameter(dofs)
+    inp.current_position = [rng.gauss(0.0, 4.0) for _ in range(dofs)]
+    inp.current_velocity = [rng.gauss(0.0, 0.8) if rng.random() < 0.9 else 0.0 for _ in range(dofs)]
+    inp.current_acceleration = [rng.gauss(0.0, 0.8) if rng.random() < 0.8 else 0.0 for _ in range(dofs)]
+    inp.target_position = [rng.gauss(0.0, 4.0) for _ in range(dofs)]
+    inp.target_velocity = [rng.gauss(0.0, 0.8) if rng.random() < 0.7 else 0.0 for _ in range(dofs)]
+    inp.target_acceleration = [rng.gauss(0.0, 0.8) if rng.random() < 0.6 else 0.0 for _ in range(dofs)]
+    inp.max_velocity = [rng.uniform(0.1, 12.0) + abs(v) for v in inp.target_velocity]
+    inp.max_acceleration = [rng.uniform(0.1, 12.0) + abs(a) for a in inp.target_acceleration]
+    inp.max_jerk = [rng.uniform(0.1, 12.0) for _ in range(dofs)]
+    return inp
+
+
+def benchmark(dofs: int, number_trajectories: int, cycles_per_input: int = 10):
+    """Per-call duration of the Python API compared to the calculation duration measured natively in C++"""
+    rng = Random(42)
+    otg = Ruckig(dofs, 0.005)
+    inputs = []
+    while len(inputs) < number_trajectories:
+        inp = random_input(dofs, rng)
+        try:
+            if otg.validate_input(inp):
+                inputs.append(inp)
+        except RuntimeError:
+            pass
+
+    trajectory = Trajectory(dofs)
+    calculate, calculate_native = [], []
+    for inp in inputs:
+        start = perf_counter_ns()
+        otg.calculate(inp, trajectory)
+        calculate.append(perf_counter_ns() - start)
+
+        out = OutputParameter(dofs)
+        otg.update(inp, out)
+        calculate_native.append(out.calculation_duration * 1e3)
+
+    update, pass_to_input = [], []
+    for inp in inputs:
+        out = OutputParameter(dofs)
+        otg.update(inp, out)
+        out.pass_to_input(inp)
+
+        # Steady state of the control loop: only the trajectory is sampled
+        for _ in range(cycles_per_input):
+            start = perf_counter_ns()
+            otg.update(inp, out)
+            middle = perf_counter_ns()
+            out.pass_to_input(inp)
+            update.append(middle - start)
+            pass_to_input.append(perf_counter_ns() - middle)
+
+    start = perf_counter_ns()
+    otg.calculate_many(inputs, 1)
+    calculate_many = (perf_counter_ns() - start) / len(inputs)
+
+    samples, generate_duration = 0, 0
+    for inp in inputs[:64]:
+        start = perf_counter_ns()
+        times, _, _, _ = generate(inp, 0.005)
+        generate_duration += perf_counter_ns() - start
+        samples += len(times)
+
+    binding = median(calculate) - median(calculate_native)
+    print(f'{dofs} DoFs: calculate {median(calculate):.0f} ns (native {median(calculate_native):.0f} ns, binding {binding:.0f} ns)'
+          f' | sampling update {median(update):.0f} ns + pass_to_input {median(pass_to_input):.0f} ns'
+          f' | calculate_many {calculate_many:.0f} ns per trajectory'
+          f' | generate {generate_duration / samples:.0f} ns per sample')
+
+
+if __name__ == '__main__':
+    # Compare with the 'Static vs. dynamic DoFs' section of otg-benchmark, as the Python module uses Ruckig<0>
+    for dofs in [3, 7]:
+        benchmark(dofs, 1024)
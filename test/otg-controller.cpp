@@ -0,0 +1,98 @@
+// Checks the real-time wrapper: commands from a second thread, and no allocations within the control loop
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "randomizer.hpp"
+
+#define RUCKIG_ALLOCATION_COUNTER_IMPLEMENT
+#include <ruckig/memory_report.hpp>
+#include <ruckig/realtime_ruckig.hpp>
+
+
+using namespace ruckig;
+
+
+int main() {
+    constexpr size_t DOFs {6};
+    constexpr size_t number_cycles {50000};
+
+    // Configure
+    RealtimeRuckig<DynamicDOFs> controller {DOFs, 0.001};
+    auto& input = controller.get_input();
+    std::fill(input.max_velocity.begin(), input.max_velocity.end(), 2.0);
+    std::fill(input.max_acceleration.begin(), input.max_acceleration.end(), 4.0);
+    std::fill(input.max_jerk.begin(), input.max_jerk.end(), 20.0);
+
+    std::vector<double> durations(number_cycles);
+    const std::vector<double> zeros(DOFs, 0.0);
+
+    std::normal_distribution<double> position_dist {0.0, 1.0};
+    std::uniform_real_distribution<double> limit_dist {0.5, 8.0};
+    Randomizer<DOFs, decltype(position_dist)> p { position_dist, 42 };
+    Randomizer<DOFs, decltype(limit_dist)> l { limit_dist, 44 };
+    std::array<double, DOFs> target_position, max_velocity, max_acceleration, max_jerk;
+
+    // Activate
+    controller.activate(zeros, zeros, zeros);
+
+    std::atomic<bool> running {true};
+    std::atomic<size_t> published {0};
+
+    // Non real-time thread, e.g. the subscription callback of target messages
+    std::thread producer {[&] {
+        while (running.load(std::memory_order_relaxed)) {
+            p.fill(target_position);
+            l.fill(max_velocity);
+            l.fill(max_acceleration);
+            l.fill(max_jerk);
+
+            auto& command = controller.command();
+            command.control_interface = ControlInterface::Position;
+            std::copy(target_position.begin(), target_position.end(), command.target_position.begin());
+            std::fill(command.target_velocity.begin(), command.target_velocity.end(), 0.0);
+            std::fill(command.target_acceleration.begin(), command.target_acceleration.end(), 0.0);
+            std::copy(max_velocity.begin(), max_velocity.end(), command.max_velocity.begin());
+            std::copy(max_acceleration.begin(), max_acceleration.end(), command.max_acceleration.begin());
+            std::copy(max_jerk.begin(), max_jerk.end(), command.max_jerk.begin());
+            command.minimum_duration = std::nullopt;
+            controller.publish_command();
+            published.fetch_add(1, std::memory_order_relaxed);
+
+            std::this_thread::sleep_for(std::chrono::microseconds(700));
+        }
+    }};
+
+    // Starting the thread allocates its state
+    const auto before = AllocationCounter::now();
+
+    // Real-time loop
+    size_t failures {0}, calculations {0};
+    for (size_t i = 0; i < number_cycles; ++i) {
+        const auto start = std::chrono::steady_clock::now();
+        const Result result = controller.update();
+        const auto stop = std::chrono::steady_clock::now();
+        durations[i] = std::chrono::duration<double, std::micro>(stop - start).count();
+
+        if (result != Result::Working && result != Result::Finished) {
+            ++failures;
+        }
+        calculations += controller.get_output().new_calculation;
+    }
+
+    running.store(false, std::memory_order_relaxed);
+    producer.join();
+    const auto loop = AllocationCounter::now() - before;
+
+    std::sort(durations.begin(), durations.end());
+    const auto percentile = [&durations](double q) { return durations[static_cast<size_t>(q * (durations.size() - 1))]; };
+    std::printf("Cycles: %zu, commands: %zu, calculations: %zu, failures: %zu, global allocations: %zu\n", number_cycles, published.load(), calculations, failures, loop.allocations);
+    std::printf("Update [µs]: median %.3f, 99%% %.3f, 99.9%% %.3f, max %.3f (calculations 99.9%% %.3f)\n", percentile(0.5), percentile(0.99), percentile(0.999), durations.back(), controller.latency_statistics.calculation.percentile(0.999));
+    return (loop.allocations == 0 && failures == 0 && calculations > 0) ? 0 : 1;
+}
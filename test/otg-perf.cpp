@@ -0,0 +1,202 @@
+// Performance regression check: runs a fixed, seeded workload and compares its latencies against a stored baseline
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "randomizer.hpp"
+
+#include <ruckig/ruckig.hpp>
+
+
+using namespace ruckig;
+
+
+//! Median and tail latency [µs] of a workload
+struct Latency {
+    double p50, p99;
+};
+
+
+double percentile(const std::vector<double>& sorted, double q) {
+    const size_t index = static_cast<size_t>(std::ceil(q * sorted.size()));
+    return sorted[std::min(std::max<size_t>(index, 1), sorted.size()) - 1];
+}
+
+//! Calculate the same seeded inputs in every repetition after a warm-up, the latencies are the minima over the repetitions
+//! so that interference by the system is filtered out
+template<size_t DOFs>
+Latency measure(size_t number_trajectories, size_t number_repetitions, const std::function<void(InputParameter<DOFs>&)>& configure) {
+    std::normal_distribution<double> position_dist {0.0, 4.0};
+    std::normal_distribution<double> dynamic_dist {0.0, 0.8};
+    std::uniform_real_distribution<double> limit_dist {0.1, 12.0};
+    Randomizer<DOFs, decltype(position_dist)> p { position_dist, 42 };
+    Randomizer<DOFs, decltype(dynamic_dist)> d { dynamic_dist, 43 };
+    Randomizer<DOFs, decltype(limit_dist)> l { limit_dist, 44 };
+
+    Ruckig<DOFs> otg {0.005};
+    std::vector<InputParameter<DOFs>> inputs;
+    InputParameter<DOFs> input;
+    configure(input);
+    while (inputs.size() < number_trajectories) {
+        p.fill(input.current_position);
+        d.fill_or_zero(input.current_velocity, 0.9);
+        d.fill_or_zero(input.current_acceleration, 0.8);
+        p.fill(input.target_position);
+        d.fill_or_zero(input.target_velocity, 0.7);
+        d.fill_or_zero(input.target_acceleration, 0.6);
+        l.fill(input.max_velocity, input.target_velocity);
+        l.fill(input.max_acceleration, input.target_acceleration);
+        l.fill(input.max_jerk);
+        if (otg.validate_input(input)) {
+            inputs.push_back(input);
+        }
+    }
+
+    Trajectory<DOFs> trajectory;
+    for (const auto& warmup_input: inputs) {
+        otg.calculate(warmup_input, trajectory);
+    }
+
+    Latency result {std::numeric_limits<double>::infinity(), std::numeric_limits<double>::infinity()};
+    std::vector<double> durations(inputs.size());
+    for (size_t repetition = 0; repetition < number_repetitions; ++repetition) {
+        for (size_t i = 0; i < inputs.size(); ++i) {
+            const auto start = std::chrono::steady_clock::now();
+            otg.calculate(inputs[i], trajectory);
+            const auto stop = std::chrono::steady_clock::now();
+            durations[i] = std::chrono::duration<double, std::micro>(stop - start).count();
+        }
+
+        std::sort(durations.begin(), durations.end());
+        result.p50 = std::min(result.p50, percentile(durations, 0.5));
+        result.p99 = std::min(result.p99, percentile(durations, 0.99));
+    }
+    return result;
+}
+
+
+std::map<std::string, Latency> read_baseline(const std::string& filename) {
+    std::map<std::string, Latency> baseline;
+    std::ifstream file {filename};
+    std::string line;
+    while (std::getline(file, line)) {
+        if (line.empty() || line[0] == '#') {
+            continue;
+        }
+
+        std::istringstream stream {line};
+        std::string name;
+        Latency latency;
+        if (stream >> name >> latency.p50 >> latency.p99) {
+            baseline[name] = latency;
+        }
+    }
+    return baseline;
+}
+
+void write_baseline(const std::string& filename, const std::vector<std::pair<std::string, Latency>>& results) {
+    std::ofstream file {filename};
+    file << "# ruckig otg-perf baseline: workload, median and 99th percentile latency [µs]" << std::endl;
+    file << std::setprecision(6);
+    for (const auto& [name, latency]: results) {
+        file << name << " " << latency.p50 << " " << latency.p99 << std::endl;
+    }
+}
+
+
+int main(int argc, char** argv) {
+    std::string baseline_filename {"otg-perf-baseline.txt"};
+    bool update_baseline {false};
+    double median_threshold {0.10}, tail_threshold {0.25}; // Allowed relative regressions
+    size_t number_trajectories {4 * 1024}, number_repetitions {7};
+
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg {argv[i]};
+        if (arg == "--update") {
+            update_baseline = true;
+        } else if (i + 1 < argc && arg == "--baseline") {
+            baseline_filename = argv[++i];
+        } else if (i + 1 < argc && arg == "--median-threshold") {
+            median_threshold = std::stod(argv[++i]);
+        } else if (i + 1 < argc && arg == "--tail-threshold") {
+            tail_threshold = std::stod(argv[++i]);
+        } else if (i + 1 < argc && arg == "--trajectories") {
+            number_trajectories = std::stoul(argv[++i]);
+        } else if (i + 1 < argc && arg == "--repetitions") {
+            number_repetitions = std::max<size_t>(std::stoul(argv[++i]), 1);
+        } else {
+            std::cerr << "Usage: otg-perf [--baseline FILE] [--update] [--median-threshold 0.10] [--tail-threshold 0.25] [--trajectories N] [--repetitions N]" << std::endl;
+            return 2;
+        }
+    }
+
+    // Fixed workload, covering Step 1 and Step 2 of both interfaces and the synchronization
+    const std::vector<std::pair<std::string, std::function<Latency()>>> workloads {
+        {"position-1dof", [&]{ return measure<1>(number_trajectories, number_repetitions, [](InputParameter<1>&) { }); }},
+        {"position-3dof", [&]{ return measure<3>(number_trajectories, number_repetitions, [](InputParameter<3>&) { }); }},
+        {"position-7dof", [&]{ return measure<7>(number_trajectories, number_repetitions, [](InputParameter<7>&) { }); }},
+        {"position-phase-7dof", [&]{ return measure<7>(number_trajectories, number_repetitions, [](InputParameter<7>& input) { input.synchronization = Synchronization::Phase; }); }},
+        {"position-discrete-7dof", [&]{ return measure<7>(number_trajectories, number_repetitions, [](InputParameter<7>& input) { input.duration_discretization = DurationDiscretization::Discrete; }); }},
+        {"velocity-7dof", [&]{ return measure<7>(number_trajectories, number_repetitions, [](InputParameter<7>& input) { input.control_interface = ControlInterface::Velocity; }); }},
+    };
+
+    std::vector<std::pair<std::string, Latency>> results;
+    for (const auto& [name, workload]: workloads) {
+        results.emplace_back(name, workload());
+    }
+
+    const auto baseline = read_baseline(baseline_filename);
+    if (update_baseline || baseline.empty()) {
+        write_baseline(baseline_filename, results);
+        for (const auto& [name, latency]: results) {
+            std::cout << std::left << std::setw(24) << name << " p50 " << latency.p50 << "  p99 " << latency.p99 << " [µs]" << std::endl;
+        }
+        std::cout << "Baseline written to " << baseline_filename << std::endl;
+        return 0;
+    }
+
+    bool regressed {false};
+    for (size_t i = 0; i < workloads.size(); ++i) {
+        auto& [name, latency] = results[i];
+        const auto it = baseline.find(name);
+        if (it == baseline.end()) {
+            std::cout << std::left << std::setw(24) << name << " not in the baseline" << std::endl;
+            continue;
+        }
+
+        const auto is_regressed = [&]() {
+            return (latency.p50 / it->second.p50 - 1.0 > median_threshold) || (latency.p99 / it->second.p99 - 1.0 > tail_threshold);
+        };
+
+        // Confirm a regression by measuring again, so that a single disturbed measurement does not fail the check
+        for (size_t confirmation = 0; confirmation < 2 && is_regressed(); ++confirmation) {
+            const Latency again = workloads[i].second();
+            latency.p50 = std::min(latency.p50, again.p50);
+            latency.p99 = std::min(latency.p99, again.p99);
+        }
+
+        const bool workload_regressed = is_regressed();
+        regressed |= workload_regressed;
+
+        std::cout << std::left << std::setw(24) << name << std::fixed << std::setprecision(3)
+            << " p50 " << latency.p50 << " (" << std::showpos << 100 * (latency.p50 / it->second.p50 - 1.0) << std::noshowpos << "%)"
+            << "  p99 " << latency.p99 << " (" << std::showpos << 100 * (latency.p99 / it->second.p99 - 1.0) << std::noshowpos << "%) [µs]"
+            << (workload_regressed ? "  REGRESSION" : "") << std::endl;
+    }
+
+    if (regressed) {
+        std::cout << "Latency regressed beyond the thresholds of " << 100 * median_threshold << "% (median) and " << 100 * tail_threshold << "% (99th percentile) compared to " << baseline_filename << std::endl;
+        return 1;
+    }
+    return 0;
+}
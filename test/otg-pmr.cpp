@@ -0,0 +1,75 @@
+// Checks the polymorphic allocators: built with RUCKIG_PMR, all dynamic-DoF state is placed in a fixed arena
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdio>
+#include <memory_resource>
+#include <random>
+
+#include "randomizer.hpp"
+
+#define RUCKIG_ALLOCATION_COUNTER_IMPLEMENT
+#include <ruckig/memory_report.hpp>
+
+
+using namespace ruckig;
+
+
+int main() {
+    constexpr size_t DOFs {3};
+    constexpr size_t number_cycles {20000};
+    static_assert(pmr_containers, "This check needs to be built with RUCKIG_PMR.");
+
+    // Without an upstream resource, any allocation beyond the arena fails
+    alignas(std::max_align_t) static std::array<std::byte, 1 << 20> buffer;
+    std::pmr::monotonic_buffer_resource arena {buffer.data(), buffer.size(), std::pmr::null_memory_resource()};
+
+    const auto before_construction = AllocationCounter::now();
+    ScopedMemoryResource scope {&arena};
+    Ruckig<DynamicDOFs> otg {DOFs, 0.005};
+    InputParameter<DynamicDOFs> input {DOFs};
+    OutputParameter<DynamicDOFs> output {DOFs};
+    Trajectory<DynamicDOFs> trajectory {DOFs};
+
+    // Growing intermediate positions are placed in the arena as well
+    for (size_t i = 0; i < 16; ++i) {
+        input.intermediate_positions.push_back({0.1 * i, -0.1 * i, 0.0});
+    }
+    input.intermediate_positions.clear();
+    const auto construction = AllocationCounter::now() - before_construction;
+
+    std::normal_distribution<double> position_dist {0.0, 4.0};
+    std::uniform_real_distribution<double> limit_dist {0.08, 12.0};
+    Randomizer<DOFs, decltype(position_dist)> p { position_dist, 42 };
+    Randomizer<DOFs, decltype(limit_dist)> l { limit_dist, 44 };
+    std::array<double, DOFs> target_position, max_velocity, max_acceleration, max_jerk;
+
+    size_t failures {0};
+    const auto before_cycles = AllocationCounter::now();
+    for (size_t i = 0; i < number_cycles; ++i) {
+        if (i % 500 == 0) {
+            p.fill(target_position);
+            l.fill(max_velocity);
+            l.fill(max_acceleration);
+            l.fill(max_jerk);
+            std::copy(target_position.begin(), target_position.end(), input.target_position.begin());
+            std::copy(max_velocity.begin(), max_velocity.end(), input.max_velocity.begin());
+            std::copy(max_acceleration.begin(), max_acceleration.end(), input.max_acceleration.begin());
+            std::copy(max_jerk.begin(), max_jerk.end(), input.max_jerk.begin());
+            if (otg.calculate(input, trajectory) != Result::Working) {
+                ++failures;
+            }
+        }
+
+        const Result result = otg.update(input, output);
+        if (result != Result::Working && result != Result::Finished) {
+            ++failures;
+        }
+        output.pass_to_input(input);
+    }
+    const auto cycles = AllocationCounter::now() - before_cycles;
+
+    std::printf("Global allocations: construction %zu, cycles %zu, failures: %zu\n", construction.allocations, cycles.allocations, failures);
+    return (construction.allocations == 0 && cycles.allocations == 0 && failures == 0) ? 0 : 1;
+}
@@ -0,0 +1,74 @@
+// Checks the hard real-time profile: built with RUCKIG_HARD_REALTIME and without exceptions
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#include "randomizer.hpp"
+
+#include <ruckig/ruckig.hpp>
+
+#if defined(__GLIBCXX__) && (defined(_GLIBCXX_IOSTREAM) || defined(_GLIBCXX_SSTREAM) || defined(_GLIBCXX_IOMANIP))
+    #error "The hard real-time profile must not include any stream headers."
+#endif
+
+
+using namespace ruckig;
+
+
+int main() {
+    constexpr size_t DOFs {3};
+    constexpr size_t number_trajectories {20000};
+    static_assert(hard_realtime, "This check needs to be built with RUCKIG_HARD_REALTIME.");
+
+    std::normal_distribution<double> position_dist {0.0, 4.0};
+    std::normal_distribution<double> dynamic_dist {0.0, 0.8};
+    std::uniform_real_distribution<double> limit_dist {0.08, 12.0};
+    Randomizer<DOFs, decltype(position_dist)> p { position_dist, 42 };
+    Randomizer<DOFs, decltype(dynamic_dist)> d { dynamic_dist, 43 };
+    Randomizer<DOFs, decltype(limit_dist)> l { limit_dist, 44 };
+
+    Ruckig<DOFs> otg {0.005};
+    InputParameter<DOFs> input;
+    Trajectory<DOFs> trajectory;
+    size_t failures {0};
+    std::vector<double> durations;
+    durations.reserve(number_trajectories);
+
+    for (size_t i = 0; i < number_trajectories; ++i) {
+        p.fill(input.current_position);
+        d.fill_or_zero(input.current_velocity, 0.9);
+        d.fill_or_zero(input.current_acceleration, 0.8);
+        p.fill(input.target_position);
+        d.fill_or_zero(input.target_velocity, 0.7);
+        l.fill(input.max_velocity, input.target_velocity);
+        l.fill(input.max_acceleration);
+        l.fill(input.max_jerk);
+        if (!otg.validate_input(input)) {
+            continue;
+        }
+
+        const auto start = std::chrono::steady_clock::now();
+        const Result result = otg.calculate(input, trajectory);
+        const auto stop = std::chrono::steady_clock::now();
+        durations.push_back(std::chrono::duration<double, std::micro>(stop - start).count());
+
+        if (result != Result::Working || otg.get_error().result != Result::Working) {
+            ++failures;
+        }
+    }
+
+    // Errors are reported through the error record only
+    input.max_jerk[1] = -1.0;
+    if (otg.calculate(input, trajectory) != Result::ErrorInvalidInput || otg.get_error().phase != CalculationPhase::Validation) {
+        ++failures;
+    }
+
+    std::sort(durations.begin(), durations.end());
+    const auto percentile = [&durations](double q) { return durations[static_cast<size_t>(q * (durations.size() - 1))]; };
+    std::printf("Calculations: %zu, failures: %zu\n", durations.size(), failures);
+    std::printf("Duration [µs]: median %.3f, 99%% %.3f, 99.9%% %.3f, max %.3f\n", percentile(0.5), percentile(0.99), percentile(0.999), durations.back());
+    return (failures == 0) ? 0 : 1;
+}
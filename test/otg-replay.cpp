@@ -0,0 +1,146 @@
+// Replays a recorded input stream (see InputRecorder) through the trajectory calculation with per-call timing
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <iterator>
+#include <limits>
+#include <string>
+#include <vector>
+
+#include <ruckig/input_recorder.hpp>
+#include <ruckig/ruckig.hpp>
+
+
+using namespace ruckig;
+
+
+//! A recorded input and the result of its replay
+struct Call {
+    uint64_t cycle;
+    InputParameter<0> input;
+    Result result;
+    double duration {std::numeric_limits<double>::infinity()}; // Minimum over the repetitions [µs]
+};
+
+
+std::vector<Call> read_recording(const std::string& filename) {
+    std::ifstream file {filename, std::ios::binary};
+    const std::vector<uint8_t> data {std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>()};
+    if (!InputRecording::read_header(data.data(), data.size())) {
+        std::cerr << "No valid input recording: " << filename << std::endl;
+        return {};
+    }
+
+    std::vector<Call> calls;
+    size_t offset {InputRecording::header_size};
+    uint64_t cycle;
+    InputParameter<0> input {1};
+    while (InputRecording::read_record(data.data(), data.size(), offset, cycle, input)) {
+        calls.push_back({cycle, input, Result::Working});
+    }
+    if (offset != data.size()) {
+        std::cerr << "Skipped an incomplete record at the end of the recording." << std::endl;
+    }
+    return calls;
+}
+
+
+int main(int argc, char** argv) {
+    std::string filename;
+    size_t number_repetitions {5}, first {0}, count {std::numeric_limits<size_t>::max()}, number_slowest {0};
+    double delta_time {0.001};
+    bool per_call {false};
+
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg {argv[i]};
+        if (arg == "--per-call") {
+            per_call = true;
+        } else if (i + 1 < argc && arg == "--repetitions") {
+            number_repetitions = std::max<size_t>(std::stoul(argv[++i]), 1);
+        } else if (i + 1 < argc && arg == "--first") {
+            first = std::stoul(argv[++i]);
+        } else if (i + 1 < argc && arg == "--count") {
+            count = std::stoul(argv[++i]);
+        } else if (i + 1 < argc && arg == "--slowest") {
+            number_slowest = std::stoul(argv[++i]);
+        } else if (i + 1 < argc && arg == "--delta-time") {
+            delta_time = std::stod(argv[++i]);
+        } else if (filename.empty() && arg[0] != '-') {
+            filename = arg;
+        } else {
+            filename.clear();
+            break;
+        }
+    }
+    if (filename.empty()) {
+        std::cerr << "Usage: otg-replay RECORDING [--repetitions 5] [--first N] [--count N] [--per-call] [--slowest K] [--delta-time 0.001]" << std::endl;
+        return 2;
+    }
+
+    std::vector<Call> calls = read_recording(filename);
+    if (calls.empty()) {
+        return 1;
+    }
+
+    // Bisect a regression by replaying a range of the records only
+    first = std::min(first, calls.size());
+    calls.erase(calls.begin(), calls.begin() + first);
+    calls.erase(calls.begin() + std::min(count, calls.size()), calls.end());
+    if (calls.empty()) {
+        std::cerr << "No records in the given range." << std::endl;
+        return 1;
+    }
+
+    // The records of a recording have the same number of DoFs as the recorded instance
+    const size_t dofs = calls.front().input.degrees_of_freedom;
+    Ruckig<0> otg {dofs, delta_time};
+    Trajectory<0> trajectory {dofs};
+    for (size_t repetition = 0; repetition < number_repetitions; ++repetition) {
+        for (auto& call: calls) {
+            if (call.input.degrees_of_freedom != dofs) {
+                call.result = Result::ErrorInvalidInput;
+                continue;
+            }
+
+            const auto start = std::chrono::steady_clock::now();
+            call.result = otg.calculate(call.input, trajectory);
+            const auto stop = std::chrono::steady_clock::now();
+            call.duration = std::min(call.duration, std::chrono::duration<double, std::micro>(stop - start).count());
+        }
+    }
+
+    size_t errors {0};
+    std::vector<double> durations;
+    durations.reserve(calls.size());
+    for (size_t i = 0; i < calls.size(); ++i) {
+        const Call& call = calls[i];
+        errors += (call.result < 0);
+        durations.push_back(call.duration);
+        if (per_call) {
+            std::cout << (first + i) << " " << call.cycle << " " << call.result << " " << std::fixed << std::setprecision(3) << call.duration << std::defaultfloat << std::endl;
+        }
+    }
+
+    std::sort(durations.begin(), durations.end());
+    const auto percentile = [&durations](double q) { return durations[static_cast<size_t>(q * (durations.size() - 1))]; };
+    std::cout << "Replayed " << calls.size() << " inputs (records " << first << " to " << (first + calls.size() - 1) << ") of " << filename << ", errors: " << errors << std::endl;
+    std::cout << std::fixed << std::setprecision(3) << "Calculation duration [µs]: median " << percentile(0.5) << ", 99% " << percentile(0.99) << ", max " << durations.back() << std::defaultfloat << std::endl;
+
+    if (number_slowest > 0) {
+        std::vector<size_t> indices(calls.size());
+        for (size_t i = 0; i < indices.size(); ++i) {
+            indices[i] = i;
+        }
+        const size_t k = std::min(number_slowest, indices.size());
+        std::partial_sort(indices.begin(), indices.begin() + k, indices.end(), [&calls](size_t a, size_t b) { return calls[a].duration > calls[b].duration; });
+        for (size_t i = 0; i < k; ++i) {
+            const Call& call = calls[indices[i]];
+            std::cout << "\nRecord " << (first + indices[i]) << " (cycle " << call.cycle << "): " << call.duration << " µs, result " << call.result << call.input.to_string();
+        }
+        std::cout << std::endl;
+    }
+    return 0;
+}
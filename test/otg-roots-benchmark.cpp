@@ -0,0 +1,375 @@
+// Microbenchmarks of the polynomial solvers in roots.hpp on corpora captured from PositionStep2 calls
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "randomizer.hpp"
+
+#include <ruckig/ruckig.hpp>
+
+#ifndef RUCKIG_CAPTURE_ROOTS
+#error "otg-roots-benchmark requires the solver hooks of RUCKIG_CAPTURE_ROOTS"
+#endif
+
+
+using namespace ruckig;
+
+
+//! Arguments of a shrinkInterval call
+struct Interval {
+    size_t n;
+    std::array<double, 7> p;
+    double l, h;
+};
+
+//! Arguments of all solver calls of a set of PositionStep2 calculations
+struct Corpus {
+    std::vector<std::array<double, 4>> cubics, quartics;
+    std::vector<std::array<double, 3>> resolvents;
+    std::vector<Interval> intervals;
+
+    size_t size() const {
+        return cubics.size() + quartics.size() + resolvents.size() + intervals.size();
+    }
+};
+
+Corpus* capturing {nullptr};
+size_t last_iterations {0};
+
+
+void set_capture(Corpus* corpus) {
+    capturing = corpus;
+    if (!corpus) {
+        Roots::Capture::cubic = nullptr;
+        Roots::Capture::resolvent = nullptr;
+        Roots::Capture::quartic = nullptr;
+        Roots::Capture::interval = nullptr;
+        return;
+    }
+
+    Roots::Capture::cubic = [](double a, double b, double c, double d) { capturing->cubics.push_back({a, b, c, d}); };
+    Roots::Capture::resolvent = [](double a, double b, double c) { capturing->resolvents.push_back({a, b, c}); };
+    Roots::Capture::quartic = [](double a, double b, double c, double d) { capturing->quartics.push_back({a, b, c, d}); };
+    Roots::Capture::interval = [](const double* p, size_t n, double l, double h) {
+        if (n <= 7) {
+            Interval interval {n, {}, l, h};
+            std::copy(p, p + n, interval.p.begin());
+            capturing->intervals.push_back(interval);
+        }
+    };
+}
+
+//! Capture the solver calls of the Step 2 calculations of seeded random 3-DoF inputs
+Corpus capture(size_t number_trajectories) {
+    std::normal_distribution<double> position_dist {0.0, 4.0};
+    std::normal_distribution<double> dynamic_dist {0.0, 0.8};
+    std::uniform_real_distribution<double> limit_dist {0.1, 12.0};
+    Randomizer<3, decltype(position_dist)> p { position_dist, 42 };
+    Randomizer<3, decltype(dynamic_dist)> d { dynamic_dist, 43 };
+    Randomizer<3, decltype(limit_dist)> l { limit_dist, 44 };
+
+    Ruckig<3> otg {0.005};
+    InputParameter<3> input;
+    Trajectory<3> trajectory;
+    Corpus corpus;
+    for (size_t i = 0; i < number_trajectories; ++i) {
+        p.fill(input.current_position);
+        d.fill_or_zero(input.current_velocity, 0.9);
+        d.fill_or_zero(input.current_acceleration, 0.8);
+        p.fill(input.target_position);
+        d.fill_or_zero(input.target_velocity, 0.7);
+        d.fill_or_zero(input.target_acceleration, 0.6);
+        l.fill(input.max_velocity, input.target_velocity);
+        l.fill(input.max_acceleration, input.target_acceleration);
+        l.fill(input.max_jerk);
+        for (size_t dof = 0; dof < 3; ++dof) {
+            input.max_velocity[dof] = std::max(input.max_velocity[dof], std::abs(input.current_velocity[dof]));
+            input.max_acceleration[dof] = std::max(input.max_acceleration[dof], std::abs(input.current_acceleration[dof]));
+        }
+
+        if (!otg.validate_input(input) || otg.calculate(input, trajectory) != Result::Working) {
+            continue;
+        }
+
+        // Repeat the Step 2 calls of the time synchronization to the trajectory duration
+        const double tf = trajectory.get_duration();
+        const auto min_durations = trajectory.get_independent_min_durations();
+        for (size_t dof = 0; dof < 3; ++dof) {
+            if (min_durations[dof] >= tf) {
+                continue;
+            }
+
+            Profile profile;
+            set_capture(&corpus);
+            PositionStep2 step2 {tf, input.current_position[dof], input.current_velocity[dof], input.current_acceleration[dof], input.target_position[dof], input.target_velocity[dof], input.target_acceleration[dof], input.max_velocity[dof], -input.max_velocity[dof], input.max_acceleration[dof], -input.max_acceleration[dof], input.max_jerk[dof]};
+            step2.get_profile(profile);
+            set_capture(nullptr);
+        }
+    }
+    return corpus;
+}
+
+
+//! Text format of a corpus with bit-exact (hexadecimal) doubles, one solver call per line
+void write_corpus(std::ostream& os, const Corpus& corpus) {
+    os << std::hexfloat;
+    for (const auto& c: corpus.cubics) {
+        os << "cubic " << c[0] << " " << c[1] << " " << c[2] << " " << c[3] << "\n";
+    }
+    for (const auto& c: corpus.resolvents) {
+        os << "resolvent " << c[0] << " " << c[1] << " " << c[2] << "\n";
+    }
+    for (const auto& c: corpus.quartics) {
+        os << "quartic " << c[0] << " " << c[1] << " " << c[2] << " " << c[3] << "\n";
+    }
+    for (const auto& interval: corpus.intervals) {
+        os << "interval " << interval.n;
+        for (size_t i = 0; i < interval.n; ++i) {
+            os << " " << interval.p[i];
+        }
+        os << " " << interval.l << " " << interval.h << "\n";
+    }
+    os << std::defaultfloat;
+}
+
+Corpus read_corpus(std::istream& is) {
+    Corpus corpus;
+    std::string line;
+    while (std::getline(is, line)) {
+        std::istringstream ss {line};
+        std::string type, token;
+        ss >> type;
+
+        // Parse with strtod, as reading hexadecimal floats via streams is not supported by all standard libraries
+        const auto next = [&ss, &token]() { ss >> token; return std::strtod(token.c_str(), nullptr); };
+        if (type == "cubic") {
+            corpus.cubics.push_back({next(), next(), next(), next()});
+        } else if (type == "resolvent") {
+            corpus.resolvents.push_back({next(), next(), next()});
+        } else if (type == "quartic") {
+            corpus.quartics.push_back({next(), next(), next(), next()});
+        } else if (type == "interval") {
+            Interval interval {};
+            if (ss >> interval.n && interval.n <= 7) {
+                for (size_t i = 0; i < interval.n; ++i) {
+                    interval.p[i] = next();
+                }
+                interval.l = next();
+                interval.h = next();
+                corpus.intervals.push_back(interval);
+            }
+        }
+    }
+    return corpus;
+}
+
+
+//! Polish a root with Newton's method in extended precision as reference
+template<class Polynomial>
+long double polish(const Polynomial& p, long double x) {
+    for (size_t i = 0; i < 64; ++i) {
+        long double f {0.0}, df {0.0};
+        for (const long double c: p) {
+            df = df * x + f;
+            f = f * x + c;
+        }
+        if (df == 0.0) {
+            break;
+        }
+
+        const long double dx = f / df;
+        x -= dx;
+        if (std::abs(dx) <= std::numeric_limits<long double>::epsilon() * std::abs(x)) {
+            break;
+        }
+    }
+    return x;
+}
+
+//! Relative errors of the roots compared to the high-precision reference
+struct Accuracy {
+    size_t roots {0}, inaccurate {0};
+    double max_error {0.0}, sum_error {0.0};
+
+    void add(double root, long double reference) {
+        const double error = static_cast<double>(std::abs(root - reference) / std::max<long double>(1.0, std::abs(reference)));
+        roots += 1;
+        inaccurate += (error > 1e-8) ? 1 : 0;
+        max_error = std::max(max_error, error);
+        sum_error += error;
+    }
+};
+
+template<size_t N>
+std::array<double, N> coefficients(const Interval& interval) {
+    std::array<double, N> p;
+    std::copy(interval.p.begin(), interval.p.begin() + N, p.begin());
+    return p;
+}
+
+template<class F>
+double shrink_dispatch(const Interval& interval, F&& f) {
+    switch (interval.n) {
+        case 4: return f(coefficients<4>(interval));
+        case 5: return f(coefficients<5>(interval));
+        case 6: return f(coefficients<6>(interval));
+        case 7: return f(coefficients<7>(interval));
+        default: return 0.0;
+    }
+}
+
+
+//! Duration per call [ns], the minimum over the repetitions
+template<class T, class F>
+double time_per_call(const std::vector<T>& calls, size_t number_repetitions, F&& f) {
+    if (calls.empty()) {
+        return 0.0;
+    }
+
+    volatile double sink {0.0};
+    double best {std::numeric_limits<double>::infinity()};
+    for (size_t repetition = 0; repetition < number_repetitions; ++repetition) {
+        double sum {0.0};
+        const auto start = std::chrono::steady_clock::now();
+        for (const auto& call: calls) {
+            sum += f(call);
+        }
+        const auto stop = std::chrono::steady_clock::now();
+        sink = sink + sum;
+        best = std::min(best, std::chrono::duration<double, std::nano>(stop - start).count() / calls.size());
+    }
+    return best;
+}
+
+void print(const std::string& name, size_t calls, double ns, const Accuracy& accuracy) {
+    std::cout << std::left << std::setw(16) << name << std::right << std::setw(8) << calls << " calls  " << std::fixed << std::setprecision(1) << std::setw(7) << ns << " ns" << std::defaultfloat << std::setprecision(3);
+    if (accuracy.roots > 0) {
+        std::cout << "  roots " << accuracy.roots << "  mean error " << accuracy.sum_error / accuracy.roots << "  max error " << accuracy.max_error << "  > 1e-8: " << accuracy.inaccurate;
+    }
+    std::cout << std::endl;
+}
+
+
+int main(int argc, char** argv) {
+    size_t number_trajectories {16 * 1024}, number_repetitions {10};
+    std::string corpus_filename, write_filename;
+
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg {argv[i]};
+        if (i + 1 < argc && arg == "--trajectories") {
+            number_trajectories = std::stoul(argv[++i]);
+        } else if (i + 1 < argc && arg == "--repetitions") {
+            number_repetitions = std::max<size_t>(std::stoul(argv[++i]), 1);
+        } else if (i + 1 < argc && arg == "--corpus") {
+            corpus_filename = argv[++i];
+        } else if (i + 1 < argc && arg == "--write") {
+            write_filename = argv[++i];
+        } else {
+            std::cerr << "Usage: otg-roots-benchmark [--trajectories N] [--repetitions N] [--corpus FILE] [--write FILE]" << std::endl;
+            return 2;
+        }
+    }
+
+    Corpus corpus;
+    if (!corpus_filename.empty()) {
+        std::ifstream file {corpus_filename};
+        corpus = read_corpus(file);
+    } else {
+        corpus = capture(number_trajectories);
+    }
+
+    if (!write_filename.empty()) {
+        std::ofstream file {write_filename};
+        write_corpus(file, corpus);
+    }
+
+    std::cout << "Corpus with " << corpus.size() << " solver calls" << std::endl;
+
+    // solveCub
+    Accuracy cubic_accuracy;
+    for (const auto& c: corpus.cubics) {
+        for (const double root: Roots::solveCub(c[0], c[1], c[2], c[3])) {
+            cubic_accuracy.add(root, polish(std::array<long double, 4> {c[0], c[1], c[2], c[3]}, root));
+        }
+    }
+    const double cubic_ns = time_per_call(corpus.cubics, number_repetitions, [](const auto& c) {
+        double sum {0.0};
+        for (const double root: Roots::solveCub(c[0], c[1], c[2], c[3])) {
+            sum += root;
+        }
+        return sum;
+    });
+    print("solveCub", corpus.cubics.size(), cubic_ns, cubic_accuracy);
+
+    // solveResolvent, only the real roots are compared
+    Accuracy resolvent_accuracy;
+    for (const auto& c: corpus.resolvents) {
+        double x[3];
+        const int zeros = Roots::solveResolvent(x, c[0], c[1], c[2]);
+        for (int i = 0; i < zeros; ++i) {
+            resolvent_accuracy.add(x[i], polish(std::array<long double, 4> {1.0, c[0], c[1], c[2]}, x[i]));
+        }
+    }
+    const double resolvent_ns = time_per_call(corpus.resolvents, number_repetitions, [](const auto& c) {
+        double x[3];
+        return Roots::solveResolvent(x, c[0], c[1], c[2]) + x[0];
+    });
+    print("solveResolvent", corpus.resolvents.size(), resolvent_ns, resolvent_accuracy);
+
+    // solveQuartMonic, the hook would capture the resolvent calls again
+    Roots::Capture::resolvent = nullptr;
+    Accuracy quartic_accuracy;
+    for (const auto& c: corpus.quartics) {
+        for (const double root: Roots::solveQuartMonic(c[0], c[1], c[2], c[3])) {
+            quartic_accuracy.add(root, polish(std::array<long double, 5> {1.0, c[0], c[1], c[2], c[3]}, root));
+        }
+    }
+    const double quartic_ns = time_per_call(corpus.quartics, number_repetitions, [](const auto& c) {
+        double sum {0.0};
+        for (const double root: Roots::solveQuartMonic(c[0], c[1], c[2], c[3])) {
+            sum += root;
+        }
+        return sum;
+    });
+    print("solveQuartMonic", corpus.quartics.size(), quartic_ns, quartic_accuracy);
+
+    // polyEval in the middle of the intervals
+    const double eval_ns = time_per_call(corpus.intervals, number_repetitions, [](const Interval& interval) {
+        return shrink_dispatch(interval, [&interval](const auto& p) { return Roots::polyEval(p, (interval.l + interval.h) / 2); });
+    });
+    print("polyEval", corpus.intervals.size(), eval_ns, Accuracy());
+
+    // shrinkInterval, as multiple roots might be inside the interval the reference is the nearest root
+    Accuracy shrink_accuracy;
+    size_t sum_iterations {0}, max_iterations {0};
+    Roots::Capture::iterations = [](size_t iterations) { last_iterations = iterations; };
+    for (const auto& interval: corpus.intervals) {
+        last_iterations = 0;
+        const double root = shrink_dispatch(interval, [&interval](const auto& p) { return Roots::shrinkInterval(p, interval.l, interval.h); });
+        sum_iterations += last_iterations;
+        max_iterations = std::max(max_iterations, last_iterations);
+
+        std::array<long double, 7> p;
+        std::copy(interval.p.begin(), interval.p.begin() + interval.n, p.begin());
+        shrink_accuracy.add(root, polish(std::vector<long double>(p.begin(), p.begin() + interval.n), root));
+    }
+    Roots::Capture::iterations = nullptr;
+
+    const double shrink_ns = time_per_call(corpus.intervals, number_repetitions, [](const Interval& interval) {
+        return shrink_dispatch(interval, [&interval](const auto& p) { return Roots::shrinkInterval(p, interval.l, interval.h); });
+    });
+    print("shrinkInterval", corpus.intervals.size(), shrink_ns, shrink_accuracy);
+    if (!corpus.intervals.empty()) {
+        std::cout << "shrinkInterval iterations: mean " << static_cast<double>(sum_iterations) / corpus.intervals.size() << "  max " << max_iterations << " (limit " << Roots::max_iterations << ")" << std::endl;
+    }
+}
@@ -1,10 +1,28 @@
 #define DOCTEST_CONFIG_IMPLEMENT
 #include "doctest.h"
 
+#include <fstream>
 #include <random>
+#include <sstream>
+#include "corpus.hpp"
 #include "randomizer.hpp"
 
 #include <ruckig/ruckig.hpp>
+#include <ruckig/async_ruckig.hpp>
+#include <ruckig/batch_ruckig.hpp>
+#include <ruckig/candidate_batch.hpp>
+#include <ruckig/fixed_point_trajectory.hpp>
+#include <ruckig/segment_table.hpp>
+#include <ruckig/waypoint_stream.hpp>
+#include <ruckig/serialization.hpp>
+#include <ruckig/compact_trajectory.hpp>
+#include <ruckig/input_recorder.hpp>
+#include <ruckig/trajectory_export.hpp>
+#include <ruckig/velocity_ruckig.hpp>
+#include <ruckig/ruckig_c.h>
+
+#define RUCKIG_ALLOCATION_COUNTER_IMPLEMENT
+#include <ruckig/memory_report.hpp>
 
 #ifdef WITH_REFLEXXES
 #include <ruckig/reflexxes_comparison.hpp>
@@ -14,6 +32,86 @@
 using namespace ruckig;
 
 
+//! Captures the inputs of the checks into a benchmark corpus with a section per test case (see --write-corpus)
+
+//! The known examples are kept completely, while only the slowest inputs of each random test case are kept, as
+//! their random distribution is benchmarked by otg-benchmark already.
+class CorpusCapture: public doctest::IReporter {
+    struct Entry {
+        double duration; // [µs]
+        std::string line;
+    };
+
+    std::vector<std::pair<std::string, std::vector<Entry>>> sections;
+
+public:
+    static inline std::string filename;
+    static inline size_t max_random_inputs {64};
+    static inline CorpusCapture* instance {nullptr};
+
+    explicit CorpusCapture(const doctest::ContextOptions&) {
+        instance = this;
+    }
+
+    template<size_t DOFs>
+    void add(const InputParameter<DOFs>& input, double duration, bool keep_all) {
+        if (filename.empty() || sections.empty()) {
+            return;
+        }
+
+        auto& entries = sections.back().second;
+        if (!keep_all && entries.size() >= max_random_inputs) {
+            const auto fastest = std::min_element(entries.begin(), entries.end(), [](const Entry& a, const Entry& b) { return a.duration < b.duration; });
+            if (fastest->duration >= duration) {
+                return;
+            }
+            entries.erase(fastest);
+        }
+
+        std::ostringstream line;
+        corpus::write_input(line, input);
+        entries.push_back({duration, line.str()});
+    }
+
+    void test_case_start(const doctest::TestCaseData& data) override {
+        sections.push_back({data.m_name, {}});
+    }
+
+    void test_run_end(const doctest::TestRunStats&) override {
+        if (filename.empty()) {
+            return;
+        }
+
+        std::ofstream file {filename};
+        file << "# Corpus of the otg-test inputs: the known examples and the slowest inputs of each random test case\n";
+        for (const auto& [name, entries]: sections) {
+            if (entries.empty()) {
+                continue;
+            }
+
+            corpus::write_section(file, name);
+            for (const auto& entry: entries) {
+                file << entry.line;
+            }
+        }
+        std::cout << "Corpus written to " << filename << std::endl;
+    }
+
+    void report_query(const doctest::QueryData&) override { }
+    void test_run_start() override { }
+    void test_case_reenter(const doctest::TestCaseData&) override { }
+    void test_case_end(const doctest::CurrentTestCaseStats&) override { }
+    void test_case_exception(const doctest::TestCaseException&) override { }
+    void subcase_start(const doctest::SubcaseSignature&) override { }
+    void subcase_end() override { }
+    void log_assert(const doctest::AssertData&) override { }
+    void log_message(const doctest::MessageData&) override { }
+    void test_case_skipped(const doctest::TestCaseData&) override { }
+};
+
+REGISTER_LISTENER("corpus", 1, CorpusCapture);
+
+
 namespace ruckig {
     template<size_t DOFs>
     std::ostream& operator<< (std::ostream& os, const InputParameter<DOFs>& value) {
@@ -26,6 +124,7 @@ namespace ruckig {
 template<size_t DOFs, class OTGType>
 inline void check_duration(OTGType& otg, InputParameter<DOFs>& input, double duration) {
     OutputParameter<DOFs> output;
+    const InputParameter<DOFs> initial_input {input};
 
     while (otg.update(input, output) == Result::Working) {
         input.current_position = output.new_position;
@@ -34,6 +133,9 @@ inline void check_duration(OTGType& otg, InputParameter<DOFs>& input, double dur
     }
 
     CHECK( output.trajectory.get_duration() == doctest::Approx(duration) );
+    if (CorpusCapture::instance) {
+        CorpusCapture::instance->add(initial_input, 0.0, true);
+    }
 }
 
 
@@ -50,6 +152,9 @@ inline void check_calculation(OTGType& otg, InputParameter<DOFs>& input) {
 
     CHECK( (result == Result::Working || (result == Result::Finished && output.trajectory.get_duration() < 0.005)) );
     CHECK( output.trajectory.get_duration() >= 0.0 );
+    if (CorpusCapture::instance) {
+        CorpusCapture::instance->add(input, output.calculation_duration, false);
+    }
 
     for (size_t dof = 0; dof < otg.degrees_of_freedom; ++dof) {
         CHECK_FALSE( (std::isnan(output.new_position[dof]) || std::isnan(output.new_velocity[dof]) || std::isnan(output.new_acceleration[dof])) );
@@ -95,180 +200,3856 @@ inline void check_comparison(OTGType& otg, InputParameter<DOFs>& input, OTGCompT
     }
 
     CHECK( (result == Result::Working || (result == Result::Finished && output.trajectory.get_duration() < 0.005)) );
+    if (CorpusCapture::instance) {
+        CorpusCapture::instance->add(input, output.calculation_duration, false);
+    }
+
+    OutputParameter<DOFs> output_comparison;
+    auto result_comparison = otg_comparison.update(input, output_comparison);
+    CHECK( output.trajectory.get_duration() <= doctest::Approx(output_comparison.trajectory.get_duration()) );
+}
+
+
+int seed {42};
+size_t number_trajectories {150000}; // Some user variable you want to be able to set
+size_t random_1, random_3, random_3_high, step_through_3, random_discrete_3, random_direction_3, comparison_1, comparison_3, velocity_random_3;
+
+std::normal_distribution<double> position_dist {0.0, 4.0};
+std::normal_distribution<double> dynamic_dist {0.0, 0.8};
+std::uniform_real_distribution<double> limit_dist {0.08, 16.0};
+std::uniform_real_distribution<double> limit_dist_high {10.0, 1000000.0};
+// std::uniform_real_distribution<double> limit_dist {800.0, 160000.0};
+std::uniform_real_distribution<double> min_limit_dist {-16.0, -0.08};
+
+
+template<class T>
+void check_array(const T& first, const T& second) {
+    for (size_t dof = 0; dof < first.size(); ++dof) {
+        CHECK( first[dof] == doctest::Approx(second[dof]) );
+    }
+}
+
+
+TEST_CASE("secondary" * doctest::description("Secondary Features")) {
+    Ruckig<3, true> otg {0.005};
+    InputParameter<3> input;
+    OutputParameter<3> output;
+
+    input.current_position = {0.0, -2.0, 0.0};
+    input.current_velocity = {0.0, 0.0, 0.0};
+    input.current_acceleration = {0.0, 0.0, 0.0};
+    input.target_position = {1.0, -3.0, 2.0};
+    input.target_velocity = {0.0, 0.3, 0.0};
+    input.target_acceleration = {0.0, 0.0, 0.0};
+    input.max_velocity = {1.0, 1.0, 1.0};
+    input.max_acceleration = {1.0, 1.0, 1.0};
+    input.max_jerk = {1.0, 1.0, 1.0};
+
+    Trajectory<3> traj;
+    auto result = otg.calculate(input, traj);
+
+    CHECK( result == Result::Working );
+    CHECK( traj.get_duration() == doctest::Approx(4.0) );
+
+    result = otg.update(input, output);
+
+    CHECK( result == Result::Working );
+    CHECK( output.trajectory.get_duration() == doctest::Approx(4.0) );
+
+    std::array<double, 3> new_position, new_velocity, new_acceleration;
+    output.trajectory.at_time(0.0, new_position, new_velocity, new_acceleration);
+    check_array(new_position, input.current_position);
+    check_array(new_velocity, input.current_velocity);
+    check_array(new_acceleration, input.current_acceleration);
+
+    output.trajectory.at_time(output.trajectory.get_duration(), new_position, new_velocity, new_acceleration);
+    check_array(new_position, input.target_position);
+    check_array(new_velocity, input.target_velocity);
+    check_array(new_acceleration, input.target_acceleration);
+
+    size_t new_section;
+    output.trajectory.at_time(2.0, new_position, new_velocity, new_acceleration, new_section);
+    check_array(new_position, {0.5, -2.6871268303, 1.0});
+    CHECK( new_section == 0 );
+
+    output.trajectory.at_time(5.0, new_position, new_velocity, new_acceleration, new_section);
+    CHECK( new_section == 1 );
+
+    auto independent_min_durations = output.trajectory.get_independent_min_durations();
+    CHECK( independent_min_durations[0] == doctest::Approx(3.1748021039) );
+    CHECK( independent_min_durations[1] == doctest::Approx(3.6860977315) );
+    CHECK( independent_min_durations[2] == doctest::Approx(output.trajectory.get_duration()) );
+
+    auto position_extrema = output.trajectory.get_position_extrema();
+    CHECK( position_extrema[0].t_max == doctest::Approx(4.0) );
+    CHECK( position_extrema[0].max == doctest::Approx(1.0) );
+    CHECK( position_extrema[0].t_min == doctest::Approx(0.0) );
+    CHECK( position_extrema[0].min == doctest::Approx(0.0) );
+
+    CHECK( position_extrema[1].t_max == doctest::Approx(0.0) );
+    CHECK( position_extrema[1].max == doctest::Approx(-2.0) );
+    CHECK( position_extrema[1].t_min == doctest::Approx(3.2254033308) );
+    CHECK( position_extrema[1].min == doctest::Approx(-3.1549193338) );
+
+    CHECK( position_extrema[2].t_max == doctest::Approx(4.0) );
+    CHECK( position_extrema[2].max == doctest::Approx(2.0) );
+    CHECK( position_extrema[2].t_min == doctest::Approx(0.0) );
+    CHECK( position_extrema[2].min == doctest::Approx(0.0) );
+
+
+    double time;
+    CHECK( output.trajectory.get_first_time_at_position(0, 0.0, time) );
+    CHECK( time == doctest::Approx(0.0) );
+
+    CHECK( output.trajectory.get_first_time_at_position(0, 0.5, time) );
+    CHECK( time == doctest::Approx(2.0) );
+
+    CHECK( output.trajectory.get_first_time_at_position(0, 1.0, time) );
+    CHECK( time == doctest::Approx(4.0) );
+
+    CHECK( output.trajectory.get_first_time_at_position(1, -3.0, time) );
+    CHECK( time == doctest::Approx(2.6004877902) );
+
+    CHECK( output.trajectory.get_first_time_at_position(1, -3.1, time) );
+    CHECK( time == doctest::Approx(2.8644154489) );
+
+    CHECK( output.trajectory.get_first_time_at_position(2, 0.05, time) );
+    CHECK( time == doctest::Approx(0.6694329501) );
+
+    CHECK_FALSE( output.trajectory.get_first_time_at_position(0, -1.0, time) );
+    CHECK_FALSE( output.trajectory.get_first_time_at_position(1, -3.4, time) );
+    CHECK_FALSE( output.trajectory.get_first_time_at_position(6, 0.0, time) );
+
+
+    input.current_position = {0.0, -2.0, 0.0};
+    input.current_velocity = {0.0, 0.0, 0.0};
+    input.current_acceleration = {0.0, 0.0, 0.0};
+    input.target_position = {1.0, -3.0, 2.0};
+    input.target_velocity = {2.0, 0.3, 0.0};
+    input.target_acceleration = {0.0, 0.0, 0.0};
+    input.max_velocity = {1.0, 1.0, 1.0};
+    input.max_acceleration = {1.0, 1.0, 1.0};
+    input.max_jerk = {1.0, 1.0, 1.0};
+
+    result = otg.update(input, output);
+
+    CHECK( result == Result::ErrorInvalidInput );
+    CHECK_FALSE( output.new_calculation );
+
+    input.target_velocity = {0.2, -0.3, 0.8};
+    result = otg.update(input, output);
+
+    CHECK( result == Result::Working );
+    CHECK( output.new_calculation );
+
+
+    input.minimum_duration = 12.0;
+    result = otg.update(input, output);
+
+    CHECK( result == Result::Working );
+    CHECK( output.trajectory.get_duration() == doctest::Approx(12.0) );
+}
+
+// TEST_CASE("enabled" * doctest::description("Enabled DoF")) {
+//     Ruckig<3, true> otg {0.005};
+//     InputParameter<3> input;
+//     OutputParameter<3> output;
+
+//     input.enabled = {true, false, false};
+//     input.current_position = {0.0, -2.0, 0.0};
+//     input.current_velocity = {0.0, 0.1, 0.0};
+//     input.current_acceleration = {0.0, 0.0, -0.2};
+//     input.target_position = {1.0, -3.0, 2.0};
+//     input.max_velocity = {1.0, 1.0, 1.0};
+//     input.max_acceleration = {1.0, 1.0, 1.0};
+//     input.max_jerk = {1.0, 1.0, 1.0};
+
+//     Result result = otg.update(input, output);
+//     CHECK( result == Result::Working );
+//     CHECK( output.trajectory.get_duration() == doctest::Approx(3.1748021039) );
+
+//     std::array<double, 3> new_position, new_velocity, new_acceleration;
+//     output.trajectory.at_time(0.0, new_position, new_velocity, new_acceleration);
+//     check_array(new_position, input.current_position);
+//     check_array(new_velocity, input.current_velocity);
+//     check_array(new_acceleration, input.current_acceleration);
+
+//     output.trajectory.at_time(output.trajectory.get_duration(), new_position, new_velocity, new_acceleration);
+//     check_array(new_position, {input.target_position[0], -1.6825197896, -1.0079368399});
+// }
+
+TEST_CASE("change-detection" * doctest::description("Generation-based Change Detection")) {
+    Ruckig<3, true> otg {0.005};
+    InputParameter<3> input;
+    OutputParameter<3> output;
+
+    input.change_detection = ChangeDetection::Generation;
+    input.current_position = {0.0, -2.0, 0.0};
+    input.target_position = {1.0, -3.0, 2.0};
+    input.max_velocity = {1.0, 1.0, 1.0};
+    input.max_acceleration = {1.0, 1.0, 1.0};
+    input.max_jerk = {1.0, 1.0, 1.0};
+
+    auto result = otg.update(input, output);
+    CHECK( result == Result::Working );
+    CHECK( output.new_calculation );
+    CHECK( output.trajectory.get_duration() == doctest::Approx(4.0) );
+
+    output.pass_to_input(input);
+    result = otg.update(input, output);
+    CHECK( result == Result::Working );
+    CHECK_FALSE( output.new_calculation );
+
+    // Without marking the change, the old trajectory is kept
+    output.pass_to_input(input);
+    input.target_position = {0.0, -3.0, 2.0};
+    result = otg.update(input, output);
+    CHECK_FALSE( output.new_calculation );
+
+    output.pass_to_input(input);
+    input.mark_changed();
+    result = otg.update(input, output);
+    CHECK( result == Result::Working );
+    CHECK( output.new_calculation );
+
+    output.pass_to_input(input);
+    result = otg.update(input, output);
+    CHECK_FALSE( output.new_calculation );
+
+    // Switching back to the full comparison
+    output.pass_to_input(input);
+    input.change_detection = ChangeDetection::Full;
+    input.target_position = {1.0, -3.0, 2.0};
+    result = otg.update(input, output);
+    CHECK( output.new_calculation );
+}
+
+TEST_CASE("compliant-limits" * doctest::description("Keeping the Trajectory when only the Limits Change")) {
+    Ruckig<3, true> otg {0.005};
+    otg.keep_trajectory_within_limits = true;
+    InputParameter<3> input;
+    OutputParameter<3> output;
+
+    input.current_position = {0.0, -2.0, 0.0};
+    input.target_position = {1.0, -3.0, 2.0};
+    input.max_velocity = {1.0, 1.0, 1.0};
+    input.max_acceleration = {1.0, 1.0, 1.0};
+    input.max_jerk = {1.0, 1.0, 1.0};
+
+    CHECK( otg.update(input, output) == Result::Working );
+    CHECK( output.new_calculation );
+    const double duration = output.trajectory.get_duration();
+    const auto extrema = output.trajectory.get_kinematic_extrema();
+
+    // Numerical noise and limits above the peaks keep the trajectory
+    output.pass_to_input(input);
+    input.max_jerk = {1.0 + 1e-15, 1.0, 1.0 - 1e-15};
+    input.max_velocity[2] = std::max(extrema[2].max_velocity, -extrema[2].min_velocity) + 1e-6;
+    CHECK( otg.update(input, output) == Result::Working );
+    CHECK_FALSE( output.new_calculation );
+    CHECK( output.trajectory.get_duration() == duration );
+
+    output.pass_to_input(input);
+    CHECK( otg.update(input, output) == Result::Working );
+    CHECK_FALSE( output.new_calculation );
+
+    // Limits below a peak, or a changed target, lead to a new calculation
+    output.pass_to_input(input);
+    input.max_velocity[2] = std::max(extrema[2].max_velocity, -extrema[2].min_velocity) - 1e-3;
+    CHECK( otg.update(input, output) == Result::Working );
+    CHECK( output.new_calculation );
+
+    output.pass_to_input(input);
+    input.max_jerk = {1.0, 1.0, 1.0};
+    input.target_position[0] = 1.5;
+    CHECK( otg.update(input, output) == Result::Working );
+    CHECK( output.new_calculation );
+
+    // Without the option, any change of the limits is recalculated
+    Ruckig<3, true> otg_default {0.005};
+    InputParameter<3> input_default;
+    input_default.current_position = {0.0, -2.0, 0.0};
+    input_default.target_position = {1.0, -3.0, 2.0};
+    input_default.max_velocity = {1.0, 1.0, 1.0};
+    input_default.max_acceleration = {1.0, 1.0, 1.0};
+    input_default.max_jerk = {1.0, 1.0, 1.0};
+    CHECK( otg_default.update(input_default, output) == Result::Working );
+    output.pass_to_input(input_default);
+    input_default.max_jerk[0] = 1.0 + 1e-15;
+    CHECK( otg_default.update(input_default, output) == Result::Working );
+    CHECK( output.new_calculation );
+}
+
+TEST_CASE("idle" * doctest::description("Idle Updates after a Finished Trajectory at Rest")) {
+    Ruckig<3, true> otg {0.005};
+    InputParameter<3> input;
+    OutputParameter<3> output;
+
+    input.current_position = {0.0, -2.0, 0.0};
+    input.target_position = {1.0, -3.0, 2.0};
+    input.max_velocity = {1.0, 1.0, 1.0};
+    input.max_acceleration = {1.0, 1.0, 1.0};
+    input.max_jerk = {1.0, 1.0, 1.0};
+
+    while (otg.update(input, output) == Result::Working) {
+        CHECK_FALSE( otg.is_idle() );
+        output.pass_to_input(input);
+    }
+    output.pass_to_input(input);
+    CHECK( otg.is_idle() );
+
+    // The idle updates keep the state, which is exactly the one sampled from the trajectory
+    const auto idle_position = output.new_position;
+    for (size_t i = 0; i < 10; ++i) {
+        const double time = output.time;
+        CHECK( otg.update(input, output) == Result::Finished );
+        CHECK( otg.is_idle() );
+        CHECK_FALSE( output.new_calculation );
+        CHECK( output.time == doctest::Approx(time + 0.005) );
+        CHECK( output.new_position == idle_position );
+        output.pass_to_input(input);
+    }
+
+    std::array<double, 3> new_position, new_velocity, new_acceleration;
+    output.trajectory.at_time(output.time, new_position, new_velocity, new_acceleration);
+    CHECK( new_position == idle_position );
+    CHECK( new_velocity == std::array<double, 3> {0.0, 0.0, 0.0} );
+    CHECK( new_acceleration == std::array<double, 3> {0.0, 0.0, 0.0} );
+
+    // Sub-samples are still written by the full update
+    std::array<double, 6> subsample_positions;
+    CHECK( otg.update(input, output, 2, subsample_positions.data()) == Result::Finished );
+    CHECK( otg.is_idle() );
+    for (size_t dof = 0; dof < 3; ++dof) {
+        CHECK( subsample_positions[dof] == idle_position[dof] );
+        CHECK( subsample_positions[3 + dof] == idle_position[dof] );
+    }
+    output.pass_to_input(input);
+
+    // A changed input leaves the idle state
+    while (otg.update(input, output) == Result::Working) {
+        output.pass_to_input(input);
+    }
+    output.pass_to_input(input);
+    CHECK( otg.is_idle() );
+    input.target_position[1] = -2.5;
+    CHECK( otg.update(input, output) == Result::Working );
+    CHECK( output.new_calculation );
+    CHECK_FALSE( otg.is_idle() );
+
+    // A target velocity keeps moving after the trajectory finished
+    input.target_velocity = {0.0, 0.1, 0.0};
+    while (otg.update(input, output) == Result::Working) {
+        output.pass_to_input(input);
+    }
+    CHECK_FALSE( otg.is_idle() );
+}
+
+TEST_CASE("fast-retargeting" * doctest::description("Fast Retargeting for Small Target Changes")) {
+    constexpr size_t DOFs {3};
+    Ruckig<DOFs, true> otg;
+
+    Randomizer<DOFs, decltype(position_dist)> p { position_dist, seed };
+    Randomizer<DOFs, decltype(limit_dist)> l { limit_dist, seed + 1 };
+    std::uniform_real_distribution<double> change_dist {-1e-3, 1e-3};
+    std::default_random_engine gen {static_cast<unsigned>(seed)};
+
+    // Early in the motion, most small target changes are corrected without a full calculation
+    size_t number_retargeted {0}, number_trajectories {0};
+    for (size_t i = 0; i < 256; ++i) {
+        InputParameter<DOFs> input;
+        p.fill(input.current_position);
+        p.fill(input.target_position);
+        l.fill(input.max_velocity);
+        l.fill(input.max_acceleration);
+        l.fill(input.max_jerk);
+
+        Trajectory<DOFs> trajectory;
+        if (otg.calculate(input, trajectory) != Result::Working) {
+            continue;
+        }
+        number_trajectories += 1;
+
+        const double time = 0.05 * trajectory.get_duration();
+        InputParameter<DOFs> changed = input;
+        trajectory.at_time(time, changed.current_position, changed.current_velocity, changed.current_acceleration);
+        for (auto& target: changed.target_position) {
+            target += change_dist(gen);
+        }
+
+        Trajectory<DOFs> retargeted, calculated;
+        if (!retargeted.calculate_retarget(trajectory, time, changed)) {
+            continue;
+        }
+        number_retargeted += 1;
+
+        REQUIRE( otg.calculate(changed, calculated) == Result::Working );
+        CHECK( retargeted.get_duration() <= calculated.get_duration() + 1e-8 );
+        for (const double min_duration: retargeted.get_independent_min_durations()) {
+            CHECK( std::isfinite(min_duration) );
+            CHECK( min_duration <= retargeted.get_duration() );
+        }
+
+        std::array<double, DOFs> new_position, new_velocity, new_acceleration;
+        retargeted.at_time(retargeted.get_duration(), new_position, new_velocity, new_acceleration);
+        for (size_t dof = 0; dof < DOFs; ++dof) {
+            CHECK( new_position[dof] == doctest::Approx(changed.target_position[dof]).epsilon(1e-8) );
+            CHECK( std::abs(new_velocity[dof]) < 1e-8 );
+            CHECK( std::abs(new_acceleration[dof]) < 1e-10 );
+        }
+    }
+    CHECK( 2 * number_retargeted > number_trajectories );
+
+    InputParameter<DOFs> input;
+    input.current_position = {0.0, -2.0, 0.0};
+    input.target_position = {1.0, -3.0, 2.0};
+    input.max_velocity = {1.0, 1.0, 1.0};
+    input.max_acceleration = {1.0, 1.0, 1.0};
+    input.max_jerk = {1.0, 1.0, 1.0};
+
+    Trajectory<DOFs> trajectory, retargeted;
+    REQUIRE( otg.calculate(input, trajectory) == Result::Working );
+
+    // A large change needs another structure of the profile, and an unsupported input the full calculation
+    InputParameter<DOFs> changed = input;
+    trajectory.at_time(0.5, changed.current_position, changed.current_velocity, changed.current_acceleration);
+    changed.target_position[2] = 0.5;
+    CHECK_FALSE( retargeted.calculate_retarget(trajectory, 0.5, changed) );
+
+    changed.target_position[2] = 2.0005;
+    changed.target_velocity[2] = 0.1;
+    CHECK_FALSE( retargeted.calculate_retarget(trajectory, 0.5, changed) );
+
+    // Through update, the corrected trajectory starts a new calculation and reaches the changed target
+    Ruckig<DOFs> otg_retarget {0.005};
+    otg_retarget.fast_retargeting = true;
+    OutputParameter<DOFs> output;
+    CHECK( otg_retarget.update(input, output) == Result::Working );
+    output.pass_to_input(input);
+
+    input.target_position[2] += 5e-4;
+    CHECK( otg_retarget.update(input, output) == Result::Working );
+    CHECK( output.new_calculation );
+    CHECK( output.trajectory.get_duration() == doctest::Approx(trajectory.get_duration() - 0.005).epsilon(1e-3) );
+    output.pass_to_input(input);
+
+    while (otg_retarget.update(input, output) == Result::Working) {
+        CHECK_FALSE( output.new_calculation );
+        output.pass_to_input(input);
+    }
+    for (size_t dof = 0; dof < DOFs; ++dof) {
+        CHECK( output.new_position[dof] == doctest::Approx(input.target_position[dof]) );
+    }
+}
+
+TEST_CASE("registered-limits" * doctest::description("Validation of Registered Limits Once")) {
+    constexpr size_t DOFs {3};
+    Ruckig<DOFs, true> otg {0.005};
+
+    Randomizer<DOFs, decltype(position_dist)> p { position_dist, seed };
+    Randomizer<DOFs, decltype(dynamic_dist)> d { dynamic_dist, seed + 1 };
+    Randomizer<DOFs, decltype(limit_dist)> l { limit_dist, seed + 2 };
+
+    InputParameter<DOFs> input;
+    l.fill(input.max_velocity);
+    l.fill(input.max_acceleration);
+    l.fill(input.max_jerk);
+    CHECK( otg.register_limits(input) );
+
+    // The state is validated as before
+    for (size_t i = 0; i < 256; ++i) {
+        p.fill(input.current_position);
+        p.fill(input.target_position);
+        d.fill_or_zero(input.target_velocity, 0.5);
+        d.fill_or_zero(input.target_acceleration, 0.5);
+        CHECK( otg.validate_input(input) == Ruckig<DOFs, true>{0.005}.validate_input(input) );
+    }
+
+    input.target_velocity = {0.0, 0.0, 0.0};
+    input.target_acceleration = {0.0, 0.0, 0.0};
+    CHECK( otg.validate_input(input) );
+    input.current_position[1] = std::numeric_limits<double>::quiet_NaN();
+    CHECK_FALSE( otg.validate_input(input) );
+    input.current_position[1] = 0.0;
+    input.target_velocity[2] = 2 * input.max_velocity[2];
+    CHECK_FALSE( otg.validate_input(input) );
+    input.target_velocity[2] = 0.0;
+
+    // Changed limits are validated again, until they are registered
+    const auto max_jerk = input.max_jerk;
+    input.max_jerk[0] = -1.0;
+    CHECK_FALSE( otg.validate_input(input) );
+    input.control_interface = ControlInterface::Velocity;
+    input.max_jerk = max_jerk;
+    input.max_velocity[0] = 0.0;
+    CHECK( otg.validate_input(input) );
+    input.control_interface = ControlInterface::Position;
+    CHECK_FALSE( otg.validate_input(input) );
+
+    CHECK_FALSE( otg.register_limits(input) );
+    input.max_velocity[0] = 1.0;
+    CHECK( otg.validate_input(input) );
+    CHECK( otg.register_limits(input) );
+
+    Trajectory<DOFs> trajectory;
+    CHECK( otg.calculate(input, trajectory) == Result::Working );
+    otg.clear_registered_limits();
+    CHECK( otg.calculate(input, trajectory) == Result::Working );
+}
+
+struct AxisLimits {
+    static constexpr double max_velocity {2.0};
+    static constexpr double max_acceleration {3.5};
+    static constexpr double max_jerk {8.0};
+};
+
+TEST_CASE("constant-limits" * doctest::description("Kinematic Limits Known at Compile-Time")) {
+    constexpr size_t DOFs {3};
+    Ruckig<DOFs, true> otg {0.005};
+    Ruckig<DOFs, true, true, 0, Instrumentation::Duration, Features::All, AxisLimits> otg_constant {0.005};
+
+    Randomizer<DOFs, decltype(position_dist)> p { position_dist, seed };
+    Randomizer<DOFs, decltype(dynamic_dist)> d { dynamic_dist, seed + 1 };
+
+    InputParameter<DOFs> input;
+    input.set_limits<AxisLimits>();
+    CHECK( input.max_velocity == std::array<double, DOFs> {2.0, 2.0, 2.0} );
+    CHECK( input.max_jerk == std::array<double, DOFs> {8.0, 8.0, 8.0} );
+
+    // The trajectories are the same as with the limits of the input
+    Trajectory<DOFs> trajectory, trajectory_constant;
+    for (size_t i = 0; i < 256; ++i) {
+        p.fill(input.current_position);
+        d.fill_or_zero(input.current_velocity, 0.9);
+        d.fill_or_zero(input.current_acceleration, 0.8);
+        p.fill(input.target_position);
+        d.fill_or_zero(input.target_velocity, 0.5);
+
+        const bool is_valid = otg.validate_input(input);
+        CHECK( otg_constant.validate_input(input) == is_valid );
+        if (!is_valid) {
+            continue;
+        }
+
+        const Result result = otg.calculate(input, trajectory);
+        CHECK( otg_constant.calculate(input, trajectory_constant) == result );
+        if (result == Result::Working) {
+            CHECK( trajectory_constant.get_duration() == doctest::Approx(trajectory.get_duration()) );
+        }
+    }
+
+    // The state is validated as before, however asymmetric limits are not allowed
+    input.current_velocity = {0.0, 0.0, 0.0};
+    input.current_acceleration = {0.0, 0.0, 0.0};
+    input.target_velocity = {0.0, 0.0, 0.0};
+    CHECK( otg_constant.validate_input(input) );
+    input.target_velocity[1] = 3.0;
+    CHECK_FALSE( otg_constant.validate_input(input) );
+    input.target_velocity[1] = 0.0;
+    input.min_velocity = {-1.0, -1.0, -1.0};
+    CHECK_FALSE( otg_constant.validate_input(input) );
+    input.min_velocity = std::nullopt;
+
+    CHECK( otg_constant.calculate(input, trajectory_constant) == Result::Working );
+    std::array<double, DOFs> new_position, new_velocity, new_acceleration;
+    trajectory_constant.at_time(trajectory_constant.get_duration(), new_position, new_velocity, new_acceleration);
+    CHECK( new_position[0] == doctest::Approx(input.target_position[0]) );
+    CHECK( new_velocity[2] == doctest::Approx(0.0) );
+
+    // Fast retargeting and keeping the trajectory within changed limits use the constant limits as well
+    Ruckig<DOFs> otg_update {0.005};
+    Ruckig<DOFs, false, true, 0, Instrumentation::Duration, Features::All, AxisLimits> otg_constant_update {0.005};
+    for (auto* fast_retargeting: {&otg_update.fast_retargeting, &otg_constant_update.fast_retargeting}) {
+        *fast_retargeting = true;
+    }
+    otg_constant_update.keep_trajectory_within_limits = true;
+
+    input.current_position = {0.0, 0.0, 0.0};
+    input.target_position = {1.0, -0.5, 0.8};
+    InputParameter<DOFs> input_constant = input;
+    input_constant.max_velocity = {0.1, 0.1, 0.1}; // Ignored
+    input_constant.max_acceleration = {0.1, 0.1, 0.1};
+    input_constant.max_jerk = {0.1, 0.1, 0.1};
+
+    OutputParameter<DOFs> output, output_constant;
+    CHECK( otg_update.update(input, output) == Result::Working );
+    CHECK( otg_constant_update.update(input_constant, output_constant) == Result::Working );
+    CHECK( output_constant.trajectory.get_duration() == doctest::Approx(output.trajectory.get_duration()) );
+    output.pass_to_input(input);
+    output_constant.pass_to_input(input_constant);
+
+    input.target_position[2] += 5e-4;
+    input_constant.target_position[2] += 5e-4;
+    Trajectory<DOFs> retargeted;
+    CHECK_FALSE( retargeted.calculate_retarget(output_constant.trajectory, output_constant.time, input_constant) );
+    CHECK( retargeted.calculate_retarget<AxisLimits>(output_constant.trajectory, output_constant.time, input_constant) );
+    CHECK( otg_update.update(input, output) == Result::Working );
+    CHECK( otg_constant_update.update(input_constant, output_constant) == Result::Working );
+    CHECK( output_constant.trajectory.get_duration() == doctest::Approx(output.trajectory.get_duration()) );
+    check_array(output_constant.new_position, output.new_position);
+    output.pass_to_input(input);
+    output_constant.pass_to_input(input_constant);
+
+    input_constant.max_velocity = {0.2, 0.2, 0.2};
+    CHECK( otg_constant_update.update(input_constant, output_constant) == Result::Working );
+    CHECK_FALSE( output_constant.new_calculation );
+    output_constant.pass_to_input(input_constant);
+
+    while (otg_constant_update.update(input_constant, output_constant) == Result::Working) {
+        output_constant.pass_to_input(input_constant);
+    }
+    check_array(output_constant.new_position, input.target_position);
+}
+
+TEST_CASE("batch" * doctest::description("Batch Calculation")) {
+    constexpr size_t DOFs {3};
+    Ruckig<DOFs, true> otg;
+
+    Randomizer<DOFs, decltype(position_dist)> p { position_dist, seed };
+    Randomizer<DOFs, decltype(limit_dist)> l { limit_dist, seed + 1 };
+
+    std::vector<InputParameter<DOFs>> inputs(64);
+    for (auto& input: inputs) {
+        p.fill(input.current_position);
+        p.fill(input.target_position);
+        l.fill(input.max_velocity);
+        l.fill(input.max_acceleration);
+        l.fill(input.max_jerk);
+    }
+    inputs[5].max_jerk[1] = -1.0;
+
+    std::vector<Trajectory<DOFs>> trajectories;
+    std::vector<Result> results;
+    otg.calculate_batch(inputs, trajectories, results);
+    CHECK( trajectories.size() == inputs.size() );
+    CHECK( results.size() == inputs.size() );
+
+    std::vector<Trajectory<DOFs>> trajectories_parallel;
+    std::vector<Result> results_parallel;
+    otg.calculate_batch(inputs, trajectories_parallel, results_parallel, 4);
+
+    // The error of the batch is the one of its first failed input, also if the calculations ran on multiple threads
+    CHECK( otg.get_error().result == Result::ErrorInvalidInput );
+    CHECK( otg.get_error().phase == CalculationPhase::Validation );
+
+    for (size_t i = 0; i < inputs.size(); ++i) {
+        Trajectory<DOFs> trajectory;
+        const Result result = otg.calculate(inputs[i], trajectory);
+        CHECK( results[i] == result );
+        CHECK( results_parallel[i] == result );
+        CHECK( trajectories[i].get_duration() == trajectory.get_duration() );
+        CHECK( trajectories_parallel[i].get_duration() == trajectory.get_duration() );
+    }
+    CHECK( results[5] == Result::ErrorInvalidInput );
+
+    inputs[5].max_jerk[1] = 1.0;
+    otg.calculate_batch(inputs, trajectories_parallel, results_parallel, 4);
+    CHECK( std::all_of(results_parallel.begin(), results_parallel.end(), [](Result r) { return r == Result::Working; }) );
+    CHECK( otg.get_error().result == Result::Working );
+
+    for (size_t t = 0; t < 8; ++t) {
+        otg.calculate_batch(inputs, trajectories_parallel, results_parallel, 8);
+        CHECK( otg.get_error().result == Result::Working );
+    }
+}
+
+TEST_CASE("trajectory-cache" * doctest::description("Trajectory Cache")) {
+    Ruckig<3, true> otg {0.005};
+    TrajectoryCache<3> cache {2};
+    otg.trajectory_cache = &cache;
+
+    InputParameter<3> input_a;
+    input_a.current_position = {0.0, -2.0, 0.0};
+    input_a.target_position = {1.0, -3.0, 2.0};
+    input_a.max_velocity = {1.0, 1.0, 1.0};
+    input_a.max_acceleration = {1.0, 1.0, 1.0};
+    input_a.max_jerk = {1.0, 1.0, 1.0};
+
+    InputParameter<3> input_b {input_a};
+    input_b.target_position = {2.0, -3.0, 2.0};
+
+    InputParameter<3> input_c {input_a};
+    input_c.target_position = {3.0, -3.0, 2.0};
+
+    Trajectory<3> trajectory, trajectory_cached;
+    CHECK( otg.calculate(input_a, trajectory) == Result::Working );
+    CHECK( otg.calculate(input_a, trajectory_cached) == Result::Working );
+    CHECK( trajectory_cached.get_duration() == trajectory.get_duration() );
+    CHECK( cache.hits == 1 );
+    CHECK( cache.misses == 1 );
+
+    CHECK( otg.calculate(input_b, trajectory) == Result::Working );
+    CHECK( otg.calculate(input_a, trajectory) == Result::Working ); // Hit, b is now least recently used
+    CHECK( otg.calculate(input_c, trajectory) == Result::Working ); // Replaces b
+    CHECK( cache.size() == 2 );
+    CHECK( cache.hits == 2 );
+    CHECK( otg.calculate(input_b, trajectory) == Result::Working );
+    CHECK( cache.hits == 2 );
+    CHECK( cache.misses == 4 );
+
+    // Failed calculations are not cached
+    InputParameter<3> input_invalid {input_a};
+    input_invalid.max_jerk[0] = -1.0;
+    CHECK( otg.calculate(input_invalid, trajectory) == Result::ErrorInvalidInput );
+    CHECK( otg.calculate(input_invalid, trajectory) == Result::ErrorInvalidInput );
+    CHECK( cache.hits == 2 );
+
+    // Quantization
+    cache.clear();
+    cache.quantization = 1e-6;
+    InputParameter<3> input_a_noisy {input_a};
+    input_a_noisy.current_position[0] += 1e-9;
+    CHECK( otg.calculate(input_a, trajectory) == Result::Working );
+    CHECK( otg.calculate(input_a_noisy, trajectory) == Result::Working );
+    CHECK( cache.hits == 1 );
+    CHECK( cache.hit_rate() == doctest::Approx(0.5) );
+
+    TrajectoryCache<DynamicDOFs> dynamic_cache {4, 3};
+    CHECK( dynamic_cache.capacity() == 4 );
+    CHECK( dynamic_cache.size() == 0 );
+}
+
+TEST_CASE("trajectory-cache-snapshot" * doctest::description("Trajectory Cache Snapshot")) {
+    Ruckig<3, true> otg {0.005};
+    TrajectoryCache<3> cache {4};
+    otg.trajectory_cache = &cache;
+
+    InputParameter<3> input;
+    input.current_position = {0.0, -2.0, 0.0};
+    input.max_velocity = {1.0, 1.0, 1.0};
+    input.max_acceleration = {1.0, 1.0, 1.0};
+    input.max_jerk = {1.0, 1.0, 1.0};
+    input.min_velocity = std::array<double, 3> {-0.5, -1.0, -1.0};
+
+    std::vector<InputParameter<3>> inputs;
+    std::vector<double> durations;
+    Trajectory<3> trajectory;
+    for (size_t i = 0; i < 3; ++i) {
+        input.target_position = {1.0 + i, -3.0, 2.0};
+        CHECK( otg.calculate(input, trajectory) == Result::Working );
+        inputs.push_back(input);
+        durations.push_back(trajectory.get_duration());
+    }
+
+    std::vector<uint8_t> snapshot;
+    cache.save(snapshot);
+
+    // A smaller cache keeps the most recently used entries
+    TrajectoryCache<3> restored {2};
+    CHECK( restored.load(snapshot.data(), snapshot.size()) );
+    CHECK( restored.size() == 2 );
+    CHECK_FALSE( restored.find(inputs[0], trajectory) );
+    for (size_t i = 1; i < 3; ++i) {
+        CHECK( restored.find(inputs[i], trajectory) );
+        CHECK( trajectory.get_duration() == durations[i] );
+    }
+
+    TrajectoryCache<DynamicDOFs> dynamic_restored {4, 3};
+    CHECK( dynamic_restored.load(snapshot.data(), snapshot.size()) );
+    CHECK( dynamic_restored.size() == 3 );
+
+    // Invalid snapshots leave the cache empty
+    CHECK_FALSE( restored.load(snapshot.data(), snapshot.size() - 8) );
+    CHECK( restored.size() == 0 );
+
+    std::vector<uint8_t> corrupted {snapshot};
+    corrupted[TrajectoryCache<3>::snapshot_header_size + 8 + 16] ^= 0x01; // Current position of the first entry
+    CHECK_FALSE( restored.load(corrupted.data(), corrupted.size()) );
+
+    TrajectoryCache<3> quantized {2, 1e-6};
+    CHECK_FALSE( quantized.load(snapshot.data(), snapshot.size()) );
+
+    TrajectoryCache<DynamicDOFs> other_dofs {4, 2};
+    CHECK_FALSE( other_dofs.load(snapshot.data(), snapshot.size()) );
+}
+
+TEST_CASE("at-times" * doctest::description("Sampling at Multiple Times")) {
+    constexpr size_t DOFs {3};
+    Ruckig<DOFs, true> otg;
+
+    Randomizer<DOFs, decltype(position_dist)> p { position_dist, seed };
+    Randomizer<DOFs, decltype(dynamic_dist)> d { dynamic_dist, seed + 1 };
+    Randomizer<DOFs, decltype(limit_dist)> l { limit_dist, seed + 2 };
+
+    std::array<double, DOFs> new_position, new_velocity, new_acceleration;
+    std::vector<double> new_positions, new_velocities, new_accelerations;
+
+    for (size_t i = 0; i < 64; ++i) {
+        InputParameter<DOFs> input;
+        p.fill(input.current_position);
+        d.fill(input.current_velocity);
+        d.fill(input.current_acceleration);
+        p.fill(input.target_position);
+        l.fill(input.max_velocity, input.current_velocity);
+        l.fill(input.max_acceleration, input.current_acceleration);
+        l.fill(input.max_jerk);
+        if (i % 4 == 0) {
+            // With a brake trajectory
+            input.current_velocity[0] = 2 * input.max_velocity[0];
+        }
+
+        Trajectory<DOFs> trajectory;
+        if (otg.calculate(input, trajectory) != Result::Working) {
+            continue;
+        }
+
+        // Ascending times including the extrapolation after the duration, followed by a jump back
+        std::vector<double> times;
+        for (size_t j = 0; j <= 200; ++j) {
+            times.push_back(1.1 * trajectory.get_duration() * j / 200);
+        }
+        times.push_back(0.3 * trajectory.get_duration());
+        times.push_back(0.0);
+
+        trajectory.at_times(times, new_positions, new_velocities, new_accelerations);
+        CHECK( new_positions.size() == times.size() * DOFs );
+
+        for (size_t j = 0; j < times.size(); ++j) {
+            trajectory.at_time(times[j], new_position, new_velocity, new_acceleration);
+            for (size_t dof = 0; dof < DOFs; ++dof) {
+                CHECK( new_positions[j * DOFs + dof] == new_position[dof] );
+                CHECK( new_velocities[j * DOFs + dof] == new_velocity[dof] );
+                CHECK( new_accelerations[j * DOFs + dof] == new_acceleration[dof] );
+            }
+        }
+
+        TrajectoryCursor<DOFs> cursor;
+        std::array<double, DOFs> cursor_position, cursor_velocity, cursor_acceleration;
+        size_t new_section, cursor_section;
+        for (const double time: times) {
+            trajectory.at_time(time, new_position, new_velocity, new_acceleration, new_section);
+            trajectory.at_time(time, cursor_position, cursor_velocity, cursor_acceleration, cursor_section, cursor);
+            CHECK( cursor_section == new_section );
+            CHECK( cursor_position == new_position );
+            CHECK( cursor_velocity == new_velocity );
+            CHECK( cursor_acceleration == new_acceleration );
+        }
+    }
+}
+
+TEST_CASE("segment-coefficients" * doctest::description("Sampling with Precomputed Segment Coefficients")) {
+    constexpr size_t DOFs {3};
+    Ruckig<DOFs, true> otg;
+
+    Randomizer<DOFs, decltype(position_dist)> p { position_dist, seed };
+    Randomizer<DOFs, decltype(dynamic_dist)> d { dynamic_dist, seed + 1 };
+    Randomizer<DOFs, decltype(limit_dist)> l { limit_dist, seed + 2 };
+
+    std::array<double, DOFs> position, velocity, acceleration, new_position, new_velocity, new_acceleration;
+    std::vector<double> positions, velocities, accelerations;
+    for (size_t i = 0; i < 64; ++i) {
+        InputParameter<DOFs> input;
+        p.fill(input.current_position);
+        d.fill(input.current_velocity);
+        d.fill(input.current_acceleration);
+        p.fill(input.target_position);
+        l.fill(input.max_velocity, input.current_velocity);
+        l.fill(input.max_acceleration, input.current_acceleration);
+        l.fill(input.max_jerk);
+        if (i % 4 == 0) {
+            // With a brake trajectory
+            input.current_velocity[0] = 2 * input.max_velocity[0];
+        }
+        input.enabled = {true, true, i % 3 != 0};
+
+        Trajectory<DOFs> trajectory;
+        if (otg.calculate(input, trajectory) != Result::Working) {
+            continue;
+        }
+
+        std::vector<double> times;
+        for (size_t j = 0; j <= 100; ++j) {
+            times.push_back(1.1 * trajectory.get_duration() * j / 100);
+        }
+
+        // Samples from the profiles before the coefficients are calculated
+        std::vector<std::array<double, DOFs>> expected_positions, expected_velocities, expected_accelerations;
+        for (const double time: times) {
+            trajectory.at_time(time, position, velocity, acceleration);
+            expected_positions.push_back(position);
+            expected_velocities.push_back(velocity);
+            expected_accelerations.push_back(acceleration);
+        }
+
+        const auto& coefficients = trajectory.get_segment_coefficients();
+        CHECK( coefficients.size() == DOFs );
+
+        trajectory.at_times(times, positions, velocities, accelerations);
+        TrajectoryCursor<DOFs> cursor;
+        size_t new_section, cursor_section;
+        for (size_t j = 0; j < times.size(); ++j) {
+            trajectory.at_time(times[j], new_position, new_velocity, new_acceleration, new_section);
+            trajectory.at_time(times[j], position, velocity, acceleration, cursor_section, cursor);
+            CHECK( cursor_section == new_section );
+            for (size_t dof = 0; dof < DOFs; ++dof) {
+                CHECK( new_position[dof] == doctest::Approx(expected_positions[j][dof]) );
+                CHECK( new_velocity[dof] == doctest::Approx(expected_velocities[j][dof]) );
+                CHECK( new_acceleration[dof] == doctest::Approx(expected_accelerations[j][dof]) );
+
+                // All paths evaluate the same coefficients
+                CHECK( position[dof] == new_position[dof] );
+                CHECK( velocity[dof] == new_velocity[dof] );
+                CHECK( acceleration[dof] == new_acceleration[dof] );
+                CHECK( positions[j * DOFs + dof] == new_position[dof] );
+            }
+        }
+
+        // Outdated by a time scaling
+        trajectory.scale_time(0.5);
+        trajectory.at_time(0.5 * trajectory.get_duration(), new_position, new_velocity, new_acceleration);
+        trajectory.get_segment_coefficients();
+        trajectory.at_time(0.5 * trajectory.get_duration(), position, velocity, acceleration);
+        for (size_t dof = 0; dof < DOFs; ++dof) {
+            CHECK( position[dof] == doctest::Approx(new_position[dof]) );
+        }
+    }
+}
+
+TEST_CASE("time-scaling" * doctest::description("Time-scaling without Recalculation")) {
+    constexpr size_t DOFs {3};
+    Ruckig<DOFs, true> otg;
+
+    Randomizer<DOFs, decltype(position_dist)> p { position_dist, seed };
+    Randomizer<DOFs, decltype(dynamic_dist)> d { dynamic_dist, seed + 1 };
+    Randomizer<DOFs, decltype(limit_dist)> l { limit_dist, seed + 2 };
+
+    std::array<double, DOFs> position, velocity, acceleration, new_position, new_velocity, new_acceleration;
+    for (size_t i = 0; i < 64; ++i) {
+        InputParameter<DOFs> input;
+        input.control_interface = (i % 4 == 0) ? ControlInterface::Velocity : ControlInterface::Position;
+        p.fill(input.current_position);
+        d.fill(input.current_velocity);
+        d.fill(input.current_acceleration);
+        p.fill(input.target_position);
+        d.fill(input.target_velocity);
+        l.fill(input.max_velocity, input.target_velocity);
+        l.fill(input.max_acceleration, input.current_acceleration);
+        l.fill(input.max_jerk);
+
+        Trajectory<DOFs> trajectory;
+        if (otg.calculate(input, trajectory) != Result::Working) {
+            continue;
+        }
+
+        const double factor {0.4 + 0.01 * i};
+        const ExecutableTrajectory<DOFs> scaled = trajectory.time_scaled(factor);
+        CHECK( scaled.get_duration() == doctest::Approx(trajectory.get_duration() / factor) );
+
+        // Including the extrapolation after the duration
+        for (size_t j = 0; j <= 40; ++j) {
+            const double time = 1.2 * scaled.get_duration() * j / 40;
+            trajectory.at_time(factor * time, position, velocity, acceleration);
+            scaled.at_time(time, new_position, new_velocity, new_acceleration);
+            for (size_t dof = 0; dof < DOFs; ++dof) {
+                CHECK( new_position[dof] == doctest::Approx(position[dof]) );
+                CHECK( new_velocity[dof] == doctest::Approx(factor * velocity[dof]) );
+                CHECK( new_acceleration[dof] == doctest::Approx(factor * factor * acceleration[dof]) );
+            }
+        }
+
+        for (size_t dof = 0; dof < DOFs; ++dof) {
+            CHECK( scaled.get_position_extrema()[dof].max == doctest::Approx(trajectory.get_position_extrema()[dof].max) );
+            CHECK( scaled.get_kinematic_extrema()[dof].max_velocity == doctest::Approx(factor * trajectory.get_kinematic_extrema()[dof].max_velocity) );
+        }
+    }
+
+    Trajectory<DOFs> trajectory;
+    CHECK_FALSE( trajectory.scale_time(0.0) );
+    CHECK_FALSE( trajectory.scale_time(std::numeric_limits<double>::infinity()) );
+}
+
+TEST_CASE("sampler" * doctest::description("Fixed-rate Trajectory Sampler")) {
+    constexpr size_t DOFs {3};
+    Ruckig<DOFs, true> otg;
+
+    Randomizer<DOFs, decltype(position_dist)> p { position_dist, seed };
+    Randomizer<DOFs, decltype(dynamic_dist)> d { dynamic_dist, seed + 1 };
+    Randomizer<DOFs, decltype(limit_dist)> l { limit_dist, seed + 2 };
+
+    std::array<double, DOFs> new_position, new_velocity, new_acceleration;
+    for (size_t i = 0; i < 64; ++i) {
+        // Velocities above the limits lead to brake trajectories
+        InputParameter<DOFs> input;
+        p.fill(input.current_position);
+        d.fill(input.current_velocity);
+        d.fill(input.current_acceleration);
+        p.fill(input.target_position);
+        l.fill(input.max_velocity);
+        l.fill(input.max_acceleration);
+        l.fill(input.max_jerk);
+
+        Trajectory<DOFs> trajectory;
+        if (!otg.validate_input(input) || otg.calculate(input, trajectory) != Result::Working) {
+            continue;
+        }
+
+        const double delta_time = trajectory.get_duration() / 97.3;
+        auto sampler = trajectory.sample(delta_time);
+
+        size_t number_samples {0};
+        double last_time {-1.0};
+        for (const auto& sample: sampler) {
+            CHECK( sample.time > last_time );
+            last_time = sample.time;
+            ++number_samples;
+
+            trajectory.at_time(sample.time, new_position, new_velocity, new_acceleration);
+            for (size_t dof = 0; dof < DOFs; ++dof) {
+                CHECK( sample.position[dof] == doctest::Approx(new_position[dof]) );
+                CHECK( sample.velocity[dof] == doctest::Approx(new_velocity[dof]) );
+                CHECK( sample.acceleration[dof] == doctest::Approx(new_acceleration[dof]) );
+            }
+        }
+        CHECK( number_samples == 99 );
+        CHECK( number_samples == sampler.size() );
+        CHECK( last_time == trajectory.get_duration() );
+        CHECK( sampler.position == new_position );
+        CHECK_FALSE( sampler.next() );
+
+        sampler.reset();
+        CHECK( sampler.time == 0.0 );
+        CHECK( sampler.position[0] == doctest::Approx(input.current_position[0]) );
+    }
+
+    Trajectory<DynamicDOFs> dynamic_trajectory {2};
+    auto dynamic_sampler = dynamic_trajectory.sample(0.01);
+    CHECK( dynamic_sampler.size() == 1 );
+    CHECK_FALSE( dynamic_sampler.next() );
+    CHECK_THROWS( dynamic_trajectory.sample(0.0) );
+}
+
+TEST_CASE("parallel-sampling" * doctest::description("Fixed-rate Sampling on a Worker Pool")) {
+    constexpr size_t DOFs {3};
+    Ruckig<DOFs, true> otg;
+    WorkerPool pool {3};
+
+    Randomizer<DOFs, decltype(position_dist)> p { position_dist, seed };
+    Randomizer<DOFs, decltype(dynamic_dist)> d { dynamic_dist, seed + 1 };
+    Randomizer<DOFs, decltype(limit_dist)> l { limit_dist, seed + 2 };
+
+    std::vector<double> positions, velocities, accelerations, parallel_positions, parallel_velocities, parallel_accelerations;
+    for (size_t i = 0; i < 64; ++i) {
+        InputParameter<DOFs> input;
+        p.fill(input.current_position);
+        d.fill(input.current_velocity);
+        d.fill(input.current_acceleration);
+        p.fill(input.target_position);
+        l.fill(input.max_velocity);
+        l.fill(input.max_acceleration);
+        l.fill(input.max_jerk);
+
+        Trajectory<DOFs> trajectory;
+        if (!otg.validate_input(input) || otg.calculate(input, trajectory) != Result::Working) {
+            continue;
+        }
+
+        const double delta_time = trajectory.get_duration() / 1001.7;
+        const size_t number_samples = trajectory.number_samples(delta_time);
+        for (auto* buffer: {&positions, &velocities, &accelerations, &parallel_positions, &parallel_velocities, &parallel_accelerations}) {
+            buffer->assign(number_samples * DOFs, 0.0);
+        }
+        CHECK( trajectory.sample_into(delta_time, positions.data(), velocities.data(), accelerations.data()) == number_samples );
+        CHECK( trajectory.sample_into(delta_time, parallel_positions.data(), parallel_velocities.data(), parallel_accelerations.data(), &pool) == number_samples );
+
+        size_t k {0};
+        for (const auto& sample: trajectory.sample(delta_time)) {
+            for (size_t dof = 0; dof < DOFs; ++dof) {
+                const size_t offset = k * DOFs + dof;
+                CHECK( positions[offset] == doctest::Approx(sample.position[dof]) );
+                CHECK( velocities[offset] == doctest::Approx(sample.velocity[dof]) );
+                CHECK( accelerations[offset] == doctest::Approx(sample.acceleration[dof]) );
+                CHECK( parallel_positions[offset] == positions[offset] );
+                CHECK( parallel_velocities[offset] == velocities[offset] );
+                CHECK( parallel_accelerations[offset] == accelerations[offset] );
+            }
+            ++k;
+        }
+        CHECK( k == number_samples );
+    }
+
+    Trajectory<DOFs> trajectory;
+    CHECK( trajectory.sample_into(0.0, positions.data(), velocities.data(), accelerations.data()) == 0 );
+}
+
+TEST_CASE("fixed-point" * doctest::description("Fixed-point Trajectory Sampling")) {
+    constexpr size_t DOFs {3};
+    Ruckig<DOFs, true> otg;
+
+    Randomizer<DOFs, decltype(position_dist)> p { position_dist, seed };
+    Randomizer<DOFs, decltype(dynamic_dist)> d { dynamic_dist, seed + 1 };
+    Randomizer<DOFs, decltype(limit_dist)> l { limit_dist, seed + 2 };
+
+    // E.g. 20-bit encoders per radian, and a linear axis in micrometers
+    const std::array<double, DOFs> scales {std::pow(2.0, 20) / (2 * M_PI), std::pow(2.0, 20) / (2 * M_PI), 1e6};
+    constexpr double tolerance {FixedPointTrajectory<DOFs>::max_rounding_error + 1e-6};
+    FixedPointTrajectory<DOFs> fixed_point {scales};
+
+    for (size_t i = 0; i < 32; ++i) {
+        InputParameter<DOFs> input;
+        p.fill(input.current_position);
+        d.fill(input.current_velocity);
+        d.fill(input.current_acceleration);
+        p.fill(input.target_position);
+        l.fill(input.max_velocity);
+        l.fill(input.max_acceleration);
+        l.fill(input.max_jerk);
+
+        Trajectory<DOFs> trajectory;
+        if (!otg.validate_input(input) || otg.calculate(input, trajectory) != Result::Working) {
+            continue;
+        }
+
+        fixed_point.assign(trajectory, 0.001);
+        auto sampler = trajectory.sample(0.001);
+        CHECK( fixed_point.size() == sampler.size() );
+
+        bool has_next {true};
+        for (const auto& sample: sampler) {
+            CHECK( has_next );
+            for (size_t dof = 0; dof < DOFs; ++dof) {
+                CHECK( std::abs(fixed_point.position[dof] - scales[dof] * sample.position[dof]) <= tolerance );
+                CHECK( std::abs(fixed_point.velocity[dof] - scales[dof] * sample.velocity[dof]) <= tolerance );
+            }
+            has_next = fixed_point.next();
+        }
+        CHECK_FALSE( has_next );
+        CHECK( fixed_point.cycle + 1 == fixed_point.size() );
+        CHECK( fixed_point.position[2] == std::llround(1e6 * input.target_position[2]) );
+
+        fixed_point.reset();
+        CHECK( fixed_point.cycle == 0 );
+        CHECK( std::abs(fixed_point.position[0] - scales[0] * input.current_position[0]) <= tolerance );
+    }
+
+    // Out of range of the fixed-point representation
+    FixedPointTrajectory<DynamicDOFs> dynamic_fixed_point {std::vector<double> {1e12}};
+    Ruckig<DynamicDOFs, true> dynamic_otg {1};
+    InputParameter<DynamicDOFs> dynamic_input {1};
+    dynamic_input.target_position = {1.0};
+    dynamic_input.max_velocity = {1.0};
+    dynamic_input.max_acceleration = {1.0};
+    dynamic_input.max_jerk = {1.0};
+    Trajectory<DynamicDOFs> dynamic_trajectory {1};
+    CHECK( dynamic_otg.calculate(dynamic_input, dynamic_trajectory) == Result::Working );
+    CHECK_THROWS( dynamic_fixed_point.assign(dynamic_trajectory, 0.001) );
+}
+
+TEST_CASE("segment-table" * doctest::description("Structure-of-arrays Segment Table")) {
+    constexpr size_t DOFs {3};
+    Ruckig<DOFs, true> otg;
+
+    Randomizer<DOFs, decltype(position_dist)> p { position_dist, seed };
+    Randomizer<DOFs, decltype(dynamic_dist)> d { dynamic_dist, seed + 1 };
+    Randomizer<DOFs, decltype(limit_dist)> l { limit_dist, seed + 2 };
+
+    TrajectorySegmentTable<DOFs> table;
+    TrajectorySegmentTable<DynamicDOFs> dynamic_table {DOFs};
+    std::array<double, DOFs> position, velocity, acceleration, new_position, new_velocity, new_acceleration;
+    std::vector<double> dynamic_position(DOFs), dynamic_velocity(DOFs), dynamic_acceleration(DOFs);
+    for (size_t i = 0; i < 64; ++i) {
+        // Velocities above the limits lead to brake trajectories, and some DoFs are not synchronized
+        InputParameter<DOFs> input;
+        input.synchronization = (i % 3 == 0) ? Synchronization::None : Synchronization::Time;
+        p.fill(input.current_position);
+        d.fill(input.current_velocity);
+        d.fill(input.current_acceleration);
+        p.fill(input.target_position);
+        d.fill(input.target_velocity);
+        l.fill(input.max_velocity, input.target_velocity);
+        l.fill(input.max_acceleration, input.target_acceleration);
+        l.fill(input.max_jerk);
+
+        Trajectory<DOFs> trajectory;
+        if (!otg.validate_input(input) || otg.calculate(input, trajectory) != Result::Working) {
+            continue;
+        }
+
+        table.assign(trajectory);
+        CHECK( table.get_duration() == trajectory.get_duration() );
+
+        // Including times before the start and the extrapolation after the duration
+        for (size_t j = 0; j <= 50; ++j) {
+            const double time = 1.2 * trajectory.get_duration() * j / 48 - 0.1 * trajectory.get_duration();
+            trajectory.at_time(time, position, velocity, acceleration);
+            table.at_time(time, new_position, new_velocity, new_acceleration);
+            for (size_t dof = 0; dof < DOFs; ++dof) {
+                CHECK( new_position[dof] == doctest::Approx(position[dof]) );
+                CHECK( new_velocity[dof] == doctest::Approx(velocity[dof]) );
+                CHECK( new_acceleration[dof] == doctest::Approx(acceleration[dof]) );
+            }
+        }
+    }
+
+    Ruckig<DynamicDOFs, true> dynamic_otg {DOFs};
+    InputParameter<DynamicDOFs> input {DOFs};
+    input.current_position = {0.0, 1.0, -2.0};
+    input.current_velocity = {3.0, 0.0, 0.0};
+    input.target_position = {1.0, -1.0, 2.0};
+    input.max_velocity = {1.0, 1.0, 1.0};
+    input.max_acceleration = {2.0, 2.0, 2.0};
+    input.max_jerk = {4.0, 4.0, 4.0};
+
+    Trajectory<DynamicDOFs> trajectory {DOFs};
+    CHECK( dynamic_otg.calculate(input, trajectory) == Result::Working );
+    dynamic_table.assign(trajectory);
+    std::vector<double> dynamic_new_position(DOFs), dynamic_new_velocity(DOFs), dynamic_new_acceleration(DOFs);
+    for (const double time: {0.0, 0.3, trajectory.get_duration() / 2, trajectory.get_duration()}) {
+        trajectory.at_time(time, dynamic_position, dynamic_velocity, dynamic_acceleration);
+        dynamic_table.at_time(time, dynamic_new_position, dynamic_new_velocity, dynamic_new_acceleration);
+        for (size_t dof = 0; dof < DOFs; ++dof) {
+            CHECK( dynamic_new_position[dof] == doctest::Approx(dynamic_position[dof]) );
+            CHECK( dynamic_new_velocity[dof] == doctest::Approx(dynamic_velocity[dof]) );
+            CHECK( dynamic_new_acceleration[dof] == doctest::Approx(dynamic_acceleration[dof]) );
+        }
+    }
+
+    TrajectorySegmentTable<DynamicDOFs> wrong_table {2};
+    CHECK_THROWS( wrong_table.assign(trajectory) );
+}
+
+TEST_CASE("position-crossings" * doctest::description("Batched Position Crossing Times")) {
+    constexpr size_t DOFs {3};
+    Ruckig<DOFs, true> otg;
+
+    Randomizer<DOFs, decltype(position_dist)> p { position_dist, seed };
+    Randomizer<DOFs, decltype(dynamic_dist)> d { dynamic_dist, seed + 1 };
+    Randomizer<DOFs, decltype(limit_dist)> l { limit_dist, seed + 2 };
+
+    std::array<double, DOFs> new_position, new_velocity, new_acceleration, last_position;
+    std::vector<PositionCrossing> crossings;
+    for (size_t i = 0; i < 32; ++i) {
+        InputParameter<DOFs> input;
+        p.fill(input.current_position);
+        d.fill(input.current_velocity);
+        d.fill(input.current_acceleration);
+        p.fill(input.target_position);
+        l.fill(input.max_velocity);
+        l.fill(input.max_acceleration);
+        l.fill(input.max_jerk);
+
+        Trajectory<DOFs> trajectory;
+        if (!otg.validate_input(input) || otg.calculate(input, trajectory) != Result::Working) {
+            continue;
+        }
+
+        // Thresholds in between the extrema of each DoF, which are crossed at least once
+        std::array<std::vector<double>, DOFs> thresholds;
+        for (size_t dof = 0; dof < DOFs; ++dof) {
+            const auto& extrema = trajectory.get_position_extrema()[dof];
+            for (size_t k = 1; k < 20; ++k) {
+                thresholds[dof].push_back(extrema.min + (extrema.max - extrema.min) * ((k * 7) % 20) / 20);
+            }
+        }
+        trajectory.get_position_crossings(thresholds, crossings);
+        CHECK( std::is_sorted(crossings.begin(), crossings.end(), [](const PositionCrossing& a, const PositionCrossing& b) { return a.time < b.time; }) );
+
+        for (const auto& crossing: crossings) {
+            trajectory.at_time(crossing.time, new_position, new_velocity, new_acceleration);
+            CHECK( new_position[crossing.dof] == doctest::Approx(thresholds[crossing.dof][crossing.index]) );
+            CHECK( crossing.velocity == doctest::Approx(new_velocity[crossing.dof]) );
+        }
+
+        // Compare the number of crossings with dense sampling
+        std::array<std::vector<size_t>, DOFs> sampled_counts, counts;
+        for (size_t dof = 0; dof < DOFs; ++dof) {
+            sampled_counts[dof].resize(thresholds[dof].size(), 0);
+            counts[dof].resize(thresholds[dof].size(), 0);
+        }
+        for (const auto& crossing: crossings) {
+            counts[crossing.dof][crossing.index] += 1;
+        }
+
+        trajectory.at_time(0.0, last_position, new_velocity, new_acceleration);
+        for (size_t j = 1; j <= 20000; ++j) {
+            trajectory.at_time(trajectory.get_duration() * j / 20000, new_position, new_velocity, new_acceleration);
+            for (size_t dof = 0; dof < DOFs; ++dof) {
+                for (size_t k = 0; k < thresholds[dof].size(); ++k) {
+                    sampled_counts[dof][k] += (last_position[dof] - thresholds[dof][k]) * (new_position[dof] - thresholds[dof][k]) < 0;
+                }
+            }
+            last_position = new_position;
+        }
+        CHECK( counts == sampled_counts );
+    }
+
+    // Standing still at a threshold is reported once
+    InputParameter<DOFs> input;
+    input.current_position = {1.0, 0.0, 0.0};
+    input.target_position = {1.0, 1.0, 0.0};
+    input.max_velocity = {1.0, 1.0, 1.0};
+    input.max_acceleration = {1.0, 1.0, 1.0};
+    input.max_jerk = {1.0, 1.0, 1.0};
+
+    Trajectory<DOFs> trajectory;
+    CHECK( otg.calculate(input, trajectory) == Result::Working );
+    crossings.clear();
+    trajectory.get_position_crossings(0, {1.0, 2.0}, crossings);
+    REQUIRE( crossings.size() == 1 );
+    CHECK( crossings[0].time == 0.0 );
+    CHECK( crossings[0].index == 0 );
+
+    crossings.clear();
+    trajectory.get_position_crossings(1, {0.25, 0.5, 0.75, 1.0}, crossings);
+    CHECK( crossings.size() == 4 );
+    CHECK( crossings.back().time == doctest::Approx(trajectory.get_duration()) );
+
+    double first_time;
+    CHECK( trajectory.get_first_time_at_position(1, 0.25, first_time) );
+    CHECK( crossings.front().time == doctest::Approx(first_time) );
+}
+
+TEST_CASE("events" * doctest::description("Event Times of Segment Boundaries and Arrivals")) {
+    constexpr size_t DOFs {3};
+    Ruckig<DOFs, true> otg;
+
+    Randomizer<DOFs, decltype(position_dist)> p { position_dist, seed };
+    Randomizer<DOFs, decltype(dynamic_dist)> d { dynamic_dist, seed + 1 };
+    Randomizer<DOFs, decltype(limit_dist)> l { limit_dist, seed + 2 };
+
+    std::vector<TrajectoryEvent> events;
+    std::vector<Trajectory<DOFs>::PositionBox> boxes;
+    for (size_t i = 0; i < 64; ++i) {
+        InputParameter<DOFs> input;
+        p.fill(input.current_position);
+        d.fill(input.current_velocity);
+        d.fill(input.current_acceleration);
+        p.fill(input.target_position);
+        l.fill(input.max_velocity);
+        l.fill(input.max_acceleration);
+        l.fill(input.max_jerk);
+
+        Trajectory<DOFs> trajectory;
+        if (!otg.validate_input(input) || otg.calculate(input, trajectory) != Result::Working) {
+            continue;
+        }
+
+        trajectory.get_events(events);
+        CHECK( std::is_sorted(events.begin(), events.end(), [](const TrajectoryEvent& a, const TrajectoryEvent& b) { return a.time < b.time; }) );
+        CHECK( events.back().type == TrajectoryEventType::Finished );
+        CHECK( events.back().time == trajectory.get_duration() );
+
+        std::array<size_t, DOFs> arrivals {0, 0, 0};
+        std::vector<double> times;
+        for (const auto& event: events) {
+            CHECK( event.time >= 0.0 );
+            CHECK( event.time <= trajectory.get_duration() );
+            if (event.type == TrajectoryEventType::Arrival) {
+                arrivals[event.dof] += 1;
+            }
+            if (event.time > 0.0 && (times.empty() || event.time > times.back())) {
+                times.push_back(event.time);
+            }
+        }
+        CHECK( arrivals == std::array<size_t, DOFs> {1, 1, 1} );
+
+        // The events are the boundaries of the position boxes, which lie in between all segment boundaries
+        trajectory.get_position_boxes(boxes);
+        REQUIRE( boxes.size() == times.size() );
+        for (size_t k = 0; k < boxes.size(); ++k) {
+            CHECK( boxes[k].t_end == times[k] );
+        }
+
+        // Walking with the next event time visits the same times
+        double time {0.0};
+        for (const double event_time: times) {
+            time = trajectory.get_next_event_time(time);
+            CHECK( time == event_time );
+        }
+        CHECK( std::isinf(trajectory.get_next_event_time(time)) );
+    }
+}
+
+TEST_CASE("kinematic-extrema" * doctest::description("Velocity and Acceleration Extrema and Position Bounds")) {
+    constexpr size_t DOFs {3};
+    Ruckig<DOFs, true> otg;
+    otg.precalculate_kinematic_extrema = true;
+
+    Randomizer<DOFs, decltype(position_dist)> p { position_dist, seed };
+    Randomizer<DOFs, decltype(dynamic_dist)> d { dynamic_dist, seed + 1 };
+    Randomizer<DOFs, decltype(limit_dist)> l { limit_dist, seed + 2 };
+
+    std::array<double, DOFs> new_position, new_velocity, new_acceleration, min_position, max_position;
+    std::vector<Trajectory<DOFs>::PositionBox> boxes;
+    for (size_t i = 0; i < 32; ++i) {
+        InputParameter<DOFs> input;
+        p.fill(input.current_position);
+        d.fill(input.current_velocity);
+        d.fill(input.current_acceleration);
+        p.fill(input.target_position);
+        l.fill(input.max_velocity);
+        l.fill(input.max_acceleration);
+        l.fill(input.max_jerk);
+
+        Trajectory<DOFs> trajectory;
+        if (!otg.validate_input(input) || otg.calculate(input, trajectory) != Result::Working) {
+            continue;
+        }
+
+        const auto& extrema = trajectory.get_kinematic_extrema();
+        trajectory.get_position_boxes(boxes);
+        REQUIRE( boxes.size() >= 1 );
+        CHECK( boxes.front().t_start == 0.0 );
+        CHECK( boxes.back().t_end == trajectory.get_duration() );
+
+        const double t_window_start = 0.3 * trajectory.get_duration(), t_window_end = 0.6 * trajectory.get_duration();
+        trajectory.get_position_bounds(t_window_start, t_window_end, min_position, max_position);
+
+        std::array<double, DOFs> sampled_min_position, sampled_max_position;
+        sampled_min_position.fill(std::numeric_limits<double>::infinity());
+        sampled_max_position.fill(-std::numeric_limits<double>::infinity());
+
+        size_t box {0};
+        for (size_t j = 0; j <= 2000; ++j) {
+            const double time = trajectory.get_duration() * j / 2000;
+            trajectory.at_time(time, new_position, new_velocity, new_acceleration);
+            while (box + 1 < boxes.size() && boxes[box].t_end < time) {
+                ++box;
+            }
+
+            for (size_t dof = 0; dof < DOFs; ++dof) {
+                CHECK( new_velocity[dof] >= extrema[dof].min_velocity - 1e-9 );
+                CHECK( new_velocity[dof] <= extrema[dof].max_velocity + 1e-9 );
+                CHECK( new_acceleration[dof] >= extrema[dof].min_acceleration - 1e-9 );
+                CHECK( new_acceleration[dof] <= extrema[dof].max_acceleration + 1e-9 );
+                CHECK( new_position[dof] >= boxes[box].min_position[dof] - 1e-9 );
+                CHECK( new_position[dof] <= boxes[box].max_position[dof] + 1e-9 );
+            }
+
+            trajectory.at_time(t_window_start + (t_window_end - t_window_start) * j / 2000, new_position, new_velocity, new_acceleration);
+            for (size_t dof = 0; dof < DOFs; ++dof) {
+                sampled_min_position[dof] = std::min(sampled_min_position[dof], new_position[dof]);
+                sampled_max_position[dof] = std::max(sampled_max_position[dof], new_position[dof]);
+            }
+        }
+
+        for (size_t dof = 0; dof < DOFs; ++dof) {
+            trajectory.at_time(extrema[dof].t_max_velocity, new_position, new_velocity, new_acceleration);
+            CHECK( new_velocity[dof] == doctest::Approx(extrema[dof].max_velocity) );
+            trajectory.at_time(extrema[dof].t_min_acceleration, new_position, new_velocity, new_acceleration);
+            CHECK( new_acceleration[dof] == doctest::Approx(extrema[dof].min_acceleration) );
+
+            CHECK( min_position[dof] <= sampled_min_position[dof] + 1e-9 );
+            CHECK( max_position[dof] >= sampled_max_position[dof] - 1e-9 );
+            CHECK( min_position[dof] == doctest::Approx(sampled_min_position[dof]).epsilon(1e-5) );
+            CHECK( max_position[dof] == doctest::Approx(sampled_max_position[dof]).epsilon(1e-5) );
+        }
+    }
+}
+
+TEST_CASE("waypoints" * doctest::description("Intermediate Positions")) {
+    constexpr size_t DOFs {3};
+    Ruckig<DOFs, true> otg {0.01};
+
+    InputParameter<DOFs> input;
+    input.current_position = {0.2, 0.0, -0.3};
+    input.current_velocity = {0.0, 0.2, 0.0};
+    input.current_acceleration = {0.0, 0.6, 0.0};
+    input.intermediate_positions = {
+        {1.4, -1.6, 1.0},
+        {-0.6, -0.5, 0.4},
+        {-0.4, -0.35, 0.0},
+        {0.8, 1.8, -0.1}
+    };
+    input.target_position = {0.5, 1.0, 0.0};
+    input.target_velocity = {0.2, 0.0, 0.3};
+    input.target_acceleration = {0.0, 0.1, -0.1};
+    input.max_velocity = {1.0, 2.0, 1.0};
+    input.max_acceleration = {3.0, 2.0, 2.0};
+    input.max_jerk = {6.0, 10.0, 20.0};
+
+    CHECK( otg.validate_input(input) );
+    Trajectory<DOFs> single;
+    CHECK_THROWS( otg.calculate(input, single) );
+
+    // Offline, the trajectory passes each waypoint at its intermediate duration
+    WaypointTrajectory<DOFs> trajectory;
+    REQUIRE( otg.calculate(input, trajectory) == Result::Working );
+    REQUIRE( trajectory.is_calculated() );
+    CHECK( trajectory.size() == 5 );
+
+    const std::vector<double> durations = trajectory.get_intermediate_durations();
+    REQUIRE( durations.size() == 5 );
+    CHECK( durations.back() == doctest::Approx(trajectory.get_duration()) );
+
+    std::array<double, DOFs> new_position, new_velocity, new_acceleration;
+    size_t new_section;
+    for (size_t i = 0; i < input.intermediate_positions.size(); ++i) {
+        trajectory.at_time(durations[i], new_position, new_velocity, new_acceleration);
+        for (size_t dof = 0; dof < DOFs; ++dof) {
+            CHECK( new_position[dof] == doctest::Approx(input.intermediate_positions[i][dof]) );
+        }
+    }
+    trajectory.at_time(trajectory.get_duration() + 0.1, new_position, new_velocity, new_acceleration, new_section);
+    CHECK( new_section == 5 );
+    trajectory.at_time(trajectory.get_duration(), new_position, new_velocity, new_acceleration);
+    check_array(new_position, input.target_position);
+    check_array(new_velocity, input.target_velocity);
+
+    // A waypoint ahead in the same direction is passed with velocity
+    trajectory.at_time(durations[1], new_position, new_velocity, new_acceleration);
+    CHECK( new_velocity[1] > 0.0 );
+    CHECK( new_velocity[0] == doctest::Approx(0.0) );
+
+    // Online, the sections are calculated one per cycle and the passed waypoints are removed
+    OutputParameter<DOFs> output;
+    REQUIRE( otg.update(input, output) == Result::Working );
+    CHECK( output.new_calculation );
+    CHECK( otg.get_waypoint_trajectory().calculated_sections() == 1 );
+    output.pass_to_input(input);
+
+    REQUIRE( otg.update(input, output) == Result::Working );
+    CHECK_FALSE( output.new_calculation );
+    CHECK( otg.get_waypoint_trajectory().calculated_sections() == 2 );
+    output.pass_to_input(input);
+
+    size_t section_changes {0};
+    double time {2 * otg.delta_time};
+    Result result;
+    while ((result = otg.update(input, output)) == Result::Working) {
+        CHECK_FALSE( output.new_calculation );
+        if (output.did_section_change) {
+            ++section_changes;
+            CHECK( input.intermediate_positions.size() == 5 - section_changes );
+        }
+        output.pass_to_input(input);
+        CHECK( input.intermediate_positions.size() + output.new_section == 4 );
+
+        time += otg.delta_time;
+        trajectory.at_time(time, new_position, new_velocity, new_acceleration);
+        check_array(output.new_position, new_position);
+    }
+    CHECK( result == Result::Finished );
+    CHECK( section_changes == 4 );
+    CHECK( input.intermediate_positions.empty() );
+    CHECK( otg.get_waypoint_trajectory().is_calculated() );
+    CHECK( time == doctest::Approx(trajectory.get_duration()).epsilon(otg.delta_time) );
+}
+
+TEST_CASE("waypoint-list" * doctest::description("Waypoint Removal and Change Detection")) {
+    InputParameter<2> input;
+    input.intermediate_positions = {{0.0, 1.0}, {2.0, 3.0}, {4.0, 5.0}};
+    InputParameter<2> copy = input;
+    CHECK_FALSE( input.has_changed(copy) );
+
+    input.intermediate_positions.pop_front();
+    CHECK( input.intermediate_positions.size() == 2 );
+    CHECK( input.intermediate_positions.removed() == 1 );
+    CHECK( std::as_const(input.intermediate_positions).front()[0] == 2.0 );
+    CHECK( input.has_changed(copy) );
+
+    copy.intermediate_positions.pop_front();
+    CHECK_FALSE( input.has_changed(copy) );
+
+    // Equal remaining elements are detected without a common revision
+    InputParameter<2> rebuilt = input;
+    rebuilt.intermediate_positions = {{2.0, 3.0}, {4.0, 5.0}};
+    CHECK_FALSE( input.has_changed(rebuilt) );
+
+    rebuilt.intermediate_positions[1][0] = 4.5;
+    CHECK( input.has_changed(rebuilt) );
+
+    rebuilt.intermediate_positions.pop_front();
+    rebuilt.intermediate_positions.pop_front();
+    CHECK( rebuilt.intermediate_positions.empty() );
+    CHECK( rebuilt.intermediate_positions.to_vector().empty() );
+}
+
+TEST_CASE("waypoint-stream" * doctest::description("Receding-horizon Waypoint Stream")) {
+    constexpr size_t DOFs {2};
+    WaypointStream<DOFs> stream {0.005, 8};
+    stream.input.current_position = {0.0, 0.0};
+    stream.input.max_velocity = {1.0, 1.5};
+    stream.input.max_acceleration = {3.0, 2.0};
+    stream.input.max_jerk = {20.0, 30.0};
+
+    // Without further waypoints, the motion stops safely at the last one of the window
+    OutputParameter<DOFs> output;
+    CHECK( stream.update(output) == Result::Finished );
+    CHECK( stream.push({0.1, 0.05}) );
+    CHECK( stream.push({0.2, 0.15}) );
+
+    Result result;
+    size_t cycles {0};
+    while ((result = stream.update(output)) == Result::Working && cycles < 10000) {
+        ++cycles;
+    }
+    CHECK( result == Result::Finished );
+    CHECK( stream.reached_waypoints == 2 );
+    CHECK( output.new_position[0] == doctest::Approx(0.2) );
+    CHECK( output.new_position[1] == doctest::Approx(0.15) );
+    CHECK( output.new_velocity[0] == doctest::Approx(0.0) );
+    CHECK( output.new_velocity[1] == doctest::Approx(0.0) );
+
+    // A long path is streamed through the window, keeping the limits and passing the waypoints without stopping
+    constexpr size_t number_waypoints {400};
+    size_t pushed {0};
+    double min_speed {std::numeric_limits<double>::infinity()};
+    const auto path = [](size_t i) { return std::array<double, DOFs> {0.2 + 0.02 * i, 0.15 + 0.1 * std::sin(0.05 * i)}; };
+    for (cycles = 0; cycles < 100000; ++cycles) {
+        while (pushed < number_waypoints && stream.push(path(pushed + 1))) {
+            ++pushed;
+        }
+        if (pushed < number_waypoints) {
+            CHECK( stream.size() == stream.capacity() );
+        }
+
+        result = stream.update(output);
+        if (result != Result::Working) {
+            break;
+        }
+
+        for (size_t dof = 0; dof < DOFs; ++dof) {
+            CHECK( std::abs(output.new_velocity[dof]) <= stream.input.max_velocity[dof] + 1e-9 );
+            CHECK( std::abs(output.new_acceleration[dof]) <= stream.input.max_acceleration[dof] + 1e-9 );
+        }
+        if (stream.reached_waypoints > 3 && stream.reached_waypoints < number_waypoints) {
+            min_speed = std::min(min_speed, std::abs(output.new_velocity[0]));
+        }
+    }
+    CHECK( result == Result::Finished );
+    CHECK( stream.size() == 0 );
+    CHECK( stream.reached_waypoints == number_waypoints + 2 );
+    CHECK( min_speed > 0.1 );
+    CHECK( output.new_position[0] == doctest::Approx(path(number_waypoints)[0]) );
+    CHECK( output.new_position[1] == doctest::Approx(path(number_waypoints)[1]) );
+    CHECK( output.new_velocity[0] == doctest::Approx(0.0) );
+}
+
+TEST_CASE("export" * doctest::description("Streaming Export of Sampled Trajectories")) {
+    constexpr size_t DOFs {2};
+    Ruckig<DOFs, true> otg;
+
+    std::vector<Trajectory<DOFs>> trajectories(2);
+    InputParameter<DOFs> input;
+    input.current_position = {0.0, -0.5};
+    input.target_position = {1.0, 0.5};
+    input.max_velocity = {1.0, 1.0};
+    input.max_acceleration = {2.0, 3.0};
+    input.max_jerk = {5.0, 6.0};
+    REQUIRE( otg.calculate(input, trajectories[0]) == Result::Working );
+    input.target_position = {-0.3, 0.2};
+    input.current_velocity = {0.2, 0.0};
+    REQUIRE( otg.calculate(input, trajectories[1]) == Result::Working );
+
+    const double delta_time {0.01};
+    const size_t number_samples = trajectories[0].sample(delta_time).size() + trajectories[1].sample(delta_time).size();
+
+    for (const bool asynchronous: {false, true}) {
+        std::ostringstream binary;
+        {
+            TrajectoryExporter exporter {binary, ExportFormat::Binary, 64, asynchronous};
+            for (const auto& trajectory: trajectories) {
+                exporter.write(trajectory, delta_time);
+            }
+            exporter.close();
+            CHECK( exporter.size() == number_samples );
+            CHECK( exporter.trajectories() == 2 );
+        }
+
+        // Decode all chunks and compare the samples with the trajectories
+        const std::string data = binary.str();
+        const uint8_t* chunk = reinterpret_cast<const uint8_t*>(data.data());
+        const uint8_t* end = chunk + data.size();
+        size_t decoded_samples {0};
+        std::array<double, DOFs> new_position, new_velocity, new_acceleration;
+        while (chunk < end) {
+            REQUIRE( std::memcmp(chunk, "RUCKIGSC", 8) == 0 );
+            CHECK( TrajectorySerialization::load_integer(chunk + 8) == (TrajectoryExporter::version | (uint64_t {DOFs} << 32)) );
+            const size_t chunk_size = TrajectorySerialization::load_integer(chunk + 16);
+            const size_t index = TrajectorySerialization::load_integer(chunk + 24);
+            REQUIRE( chunk_size <= 64 );
+            REQUIRE( index < 2 );
+
+            const auto value = [&](size_t column, size_t i) { return TrajectorySerialization::load_double(chunk + TrajectoryExporter::header_size + 8 * (column * chunk_size + i)); };
+            for (size_t i = 0; i < chunk_size; ++i) {
+                trajectories[index].at_time(value(0, i), new_position, new_velocity, new_acceleration);
+                for (size_t dof = 0; dof < DOFs; ++dof) {
+                    CHECK( value(1 + dof, i) == doctest::Approx(new_position[dof]) );
+                    CHECK( value(1 + DOFs + dof, i) == doctest::Approx(new_velocity[dof]) );
+                    CHECK( value(1 + 2 * DOFs + dof, i) == doctest::Approx(new_acceleration[dof]) );
+                }
+            }
+
+            decoded_samples += chunk_size;
+            chunk += TrajectoryExporter::header_size + 8 * (1 + 3 * DOFs) * chunk_size;
+        }
+        CHECK( chunk == end );
+        CHECK( decoded_samples == number_samples );
+
+        std::ostringstream csv;
+        {
+            TrajectoryExporter exporter {csv, ExportFormat::CSV, 16, asynchronous};
+            for (const auto& trajectory: trajectories) {
+                exporter.write(trajectory, delta_time);
+            }
+        }
+
+        std::istringstream lines {csv.str()};
+        std::string line;
+        std::getline(lines, line);
+        CHECK( line == "trajectory,time,position_0,position_1,velocity_0,velocity_1,acceleration_0,acceleration_1" );
+        size_t rows {0};
+        while (std::getline(lines, line)) {
+            ++rows;
+        }
+        CHECK( rows == number_samples );
+    }
+}
+
+TEST_CASE("discrete-duration" * doctest::description("Discrete Durations at the Boundary of a Time Step")) {
+    Ruckig<1, true> otg_continuous;
+    Randomizer<1, decltype(position_dist)> p { position_dist, seed };
+    Randomizer<1, decltype(limit_dist)> l { limit_dist, seed + 1 };
+
+    InputParameter<1> input;
+    Trajectory<1> trajectory;
+    for (size_t i = 0; i < 256; ++i) {
+        p.fill(input.current_position);
+        p.fill(input.target_position);
+        l.fill(input.max_velocity);
+        l.fill(input.max_acceleration);
+        l.fill(input.max_jerk);
+        input.duration_discretization = DurationDiscretization::Continuous;
+        REQUIRE( otg_continuous.calculate(input, trajectory) == Result::Working );
+        const double min_duration = trajectory.get_duration();
+
+        // The minimal duration is (up to rounding) a multiple of the time step, which must not be rounded below it
+        const size_t steps = 1 + i % 16;
+        Ruckig<1, true> otg {min_duration / steps};
+        input.duration_discretization = DurationDiscretization::Discrete;
+        REQUIRE( otg.calculate(input, trajectory) == Result::Working );
+        CHECK( trajectory.get_duration() >= min_duration );
+        CHECK( trajectory.get_duration() / otg.delta_time == doctest::Approx(std::round(trajectory.get_duration() / otg.delta_time)) );
+        CHECK( trajectory.get_duration() <= min_duration + otg.delta_time * (1 + 1e-9) );
+    }
+}
+
+TEST_CASE("variable-time-step" * doctest::description("Update with a Measured Time Step")) {
+    Ruckig<3, true> otg {0.005};
+    Ruckig<3, true> otg_fixed {0.005};
+    InputParameter<3> input;
+    OutputParameter<3> output, output_fixed;
+    input.current_position = {0.2, 0.0, -1.0};
+    input.target_position = {1.0, -2.0, 0.5};
+    input.target_velocity = {0.2, 0.0, -0.3};
+    input.max_velocity = {1.0, 1.5, 2.0};
+    input.max_acceleration = {2.0, 1.0, 3.0};
+    input.max_jerk = {5.0, 4.0, 6.0};
+
+    // A jittering cycle time samples the same trajectory without recalculations
+    std::mt19937 gen (seed);
+    std::uniform_real_distribution<double> jitter {0.0, 0.01};
+    REQUIRE( otg_fixed.update(input, output_fixed) == Result::Working );
+
+    std::array<double, 3> position, velocity, acceleration;
+    double time {0.0};
+    size_t calculations {0};
+    Result result {Result::Working};
+    while (result == Result::Working) {
+        const double time_step = (calculations == 0) ? otg.delta_time : jitter(gen);
+        result = otg.update(input, output, time_step);
+        REQUIRE( result >= 0 );
+        time += time_step;
+        calculations += output.new_calculation;
+
+        output_fixed.trajectory.at_time(time, position, velocity, acceleration);
+        CHECK( output.time == doctest::Approx(time) );
+        CHECK( output.new_position[0] == doctest::Approx(position[0]) );
+        CHECK( output.new_velocity[1] == doctest::Approx(velocity[1]) );
+        CHECK( output.new_acceleration[2] == doctest::Approx(acceleration[2]) );
+        output.pass_to_input(input);
+    }
+    CHECK( calculations == 1 );
+    CHECK( output.new_position[1] == doctest::Approx(input.target_position[1]) );
+
+    CHECK( otg.update(input, output, 0.0) == Result::Finished );
+    CHECK_THROWS( otg.update(input, output, -0.001) );
+    CHECK_THROWS( otg.update(input, output, std::numeric_limits<double>::quiet_NaN()) );
+}
+
+TEST_CASE("failed-recalculation" * doctest::description("Previous Trajectory after a Failed Recalculation")) {
+    Ruckig<3> otg {0.005};
+    InputParameter<3> input;
+    OutputParameter<3> output;
+    input.current_position = {0.0, 0.5, -1.0};
+    input.target_position = {1.0, -0.5, 2.0};
+    input.max_velocity = {1.0, 1.5, 2.0};
+    input.max_acceleration = {2.0, 1.0, 3.0};
+    input.max_jerk = {5.0, 4.0, 6.0};
+
+    for (size_t i = 0; i < 20; ++i) {
+        REQUIRE( otg.update(input, output) == Result::Working );
+        output.pass_to_input(input);
+    }
+    const double duration = output.trajectory.get_duration();
+    const auto position = output.new_position;
+
+    // A valid input whose trajectory exceeds the maximal duration fails after Step 1
+    InputParameter<3> far_input = input;
+    far_input.target_position[0] = 1e6;
+    far_input.max_velocity[0] = 0.01;
+    CHECK( otg.update(far_input, output) == Result::ErrorTrajectoryDuration );
+    CHECK( otg.get_error().result == Result::ErrorTrajectoryDuration );
+    CHECK( output.trajectory.get_duration() == duration );
+
+    // The previous trajectory continues with the previous input
+    CHECK( otg.update(input, output) == Result::Working );
+    CHECK_FALSE( output.new_calculation );
+    CHECK( output.new_position[2] > position[2] );
+
+    std::array<double, 3> new_position, new_velocity, new_acceleration;
+    output.trajectory.at_time(output.time, new_position, new_velocity, new_acceleration);
+    CHECK( output.new_position == new_position );
+}
+
+TEST_CASE("subcycles" * doctest::description("Sub-cycle Interpolation")) {
+    constexpr size_t DOFs {2}, K {8};
+    Ruckig<DOFs, true> otg {0.004};
+    InputParameter<DOFs> input;
+    OutputParameter<DOFs> output;
+    input.current_position = {0.0, -0.5};
+    input.intermediate_positions = {{0.4, 0.3}, {0.9, 0.1}};
+    input.target_position = {1.5, 0.8};
+    input.max_velocity = {1.0, 1.5};
+    input.max_acceleration = {3.0, 2.0};
+    input.max_jerk = {20.0, 15.0};
+
+    std::array<double, K * DOFs> positions, velocities;
+    std::array<double, DOFs> position, velocity, acceleration;
+    double last_time {0.0};
+    Result result {Result::Working};
+    while (result == Result::Working) {
+        result = otg.update(input, output, K, positions.data(), velocities.data());
+        REQUIRE( result >= 0 );
+        if (output.new_calculation) {
+            last_time = 0.0;
+        }
+
+        // Evenly spaced along the trajectory through all sections, the last one at the output state
+        for (size_t k = 0; k < K; ++k) {
+            otg.get_waypoint_trajectory().at_time(last_time + otg.delta_time * (k + 1) / K, position, velocity, acceleration);
+            for (size_t dof = 0; dof < DOFs; ++dof) {
+                CHECK( positions[k * DOFs + dof] == doctest::Approx(position[dof]) );
+                CHECK( velocities[k * DOFs + dof] == doctest::Approx(velocity[dof]) );
+            }
+        }
+        CHECK( positions[(K - 1) * DOFs] == output.new_position[0] );
+        CHECK( velocities[(K - 1) * DOFs + 1] == output.new_velocity[1] );
+
+        last_time += otg.delta_time;
+        output.pass_to_input(input);
+    }
+}
+
+TEST_CASE("update-ahead" * doctest::description("Lookahead Output of Multiple Cycles")) {
+    constexpr size_t DOFs {2}, N {32};
+    Ruckig<DOFs, true> otg {0.002}, otg_single {0.002};
+    InputParameter<DOFs> input;
+    OutputParameter<DOFs> output, output_single;
+    input.current_position = {0.0, -0.5};
+    input.intermediate_positions = {{0.1, -0.4}, {0.2, -0.45}, {0.3, 0.0}};
+    input.target_position = {1.5, 0.8};
+    input.max_velocity = {1.0, 1.5};
+    input.max_acceleration = {3.0, 2.0};
+    input.max_jerk = {20.0, 15.0};
+    InputParameter<DOFs> input_single {input};
+
+    // Equal to single updates, alternating with them
+    std::array<double, N * DOFs> positions, velocities;
+    size_t calculations {0};
+    Result result {Result::Working};
+    for (size_t refill = 0; result == Result::Working; ++refill) {
+        if (refill % 3 == 2) {
+            result = otg.update(input, output);
+            REQUIRE( result >= 0 );
+            calculations += output.new_calculation;
+            output.pass_to_input(input);
+
+            REQUIRE( otg_single.update(input_single, output_single) >= 0 );
+            output_single.pass_to_input(input_single);
+            CHECK( output.new_position[0] == doctest::Approx(output_single.new_position[0]) );
+            continue;
+        }
+
+        result = otg.update_ahead(input, output, N, positions.data(), velocities.data());
+        REQUIRE( result >= 0 );
+        calculations += output.new_calculation;
+
+        for (size_t cycle = 0; cycle < N; ++cycle) {
+            REQUIRE( otg_single.update(input_single, output_single) >= 0 );
+            output_single.pass_to_input(input_single);
+            for (size_t dof = 0; dof < DOFs; ++dof) {
+                CHECK( positions[cycle * DOFs + dof] == doctest::Approx(output_single.new_position[dof]) );
+                CHECK( velocities[cycle * DOFs + dof] == doctest::Approx(output_single.new_velocity[dof]) );
+            }
+        }
+        CHECK( input.current_position[1] == output_single.new_position[1] );
+        CHECK( input.intermediate_positions.size() == input_single.intermediate_positions.size() );
+        CHECK( output.new_section == output_single.new_section );
+    }
+    CHECK( calculations == 1 );
+    CHECK( input.current_position[0] == doctest::Approx(input.target_position[0]) );
+}
+
+TEST_CASE("speed-override" * doctest::description("Jerk-limited Speed Override")) {
+    SpeedOverride speed_override;
+    speed_override.target = 0.5;
+    double previous_rate {0.0}, time {0.0};
+    for (size_t i = 0; i < 2000 && speed_override.get_ratio() != 0.5; ++i) {
+        const double time_step = speed_override.step(0.001);
+        CHECK( std::abs(speed_override.get_rate()) <= speed_override.max_rate );
+        const double max_rate_change = (speed_override.get_ratio() == 0.5) ? 2 * speed_override.max_rate_change : speed_override.max_rate_change; // Landing on the target
+        CHECK( std::abs(speed_override.get_rate() - previous_rate) <= max_rate_change * 0.001 + 1e-12 );
+        CHECK( speed_override.get_ratio() >= 0.5 );
+        previous_rate = speed_override.get_rate();
+        time += time_step;
+    }
+    CHECK( speed_override.get_ratio() == 0.5 );
+    CHECK( speed_override.get_rate() == 0.0 );
+    CHECK( time > 0.0 );
+
+    constexpr size_t DOFs {2};
+    constexpr double delta_time {0.002};
+    Ruckig<DOFs, true> otg {delta_time};
+    InputParameter<DOFs> input;
+    OutputParameter<DOFs> output;
+    input.current_position = {0.0, -0.5};
+    input.target_position = {2.5, 0.8};
+    input.max_velocity = {1.0, 1.5};
+    input.max_acceleration = {3.0, 2.0};
+    input.max_jerk = {20.0, 15.0};
+    otg.speed_override.max_rate = 2.0;
+
+    // Half speed, feed hold, a new target at half speed, and back to full speed
+    std::array<double, DOFs> previous_velocity {0.0, 0.0};
+    size_t calculations {0}, cycle {0};
+    Result result {Result::Working};
+    for (; result == Result::Working && cycle < 10000; ++cycle) {
+        switch (cycle) {
+            case 200: otg.speed_override.target = 0.5; break;
+            case 400: otg.speed_override.target = 0.0; break;
+            case 800: otg.speed_override.target = 0.5; break;
+            case 1100: input.target_position = {1.5, 1.0}; break;
+            case 1300: otg.speed_override.target = 1.0; break;
+        }
+
+        result = otg.update(input, output);
+        REQUIRE( result >= 0 );
+        calculations += output.new_calculation;
+
+        // The velocity stays continuous, also across the recalculation
+        for (size_t dof = 0; dof < DOFs; ++dof) {
+            CHECK( std::abs(output.new_velocity[dof] - previous_velocity[dof]) <= (input.max_acceleration[dof] + otg.speed_override.max_rate * input.max_velocity[dof]) * delta_time );
+            CHECK( std::abs(output.new_velocity[dof]) <= input.max_velocity[dof] + 1e-9 );
+        }
+        previous_velocity = output.new_velocity;
+
+        if (cycle == 799) {
+            CHECK( otg.speed_override.get_ratio() == 0.0 );
+            CHECK( output.new_velocity[0] == 0.0 );
+            CHECK( output.new_position[0] == input.current_position[0] );
+        }
+        output.pass_to_input(input);
+    }
+    CHECK( result == Result::Finished );
+    CHECK( calculations == 2 );
+    CHECK( otg.speed_override.is_identity() );
+    check_array(output.new_position, input.target_position);
+}
+
+TEST_CASE("phase-synchronization-scaling" * doctest::description("Phase Synchronization by Profile Scaling")) {
+    constexpr size_t DOFs {3};
+    Ruckig<DOFs, true> otg {0.005};
+
+    Randomizer<DOFs, decltype(position_dist)> p { position_dist, seed };
+    Randomizer<DOFs, decltype(limit_dist)> l { limit_dist, seed + 1 };
+    std::mt19937 gen (seed + 2);
+    std::normal_distribution<double> scale_dist {0.0, 0.5};
+
+    std::array<double, DOFs> direction, new_position, new_velocity, new_acceleration;
+    size_t number_straight_lines {0};
+    for (size_t i = 0; i < 512; ++i) {
+        InputParameter<DOFs> input;
+        input.synchronization = Synchronization::Phase;
+        p.fill(input.current_position);
+        p.fill(direction);
+
+        // A collinear input along the direction, with an initial velocity above the limits for some inputs (so that the limiting DoF brakes)
+        const double distance {scale_dist(gen)}, v0 {scale_dist(gen)}, a0 {scale_dist(gen)}, vf {scale_dist(gen)};
+        for (size_t dof = 0; dof < DOFs; ++dof) {
+            input.target_position[dof] = input.current_position[dof] + distance * direction[dof];
+            input.current_velocity[dof] = v0 * direction[dof];
+            input.current_acceleration[dof] = a0 * direction[dof];
+            input.target_velocity[dof] = vf * direction[dof];
+        }
+        l.fill(input.max_velocity, input.target_velocity);
+        l.fill(input.max_acceleration);
+        l.fill(input.max_jerk);
+        if (!otg.validate_input(input)) {
+            continue;
+        }
+
+        Trajectory<DOFs> trajectory;
+        REQUIRE( otg.calculate(input, trajectory) == Result::Working );
+
+        trajectory.at_time(trajectory.get_duration(), new_position, new_velocity, new_acceleration);
+        check_array(new_position, input.target_position);
+        check_array(new_velocity, input.target_velocity);
+
+        // The motion is a straight line if it is phase synchronized
+        bool is_straight_line {true};
+        for (size_t j = 0; j <= 20; ++j) {
+            trajectory.at_time(trajectory.get_duration() * j / 20, new_position, new_velocity, new_acceleration);
+            for (size_t dof = 1; dof < DOFs; ++dof) {
+                const double offset = (new_position[dof] - input.current_position[dof]) * direction[0] - (new_position[0] - input.current_position[0]) * direction[dof];
+                is_straight_line &= (std::abs(offset) < 1e-8 * (1.0 + std::abs(direction[0] * direction[dof])));
+            }
+        }
+        number_straight_lines += is_straight_line;
+    }
+    CHECK( number_straight_lines > 256 );
+
+    // A DoF with an unchanged input keeps its own brake trajectory after it was scaled from the limiting DoF
+    Ruckig<2, true> otg_two {0.005};
+    InputParameter<2> input;
+    input.synchronization = Synchronization::Phase;
+    input.current_position = {0.0, 0.0};
+    input.current_velocity = {1.5, 3.0};
+    input.target_position = {1.0, 2.0};
+    input.max_velocity = {1.0, 10.0};
+    input.max_acceleration = {2.0, 10.0};
+    input.max_jerk = {5.0, 20.0};
+
+    Trajectory<2> trajectory, fresh;
+    REQUIRE( otg_two.calculate(input, trajectory) == Result::Working );
+    input.target_position[0] = 1.5;
+    REQUIRE( otg_two.calculate(input, trajectory) == Result::Working );
+    REQUIRE( otg_two.calculate(input, fresh) == Result::Working );
+    CHECK( trajectory.get_duration() == doctest::Approx(fresh.get_duration()) );
+
+    std::array<double, 2> position, velocity, acceleration, fresh_position;
+    for (size_t j = 0; j <= 20; ++j) {
+        const double time = fresh.get_duration() * j / 20;
+        trajectory.at_time(time, position, velocity, acceleration);
+        fresh.at_time(time, fresh_position, velocity, acceleration);
+        check_array(position, fresh_position);
+    }
+}
+
+TEST_CASE("stop" * doctest::description("Closed-form Stop Trajectory")) {
+    constexpr size_t DOFs {3};
+    Ruckig<DOFs, true> otg {0.005};
+    Randomizer<DOFs, decltype(position_dist)> p { position_dist, seed };
+    Randomizer<DOFs, decltype(dynamic_dist)> d { dynamic_dist, seed + 1 };
+    Randomizer<DOFs, decltype(limit_dist)> l { limit_dist, seed + 2 };
+
+    InputParameter<DOFs> input, velocity_input;
+    Trajectory<DOFs> trajectory, velocity_trajectory;
+    std::array<double, DOFs> position, velocity, acceleration;
+    for (size_t i = 0; i < 1024; ++i) {
+        p.fill(input.current_position);
+        d.fill_or_zero(input.current_velocity, 0.9);
+        d.fill_or_zero(input.current_acceleration, 0.8);
+        l.fill(input.max_acceleration);
+        l.fill(input.max_jerk);
+
+        // Same independent stops as with the velocity interface
+        velocity_input = input;
+        velocity_input.control_interface = ControlInterface::Velocity;
+        velocity_input.synchronization = Synchronization::None;
+        REQUIRE( otg.calculate_stop(input, trajectory, false) == Result::Working );
+        REQUIRE( otg.calculate(velocity_input, velocity_trajectory) == Result::Working );
+        CHECK( trajectory.get_duration() == doctest::Approx(velocity_trajectory.get_duration()) );
+        for (size_t dof = 0; dof < DOFs; ++dof) {
+            CHECK( trajectory.get_independent_min_durations()[dof] == doctest::Approx(velocity_trajectory.get_independent_min_durations()[dof]) );
+        }
+
+        // Synchronized as with the velocity interface
+        REQUIRE( otg.calculate_stop(input, trajectory) == Result::Working );
+        velocity_input.synchronization = Synchronization::Time;
+        REQUIRE( otg.calculate(velocity_input, velocity_trajectory) == Result::Working );
+        CHECK( trajectory.get_duration() == doctest::Approx(velocity_trajectory.get_duration()) );
+
+        trajectory.at_time(trajectory.get_duration(), position, velocity, acceleration);
+        for (size_t dof = 0; dof < DOFs; ++dof) {
+            CHECK( velocity[dof] == doctest::Approx(0.0).epsilon(1e-9) );
+            CHECK( acceleration[dof] == doctest::Approx(0.0).epsilon(1e-9) );
+        }
+    }
+
+    input.max_jerk[1] = 0.0;
+    CHECK( Ruckig<DOFs>{0.005}.calculate_stop(input, trajectory) == Result::ErrorInvalidInput );
+
+    // The following updates continue along the stop trajectory
+    input.current_position = {0.0, 1.0, -1.0};
+    input.current_velocity = {1.0, -0.5, 0.2};
+    input.current_acceleration = {0.5, 0.0, -2.0};
+    input.target_position = {5.0, 5.0, 5.0};
+    input.max_velocity = {2.0, 2.0, 2.0};
+    input.max_acceleration = {2.0, 1.0, 3.0};
+    input.max_jerk = {10.0, 5.0, 20.0};
+
+    OutputParameter<DOFs> output;
+    Result result = otg.stop(input, output);
+    CHECK( output.new_calculation );
+    const double stop_duration = output.trajectory.get_duration();
+    while (result == Result::Working) {
+        output.pass_to_input(input);
+        result = otg.update(input, output);
+        CHECK_FALSE( output.new_calculation );
+    }
+    CHECK( result == Result::Finished );
+    CHECK( output.trajectory.get_duration() == stop_duration );
+    CHECK( output.new_velocity[0] == doctest::Approx(0.0) );
+}
+
+TEST_CASE("instrumentation" * doctest::description("Timing Instrumentation")) {
+    InputParameter<3> input;
+    input.current_position = {0.0, -2.0, 0.0};
+    input.target_position = {1.0, -3.0, 2.0};
+    input.max_velocity = {1.0, 1.0, 1.0};
+    input.max_acceleration = {1.0, 1.0, 1.0};
+    input.max_jerk = {1.0, 1.0, 1.0};
+
+    Ruckig<3, true, true, 0, Instrumentation::Phases> otg {0.005};
+    OutputParameter<3> output;
+
+    CHECK( otg.update(input, output) == Result::Working );
+    CHECK( output.calculation_duration > 0.0 );
+    double phases_duration {output.calculation_timing.synchronization + output.calculation_timing.phase_synchronization};
+    for (size_t dof = 0; dof < 3; ++dof) {
+        CHECK( output.calculation_timing.step1[dof] >= 0.0 );
+        phases_duration += output.calculation_timing.brake[dof] + output.calculation_timing.step1[dof] + output.calculation_timing.step2[dof];
+    }
+    CHECK( phases_duration > 0.0 );
+    CHECK( phases_duration <= output.calculation_duration );
+
+    Ruckig<3, true, true, 0, Instrumentation::None> otg_none {0.005};
+    OutputParameter<3> output_none;
+
+    CHECK( otg_none.update(input, output_none) == Result::Working );
+    CHECK( output_none.calculation_duration == 0.0 );
+    CHECK( output_none.trajectory.get_duration() == output.trajectory.get_duration() );
+}
+
+template<class OTGType, class InputType, class OutputType>
+void check_steady_state_allocations(OTGType& otg, InputType input, OutputType output) {
+    input.current_position = {0.0, -2.0, 0.0};
+    input.target_position = {1.0, -3.0, 2.0};
+    input.max_velocity = {1.0, 1.0, 1.0};
+    input.max_acceleration = {1.0, 1.0, 1.0};
+    input.max_jerk = {1.0, 1.0, 1.0};
+
+    CHECK( otg.update(input, output) == Result::Working );
+    output.pass_to_input(input);
+
+    // Sampling cycles and a recalculation for a new target do not allocate
+    const auto before = AllocationCounter::now();
+    for (size_t cycle = 0; cycle < 64; ++cycle) {
+        CHECK( otg.update(input, output) == Result::Working );
+        output.pass_to_input(input);
+    }
+    input.target_position = {2.0, -1.0, 1.0};
+    CHECK( otg.update(input, output) == Result::Working );
+    CHECK( output.new_calculation );
+    CHECK( (AllocationCounter::now() - before).allocations == 0 );
+}
+
+TEST_CASE("memory" * doctest::description("Memory Footprint and Allocations")) {
+    CHECK( AllocationCounter::is_installed );
+
+    const auto report = MemoryReport::of<3>();
+    CHECK( report.ruckig == sizeof(Ruckig<3>) );
+    CHECK( report.trajectory == sizeof(Trajectory<3>) );
+    CHECK( report.block == sizeof(Block) );
+    CHECK( report.ruckig_heap.value() == 0 );
+    CHECK( report.trajectory_heap.value() == 0 );
+    CHECK( report.input_parameter_heap.value() == 0 );
+    CHECK( report.output_parameter_heap.value() == 0 );
+    CHECK( report.total() == sizeof(Ruckig<3>) + sizeof(Trajectory<3>) + sizeof(InputParameter<3>) + sizeof(OutputParameter<3>) );
+
+    const auto dynamic_report = MemoryReport::of<0>(3);
+    CHECK( dynamic_report.degrees_of_freedom == 3 );
+    CHECK( dynamic_report.dynamic_dofs );
+    CHECK( dynamic_report.ruckig_heap.value() > 0 );
+    CHECK( dynamic_report.trajectory_heap.value() > 0 );
+    CHECK( dynamic_report.input_parameter_heap.value() > 0 );
+
+    const auto bounded_report = MemoryReport::of<0, 3>(3);
+    CHECK( bounded_report.ruckig_heap.value() == 0 );
+    CHECK( bounded_report.trajectory_heap.value() == 0 );
+
+    Ruckig<3> otg {0.005};
+    check_steady_state_allocations(otg, InputParameter<3>(), OutputParameter<3>());
+
+    Ruckig<0> otg_dynamic {3, 0.005};
+    check_steady_state_allocations(otg_dynamic, InputParameter<0>(3), OutputParameter<0>(3));
+
+    Ruckig<0, false, true, 3> otg_bounded {3, 0.005};
+    check_steady_state_allocations(otg_bounded, InputParameter<0, 3>(3), OutputParameter<0, 3>(3));
+}
+
+TEST_CASE("cache-alignment" * doctest::description("Cache-line Aligned Instances")) {
+    // The calculation workspace starts on its own cache line, so that instances are aligned as well
+    CHECK( alignof(Ruckig<3>) == cache_line_size );
+    CHECK( sizeof(Ruckig<3>) % cache_line_size == 0 );
+    CHECK( alignof(Ruckig<0>) == cache_line_size );
+
+    struct Axis {
+        Ruckig<3> otg {0.005};
+        InputParameter<3> input;
+        OutputParameter<3> output;
+    };
+    CHECK( alignof(CacheAligned<InputParameter<3>>) == cache_line_size );
+    CHECK( sizeof(CacheAligned<OutputParameter<3>>) % cache_line_size == 0 );
+
+    std::vector<CacheAligned<Axis>> axes(5);
+    std::vector<CacheAligned<InputParameter<0>>> dynamic_inputs;
+    for (size_t i = 0; i < axes.size(); ++i) {
+        CHECK( reinterpret_cast<std::uintptr_t>(&axes[i]) % cache_line_size == 0 );
+
+        auto& axis = axes[i];
+        axis.input.target_position = {1.0 + 0.1 * i, -0.5, 0.2};
+        axis.input.max_velocity = {1.0, 1.0, 1.0};
+        axis.input.max_acceleration = {2.0, 2.0, 2.0};
+        axis.input.max_jerk = {4.0, 4.0, 4.0};
+        CHECK( axis.otg.update(axis.input, axis.output) == Result::Working );
+
+        dynamic_inputs.emplace_back(3);
+        CHECK( dynamic_inputs.back().degrees_of_freedom == 3 );
+    }
+    for (const auto& input: dynamic_inputs) {
+        CHECK( reinterpret_cast<std::uintptr_t>(&input) % cache_line_size == 0 );
+    }
+}
+
+TEST_CASE("case-statistics" * doctest::description("Profile Case Statistics")) {
+    Randomizer<3, decltype(position_dist)> p { position_dist, seed };
+    Randomizer<3, decltype(dynamic_dist)> d { dynamic_dist, seed + 1 };
+    Randomizer<3, decltype(limit_dist)> l { limit_dist, seed + 2 };
+
+    Ruckig<3, false, true, 0, Instrumentation::Cases> otg {0.005};
+    Ruckig<3, false, true> otg_default {0.005};
+    InputParameter<3> input;
+    Trajectory<3> trajectory, trajectory_default;
+    std::vector<InputParameter<3>> inputs;
+
+    size_t calculations {0};
+    for (size_t i = 0; i < 256; ++i) {
+        p.fill(input.current_position);
+        d.fill_or_zero(input.current_velocity, 0.9);
+        d.fill_or_zero(input.current_acceleration, 0.8);
+        p.fill(input.target_position);
+        d.fill_or_zero(input.target_velocity, 0.7);
+        l.fill(input.max_velocity, input.target_velocity);
+        l.fill(input.max_acceleration);
+        l.fill(input.max_jerk);
+        if (!otg.validate_input(input)) {
+            continue;
+        }
+
+        CHECK( otg.calculate(input, trajectory) == Result::Working );
+        CHECK( otg_default.calculate(input, trajectory_default) == Result::Working );
+        CHECK( trajectory.get_duration() == trajectory_default.get_duration() );
+        inputs.push_back(input);
+        calculations += 1;
+    }
+
+    const auto sum = [](const auto& values) { return std::accumulate(values.begin(), values.end(), uint64_t {0}); };
+    const CaseStatistics& cases = otg.get_case_statistics();
+    CHECK( cases.calculations == calculations );
+    CHECK( sum(cases.position_limits) == 3 * calculations );
+    CHECK( sum(cases.position_jerk_signs) == 3 * calculations );
+    CHECK( sum(cases.velocity_limits) == 0 );
+    CHECK( sum(cases.synchronization_candidates) == calculations );
+    CHECK( cases.position_step1 == 3 * calculations );
+    CHECK( cases.position_step1_cases >= cases.position_step1 );
+    CHECK( cases.position_step1_two_step <= cases.position_step1 );
+    CHECK( cases.step2 <= 2 * calculations );
+    CHECK( otg_default.get_case_statistics().calculations == 0 );
+
+    // A batch on multiple threads counts the same cases
+    const CaseStatistics cases_sequential = cases;
+    otg.reset_case_statistics();
+    std::vector<Trajectory<3>> trajectories;
+    std::vector<Result> results;
+    otg.calculate_batch(inputs, trajectories, results, 4);
+    CHECK( cases.calculations == cases_sequential.calculations );
+    CHECK( cases.position_limits == cases_sequential.position_limits );
+    CHECK( cases.position_jerk_signs == cases_sequential.position_jerk_signs );
+    CHECK( cases.position_step1_cases == cases_sequential.position_step1_cases );
+    CHECK( cases.step2 == cases_sequential.step2 );
+    CHECK( cases.synchronization_candidates == cases_sequential.synchronization_candidates );
+
+    // Only calculations are counted, an unchanged input within update is not
+    input.control_interface = ControlInterface::Velocity;
+    otg.reset_case_statistics();
+    OutputParameter<3> output;
+    CHECK( otg.update(input, output) == Result::Working );
+    output.pass_to_input(input);
+    CHECK( otg.update(input, output) == Result::Working );
+    CHECK( otg.get_case_statistics().calculations == 1 );
+    CHECK( sum(otg.get_case_statistics().velocity_limits) == 3 );
+    CHECK( otg.get_case_statistics().position_step1 == 0 );
+}
+
+TEST_CASE("normalized-fallback" * doctest::description("Re-solving Inputs of Extreme Scale in Normalized Units")) {
+    Ruckig<3, false, true, 0, Instrumentation::Cases> otg {0.005};
+    InputParameter<3> input;
+    Trajectory<3> trajectory;
+
+    // The limits of the first DoF span eight orders of magnitude, so that no profile passes the checks in its units
+    input.current_position = {0.0096745021343483898, 0.0, 0.2};
+    input.current_velocity = {-0.78507554405896696, 0.0, 0.1};
+    input.current_acceleration = {-0.53114234036172148, 0.0, 0.0};
+    input.target_position = {-0.0096580314500598497, 1.0, -0.5};
+    input.max_velocity = {0.0019269930604733315, 1.0, 1.0};
+    input.max_acceleration = {282.87094917854927, 1.0, 1.0};
+    input.max_jerk = {0.0031449450786355366, 1.0, 1.0};
+
+    CHECK( otg.calculate(input, trajectory) == Result::Working );
+    CHECK( trajectory.get_duration() == doctest::Approx(411.383).epsilon(1e-5) );
+    CHECK( otg.get_case_statistics().normalized == 1 );
+
+    std::array<double, 3> new_position, new_velocity, new_acceleration;
+    trajectory.at_time(trajectory.get_duration(), new_position, new_velocity, new_acceleration);
+    for (size_t dof = 0; dof < 3; ++dof) {
+        CHECK( new_position[dof] == doctest::Approx(input.target_position[dof]) );
+        CHECK( new_velocity[dof] == doctest::Approx(0.0) );
+        CHECK( new_acceleration[dof] == doctest::Approx(0.0) );
+    }
+
+    // The same DoF alone is time-optimal
+    Ruckig<1> otg_single {0.005};
+    InputParameter<1> input_single;
+    Trajectory<1> trajectory_single;
+    input_single.current_position = {input.current_position[0]};
+    input_single.current_velocity = {input.current_velocity[0]};
+    input_single.current_acceleration = {input.current_acceleration[0]};
+    input_single.target_position = {input.target_position[0]};
+    input_single.max_velocity = {input.max_velocity[0]};
+    input_single.max_acceleration = {input.max_acceleration[0]};
+    input_single.max_jerk = {input.max_jerk[0]};
+    CHECK( otg_single.calculate(input_single, trajectory_single) == Result::Working );
+    CHECK( trajectory_single.get_duration() == doctest::Approx(trajectory.get_duration()) );
+
+    // Inputs of moderate scale never need the fallback
+    otg.reset_case_statistics();
+    input.current_velocity[0] = 0.0;
+    input.current_acceleration[0] = 0.0;
+    input.max_velocity[0] = 1.0;
+    input.max_acceleration[0] = 1.0;
+    input.max_jerk[0] = 1.0;
+    CHECK( otg.calculate(input, trajectory) == Result::Working );
+    CHECK( otg.get_case_statistics().normalized == 0 );
+}
+
+TEST_CASE("latency-statistics" * doctest::description("Latency Histograms")) {
+    LatencyHistogram histogram;
+    CHECK( histogram.percentile(0.5) == 0.0 );
+    for (size_t i = 1; i <= 1000; ++i) {
+        histogram.record(static_cast<double>(i));
+    }
+    CHECK( histogram.count() == 1000 );
+    CHECK( histogram.max() == doctest::Approx(1000.0) );
+    CHECK( histogram.percentile(0.5) >= 500.0 );
+    CHECK( histogram.percentile(0.5) <= 500.0 * 1.0625 );
+    CHECK( histogram.percentile(0.999) >= 999.0 );
+    CHECK( histogram.percentile(1.0) == doctest::Approx(1000.0) );
+    histogram.record(0.02);
+    CHECK( histogram.percentile(0.0) == doctest::Approx(0.02) );
+    histogram.reset();
+    CHECK( histogram.count() == 0 );
+
+    InputParameter<3> input;
+    input.current_position = {0.0, -2.0, 0.0};
+    input.target_position = {1.0, -3.0, 2.0};
+    input.max_velocity = {1.0, 1.0, 1.0};
+    input.max_acceleration = {1.0, 1.0, 1.0};
+    input.max_jerk = {1.0, 1.0, 1.0};
+
+    LatencyStatistics<3> statistics;
+    LatencyStatistics<3>::MaxSample sample;
+    CHECK_FALSE( statistics.get_max(sample) );
+
+    Ruckig<3> otg {0.005};
+    otg.latency_statistics = &statistics;
+    OutputParameter<3> output;
+
+    // Read concurrently by a monitoring thread
+    std::atomic<bool> running {true};
+    std::thread monitor([&statistics, &running]() {
+        LatencyStatistics<3>::MaxSample monitor_sample;
+        while (running) {
+            statistics.calculation.percentile(0.999);
+            statistics.sampling.percentile(0.999);
+            statistics.get_max(monitor_sample);
+        }
+    });
+
+    size_t cycles {0};
+    Result result {Result::Working};
+    while (result == Result::Working) {
+        result = otg.update(input, output);
+        output.pass_to_input(input);
+        ++cycles;
+    }
+    running = false;
+    monitor.join();
+
+    CHECK( result == Result::Finished );
+    CHECK( statistics.calculation.count() == 1 );
+    CHECK( statistics.sampling.count() == cycles - 1 );
+    CHECK( statistics.sampling.percentile(0.5) <= statistics.sampling.max() );
+
+    REQUIRE( statistics.get_max(sample) );
+    CHECK( sample.duration >= statistics.calculation.max() / 1.0625 );
+    CHECK( sample.duration >= statistics.sampling.max() / 1.0625 );
+    if (sample.calculation) {
+        CHECK( sample.input.current_position[1] == -2.0 );
+        CHECK( sample.input.target_position[2] == 2.0 );
+    }
+
+    statistics.reset();
+    CHECK( statistics.calculation.count() == 0 );
+    CHECK_FALSE( statistics.get_max(sample) );
+
+    input.target_position = {2.0, -1.0, 1.0};
+    CHECK( otg.update(input, output) == Result::Working );
+    REQUIRE( statistics.get_max(sample) );
+    CHECK( sample.calculation );
+    CHECK( sample.input.target_position[0] == 2.0 );
+    CHECK( statistics.calculation.count() == 1 );
+}
+
+TEST_CASE("step1-minimum-duration" * doctest::description("Step 1 without Blocked Intervals")) {
+    Randomizer<1, decltype(position_dist)> p { position_dist, seed };
+    Randomizer<1, decltype(dynamic_dist)> d { dynamic_dist, seed + 1 };
+    Randomizer<1, decltype(limit_dist)> l { limit_dist, seed + 2 };
+
+    std::array<double, 1> p0, v0, a0, pf, vf, af, vMax, aMax, jMax;
+    for (size_t i = 0; i < 1024; ++i) {
+        p.fill(p0);
+        d.fill(v0);
+        d.fill(a0);
+        p.fill(pf);
+        d.fill(vf);
+        d.fill(af);
+        l.fill(vMax, vf);
+        l.fill(aMax, af);
+        l.fill(jMax);
+
+        PositionStep1 step1 {p0[0], v0[0], a0[0], pf[0], vf[0], af[0], vMax[0], -vMax[0], aMax[0], -aMax[0], jMax[0]};
+        Block block, block_minimum;
+        if (!step1.get_profile(Profile(), block)) {
+            continue;
+        }
+
+        CHECK( step1.get_profile(Profile(), block_minimum, true) );
+        CHECK( block_minimum.t_min == doctest::Approx(block.t_min) );
+        CHECK_FALSE( block_minimum.has_a );
+        CHECK_FALSE( block_minimum.has_b );
+    }
+}
+
+TEST_CASE("min-duration" * doctest::description("Minimal Duration without Step 2")) {
+    Randomizer<3, decltype(position_dist)> p { position_dist, seed };
+    Randomizer<3, decltype(dynamic_dist)> d { dynamic_dist, seed + 1 };
+    Randomizer<3, decltype(limit_dist)> l { limit_dist, seed + 2 };
+
+    Ruckig<3, true> otg {0.005};
+    InputParameter<3> input;
+    Trajectory<3> trajectory, workspace;
+    std::array<double, 3> new_position, new_velocity, new_acceleration, new_position_workspace;
+
+    for (size_t i = 0; i < 1024; ++i) {
+        p.fill(input.current_position);
+        d.fill(input.current_velocity);
+        d.fill(input.current_acceleration);
+        p.fill(input.target_position);
+        d.fill(input.target_velocity);
+        l.fill(input.max_velocity, input.target_velocity);
+        l.fill(input.max_acceleration);
+        l.fill(input.max_jerk);
+        input.synchronization = (i % 3 == 0) ? Synchronization::Phase : Synchronization::Time;
+        input.duration_discretization = (i % 4 == 0) ? DurationDiscretization::Discrete : DurationDiscretization::Continuous;
+        if (!otg.validate_input(input) || otg.calculate(input, trajectory) != Result::Working) {
+            continue;
+        }
+
+        double duration {-1.0};
+        CHECK( otg.calculate_min_duration(input, workspace, duration) == Result::Working );
+        CHECK( duration == trajectory.get_duration() );
+        CHECK( workspace.get_independent_min_durations() == trajectory.get_independent_min_durations() );
+
+        // The workspace keeps Step 1 for a following calculation of the same input
+        CHECK( otg.calculate(input, workspace) == Result::Working );
+        CHECK( workspace.get_duration() == trajectory.get_duration() );
+        trajectory.at_time(duration * 0.3, new_position, new_velocity, new_acceleration);
+        workspace.at_time(duration * 0.3, new_position_workspace, new_velocity, new_acceleration);
+        check_array(new_position_workspace, new_position);
+
+        // Reachability at the boundary of the duration, with the Step 1 of the workspace and from scratch
+        CHECK( otg.is_reachable_within(input, workspace, duration) );
+        CHECK_FALSE( otg.is_reachable_within(input, workspace, duration * 0.99) );
+        Trajectory<3> fresh;
+        CHECK_FALSE( otg.is_reachable_within(input, fresh, duration * 0.99) );
+        CHECK( otg.is_reachable_within(input, fresh, duration * 1.01) );
+    }
+}
+
+TEST_CASE("deferred-step2" * doctest::description("Deferred Step 2 until First Use")) {
+    Randomizer<3, decltype(position_dist)> p { position_dist, seed };
+    Randomizer<3, decltype(dynamic_dist)> d { dynamic_dist, seed + 1 };
+    Randomizer<3, decltype(limit_dist)> l { limit_dist, seed + 2 };
+
+    WorkerPool pool {1};
+    Ruckig<3, true> otg {0.005};
+    InputParameter<3> input;
+    Trajectory<3> trajectory, deferred;
+    std::array<double, 3> new_position, new_velocity, new_acceleration, new_position_deferred;
+
+    for (size_t i = 0; i < 1024; ++i) {
+        p.fill(input.current_position);
+        d.fill(input.current_velocity);
+        d.fill(input.current_acceleration);
+        p.fill(input.target_position);
+        d.fill(input.target_velocity);
+        l.fill(input.max_velocity, input.target_velocity);
+        l.fill(input.max_acceleration);
+        l.fill(input.max_jerk);
+        input.control_interface = (i % 5 == 0) ? ControlInterface::Velocity : ControlInterface::Position;
+        input.synchronization = (i % 3 == 0) ? Synchronization::Phase : Synchronization::Time;
+        input.per_dof_synchronization = (i % 7 == 0) ? std::optional<std::array<Synchronization, 3>>({Synchronization::Time, Synchronization::None, Synchronization::TimeIfNecessary}) : std::nullopt;
+        if (!otg.validate_input(input) || otg.calculate(input, trajectory) != Result::Working) {
+            continue;
+        }
+
+        CHECK( otg.calculate_deferred(input, deferred) == Result::Working );
+        CHECK( deferred.get_duration() == trajectory.get_duration() );
+        CHECK( deferred.get_independent_min_durations() == trajectory.get_independent_min_durations() );
+
+        // The deferred DoFs don't depend on the input anymore
+        const auto target_position = input.target_position;
+        p.fill(input.target_position);
+        switch (i % 3) {
+            case 0: {
+                for (size_t dof = 0; dof < 3; ++dof) {
+                    CHECK( deferred.resolve_step2(dof) );
+                    CHECK_FALSE( deferred.is_deferred(dof) );
+                }
+            } break;
+            case 1: {
+                CHECK( deferred.resolve_all_step2(&pool) );
+            } break;
+            case 2: {
+                bool was_interrupted {true};
+                CHECK( deferred.resolve_all_step2(was_interrupted, 0.0) );
+                CHECK( was_interrupted == deferred.has_deferred_step2() );
+                CHECK( deferred.resolve_all_step2() );
+            } break;
+        }
+        input.target_position = target_position;
+        CHECK_FALSE( deferred.has_deferred_step2() );
+
+        const double time = trajectory.get_duration() * 0.4;
+        trajectory.at_time(time, new_position, new_velocity, new_acceleration);
+        deferred.at_time(time, new_position_deferred, new_velocity, new_acceleration);
+        check_array(new_position_deferred, new_position);
+    }
+
+    // A new calculation discards the deferred DoFs
+    input.control_interface = ControlInterface::Position;
+    input.synchronization = Synchronization::Time;
+    input.per_dof_synchronization = std::nullopt;
+    input.current_position = {0.0, 0.0, 0.0};
+    input.current_velocity = {0.0, 0.0, 0.0};
+    input.current_acceleration = {0.0, 0.0, 0.0};
+    input.target_position = {1.0, 0.5, -0.2};
+    input.target_velocity = {0.0, 0.0, 0.0};
+    input.max_velocity = {1.0, 1.0, 1.0};
+    input.max_acceleration = {1.0, 1.0, 1.0};
+    input.max_jerk = {1.0, 1.0, 1.0};
+    CHECK( otg.calculate_deferred(input, deferred) == Result::Working );
+    CHECK_FALSE( deferred.is_deferred(0) );
+    CHECK( deferred.is_deferred(1) );
+    CHECK( deferred.is_deferred(2) );
+    CHECK( otg.calculate(input, deferred) == Result::Working );
+    CHECK_FALSE( deferred.has_deferred_step2() );
+}
+
+TEST_CASE("min-duration-matrix" * doctest::description("Minimal Durations from Each Start to Each Target")) {
+    Randomizer<3, decltype(position_dist)> p { position_dist, seed };
+    Randomizer<3, decltype(dynamic_dist)> d { dynamic_dist, seed + 1 };
+    Randomizer<3, decltype(limit_dist)> l { limit_dist, seed + 2 };
+
+    Ruckig<3, true> otg {0.005};
+    Ruckig<0, true> otg_dynamic {3, 0.005};
+    std::vector<InputParameter<3>> starts(17), targets(23);
+    for (auto& start: starts) {
+        p.fill(start.current_position);
+        d.fill(start.current_velocity);
+        d.fill(start.current_acceleration);
+        l.fill(start.max_velocity);
+        l.fill(start.max_acceleration);
+        l.fill(start.max_jerk);
+    }
+    for (auto& target: targets) {
+        p.fill(target.target_position);
+        d.fill(target.target_velocity);
+    }
+    targets[4].target_velocity[0] = 1e3; // Exceeds the velocity limit
+
+    std::vector<double> durations, durations_parallel, durations_dynamic;
+    otg.calculate_min_duration_matrix(starts, targets, durations);
+    otg.calculate_min_duration_matrix(starts, targets, durations_parallel, 4);
+    CHECK( durations.size() == starts.size() * targets.size() );
+    CHECK( durations_parallel == durations );
+
+    std::vector<InputParameter<0>> starts_dynamic, targets_dynamic;
+    for (const auto& start: starts) {
+        starts_dynamic.push_back(InputParameter<0>(3));
+        starts_dynamic.back().current_position = {start.current_position.begin(), start.current_position.end()};
+        starts_dynamic.back().current_velocity = {start.current_velocity.begin(), start.current_velocity.end()};
+        starts_dynamic.back().current_acceleration = {start.current_acceleration.begin(), start.current_acceleration.end()};
+        starts_dynamic.back().max_velocity = {start.max_velocity.begin(), start.max_velocity.end()};
+        starts_dynamic.back().max_acceleration = {start.max_acceleration.begin(), start.max_acceleration.end()};
+        starts_dynamic.back().max_jerk = {start.max_jerk.begin(), start.max_jerk.end()};
+    }
+    for (const auto& target: targets) {
+        targets_dynamic.push_back(InputParameter<0>(3));
+        targets_dynamic.back().target_position = {target.target_position.begin(), target.target_position.end()};
+        targets_dynamic.back().target_velocity = {target.target_velocity.begin(), target.target_velocity.end()};
+    }
+    otg_dynamic.calculate_min_duration_matrix(starts_dynamic, targets_dynamic, durations_dynamic, 2);
+    CHECK( durations_dynamic == durations );
+
+    for (size_t i = 0; i < starts.size(); ++i) {
+        for (size_t j = 0; j < targets.size(); ++j) {
+            InputParameter<3> input = starts[i];
+            input.target_position = targets[j].target_position;
+            input.target_velocity = targets[j].target_velocity;
+
+            Trajectory<3> trajectory;
+            if (!otg.validate_input(input)) {
+                CHECK( std::isinf(durations[i * targets.size() + j]) );
+            } else if (otg.calculate(input, trajectory) == Result::Working) {
+                CHECK( durations[i * targets.size() + j] == trajectory.get_duration() );
+            }
+        }
+    }
+    CHECK( std::isinf(durations[4]) );
+}
+
+TEST_CASE("approximation" * doctest::description("Conservative Approximation of Duration and Positions")) {
+    Randomizer<3, decltype(position_dist)> p { position_dist, seed };
+    Randomizer<3, decltype(dynamic_dist)> d { dynamic_dist, seed + 1 };
+    Randomizer<3, decltype(limit_dist)> l { limit_dist, seed + 2 };
+    Randomizer<3, decltype(min_limit_dist)> lm { min_limit_dist, seed + 3 };
+
+    Ruckig<3> otg {0.005};
+    InputParameter<3> input;
+    Trajectory<3> trajectory;
+    ConservativeApproximation<3> approximation;
+    std::array<double, 3> new_position, new_velocity, new_acceleration;
+
+    for (size_t i = 0; i < 1024; ++i) {
+        p.fill(input.current_position);
+        d.fill(input.current_velocity);
+        d.fill(input.current_acceleration);
+        p.fill(input.target_position);
+        d.fill(input.target_velocity);
+        d.fill(input.target_acceleration);
+        l.fill(input.max_velocity, input.target_velocity);
+        l.fill(input.max_acceleration, input.target_acceleration);
+        l.fill(input.max_jerk);
+        if (i % 2 == 0) {
+            input.min_velocity = input.max_velocity;
+            input.min_acceleration = input.max_acceleration;
+            lm.fill_min(*input.min_velocity, input.target_velocity);
+            lm.fill_min(*input.min_acceleration, input.target_acceleration);
+        } else {
+            input.min_velocity = std::nullopt;
+            input.min_acceleration = std::nullopt;
+        }
+        input.synchronization = (i % 3 == 0) ? Synchronization::Phase : ((i % 7 == 0) ? Synchronization::None : Synchronization::Time);
+        input.duration_discretization = (i % 4 == 0) ? DurationDiscretization::Discrete : DurationDiscretization::Continuous;
+        input.enabled = {true, i % 5 != 0, true};
+        if (!otg.validate_input(input) || otg.calculate(input, trajectory) != Result::Working) {
+            continue;
+        }
+
+        CHECK( otg.calculate_approximation(input, approximation) == Result::Working );
+        CHECK( trajectory.get_duration() <= approximation.duration * (1 + 1e-12) + 1e-12 );
+
+        for (size_t k = 0; k <= 64; ++k) {
+            trajectory.at_time(trajectory.get_duration() * k / 64, new_position, new_velocity, new_acceleration);
+            for (size_t dof = 0; dof < 3; ++dof) {
+                CHECK( new_position[dof] >= approximation.min_position[dof] - 1e-9 );
+                CHECK( new_position[dof] <= approximation.max_position[dof] + 1e-9 );
+            }
+        }
+    }
+
+    input.control_interface = ControlInterface::Velocity;
+    CHECK( otg.calculate_approximation(input, approximation) == Result::ErrorInvalidInput );
+}
+
+TEST_CASE("warm-start" * doctest::description("Warm-started Step 2")) {
+    Ruckig<3, true> otg {0.005}, otg_warm {0.005};
+    InputParameter<3> input, input_warm;
+    OutputParameter<3> output, output_warm;
+
+    input.current_position = {0.0, -2.0, 0.0};
+    input.target_position = {1.0, -3.0, 2.0};
+    input.target_velocity = {0.1, 0.3, 0.0};
+    input.max_velocity = {1.0, 1.0, 1.0};
+    input.max_acceleration = {1.0, 1.0, 1.0};
+    input.max_jerk = {1.0, 1.0, 1.0};
+    input_warm = input;
+    input_warm.warm_start = true;
+
+    std::array<double, 3> new_position, new_velocity, new_acceleration;
+
+    // Stream a slowly moving target
+    for (size_t i = 0; i < 400; ++i) {
+        input.target_position[0] += 0.001;
+        input_warm.target_position[0] += 0.001;
+
+        CHECK( otg.update(input, output) == Result::Working );
+        CHECK( otg_warm.update(input_warm, output_warm) == Result::Working );
+        // Step 2 might find a different profile of the same duration
+        CHECK( output_warm.trajectory.get_duration() == doctest::Approx(output.trajectory.get_duration()) );
+        output_warm.trajectory.at_time(output_warm.trajectory.get_duration(), new_position, new_velocity, new_acceleration);
+        check_array(new_position, input_warm.target_position);
+        check_array(new_velocity, input_warm.target_velocity);
+
+        output.pass_to_input(input);
+        output_warm.pass_to_input(input_warm);
+    }
+}
+
+TEST_CASE("incremental-recalculation" * doctest::description("Recalculation of Changed DoFs Only")) {
+    Randomizer<3, decltype(position_dist)> p { position_dist, seed };
+    Randomizer<3, decltype(dynamic_dist)> d { dynamic_dist, seed + 1 };
+    Randomizer<3, decltype(limit_dist)> l { limit_dist, seed + 2 };
+    std::uniform_real_distribution<double> change_dist {-1.0, 1.0};
+    std::default_random_engine gen(seed + 3);
+
+    Ruckig<3, true> otg {0.005};
+    InputParameter<3> input;
+    Trajectory<3> trajectory, trajectory_fresh;
+    std::array<double, 3> new_position, new_velocity, new_acceleration, new_position_fresh, new_velocity_fresh, new_acceleration_fresh;
+
+    for (size_t i = 0; i < 256; ++i) {
+        p.fill(input.current_position);
+        d.fill(input.current_velocity);
+        d.fill(input.current_acceleration);
+        p.fill(input.target_position);
+        d.fill(input.target_velocity);
+        d.fill(input.target_acceleration);
+        l.fill(input.max_velocity, input.target_velocity);
+        l.fill(input.max_acceleration, input.target_acceleration);
+        l.fill(input.max_jerk);
+
+        if (!otg.validate_input(input) || otg.calculate(input, trajectory) != Result::Working) {
+            continue;
+        }
+
+        // Retarget a single DoF, and change the synchronization from time to time
+        const size_t dof = i % 3;
+        input.target_position[dof] += change_dist(gen);
+        input.synchronization = (i % 5 == 0) ? Synchronization::Phase : Synchronization::Time;
+        if (!otg.validate_input(input)) {
+            continue;
+        }
+
+        const Result result = otg.calculate(input, trajectory);
+        trajectory_fresh = Trajectory<3> {};
+        CHECK( otg.calculate(input, trajectory_fresh) == result );
+        CHECK( trajectory.get_duration() == trajectory_fresh.get_duration() );
+
+        const double time = trajectory.get_duration() * 0.4;
+        trajectory.at_time(time, new_position, new_velocity, new_acceleration);
+        trajectory_fresh.at_time(time, new_position_fresh, new_velocity_fresh, new_acceleration_fresh);
+        CHECK( new_position == new_position_fresh );
+        CHECK( new_velocity == new_velocity_fresh );
+        CHECK( new_acceleration == new_acceleration_fresh );
+    }
+}
+
+TEST_CASE("roots-batch" * doctest::description("Batched Polynomial Root Solvers")) {
+    constexpr size_t n {1023};
+    std::default_random_engine gen(seed);
+    std::uniform_real_distribution<double> coefficient_dist {-4.0, 4.0};
+
+    std::array<std::vector<double>, 4> coefficients;
+    for (auto& c: coefficients) {
+        c.resize(n);
+        std::generate(c.begin(), c.end(), [&]() { return coefficient_dist(gen); });
+    }
+
+    std::vector<Roots::PositiveSet<double, 3>> cubic_roots(n);
+    std::vector<Roots::PositiveSet<double, 4>> quartic_roots(n);
+    Roots::solveCubBatch(coefficients[0].data(), coefficients[1].data(), coefficients[2].data(), coefficients[3].data(), cubic_roots.data(), n);
+    Roots::solveQuartMonicBatch(coefficients[0].data(), coefficients[1].data(), coefficients[2].data(), coefficients[3].data(), quartic_roots.data(), n);
+
+    // Polynomials (x - r) * (x^2 + 1) with a single root in [r - 1, r + 2]
+    std::vector<std::array<double, 4>> polynoms(n);
+    std::vector<double> lower(n), upper(n), roots(n);
+    for (size_t i = 0; i < n; ++i) {
+        const double r = coefficients[0][i];
+        polynoms[i] = {1.0, -r, 1.0, -r};
+        lower[i] = r - 1.0;
+        upper[i] = (i % 16 == 0) ? r : r + 2.0; // Root at the boundary
+    }
+    Roots::shrinkIntervalBatch(polynoms.data(), lower.data(), upper.data(), roots.data(), n);
+
+    for (size_t i = 0; i < n; ++i) {
+        auto cubic_expected = Roots::solveCub(coefficients[0][i], coefficients[1][i], coefficients[2][i], coefficients[3][i]);
+        CHECK( std::vector<double>(cubic_roots[i].begin(), cubic_roots[i].end()) == std::vector<double>(cubic_expected.begin(), cubic_expected.end()) );
+
+        auto quartic_expected = Roots::solveQuartMonic(coefficients[0][i], coefficients[1][i], coefficients[2][i], coefficients[3][i]);
+        CHECK( std::vector<double>(quartic_roots[i].begin(), quartic_roots[i].end()) == std::vector<double>(quartic_expected.begin(), quartic_expected.end()) );
+
+        CHECK( roots[i] == Roots::shrinkInterval(polynoms[i], lower[i], upper[i]) );
+        CHECK( roots[i] == doctest::Approx(coefficients[0][i]) );
+    }
+}
+
+TEST_CASE("root-refinement" * doctest::description("Bounded Root Refinement")) {
+    std::default_random_engine gen(seed);
+    std::uniform_real_distribution<double> root_dist {-4.0, 4.0};
+
+    // Polynomials (x - r) * (x^2 + s) with a single root r
+    std::array<double, 4> errors {0.0, 0.0, 0.0, 0.0};
+    for (size_t i = 0; i < 1024; ++i) {
+        const double r = root_dist(gen);
+        const double s = 0.01 + std::abs(root_dist(gen));
+        const std::array<double, 4> polynom {1.0, -r, s, -r * s};
+
+        errors[0] = std::max(errors[0], std::abs(Roots::shrinkInterval<4, 2>(polynom, r - 1.0, r + 2.0) - r));
+        errors[1] = std::max(errors[1], std::abs(Roots::shrinkInterval<4, 8>(polynom, r - 1.0, r + 2.0) - r));
+        errors[2] = std::max(errors[2], std::abs(Roots::shrinkInterval<4, 16>(polynom, r - 1.0, r + 2.0) - r));
+        errors[3] = std::max(errors[3], std::abs(Roots::shrinkInterval<4>(polynom, r - 1.0, r + 2.0) - r));
+    }
+    CHECK( errors[0] < 3.0 ); // Within the interval
+    CHECK( errors[2] < 1e-12 );
+    CHECK( errors[3] < 1e-12 );
+
+    // The final state of trajectories is within the precision of the profile checks for the configured refinement
+    Randomizer<3, decltype(position_dist)> p { position_dist, seed };
+    Randomizer<3, decltype(dynamic_dist)> d { dynamic_dist, seed + 1 };
+    Randomizer<3, decltype(limit_dist)> l { limit_dist, seed + 2 };
+
+    Ruckig<3, true> otg {0.005};
+    InputParameter<3> input;
+    Trajectory<3> trajectory;
+    std::array<double, 3> new_position, new_velocity, new_acceleration;
+    double max_position_error {0.0}, max_velocity_error {0.0}, max_acceleration_error {0.0};
+    for (size_t i = 0; i < 4096; ++i) {
+        p.fill(input.current_position);
+        d.fill(input.current_velocity);
+        d.fill(input.current_acceleration);
+        p.fill(input.target_position);
+        d.fill(input.target_velocity);
+        d.fill(input.target_acceleration);
+        l.fill(input.max_velocity, input.target_velocity);
+        l.fill(input.max_acceleration, input.target_acceleration);
+        l.fill(input.max_jerk);
+
+        if (!otg.validate_input(input) || otg.calculate(input, trajectory) != Result::Working) {
+            continue;
+        }
+
+        trajectory.at_time(trajectory.get_duration(), new_position, new_velocity, new_acceleration);
+        for (size_t dof = 0; dof < 3; ++dof) {
+            max_position_error = std::max(max_position_error, std::abs(new_position[dof] - input.target_position[dof]));
+            max_velocity_error = std::max(max_velocity_error, std::abs(new_velocity[dof] - input.target_velocity[dof]));
+            max_acceleration_error = std::max(max_acceleration_error, std::abs(new_acceleration[dof] - input.target_acceleration[dof]));
+        }
+    }
+    CHECK( max_position_error < 1e-8 );
+    CHECK( max_velocity_error < 1e-8 );
+    CHECK( max_acceleration_error < 1e-10 );
+}
+
+TEST_CASE("features" * doctest::description("Compile-time Feature Policy")) {
+    Randomizer<3, decltype(position_dist)> p { position_dist, seed };
+    Randomizer<3, decltype(dynamic_dist)> d { dynamic_dist, seed + 1 };
+    Randomizer<3, decltype(limit_dist)> l { limit_dist, seed + 2 };
+
+    Ruckig<3, true> otg {0.005};
+    Ruckig<3, true, true, 0, Instrumentation::Duration, Features::Minimal> otg_minimal {0.005};
+    Ruckig<3, true, true, 0, Instrumentation::Duration, Features::Symmetric | Features::TimeSyncOnly> otg_symmetric {0.005};
+    InputParameter<3> input;
+    Trajectory<3> trajectory, trajectory_minimal, trajectory_symmetric;
+
+    for (size_t i = 0; i < 256; ++i) {
+        p.fill(input.current_position);
+        d.fill(input.current_velocity);
+        d.fill(input.current_acceleration);
+        p.fill(input.target_position);
+        d.fill(input.target_velocity);
+        d.fill(input.target_acceleration);
+        l.fill(input.max_velocity, input.target_velocity);
+        l.fill(input.max_acceleration, input.target_acceleration);
+        l.fill(input.max_jerk);
+
+        if (!otg.validate_input(input)) {
+            continue;
+        }
+
+        CHECK( otg_minimal.validate_input(input) );
+        const Result result = otg.calculate(input, trajectory);
+        CHECK( otg_minimal.calculate(input, trajectory_minimal) == result );
+        CHECK( otg_symmetric.calculate(input, trajectory_symmetric) == result );
+        CHECK( trajectory_minimal.get_duration() == trajectory.get_duration() );
+        CHECK( trajectory_symmetric.get_duration() == trajectory.get_duration() );
+    }
+
+    // Inputs with removed features are invalid
+    input.min_velocity = {-1.0, -1.0, -1.0};
+    CHECK_FALSE( otg_minimal.validate_input(input) );
+    CHECK_FALSE( otg_symmetric.validate_input(input) );
+
+    input.min_velocity = std::nullopt;
+    input.synchronization = Synchronization::Phase;
+    CHECK_FALSE( otg_symmetric.validate_input(input) );
+
+    input.synchronization = Synchronization::Time;
+    input.enabled = {true, false, true};
+    CHECK_FALSE( otg_minimal.validate_input(input) );
+    CHECK( otg_symmetric.validate_input(input) );
+}
+
+TEST_CASE("worker-pool" * doctest::description("Parallel Calculation of the DoFs")) {
+    constexpr size_t dofs {12};
+    Randomizer<0, decltype(position_dist)> p { position_dist, seed };
+    Randomizer<0, decltype(dynamic_dist)> d { dynamic_dist, seed + 1 };
+    Randomizer<0, decltype(limit_dist)> l { limit_dist, seed + 2 };
+
+    WorkerPool pool {3};
+    CHECK( pool.number_threads() == 4 );
+
+    Ruckig<0, true> otg {dofs, 0.005}, otg_parallel {dofs, 0.005};
+    otg_parallel.worker_pool = &pool;
+
+    InputParameter<0> input {dofs};
+    Trajectory<0> trajectory {dofs}, trajectory_parallel {dofs};
+    std::vector<double> new_position(dofs), new_velocity(dofs), new_acceleration(dofs), new_position_parallel(dofs), new_velocity_parallel(dofs), new_acceleration_parallel(dofs);
+
+    for (size_t i = 0; i < 256; ++i) {
+        p.fill(input.current_position);
+        d.fill(input.current_velocity);
+        d.fill(input.current_acceleration);
+        p.fill(input.target_position);
+        d.fill(input.target_velocity);
+        d.fill(input.target_acceleration);
+        l.fill(input.max_velocity, input.target_velocity);
+        l.fill(input.max_acceleration, input.target_acceleration);
+        l.fill(input.max_jerk);
+        input.synchronization = (i % 4 == 0) ? Synchronization::Phase : Synchronization::Time;
+
+        if (!otg.validate_input(input)) {
+            continue;
+        }
+
+        CHECK( otg_parallel.calculate(input, trajectory_parallel) == otg.calculate(input, trajectory) );
+        CHECK( trajectory_parallel.get_duration() == trajectory.get_duration() );
+
+        const double time = trajectory.get_duration() * 0.6;
+        trajectory.at_time(time, new_position, new_velocity, new_acceleration);
+        trajectory_parallel.at_time(time, new_position_parallel, new_velocity_parallel, new_acceleration_parallel);
+        CHECK( new_position_parallel == new_position );
+        CHECK( new_velocity_parallel == new_velocity );
+        CHECK( new_acceleration_parallel == new_acceleration );
+    }
+}
+
+TEST_CASE("speculative-candidates" * doctest::description("Speculative Step 2 of the Following Synchronization Candidates")) {
+    constexpr size_t DOFs {6};
+    Randomizer<DOFs, decltype(position_dist)> p { position_dist, seed };
+    Randomizer<DOFs, decltype(dynamic_dist)> d { dynamic_dist, seed + 1 };
+    Randomizer<DOFs, decltype(limit_dist)> l { limit_dist, seed + 2 };
+
+    WorkerPool pool {3};
+    Ruckig<DOFs, true> otg {0.005}, otg_sequential {0.005}, otg_parallel {0.005};
+    otg_parallel.worker_pool = &pool;
+
+    InputParameter<DOFs> input, input_speculative;
+    Trajectory<DOFs> trajectory, trajectory_sequential, trajectory_parallel;
+    std::array<double, DOFs> new_position, new_velocity, new_acceleration, new_position_parallel, new_velocity_parallel, new_acceleration_parallel;
+
+    // The following candidates are only used if Step 2 fails for the first one, so the trajectories are the same
+    for (size_t i = 0; i < 256; ++i) {
+        p.fill(input.current_position);
+        d.fill(input.current_velocity);
+        d.fill(input.current_acceleration);
+        p.fill(input.target_position);
+        d.fill(input.target_velocity);
+        d.fill(input.target_acceleration);
+        l.fill(input.max_velocity, input.target_velocity);
+        l.fill(input.max_acceleration, input.target_acceleration);
+        l.fill(input.max_jerk);
+        input.duration_discretization = (i % 4 == 0) ? DurationDiscretization::Discrete : DurationDiscretization::Continuous;
+
+        if (!otg.validate_input(input)) {
+            continue;
+        }
+
+        input_speculative = input;
+        input_speculative.speculative_candidates = 4;
+        const Result result = otg.calculate(input, trajectory);
+        CHECK( otg_sequential.calculate(input_speculative, trajectory_sequential) == result );
+        CHECK( otg_parallel.calculate(input_speculative, trajectory_parallel) == result );
+        CHECK( trajectory_sequential.get_duration() == trajectory.get_duration() );
+        CHECK( trajectory_parallel.get_duration() == trajectory.get_duration() );
+
+        const double time = trajectory.get_duration() * 0.6;
+        trajectory.at_time(time, new_position, new_velocity, new_acceleration);
+        trajectory_parallel.at_time(time, new_position_parallel, new_velocity_parallel, new_acceleration_parallel);
+        CHECK( new_position_parallel == new_position );
+        CHECK( new_velocity_parallel == new_velocity );
+        CHECK( new_acceleration_parallel == new_acceleration );
+    }
+}
+
+TEST_CASE("interrupted-calculation" * doctest::description("Soft Interruption of the Calculation")) {
+    constexpr size_t dofs {6};
+    Randomizer<0, decltype(position_dist)> p { position_dist, seed };
+    Randomizer<0, decltype(dynamic_dist)> d { dynamic_dist, seed + 1 };
+    Randomizer<0, decltype(limit_dist)> l { limit_dist, seed + 2 };
+
+    Ruckig<0, true> otg {dofs, 0.005};
+    InputParameter<0> input {dofs};
+    Trajectory<0> trajectory {dofs}, trajectory_interrupted {dofs};
+    std::vector<double> new_position(dofs), new_velocity(dofs), new_acceleration(dofs), new_position_interrupted(dofs), new_velocity_interrupted(dofs), new_acceleration_interrupted(dofs);
+
+    for (size_t i = 0; i < 256; ++i) {
+        p.fill(input.current_position);
+        d.fill(input.current_velocity);
+        d.fill(input.current_acceleration);
+        p.fill(input.target_position);
+        d.fill(input.target_velocity);
+        d.fill(input.target_acceleration);
+        l.fill(input.max_velocity, input.target_velocity);
+        l.fill(input.max_acceleration, input.target_acceleration);
+        l.fill(input.max_jerk);
+        input.synchronization = (i % 4 == 0) ? Synchronization::Phase : Synchronization::Time;
+
+        if (!otg.validate_input(input)) {
+            continue;
+        }
+
+        input.interrupt_calculation_duration = std::nullopt;
+        const Result result = otg.calculate(input, trajectory);
+
+        // Interrupt the calculation after every DoF and synchronization candidate
+        input.interrupt_calculation_duration = 0.0;
+        bool was_interrupted {false};
+        Result result_interrupted = otg.calculate(input, trajectory_interrupted, was_interrupted);
+        size_t calls {1};
+        while (result_interrupted == Result::Working && was_interrupted) {
+            CHECK( trajectory_interrupted.is_calculation_interrupted() );
+            result_interrupted = otg.continue_calculation(input, trajectory_interrupted, was_interrupted);
+            ++calls;
+        }
+
+        CHECK( calls > 1 );
+        CHECK( !trajectory_interrupted.is_calculation_interrupted() );
+        CHECK( result_interrupted == result );
+        CHECK( trajectory_interrupted.get_duration() == trajectory.get_duration() );
+
+        const double time = trajectory.get_duration() * 0.6;
+        trajectory.at_time(time, new_position, new_velocity, new_acceleration);
+        trajectory_interrupted.at_time(time, new_position_interrupted, new_velocity_interrupted, new_acceleration_interrupted);
+        CHECK( new_position_interrupted == new_position );
+        CHECK( new_velocity_interrupted == new_velocity );
+        CHECK( new_acceleration_interrupted == new_acceleration );
+    }
+
+    // The update keeps following the previous trajectory until the interrupted calculation is finished
+    Ruckig<3, true> otg_update {0.005};
+    InputParameter<3> input_update;
+    OutputParameter<3> output;
+
+    input_update.current_position = {0.0, -2.0, 0.0};
+    input_update.target_position = {1.0, -3.0, 2.0};
+    input_update.max_velocity = {1.0, 1.0, 1.0};
+    input_update.max_acceleration = {1.0, 1.0, 1.0};
+    input_update.max_jerk = {1.0, 1.0, 1.0};
+    input_update.interrupt_calculation_duration = 0.0;
+
+    CHECK( otg_update.update(input_update, output) == Result::Working );
+    CHECK( output.new_calculation );
+    CHECK( !output.was_calculation_interrupted );
+    output.pass_to_input(input_update);
+
+    size_t interrupted_cycles {0}, swap_cycle {0};
+    Result result {Result::Working};
+    for (size_t i = 1; i < 4000 && result == Result::Working; ++i) {
+        if (i == 200) {
+            input_update.target_position = {-1.0, -1.0, 1.0};
+        }
+
+        const double old_duration = output.trajectory.get_duration();
+        result = otg_update.update(input_update, output);
+        if (output.was_calculation_interrupted) {
+            CHECK( output.trajectory.get_duration() == old_duration );
+            ++interrupted_cycles;
+        }
+        if (output.new_calculation) {
+            swap_cycle = i;
+        }
+        output.pass_to_input(input_update);
+    }
+
+    CHECK( result == Result::Finished );
+    CHECK( interrupted_cycles > 0 );
+    CHECK( swap_cycle == 200 + interrupted_cycles );
+    check_array(output.new_position, input_update.target_position);
+}
+
+TEST_CASE("trajectory-mailbox" * doctest::description("Triple-buffered Trajectory Handoff")) {
+    Ruckig<1, true> otg;
+    InputParameter<1> input;
+    input.max_velocity = {1.0};
+    input.max_acceleration = {1.0};
+    input.max_jerk = {1.0};
+
+    TrajectoryMailbox<1> mailbox;
+    CHECK( !mailbox.has_new() );
+    CHECK( !mailbox.receive() );
+
+    input.target_position = {1.0};
+    CHECK( otg.calculate(input, mailbox.back()) == Result::Working );
+    mailbox.publish(0.5);
+    input.target_position = {2.0};
+    CHECK( otg.calculate(input, mailbox.back()) == Result::Working );
+    mailbox.publish(0.75);
+
+    // Only the latest trajectory is adopted
+    CHECK( mailbox.receive() );
+    CHECK( mailbox.front_time_offset() == 0.75 );
+    CHECK( mailbox.front().get_duration() > 0.0 );
+    CHECK( !mailbox.receive() );
+
+    // The consumer always sees a consistent pair of trajectory and time offset
+    constexpr size_t number_trajectories {2000};
+    std::thread producer([&otg, input, &mailbox]() mutable {
+        for (size_t i = 1; i <= number_trajectories; ++i) {
+            input.target_position = {static_cast<double>(i)};
+            otg.calculate(input, mailbox.back());
+            mailbox.publish(static_cast<double>(i));
+        }
+    });
+
+    double last_offset {0.0};
+    std::array<double, 1> new_position, new_velocity, new_acceleration;
+    while (last_offset < number_trajectories) {
+        if (!mailbox.receive()) {
+            std::this_thread::yield();
+            continue;
+        }
+
+        const auto& trajectory = mailbox.front();
+        trajectory.at_time(trajectory.get_duration(), new_position, new_velocity, new_acceleration);
+        CHECK( new_position[0] == doctest::Approx(mailbox.front_time_offset()) );
+        CHECK( mailbox.front_time_offset() > last_offset );
+        last_offset = mailbox.front_time_offset();
+    }
+    producer.join();
+}
+
+TEST_CASE("batch-ruckig" * doctest::description("Stepping Many Instances Together")) {
+    constexpr size_t number_instances {64};
+    Randomizer<3, decltype(position_dist)> p { position_dist, seed };
+    Randomizer<3, decltype(dynamic_dist)> d { dynamic_dist, seed + 1 };
+    Randomizer<3, decltype(limit_dist)> l { limit_dist, seed + 2 };
+
+    WorkerPool pool {2};
+    BatchRuckig<3> batch {number_instances, 0.005};
+    batch.worker_pool = &pool;
+    CHECK( batch.size() == number_instances );
+
+    std::vector<Ruckig<3>> otgs(number_instances, Ruckig<3> {0.005});
+    std::vector<InputParameter<3>> inputs(number_instances);
+    std::vector<OutputParameter<3>> outputs(number_instances);
+    std::vector<Result> results(number_instances);
+
+    auto randomize_target = [&](InputParameter<3>& input) {
+        p.fill(input.target_position);
+        d.fill(input.target_velocity);
+        l.fill(input.max_velocity, input.target_velocity);
+        l.fill(input.max_acceleration);
+        l.fill(input.max_jerk);
+    };
+
+    for (auto& input: inputs) {
+        p.fill(input.current_position);
+        d.fill(input.current_velocity);
+        randomize_target(input);
+    }
+
+    for (size_t cycle = 0; cycle < 400; ++cycle) {
+        // Change the targets of a few instances
+        if (cycle % 50 == 25) {
+            for (size_t i = cycle % 7; i < number_instances; i += 7) {
+                randomize_target(inputs[i]);
+            }
+        }
+
+        auto batch_inputs = inputs;
+        for (size_t i = 0; i < number_instances; ++i) {
+            results[i] = otgs[i].update(inputs[i], outputs[i]);
+        }
+        batch.update_all(batch_inputs);
+
+        for (size_t i = 0; i < number_instances; ++i) {
+            CHECK( batch.results[i] == results[i] );
+            CHECK( static_cast<bool>(batch.new_calculations[i]) == outputs[i].new_calculation );
+            CHECK( batch.times[i] == doctest::Approx(outputs[i].time) );
+            for (size_t dof = 0; dof < 3; ++dof) {
+                CHECK( batch.new_positions[dof * number_instances + i] == doctest::Approx(outputs[i].new_position[dof]) );
+                CHECK( batch.new_velocities[dof * number_instances + i] == doctest::Approx(outputs[i].new_velocity[dof]) );
+                CHECK( batch.new_accelerations[dof * number_instances + i] == doctest::Approx(outputs[i].new_acceleration[dof]) );
+            }
+
+            outputs[i].pass_to_input(inputs[i]);
+        }
+    }
+}
+
+TEST_CASE("candidate-batch" * doctest::description("Minimal Durations of Many Candidates")) {
+    constexpr size_t number_candidates {1000};
+    Randomizer<3, decltype(position_dist)> p { position_dist, seed };
+    Randomizer<3, decltype(dynamic_dist)> d { dynamic_dist, seed + 1 };
+    Randomizer<3, decltype(limit_dist)> l { limit_dist, seed + 2 };
+
+    WorkerPool pool {3};
+    CandidateBatch<3> batch {number_candidates};
+    CandidateBatch<DynamicDOFs> dynamic_batch {number_candidates, 3};
+    batch.worker_pool = &pool;
+    CHECK( batch.size() == number_candidates );
+
+    Ruckig<3> otg;
+    std::vector<InputParameter<3>> inputs(number_candidates);
+    for (size_t candidate = 0; candidate < number_candidates; ++candidate) {
+        auto& input = inputs[candidate];
+        p.fill(input.current_position);
+        d.fill_or_zero(input.current_velocity, 0.9);
+        d.fill_or_zero(input.current_acceleration, 0.8);
+        p.fill(input.target_position);
+        d.fill_or_zero(input.target_velocity, 0.7);
+        l.fill(input.max_velocity, input.target_velocity);
+        l.fill(input.max_acceleration);
+        l.fill(input.max_jerk);
+        if (candidate % 100 == 7) {
+            input.max_jerk[1] = 0.0;
+        }
+
+        for (size_t dof = 0; dof < 3; ++dof) {
+            const size_t i = dof * number_candidates + candidate;
+            batch.current_positions[i] = input.current_position[dof];
+            batch.current_velocities[i] = input.current_velocity[dof];
+            batch.current_accelerations[i] = input.current_acceleration[dof];
+            batch.target_positions[i] = input.target_position[dof];
+            batch.target_velocities[i] = input.target_velocity[dof];
+            batch.target_accelerations[i] = input.target_acceleration[dof];
+            batch.max_velocities[i] = input.max_velocity[dof];
+            batch.max_accelerations[i] = input.max_acceleration[dof];
+            batch.max_jerks[i] = input.max_jerk[dof];
+        }
+    }
+
+    dynamic_batch.current_positions = batch.current_positions;
+    dynamic_batch.current_velocities = batch.current_velocities;
+    dynamic_batch.current_accelerations = batch.current_accelerations;
+    dynamic_batch.target_positions = batch.target_positions;
+    dynamic_batch.target_velocities = batch.target_velocities;
+    dynamic_batch.target_accelerations = batch.target_accelerations;
+    dynamic_batch.max_velocities = batch.max_velocities;
+    dynamic_batch.max_accelerations = batch.max_accelerations;
+    dynamic_batch.max_jerks = batch.max_jerks;
+
+    batch.evaluate();
+    dynamic_batch.evaluate();
+
+    Trajectory<3> trajectory, chosen;
+    for (size_t candidate = 0; candidate < number_candidates; ++candidate) {
+        const Result result = otg.calculate(inputs[candidate], trajectory);
+        CHECK( batch.results[candidate] == result );
+        CHECK( dynamic_batch.results[candidate] == result );
+        if (result != Result::Working) {
+            CHECK( std::isinf(batch.durations[candidate]) );
+            continue;
+        }
+
+        CHECK( batch.durations[candidate] == doctest::Approx(trajectory.get_duration()) );
+        CHECK( dynamic_batch.durations[candidate] == batch.durations[candidate] );
+    }
+    CHECK( batch.results[7] == Result::ErrorInvalidInput );
 
-    OutputParameter<DOFs> output_comparison;
-    auto result_comparison = otg_comparison.update(input, output_comparison);
-    CHECK( output.trajectory.get_duration() <= doctest::Approx(output_comparison.trajectory.get_duration()) );
+    // Exact trajectory of the fastest candidate
+    const size_t fastest = std::distance(batch.durations.begin(), std::min_element(batch.durations.begin(), batch.durations.end()));
+    CHECK( batch.calculate(fastest, chosen) == Result::Working );
+    CHECK( chosen.get_duration() == doctest::Approx(batch.durations[fastest]) );
 }
 
+TEST_CASE("c-api" * doctest::description("Flat C Interface with Batches")) {
+    constexpr size_t number_inputs {32};
+    Randomizer<3, decltype(position_dist)> p { position_dist, seed };
+    Randomizer<3, decltype(dynamic_dist)> d { dynamic_dist, seed + 1 };
+    Randomizer<3, decltype(limit_dist)> l { limit_dist, seed + 2 };
 
-int seed {42};
-size_t number_trajectories {150000}; // Some user variable you want to be able to set
-size_t random_1, random_3, random_3_high, step_through_3, random_discrete_3, random_direction_3, comparison_1, comparison_3, velocity_random_3;
+    Ruckig<3> otg {0.005};
+    std::vector<InputParameter<3>> inputs(number_inputs);
+    std::vector<double> current_position, current_velocity, target_position, target_velocity, max_velocity, max_acceleration, max_jerk;
+    for (auto& input: inputs) {
+        p.fill(input.current_position);
+        d.fill(input.current_velocity);
+        p.fill(input.target_position);
+        d.fill(input.target_velocity);
+        l.fill(input.max_velocity, input.target_velocity);
+        l.fill(input.max_acceleration);
+        l.fill(input.max_jerk);
 
-std::normal_distribution<double> position_dist {0.0, 4.0};
-std::normal_distribution<double> dynamic_dist {0.0, 0.8};
-std::uniform_real_distribution<double> limit_dist {0.08, 16.0};
-std::uniform_real_distribution<double> limit_dist_high {10.0, 1000000.0};
-// std::uniform_real_distribution<double> limit_dist {800.0, 160000.0};
-std::uniform_real_distribution<double> min_limit_dist {-16.0, -0.08};
+        current_position.insert(current_position.end(), input.current_position.begin(), input.current_position.end());
+        current_velocity.insert(current_velocity.end(), input.current_velocity.begin(), input.current_velocity.end());
+        target_position.insert(target_position.end(), input.target_position.begin(), input.target_position.end());
+        target_velocity.insert(target_velocity.end(), input.target_velocity.begin(), input.target_velocity.end());
+        max_velocity.insert(max_velocity.end(), input.max_velocity.begin(), input.max_velocity.end());
+        max_acceleration.insert(max_acceleration.end(), input.max_acceleration.begin(), input.max_acceleration.end());
+        max_jerk.insert(max_jerk.end(), input.max_jerk.begin(), input.max_jerk.end());
+    }
+    inputs[5].max_jerk[1] = -1.0;
+    max_jerk[5 * 3 + 1] = -1.0;
+
+    RuckigInputArrays arrays {};
+    arrays.current_position = current_position.data();
+    arrays.current_velocity = current_velocity.data();
+    arrays.target_position = target_position.data();
+    arrays.target_velocity = target_velocity.data();
+    arrays.max_velocity = max_velocity.data();
+    arrays.max_acceleration = max_acceleration.data();
+    arrays.max_jerk = max_jerk.data();
+    arrays.limits_stride = 3;
+    arrays.control_interface = RUCKIG_CONTROL_POSITION;
+
+    RuckigGenerator* generator = ruckig_create(3, 0.005);
+    RuckigTrajectories* trajectories = ruckig_trajectories_create(generator);
+    REQUIRE( generator != nullptr );
+    REQUIRE( trajectories != nullptr );
+    CHECK( ruckig_degrees_of_freedom(generator) == 3 );
+
+    std::vector<int> results(number_inputs);
+    std::vector<double> durations(number_inputs);
+    ruckig_calculate_batch(generator, &arrays, number_inputs, trajectories, results.data(), durations.data(), 2);
+    CHECK( ruckig_trajectories_size(trajectories) == number_inputs );
+
+    const std::vector<double> times {0.0, 0.1, 0.5, 1.0, 4.0};
+    std::vector<double> positions(number_inputs * times.size() * 3), velocities(positions.size()), accelerations(positions.size());
+    ruckig_sample_batch(trajectories, times.data(), times.size(), positions.data(), velocities.data(), accelerations.data());
+
+    Trajectory<3> trajectory;
+    std::array<double, 3> new_position, new_velocity, new_acceleration;
+    for (size_t k = 0; k < number_inputs; ++k) {
+        const Result result = otg.calculate(inputs[k], trajectory);
+        CHECK( results[k] == result );
+        if (result != Result::Working) {
+            continue;
+        }
+
+        CHECK( durations[k] == doctest::Approx(trajectory.get_duration()) );
+        for (size_t i = 0; i < times.size(); ++i) {
+            trajectory.at_time(times[i], new_position, new_velocity, new_acceleration);
+            for (size_t dof = 0; dof < 3; ++dof) {
+                const size_t offset = (k * times.size() + i) * 3 + dof;
+                CHECK( positions[offset] == doctest::Approx(new_position[dof]) );
+                CHECK( velocities[offset] == doctest::Approx(new_velocity[dof]) );
+                CHECK( accelerations[offset] == doctest::Approx(new_acceleration[dof]) );
+            }
+        }
+    }
+    CHECK( results[5] == RUCKIG_ERROR_INVALID_INPUT );
 
+    // Online update with shared limits, passing the new state back as current state
+    arrays.limits_stride = 0;
+    InputParameter<3> input = inputs[0];
+    OutputParameter<3> output;
+    std::array<double, 3> c_position, c_velocity, c_acceleration;
+    for (size_t cycle = 0; cycle < 100; ++cycle) {
+        const Result result = otg.update(input, output);
+        CHECK( ruckig_update(generator, &arrays, c_position.data(), c_velocity.data(), c_acceleration.data()) == result );
+        for (size_t dof = 0; dof < 3; ++dof) {
+            CHECK( c_position[dof] == doctest::Approx(output.new_position[dof]) );
+            CHECK( c_velocity[dof] == doctest::Approx(output.new_velocity[dof]) );
+        }
 
-template<class T>
-void check_array(const T& first, const T& second) {
-    for (size_t dof = 0; dof < first.size(); ++dof) {
-        CHECK( first[dof] == doctest::Approx(second[dof]) );
+        output.pass_to_input(input);
+        std::copy(c_position.begin(), c_position.end(), current_position.begin());
+        std::copy(c_velocity.begin(), c_velocity.end(), current_velocity.begin());
+        arrays.current_acceleration = c_acceleration.data();
     }
-}
 
+    ruckig_trajectories_destroy(trajectories);
+    ruckig_destroy(generator);
+    CHECK( ruckig_create(0, 0.005) == nullptr );
+}
 
-TEST_CASE("secondary" * doctest::description("Secondary Features")) {
-    Ruckig<3, true> otg {0.005};
+TEST_CASE("concurrent-queries" * doctest::description("Concurrent Queries of a Shared Trajectory")) {
+    Ruckig<3, true> otg;
     InputParameter<3> input;
-    OutputParameter<3> output;
-
     input.current_position = {0.0, -2.0, 0.0};
-    input.current_velocity = {0.0, 0.0, 0.0};
-    input.current_acceleration = {0.0, 0.0, 0.0};
     input.target_position = {1.0, -3.0, 2.0};
-    input.target_velocity = {0.0, 0.3, 0.0};
-    input.target_acceleration = {0.0, 0.0, 0.0};
     input.max_velocity = {1.0, 1.0, 1.0};
     input.max_acceleration = {1.0, 1.0, 1.0};
     input.max_jerk = {1.0, 1.0, 1.0};
 
-    Trajectory<3> traj;
-    auto result = otg.calculate(input, traj);
-
-    CHECK( result == Result::Working );
-    CHECK( traj.get_duration() == doctest::Approx(4.0) );
-
-    result = otg.update(input, output);
+    Trajectory<3> trajectory;
+    CHECK( otg.calculate(input, trajectory) == Result::Working );
 
-    CHECK( result == Result::Working );
-    CHECK( output.trajectory.get_duration() == doctest::Approx(4.0) );
+    const Trajectory<3>& shared_trajectory = trajectory;
+    std::array<std::array<PositionExtrema, 3>, 4> thread_extrema;
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < thread_extrema.size(); ++t) {
+        threads.emplace_back([&shared_trajectory, &thread_extrema, t]() {
+            thread_extrema[t] = shared_trajectory.get_position_extrema();
+        });
+    }
+    for (auto& thread: threads) {
+        thread.join();
+    }
 
-    std::array<double, 3> new_position, new_velocity, new_acceleration;
-    output.trajectory.at_time(0.0, new_position, new_velocity, new_acceleration);
-    check_array(new_position, input.current_position);
-    check_array(new_velocity, input.current_velocity);
-    check_array(new_acceleration, input.current_acceleration);
+    Trajectory<3> reference_trajectory;
+    CHECK( otg.calculate(input, reference_trajectory) == Result::Working );
+    const auto reference_extrema = reference_trajectory.get_position_extrema();
+    for (const auto& extrema: thread_extrema) {
+        for (size_t dof = 0; dof < 3; ++dof) {
+            CHECK( extrema[dof].min == reference_extrema[dof].min );
+            CHECK( extrema[dof].max == reference_extrema[dof].max );
+            CHECK( extrema[dof].t_min == reference_extrema[dof].t_min );
+            CHECK( extrema[dof].t_max == reference_extrema[dof].t_max );
+        }
+    }
+    CHECK( reference_extrema[1].min == doctest::Approx(-3.0) );
+    CHECK( reference_extrema[2].max == doctest::Approx(2.0) );
+
+    // The extrema are recalculated for a new trajectory, and copied along with it
+    input.target_position = {1.0, -1.0, 2.0};
+    otg.precalculate_position_extrema = true;
+    CHECK( otg.calculate(input, trajectory) == Result::Working );
+    const Trajectory<3> copied_trajectory = trajectory;
+    CHECK( copied_trajectory.get_position_extrema()[1].max == doctest::Approx(-1.0) );
+    CHECK( trajectory.get_position_extrema()[1].min == doctest::Approx(-2.0) );
+}
 
-    output.trajectory.at_time(output.trajectory.get_duration(), new_position, new_velocity, new_acceleration);
-    check_array(new_position, input.target_position);
-    check_array(new_velocity, input.target_velocity);
-    check_array(new_acceleration, input.target_acceleration);
+TEST_CASE("serialization" * doctest::description("Binary Trajectory Serialization")) {
+    constexpr size_t dofs {3};
+    Randomizer<dofs, decltype(position_dist)> p { position_dist, seed };
+    Randomizer<dofs, decltype(dynamic_dist)> d { dynamic_dist, seed + 1 };
+    Randomizer<dofs, decltype(limit_dist)> l { limit_dist, seed + 2 };
+
+    Ruckig<dofs, true> otg;
+    InputParameter<dofs> input;
+    Trajectory<dofs> trajectory, loaded_trajectory;
+    std::array<double, dofs> new_position, new_velocity, new_acceleration, view_position, view_velocity, view_acceleration;
+
+    // Archive of concatenated trajectories
+    std::vector<uint8_t> archive;
+    std::vector<Trajectory<dofs>> trajectories;
+    for (size_t i = 0; i < 64; ++i) {
+        p.fill(input.current_position);
+        d.fill(input.current_velocity);
+        d.fill(input.current_acceleration);
+        p.fill(input.target_position);
+        d.fill(input.target_velocity);
+        l.fill(input.max_velocity, input.target_velocity);
+        l.fill(input.max_acceleration);
+        l.fill(input.max_jerk);
 
-    size_t new_section;
-    output.trajectory.at_time(2.0, new_position, new_velocity, new_acceleration, new_section);
-    check_array(new_position, {0.5, -2.6871268303, 1.0});
-    CHECK( new_section == 0 );
+        if (!otg.validate_input(input) || otg.calculate(input, trajectory) != Result::Working) {
+            continue;
+        }
 
-    output.trajectory.at_time(5.0, new_position, new_velocity, new_acceleration, new_section);
-    CHECK( new_section == 1 );
+        TrajectorySerialization::write(trajectory, archive);
+        trajectories.push_back(trajectory);
+    }
+    CHECK( archive.size() == trajectories.size() * TrajectorySerialization::size(dofs) );
+
+    size_t offset {0};
+    for (const auto& original: trajectories) {
+        const TrajectoryView view {archive.data() + offset, archive.size() - offset};
+        REQUIRE( view.is_valid() );
+        CHECK( view.degrees_of_freedom() == dofs );
+        CHECK( view.get_duration() == original.get_duration() );
+
+        CHECK( TrajectorySerialization::read(archive.data() + offset, archive.size() - offset, loaded_trajectory) );
+        CHECK( loaded_trajectory.get_duration() == original.get_duration() );
+        CHECK( loaded_trajectory.get_position_extrema()[0].max == original.get_position_extrema()[0].max );
+
+        for (const double time: {0.0, 0.01, 0.3 * original.get_duration(), 0.7 * original.get_duration(), original.get_duration(), original.get_duration() + 0.5}) {
+            original.at_time(time, new_position, new_velocity, new_acceleration);
+            view.at_time(time, view_position, view_velocity, view_acceleration);
+            CHECK( view_position == new_position );
+            CHECK( view_velocity == new_velocity );
+            CHECK( view_acceleration == new_acceleration );
+
+            loaded_trajectory.at_time(time, view_position, view_velocity, view_acceleration);
+            CHECK( view_position == new_position );
+        }
+        offset += view.size();
+    }
 
-    auto independent_min_durations = output.trajectory.get_independent_min_durations();
-    CHECK( independent_min_durations[0] == doctest::Approx(3.1748021039) );
-    CHECK( independent_min_durations[1] == doctest::Approx(3.6860977315) );
-    CHECK( independent_min_durations[2] == doctest::Approx(output.trajectory.get_duration()) );
+    // Invalid data is rejected
+    archive[0] = 'X';
+    CHECK_FALSE( TrajectoryView(archive.data(), archive.size()).is_valid() );
+    CHECK_FALSE( TrajectorySerialization::read(archive.data(), archive.size(), loaded_trajectory) );
+    CHECK_FALSE( TrajectoryView(archive.data() + TrajectorySerialization::size(dofs), 10).is_valid() );
 
-    auto position_extrema = output.trajectory.get_position_extrema();
-    CHECK( position_extrema[0].t_max == doctest::Approx(4.0) );
-    CHECK( position_extrema[0].max == doctest::Approx(1.0) );
-    CHECK( position_extrema[0].t_min == doctest::Approx(0.0) );
-    CHECK( position_extrema[0].min == doctest::Approx(0.0) );
+    Trajectory<0> dynamic_trajectory {2};
+    CHECK_FALSE( TrajectorySerialization::read(archive.data() + TrajectorySerialization::size(dofs), archive.size(), dynamic_trajectory) );
+}
 
-    CHECK( position_extrema[1].t_max == doctest::Approx(0.0) );
-    CHECK( position_extrema[1].max == doctest::Approx(-2.0) );
-    CHECK( position_extrema[1].t_min == doctest::Approx(3.2254033308) );
-    CHECK( position_extrema[1].min == doctest::Approx(-3.1549193338) );
+TEST_CASE("compact-trajectory" * doctest::description("Compact Storage of Profiles")) {
+    constexpr size_t dofs {3};
+    Randomizer<dofs, decltype(position_dist)> p { position_dist, seed };
+    Randomizer<dofs, decltype(dynamic_dist)> d { dynamic_dist, seed + 1 };
+    Randomizer<dofs, decltype(limit_dist)> l { limit_dist, seed + 2 };
+
+    Ruckig<dofs, true> otg;
+    InputParameter<dofs> input;
+    Trajectory<dofs> trajectory, restored_trajectory;
+    ExecutableTrajectory<dofs> restored_float;
+    CompactTrajectory<dofs> compact;
+    CompactTrajectory<dofs, 0, float> compact_float;
+    std::array<double, dofs> position, velocity, acceleration, new_position, new_velocity, new_acceleration;
+
+    CHECK( 2 * CompactTrajectory<dofs>::bytes_per_dof < sizeof(Profile) );
+    CHECK( 2 * CompactTrajectory<dofs, 0, float>::bytes_per_dof == CompactTrajectory<dofs>::bytes_per_dof );
+
+    for (size_t i = 0; i < 64; ++i) {
+        // Velocities above the limits lead to brake trajectories, and a disabled DoF keeps its acceleration
+        input.enabled = {true, true, i % 4 != 0};
+        p.fill(input.current_position);
+        d.fill(input.current_velocity);
+        d.fill(input.current_acceleration);
+        p.fill(input.target_position);
+        d.fill(input.target_velocity);
+        l.fill(input.max_velocity);
+        l.fill(input.max_acceleration, input.current_acceleration);
+        l.fill(input.max_jerk);
 
-    CHECK( position_extrema[2].t_max == doctest::Approx(4.0) );
-    CHECK( position_extrema[2].max == doctest::Approx(2.0) );
-    CHECK( position_extrema[2].t_min == doctest::Approx(0.0) );
-    CHECK( position_extrema[2].min == doctest::Approx(0.0) );
+        if (!otg.validate_input(input) || otg.calculate(input, trajectory) != Result::Working) {
+            continue;
+        }
 
+        CHECK( compact.assign(trajectory, 1e-9) );
+        compact.restore(restored_trajectory);
+        CHECK( restored_trajectory.get_duration() == trajectory.get_duration() );
+
+        // Float storage is only accurate relative to the magnitude of the values
+        const bool float_accurate = compact_float.assign(trajectory, 1e-3);
+        CHECK( compact_float.error > compact.error );
+        compact_float.restore(restored_float);
+
+        for (size_t j = 0; j <= 20; ++j) {
+            const double time = 1.1 * trajectory.get_duration() * j / 20;
+            trajectory.at_time(time, position, velocity, acceleration);
+            restored_trajectory.at_time(time, new_position, new_velocity, new_acceleration);
+            for (size_t dof = 0; dof < dofs; ++dof) {
+                CHECK( new_position[dof] == doctest::Approx(position[dof]) );
+                CHECK( new_velocity[dof] == doctest::Approx(velocity[dof]) );
+                CHECK( new_acceleration[dof] == doctest::Approx(acceleration[dof]) );
+            }
+
+            if (float_accurate) {
+                restored_float.at_time(time, new_position, new_velocity, new_acceleration);
+                for (size_t dof = 0; dof < dofs; ++dof) {
+                    CHECK( new_position[dof] == doctest::Approx(position[dof]).epsilon(1e-3).scale(1.0) );
+                }
+            }
+        }
 
-    double time;
-    CHECK( output.trajectory.get_first_time_at_position(0, 0.0, time) );
-    CHECK( time == doctest::Approx(0.0) );
+        // The calculation continues as usual with the restored trajectory
+        CHECK( otg.calculate(input, restored_trajectory) == Result::Working );
+        CHECK( restored_trajectory.get_duration() == trajectory.get_duration() );
+    }
 
-    CHECK( output.trajectory.get_first_time_at_position(0, 0.5, time) );
-    CHECK( time == doctest::Approx(2.0) );
+    CompactTrajectory<0> dynamic_compact {2};
+    CHECK_THROWS( dynamic_compact.assign(Trajectory<0> {3}) );
+}
 
-    CHECK( output.trajectory.get_first_time_at_position(0, 1.0, time) );
-    CHECK( time == doctest::Approx(4.0) );
+TEST_CASE("velocity-ruckig" * doctest::description("Velocity-only Trajectory Generator")) {
+    constexpr size_t DOFs {3};
+    Ruckig<DOFs, true> otg {0.005};
+    VelocityRuckig<DOFs, true> velocity_otg {0.005};
+
+    Randomizer<DOFs, decltype(dynamic_dist)> d { dynamic_dist, seed };
+    Randomizer<DOFs, decltype(limit_dist)> l { limit_dist, seed + 1 };
+    std::mt19937 gen (seed + 2);
+    std::uniform_int_distribution<int> option_dist {0, 3};
+
+    std::array<double, DOFs> position, velocity, acceleration, new_position, new_velocity, new_acceleration;
+    for (size_t i = 0; i < 512; ++i) {
+        InputParameter<DOFs> input;
+        input.control_interface = ControlInterface::Velocity;
+        d.fill(input.current_position);
+        d.fill(input.current_velocity);
+        d.fill_or_zero(input.current_acceleration, 0.8);
+        d.fill(input.target_velocity);
+        d.fill_or_zero(input.target_acceleration, 0.2);
+        l.fill(input.max_acceleration, input.target_acceleration);
+        l.fill(input.max_jerk);
+        switch (option_dist(gen)) {
+            case 1: input.duration_discretization = DurationDiscretization::Discrete; break;
+            case 2: input.minimum_duration = 3.0; break;
+            case 3: input.per_dof_synchronization = {Synchronization::Time, Synchronization::None, Synchronization::TimeIfNecessary}; break;
+        }
 
-    CHECK( output.trajectory.get_first_time_at_position(1, -3.0, time) );
-    CHECK( time == doctest::Approx(2.6004877902) );
+        Trajectory<DOFs> trajectory;
+        REQUIRE( otg.calculate(input, trajectory) == Result::Working );
+        REQUIRE( velocity_otg.calculate(input) == Result::Working );
+        CHECK( velocity_otg.get_duration() == doctest::Approx(trajectory.get_duration()) );
 
-    CHECK( output.trajectory.get_first_time_at_position(1, -3.1, time) );
-    CHECK( time == doctest::Approx(2.8644154489) );
+        // For discrete durations, Ruckig keeps the unrounded profile of the limiting DoF, so only the final state is compared
+        if (input.duration_discretization == DurationDiscretization::Discrete) {
+            velocity_otg.at_time(velocity_otg.get_duration(), new_position, new_velocity, new_acceleration);
+            check_array(new_velocity, input.target_velocity);
+            check_array(new_acceleration, input.target_acceleration);
+            continue;
+        }
 
-    CHECK( output.trajectory.get_first_time_at_position(2, 0.05, time) );
-    CHECK( time == doctest::Approx(0.6694329501) );
+        for (size_t j = 0; j <= 20; ++j) {
+            const double time = 1.1 * trajectory.get_duration() * j / 20;
+            trajectory.at_time(time, position, velocity, acceleration);
+            velocity_otg.at_time(time, new_position, new_velocity, new_acceleration);
+            check_array(new_position, position);
+            check_array(new_velocity, velocity);
+            check_array(new_acceleration, acceleration);
+        }
+    }
 
-    CHECK_FALSE( output.trajectory.get_first_time_at_position(0, -1.0, time) );
-    CHECK_FALSE( output.trajectory.get_first_time_at_position(1, -3.4, time) );
-    CHECK_FALSE( output.trajectory.get_first_time_at_position(6, 0.0, time) );
+    // Control loop until the target velocity is reached
+    InputParameter<DOFs> input;
+    input.current_velocity = {0.0, -0.2, 0.5};
+    input.target_velocity = {1.0, 0.5, -0.5};
+    input.max_acceleration = {1.0, 2.0, 1.0};
+    input.max_jerk = {2.0, 2.0, 4.0};
+
+    VelocityOutputParameter<DOFs> output;
+    size_t calculations {0}, cycles {0};
+    Result result;
+    while ((result = velocity_otg.update(input, output)) == Result::Working) {
+        calculations += output.new_calculation;
+        output.pass_to_input(input);
+        ++cycles;
+    }
+    CHECK( result == Result::Finished );
+    CHECK( calculations == 1 );
+    CHECK( cycles * 0.005 <= velocity_otg.get_duration() );
+    CHECK( (cycles + 1) * 0.005 > velocity_otg.get_duration() );
+    check_array(output.new_velocity, input.target_velocity);
+
+    // A disabled DoF keeps its acceleration
+    input.current_acceleration[1] = 0.5;
+    input.enabled[1] = false;
+    REQUIRE( velocity_otg.calculate(input) == Result::Working );
+    velocity_otg.at_time(2.0, new_position, new_velocity, new_acceleration);
+    CHECK( new_position[1] == doctest::Approx(input.current_position[1] + 2.0 * input.current_velocity[1] + 1.0) );
+    CHECK( new_velocity[1] == doctest::Approx(input.current_velocity[1] + 1.0) );
+    CHECK( new_acceleration[1] == doctest::Approx(0.5) );
+
+    input.max_acceleration[0] = 0.0;
+    CHECK_THROWS( velocity_otg.calculate(input) );
+}
 
+TEST_CASE("input-recorder" * doctest::description("Binary Input Recording")) {
+    constexpr size_t dofs {3};
+    Randomizer<dofs, decltype(position_dist)> p { position_dist, seed };
+    Randomizer<dofs, decltype(dynamic_dist)> d { dynamic_dist, seed + 1 };
+    Randomizer<dofs, decltype(limit_dist)> l { limit_dist, seed + 2 };
+
+    InputRecorder<dofs> recorder {64 * 1024};
+    InputParameter<dofs> input;
+    std::vector<InputParameter<dofs>> changed_inputs;
+    std::vector<uint64_t> changed_cycles;
+    for (size_t cycle = 0; cycle < 200; ++cycle) {
+        // The input changes only every fourth cycle
+        if (cycle % 4 == 0) {
+            p.fill(input.current_position);
+            d.fill(input.current_velocity);
+            d.fill(input.current_acceleration);
+            p.fill(input.target_position);
+            d.fill(input.target_velocity);
+            l.fill(input.max_velocity, input.target_velocity);
+            l.fill(input.max_acceleration);
+            l.fill(input.max_jerk);
+            input.current_velocity[1] = -0.0;
+            input.synchronization = (cycle % 8 == 0) ? Synchronization::Phase : Synchronization::Time;
+            input.min_velocity = (cycle % 16 == 0) ? std::optional<std::array<double, dofs>>({-1.0, -2.0, -3.0}) : std::nullopt;
+            input.enabled = {true, cycle % 12 != 0, true};
+            input.per_dof_control_interface = (cycle % 20 == 0) ? std::optional<std::array<ControlInterface, dofs>>({ControlInterface::Velocity, ControlInterface::Position, ControlInterface::Velocity}) : std::nullopt;
+            input.minimum_duration = (cycle % 24 == 0) ? std::optional<double>(1.0 / 3.0) : std::nullopt;
+            changed_inputs.push_back(input);
+            changed_cycles.push_back(cycle);
+        }
+        CHECK( recorder.record(input) );
+    }
+    CHECK( recorder.dropped_records() == 0 );
+
+    std::vector<uint8_t> recording;
+    InputRecording::write_header(recording);
+    CHECK( recorder.drain(recording) > 0 );
+    CHECK( recorder.drain(recording) == 0 );
+    REQUIRE( InputRecording::read_header(recording.data(), recording.size()) );
+
+    // The changed inputs are restored bit-exactly with their cycle
+    size_t offset {InputRecording::header_size}, number_records {0};
+    uint64_t cycle;
+    InputParameter<dofs> replayed;
+    while (InputRecording::read_record(recording.data(), recording.size(), offset, cycle, replayed)) {
+        REQUIRE( number_records < changed_inputs.size() );
+        CHECK( cycle == changed_cycles[number_records] );
+        CHECK_FALSE( replayed != changed_inputs[number_records] );
+        CHECK( std::signbit(replayed.current_velocity[1]) );
+        ++number_records;
+    }
+    CHECK( number_records == changed_inputs.size() );
+    CHECK( offset == recording.size() );
+
+    // Dynamic DoFs are resized to the recording
+    InputParameter<0> dynamic_replayed {1};
+    offset = InputRecording::header_size;
+    CHECK( InputRecording::read_record(recording.data(), recording.size(), offset, cycle, dynamic_replayed) );
+    CHECK( dynamic_replayed.degrees_of_freedom == dofs );
+    CHECK( dynamic_replayed.target_position[2] == changed_inputs[0].target_position[2] );
+
+    // A full ring buffer drops records, which are recorded again once drained, and wraps around
+    InputRecorder<dofs> small_recorder {InputRecording::max_record_size(dofs) + 8};
+    input.min_velocity.reset();
+    input.per_dof_control_interface.reset();
+    input.minimum_duration.reset();
+    input.enabled = {true, true, true};
+    std::vector<double> target_positions {input.target_position[0]};
+    CHECK( small_recorder.record(input) );
+    input.target_position[0] += 1.0;
+    CHECK_FALSE( small_recorder.record(input) );
+    CHECK( small_recorder.dropped_records() == 1 );
+
+    std::vector<uint8_t> small_recording;
+    for (size_t i = 0; i < 5; ++i) {
+        small_recorder.drain(small_recording);
+        target_positions.push_back(input.target_position[0]);
+        CHECK( small_recorder.record(input) );
+        input.target_position[0] += 1.0;
+    }
+    small_recorder.drain(small_recording);
+
+    offset = 0;
+    number_records = 0;
+    while (InputRecording::read_record(small_recording.data(), small_recording.size(), offset, cycle, replayed)) {
+        REQUIRE( number_records < target_positions.size() );
+        CHECK( replayed.target_position[0] == target_positions[number_records] );
+        ++number_records;
+    }
+    CHECK( number_records == 6 );
+    CHECK( cycle == 6 );
+}
 
+TEST_CASE("executable-trajectory" * doctest::description("Executable Part of a Trajectory")) {
+    Ruckig<3, true> otg;
+    InputParameter<3> input;
     input.current_position = {0.0, -2.0, 0.0};
-    input.current_velocity = {0.0, 0.0, 0.0};
-    input.current_acceleration = {0.0, 0.0, 0.0};
+    input.current_velocity = {0.2, 0.0, -0.1};
     input.target_position = {1.0, -3.0, 2.0};
-    input.target_velocity = {2.0, 0.3, 0.0};
-    input.target_acceleration = {0.0, 0.0, 0.0};
+    input.target_velocity = {0.0, 0.3, 0.0};
     input.max_velocity = {1.0, 1.0, 1.0};
     input.max_acceleration = {1.0, 1.0, 1.0};
     input.max_jerk = {1.0, 1.0, 1.0};
 
-    result = otg.update(input, output);
+    Trajectory<3> trajectory;
+    CHECK( otg.calculate(input, trajectory) == Result::Working );
+
+    const ExecutableTrajectory<3> executable = trajectory;
+    CHECK( sizeof(executable) < sizeof(trajectory) / 2 );
+    CHECK( executable.get_duration() == trajectory.get_duration() );
+    CHECK( executable.get_independent_min_durations() == trajectory.get_independent_min_durations() );
+    CHECK( executable.get_position_extrema()[2].max == trajectory.get_position_extrema()[2].max );
+
+    std::array<double, 3> new_position, new_velocity, new_acceleration, executable_position, executable_velocity, executable_acceleration;
+    for (const double time: {0.0, 0.5, 0.5 * trajectory.get_duration(), trajectory.get_duration(), trajectory.get_duration() + 1.0}) {
+        trajectory.at_time(time, new_position, new_velocity, new_acceleration);
+        executable.at_time(time, executable_position, executable_velocity, executable_acceleration);
+        CHECK( executable_position == new_position );
+        CHECK( executable_velocity == new_velocity );
+        CHECK( executable_acceleration == new_acceleration );
+    }
 
-    CHECK( result == Result::ErrorInvalidInput );
-    CHECK_FALSE( output.new_calculation );
+    // Adopting it discards the calculation workspace, but the next calculation is still correct
+    Trajectory<3> adopted;
+    adopted.assign(executable);
+    CHECK( adopted.get_duration() == trajectory.get_duration() );
 
-    input.target_velocity = {0.2, -0.3, 0.8};
-    result = otg.update(input, output);
+    input.target_position = {-1.0, 1.0, 0.5};
+    CHECK( otg.calculate(input, trajectory) == Result::Working );
+    CHECK( otg.calculate(input, adopted) == Result::Working );
+    CHECK( adopted.get_duration() == trajectory.get_duration() );
 
-    CHECK( result == Result::Working );
-    CHECK( output.new_calculation );
+    ExecutableTrajectory<0> dynamic_executable = Trajectory<0> {2};
+    CHECK( dynamic_executable.degrees_of_freedom == 2 );
+    CHECK( dynamic_executable.get_duration() == 0.0 );
+}
 
+TEST_CASE("async" * doctest::description("Asynchronous Background Calculation")) {
+    AsyncRuckig<3> otg {0.005};
+    InputParameter<3> input;
+    OutputParameter<3> output;
 
-    input.minimum_duration = 12.0;
-    result = otg.update(input, output);
+    input.current_position = {0.0, -2.0, 0.0};
+    input.target_position = {1.0, -3.0, 2.0};
+    input.max_velocity = {1.0, 1.0, 1.0};
+    input.max_acceleration = {1.0, 1.0, 1.0};
+    input.max_jerk = {1.0, 1.0, 1.0};
 
-    CHECK( result == Result::Working );
-    CHECK( output.trajectory.get_duration() == doctest::Approx(12.0) );
-}
+    CHECK( otg.update(input, output) == Result::Working );
+    CHECK( output.new_calculation );
+    output.pass_to_input(input);
 
-// TEST_CASE("enabled" * doctest::description("Enabled DoF")) {
-//     Ruckig<3, true> otg {0.005};
-//     InputParameter<3> input;
-//     OutputParameter<3> output;
+    size_t request_cycle {0}, swap_cycle {0};
+    Result result {Result::Working};
+    for (size_t i = 1; i < 4000 && result == Result::Working; ++i) {
+        if (i == 200) {
+            input.target_position = {-1.0, -1.0, 1.0};
+        }
 
-//     input.enabled = {true, false, false};
-//     input.current_position = {0.0, -2.0, 0.0};
-//     input.current_velocity = {0.0, 0.1, 0.0};
-//     input.current_acceleration = {0.0, 0.0, -0.2};
-//     input.target_position = {1.0, -3.0, 2.0};
-//     input.max_velocity = {1.0, 1.0, 1.0};
-//     input.max_acceleration = {1.0, 1.0, 1.0};
-//     input.max_jerk = {1.0, 1.0, 1.0};
+        const auto old_position = output.new_position;
+        result = otg.update(input, output);
+        CHECK( (result == Result::Working || result == Result::Finished) );
 
-//     Result result = otg.update(input, output);
-//     CHECK( result == Result::Working );
-//     CHECK( output.trajectory.get_duration() == doctest::Approx(3.1748021039) );
+        if (output.was_calculation_interrupted) {
+            request_cycle = (request_cycle == 0) ? i : request_cycle;
+        }
+        while (otg.is_calculating()) {
+            std::this_thread::yield();
+        }
+        if (output.new_calculation) {
+            swap_cycle = i;
+        }
 
-//     std::array<double, 3> new_position, new_velocity, new_acceleration;
-//     output.trajectory.at_time(0.0, new_position, new_velocity, new_acceleration);
-//     check_array(new_position, input.current_position);
-//     check_array(new_velocity, input.current_velocity);
-//     check_array(new_acceleration, input.current_acceleration);
+        // The output stays continuous when swapping in the new trajectory
+        for (size_t dof = 0; dof < 3; ++dof) {
+            CHECK( std::abs(output.new_position[dof] - old_position[dof]) <= input.max_velocity[dof] * 0.005 + 1e-9 );
+        }
+        output.pass_to_input(input);
+    }
 
-//     output.trajectory.at_time(output.trajectory.get_duration(), new_position, new_velocity, new_acceleration);
-//     check_array(new_position, {input.target_position[0], -1.6825197896, -1.0079368399});
-// }
+    CHECK( result == Result::Finished );
+    CHECK( request_cycle == 200 );
+    CHECK( swap_cycle == request_cycle + otg.prediction_cycles );
+    check_array(output.new_position, input.target_position);
+}
 
 TEST_CASE("phase-synchronization" * doctest::description("Phase Synchronization")) {
     Ruckig<3, true> otg {0.005};
@@ -386,6 +4167,95 @@ TEST_CASE("per-dof-setting" * doctest::description("Per DoF Settings")) {
     CHECK( new_position[2] == doctest::Approx(input.target_position[2]) );
 }
 
+TEST_CASE("synchronization-groups" * doctest::description("Independent Synchronization Groups")) {
+    Randomizer<5, decltype(position_dist)> p { position_dist, seed };
+    Randomizer<5, decltype(dynamic_dist)> d { dynamic_dist, seed + 1 };
+    Randomizer<5, decltype(limit_dist)> l { limit_dist, seed + 2 };
+
+    // The groups are compared with separate calculations of their DoFs
+    const std::array<size_t, 5> groups {1, 0, 1, 0, 1};
+    const std::array<size_t, 2> group_0 {1, 3};
+    const std::array<size_t, 3> group_1 {0, 2, 4};
+
+    Ruckig<5> otg;
+    Ruckig<2> otg_0;
+    Ruckig<3> otg_1;
+    InputParameter<5> input;
+    InputParameter<2> input_0;
+    InputParameter<3> input_1;
+    Trajectory<5> trajectory;
+    Trajectory<2> trajectory_0;
+    Trajectory<3> trajectory_1;
+    input.synchronization_groups = groups;
+
+    const auto split = [&input](auto& group_input, const auto& dofs) {
+        for (size_t i = 0; i < dofs.size(); ++i) {
+            group_input.current_position[i] = input.current_position[dofs[i]];
+            group_input.current_velocity[i] = input.current_velocity[dofs[i]];
+            group_input.current_acceleration[i] = input.current_acceleration[dofs[i]];
+            group_input.target_position[i] = input.target_position[dofs[i]];
+            group_input.target_velocity[i] = input.target_velocity[dofs[i]];
+            group_input.target_acceleration[i] = input.target_acceleration[dofs[i]];
+            group_input.max_velocity[i] = input.max_velocity[dofs[i]];
+            group_input.max_acceleration[i] = input.max_acceleration[dofs[i]];
+            group_input.max_jerk[i] = input.max_jerk[dofs[i]];
+        }
+    };
+
+    std::array<double, 5> new_position, new_velocity, new_acceleration;
+    std::array<double, 2> new_position_0, new_velocity_0, new_acceleration_0;
+    std::array<double, 3> new_position_1, new_velocity_1, new_acceleration_1;
+    for (size_t i = 0; i < 1024; ++i) {
+        p.fill(input.current_position);
+        d.fill_or_zero(input.current_velocity, 0.9);
+        p.fill(input.target_position);
+        d.fill_or_zero(input.target_velocity, 0.7);
+        l.fill(input.max_velocity, input.target_velocity);
+        l.fill(input.max_acceleration);
+        l.fill(input.max_jerk);
+        input.minimum_duration = (i % 8 == 0) ? std::optional<double>(1.0) : std::nullopt;
+        input_0.minimum_duration = input.minimum_duration;
+        input_1.minimum_duration = input.minimum_duration;
+        split(input_0, group_0);
+        split(input_1, group_1);
+
+        const Result result = otg.calculate(input, trajectory);
+        const Result result_0 = otg_0.calculate(input_0, trajectory_0);
+        const Result result_1 = otg_1.calculate(input_1, trajectory_1);
+        if (result_0 != Result::Working || result_1 != Result::Working) {
+            continue;
+        }
+
+        REQUIRE( result == Result::Working );
+        CHECK( trajectory.get_duration() == doctest::Approx(std::max(trajectory_0.get_duration(), trajectory_1.get_duration())) );
+        for (const double time: {0.0, 0.25 * trajectory.get_duration(), 0.5 * trajectory_0.get_duration(), 0.5 * trajectory_1.get_duration(), trajectory.get_duration()}) {
+            trajectory.at_time(time, new_position, new_velocity, new_acceleration);
+            trajectory_0.at_time(time, new_position_0, new_velocity_0, new_acceleration_0);
+            trajectory_1.at_time(time, new_position_1, new_velocity_1, new_acceleration_1);
+            for (size_t j = 0; j < group_0.size(); ++j) {
+                CHECK( new_position[group_0[j]] == doctest::Approx(new_position_0[j]) );
+                CHECK( new_velocity[group_0[j]] == doctest::Approx(new_velocity_0[j]) );
+            }
+            for (size_t j = 0; j < group_1.size(); ++j) {
+                CHECK( new_position[group_1[j]] == doctest::Approx(new_position_1[j]) );
+                CHECK( new_velocity[group_1[j]] == doctest::Approx(new_velocity_1[j]) );
+            }
+        }
+    }
+
+    // A single group is the same as no groups
+    Trajectory<5> trajectory_all;
+    input.synchronization_groups.reset();
+    CHECK( otg.calculate(input, trajectory_all) == Result::Working );
+    input.synchronization_groups = std::array<size_t, 5> {7, 7, 7, 7, 7};
+    CHECK( otg.calculate(input, trajectory) == Result::Working );
+    CHECK( trajectory.get_duration() == doctest::Approx(trajectory_all.get_duration()) );
+
+    // Groups are a per-DoF setting
+    Ruckig<5, false, true, 0, Instrumentation::Duration, Features::Uniform> otg_uniform;
+    CHECK( otg_uniform.calculate(input, trajectory) == Result::ErrorInvalidInput );
+}
+
 TEST_CASE("dynamic-dofs" * doctest::description("Dynamic DoFs")) {
     Ruckig<DynamicDOFs, true> otg {3, 0.005};
     InputParameter<DynamicDOFs> input {3};
@@ -413,6 +4283,43 @@ TEST_CASE("dynamic-dofs" * doctest::description("Dynamic DoFs")) {
     check_array(new_acceleration, input.current_acceleration);
 }
 
+TEST_CASE("bounded-dofs" * doctest::description("Dynamic DoFs with Bounded Capacity")) {
+    constexpr size_t MaxDOFs {8};
+    Ruckig<DynamicDOFs, true, true, MaxDOFs> otg {3, 0.005};
+    InputParameter<DynamicDOFs, MaxDOFs> input {3};
+    OutputParameter<DynamicDOFs, MaxDOFs> output {3};
+
+    CHECK( input.current_position.size() == 3 );
+    CHECK( input.current_position.capacity() == MaxDOFs );
+    CHECK_THROWS( InputParameter<DynamicDOFs, MaxDOFs>(MaxDOFs + 1) );
+
+    input.current_position = {0.0, -2.0, 0.0};
+    input.current_velocity = {0.0, 0.0, 0.0};
+    input.current_acceleration = {0.0, 0.0, 0.0};
+    input.target_position = {1.0, -3.0, 2.0};
+    input.target_velocity = {0.0, 0.3, 0.0};
+    input.target_acceleration = {0.0, 0.0, 0.0};
+    input.max_velocity = {1.0, 1.0, 1.0};
+    input.max_acceleration = {1.0, 1.0, 1.0};
+    input.max_jerk = {1.0, 1.0, 1.0};
+
+    auto result = otg.update(input, output);
+
+    CHECK( result == Result::Working );
+    CHECK( output.trajectory.get_duration() == doctest::Approx(4.0) );
+
+    BoundedVector<double, MaxDOFs> new_position(3), new_velocity(3), new_acceleration(3);
+    output.trajectory.at_time(0.0, new_position, new_velocity, new_acceleration);
+    check_array(new_position, input.current_position);
+    check_array(new_velocity, input.current_velocity);
+    check_array(new_acceleration, input.current_acceleration);
+
+    output.trajectory.at_time(output.trajectory.get_duration(), new_position, new_velocity, new_acceleration);
+    check_array(new_position, input.target_position);
+    check_array(new_velocity, input.target_velocity);
+    check_array(new_acceleration, input.target_acceleration);
+}
+
 TEST_CASE("known" * doctest::description("Known examples")) {
     Ruckig<3, true> otg {0.005};
 
@@ -921,6 +4828,12 @@ int main(int argc, char** argv) {
     if (argc > 2 && std::isdigit(argv[2][0])) {
         seed = std::stoi(argv[2]);
     }
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg {argv[i]};
+        if (arg.compare(0, 15, "--write-corpus=") == 0) {
+            CorpusCapture::filename = arg.substr(15);
+        }
+    }
 
     context.applyCommandLine(argc, argv);
 
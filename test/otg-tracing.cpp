@@ -0,0 +1,78 @@
+// Checks the trace points: built with the CountingTracer as RUCKIG_TRACE_POLICY
+
+#include <cstdio>
+#include <random>
+
+#include "randomizer.hpp"
+
+#include <ruckig/ruckig.hpp>
+
+
+using namespace ruckig;
+
+
+int main() {
+    constexpr size_t DOFs {3};
+    constexpr size_t number_trajectories {2000};
+    static_assert(std::is_same_v<Tracer, CountingTracer>, "This check needs to be built with RUCKIG_TRACE_POLICY=CountingTracer.");
+
+    std::normal_distribution<double> position_dist {0.0, 4.0};
+    std::normal_distribution<double> dynamic_dist {0.0, 0.8};
+    std::uniform_real_distribution<double> limit_dist {0.1, 12.0};
+    Randomizer<DOFs, decltype(position_dist)> p { position_dist, 42 };
+    Randomizer<DOFs, decltype(dynamic_dist)> d { dynamic_dist, 43 };
+    Randomizer<DOFs, decltype(limit_dist)> l { limit_dist, 44 };
+
+    Ruckig<DOFs> otg {0.005};
+    InputParameter<DOFs> input;
+    OutputParameter<DOFs> output;
+    size_t failures {0}, calculations {0}, samples {0};
+
+    for (size_t i = 0; i < number_trajectories; ++i) {
+        p.fill(input.current_position);
+        d.fill_or_zero(input.current_velocity, 0.9);
+        d.fill_or_zero(input.current_acceleration, 0.8);
+        p.fill(input.target_position);
+        d.fill_or_zero(input.target_velocity, 0.7);
+        l.fill(input.max_velocity, input.target_velocity);
+        l.fill(input.max_acceleration);
+        l.fill(input.max_jerk);
+        if (!otg.validate_input(input)) {
+            continue;
+        }
+
+        // A new calculation, followed by cycles that only sample the trajectory
+        for (size_t cycle = 0; cycle < 3; ++cycle) {
+            if (otg.update(input, output) != Result::Working) {
+                ++failures;
+            }
+            calculations += output.new_calculation;
+            ++samples;
+            output.pass_to_input(input);
+        }
+    }
+
+    const auto count = [](TracePoint point) {
+        const size_t index = static_cast<size_t>(point);
+        return std::make_pair(CountingTracer::begins[index].load(), CountingTracer::ends[index].load());
+    };
+
+    const auto [calculate_begins, calculate_ends] = count(TracePoint::Calculate);
+    const auto [brake_begins, brake_ends] = count(TracePoint::Brake);
+    const auto [step1_begins, step1_ends] = count(TracePoint::Step1);
+    const auto [synchronization_begins, synchronization_ends] = count(TracePoint::Synchronization);
+    const auto [step2_begins, step2_ends] = count(TracePoint::Step2);
+    const auto [at_time_begins, at_time_ends] = count(TracePoint::AtTime);
+
+    failures += (calculate_begins != calculations || calculate_ends != calculations);
+    failures += (brake_begins != brake_ends || brake_begins != DOFs * calculations);
+    failures += (step1_begins != step1_ends || step1_begins != DOFs * calculations);
+    failures += (synchronization_begins != synchronization_ends || synchronization_begins != calculations);
+    failures += (step2_begins != step2_ends || step2_begins == 0 || step2_begins > (DOFs - 1) * calculations);
+    failures += (at_time_begins != at_time_ends || at_time_begins != samples);
+    failures += CountingTracer::nesting_errors.load();
+
+    std::printf("Calculations: %zu, samples: %zu, failures: %zu\n", calculations, samples, failures);
+    std::printf("Trace points: calculate %zu, brake %zu, step1 %zu, synchronization %zu, step2 %zu, at_time %zu\n", calculate_begins, brake_begins, step1_begins, synchronization_begins, step2_begins, at_time_begins);
+    return (failures == 0) ? 0 : 1;
+}
@@ -0,0 +1,217 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "corpus.hpp"
+#include "randomizer.hpp"
+
+#include <ruckig/ruckig.hpp>
+
+
+using namespace ruckig;
+
+
+//! Input that was found by the search, together with its calculation duration
+struct Candidate {
+    InputParameter<0> input;
+    double duration; // [µs]
+    Result result;
+};
+
+
+//! Searches adversarially for inputs with a long calculation duration (worst-case execution time)
+
+//! Starting from random inputs, a population of the slowest inputs found so far is evolved by mutations that
+//! favor the slow paths of the algorithm: inputs at or beyond the kinematic limits (brake trajectories), nearly
+//! coinciding boundary states (numerical edge cases of the root finding), and very different limits across the DoFs
+//! (synchronization with many possible durations). The slowest inputs are saved as a corpus for regression tests.
+class WCETSearch {
+    Ruckig<0> otg;
+    std::default_random_engine gen;
+    size_t repetitions;
+
+public:
+    explicit WCETSearch(size_t dofs, int seed, size_t repetitions): otg(dofs, 0.005), gen(seed), repetitions(repetitions) { }
+
+    //! Minimum over the repetitions to reduce measurement noise, e.g. from interrupts
+    double measure(const InputParameter<0>& input, Result& result) {
+        Trajectory<0> trajectory {otg.degrees_of_freedom};
+        double duration {std::numeric_limits<double>::infinity()};
+        for (size_t i = 0; i < repetitions; ++i) {
+            const auto start = std::chrono::high_resolution_clock::now();
+            result = otg.calculate(input, trajectory);
+            const auto stop = std::chrono::high_resolution_clock::now();
+            duration = std::min(duration, std::chrono::duration_cast<std::chrono::nanoseconds>(stop - start).count() / 1000.0);
+        }
+        return duration;
+    }
+
+    InputParameter<0> random_input() {
+        std::normal_distribution<double> position_dist {0.0, 4.0};
+        std::normal_distribution<double> dynamic_dist {0.0, 0.8};
+        std::uniform_real_distribution<double> limit_dist {0.1, 12.0};
+
+        Randomizer<0, decltype(position_dist)> p { position_dist, static_cast<int>(gen()) };
+        Randomizer<0, decltype(dynamic_dist)> d { dynamic_dist, static_cast<int>(gen()) };
+        Randomizer<0, decltype(limit_dist)> l { limit_dist, static_cast<int>(gen()) };
+
+        InputParameter<0> input {otg.degrees_of_freedom};
+        p.fill(input.current_position);
+        d.fill_or_zero(input.current_velocity, 0.9);
+        d.fill_or_zero(input.current_acceleration, 0.8);
+        p.fill(input.target_position);
+        d.fill_or_zero(input.target_velocity, 0.7);
+        d.fill_or_zero(input.target_acceleration, 0.6);
+        l.fill(input.max_velocity, input.target_velocity);
+        l.fill(input.max_acceleration, input.target_acceleration);
+        l.fill(input.max_jerk);
+        return input;
+    }
+
+    InputParameter<0> mutate(const InputParameter<0>& parent) {
+        InputParameter<0> input {parent};
+        std::uniform_int_distribution<size_t> dof_dist {0, otg.degrees_of_freedom - 1};
+        std::uniform_int_distribution<int> mutation_dist {0, 6};
+        std::normal_distribution<double> noise {0.0, 1.0};
+        std::uniform_real_distribution<double> unit {0.0, 1.0};
+
+        const size_t number_mutations = 1 + gen() % 3;
+        for (size_t m = 0; m < number_mutations; ++m) {
+            const size_t dof = dof_dist(gen);
+            switch (mutation_dist(gen)) {
+                case 0: { // Small perturbation of the boundary state
+                    input.current_position[dof] += 0.1 * noise(gen);
+                    input.current_velocity[dof] += 0.1 * noise(gen);
+                    input.current_acceleration[dof] += 0.1 * noise(gen);
+                } break;
+                case 1: { // Target close to the current state
+                    const double scale = std::pow(10.0, -8.0 * unit(gen));
+                    input.target_position[dof] = input.current_position[dof] + scale * noise(gen);
+                    input.target_velocity[dof] = input.current_velocity[dof] + scale * noise(gen);
+                    input.target_acceleration[dof] = input.current_acceleration[dof] + scale * noise(gen);
+                } break;
+                case 2: { // Current state at or beyond the limits (brake trajectory)
+                    input.current_velocity[dof] = input.max_velocity[dof] * (0.9 + 0.2 * unit(gen)) * (unit(gen) < 0.5 ? -1 : 1);
+                    input.current_acceleration[dof] = input.max_acceleration[dof] * (0.9 + 0.2 * unit(gen)) * (unit(gen) < 0.5 ? -1 : 1);
+                } break;
+                case 3: { // Target state at the limits
+                    input.target_velocity[dof] = input.max_velocity[dof] * (0.5 + 0.5 * unit(gen)) * (unit(gen) < 0.5 ? -1 : 1);
+                    input.target_acceleration[dof] = input.max_acceleration[dof] * unit(gen) * (unit(gen) < 0.5 ? -1 : 1);
+                } break;
+                case 4: { // Very different scales of the limits
+                    const double scale = std::pow(10.0, 4.0 * (unit(gen) - 0.5));
+                    input.max_velocity[dof] *= scale;
+                    input.max_acceleration[dof] *= std::pow(10.0, 4.0 * (unit(gen) - 0.5));
+                    input.max_jerk[dof] *= std::pow(10.0, 4.0 * (unit(gen) - 0.5));
+                } break;
+                case 5: { // Copy the scaled boundary state of another DoF (nearly collinear inputs)
+                    const size_t other = dof_dist(gen);
+                    const double scale = 1.0 + 1e-3 * noise(gen);
+                    input.current_position[dof] = scale * input.current_position[other];
+                    input.current_velocity[dof] = scale * input.current_velocity[other];
+                    input.current_acceleration[dof] = scale * input.current_acceleration[other];
+                    input.target_position[dof] = scale * input.target_position[other];
+                    input.target_velocity[dof] = scale * input.target_velocity[other];
+                    input.target_acceleration[dof] = scale * input.target_acceleration[other];
+                } break;
+                case 6: { // Zero values, e.g. for degenerated profiles
+                    input.current_velocity[dof] = 0.0;
+                    input.current_acceleration[dof] = 0.0;
+                    (unit(gen) < 0.5 ? input.target_velocity[dof] : input.target_acceleration[dof]) = 0.0;
+                } break;
+            }
+        }
+        return input;
+    }
+
+    std::vector<Candidate> search(size_t iterations, size_t population_size) {
+        std::vector<Candidate> population;
+        auto insert = [&population, population_size](const Candidate& candidate) {
+            if (population.size() < population_size || candidate.duration > population.back().duration) {
+                population.insert(std::upper_bound(population.begin(), population.end(), candidate, [](const Candidate& a, const Candidate& b) { return a.duration > b.duration; }), candidate);
+                if (population.size() > population_size) {
+                    population.pop_back();
+                }
+            }
+        };
+
+        for (size_t i = 0; i < iterations; ++i) {
+            // Mix random restarts with mutations of the slowest inputs so far
+            InputParameter<0> input = (population.empty() || gen() % 8 == 0) ? random_input() : mutate(population[gen() % population.size()].input);
+            if (!otg.validate_input(input)) {
+                continue;
+            }
+
+            Result result;
+            const double duration = measure(input, result);
+            insert({input, duration, result});
+        }
+
+        // Measure again to remove outliers due to single noisy measurements
+        for (auto& candidate: population) {
+            candidate.duration = std::min(candidate.duration, measure(candidate.input, candidate.result));
+        }
+        std::sort(population.begin(), population.end(), [](const Candidate& a, const Candidate& b) { return a.duration > b.duration; });
+        return population;
+    }
+};
+
+
+int main(int argc, char** argv) {
+    // Usage: otg-wcet [--dofs N] [--iterations N] [--population N] [--seed N] [--corpus FILE] [--replay FILE]
+    size_t dofs {7}, iterations {200000}, population_size {64}, repetitions {5};
+    int seed {42};
+    std::string corpus_filename {"wcet-corpus.txt"}, replay_filename;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        const std::string arg {argv[i]};
+        if (arg == "--dofs") {
+            dofs = std::stoul(argv[i + 1]);
+        } else if (arg == "--iterations") {
+            iterations = std::stoul(argv[i + 1]);
+        } else if (arg == "--population") {
+            population_size = std::stoul(argv[i + 1]);
+        } else if (arg == "--seed") {
+            seed = std::stoi(argv[i + 1]);
+        } else if (arg == "--corpus") {
+            corpus_filename = argv[i + 1];
+        } else if (arg == "--replay") {
+            replay_filename = argv[i + 1];
+        }
+    }
+
+    WCETSearch wcet {dofs, seed, repetitions};
+
+    // Replay a stored corpus to check for regressions of the worst-case
+    if (!replay_filename.empty()) {
+        std::ifstream file {replay_filename};
+        double worst {0.0};
+        for (const auto& input: corpus::read<0>(file, dofs)) {
+            Result result;
+            worst = std::max(worst, wcet.measure(input, result));
+        }
+        std::cout << "Worst calculation duration of corpus: " << worst << " [µs]" << std::endl;
+        return 0;
+    }
+
+    const auto population = wcet.search(iterations, population_size);
+    if (population.empty()) {
+        return 1;
+    }
+
+    std::cout << "Worst calculation duration for " << dofs << " DoFs after " << iterations << " iterations: " << population.front().duration << " [µs]" << std::endl;
+    std::cout << "Median of the " << population.size() << " slowest inputs: " << population[population.size() / 2].duration << " [µs]" << std::endl;
+
+    std::ofstream file {corpus_filename};
+    file << "# WCET corpus: " << dofs << " DoFs, seed " << seed << ", " << iterations << " iterations\n";
+    for (const auto& candidate: population) {
+        file << "# duration " << candidate.duration << " µs, result " << candidate.result << "\n";
+        corpus::write_input(file, candidate.input);
+    }
+    std::cout << "Corpus written to " << corpus_filename << std::endl;
+}
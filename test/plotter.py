@@ -50,14 +50,14 @@ class Plotter:
             if inp.max_velocity[dof] < 1.4 * global_max:
                 plt.axhline(y=inp.max_velocity[dof], color='orange', linestyle='--', linewidth=1.1)
 
-            min_velocity = inp.min_velocity[dof] if inp.min_velocity else -inp.max_velocity[dof]
+            min_velocity = inp.min_velocity[dof] if inp.min_velocity is not None else -inp.max_velocity[dof]
             if min_velocity > 1.4 * global_min:
                 plt.axhline(y=min_velocity, color='orange', linestyle='--', linewidth=1.1)
 
             if inp.max_acceleration[dof] < 1.4 * global_max:
                 plt.axhline(y=inp.max_acceleration[dof], color='g', linestyle='--', linewidth=1.1)
 
-            min_acceleration = inp.min_acceleration[dof] if inp.min_acceleration else -inp.max_acceleration[dof]
+            min_acceleration = inp.min_acceleration[dof] if inp.min_acceleration is not None else -inp.max_acceleration[dof]
             if min_acceleration > 1.4 * global_min:
                 plt.axhline(y=min_acceleration, color='g', linestyle='--', linewidth=1.1)
 
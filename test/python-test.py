@@ -0,0 +1,100 @@
+import asyncio
+import gc
+from pathlib import Path
+from sys import path
+
+import numpy as np
+
+# Path to the build directory including a file similar to 'ruckig.cpython-37m-x86_64-linux-gnu'.
+build_path = Path(__file__).parent.absolute().parent / 'build'
+path.insert(0, str(build_path))
+
+from ruckig import InputParameter, Result, Ruckig, Trajectory, generate
+
+
+def create_input():
+    inp = InputParameter(3)
+    inp.current_position = [0.0, 0.0, 0.5]
+    inp.current_velocity = [0.0, -0.2, 0.0]
+    inp.target_position = [1.0, -0.5, -0.5]
+    inp.max_velocity = [1.0, 1.0, 1.0]
+    inp.max_acceleration = [2.0, 2.0, 2.0]
+    inp.max_jerk = [4.0, 4.0, 4.0]
+    return inp
+
+
+def test_array_views():
+    inp = create_input()
+
+    # The vector fields are views, updated in-place
+    target_position = inp.target_position
+    target_position[0] = 2.0
+    assert inp.target_position[0] == 2.0
+    inp.target_position = [1.0, 1.0, 1.0]
+    assert target_position[1] == 1.0
+
+    try:
+        inp.target_position = [1.0, 2.0]
+        assert False, 'a size mismatch needs to be rejected'
+    except ValueError:
+        pass
+
+    # The optional fields are copies, so that replacing them keeps existing arrays valid
+    assert inp.min_velocity is None
+    inp.min_velocity = [-1.0, -1.0, -1.0]
+    min_velocity = inp.min_velocity
+    inp.min_velocity = None
+    gc.collect()
+    assert min_velocity.tolist() == [-1.0, -1.0, -1.0]
+    assert inp.min_velocity is None
+
+
+def test_calculate():
+    otg = Ruckig(3, 0.01)
+    inp = create_input()
+    trajectory = Trajectory(3)
+    assert otg.calculate(inp, trajectory) == Result.Working
+
+    # Scalar and array sampling
+    position, velocity, acceleration = trajectory.at_time(trajectory.duration)
+    assert np.allclose(position, inp.target_position)
+    positions, velocities, accelerations = trajectory.at_time(np.linspace(0.0, trajectory.duration, 11))
+    assert positions.shape == (11, 3)
+    assert np.allclose(positions[-1], inp.target_position)
+
+    # Only the duration
+    workspace = Trajectory(3)
+    result, duration = otg.calculate_min_duration(inp, workspace)
+    assert result == Result.Working
+    assert abs(duration - trajectory.duration) < 1e-12
+
+    results, trajectories = otg.calculate_many([inp, inp], 2)
+    assert results == [Result.Working, Result.Working]
+    assert abs(trajectories[1].duration - trajectory.duration) < 1e-12
+
+
+def test_generate():
+    inp = create_input()
+    times, positions, velocities, accelerations = generate(inp, 0.01)
+    assert positions.shape == (len(times), 3)
+    assert np.allclose(positions[-1], inp.target_position)
+
+
+def test_async():
+    otg = Ruckig(3, 0.01)
+    inp = create_input()
+
+    async def calculate():
+        return await otg.calculate_async(inp)
+
+    result, trajectory = asyncio.run(calculate())
+    assert result == Result.Working
+    assert trajectory.duration > 0.0
+
+
+if __name__ == '__main__':
+    test_array_views()
+    test_calculate()
+    test_generate()
+    test_async()
+    print('All Python tests passed.')